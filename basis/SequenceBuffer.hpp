@@ -1,10 +1,15 @@
 #pragma once
 
+#include <climits>
 #include <cstdint>
+#include <memory>
+#include <new>
 #include <string>
+#include <string_view>
 #include <optional>
 #include <functional>
-#include <unordered_map>
+#include <variant>
+#include <vector>
 
 #include <glm/vec3.hpp>
 
@@ -13,6 +18,7 @@
 
 #include <base/logging.h>
 #include <base/trace_event/trace_event.h>
+#include <base/trace_event/memory_usage_estimator.h>
 
 namespace backend {
 
@@ -41,6 +47,66 @@ struct UserCommand
   bool isDropped = false;
 };
 
+/// \note wire framing for |SequenceBuffer::exportRange| blobs:
+///   [firstTick u64 LE][count u32 LE]
+///   then per tick: [payloadSize u32 LE][payload bytes]
+/// ticks are consecutive (firstTick, firstTick + 1, ...),
+/// so per-frame tick numbers are implicit
+namespace sequence_export_internal {
+
+inline void appendU32(std::string* out, const uint32_t value)
+{
+  const char bytes[4] = {
+    static_cast<char>(value)
+    , static_cast<char>(value >> 8)
+    , static_cast<char>(value >> 16)
+    , static_cast<char>(value >> 24)
+  };
+  out->append(bytes, 4);
+}
+
+inline void appendU64(std::string* out, const uint64_t value)
+{
+  appendU32(out, static_cast<uint32_t>(value));
+  appendU32(out, static_cast<uint32_t>(value >> 32));
+}
+
+inline void patchU32(std::string* out, const size_t pos, const uint32_t value)
+{
+  (*out)[pos] = static_cast<char>(value);
+  (*out)[pos + 1] = static_cast<char>(value >> 8);
+  (*out)[pos + 2] = static_cast<char>(value >> 16);
+  (*out)[pos + 3] = static_cast<char>(value >> 24);
+}
+
+[[nodiscard]] /* don't ignore return value */
+inline bool readU32(const std::string_view data, size_t* pos, uint32_t* value)
+{
+  if(*pos > data.size() || data.size() - *pos < 4) {
+    return false;
+  }
+  *value = static_cast<uint32_t>(static_cast<unsigned char>(data[*pos]))
+    | (static_cast<uint32_t>(static_cast<unsigned char>(data[*pos + 1])) << 8)
+    | (static_cast<uint32_t>(static_cast<unsigned char>(data[*pos + 2])) << 16)
+    | (static_cast<uint32_t>(static_cast<unsigned char>(data[*pos + 3])) << 24);
+  *pos += 4;
+  return true;
+}
+
+[[nodiscard]] /* don't ignore return value */
+inline bool readU64(const std::string_view data, size_t* pos, uint64_t* value)
+{
+  uint32_t lo = 0;
+  uint32_t hi = 0;
+  if(!readU32(data, pos, &lo) || !readU32(data, pos, &hi)) {
+    return false;
+  }
+  *value = static_cast<uint64_t>(lo) | (static_cast<uint64_t>(hi) << 32);
+  return true;
+}
+
+} // namespace sequence_export_internal
+
 /// \note expected to work with ordeded sequence without holes or duplication
 /// i.e. server snapshot generation using SequenceBuffer
 /// will store N last snapshots made by server
@@ -63,8 +129,12 @@ public:
     clear();
   }
 
-  void each(const EachCb& cb) {
-    DCHECK(cb);
+  /// \note prefer this overload on hot (per-tick) paths:
+  /// the callable type is visible to the compiler,
+  /// so the loop compiles down to direct (inlinable) calls
+  /// without `std::function` type erasure or allocation
+  template<typename Callable>
+  void each(Callable&& cb) {
     for(size_t i = 0; i < buffer_.size(); i++)
     {
       const bool has_value
@@ -75,6 +145,13 @@ public:
     }
   }
 
+  /// \note kept for callers that store the callback as |EachCb|;
+  /// overload resolution prefers the template above for lambdas
+  void each(const EachCb& cb) {
+    DCHECK(cb);
+    each<const EachCb&>(cb);
+  }
+
   size_t size() const {
     return buffer_.size();
   }
@@ -91,6 +168,25 @@ public:
     return latestTick_;
   }
 
+  /// \note use it to size per-player snapshot buffers
+  /// i.e. to choose |Size| based on real memory usage
+  // Estimates memory usage (in bytes) of the buffer itself
+  // plus heap allocations owned by stored values.
+  // Requires `base::trace_event::EstimateMemoryUsage(Type)`
+  // to be known (see base/trace_event/memory_usage_estimator.h);
+  // instantiated only when called.
+  size_t EstimateMemoryUsage() const
+  {
+    size_t usage = sizeof(*this);
+    for(size_t i = 0; i < buffer_.size(); i++)
+    {
+      if(sequences_[i].has_value()) {
+        usage += base::trace_event::EstimateMemoryUsage(buffer_[i]);
+      }
+    }
+    return usage;
+  }
+
   void setByTickNum(const Type& value, const TickNumType tickNum)
   {
     const size_t tickIndex = tickNumToBufferIndex(tickNum);
@@ -143,6 +239,66 @@ public:
     return true;
   }
 
+  /// \note late-joiner export: serializes the contiguous tick range
+  /// [firstTick, lastTick] into |out| in a single pass. Each snapshot
+  /// is encoded by |encode| directly into the destination buffer
+  /// behind a length prefix (no per-snapshot temporary buffer, no
+  /// second copy); framing is documented at
+  /// |sequence_export_internal| and walked back by
+  /// |forEachExportedSnapshot|.
+  /// |encode| must append the serialized form of one value, i.e. the
+  /// binary codec from basis/serializers.h for base::Value snapshots:
+  ///   [](const Snapshot& s, std::string* out) { appendBinary(s, out); }
+  /// \note appends to |out| (callers may batch several exports);
+  /// on failure |out| is restored to its original size
+  /// \note returns false when any tick of the range is not resident
+  /// (never written, already overwritten, or wider than the ring)
+  template<typename Encoder>
+  [[nodiscard]] /* don't ignore return value */
+  bool exportRange(
+    const TickNumType firstTick
+    , const TickNumType lastTick
+    , std::string* out
+    , Encoder&& encode) const
+  {
+    using namespace sequence_export_internal;
+
+    DCHECK(out);
+    DCHECK(firstTick > 0);
+    DCHECK(firstTick <= lastTick);
+
+    const TickNumType count = lastTick - firstTick + 1;
+    if(count > buffer_.size()) {
+      // the ring can not hold that many consecutive ticks
+      return false;
+    }
+
+    const size_t rollbackSize = out->size();
+    appendU64(out, firstTick);
+    appendU32(out, static_cast<uint32_t>(count));
+
+    for(TickNumType tick = firstTick; tick <= lastTick; ++tick)
+    {
+      const size_t tickIndex = tickNumToBufferIndex(tick);
+      if(!sequences_[tickIndex].has_value()
+         || sequences_[tickIndex].value() != tick)
+      {
+        out->resize(rollbackSize);
+        return false;
+      }
+
+      // length prefix is patched after the in-place encode
+      const size_t sizePos = out->size();
+      appendU32(out, 0);
+      encode(buffer_[tickIndex], out);
+      const size_t payloadSize = out->size() - sizePos - 4;
+      DCHECK(payloadSize <= std::numeric_limits<uint32_t>::max());
+      patchU32(out, sizePos, static_cast<uint32_t>(payloadSize));
+    }
+
+    return true;
+  }
+
   [[nodiscard]] /* don't ignore return value */
   size_t tickNumToBufferIndex(const TickNumType tickNum) const
   {
@@ -169,4 +325,644 @@ private:
   std::array<Type, Size> buffer_{};
 };
 
+/// \note walks a blob produced by |SequenceBuffer::exportRange|,
+/// calling |cb(tickNum, payload)| once per snapshot (in tick order,
+/// tick numbers reconstructed from the header since the exported
+/// range is contiguous); |payload| is a view into |blob|, so it must
+/// not outlive the blob
+/// \note returns false when the blob is truncated or malformed
+/// (callers must treat the blob as untrusted network input)
+template<typename Callable>
+[[nodiscard]] /* don't ignore return value */
+bool forEachExportedSnapshot(
+  const std::string_view blob
+  , Callable&& cb)
+{
+  using namespace sequence_export_internal;
+
+  size_t pos = 0;
+
+  uint64_t firstTick = 0;
+  uint32_t count = 0;
+  if(!readU64(blob, &pos, &firstTick)
+     || !readU32(blob, &pos, &count))
+  {
+    return false;
+  }
+
+  for(uint32_t i = 0; i < count; ++i)
+  {
+    uint32_t payloadSize = 0;
+    if(!readU32(blob, &pos, &payloadSize)
+       || blob.size() - pos < payloadSize)
+    {
+      return false;
+    }
+
+    cb(static_cast<TickNumType>(firstTick + i)
+       , blob.substr(pos, payloadSize));
+    pos += payloadSize;
+  }
+
+  // trailing bytes mean a framing bug somewhere
+  return pos == blob.size();
+}
+
+/// \note caches the most recently exported tick range so a burst of
+/// late joiners asking for the same baseline shares ONE encoded blob
+/// (shared_ptr to an immutable string) instead of re-encoding the
+/// range per client; the blob stays valid while any joiner holds the
+/// shared_ptr, even after the cache moves on to a newer range
+/// \note NOT thread-safe, same as the sequence buffers it fronts
+/// (confine to the simulation sequence)
+class ExportedRangeCache {
+public:
+  ExportedRangeCache() = default;
+
+  /// \note returns the cached blob when [firstTick, lastTick] matches
+  /// the previous call, otherwise exports the range from |buffer| via
+  /// |encode| (see |SequenceBuffer::exportRange|) and caches it;
+  /// returns nullptr when the export fails (range not resident)
+  template<typename Buffer, typename Encoder>
+  [[nodiscard]] /* don't ignore return value */
+  std::shared_ptr<const std::string> getOrExport(
+    const Buffer& buffer
+    , const TickNumType firstTick
+    , const TickNumType lastTick
+    , Encoder&& encode)
+  {
+    if(blob_
+       && firstTick_ == firstTick
+       && lastTick_ == lastTick)
+    {
+      return blob_;
+    }
+
+    std::shared_ptr<std::string> blob
+      = std::make_shared<std::string>();
+    if(!buffer.exportRange(
+         firstTick, lastTick, blob.get()
+         , std::forward<Encoder>(encode)))
+    {
+      return nullptr;
+    }
+
+    firstTick_ = firstTick;
+    lastTick_ = lastTick;
+    blob_ = std::move(blob);
+    return blob_;
+  }
+
+  /// \note call when cached ticks get overwritten in the backing
+  /// buffer (i.e. on reset), so stale ranges are never served
+  void invalidate()
+  {
+    blob_ = nullptr;
+  }
+
+private:
+  TickNumType firstTick_ = 0;
+  TickNumType lastTick_ = 0;
+
+  std::shared_ptr<const std::string> blob_;
+};
+
+/// \note expected to work with ordeded sequence without holes or duplication,
+/// same as SequenceBuffer
+/// \note use when per-tick scans read only a small fixed part of each
+/// stored value (i.e. ~2 KB snapshots whose reconciliation sweep reads
+/// a 16-byte header): values are split structure-of-arrays style into
+/// a contiguous array of user-declared headers (hot) and an array of
+/// full values (cold), so header-only sweeps via |eachHeader| touch
+/// Size * sizeof(HeaderType) bytes instead of dragging whole values
+/// through cache
+//
+// ExtractHeader must be callable as:
+//   HeaderType operator()(const Type& value)
+//
+/// \note keep HeaderType small (it is copied on every setByTickNum
+/// and the whole point is packing many of them per cache line)
+template<typename Type, typename HeaderType
+  , TickBufferSizeType Size
+  , typename ExtractHeader>
+class SoASequenceBuffer {
+public:
+  typedef std::function<
+    void(const Type&, const TickNumType&)
+  > EachCb;
+
+  typedef std::function<
+    void(const HeaderType&, const TickNumType&)
+  > EachHeaderCb;
+
+public:
+  SoASequenceBuffer() {
+    clear();
+  }
+
+  /// \note visits full values, same as SequenceBuffer::each;
+  /// prefer |eachHeader| on per-tick paths that only need headers
+  template<typename Callable>
+  void each(Callable&& cb) {
+    for(size_t i = 0; i < buffer_.size(); i++)
+    {
+      const bool has_value
+        = sequences_[i].has_value();
+      if(has_value) {
+        cb(buffer_[i], sequences_[i].value());
+      }
+    }
+  }
+
+  /// \note kept for callers that store the callback as |EachCb|;
+  /// overload resolution prefers the template above for lambdas
+  void each(const EachCb& cb) {
+    DCHECK(cb);
+    each<const EachCb&>(cb);
+  }
+
+  /// \note the hot sweep: walks only |headers_| and |sequences_|,
+  /// never touching the bulk |buffer_| array
+  template<typename Callable>
+  void eachHeader(Callable&& cb) {
+    for(size_t i = 0; i < headers_.size(); i++)
+    {
+      const bool has_value
+        = sequences_[i].has_value();
+      if(has_value) {
+        cb(headers_[i], sequences_[i].value());
+      }
+    }
+  }
+
+  /// \note kept for callers that store the callback as |EachHeaderCb|
+  void eachHeader(const EachHeaderCb& cb) {
+    DCHECK(cb);
+    eachHeader<const EachHeaderCb&>(cb);
+  }
+
+  size_t size() const {
+    return buffer_.size();
+  }
+
+  void clear()
+  {
+    for (size_t i = 0; i < sequences_.size(); ++i) {
+      sequences_[i] = std::nullopt;
+    }
+    latestTick_ = 0;
+  }
+
+  TickNumType latestTick() const noexcept
+  {
+    return latestTick_;
+  }
+
+  // Estimates memory usage (in bytes), see
+  // SequenceBuffer::EstimateMemoryUsage for requirements.
+  size_t EstimateMemoryUsage() const
+  {
+    size_t usage = sizeof(*this);
+    for(size_t i = 0; i < buffer_.size(); i++)
+    {
+      if(sequences_[i].has_value()) {
+        usage += base::trace_event::EstimateMemoryUsage(buffer_[i]);
+      }
+    }
+    return usage;
+  }
+
+  void setByTickNum(const Type& value, const TickNumType tickNum)
+  {
+    const size_t tickIndex = tickNumToBufferIndex(tickNum);
+
+    DCHECK(tickIndex >= 0);
+    DCHECK(tickIndex < buffer_.size());
+    headers_[tickIndex] = extract_(value);
+    buffer_[tickIndex] = value;
+    sequences_[tickIndex] = tickNum;
+    if(tickNum > latestTick_) {
+      latestTick_ = tickNum;
+    }
+  }
+
+  [[nodiscard]] /* don't ignore return value */
+  bool hasValue(TickNumType tickNum) const
+  {
+    const size_t tickIndex = tickNumToBufferIndex(tickNum);
+
+    const bool has_value
+      = sequences_[tickIndex].has_value();
+
+    // if we have value, than we expect valid seq. num.
+    DCHECK(has_value
+      ? (sequences_[tickIndex].value() == tickNum)
+      : true)
+      << " something went wrong for tickIndex = "
+      << tickIndex;
+
+    return has_value;
+  }
+
+  [[nodiscard]] /* don't ignore return value */
+  bool tryGetValue(TickNumType tickNum, Type* result)
+  {
+    const size_t tickIndex = tickNumToBufferIndex(tickNum);
+    DCHECK(tickIndex >= 0);
+    DCHECK(tickIndex < buffer_.size());
+    *result = buffer_[tickIndex];
+
+    if(!sequences_[tickIndex].has_value()
+       // if we have value, than we expect valid seq. num.
+       || sequences_[tickIndex].value() != tickNum)
+    {
+      DCHECK(false)
+        << " something went wrong for tickIndex = "
+        << tickIndex;
+      return false;
+    }
+
+    return true;
+  }
+
+  /// \note reads only the header array, not the bulk payload
+  [[nodiscard]] /* don't ignore return value */
+  bool tryGetHeader(TickNumType tickNum, HeaderType* result) const
+  {
+    const size_t tickIndex = tickNumToBufferIndex(tickNum);
+    DCHECK(tickIndex >= 0);
+    DCHECK(tickIndex < headers_.size());
+
+    if(!sequences_[tickIndex].has_value()
+       || sequences_[tickIndex].value() != tickNum)
+    {
+      return false;
+    }
+
+    *result = headers_[tickIndex];
+    return true;
+  }
+
+  [[nodiscard]] /* don't ignore return value */
+  size_t tickNumToBufferIndex(const TickNumType tickNum) const
+  {
+    /// \note tickNum must start from 1
+    DCHECK(tickNum > 0);
+    DCHECK(tickNum < std::numeric_limits<TickNumType>::max());
+
+    const TickNumType tickIndex = tickNum % buffer_.size();
+    return tickIndex;
+  }
+
+private:
+  TickNumType latestTick_ = 0;
+
+  ExtractHeader extract_{};
+
+  std::array<std::optional<TickNumType>, Size> sequences_{};
+  // hot: scanned every tick, packed apart from the payloads
+  std::array<HeaderType, Size> headers_{};
+  // cold: only touched by full-value reads and writes
+  std::array<Type, Size> buffer_{};
+};
+
+/// \note expected to work with ordeded sequence without holes or duplication,
+/// same as SequenceBuffer
+/// \note use when full per-tick values dominate memory
+/// (i.e. server snapshots for many players):
+/// only every KeyframeInterval-th tick stores a full value (keyframe),
+/// other ticks store DeltaType produced by |Diff| against the prev. tick
+/// and are reconstructed on demand by applying |Patch| forward
+/// from the nearest keyframe
+/// \note reconstruction costs up to (KeyframeInterval - 1) patches,
+/// which is fine because mapping tick num. to value
+/// is not frequent operation (see note on SequenceBuffer)
+//
+// Diff must be callable as:
+//   DeltaType operator()(const Type& base, const Type& next)
+// Patch must be callable as:
+//   Type operator()(const Type& base, const DeltaType& delta)
+//
+/// \note keep DeltaType small (heap-backed list of changed entities etc.),
+/// the ring stores max(sizeof(Type), sizeof(DeltaType)) per slot inline
+template<typename Type, typename DeltaType
+  , TickBufferSizeType Size
+  , TickBufferSizeType KeyframeInterval
+  , typename Diff, typename Patch>
+class DeltaSequenceBuffer {
+  // a keyframe must still be resident in the ring
+  // when walking back from any live tick
+  static_assert(KeyframeInterval >= 1 && KeyframeInterval <= Size
+    , "KeyframeInterval must be in [1, Size]");
+
+public:
+  DeltaSequenceBuffer() {
+    clear();
+  }
+
+  size_t size() const {
+    return slots_.size();
+  }
+
+  void clear()
+  {
+    for (size_t i = 0; i < sequences_.size(); ++i) {
+      sequences_[i] = std::nullopt;
+      slots_[i] = std::monostate{};
+    }
+    latestTick_ = 0;
+  }
+
+  TickNumType latestTick() const noexcept
+  {
+    return latestTick_;
+  }
+
+  void setByTickNum(const Type& value, const TickNumType tickNum)
+  {
+    const size_t tickIndex = tickNumToBufferIndex(tickNum);
+
+    DCHECK(tickIndex >= 0);
+    DCHECK(tickIndex < slots_.size());
+
+    const bool isKeyframe
+      = (tickNum % KeyframeInterval == 0)
+      // first value and gaps (dropped ticks, out-of-order writes)
+      // force a keyframe: a delta would have no base to patch against
+      || latestTick_ == 0
+      || tickNum != latestTick_ + 1;
+
+    if(isKeyframe) {
+      slots_[tickIndex] = value;
+    } else {
+      slots_[tickIndex] = diff_(lastValue_, value);
+    }
+    sequences_[tickIndex] = tickNum;
+    lastValue_ = value;
+    if(tickNum > latestTick_) {
+      latestTick_ = tickNum;
+    }
+  }
+
+  [[nodiscard]] /* don't ignore return value */
+  bool hasValue(TickNumType tickNum) const
+  {
+    const size_t tickIndex = tickNumToBufferIndex(tickNum);
+
+    return sequences_[tickIndex].has_value()
+      // if we have value, than we expect valid seq. num.
+      && sequences_[tickIndex].value() == tickNum;
+  }
+
+  /// \note reconstructs delta-stored ticks by patching forward
+  /// from the nearest keyframe, so unlike SequenceBuffer::tryGetValue
+  /// this is not a plain array read
+  [[nodiscard]] /* don't ignore return value */
+  bool tryGetValue(TickNumType tickNum, Type* result) const
+  {
+    if(!hasValue(tickNum)) {
+      return false;
+    }
+
+    // walk back to the nearest keyframe
+    TickNumType keyTick = tickNum;
+    while(!std::holds_alternative<Type>(slots_[tickNumToBufferIndex(keyTick)]))
+    {
+      if(keyTick <= 1
+         || !hasValue(keyTick - 1))
+      {
+        // base of the delta chain was dropped or overwritten
+        return false;
+      }
+      --keyTick;
+    }
+
+    Type value = std::get<Type>(slots_[tickNumToBufferIndex(keyTick)]);
+    // patch forward up to the requested tick
+    for(TickNumType tick = keyTick + 1; tick <= tickNum; ++tick)
+    {
+      value = patch_(value
+        , std::get<DeltaType>(slots_[tickNumToBufferIndex(tick)]));
+    }
+    *result = std::move(value);
+    return true;
+  }
+
+  /// \note use it to compare against a plain SequenceBuffer
+  /// when deciding whether delta storage pays off for |Type|
+  // Estimates memory usage (in bytes), see
+  // SequenceBuffer::EstimateMemoryUsage for requirements.
+  size_t EstimateMemoryUsage() const
+  {
+    size_t usage = sizeof(*this);
+    for(size_t i = 0; i < slots_.size(); i++)
+    {
+      if(const Type* keyframe = std::get_if<Type>(&slots_[i])) {
+        usage += base::trace_event::EstimateMemoryUsage(*keyframe);
+      } else if(const DeltaType* delta = std::get_if<DeltaType>(&slots_[i])) {
+        usage += base::trace_event::EstimateMemoryUsage(*delta);
+      }
+    }
+    return usage;
+  }
+
+  [[nodiscard]] /* don't ignore return value */
+  size_t tickNumToBufferIndex(const TickNumType tickNum) const
+  {
+    /// \note tickNum must start from 1
+    DCHECK(tickNum > 0);
+    DCHECK(tickNum < std::numeric_limits<TickNumType>::max());
+
+    const TickNumType tickIndex = tickNum % slots_.size();
+    return tickIndex;
+  }
+
+private:
+  typedef std::variant<std::monostate, Type, DeltaType> SlotType;
+
+  TickNumType latestTick_ = 0;
+
+  // most recently inserted full value;
+  // keeps sequential appends O(1) (diff against the cache,
+  // no reconstruction of the prev. tick)
+  Type lastValue_{};
+
+  Diff diff_{};
+  Patch patch_{};
+
+  std::array<std::optional<TickNumType>, Size> sequences_{};
+  std::array<SlotType, Size> slots_{};
+};
+
+/// \note use when many identical buffer instances churn together
+/// i.e. one SequenceBuffer<Snapshot, 64> per connected player:
+/// per-player `new` scatters thousands of instances across the heap,
+/// so the per-tick all-players sweep chases pointers and mass
+/// disconnects pay one deallocation per player
+//
+// carves all instances out of ONE contiguous block:
+// 1) acquire() placement-news a buffer into a recycled slot
+//    (lowest free index first, so live buffers stay packed
+//    towards the front of the block)
+// 2) release() destroys it and recycles the slot
+// 3) releaseAll() tears down every live buffer with only a
+//    destructor call each - the block itself is never freed
+//    until the pool dies
+//
+// BufferType may be any of the buffer variants above
+// (SequenceBuffer, SoASequenceBuffer, DeltaSequenceBuffer)
+template<typename BufferType>
+class SequenceBufferPool {
+public:
+  typedef std::function<
+    void(BufferType&)
+  > EachCb;
+
+public:
+  /// \note the whole block is allocated up-front;
+  /// |capacity| is the hard cap on simultaneously live buffers
+  explicit SequenceBufferPool(size_t capacity)
+    : capacity_(capacity)
+    , storage_(static_cast<BufferType*>(
+        ::operator new(sizeof(BufferType) * capacity
+          , std::align_val_t(alignof(BufferType)))))
+  {
+    DCHECK(capacity > 0);
+    live_.resize(capacity, false);
+    freeSlots_.reserve(capacity);
+    // popped from the back, so push high indices first
+    // and acquire() hands out low indices first
+    for(size_t i = capacity; i > 0; i--) {
+      freeSlots_.push_back(i - 1);
+    }
+  }
+
+  SequenceBufferPool(const SequenceBufferPool&) = delete;
+  SequenceBufferPool& operator=(const SequenceBufferPool&) = delete;
+
+  ~SequenceBufferPool()
+  {
+    releaseAll();
+    ::operator delete(storage_
+      , std::align_val_t(alignof(BufferType)));
+  }
+
+  /// \note returns nullptr when all |capacity| slots are live
+  [[nodiscard]] /* don't ignore return value */
+  BufferType* acquire()
+  {
+    if(freeSlots_.empty()) {
+      return nullptr;
+    }
+    const size_t slot = freeSlots_.back();
+    freeSlots_.pop_back();
+    DCHECK(!live_[slot]);
+    live_[slot] = true;
+    liveCount_++;
+    return new (storage_ + slot) BufferType();
+  }
+
+  /// \note |buffer| must have been returned by acquire() on this pool
+  void release(BufferType* buffer)
+  {
+    DCHECK(buffer);
+    const size_t slot = slotOf(buffer);
+    DCHECK(live_[slot]);
+    buffer->~BufferType();
+    live_[slot] = false;
+    DCHECK(liveCount_ > 0);
+    liveCount_--;
+    freeSlots_.push_back(slot);
+  }
+
+  /// \note mass disconnect: destroys every live buffer
+  /// (one destructor call each, no per-buffer deallocation)
+  /// and resets the free list
+  void releaseAll()
+  {
+    for(size_t i = 0; i < capacity_; i++)
+    {
+      if(live_[i]) {
+        (storage_ + i)->~BufferType();
+        live_[i] = false;
+      }
+    }
+    liveCount_ = 0;
+    freeSlots_.clear();
+    for(size_t i = capacity_; i > 0; i--) {
+      freeSlots_.push_back(i - 1);
+    }
+  }
+
+  /// \note the per-tick sweep: visits live buffers in slot order,
+  /// walking the contiguous block front to back
+  template<typename Callable>
+  void each(Callable&& cb)
+  {
+    for(size_t i = 0; i < capacity_; i++)
+    {
+      if(live_[i]) {
+        cb(*(storage_ + i));
+      }
+    }
+  }
+
+  /// \note kept for callers that store the callback as |EachCb|;
+  /// overload resolution prefers the template above for lambdas
+  void each(const EachCb& cb) {
+    DCHECK(cb);
+    each<const EachCb&>(cb);
+  }
+
+  size_t liveCount() const noexcept
+  {
+    return liveCount_;
+  }
+
+  size_t capacity() const noexcept
+  {
+    return capacity_;
+  }
+
+  // Estimates memory usage (in bytes), see
+  // SequenceBuffer::EstimateMemoryUsage for requirements.
+  size_t EstimateMemoryUsage() const
+  {
+    size_t usage = sizeof(*this)
+      + sizeof(BufferType) * capacity_
+      + freeSlots_.capacity() * sizeof(size_t)
+      + live_.capacity() / CHAR_BIT;
+    for(size_t i = 0; i < capacity_; i++)
+    {
+      if(live_[i]) {
+        // subtract the inline part already counted via the block
+        usage += (storage_ + i)->EstimateMemoryUsage()
+          - sizeof(BufferType);
+      }
+    }
+    return usage;
+  }
+
+private:
+  [[nodiscard]] /* don't ignore return value */
+  size_t slotOf(const BufferType* buffer) const
+  {
+    DCHECK(buffer >= storage_);
+    DCHECK(buffer < storage_ + capacity_);
+    return static_cast<size_t>(buffer - storage_);
+  }
+
+  const size_t capacity_;
+
+  BufferType* const storage_;
+
+  size_t liveCount_ = 0;
+
+  // per-slot liveness; drives the sweep and releaseAll()
+  std::vector<bool> live_{};
+
+  // recycled slot indices, popped from the back
+  std::vector<size_t> freeSlots_{};
+};
+
 } // namespace backend
@@ -15,9 +15,12 @@
 #include "base/task/post_task.h"
 #include "base/task/task_executor.h"
 #include "base/threading/platform_thread.h"
+#include "base/threading/thread.h"
 #include "base/time/time.h"
 #include "build/build_config.h"
 
+#include "basis/promise/post_promise.h"
+
 namespace application {
 
 namespace {
@@ -68,6 +71,30 @@ const char* getAppRunnerName(AppRunners::ID identifier)
   return "Unknown Thread";
 }
 
+// Runs as the first task on a freshly spawned runner thread: by the
+// time it executes the message loop is live. Also pre-faults a chunk
+// of stack so early real tasks do not pay those page faults.
+void warmupRunner(AppRunners::ID identifier)
+{
+  volatile char stack_probe[16 * 1024];
+  stack_probe[0] = 0;
+  stack_probe[sizeof(stack_probe) - 1] = 0;
+
+  DVLOG(9)
+    << "runner ready: "
+    << getAppRunnerName(identifier);
+}
+
+// Warmup variant that first applies the runner's OS scheduling, so
+// every real task already runs at the configured priority.
+void warmupRunnerWithScheduling(
+  AppRunners::ID identifier
+  , basis::ThreadSchedulingConfig scheduling)
+{
+  basis::applyCurrentThreadScheduling(scheduling);
+  warmupRunner(identifier);
+}
+
 }  // namespace
 
 // static
@@ -148,4 +175,61 @@ bool runOrPostTaskOn(const base::Location& location
     ->PostTask(location, std::move(task));
 }
 
+AppRunnersReadiness::AppRunnersReadiness() = default;
+
+AppRunnersReadiness::AppRunnersReadiness(AppRunnersReadiness&&) = default;
+
+AppRunnersReadiness&
+AppRunnersReadiness::operator=(AppRunnersReadiness&&) = default;
+
+AppRunnersReadiness::~AppRunnersReadiness() = default;
+
+AppRunnersReadiness startAppRunnersInParallel(
+  const base::Location& location
+  , const std::vector<AppRunners::ID>& ids)
+{
+  // All runners keep inherited scheduling.
+  return startAppRunnersInParallel(
+    location
+    , ids
+    , std::vector<basis::ThreadSchedulingConfig>(ids.size()));
+}
+
+AppRunnersReadiness startAppRunnersInParallel(
+  const base::Location& location
+  , const std::vector<AppRunners::ID>& ids
+  , const std::vector<basis::ThreadSchedulingConfig>& scheduling)
+{
+  DCHECK_EQ(ids.size(), scheduling.size());
+
+  AppRunnersReadiness readiness;
+  readiness.perRunner.reserve(ids.size());
+
+  // Spawn every thread before waiting on any of them;
+  // base::Thread::StartWithOptions() returns without blocking on the
+  // thread main, so the OS brings them up concurrently.
+  for (size_t i = 0; i < ids.size(); ++i) {
+    const AppRunners::ID identifier = ids[i];
+
+    // Lives for the whole process, like the task runner slots.
+    base::Thread* thread = new base::Thread(getAppRunnerName(identifier));
+    CHECK(thread->StartWithOptions(base::Thread::Options()));
+
+    AppRunners::setTaskRunner(identifier, thread->task_runner());
+
+    readiness.perRunner.push_back(
+      base::PostPromise(location
+        , thread->task_runner().get()
+        , scheduling[i].requiresSetup()
+            ? base::BindOnce(
+                &warmupRunnerWithScheduling, identifier, scheduling[i])
+            : base::BindOnce(&warmupRunner, identifier)));
+  }
+
+  readiness.allReady
+    = base::Promises::All(location, readiness.perRunner);
+
+  return readiness;
+}
+
 }  // namespace application
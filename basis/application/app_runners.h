@@ -3,6 +3,7 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "base/callback.h"
 #include "base/location.h"
@@ -16,6 +17,9 @@
 #include "base/threading/thread_checker.h"
 #include "base/time/time.h"
 
+#include "basis/promise/promise.h"
+#include "basis/thread_pool_util.hpp" // for basis::ThreadSchedulingConfig
+
 // Use DCHECK_CURRENTLY_ON_RUNNER(AppRunner::ID) to assert that a function can only
 // be called on the named AppRunner.
 #define DCHECK_CURRENTLY_ON_RUNNER(identifier)                              \
@@ -117,4 +121,50 @@ bool runOrPostTaskOn(const base::Location& location
   , AppRunners::ID id
   , base::OnceClosure task);
 
+// Readiness promises for a parallel runner bring-up; see
+// startAppRunnersInParallel().
+struct AppRunnersReadiness {
+  AppRunnersReadiness();
+  AppRunnersReadiness(AppRunnersReadiness&&);
+  AppRunnersReadiness& operator=(AppRunnersReadiness&&);
+  ~AppRunnersReadiness();
+
+  // |perRunner[i]| resolves once the runner for |ids[i]| (as passed to
+  // startAppRunnersInParallel) executed its warmup task, i.e. its
+  // thread is live. Dependents of a single runner chain off their
+  // entry instead of waiting for the rest.
+  std::vector<base::Promise<void, base::NoReject>> perRunner;
+
+  // Resolves once every requested runner is live.
+  base::Promise<void, base::NoReject> allReady;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(AppRunnersReadiness);
+};
+
+// Brings up one dedicated thread per id concurrently: all threads are
+// spawned before waiting on any of them, so the spawn plus first-task
+// warmup of N runners overlaps instead of adding up serially. Each
+// runner is registered via AppRunners::setTaskRunner immediately, and
+// a warmup task (which also pre-faults some stack) is posted as the
+// runner's first task.
+//
+// Must be called once, on the main thread, before any getTaskRunner()
+// for the given ids. The threads live for the whole process.
+AppRunnersReadiness startAppRunnersInParallel(
+  const base::Location& location
+  , const std::vector<AppRunners::ID>& ids);
+
+// Same, with per-runner OS scheduling: |scheduling[i]| is applied on
+// the thread for |ids[i]| as its very first task (before any real
+// work), so e.g. the FIXED_LOOP runner can be protected from
+// preemption by background load with SCHED_FIFO or a negative nice.
+// See basis::ThreadSchedulingConfig for privileges and fallback; the
+// runner's readiness promise resolves only after its scheduling was
+// applied (or fell back).
+AppRunnersReadiness startAppRunnersInParallel(
+  const base::Location& location
+  , const std::vector<AppRunners::ID>& ids
+  , const std::vector<basis::ThreadSchedulingConfig>& scheduling);
+
 }  // namespace application
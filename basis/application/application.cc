@@ -10,6 +10,50 @@ ApplicationObserver::ApplicationObserver() = default;
 
 ApplicationObserver::~ApplicationObserver() = default;
 
+bool
+  ApplicationObserver::shouldCoalesceNotifications() const
+{
+  return true;
+}
+
+void
+  ApplicationObserver::dispatchStateChange(
+    scoped_refptr<CoalescedNotificationState> shared
+    , int64_t generation
+    , const application::ApplicationState state)
+{
+  if (shouldCoalesceNotifications()) {
+    if (generation
+        != shared->state_generation.load(std::memory_order_acquire))
+    {
+      // Stale: a newer delivery task is already queued behind this
+      // one and will carry the latest state.
+      return;
+    }
+    onStateChange(shared->latest_state.load(std::memory_order_relaxed));
+    return;
+  }
+  onStateChange(state);
+}
+
+void
+  ApplicationObserver::dispatchFocusChange(
+    scoped_refptr<CoalescedNotificationState> shared
+    , int64_t generation
+    , const bool has_focus)
+{
+  if (shouldCoalesceNotifications()) {
+    if (generation
+        != shared->focus_generation.load(std::memory_order_acquire))
+    {
+      return;
+    }
+    onFocusChange(shared->latest_focus.load(std::memory_order_relaxed));
+    return;
+  }
+  onFocusChange(has_focus);
+}
+
 #define STATE_STRING(state)                                             \
   base::StringPrintf("%s (%d)", \
     application::GetApplicationStateString(state), \
@@ -17,6 +61,7 @@ ApplicationObserver::~ApplicationObserver() = default;
 
 Application::Application()
   : observers_(new base::ObserverListThreadSafe<ApplicationObserver>())
+  , coalescing_(new CoalescedNotificationState())
   , app_loaded_(base::WaitableEvent::ResetPolicy::MANUAL,
                 base::WaitableEvent::InitialState::NOT_SIGNALED)
 {
@@ -38,8 +83,17 @@ void
 {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
 
+  // Publish the value before the generation: a delivery task that
+  // observes the new generation also observes the new state.
+  coalescing_->latest_state.store(state, std::memory_order_relaxed);
+  const int64_t generation
+    = coalescing_->state_generation.fetch_add(
+        1, std::memory_order_release) + 1;
+
   observers_->Notify(FROM_HERE
-    , &ApplicationObserver::onStateChange
+    , &ApplicationObserver::dispatchStateChange
+    , coalescing_
+    , generation
     , state);
 }
 
@@ -49,8 +103,15 @@ void
 {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
 
+  coalescing_->latest_focus.store(has_focus, std::memory_order_relaxed);
+  const int64_t generation
+    = coalescing_->focus_generation.fetch_add(
+        1, std::memory_order_release) + 1;
+
   observers_->Notify(FROM_HERE
-    , &ApplicationObserver::onFocusChange
+    , &ApplicationObserver::dispatchFocusChange
+    , coalescing_
+    , generation
     , has_focus);
 }
 
@@ -122,9 +183,16 @@ void
   application_state_ = state;
   DCHECK(application_state_ != application::kApplicationStateTotal);
 
+  const bool has_focus = HasFocus(application_state_);
+
+  // Publish the pair for lock-free pollers (snapshotState()) before
+  // any observer hears about the transition.
+  snapshot_.store(
+    packSnapshot(application_state_, has_focus)
+    , std::memory_order_release);
+
   notifyStateChange(application_state_);
 
-  const bool has_focus = HasFocus(application_state_);
   const bool focus_changed = has_focus != old_has_focus;
 
   if (focus_changed) {
@@ -277,4 +345,27 @@ ApplicationState
   return application_state_;
 }
 
+uint32_t
+  Application::packSnapshot(
+    application::ApplicationState state
+    , bool has_focus) noexcept
+{
+  return (static_cast<uint32_t>(state) << 1)
+         | (has_focus ? 1u : 0u);
+}
+
+Application::StateSnapshot
+  Application::snapshotState()
+    const
+    noexcept
+{
+  const uint32_t packed
+    = snapshot_.load(std::memory_order_acquire);
+  StateSnapshot snapshot;
+  snapshot.state
+    = static_cast<application::ApplicationState>(packed >> 1);
+  snapshot.has_focus = (packed & 1u) != 0;
+  return snapshot;
+}
+
 } // namespace application
@@ -6,12 +6,36 @@
 
 #include <base/macros.h>
 #include <base/logging.h>
+#include <base/memory/ref_counted.h>
 #include <base/sequenced_task_runner.h>
 #include <base/observer_list_threadsafe.h>
 #include <base/synchronization/waitable_event.h>
 
+#include <atomic>
+#include <cstdint>
+
 namespace application {
 
+// Shared between |Application| and the per-observer notification
+// tasks posted by ObserverListThreadSafe: the latest published
+// state/focus and monotonically growing generations. A delivery task
+// whose generation is no longer the latest is stale — a newer task
+// carrying the newer value is already queued behind it — and gets
+// dropped for coalescing observers.
+struct CoalescedNotificationState
+  : public base::RefCountedThreadSafe<CoalescedNotificationState> {
+  std::atomic<int64_t> state_generation{0};
+  std::atomic<application::ApplicationState> latest_state{
+    application::kApplicationStatePreloading};
+
+  std::atomic<int64_t> focus_generation{0};
+  std::atomic<bool> latest_focus{false};
+
+ private:
+  friend class base::RefCountedThreadSafe<CoalescedNotificationState>;
+  ~CoalescedNotificationState() = default;
+};
+
 class ApplicationObserver {
  public:
   ApplicationObserver();
@@ -31,6 +55,28 @@ class ApplicationObserver {
         const bool has_focus)
           = 0;
 
+  // Coalesced delivery (the default): a burst of rapid transitions
+  // collapses into one onStateChange/onFocusChange per observer
+  // thread, carrying the latest value. Observers that must see every
+  // intermediate edge override this to return false.
+  virtual
+    bool
+      shouldCoalesceNotifications() const;
+
+  // Invoked through ObserverListThreadSafe on the observer's own
+  // sequence; drops stale deliveries for coalescing observers.
+  void
+    dispatchStateChange(
+      scoped_refptr<CoalescedNotificationState> shared
+      , int64_t generation
+      , const application::ApplicationState state);
+
+  void
+    dispatchFocusChange(
+      scoped_refptr<CoalescedNotificationState> shared
+      , int64_t generation
+      , const bool has_focus);
+
   //virtual
   //  void
   //    onAppPause()
@@ -100,11 +146,33 @@ class Application {
   void
     signalOnLoad();
 
+  // Owner-sequence read of the current state (cheap, but only valid on
+  // the sequence that drives transitions). Cross-thread pollers use
+  // snapshotState().
   application::ApplicationState
     getApplicationState()
     const
     noexcept;
 
+  // One consistent (state, focus) pair, as last published by
+  // setApplicationState().
+  struct StateSnapshot {
+    application::ApplicationState state;
+    bool has_focus;
+  };
+
+  // Lock-free read path for per-frame polling (render/network threads
+  // deciding whether to throttle): a single wait-free atomic load,
+  // callable from any thread, never contending with the
+  // observer-notification writer. Both fields are packed into one word,
+  // so the pair is always consistent — no seqlock retry loop needed.
+  // The snapshot may trail a transition in progress by one publish;
+  // pollers re-read next frame anyway.
+  StateSnapshot
+    snapshotState()
+    const
+    noexcept;
+
   void
     setApplicationState(
       application::ApplicationState state);
@@ -119,6 +187,16 @@ private:
   application::ApplicationState application_state_
     = application::kApplicationStatePreloading;
 
+  static uint32_t packSnapshot(
+    application::ApplicationState state
+    , bool has_focus) noexcept;
+
+  // (state, focus) packed into one word - bit 0 focus, the rest state -
+  // so cross-thread pollers read a consistent pair with one load.
+  // Written only on the owner sequence by setApplicationState().
+  std::atomic<uint32_t> snapshot_{
+    packSnapshot(application::kApplicationStatePreloading, false)};
+
   friend class ApplicationObserver;
 
   /// \note ObserverListThreadSafe may be ued from multiple threads
@@ -126,6 +204,9 @@ private:
       base::ObserverListThreadSafe<ApplicationObserver>
     > observers_;
 
+  // Latest state/focus plus generations for stale-delivery dropping.
+  const scoped_refptr<CoalescedNotificationState> coalescing_;
+
   base::WaitableEvent app_loaded_;
 
   DISALLOW_COPY_AND_ASSIGN(Application);
@@ -10,6 +10,9 @@
 #include <base/files/file_util.h>
 #include <base/files/file_path.h>
 
+#include <atomic>
+#include <memory>
+
 namespace {
 
 static base::FilePath GetOrCreateDirectory(application::paths::AppPathId path_id)
@@ -29,6 +32,67 @@ static base::FilePath GetOrCreateDirectory(application::paths::AppPathId path_id
   return base::FilePath();
 }
 
+// Every AppPathId resolved (and its directory ensured) exactly once.
+// AppGetPath re-derives paths on each call — readlink("/proc/self/exe"),
+// string assembly, mkdir — which is wasteful for code that queries
+// paths thousands of times during startup. Results never change within
+// a process (the temp dir is keyed by pid, not time), so they are safe
+// to resolve once and treat as immutable.
+struct ResolvedAppPaths {
+  base::FilePath debug_out;
+  base::FilePath test_out;
+  // Content directory with the "web" subdirectory already created.
+  base::FilePath web_root;
+};
+
+// Lazily builds the table behind an atomic pointer: after the first
+// query a lookup is one acquire-load plus a FilePath copy, with no
+// filesystem traffic. Racing initializers both build a table; the
+// loser discards its copy and uses the winner's.
+const ResolvedAppPaths* GetResolvedAppPaths()
+{
+  static std::atomic<const ResolvedAppPaths*> cache{nullptr};
+
+  const ResolvedAppPaths* existing
+    = cache.load(std::memory_order_acquire);
+  if (existing) {
+    return existing;
+  }
+
+  std::unique_ptr<ResolvedAppPaths> resolved
+    = std::make_unique<ResolvedAppPaths>();
+  resolved->debug_out
+    = GetOrCreateDirectory(
+        application::paths::kAppPathDebugOutputDirectory);
+  resolved->test_out
+    = GetOrCreateDirectory(
+        application::paths::kAppPathTestOutputDirectory);
+  base::FilePath content
+    = GetOrCreateDirectory(
+        application::paths::kAppPathContentDirectory);
+  if (!content.empty()) {
+    base::FilePath web_root = content.Append("web");
+    if (base::CreateDirectory(web_root)) {
+      resolved->web_root = web_root;
+    } else {
+      DLOG(ERROR)
+        << "Unable to create directory "
+        << web_root.value();
+      DCHECK(false);
+    }
+  }
+
+  const ResolvedAppPaths* expected = nullptr;
+  if (cache.compare_exchange_strong(
+        expected, resolved.get(), std::memory_order_acq_rel))
+  {
+    // Published; intentionally leaked for the process lifetime.
+    return resolved.release();
+  }
+  // Another thread won the race; use its table.
+  return expected;
+}
+
 }  // namespace
 
 namespace application {
@@ -39,54 +103,39 @@ bool PathProvider(int key, base::FilePath* result)
 {
   DCHECK(result);
 
+  const ResolvedAppPaths* resolved = GetResolvedAppPaths();
+
   switch (key) {
     case paths::DIR_APP_DEBUG_OUT: {
-      base::FilePath directory =
-          GetOrCreateDirectory(kAppPathDebugOutputDirectory);
-      if (!directory.empty()) {
-        *result = directory;
+      if (!resolved->debug_out.empty()) {
+        *result = resolved->debug_out;
         return true;
       } else {
         DLOG(ERROR)
-          << "Unable to get or create paths::DIR_APP_DEBUG_OUT "
-          << directory.value();
+          << "Unable to get or create paths::DIR_APP_DEBUG_OUT";
         return false;
       }
     }
 
     case paths::DIR_APP_TEST_OUT:
       {
-        base::FilePath directory =
-            GetOrCreateDirectory(kAppPathTestOutputDirectory);
-        if (!directory.empty()) {
-          *result = directory;
+        if (!resolved->test_out.empty()) {
+          *result = resolved->test_out;
           return true;
         } else {
           DLOG(ERROR)
-            << "Unable to get or create paths::DIR_APP_TEST_OUT "
-            << directory.value();
+            << "Unable to get or create paths::DIR_APP_TEST_OUT";
           return false;
         }
       }
 
     case paths::DIR_APP_WEB_ROOT: {
-      base::FilePath directory =
-          GetOrCreateDirectory(kAppPathContentDirectory);
-      if (!directory.empty()) {
-        *result = directory.Append("web");
-        const bool dir_created
-          = base::CreateDirectory(*result);
-        if(!dir_created){
-          DLOG(ERROR)
-            << "Unable to create directory "
-            << result->value();
-          DCHECK(false);
-        }
+      if (!resolved->web_root.empty()) {
+        *result = resolved->web_root;
         return true;
       } else {
         DLOG(ERROR)
-          << "Unable to get or create paths::DIR_APP_WEB_ROOT "
-          << directory.value();
+          << "Unable to get or create paths::DIR_APP_WEB_ROOT";
         return false;
       }
     }
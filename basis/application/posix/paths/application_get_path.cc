@@ -56,22 +56,38 @@ bool GetExecutablePath(char* out_path, int path_size) {
     return false;
   }
 
-  char path[kMaxPathSize + 1];
-  ssize_t bytes_read = readlink("/proc/self/exe", path, kMaxPathSize);
-  if (bytes_read < 1) {
+  struct CachedExePath {
+    char path[kMaxPathSize + 1];
+    ssize_t length;
+  };
+  // The executable path cannot change within a process, so the
+  // readlink happens once (thread-safe function-local static); every
+  // later call is a plain copy out of the cached buffer.
+  static const CachedExePath cached = [] {
+    CachedExePath resolved{};
+    resolved.length
+      = readlink("/proc/self/exe", resolved.path, kMaxPathSize);
+    if (resolved.length < 1) {
+      resolved.path[0] = '\0';
+    } else {
+      resolved.path[resolved.length] = '\0';
+    }
+    return resolved;
+  }();
+
+  if (cached.length < 1) {
     DCHECK(false);
     return false;
   }
 
-  path[bytes_read] = '\0';
-  if (bytes_read > path_size) {
+  if (cached.length > path_size) {
     DCHECK(false);
     return false;
   }
 
   /// \todo use base::strlcpy
   const int result = base::strings::SafeSNPrintf(
-    out_path, path_size, "%s", path);
+    out_path, path_size, "%s", cached.path);
   if (result < 1 || result > kMaxPathSize) {
     out_path[0] = '\0';
     DCHECK(false);
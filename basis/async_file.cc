@@ -0,0 +1,487 @@
+#include "basis/async_file.hpp"
+
+#include <base/bind.h>
+#include <base/files/file_util.h>
+#include <base/logging.h>
+#include <base/macros.h>
+#include <base/no_destructor.h>
+#include <base/sequenced_task_runner.h>
+#include <base/task/post_task.h>
+#include <base/task/task_traits.h>
+#include <build/build_config.h>
+
+#include <basis/promise/post_promise.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <utility>
+
+#if defined(OS_LINUX) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <base/posix/eintr_wrapper.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define BASIS_HAS_IO_URING 1
+#endif
+#endif // __has_include(<linux/io_uring.h>)
+#endif // defined(OS_LINUX) && defined(__has_include)
+
+namespace basis {
+
+namespace {
+
+// Traits match the persistence offload in SerializeJsonToFileAsync:
+// file work may block, is not latency-critical, and must not be
+// dropped at shutdown.
+scoped_refptr<base::SequencedTaskRunner> FileTaskRunner() {
+  static base::NoDestructor<scoped_refptr<base::SequencedTaskRunner>>
+      task_runner(base::CreateSequencedTaskRunnerWithTraits(
+          {base::MayBlock(), base::TaskPriority::BEST_EFFORT,
+           base::TaskShutdownBehavior::BLOCK_SHUTDOWN}));
+  return *task_runner;
+}
+
+#if defined(BASIS_HAS_IO_URING)
+
+// One file chunk per submission queue entry; 8 in-flight 256 KiB
+// chunks keep a disk busy while costing one enter syscall per batch.
+constexpr size_t kChunkSize = 256 * 1024;
+constexpr unsigned kQueueDepth = 8;
+
+int IoUringSetup(unsigned entries, struct io_uring_params* params) {
+  return static_cast<int>(
+      syscall(__NR_io_uring_setup, entries, params));
+}
+
+int IoUringEnter(int ring_fd,
+                 unsigned to_submit,
+                 unsigned min_complete,
+                 unsigned flags) {
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd,
+                                  to_submit, min_complete, flags,
+                                  nullptr, 0));
+}
+
+// Minimal raw-syscall ring (no liburing dependency, matching how the
+// rest of basis talks to Linux directly — see thread_pool_util's
+// sched/sysfs use). One ring per worker thread, created on first use
+// and torn down at thread exit; sequences never run concurrently on
+// one thread, so the ring needs no locking.
+class UringQueue {
+ public:
+  UringQueue() = default;
+
+  ~UringQueue() { Close(); }
+
+  bool Init() {
+    struct io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    ring_fd_ = IoUringSetup(kQueueDepth, &params);
+    if (ring_fd_ < 0) {
+      return false;
+    }
+
+    sq_ring_size_ =
+        params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = params.cq_off.cqes +
+                    params.cq_entries * sizeof(struct io_uring_cqe);
+
+    // Newer kernels map both rings in one region; size it to the
+    // larger of the two either way.
+    const bool single_mmap =
+        (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap && cq_ring_size_ > sq_ring_size_) {
+      sq_ring_size_ = cq_ring_size_;
+    }
+
+    sq_ring_ptr_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ring_fd_,
+                        IORING_OFF_SQ_RING);
+    if (sq_ring_ptr_ == MAP_FAILED) {
+      Close();
+      return false;
+    }
+    if (single_mmap) {
+      cq_ring_ptr_ = sq_ring_ptr_;
+    } else {
+      cq_ring_ptr_ = mmap(nullptr, cq_ring_size_,
+                          PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, ring_fd_,
+                          IORING_OFF_CQ_RING);
+      if (cq_ring_ptr_ == MAP_FAILED) {
+        cq_ring_ptr_ = nullptr;
+        Close();
+        return false;
+      }
+    }
+
+    sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    sqes_ = static_cast<struct io_uring_sqe*>(
+        mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES));
+    if (sqes_ == MAP_FAILED) {
+      sqes_ = nullptr;
+      Close();
+      return false;
+    }
+
+    char* sq_base = static_cast<char*>(sq_ring_ptr_);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq_base + params.sq_off.tail);
+    sq_mask_ =
+        reinterpret_cast<unsigned*>(sq_base + params.sq_off.ring_mask);
+    sq_array_ =
+        reinterpret_cast<unsigned*>(sq_base + params.sq_off.array);
+
+    char* cq_base = static_cast<char*>(cq_ring_ptr_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq_base + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq_base + params.cq_off.tail);
+    cq_mask_ =
+        reinterpret_cast<unsigned*>(cq_base + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<struct io_uring_cqe*>(
+        cq_base + params.cq_off.cqes);
+
+    return true;
+  }
+
+  bool IsValid() const { return ring_fd_ >= 0; }
+
+  // Queues one READV/WRITEV entry; |iov| must stay alive until the
+  // batch is reaped.
+  void QueueRw(uint8_t opcode,
+               int fd,
+               const struct iovec* iov,
+               uint64_t file_offset,
+               uint64_t user_data) {
+    const unsigned tail = *sq_tail_;
+    const unsigned index = tail & *sq_mask_;
+    struct io_uring_sqe* sqe = &sqes_[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->off = file_offset;
+    sqe->addr = reinterpret_cast<uint64_t>(iov);
+    sqe->len = 1;
+    sqe->user_data = user_data;
+    sq_array_[index] = index;
+    // Publish the new tail after the entry is fully written.
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    ++pending_;
+  }
+
+  // Submits everything queued and waits for all of it; calls
+  // |on_complete| with (user_data, res) per completion. Returns false
+  // on a submission failure (the batch is then in an unknown state and
+  // the caller should fall back to plain syscalls on a fresh attempt).
+  template <typename OnComplete>
+  bool SubmitAndWaitAll(OnComplete&& on_complete) {
+    unsigned to_reap = pending_;
+    pending_ = 0;
+    unsigned submitted = 0;
+    while (submitted < to_reap) {
+      const int rc = IoUringEnter(ring_fd_, to_reap - submitted,
+                                  to_reap - submitted,
+                                  IORING_ENTER_GETEVENTS);
+      if (rc < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        PLOG(WARNING) << "io_uring_enter failed";
+        return false;
+      }
+      submitted += static_cast<unsigned>(rc);
+    }
+
+    unsigned head = *cq_head_;
+    unsigned reaped = 0;
+    while (reaped < to_reap) {
+      const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+      while (head != tail && reaped < to_reap) {
+        const struct io_uring_cqe& cqe = cqes_[head & *cq_mask_];
+        on_complete(cqe.user_data, cqe.res);
+        ++head;
+        ++reaped;
+      }
+      __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+      if (reaped < to_reap) {
+        const int rc =
+            IoUringEnter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS);
+        if (rc < 0 && errno != EINTR) {
+          PLOG(WARNING) << "io_uring_enter (reap) failed";
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+ private:
+  void Close() {
+    if (sqes_) {
+      munmap(sqes_, sqes_size_);
+      sqes_ = nullptr;
+    }
+    if (cq_ring_ptr_ && cq_ring_ptr_ != sq_ring_ptr_) {
+      munmap(cq_ring_ptr_, cq_ring_size_);
+    }
+    cq_ring_ptr_ = nullptr;
+    if (sq_ring_ptr_) {
+      munmap(sq_ring_ptr_, sq_ring_size_);
+      sq_ring_ptr_ = nullptr;
+    }
+    if (ring_fd_ >= 0) {
+      close(ring_fd_);
+      ring_fd_ = -1;
+    }
+  }
+
+  int ring_fd_ = -1;
+  void* sq_ring_ptr_ = nullptr;
+  size_t sq_ring_size_ = 0;
+  void* cq_ring_ptr_ = nullptr;
+  size_t cq_ring_size_ = 0;
+  struct io_uring_sqe* sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+  unsigned* sq_tail_ = nullptr;
+  unsigned* sq_mask_ = nullptr;
+  unsigned* sq_array_ = nullptr;
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned* cq_mask_ = nullptr;
+  struct io_uring_cqe* cqes_ = nullptr;
+  unsigned pending_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(UringQueue);
+};
+
+// 0 = unprobed, 1 = available, -1 = unavailable. Probed by the first
+// ring creation; a kernel without the syscalls (ENOSYS) or a seccomp
+// policy denying them flips this to unavailable for the process.
+std::atomic<int> g_uring_state{0};
+
+UringQueue* ThreadUringQueue() {
+  if (g_uring_state.load(std::memory_order_relaxed) < 0) {
+    return nullptr;
+  }
+  static thread_local UringQueue t_ring;
+  if (!t_ring.IsValid()) {
+    if (!t_ring.Init()) {
+      LOG(WARNING)
+          << "io_uring unavailable; file I/O falls back to"
+          << " plain syscalls on the offload sequence";
+      g_uring_state.store(-1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    g_uring_state.store(1, std::memory_order_relaxed);
+  }
+  return &t_ring;
+}
+
+bool ReadWithUring(const base::FilePath& path, std::string* contents) {
+  UringQueue* ring = ThreadUringQueue();
+  if (!ring) {
+    return false;
+  }
+
+  const int fd =
+      HANDLE_EINTR(open(path.value().c_str(), O_RDONLY | O_CLOEXEC));
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+    close(fd);
+    return false;
+  }
+  const size_t size = static_cast<size_t>(st.st_size);
+  contents->resize(size);
+
+  bool ok = true;
+  size_t offset = 0;
+  struct iovec iovs[kQueueDepth];
+  while (ok && offset < size) {
+    unsigned chunks = 0;
+    size_t batch_offset = offset;
+    uint64_t chunk_offsets[kQueueDepth];
+    while (chunks < kQueueDepth && batch_offset < size) {
+      const size_t len = std::min(kChunkSize, size - batch_offset);
+      iovs[chunks].iov_base = &(*contents)[batch_offset];
+      iovs[chunks].iov_len = len;
+      chunk_offsets[chunks] = batch_offset;
+      ring->QueueRw(IORING_OP_READV, fd, &iovs[chunks], batch_offset,
+                    chunks);
+      batch_offset += len;
+      ++chunks;
+    }
+
+    if (!ring->SubmitAndWaitAll([&](uint64_t user_data, int32_t res) {
+          const unsigned chunk = static_cast<unsigned>(user_data);
+          const size_t want = iovs[chunk].iov_len;
+          if (res < 0) {
+            ok = false;
+            return;
+          }
+          // Short reads are legal; finish the tail synchronously
+          // rather than re-submitting (rare on regular files).
+          size_t got = static_cast<size_t>(res);
+          while (ok && got < want) {
+            const ssize_t n = HANDLE_EINTR(pread(
+                fd, static_cast<char*>(iovs[chunk].iov_base) + got,
+                want - got, chunk_offsets[chunk] + got));
+            if (n <= 0) {
+              ok = false;
+              break;
+            }
+            got += static_cast<size_t>(n);
+          }
+        })) {
+      ok = false;
+    }
+    offset = batch_offset;
+  }
+
+  close(fd);
+  if (!ok) {
+    contents->clear();
+  }
+  return ok;
+}
+
+bool WriteWithUring(const base::FilePath& path, base::StringPiece data) {
+  UringQueue* ring = ThreadUringQueue();
+  if (!ring) {
+    return false;
+  }
+
+  const int fd = HANDLE_EINTR(open(path.value().c_str(),
+                                   O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                                   0666));
+  if (fd < 0) {
+    return false;
+  }
+
+  bool ok = true;
+  size_t offset = 0;
+  struct iovec iovs[kQueueDepth];
+  while (ok && offset < data.size()) {
+    unsigned chunks = 0;
+    size_t batch_offset = offset;
+    uint64_t chunk_offsets[kQueueDepth];
+    while (chunks < kQueueDepth && batch_offset < data.size()) {
+      const size_t len =
+          std::min(kChunkSize, data.size() - batch_offset);
+      iovs[chunks].iov_base =
+          const_cast<char*>(data.data() + batch_offset);
+      iovs[chunks].iov_len = len;
+      chunk_offsets[chunks] = batch_offset;
+      ring->QueueRw(IORING_OP_WRITEV, fd, &iovs[chunks], batch_offset,
+                    chunks);
+      batch_offset += len;
+      ++chunks;
+    }
+
+    if (!ring->SubmitAndWaitAll([&](uint64_t user_data, int32_t res) {
+          const unsigned chunk = static_cast<unsigned>(user_data);
+          const size_t want = iovs[chunk].iov_len;
+          if (res < 0) {
+            ok = false;
+            return;
+          }
+          size_t put = static_cast<size_t>(res);
+          while (ok && put < want) {
+            const ssize_t n = HANDLE_EINTR(pwrite(
+                fd, static_cast<const char*>(iovs[chunk].iov_base) + put,
+                want - put, chunk_offsets[chunk] + put));
+            if (n <= 0) {
+              ok = false;
+              break;
+            }
+            put += static_cast<size_t>(n);
+          }
+        })) {
+      ok = false;
+    }
+    offset = batch_offset;
+  }
+
+  close(fd);
+  return ok;
+}
+
+#endif // defined(BASIS_HAS_IO_URING)
+
+base::Optional<std::string> ReadFileTask(const base::FilePath& path) {
+  std::string contents;
+  if (!AsyncFile::ReadFileToStringBlocking(path, &contents)) {
+    return base::nullopt;
+  }
+  return contents;
+}
+
+bool WriteFileTask(const base::FilePath& path, std::string data) {
+  return AsyncFile::WriteFileBlocking(path, data);
+}
+
+}  // namespace
+
+// static
+bool AsyncFile::IsIoUringAvailable() {
+#if defined(BASIS_HAS_IO_URING)
+  return ThreadUringQueue() != nullptr;
+#else
+  return false;
+#endif // defined(BASIS_HAS_IO_URING)
+}
+
+// static
+base::Promise<base::Optional<std::string>, base::NoReject>
+AsyncFile::ReadFileToString(const base::Location& from_here,
+                            const base::FilePath& path) {
+  return base::PostPromise(from_here, FileTaskRunner().get(),
+                           base::BindOnce(&ReadFileTask, path));
+}
+
+// static
+base::Promise<bool, base::NoReject> AsyncFile::WriteFile(
+    const base::Location& from_here,
+    const base::FilePath& path,
+    std::string data) {
+  return base::PostPromise(
+      from_here, FileTaskRunner().get(),
+      base::BindOnce(&WriteFileTask, path, std::move(data)));
+}
+
+// static
+bool AsyncFile::ReadFileToStringBlocking(const base::FilePath& path,
+                                         std::string* contents) {
+  DCHECK(contents);
+#if defined(BASIS_HAS_IO_URING)
+  if (ReadWithUring(path, contents)) {
+    return true;
+  }
+#endif // defined(BASIS_HAS_IO_URING)
+  return base::ReadFileToString(path, contents);
+}
+
+// static
+bool AsyncFile::WriteFileBlocking(const base::FilePath& path,
+                                  base::StringPiece data) {
+#if defined(BASIS_HAS_IO_URING)
+  if (WriteWithUring(path, data)) {
+    return true;
+  }
+#endif // defined(BASIS_HAS_IO_URING)
+  const int size = static_cast<int>(data.size());
+  return base::WriteFile(path, data.data(), size) == size;
+}
+
+}  // namespace basis
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <string>
+
+#include <base/callback.h>
+#include <base/files/file_path.h>
+#include <base/location.h>
+#include <base/optional.h>
+#include <base/strings/string_piece.h>
+
+#include <basis/promise/promise.h>
+
+namespace basis {
+
+// Asynchronous whole-file reads/writes that complete into promises,
+// backed by io_uring where the kernel supports it (Linux 5.1+).
+//
+// A sequence doing synchronous file I/O spends its wall time blocked
+// in syscalls; the persistence sequence is the canonical victim. The
+// promise API here runs the operation on an internal MayBlock
+// thread-pool sequence, so the calling sequence stays runnable either
+// way; on top of that, the io_uring backend submits the file in large
+// chunks through one ring (one enter syscall per batch instead of one
+// read/write per chunk) and lets the kernel service them in parallel.
+// When the ring is unavailable — old kernel, seccomp, missing header
+// at build time — the same operations degrade to plain syscalls on the
+// offload sequence, with identical results.
+//
+// The blocking variants exist for callers that are already on a
+// MayBlock sequence (e.g. the serializer file helpers) and just want
+// the batched-ring fast path without another hop.
+class AsyncFile {
+ public:
+  // True when the io_uring backend is in use (probed once, cached).
+  static bool IsIoUringAvailable();
+
+  // Reads the whole file at |path|; resolves with the content, or
+  // nullopt on any error. Attach continuations with ThenHere to get
+  // back onto the calling sequence.
+  static base::Promise<base::Optional<std::string>, base::NoReject>
+  ReadFileToString(const base::Location& from_here,
+                   const base::FilePath& path);
+
+  // Replaces the file at |path| with |data| (taken by value and moved
+  // to the offload sequence); resolves with true on success.
+  static base::Promise<bool, base::NoReject> WriteFile(
+      const base::Location& from_here,
+      const base::FilePath& path,
+      std::string data);
+
+  // Blocking primitives behind the promises; io_uring-batched where
+  // available, plain syscalls otherwise. Must run on a sequence that
+  // may block.
+  static bool ReadFileToStringBlocking(const base::FilePath& path,
+                                       std::string* contents);
+  static bool WriteFileBlocking(const base::FilePath& path,
+                                base::StringPiece data);
+
+ private:
+  AsyncFile() = delete;
+};
+
+}  // namespace basis
@@ -0,0 +1,621 @@
+#include "basis/binary_trace_file.hpp" // IWYU pragma: associated
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <vector>
+
+#include <base/files/file_path.h>
+#include <base/json/string_escape.h>
+#include <base/logging.h>
+
+#include <basis/compressed_block_writer.hpp>
+#include <basis/serializers.h>
+
+namespace basis {
+
+namespace {
+
+constexpr uint32_t kMagic = 0x31525442; // 'BTR1', little-endian
+
+constexpr uint8_t kTagStringDef = 0x01;
+constexpr uint8_t kTagEvent = 0x02;
+
+// ------------------------------ encoding ------------------------------
+
+void appendVarint(std::string* out, uint64_t value)
+{
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>(value | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+uint64_t zigzag(int64_t value)
+{
+  return (static_cast<uint64_t>(value) << 1)
+         ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value)
+{
+  return static_cast<int64_t>(value >> 1)
+         ^ -static_cast<int64_t>(value & 1);
+}
+
+// Minimal comma-managed JSON re-builder for the nested values ("args")
+// that the streaming parser hands us token by token.
+class JsonRebuilder {
+ public:
+  void beginObject()
+  {
+    comma();
+    out_.push_back('{');
+    need_comma_.push_back(false);
+  }
+
+  void endObject()
+  {
+    out_.push_back('}');
+    need_comma_.pop_back();
+    markValue();
+  }
+
+  void beginArray()
+  {
+    comma();
+    out_.push_back('[');
+    need_comma_.push_back(false);
+  }
+
+  void endArray()
+  {
+    out_.push_back(']');
+    need_comma_.pop_back();
+    markValue();
+  }
+
+  void key(const base::StringPiece& key)
+  {
+    comma();
+    base::EscapeJSONString(key, /*put_in_quotes=*/true, &out_);
+    out_.push_back(':');
+    // The value that follows must not emit another comma.
+    if (!need_comma_.empty()) {
+      need_comma_.back() = false;
+    }
+  }
+
+  void scalar(const std::string& literal)
+  {
+    comma();
+    out_.append(literal);
+    markValue();
+  }
+
+  void stringScalar(const base::StringPiece& value)
+  {
+    comma();
+    base::EscapeJSONString(value, /*put_in_quotes=*/true, &out_);
+    markValue();
+  }
+
+  bool done() const { return need_comma_.empty(); }
+
+  const std::string& text() const { return out_; }
+
+ private:
+  void comma()
+  {
+    if (!need_comma_.empty() && need_comma_.back()) {
+      out_.push_back(',');
+    }
+  }
+
+  void markValue()
+  {
+    if (!need_comma_.empty()) {
+      need_comma_.back() = true;
+    }
+  }
+
+  std::string out_;
+  std::vector<bool> need_comma_;
+};
+
+// Streams the flushed event array straight into binary records; no
+// base::Value tree, no second pass over the text. Events are flat
+// objects except for "args" (and the odd nested value), which are
+// rebuilt into a raw JSON string and stored verbatim.
+class BinaryTraceEncoder : public chromecast::JsonStreamHandler {
+ public:
+  explicit BinaryTraceEncoder(CompressedBlockWriter* writer)
+    : writer_(writer)
+  {
+    std::string magic(reinterpret_cast<const char*>(&kMagic)
+      , sizeof(kMagic));
+    writer_->write(magic.data(), magic.size());
+  }
+
+  bool BeginArray() override
+  {
+    if (depth_ == 0) {
+      ++depth_;
+      return true;
+    }
+    return nestedBegin(/*object=*/false);
+  }
+
+  bool EndArray() override
+  {
+    if (depth_ == 1) {
+      --depth_;
+      return true;
+    }
+    return nestedEnd(/*object=*/false);
+  }
+
+  bool BeginObject() override
+  {
+    if (depth_ == 0) {
+      // Expected the bare event array, not the {"traceEvents"} wrapper.
+      return false;
+    }
+    if (depth_ == 1) {
+      ++depth_;
+      resetEvent();
+      return true;
+    }
+    return nestedBegin(/*object=*/true);
+  }
+
+  bool EndObject() override
+  {
+    if (depth_ == 2 && !capturing()) {
+      --depth_;
+      emitEvent();
+      return true;
+    }
+    return nestedEnd(/*object=*/true);
+  }
+
+  bool Key(base::StringPiece key) override
+  {
+    if (capturing()) {
+      nested_.key(key);
+      return true;
+    }
+    key_.assign(key.data(), key.size());
+    return true;
+  }
+
+  bool StringValue(base::StringPiece value) override
+  {
+    if (capturing()) {
+      nested_.stringScalar(value);
+      return true;
+    }
+    if (key_ == "ph") {
+      phase_ = value.empty() ? '?' : value[0];
+    } else if (key_ == "cat") {
+      cat_id_ = internString(value);
+    } else if (key_ == "name") {
+      name_id_ = internString(value);
+    } else {
+      std::string escaped;
+      base::EscapeJSONString(value, /*put_in_quotes=*/true, &escaped);
+      appendExtra(escaped);
+    }
+    return true;
+  }
+
+  bool IntValue(int value) override
+  {
+    return number(static_cast<double>(value));
+  }
+
+  bool DoubleValue(double value) override
+  {
+    return number(value);
+  }
+
+  bool BoolValue(bool value) override
+  {
+    if (capturing()) {
+      nested_.scalar(value ? "true" : "false");
+      return true;
+    }
+    appendExtra(value ? "true" : "false");
+    return true;
+  }
+
+  bool NullValue() override
+  {
+    if (capturing()) {
+      nested_.scalar("null");
+      return true;
+    }
+    appendExtra("null");
+    return true;
+  }
+
+ private:
+  bool capturing() const { return capture_depth_ > 0; }
+
+  bool nestedBegin(bool object)
+  {
+    if (!capturing()) {
+      if (depth_ != 2) {
+        return false;
+      }
+      // Start of a nested value under |key_| at event level.
+      nested_ = JsonRebuilder();
+      nested_key_ = key_;
+    }
+    ++capture_depth_;
+    if (object) {
+      nested_.beginObject();
+    } else {
+      nested_.beginArray();
+    }
+    return true;
+  }
+
+  bool nestedEnd(bool object)
+  {
+    if (!capturing()) {
+      return false;
+    }
+    if (object) {
+      nested_.endObject();
+    } else {
+      nested_.endArray();
+    }
+    if (--capture_depth_ == 0) {
+      if (nested_key_ == "args") {
+        args_ = nested_.text();
+      } else {
+        key_ = nested_key_;
+        appendExtra(nested_.text());
+      }
+    }
+    return true;
+  }
+
+  bool number(double value)
+  {
+    if (capturing()) {
+      nested_.scalar(formatNumber(value));
+      return true;
+    }
+    if (key_ == "pid") {
+      pid_ = static_cast<int64_t>(value);
+    } else if (key_ == "tid") {
+      tid_ = static_cast<int64_t>(value);
+    } else if (key_ == "ts") {
+      ts_ = static_cast<int64_t>(value);
+    } else if (key_ == "dur") {
+      dur_ = static_cast<int64_t>(value);
+    } else {
+      appendExtra(formatNumber(value));
+    }
+    return true;
+  }
+
+  static std::string formatNumber(double value)
+  {
+    // Trace numbers are microsecond integers in practice; keep them
+    // integral when they are so the round trip is byte-stable.
+    const int64_t as_int = static_cast<int64_t>(value);
+    if (static_cast<double>(as_int) == value) {
+      return std::to_string(as_int);
+    }
+    return std::to_string(value);
+  }
+
+  // Records "key":value for fields without a dedicated slot. |value|
+  // must already be valid JSON.
+  void appendExtra(const std::string& value)
+  {
+    if (!extra_.empty()) {
+      extra_.push_back(',');
+    }
+    base::EscapeJSONString(key_, /*put_in_quotes=*/true, &extra_);
+    extra_.push_back(':');
+    extra_.append(value);
+  }
+
+  uint64_t internString(const base::StringPiece& value)
+  {
+    const std::string str(value.data(), value.size());
+    auto it = string_ids_.find(str);
+    if (it != string_ids_.end()) {
+      return it->second;
+    }
+    const uint64_t id = next_string_id_++;
+    string_ids_[str] = id;
+    std::string record;
+    record.push_back(static_cast<char>(kTagStringDef));
+    appendVarint(&record, id);
+    appendVarint(&record, str.size());
+    record.append(str);
+    writer_->write(record.data(), record.size());
+    return id;
+  }
+
+  void resetEvent()
+  {
+    phase_ = '?';
+    pid_ = last_pid_;
+    tid_ = last_tid_;
+    ts_ = last_ts_;
+    dur_ = -1;
+    cat_id_ = 0;
+    name_id_ = 0;
+    args_.clear();
+    extra_.clear();
+    key_.clear();
+  }
+
+  void emitEvent()
+  {
+    std::string record;
+    record.reserve(32 + args_.size() + extra_.size());
+    record.push_back(static_cast<char>(kTagEvent));
+    record.push_back(static_cast<char>(phase_));
+    appendVarint(&record, zigzag(pid_));
+    appendVarint(&record, zigzag(tid_));
+    appendVarint(&record, zigzag(ts_ - last_ts_));
+    appendVarint(&record, cat_id_);
+    appendVarint(&record, name_id_);
+    appendVarint(&record, zigzag(dur_ + 1));
+    appendVarint(&record, args_.size());
+    record.append(args_);
+    appendVarint(&record, extra_.size());
+    record.append(extra_);
+    writer_->write(record.data(), record.size());
+    last_ts_ = ts_;
+    last_pid_ = pid_;
+    last_tid_ = tid_;
+  }
+
+  CompressedBlockWriter* writer_;
+
+  int depth_ = 0;
+  int capture_depth_ = 0;
+  std::string key_;
+  std::string nested_key_;
+  JsonRebuilder nested_;
+
+  char phase_ = '?';
+  int64_t pid_ = 0;
+  int64_t tid_ = 0;
+  int64_t ts_ = 0;
+  int64_t dur_ = -1;
+  uint64_t cat_id_ = 0;
+  uint64_t name_id_ = 0;
+  std::string args_;
+  std::string extra_;
+
+  int64_t last_ts_ = 0;
+  int64_t last_pid_ = 0;
+  int64_t last_tid_ = 0;
+
+  std::map<std::string, uint64_t> string_ids_;
+  uint64_t next_string_id_ = 1;
+};
+
+// ------------------------------ decoding ------------------------------
+
+class BinaryTraceReader {
+ public:
+  BinaryTraceReader(const char* data, size_t size)
+    : data_(data)
+    , size_(size)
+  {}
+
+  bool readMagic()
+  {
+    uint32_t magic = 0;
+    if (size_ - pos_ < sizeof(magic)) {
+      return false;
+    }
+    memcpy(&magic, data_ + pos_, sizeof(magic));
+    pos_ += sizeof(magic);
+    return magic == kMagic;
+  }
+
+  bool atEnd() const { return pos_ >= size_; }
+
+  bool readByte(uint8_t* out)
+  {
+    if (pos_ >= size_) {
+      return false;
+    }
+    *out = static_cast<uint8_t>(data_[pos_++]);
+    return true;
+  }
+
+  bool readVarint(uint64_t* out)
+  {
+    uint64_t value = 0;
+    int shift = 0;
+    while (pos_ < size_ && shift < 64) {
+      const uint8_t byte = static_cast<uint8_t>(data_[pos_++]);
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80)) {
+        *out = value;
+        return true;
+      }
+      shift += 7;
+    }
+    return false;
+  }
+
+  bool readBytes(size_t len, base::StringPiece* out)
+  {
+    if (size_ - pos_ < len) {
+      return false;
+    }
+    *out = base::StringPiece(data_ + pos_, len);
+    pos_ += len;
+    return true;
+  }
+
+ private:
+  const char* data_;
+  size_t size_;
+  size_t pos_ = 0;
+};
+
+}  // namespace
+
+bool writeBinaryTraceFromJson(
+  const base::FilePath& path
+  , const base::StringPiece& json_events)
+{
+  CompressedBlockWriter writer(path.value());
+  BinaryTraceEncoder encoder(&writer);
+  const bool parsed
+    = chromecast::StreamJsonFromString(json_events, &encoder);
+  writer.close();
+  if (!parsed || !writer.ok()) {
+    LOG(ERROR)
+      << "Failed to write binary trace to "
+      << path.value()
+      << (parsed ? " (I/O error)" : " (malformed trace JSON)");
+    return false;
+  }
+  return true;
+}
+
+bool convertBinaryTraceToJson(
+  const base::FilePath& binary_path
+  , const base::FilePath& json_path)
+{
+  base::Optional<std::string> payload
+    = decompressBlockFile(binary_path.value());
+  if (!payload) {
+    LOG(ERROR)
+      << "Failed to read binary trace " << binary_path.value();
+    return false;
+  }
+
+  BinaryTraceReader reader(payload->data(), payload->size());
+  if (!reader.readMagic()) {
+    LOG(ERROR)
+      << "Not a binary trace file: " << binary_path.value();
+    return false;
+  }
+
+  std::ofstream out(json_path.value()
+    , std::ios::binary | std::ios::trunc);
+  if (!out) {
+    LOG(ERROR)
+      << "Failed to open " << json_path.value();
+    return false;
+  }
+
+  std::vector<std::string> strings(1); // id 0 = empty
+  int64_t last_ts = 0;
+  bool first_event = true;
+  out << "[";
+
+  while (!reader.atEnd()) {
+    uint8_t tag = 0;
+    if (!reader.readByte(&tag)) {
+      break;
+    }
+    if (tag == kTagStringDef) {
+      uint64_t id = 0;
+      uint64_t len = 0;
+      base::StringPiece bytes;
+      if (!reader.readVarint(&id)
+          || !reader.readVarint(&len)
+          || !reader.readBytes(static_cast<size_t>(len), &bytes)
+          || id != strings.size())
+      {
+        LOG(ERROR)
+          << "Corrupt string table in " << binary_path.value();
+        return false;
+      }
+      strings.emplace_back(bytes.data(), bytes.size());
+    } else if (tag == kTagEvent) {
+      uint8_t phase = 0;
+      uint64_t pid_z, tid_z, ts_z, cat_id, name_id, dur_z;
+      uint64_t args_len, extra_len;
+      base::StringPiece args, extra;
+      if (!reader.readByte(&phase)
+          || !reader.readVarint(&pid_z)
+          || !reader.readVarint(&tid_z)
+          || !reader.readVarint(&ts_z)
+          || !reader.readVarint(&cat_id)
+          || !reader.readVarint(&name_id)
+          || !reader.readVarint(&dur_z)
+          || !reader.readVarint(&args_len)
+          || !reader.readBytes(static_cast<size_t>(args_len), &args)
+          || !reader.readVarint(&extra_len)
+          || !reader.readBytes(static_cast<size_t>(extra_len), &extra)
+          || cat_id >= strings.size()
+          || name_id >= strings.size())
+      {
+        LOG(ERROR)
+          << "Corrupt event record in " << binary_path.value();
+        return false;
+      }
+      const int64_t ts = last_ts + unzigzag(ts_z);
+      last_ts = ts;
+      const int64_t dur = unzigzag(static_cast<uint64_t>(dur_z)) - 1;
+
+      if (!first_event) {
+        out << ",";
+      }
+      first_event = false;
+
+      std::string escaped;
+      out << "{\"pid\":" << unzigzag(pid_z)
+          << ",\"tid\":" << unzigzag(tid_z)
+          << ",\"ts\":" << ts
+          << ",\"ph\":\"" << static_cast<char>(phase) << "\"";
+      escaped.clear();
+      base::EscapeJSONString(strings[static_cast<size_t>(cat_id)]
+        , /*put_in_quotes=*/true, &escaped);
+      out << ",\"cat\":" << escaped;
+      escaped.clear();
+      base::EscapeJSONString(strings[static_cast<size_t>(name_id)]
+        , /*put_in_quotes=*/true, &escaped);
+      out << ",\"name\":" << escaped;
+      if (dur >= 0) {
+        out << ",\"dur\":" << dur;
+      }
+      if (!args.empty()) {
+        out << ",\"args\":";
+        out.write(args.data(), static_cast<std::streamsize>(args.size()));
+      }
+      if (!extra.empty()) {
+        out << ",";
+        out.write(extra.data()
+          , static_cast<std::streamsize>(extra.size()));
+      }
+      out << "}";
+    } else {
+      LOG(ERROR)
+        << "Unknown record tag " << static_cast<int>(tag)
+        << " in " << binary_path.value();
+      return false;
+    }
+  }
+
+  out << "]";
+  out.flush();
+  if (!out) {
+    LOG(ERROR)
+      << "Failed writing " << json_path.value();
+    return false;
+  }
+  return true;
+}
+
+}  // namespace basis
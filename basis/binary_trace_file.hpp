@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+
+#include <base/strings/string_piece.h>
+
+namespace base {
+class FilePath;
+}  // namespace base
+
+namespace basis {
+
+// Compact binary container for chrome://tracing event streams.
+//
+// TraceLog's JSON output repeats every category, name and key for every
+// event and spells timestamps out in decimal; a 60-second server capture
+// easily runs into gigabytes and the flush pause is dominated by writing
+// them. This format interns strings once, delta-encodes timestamps as
+// varints and rides on the streaming LZ4 stage
+// (basis/compressed_block_writer.hpp), which together cut the on-disk
+// size and the write time by roughly an order of magnitude on real
+// captures. Viewing stays JSON: convertBinaryTraceToJson() expands a
+// capture back into a chrome://tracing-loadable array offline, where
+// the cost does not matter.
+//
+// Layout inside the LZ4 block container (all integers LEB128 varints,
+// signed values zigzag-encoded):
+//   u32 magic 'BTR1'
+//   records, each starting with a tag byte:
+//     0x01 string-def: id, byte length, bytes (categories, names)
+//     0x02 event: phase byte, pid, tid, ts delta from previous event,
+//          category id, name id, dur+1 (0 = no "dur" key), raw JSON of
+//          "args" (byte length + bytes, 0 = none), raw JSON fragment of
+//          any remaining keys ("id", "s", "tts", ...) so nothing the
+//          trace viewer needs is dropped.
+//
+// The JSON side of both functions is the bare event array that
+// basis::dumpLastTraceEvents() writes (not the {"traceEvents": ...}
+// wrapper).
+
+// Transcodes the JSON event array |json_events| into a binary trace
+// file at |path|. Streams through the single-pass parser in
+// basis/serializers.h, so no base::Value tree is built. Returns false
+// on malformed JSON or I/O failure (the file is unusable then).
+bool writeBinaryTraceFromJson(
+  const base::FilePath& path
+  , const base::StringPiece& json_events);
+
+// The converter for viewing: expands the binary capture at
+// |binary_path| into a chrome://tracing-loadable JSON event array at
+// |json_path|. Output is streamed, so multi-GB expansions do not need
+// to fit in memory. Returns false if the input is not a valid binary
+// trace or the output cannot be written.
+bool convertBinaryTraceToJson(
+  const base::FilePath& binary_path
+  , const base::FilePath& json_path);
+
+}  // namespace basis
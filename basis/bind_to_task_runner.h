@@ -29,6 +29,8 @@
 //                     base::BindOnce(&MyClass::MyMethod, this)));
 //
 // Note that the callback is always posted to the target TaskRunner.
+// BindToTaskRunnerMaybeInline below relaxes that: it runs the callback
+// synchronously when invoked on the destination sequence already.
 //
 // As a convenience, you can use BindToCurrentThread() to bind to the
 // TaskRunner for the current thread (ie, base::ThreadTaskRunnerHandle::Get()).
@@ -50,6 +52,26 @@ struct BindToTaskRunnerTrampoline<void(Args...)> {
   }
 };
 
+template <typename Sig>
+struct BindToTaskRunnerMaybeInlineTrampoline;
+
+template <typename... Args>
+struct BindToTaskRunnerMaybeInlineTrampoline<void(Args...)> {
+  static void Run(base::TaskRunner* task_runner,
+                  base::OnceCallback<void(Args...)> callback,
+                  Args... args) {
+    // Already on the destination sequence: skip the queue round-trip
+    // and run synchronously.
+    if (task_runner->RunsTasksInCurrentSequence()) {
+      std::move(callback).Run(std::forward<Args>(args)...);
+      return;
+    }
+    task_runner->PostTask(
+        FROM_HERE,
+        base::BindOnce(std::move(callback), std::forward<Args>(args)...));
+  }
+};
+
 }  // namespace bind_helpers
 
 template <typename T>
@@ -70,6 +92,31 @@ base::RepeatingCallback<T> BindToTaskRunner(
                              std::move(callback));
 }
 
+// Like BindToTaskRunner, but when the wrapped callback is invoked on
+// the destination sequence already, it runs synchronously instead of
+// paying a PostTask round-trip (the common case in pipelines where
+// producer and consumer usually share a sequence). Only use when the
+// caller tolerates both synchronous and asynchronous execution:
+// re-entrancy and lock-held invocation become possible on the inline
+// path.
+template <typename T>
+base::OnceCallback<T> BindToTaskRunnerMaybeInline(
+    scoped_refptr<base::TaskRunner> task_runner,
+    base::OnceCallback<T> callback) {
+  return base::BindOnce(
+      &bind_helpers::BindToTaskRunnerMaybeInlineTrampoline<T>::Run,
+      base::RetainedRef(std::move(task_runner)), std::move(callback));
+}
+
+template <typename T>
+base::RepeatingCallback<T> BindToTaskRunnerMaybeInline(
+    scoped_refptr<base::TaskRunner> task_runner,
+    base::RepeatingCallback<T> callback) {
+  return base::BindRepeating(
+      &bind_helpers::BindToTaskRunnerMaybeInlineTrampoline<T>::Run,
+      base::RetainedRef(std::move(task_runner)), std::move(callback));
+}
+
 template <typename T>
 base::OnceCallback<T> BindToCurrentThread(base::OnceCallback<T> callback) {
   return BindToTaskRunner(base::ThreadTaskRunnerHandle::Get(),
@@ -12,6 +12,8 @@
 #include "base/callback.h"
 #include "base/run_loop.h"
 #include "base/test/task_environment.h"
+#include "base/threading/thread.h"
+#include "base/threading/thread_task_runner_handle.h"
 #include "testing/gmock/include/gmock/gmock.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -162,4 +164,31 @@ TEST_F(BindToTaskRunnerTest, RepeatingCallbackWithUnboundMoveOnly) {
   EXPECT_CALL(callbacks_, DoMoveOnlyCallback(Pointee(kValue)));
 }
 
+TEST_F(BindToTaskRunnerTest, MaybeInlineRunsSynchronouslyOnSameSequence) {
+  // Invoked on the destination sequence: no posting, the callback must
+  // have run before Run() returns.
+  EXPECT_CALL(callbacks_, VoidCallback());
+  base::OnceClosure callback = BindToTaskRunnerMaybeInline(
+      base::ThreadTaskRunnerHandle::Get(),
+      base::BindOnce(&Callbacks::VoidCallback, base::Unretained(&callbacks_)));
+  std::move(callback).Run();
+  testing::Mock::VerifyAndClearExpectations(&callbacks_);
+}
+
+TEST_F(BindToTaskRunnerTest, MaybeInlinePostsFromOtherSequence) {
+  base::RepeatingClosure callback = BindToTaskRunnerMaybeInline(
+      base::ThreadTaskRunnerHandle::Get(),
+      base::BindRepeating(&Callbacks::VoidCallback,
+                          base::Unretained(&callbacks_)));
+  base::Thread other_thread("MaybeInlineTest");
+  ASSERT_TRUE(other_thread.Start());
+  other_thread.task_runner()->PostTask(FROM_HERE, callback);
+  // Joins the thread, so the wrapped callback has been invoked (and
+  // posted back to this sequence) before we pump the loop.
+  other_thread.Stop();
+  EXPECT_CALL(callbacks_, VoidCallback());
+  base::RunLoop().RunUntilIdle();
+  testing::Mock::VerifyAndClearExpectations(&callbacks_);
+}
+
 }  // namespace chromecast
@@ -5,10 +5,15 @@
 #include <base/base_switches.h>
 #include <base/feature_list.h>
 
+#include <basis/startup_phases.hpp>
+#include <basis/switch_registry.hpp>
+
 namespace basis {
 
 void initCommandLine(int argc, char* argv[])
 {
+  ScopedStartupPhase startup_phase("initCommandLine");
+
   // see https://peter.sh/experiments/chromium-command-line-switches/
   DCHECK(!base::CommandLine::InitializedForCurrentProcess());
   base::CommandLine::Init(argc, argv);
@@ -75,6 +80,11 @@ void initCommandLine(int argc, char* argv[])
   DCHECK(command_line->HasSwitch(switches::kV) ||
       command_line->HasSwitch(switches::kVModule));
 #endif // NDEBUG
+
+  /// \note single parse pass for all switches declared up to this
+  /// point (see switch_registry.hpp); later reads are index-based
+  /// and allocation-free
+  switchRegistry().parseFromCommandLine(*command_line);
 }
 
 }  // namespace basis
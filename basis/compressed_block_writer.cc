@@ -0,0 +1,235 @@
+#include "basis/compressed_block_writer.hpp" // IWYU pragma: associated
+
+#include <algorithm>
+#include <cstring>
+
+#include <base/logging.h>
+
+#include <basis/lz4.hpp>
+
+namespace basis {
+
+namespace {
+
+const char kFileMagic[4] = {'B', 'L', 'Z', '1'};
+
+// Iterations of the non-blocking path attempted before parking; same
+// rationale as BlockingProducerConsumerQueue::kSpinCount.
+constexpr int kSpinCount = 1000;
+
+void appendU32(std::ofstream* out, uint32_t value) {
+  char bytes[4];
+  bytes[0] = static_cast<char>(value);
+  bytes[1] = static_cast<char>(value >> 8);
+  bytes[2] = static_cast<char>(value >> 16);
+  bytes[3] = static_cast<char>(value >> 24);
+  out->write(bytes, sizeof(bytes));
+}
+
+uint32_t readU32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0])
+         | (static_cast<uint32_t>(p[1]) << 8)
+         | (static_cast<uint32_t>(p[2]) << 16)
+         | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+}  // namespace
+
+CompressedBlockWriter::CompressedBlockWriter(
+  const std::string& path
+  , uint32_t ring_bytes)
+  : out_(path, std::ios::binary | std::ios::trunc)
+  , ring_(ring_bytes)
+  , compress_scratch_(lz4CompressBound(kBlockSize))
+{
+  DCHECK_GT(ring_bytes, 2 * kBlockSize);
+  if (!out_.good()) {
+    LOG(ERROR)
+      << "Failed to open " << path << " for compressed writing";
+    failed_.store(true, std::memory_order_relaxed);
+    return;
+  }
+  out_.write(kFileMagic, sizeof(kFileMagic));
+  writer_thread_ = std::thread(&CompressedBlockWriter::writerLoop, this);
+}
+
+CompressedBlockWriter::~CompressedBlockWriter() {
+  close();
+}
+
+bool CompressedBlockWriter::ok() const {
+  return !failed_.load(std::memory_order_acquire);
+}
+
+void CompressedBlockWriter::write(const void* data, size_t size) {
+  DCHECK(!stop_.load(std::memory_order_relaxed));
+  if (!writer_thread_.joinable()) {
+    // The file never opened; drop the data, ok() already reports it.
+    return;
+  }
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  while (size > 0) {
+    const uint32_t chunk =
+        static_cast<uint32_t>(std::min<size_t>(size, kBlockSize));
+
+    // Spin-then-park until the ring has room (only when the producer
+    // outruns the compression thread).
+    if (!ring_.write(bytes, chunk)) {
+      int spin = 0;
+      for (;;) {
+        if (++spin < kSpinCount) {
+          if (ring_.write(bytes, chunk)) {
+            break;
+          }
+          continue;
+        }
+        EventCount::Key key = notFull_.prepareWait();
+        if (ring_.write(bytes, chunk)) {
+          notFull_.cancelWait();
+          break;
+        }
+        notFull_.wait(key);
+      }
+    }
+
+    queued_blocks_.fetch_add(1, std::memory_order_release);
+    notEmpty_.notify();
+    bytes += chunk;
+    size -= chunk;
+  }
+}
+
+void CompressedBlockWriter::flush() {
+  if (!writer_thread_.joinable()) {
+    return;
+  }
+  const uint64_t target = queued_blocks_.load(std::memory_order_acquire);
+  for (;;) {
+    if (flushed_blocks_.load(std::memory_order_acquire) >= target) {
+      return;
+    }
+    EventCount::Key key = drained_.prepareWait();
+    if (flushed_blocks_.load(std::memory_order_acquire) >= target) {
+      drained_.cancelWait();
+      return;
+    }
+    drained_.wait(key);
+  }
+}
+
+void CompressedBlockWriter::close() {
+  if (!writer_thread_.joinable()) {
+    return;
+  }
+  stop_.store(true, std::memory_order_release);
+  notEmpty_.notifyAll();
+  writer_thread_.join();
+  out_.close();
+  if (!out_) {
+    failed_.store(true, std::memory_order_release);
+  }
+}
+
+void CompressedBlockWriter::writerLoop() {
+  uint64_t written_blocks = 0;
+  for (;;) {
+    ByteStreamSPSCQueue::MessageView msg = ring_.front();
+    if (msg) {
+      writeBlock(msg.data, msg.size);
+      ring_.popFront();
+      notFull_.notify();
+      ++written_blocks;
+      continue;
+    }
+
+    // Ring drained: make everything written so far durable and let
+    // flush() waiters go before parking.
+    out_.flush();
+    if (!out_) {
+      failed_.store(true, std::memory_order_release);
+    }
+    flushed_blocks_.store(written_blocks, std::memory_order_release);
+    drained_.notifyAll();
+
+    if (stop_.load(std::memory_order_acquire)) {
+      // stop_ is set before the wake, so a ring observed empty after
+      // it means no more records can arrive.
+      if (!ring_.front()) {
+        return;
+      }
+      continue;
+    }
+
+    EventCount::Key key = notEmpty_.prepareWait();
+    if (ring_.front() || stop_.load(std::memory_order_acquire)) {
+      notEmpty_.cancelWait();
+      continue;
+    }
+    notEmpty_.wait(key);
+  }
+}
+
+void CompressedBlockWriter::writeBlock(const uint8_t* data, uint32_t size) {
+  const size_t compressed_size = lz4CompressBlock(
+      data, size, compress_scratch_.data(), compress_scratch_.size());
+
+  appendU32(&out_, size);
+  if (compressed_size != 0 && compressed_size < size) {
+    appendU32(&out_, static_cast<uint32_t>(compressed_size));
+    out_.write(reinterpret_cast<const char*>(compress_scratch_.data()),
+               static_cast<std::streamsize>(compressed_size));
+  } else {
+    // Incompressible (or empty): store raw, flagged by stored == raw.
+    appendU32(&out_, size);
+    out_.write(reinterpret_cast<const char*>(data),
+               static_cast<std::streamsize>(size));
+  }
+  if (!out_) {
+    failed_.store(true, std::memory_order_release);
+  }
+}
+
+base::Optional<std::string> decompressBlockFile(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in.good()) {
+    return base::nullopt;
+  }
+  std::string file_data((std::istreambuf_iterator<char>(in)),
+                        std::istreambuf_iterator<char>());
+
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(file_data.data());
+  const uint8_t* const end = p + file_data.size();
+  if (end - p < static_cast<ptrdiff_t>(sizeof(kFileMagic))
+      || std::memcmp(p, kFileMagic, sizeof(kFileMagic)) != 0) {
+    return base::nullopt;
+  }
+  p += sizeof(kFileMagic);
+
+  std::string result;
+  while (p < end) {
+    if (end - p < 8) {
+      return base::nullopt;
+    }
+    const uint32_t raw_size = readU32(p);
+    const uint32_t stored_size = readU32(p + 4);
+    p += 8;
+    if (stored_size > static_cast<size_t>(end - p)
+        || stored_size > raw_size) {
+      return base::nullopt;
+    }
+    const size_t old_size = result.size();
+    result.resize(old_size + raw_size);
+    if (stored_size == raw_size) {
+      std::memcpy(&result[old_size], p, raw_size);
+    } else if (lz4DecompressBlock(
+                   p, stored_size,
+                   reinterpret_cast<uint8_t*>(&result[old_size]),
+                   raw_size) != raw_size) {
+      return base::nullopt;
+    }
+    p += stored_size;
+  }
+  return result;
+}
+
+}  // namespace basis
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <base/macros.h>
+#include <base/optional.h>
+
+#include <basis/concurrency/ByteStreamSPSCQueue.hpp>
+#include <basis/concurrency/EventCount.hpp>
+
+namespace basis {
+
+// Streaming LZ4 compression stage for bulk flush paths (trace snapshots,
+// binary log records).
+//
+// A flush that writes hundreds of MB straight to disk competes for the
+// bandwidth the database needs, and the writing thread stalls for the
+// whole transfer. This writer decouples the two: producers hand blocks
+// to a byte SPSC ring (basis/concurrency/ByteStreamSPSCQueue.hpp) and
+// return immediately; a dedicated background thread drains the ring,
+// LZ4-compresses each block (basis/lz4.hpp, ~4x on trace JSON and log
+// records) and writes the result, so the disk sees a quarter of the
+// bytes and the producer only ever waits when it outruns *compression*
+// (memcpy-speed), not the disk... the ring absorbs the difference.
+// Incompressible blocks are stored raw, so pathological input costs
+// 8 bytes of framing per block, never an expansion.
+//
+// File format: kFileMagic, then per block a uint32 raw size and uint32
+// stored size (little-endian); stored == raw means the payload is raw
+// bytes, anything smaller means one LZ4 block. decompressBlockFile()
+// reads it back; offline tooling can too, the framing is trivial.
+//
+// Threading: any single thread may call write()/flush() (producer);
+// close() and the destructor must come from that same thread. The
+// background thread is the only writer of the file.
+class CompressedBlockWriter {
+ public:
+  // Blocks bigger than this are split; 64 KiB keeps the LZ4 match
+  // window fully used while bounding ring residency per record.
+  static constexpr uint32_t kBlockSize = 64 * 1024;
+
+  // Creates/truncates |path| and starts the compression thread.
+  // |ring_bytes| bounds how far the producer can run ahead of
+  // compression (default 4 MiB ~ 64 blocks).
+  explicit CompressedBlockWriter(
+    const std::string& path
+    , uint32_t ring_bytes = 4 * 1024 * 1024);
+
+  // close()s.
+  ~CompressedBlockWriter();
+
+  // False when the file failed to open or a write failed; once false,
+  // stays false. Check after flush()/close() for the final verdict.
+  [[nodiscard]] /* don't ignore return value */
+  bool ok() const;
+
+  // Queues |size| bytes for compression and write-out. Returns as soon
+  // as the bytes are in the ring; parks (spin-then-futex, see
+  // EventCount.hpp) only while the ring is full.
+  void write(const void* data, size_t size);
+
+  // Blocks until everything write()-n so far is compressed, written and
+  // flushed to the OS.
+  void flush();
+
+  // flush() + stop the background thread + close the file. Idempotent;
+  // write() must not be called afterwards.
+  void close();
+
+ private:
+  void writerLoop();
+
+  // Compresses and writes the block at the front of the ring.
+  void writeBlock(const uint8_t* data, uint32_t size);
+
+  std::ofstream out_;
+  ByteStreamSPSCQueue ring_;
+  EventCount notEmpty_;
+  EventCount notFull_;
+  EventCount drained_;
+
+  // Blocks queued by the producer / durably flushed by the writer
+  // thread; flush() waits for the second to catch the first.
+  std::atomic<uint64_t> queued_blocks_{0};
+  std::atomic<uint64_t> flushed_blocks_{0};
+
+  std::atomic<bool> stop_{false};
+  std::atomic<bool> failed_{false};
+
+  // Reused per block; sized to lz4CompressBound(kBlockSize) once.
+  std::vector<uint8_t> compress_scratch_;
+
+  std::thread writer_thread_;
+
+  DISALLOW_COPY_AND_ASSIGN(CompressedBlockWriter);
+};
+
+// Reads a CompressedBlockWriter file back into memory. Returns
+// base::nullopt when the file cannot be read, has the wrong magic or a
+// corrupt block. For offline tools and tests.
+base::Optional<std::string> decompressBlockFile(const std::string& path);
+
+}  // namespace basis
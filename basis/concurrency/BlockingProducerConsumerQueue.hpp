@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include <basis/concurrency/EventCount.hpp>
+#include <basis/concurrency/LockFreeProducerConsumerQueue.hpp>
+#include <basis/concurrency/SpinWait.hpp>
+
+namespace basis {
+
+/*
+ * LockFreeProducerConsumerQueue with optional blocking operations.
+ *
+ * The plain queue forces consumers to either spin on read() or layer a
+ * mutex/condvar on top; low-rate control queues then burn a core idling.
+ * This wrapper keeps the pure lock-free write()/read()/frontPtr() path
+ * untouched and adds blockingRead()/blockingWrite() that spin briefly and
+ * then park on a futex-backed EventCount until the other side makes
+ * progress. notify() on the hot path is a single fetch_add unless somebody
+ * is actually parked, so the producer side of a busy queue stays lock-free
+ * in practice.
+ *
+ * Use the plain LockFreeProducerConsumerQueue for hot data queues that are
+ * drained every tick; use this wrapper where the consumer may idle.
+ */
+template <class T>
+struct BlockingProducerConsumerQueue {
+  typedef T value_type;
+
+  BlockingProducerConsumerQueue(const BlockingProducerConsumerQueue&) = delete;
+  BlockingProducerConsumerQueue& operator=(
+      const BlockingProducerConsumerQueue&) = delete;
+
+  explicit BlockingProducerConsumerQueue(uint32_t size) : queue_(size) {}
+
+  // Non-blocking operations; identical to the wrapped queue except for the
+  // (cheap) wakeup signal.
+  template <class... Args>
+  bool write(Args&&... recordArgs) {
+    if (!queue_.write(std::forward<Args>(recordArgs)...)) {
+      return false;
+    }
+    notEmpty_.notify();
+    return true;
+  }
+
+  bool read(T& record) {
+    if (!queue_.read(record)) {
+      return false;
+    }
+    notFull_.notify();
+    return true;
+  }
+
+  // Blocks until a record could be written: calibrated spin with
+  // backoff (see SpinWait), then park.
+  template <class... Args>
+  void blockingWrite(Args&&... recordArgs) {
+    SpinWait spin_wait;
+    for (;;) {
+      if (write(std::forward<Args>(recordArgs)...)) {
+        return;
+      }
+      if (spin_wait.spin()) {
+        continue;
+      }
+      EventCount::Key key = notFull_.prepareWait();
+      if (write(std::forward<Args>(recordArgs)...)) {
+        notFull_.cancelWait();
+        return;
+      }
+      notFull_.wait(key);
+      // Data just moved; a fresh spin budget usually wins the race
+      // with the next full/empty transition without another park.
+      spin_wait.reset();
+    }
+  }
+
+  // Blocks until a record was read: calibrated spin with backoff
+  // (see SpinWait), then park.
+  void blockingRead(T& record) {
+    SpinWait spin_wait;
+    for (;;) {
+      if (read(record)) {
+        return;
+      }
+      if (spin_wait.spin()) {
+        continue;
+      }
+      EventCount::Key key = notEmpty_.prepareWait();
+      if (read(record)) {
+        notEmpty_.cancelWait();
+        return;
+      }
+      notEmpty_.wait(key);
+      spin_wait.reset();
+    }
+  }
+
+  bool isEmpty() const { return queue_.isEmpty(); }
+  bool isFull() const { return queue_.isFull(); }
+  size_t sizeGuess() const { return queue_.sizeGuess(); }
+  size_t capacity() const { return queue_.capacity(); }
+
+ private:
+  LockFreeProducerConsumerQueue<T> queue_;
+
+  EventCount notEmpty_;
+  EventCount notFull_;
+};
+
+} // namespace basis
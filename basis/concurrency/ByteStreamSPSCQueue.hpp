@@ -0,0 +1,244 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include <basis/concurrency/LockFreeProducerConsumerQueue.hpp>
+
+namespace basis {
+
+/*
+ * Single-producer single-consumer byte ring for variable-size messages.
+ * The typed LockFreeProducerConsumerQueue forces fixed-size slots, which
+ * for variable-length network messages means either padding every slot
+ * to the worst case or allocating per message and queueing pointers.
+ * This ring stores length-prefixed records back to back in one byte
+ * buffer instead: no per-message allocation, and the consumer walks the
+ * payloads sequentially in cache order.
+ *
+ * Producer API is two-phase so messages can be serialized directly into
+ * the ring:
+ *
+ *   if (uint8_t* dst = ring.reserve(len)) {
+ *     serialize_into(dst, len);
+ *     ring.commit();
+ *   }
+ *
+ * (or the one-shot write() which memcpys.) Consumer side is zero-copy:
+ *
+ *   while (auto msg = ring.front()) {
+ *     process(msg.data, msg.size);
+ *     ring.popFront();
+ *   }
+ *
+ * Index scheme and memory ordering are the same as
+ * LockFreeProducerConsumerQueue: acquire load of the opposing index,
+ * release store of the own index, non-atomic per-side cache of the
+ * opposing index. Records are contiguous; when a record doesn't fit in
+ * the tail of the buffer the producer publishes a wrap marker and the
+ * record starts at offset 0, so a message view is never split.
+ */
+class ByteStreamSPSCQueue {
+ public:
+  // A view of the record at the front of the ring. Valid until
+  // popFront(); only the consumer thread may use it.
+  struct MessageView {
+    const uint8_t* data = nullptr;
+    uint32_t size = 0;
+
+    explicit operator bool() const { return data != nullptr; }
+  };
+
+  ByteStreamSPSCQueue(const ByteStreamSPSCQueue&) = delete;
+  ByteStreamSPSCQueue& operator=(const ByteStreamSPSCQueue&) = delete;
+
+  // |sizeBytes| must be a multiple of 4 and large enough for the biggest
+  // message plus its header (see maxMessageSize()).
+  explicit ByteStreamSPSCQueue(uint32_t sizeBytes)
+      : size_(sizeBytes),
+        data_(static_cast<uint8_t*>(std::malloc(sizeBytes))),
+        readIndex_(0),
+        writeIndexCache_(0),
+        writeIndex_(0),
+        readIndexCache_(0) {
+    assert(sizeBytes >= 2 * kHeaderSize);
+    assert(sizeBytes % kHeaderSize == 0);
+    if (!data_) {
+      throw std::bad_alloc();
+    }
+  }
+
+  ~ByteStreamSPSCQueue() { std::free(data_); }
+
+  // Largest payload a single reserve()/write() can ever succeed for.
+  uint32_t maxMessageSize() const {
+    return size_ - kIndexGap - kHeaderSize;
+  }
+
+  // Reserves |len| contiguous payload bytes in the ring. Returns nullptr
+  // when the ring doesn't currently have room. The record is invisible
+  // to the consumer until commit(); at most one reservation may be
+  // outstanding.
+  uint8_t* reserve(uint32_t len) {
+    assert(!pending_);
+    assert(len <= maxMessageSize());
+    const uint32_t need = kHeaderSize + alignUp(len);
+
+    auto const currentWrite = writeIndex_.load(std::memory_order_relaxed);
+    const uint32_t tail = size_ - currentWrite;
+    // A record that doesn't fit in the tail costs the whole tail (wrap
+    // marker) plus itself at the front of the buffer.
+    const uint32_t needTotal = tail >= need ? need : tail + need;
+
+    if (freeBytes(currentWrite, readIndexCache_) < needTotal) {
+      readIndexCache_ = readIndex_.load(std::memory_order_acquire);
+      if (freeBytes(currentWrite, readIndexCache_) < needTotal) {
+        // ring is full
+        return nullptr;
+      }
+    }
+
+    uint32_t recordStart = currentWrite;
+    if (tail < need) {
+      // The marker only becomes visible with the commit() publish, like
+      // the record itself.
+      storeHeader(currentWrite, kWrapMarker);
+      recordStart = 0;
+    }
+    storeHeader(recordStart, len);
+
+    pendingEnd_ = recordStart + kHeaderSize + alignUp(len);
+    if (pendingEnd_ == size_) {
+      pendingEnd_ = 0;
+    }
+    pending_ = true;
+    return data_ + recordStart + kHeaderSize;
+  }
+
+  // Publishes the record from the last reserve().
+  void commit() {
+    assert(pending_);
+    pending_ = false;
+    writeIndex_.store(pendingEnd_, std::memory_order_release);
+  }
+
+  // One-shot convenience: reserve + memcpy + commit. Returns false when
+  // the ring is full.
+  bool write(const void* data, uint32_t len) {
+    uint8_t* dst = reserve(len);
+    if (!dst) {
+      return false;
+    }
+    std::memcpy(dst, data, len);
+    commit();
+    return true;
+  }
+
+  // View of the front record, or a null view when the ring is empty.
+  MessageView front() {
+    for (;;) {
+      auto const currentRead = readIndex_.load(std::memory_order_relaxed);
+      if (currentRead == writeIndexCache_) {
+        writeIndexCache_ = writeIndex_.load(std::memory_order_acquire);
+        if (currentRead == writeIndexCache_) {
+          // ring is empty
+          return MessageView{};
+        }
+      }
+      const uint32_t len = loadHeader(currentRead);
+      if (len == kWrapMarker) {
+        // Tail was too small for the next record; it continues at 0.
+        readIndex_.store(0, std::memory_order_release);
+        continue;
+      }
+      return MessageView{data_ + currentRead + kHeaderSize, len};
+    }
+  }
+
+  // Releases the record returned by front(). The ring must not be empty.
+  void popFront() {
+    auto const currentRead = readIndex_.load(std::memory_order_relaxed);
+    assert(currentRead != writeIndex_.load(std::memory_order_acquire));
+    const uint32_t len = loadHeader(currentRead);
+    // front() already skipped any wrap marker.
+    assert(len != kWrapMarker);
+    uint32_t next = currentRead + kHeaderSize + alignUp(len);
+    if (next == size_) {
+      next = 0;
+    }
+    readIndex_.store(next, std::memory_order_release);
+  }
+
+  bool isEmpty() const {
+    return readIndex_.load(std::memory_order_acquire) ==
+        writeIndex_.load(std::memory_order_acquire);
+  }
+
+  // Bytes (including headers and padding) the producer could currently
+  // reserve without wrapping considerations. Same caveats as
+  // LockFreeProducerConsumerQueue::sizeGuess().
+  size_t freeBytesGuess() const {
+    return freeBytes(writeIndex_.load(std::memory_order_acquire),
+                     readIndex_.load(std::memory_order_acquire));
+  }
+
+ private:
+  static constexpr uint32_t kHeaderSize = sizeof(uint32_t);
+  // Tail-filling marker; no real record can have this length because
+  // maxMessageSize() is far smaller.
+  static constexpr uint32_t kWrapMarker = 0xffffffffu;
+  // The write index never catches the read index; since every advance
+  // is header-aligned the minimum gap is one header.
+  static constexpr uint32_t kIndexGap = kHeaderSize;
+
+  static constexpr uint32_t alignUp(uint32_t len) {
+    return (len + kHeaderSize - 1) & ~(kHeaderSize - 1);
+  }
+
+  // Bytes the producer may write after |writeIdx| without catching
+  // |readIdx|.
+  uint32_t freeBytes(uint32_t writeIdx, uint32_t readIdx) const {
+    uint32_t free = readIdx + size_ - writeIdx;
+    if (free > size_) {
+      free -= size_;
+    }
+    return free - kIndexGap;
+  }
+
+  // Offsets are always multiples of kHeaderSize and |data_| is
+  // malloc-aligned, so the casts below are aligned accesses.
+  void storeHeader(uint32_t offset, uint32_t value) {
+    *reinterpret_cast<uint32_t*>(data_ + offset) = value;
+  }
+
+  uint32_t loadHeader(uint32_t offset) const {
+    return *reinterpret_cast<const uint32_t*>(data_ + offset);
+  }
+
+  char pad0_[hardware_destructive_interference_size];
+  const uint32_t size_;
+  uint8_t* const data_;
+
+  // Same cache-line layout as LockFreeProducerConsumerQueue: each index
+  // shares its line with that side's cache of the opposing index.
+  alignas(hardware_destructive_interference_size)
+      std::atomic<uint32_t> readIndex_;
+  uint32_t writeIndexCache_;
+  alignas(hardware_destructive_interference_size)
+      std::atomic<uint32_t> writeIndex_;
+  uint32_t readIndexCache_;
+
+  // Producer-local two-phase state.
+  bool pending_ = false;
+  uint32_t pendingEnd_ = 0;
+
+  char pad1_[hardware_destructive_interference_size -
+             sizeof(std::atomic<uint32_t>) - sizeof(uint32_t)];
+};
+
+}  // namespace basis
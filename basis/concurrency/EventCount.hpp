@@ -0,0 +1,147 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <climits>
+#include <cstdint>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+namespace basis {
+
+/*
+ * EventCount allows to wait for arbitrary predicates in non-blocking
+ * algorithms without giving up their lock-free fast path. Think of it as a
+ * condition variable whose "lock" is the user's own atomic state.
+ *
+ * mimic: folly::EventCount
+ *
+ * Waiter protocol:
+ *
+ *   for (;;) {
+ *     if (predicate()) return;              // lock-free fast path
+ *     EventCount::Key key = ec.prepareWait();
+ *     if (predicate()) { ec.cancelWait(); return; }
+ *     ec.wait(key);                         // parks on a futex
+ *   }
+ *
+ * Notifier protocol: change the state the predicate reads, then call
+ * notify()/notifyAll(). notify() is a single fetch_add plus a conditional
+ * futex wake, so it's cheap enough to call unconditionally on the hot path
+ * (the wake syscall only happens while somebody is parked).
+ *
+ * On non-Linux platforms the futex is emulated with a mutex + condition
+ * variable; the waiter/epoch accounting is identical.
+ */
+class EventCount {
+ public:
+  EventCount() noexcept : val_(0) {}
+
+  EventCount(const EventCount&) = delete;
+  EventCount& operator=(const EventCount&) = delete;
+
+  class Key {
+    friend class EventCount;
+    explicit Key(uint32_t epoch) noexcept : epoch_(epoch) {}
+    uint32_t epoch_;
+  };
+
+  // Registers this thread as a waiter and snapshots the epoch. Must be
+  // paired with exactly one wait() or cancelWait().
+  Key prepareWait() noexcept {
+    uint64_t prev = val_.fetch_add(kAddWaiter, std::memory_order_acq_rel);
+    return Key(static_cast<uint32_t>(prev >> kEpochShift));
+  }
+
+  void cancelWait() noexcept {
+    // memory_order_relaxed would suffice for correctness, but the faster
+    // #waiters gets to 0, the less likely it is that we'll do spurious wakes.
+    val_.fetch_sub(kAddWaiter, std::memory_order_seq_cst);
+  }
+
+  // Parks until the epoch moves past |key|'s snapshot (i.e. somebody called
+  // notify after prepareWait()).
+  void wait(Key key) noexcept {
+    while (epoch()->load(std::memory_order_acquire) == key.epoch_) {
+      futexWait(key.epoch_);
+    }
+    cancelWait();
+  }
+
+  // Wakes one / all parked waiters. May be called from any thread.
+  void notify() noexcept { doNotify(1); }
+  void notifyAll() noexcept { doNotify(INT_MAX); }
+
+ private:
+  // Layout of |val_|: low 32 bits waiter count, high 32 bits epoch. The
+  // epoch half doubles as the futex word.
+  static constexpr uint64_t kAddWaiter = 1;
+  static constexpr uint64_t kWaiterMask = (uint64_t(1) << 32) - 1;
+  static constexpr int kEpochShift = 32;
+  static constexpr uint64_t kAddEpoch = uint64_t(1) << kEpochShift;
+
+  std::atomic<uint32_t>* epoch() noexcept {
+    // The epoch occupies the high half of |val_|.
+    static_assert(sizeof(val_) == 8, "EventCount layout");
+    return reinterpret_cast<std::atomic<uint32_t>*>(
+               reinterpret_cast<char*>(&val_)) +
+           (isLittleEndian() ? 1 : 0);
+  }
+
+  static constexpr bool isLittleEndian() {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return false;
+#else
+    return true;
+#endif
+  }
+
+  void doNotify(int n) noexcept {
+    uint64_t prev = val_.fetch_add(kAddEpoch, std::memory_order_acq_rel);
+    if (prev & kWaiterMask) {
+      futexWake(n);
+    }
+  }
+
+#if defined(__linux__)
+  void futexWait(uint32_t expected) noexcept {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(epoch()),
+            FUTEX_WAIT | FUTEX_PRIVATE_FLAG, expected, nullptr, nullptr, 0);
+  }
+
+  void futexWake(int n) noexcept {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(epoch()),
+            FUTEX_WAKE | FUTEX_PRIVATE_FLAG, n, nullptr, nullptr, 0);
+  }
+#else
+  void futexWait(uint32_t expected) noexcept {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (epoch()->load(std::memory_order_acquire) == expected) {
+      cv_.wait(lock);
+    }
+  }
+
+  void futexWake(int n) noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (n == 1) {
+      cv_.notify_one();
+    } else {
+      cv_.notify_all();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+#endif
+
+  std::atomic<uint64_t> val_;
+};
+
+} // namespace basis
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include <basis/concurrency/LockFreeProducerConsumerQueue.hpp>
+
+namespace basis {
+
+/*
+ * MPMCQueue is a bounded multi-producer multi-consumer queue without locks.
+ *
+ * mimic: Dmitry Vyukov's bounded MPMC queue (ticket ring).
+ *
+ * Every slot carries a sequence number. A producer claims a ticket by
+ * fetch-incrementing |enqueueTicket_| (well, compare-exchanging it, so a
+ * producer that loses the race retries instead of over-claiming a full
+ * queue), writes its record into slot (ticket % capacity) and publishes by
+ * bumping the slot's sequence; a consumer does the symmetric dance on
+ * |dequeueTicket_|. Producers and consumers never contend on the same
+ * atomic, and the two tickets plus each slot's sequence live on their own
+ * cache lines, so throughput scales with cores until the ring itself is
+ * the bottleneck.
+ *
+ * Unlike LockFreeProducerConsumerQueue this queue is safe with any number
+ * of writers and readers; prefer the SPSC queue when the 1:1 topology is
+ * known, it is cheaper per operation.
+ *
+ * capacity must be a power of two (the ticket-to-slot mapping is a mask).
+ * write()/read() are non-blocking and return false when the queue is full/
+ * empty; pair with EventCount (see BlockingProducerConsumerQueue) if a
+ * parking variant is needed.
+ */
+template <class T>
+struct MPMCQueue {
+  typedef T value_type;
+
+  MPMCQueue(const MPMCQueue&) = delete;
+  MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+  explicit MPMCQueue(uint32_t capacity)
+      : capacity_(capacity),
+        mask_(capacity - 1),
+        // malloc() only guarantees max_align_t alignment; the slots are
+        // over-aligned to a cache line, so ask for it explicitly.
+        slots_(static_cast<Slot*>(
+            std::aligned_alloc(alignof(Slot), sizeof(Slot) * capacity))),
+        enqueueTicket_(0),
+        dequeueTicket_(0) {
+    assert(capacity >= 2);
+    // Ticket-to-slot mapping relies on capacity being a power of two.
+    if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+      throw std::invalid_argument("MPMCQueue capacity must be a power of two");
+    }
+    if (!slots_) {
+      throw std::bad_alloc();
+    }
+    for (uint32_t i = 0; i < capacity_; ++i) {
+      new (&slots_[i].sequence) std::atomic<size_t>(i);
+    }
+  }
+
+  ~MPMCQueue() {
+    // No real synchronization needed at destructor time: only one thread
+    // can be doing this.
+    if (!std::is_trivially_destructible<T>::value) {
+      size_t readTicket = dequeueTicket_.load(std::memory_order_relaxed);
+      size_t endTicket = enqueueTicket_.load(std::memory_order_relaxed);
+      while (readTicket != endTicket) {
+        reinterpret_cast<T*>(&slots_[readTicket & mask_].storage)->~T();
+        ++readTicket;
+      }
+    }
+
+    std::free(slots_);
+  }
+
+  // Attempts to enqueue a record; returns false if the queue is full.
+  // Safe to call from any number of threads.
+  template <class... Args>
+  bool write(Args&&... recordArgs) {
+    size_t ticket = enqueueTicket_.load(std::memory_order_relaxed);
+    for (;;) {
+      Slot& slot = slots_[ticket & mask_];
+      size_t seq = slot.sequence.load(std::memory_order_acquire);
+      intptr_t diff =
+          static_cast<intptr_t>(seq) - static_cast<intptr_t>(ticket);
+      if (diff == 0) {
+        // Slot is free for this ticket; try to claim the ticket.
+        if (enqueueTicket_.compare_exchange_weak(
+                ticket, ticket + 1, std::memory_order_relaxed)) {
+          new (&slot.storage) T(std::forward<Args>(recordArgs)...);
+          slot.sequence.store(ticket + 1, std::memory_order_release);
+          return true;
+        }
+        // Lost the race; |ticket| was reloaded by compare_exchange_weak.
+      } else if (diff < 0) {
+        // The slot still holds a record from |capacity_| tickets ago.
+        // queue is full
+        return false;
+      } else {
+        // Another producer already claimed this ticket; catch up.
+        ticket = enqueueTicket_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // move (or copy) a record off the queue to given variable; returns false
+  // if the queue is empty. Safe to call from any number of threads.
+  bool read(T& record) {
+    size_t ticket = dequeueTicket_.load(std::memory_order_relaxed);
+    for (;;) {
+      Slot& slot = slots_[ticket & mask_];
+      size_t seq = slot.sequence.load(std::memory_order_acquire);
+      intptr_t diff =
+          static_cast<intptr_t>(seq) - static_cast<intptr_t>(ticket + 1);
+      if (diff == 0) {
+        // Slot holds the record for this ticket; try to claim the ticket.
+        if (dequeueTicket_.compare_exchange_weak(
+                ticket, ticket + 1, std::memory_order_relaxed)) {
+          T* data = reinterpret_cast<T*>(&slot.storage);
+          record = std::move(*data);
+          data->~T();
+          // Free the slot for the producer one lap ahead of us.
+          slot.sequence.store(ticket + capacity_, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        // The producer for this ticket has not published yet.
+        // queue is empty
+        return false;
+      } else {
+        // Another consumer already claimed this ticket; catch up.
+        ticket = dequeueTicket_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Queries about the state of the queue are approximate under concurrent
+  // access, same caveats as LockFreeProducerConsumerQueue::sizeGuess().
+  bool isEmpty() const { return sizeGuess() == 0; }
+
+  bool isFull() const { return sizeGuess() >= capacity_; }
+
+  size_t sizeGuess() const {
+    size_t write = enqueueTicket_.load(std::memory_order_acquire);
+    size_t read = dequeueTicket_.load(std::memory_order_acquire);
+    return write > read ? write - read : 0;
+  }
+
+  // maximum number of items in the queue.
+  size_t capacity() const { return capacity_; }
+
+ private:
+  // Each slot owns its cache line so producers/consumers spinning on
+  // neighbouring sequences do not false-share.
+  struct alignas(hardware_destructive_interference_size) Slot {
+    std::atomic<size_t> sequence;
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+  };
+
+  char pad0_[hardware_destructive_interference_size];
+  const uint32_t capacity_;
+  const size_t mask_;
+  Slot* const slots_;
+
+  alignas(hardware_destructive_interference_size)
+      std::atomic<size_t> enqueueTicket_;
+  alignas(hardware_destructive_interference_size)
+      std::atomic<size_t> dequeueTicket_;
+
+  char pad1_[hardware_destructive_interference_size -
+             sizeof(std::atomic<size_t>)];
+};
+
+} // namespace basis
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+
+namespace basis {
+
+template <class T>
+struct MPSCIntrusiveQueue;
+
+/*
+ * Base class providing the embedded link; a queue element derives from it:
+ *
+ *   struct MyTask : MPSCQueueNode<MyTask> { ... };
+ *   MPSCIntrusiveQueue<MyTask> queue;
+ */
+template <class T>
+struct MPSCQueueNode {
+ private:
+  friend struct MPSCIntrusiveQueue<T>;
+
+  std::atomic<MPSCQueueNode*> next_{nullptr};
+};
+
+/*
+ * MPSCIntrusiveQueue is an unbounded intrusive multi-producer
+ * single-consumer queue.
+ *
+ * mimic: Dmitry Vyukov's intrusive MPSC node-based queue.
+ *
+ * push() costs one atomic exchange (no CAS loop, so producers never retry
+ * under contention) and may be called from any thread; pop() may only be
+ * called by the single consumer. The queue never allocates: the link lives
+ * inside the element (MPSCQueueNode), so pushing an already-constructed
+ * item is pointer writes only.
+ *
+ * pop() can return nullptr even when an element was pushed, if the pushing
+ * producer is between its exchange and the link store; the window is a few
+ * instructions, so a consumer that knows an element is in flight (e.g. via
+ * an external pending counter) may simply retry.
+ *
+ * Elements are not owned: the consumer must dispose of popped elements,
+ * and anything still queued at destruction time is leaked unless the owner
+ * drains first.
+ */
+template <class T>
+struct MPSCIntrusiveQueue {
+  typedef T value_type;
+
+  MPSCIntrusiveQueue(const MPSCIntrusiveQueue&) = delete;
+  MPSCIntrusiveQueue& operator=(const MPSCIntrusiveQueue&) = delete;
+
+  MPSCIntrusiveQueue() : head_(&stub_), tail_(&stub_) {}
+
+  // Appends an element. Safe from any thread; wait-free.
+  void push(T* item) {
+    Node* node = item;
+    node->next_.store(nullptr, std::memory_order_relaxed);
+    Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+    // Between the exchange and this store the queue is momentarily
+    // "broken" after |prev|; pop() detects that and backs off.
+    prev->next_.store(node, std::memory_order_release);
+  }
+
+  // Removes and returns the oldest element, or nullptr if the queue is
+  // empty or a producer is mid-push (see file comment). Consumer only.
+  T* pop() {
+    Node* tail = tail_;
+    Node* next = tail->next_.load(std::memory_order_acquire);
+
+    if (tail == &stub_) {
+      if (!next) {
+        // Empty (or a producer is mid-push of the very first element).
+        return nullptr;
+      }
+      // Skip past the stub to the first real element.
+      tail_ = next;
+      tail = next;
+      next = next->next_.load(std::memory_order_acquire);
+    }
+
+    if (next) {
+      tail_ = next;
+      return static_cast<T*>(tail);
+    }
+
+    // |tail| looks like the last element; if a producer pushed after it
+    // but has not linked yet, back off instead of losing the element.
+    if (tail != head_.load(std::memory_order_acquire)) {
+      return nullptr;
+    }
+
+    // Queue holds exactly one element: re-insert the stub behind it so the
+    // element can be unlinked.
+    stub_.next_.store(nullptr, std::memory_order_relaxed);
+    Node* prev = head_.exchange(&stub_, std::memory_order_acq_rel);
+    prev->next_.store(&stub_, std::memory_order_release);
+
+    next = tail->next_.load(std::memory_order_acquire);
+    if (next) {
+      tail_ = next;
+      return static_cast<T*>(tail);
+    }
+    return nullptr;
+  }
+
+  // Approximate; exact only when no producer is mid-push. Consumer only.
+  bool isEmpty() const {
+    return tail_ == &stub_ &&
+           stub_.next_.load(std::memory_order_acquire) == nullptr;
+  }
+
+ private:
+  typedef MPSCQueueNode<T> Node;
+
+  // Producers contend on |head_|; |tail_| belongs to the consumer.
+  std::atomic<Node*> head_;
+  Node* tail_;
+  Node stub_;
+};
+
+} // namespace basis
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include <basis/concurrency/LockFreeProducerConsumerQueue.hpp>
+
+namespace basis {
+
+/*
+ * Single-producer single-consumer ring over a caller-provided shared
+ * memory segment, for zero-copy handoff between processes. Uses the same
+ * algorithm as LockFreeProducerConsumerQueue (one wasted slot, acquire
+ * loads of the opposing index, release stores of the own index, cached
+ * opposing index per side) but keeps ALL queue state - indices, capacity
+ * and the records themselves - inside the segment. The segment may be
+ * mapped at different addresses in each process: records are addressed
+ * by offset from the segment base, never by stored pointers.
+ *
+ * Usage:
+ *   producer: shm_open + ftruncate(SegmentSize(n)) + mmap, then
+ *             auto q = SharedMemorySPSCQueue<T>::Create(base, bytes, n);
+ *   consumer: shm_open + mmap, then
+ *             auto q = SharedMemorySPSCQueue<T>::Attach(base, bytes);
+ *
+ * The queue does not own the mapping; the caller unmaps/unlinks it.
+ * Exactly one process may write and one may read at a time. A crashed
+ * peer can leave the ring partially advanced but never structurally
+ * corrupt: indices only ever step to already-published values.
+ */
+template <class T>
+class SharedMemorySPSCQueue {
+  // Records cross a process boundary as raw bytes; anything with
+  // pointers, ownership or vtables would be meaningless (or dangerous)
+  // in the other process.
+  static_assert(std::is_trivially_copyable<T>::value,
+                "Shared-memory queue records must be trivially copyable");
+
+ public:
+  typedef T value_type;
+
+  // The in-segment layout. Indices live on separate cache-line pairs so
+  // producer and consumer processes don't false-share.
+  struct Header {
+    uint32_t magic;
+    uint32_t size;
+    alignas(hardware_destructive_interference_size)
+        std::atomic<uint32_t> readIndex;
+    alignas(hardware_destructive_interference_size)
+        std::atomic<uint32_t> writeIndex;
+  };
+
+  static_assert(std::atomic<uint32_t>::is_always_lock_free,
+                "Indices must be lock free to be shared between processes");
+
+  // Bytes the segment must provide for a queue of |size| slots (usable
+  // capacity is size - 1, as in LockFreeProducerConsumerQueue).
+  static constexpr size_t SegmentSize(uint32_t size) {
+    return RecordsOffset() + sizeof(T) * size;
+  }
+
+  // Initializes a queue in |memory| (typically freshly ftruncate'd shm,
+  // i.e. zero-filled). |memoryBytes| must be at least SegmentSize(size)
+  // and |size| >= 2. Only the creating process may call this, before the
+  // peer attaches.
+  static SharedMemorySPSCQueue Create(void* memory,
+                                      size_t memoryBytes,
+                                      uint32_t size) {
+    assert(size >= 2);
+    assert(memoryBytes >= SegmentSize(size));
+    (void)memoryBytes;
+    Header* header = new (memory) Header();
+    header->size = size;
+    header->readIndex.store(0, std::memory_order_relaxed);
+    header->writeIndex.store(0, std::memory_order_relaxed);
+    // Published last: Attach() in the peer spins on it.
+    header->magic = kMagic;
+    return SharedMemorySPSCQueue(header);
+  }
+
+  // Attaches to a segment previously initialized with Create(). Returns
+  // a queue with valid() == false if the segment doesn't look like one
+  // of ours (wrong magic, or too small for its declared size).
+  static SharedMemorySPSCQueue Attach(void* memory, size_t memoryBytes) {
+    if (memoryBytes < sizeof(Header)) {
+      return SharedMemorySPSCQueue(nullptr);
+    }
+    Header* header = static_cast<Header*>(memory);
+    if (header->magic != kMagic || header->size < 2 ||
+        memoryBytes < SegmentSize(header->size)) {
+      return SharedMemorySPSCQueue(nullptr);
+    }
+    return SharedMemorySPSCQueue(header);
+  }
+
+  bool valid() const { return header_ != nullptr; }
+
+  // Copies |record| into the ring. Returns false when full.
+  bool write(const T& record) {
+    auto const currentWrite =
+        header_->writeIndex.load(std::memory_order_relaxed);
+    auto const nextRecord = nextIndex(currentWrite);
+    if (nextRecord == readIndexCache_) {
+      readIndexCache_ = header_->readIndex.load(std::memory_order_acquire);
+      if (nextRecord == readIndexCache_) {
+        // queue is full
+        return false;
+      }
+    }
+    records()[currentWrite] = record;
+    header_->writeIndex.store(nextRecord, std::memory_order_release);
+    return true;
+  }
+
+  // Copies the front record into |record|. Returns false when empty.
+  bool read(T& record) {
+    auto const currentRead =
+        header_->readIndex.load(std::memory_order_relaxed);
+    if (currentRead == writeIndexCache_) {
+      writeIndexCache_ = header_->writeIndex.load(std::memory_order_acquire);
+      if (currentRead == writeIndexCache_) {
+        // queue is empty
+        return false;
+      }
+    }
+    record = records()[currentRead];
+    header_->readIndex.store(nextIndex(currentRead),
+                             std::memory_order_release);
+    return true;
+  }
+
+  // Pointer to the front record for in-place consumption (this is the
+  // zero-copy path) or nullptr if empty. The record stays valid until
+  // popFront().
+  T* frontPtr() {
+    auto const currentRead =
+        header_->readIndex.load(std::memory_order_relaxed);
+    if (currentRead == writeIndexCache_) {
+      writeIndexCache_ = header_->writeIndex.load(std::memory_order_acquire);
+      if (currentRead == writeIndexCache_) {
+        // queue is empty
+        return nullptr;
+      }
+    }
+    return &records()[currentRead];
+  }
+
+  // queue must not be empty
+  void popFront() {
+    auto const currentRead =
+        header_->readIndex.load(std::memory_order_relaxed);
+    assert(currentRead != header_->writeIndex.load(std::memory_order_acquire));
+    header_->readIndex.store(nextIndex(currentRead),
+                             std::memory_order_release);
+  }
+
+  bool isEmpty() const {
+    return header_->readIndex.load(std::memory_order_acquire) ==
+        header_->writeIndex.load(std::memory_order_acquire);
+  }
+
+  bool isFull() const {
+    return nextIndex(header_->writeIndex.load(std::memory_order_acquire)) ==
+        header_->readIndex.load(std::memory_order_acquire);
+  }
+
+  // Same caveats as LockFreeProducerConsumerQueue::sizeGuess().
+  size_t sizeGuess() const {
+    int ret = header_->writeIndex.load(std::memory_order_acquire) -
+        header_->readIndex.load(std::memory_order_acquire);
+    if (ret < 0) {
+      ret += header_->size;
+    }
+    return ret;
+  }
+
+  // maximum number of items in the queue.
+  size_t capacity() const { return header_->size - 1; }
+
+ private:
+  static constexpr uint32_t kMagic = 0x53505351;  // 'SPSQ'
+
+  // Records start at the first suitably aligned offset past the header;
+  // always the same in every process regardless of mapping address.
+  static constexpr size_t RecordsOffset() {
+    return (sizeof(Header) + alignof(T) - 1) & ~(alignof(T) - 1);
+  }
+
+  explicit SharedMemorySPSCQueue(Header* header) : header_(header) {}
+
+  T* records() const {
+    return reinterpret_cast<T*>(reinterpret_cast<char*>(header_) +
+                                RecordsOffset());
+  }
+
+  uint32_t nextIndex(uint32_t index) const {
+    ++index;
+    return index == header_->size ? 0 : index;
+  }
+
+  Header* header_;
+
+  // Process-local caches of the opposing index (see
+  // LockFreeProducerConsumerQueue); deliberately not in the segment.
+  uint32_t writeIndexCache_ = 0;
+  uint32_t readIndexCache_ = 0;
+};
+
+}  // namespace basis
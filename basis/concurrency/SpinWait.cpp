@@ -0,0 +1,110 @@
+#include "basis/concurrency/SpinWait.hpp"
+
+#include <chrono>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h> // for _mm_pause
+#endif
+
+namespace basis {
+
+namespace {
+
+// Budget clamp: enough pauses to matter even if calibration measures a
+// absurdly slow pause, bounded so a mis-measured fast pause cannot turn
+// phase 1 into a milliseconds-long burn.
+constexpr uint32_t kMinBudget = 64;
+constexpr uint32_t kMaxBudget = 16384;
+
+uint32_t calibrate() noexcept
+{
+  using clock = std::chrono::steady_clock;
+  constexpr uint32_t kProbePauses = 4096;
+
+  // Warm up (first executions may stall on instruction decode).
+  for (uint32_t i = 0; i < 64; ++i) {
+    SpinWait::pause();
+  }
+
+  const clock::time_point begin = clock::now();
+  for (uint32_t i = 0; i < kProbePauses; ++i) {
+    SpinWait::pause();
+  }
+  const clock::time_point end = clock::now();
+
+  const int64_t probe_ns
+    = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin)
+        .count();
+  // Integer ceil of per-pause cost; a preempted probe only makes the
+  // budget smaller (we spin less), never pathological.
+  const int64_t pause_ns
+    = (probe_ns + kProbePauses - 1) / kProbePauses;
+  if (pause_ns <= 0) {
+    return kMaxBudget;
+  }
+
+  const int64_t budget = SpinWait::kTargetSpinNs / pause_ns;
+  if (budget < kMinBudget) {
+    return kMinBudget;
+  }
+  if (budget > kMaxBudget) {
+    return kMaxBudget;
+  }
+  return static_cast<uint32_t>(budget);
+}
+
+} // namespace
+
+bool SpinWait::spin() noexcept
+{
+  if (pauses_spent_ < spinBudget()) {
+    // Exponential ramp: spent+1 doubles the batch each step (1, 2, 4,
+    // ..., capped), so short waits recheck the predicate almost
+    // immediately while long waits settle into cheap 64-pause batches.
+    uint32_t batch = pauses_spent_ + 1;
+    if (batch > kMaxPausesPerStep) {
+      batch = kMaxPausesPerStep;
+    }
+    for (uint32_t i = 0; i < batch; ++i) {
+      pause();
+    }
+    pauses_spent_ += batch;
+    return true;
+  }
+  if (yields_spent_ < kYieldCount) {
+    std::this_thread::yield();
+    ++yields_spent_;
+    return true;
+  }
+  return false;
+}
+
+// static
+void SpinWait::pause() noexcept
+{
+#if defined(__x86_64__) || defined(__i386__)
+  _mm_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield" ::: "memory");
+#else
+  // No hint instruction; the compiler barrier alone keeps the poll
+  // loop from being optimized into a register spin.
+  asm volatile("" ::: "memory");
+#endif
+}
+
+// static
+uint32_t SpinWait::spinBudget() noexcept
+{
+  static const uint32_t budget = calibrate();
+  return budget;
+}
+
+// static
+uint32_t SpinWait::initialize() noexcept
+{
+  return spinBudget();
+}
+
+}  // namespace basis
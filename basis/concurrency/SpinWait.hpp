@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+
+namespace basis {
+
+/*
+ * Calibrated spin-wait with exponential backoff.
+ *
+ * Hand-rolled `while (!ready) {}` loops hammer the cache line they poll,
+ * starve the sibling hyper-thread and, with a fixed iteration count,
+ * spin for wildly different wall times across hosts. SpinWait owns that
+ * policy in one place:
+ *
+ *   phase 1: batches of pause instructions, batch size doubling each
+ *            step (1, 2, 4, ... up to 64), until the calibrated budget
+ *            of pauses is exhausted - polite to SMT siblings, light on
+ *            the memory bus, and a short total wait on any host;
+ *   phase 2: a handful of sched yields, giving a ready thread on the
+ *            same core a chance to run without a full park;
+ *   then:    spin() returns false - the caller should park (e.g. on an
+ *            EventCount futex, see BlockingProducerConsumerQueue).
+ *
+ * The pause budget is calibrated once per process so the phase-1 wall
+ * time lands near kTargetSpinNs regardless of how long the pause
+ * instruction stalls on this microarchitecture (tens of cycles on
+ * recent x86, near-zero elsewhere). Call initialize() during startup to
+ * keep the (sub-millisecond) calibration off latency-sensitive paths.
+ *
+ * Waiter protocol:
+ *
+ *   SpinWait spin_wait;
+ *   for (;;) {
+ *     if (predicate()) return;         // the caller's fast path
+ *     if (!spin_wait.spin()) {
+ *       park();                        // futex/EventCount/condvar
+ *       spin_wait.reset();             // fresh budget after a wakeup
+ *     }
+ *   }
+ */
+class SpinWait {
+ public:
+  // Spin-phase wall-time target; roughly the cost of a park+wake
+  // syscall pair, so spinning never costs more than the park it avoids.
+  static constexpr uint32_t kTargetSpinNs = 4000;
+
+  // Yields attempted after the pause budget, before advising a park.
+  static constexpr uint32_t kYieldCount = 4;
+
+  SpinWait() noexcept = default;
+
+  SpinWait(const SpinWait&) = delete;
+  SpinWait& operator=(const SpinWait&) = delete;
+
+  // One backoff step. Returns true while still spinning (re-check the
+  // predicate and call again); false once the budget is exhausted and
+  // the caller should park.
+  bool spin() noexcept;
+
+  // Starts a fresh budget; call after waking from a park.
+  void reset() noexcept { pauses_spent_ = 0; yields_spent_ = 0; }
+
+  // One pause/yield hint instruction (immediately usable in loops that
+  // manage their own budget).
+  static void pause() noexcept;
+
+  // Calibrated phase-1 budget in pause instructions.
+  static uint32_t spinBudget() noexcept;
+
+  // Forces the calibration now (idempotent); returns spinBudget().
+  static uint32_t initialize() noexcept;
+
+ private:
+  // Longest pause batch; bounds the predicate-recheck latency once the
+  // backoff has fully ramped up.
+  static constexpr uint32_t kMaxPausesPerStep = 64;
+
+  uint32_t pauses_spent_ = 0;
+  uint32_t yields_spent_ = 0;
+};
+
+} // namespace basis
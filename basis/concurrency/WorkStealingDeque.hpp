@@ -0,0 +1,193 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include <basis/concurrency/LockFreeProducerConsumerQueue.hpp>
+
+namespace basis {
+
+/*
+ * WorkStealingDeque is a lock-free Chase-Lev deque for building
+ * work-stealing schedulers.
+ *
+ * mimic: "Dynamic Circular Work-Stealing Deque" (Chase & Lev, 2005) with
+ * the C11 memory-order corrections from Le et al., "Correct and Efficient
+ * Work-Stealing for Weak Memory Models" (2013).
+ *
+ * Exactly one owner thread may call push()/pop() (LIFO end, no atomic RMW
+ * in the common case); any number of thieves may call steal() (FIFO end,
+ * one compare-exchange per successful steal). The LIFO owner end keeps hot
+ * tasks cache-warm while thieves drain the cold end, which is what lets an
+ * imbalanced shard's backlog spread across idle cores instead of funneling
+ * through one FIFO.
+ *
+ * The ring grows geometrically when push() catches up with the thieves;
+ * retired rings are kept alive until the deque is destroyed, because a
+ * thief may still be reading a stale ring pointer. That waste is bounded
+ * (old rings sum to less than the final ring's size).
+ *
+ * T must be trivially copyable - the intended payload is a task pointer or
+ * small POD handle, matching how the thread-pool layer hands out work.
+ */
+template <class T>
+struct WorkStealingDeque {
+  typedef T value_type;
+
+  static_assert(std::is_trivially_copyable<T>::value,
+                "WorkStealingDeque is meant for task pointers / POD handles");
+
+  WorkStealingDeque(const WorkStealingDeque&) = delete;
+  WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+  // capacity must be a power of two; it is only the initial ring size, the
+  // deque grows as needed.
+  explicit WorkStealingDeque(size_t capacity = 1024)
+      : top_(0), bottom_(0), ring_(new Ring(capacity)) {
+    assert(capacity >= 2);
+    assert((capacity & (capacity - 1)) == 0);
+    retired_.reserve(8);
+  }
+
+  ~WorkStealingDeque() {
+    delete ring_.load(std::memory_order_relaxed);
+    for (Ring* ring : retired_) {
+      delete ring;
+    }
+  }
+
+  // Pushes a record onto the owner's end. Owner thread only.
+  void push(T record) {
+    int64_t bottom = bottom_.load(std::memory_order_relaxed);
+    int64_t top = top_.load(std::memory_order_acquire);
+    Ring* ring = ring_.load(std::memory_order_relaxed);
+
+    if (bottom - top > static_cast<int64_t>(ring->capacity()) - 1) {
+      ring = grow(ring, top, bottom);
+    }
+    ring->store(bottom, record);
+    // Publish the record before publishing the new bottom.
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+  }
+
+  // Pops a record from the owner's end (most recently pushed). Owner
+  // thread only. Returns false if the deque was empty or the last record
+  // was lost to a concurrent thief.
+  bool pop(T& record) {
+    int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+    Ring* ring = ring_.load(std::memory_order_relaxed);
+    bottom_.store(bottom, std::memory_order_relaxed);
+    // The bottom_ store must be visible to thieves before top_ is read,
+    // otherwise owner and thief can both take the final record.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = top_.load(std::memory_order_relaxed);
+
+    if (top > bottom) {
+      // deque was empty
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+      return false;
+    }
+
+    record = ring->load(bottom);
+    if (top != bottom) {
+      // More than one record left; no thief can race us for this one.
+      return true;
+    }
+
+    // Final record: race any thieves for it via top_.
+    bool won = top_.compare_exchange_strong(
+        top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+    return won;
+  }
+
+  // Steals a record from the cold end (least recently pushed). Safe from
+  // any thread. Returns false if the deque was empty or the steal lost a
+  // race; callers are expected to retry elsewhere, not spin here.
+  bool steal(T& record) {
+    int64_t top = top_.load(std::memory_order_acquire);
+    // Order the top_ read before the bottom_ read (see pop()).
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t bottom = bottom_.load(std::memory_order_acquire);
+
+    if (top >= bottom) {
+      // deque was empty
+      return false;
+    }
+
+    Ring* ring = ring_.load(std::memory_order_consume);
+    record = ring->load(top);
+    return top_.compare_exchange_strong(
+        top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+  }
+
+  bool isEmpty() const { return sizeGuess() == 0; }
+
+  // Approximate under concurrent access, same caveats as
+  // LockFreeProducerConsumerQueue::sizeGuess().
+  size_t sizeGuess() const {
+    int64_t bottom = bottom_.load(std::memory_order_acquire);
+    int64_t top = top_.load(std::memory_order_acquire);
+    return bottom > top ? static_cast<size_t>(bottom - top) : 0;
+  }
+
+  size_t capacity() const {
+    return ring_.load(std::memory_order_acquire)->capacity();
+  }
+
+ private:
+  // Fixed-size circular array of relaxed-atomic records. Indexed by the
+  // unwrapped top/bottom counters (masked internally).
+  class Ring {
+   public:
+    explicit Ring(size_t capacity)
+        : capacity_(capacity),
+          mask_(capacity - 1),
+          records_(new std::atomic<T>[capacity]) {}
+
+    ~Ring() { delete[] records_; }
+
+    size_t capacity() const { return capacity_; }
+
+    void store(int64_t index, T record) {
+      records_[static_cast<size_t>(index) & mask_].store(
+          record, std::memory_order_relaxed);
+    }
+
+    T load(int64_t index) const {
+      return records_[static_cast<size_t>(index) & mask_].load(
+          std::memory_order_relaxed);
+    }
+
+   private:
+    const size_t capacity_;
+    const size_t mask_;
+    std::atomic<T>* const records_;
+  };
+
+  // Doubles the ring. Owner thread only (called from push()).
+  Ring* grow(Ring* old, int64_t top, int64_t bottom) {
+    Ring* bigger = new Ring(old->capacity() * 2);
+    for (int64_t i = top; i < bottom; ++i) {
+      bigger->store(i, old->load(i));
+    }
+    ring_.store(bigger, std::memory_order_release);
+    // A thief may still hold the old ring pointer; retire, don't delete.
+    retired_.push_back(old);
+    return bigger;
+  }
+
+  alignas(hardware_destructive_interference_size) std::atomic<int64_t> top_;
+  alignas(hardware_destructive_interference_size) std::atomic<int64_t> bottom_;
+  alignas(hardware_destructive_interference_size) std::atomic<Ring*> ring_;
+
+  // Owner thread only.
+  std::vector<Ring*> retired_;
+};
+
+} // namespace basis
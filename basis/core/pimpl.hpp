@@ -476,4 +476,157 @@ private:
     std::aligned_storage_t<Size, Alignment> storage_;
   };
 
+  /// \note Split storage for impls that mix a few hot fields with a
+  /// kilobyte of cold configuration: with everything inline (FastPimpl)
+  /// every array traversal of the wrapping objects drags the cold bytes
+  /// through cache. SplitPimpl keeps the hot part inline through the
+  /// same size/alignment machinery (PIMPL_VALIDATE applies to the hot
+  /// part), and parks the cold part behind one lazily-allocated pointer
+  /// that only the slow paths asking for it ever dereference - so
+  /// arrays of the wrapping objects stay cache-dense.
+  ///
+  /// Typical usage (mirrors FastPimpl; both impl types stay
+  /// forward-declared in the header and defined in the cpp file):
+  ///
+  /// // Session.h:
+  /// class Session {
+  /// public:
+  ///   Session();
+  ///   ~Session();
+  /// private:
+  ///   pimpl::SplitPimpl<
+  ///     class SessionHot    // per-tick fields, inline in the array
+  ///     , class SessionCold // config blob, one pointer away
+  ///     , /*HotSize*/32
+  ///     , /*HotAlignment*/8
+  ///   > m_impl;
+  /// };
+  ///
+  /// Hot part is reached through the pointer-like interface
+  /// (|m_impl->...|, |*m_impl|); cold part through |m_impl.cold()|,
+  /// default-constructed on first access.
+  template<
+      typename HotT
+      , typename ColdT
+      , size_t HotSize
+      , size_t HotAlignment
+      , SizePolicy SizePolicy = SizePolicy::Exact
+      , AlignPolicy AlignPolicy = AlignPolicy::Exact
+    >
+  class SplitPimpl {
+public:
+    // Arguments construct the hot part; the cold part starts
+    // unmaterialized (no allocation).
+    template<typename... Args>
+    SplitPimpl(Args&&... args)
+      : hot_(std::forward<Args>(args)...)
+    {}
+
+    ~SplitPimpl()
+    {
+      delete cold_;
+    }
+
+    // Copy; the cold part is copied only when materialized.
+    SplitPimpl(const SplitPimpl& rhs)
+      : hot_(rhs.hot_)
+      , cold_(rhs.cold_ ? new ColdT(*rhs.cold_) : nullptr)
+    {}
+
+    // Copy assign
+    SplitPimpl& operator=(const SplitPimpl& rhs)
+    {
+      if (this != &rhs)
+      {
+        hot_ = rhs.hot_;
+        ColdT* cold = rhs.cold_ ? new ColdT(*rhs.cold_) : nullptr;
+        delete cold_;
+        cold_ = cold;
+      }
+
+      return *this;
+    }
+
+    // Move; steals the cold allocation.
+    SplitPimpl(SplitPimpl&& rhs)
+      : hot_(std::move(rhs.hot_))
+      , cold_(rhs.cold_)
+    {
+      rhs.cold_ = nullptr;
+    }
+
+    // Move assign
+    SplitPimpl& operator=(SplitPimpl&& rhs)
+    {
+      if (this != &rhs)
+      {
+        hot_ = std::move(rhs.hot_);
+        delete cold_;
+        cold_ = rhs.cold_;
+        rhs.cold_ = nullptr;
+      }
+
+      return *this;
+    }
+
+    // Hot accessors; see FastPimpl for the validation applied.
+
+    HotT* operator->() noexcept
+    {
+      return hot_.operator->();
+    }
+
+    const HotT* operator->() const noexcept
+    {
+      return hot_.operator->();
+    }
+
+    HotT& operator*() noexcept
+    {
+      return *hot_;
+    }
+
+    const HotT& operator*() const noexcept
+    {
+      return *hot_;
+    }
+
+    /// \note default-constructed on first access, so objects that never
+    /// walk a cold path never pay the allocation
+    ColdT& cold()
+    {
+      if (!cold_)
+      {
+        cold_ = new ColdT();
+      }
+      return *cold_;
+    }
+
+    // Returns nullptr while the cold part is unmaterialized.
+    const ColdT* cold_ptr() const noexcept
+    {
+      return cold_;
+    }
+
+    bool has_cold() const noexcept
+    {
+      return cold_ != nullptr;
+    }
+
+private:
+    /// \note reuses FastPimpl, so the PIMPL_VALIDATE size/alignment
+    /// checks cover the hot part
+    FastPimpl<
+      HotT
+      , HotSize
+      , HotAlignment
+      , SizePolicy
+      , AlignPolicy
+    > hot_;
+
+    /// \note costs the hot object one pointer; the pointee is pulled
+    /// into cache only by the slow paths that call |cold()|
+    ColdT* cold_ = nullptr;
+  };
+
 } // namespace pimpl
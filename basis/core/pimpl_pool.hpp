@@ -0,0 +1,220 @@
+#pragma once
+
+/// \note This is `standalone` header that can depend only on `std`.
+/// Don't `include` any non-standard files here.
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/// \note |FastPimpl| (see pimpl.hpp) removes the per-object heap
+/// allocation of the classic pimpl idiom, but a container of pimpl'd
+/// objects still pays one allocation (and one arbitrary heap address)
+/// per element. |PimplPool| complements it: all objects live in one
+/// contiguous cache-aligned slab, so creating/destroying thousands of
+/// short-lived objects per second (e.g. per-connection sessions) costs
+/// no per-object heap traffic, and iterating live objects walks memory
+/// linearly.
+/// \see about `Data Locality` https://gameprogrammingpatterns.com/data-locality.html
+
+/// \note |T| is usually a type whose implementation details are hidden
+/// behind |FastPimpl| members; because |FastPimpl| inlines its storage,
+/// pooling the outer object automatically pools the pimpl'd state too.
+/// Any regular type works, though.
+
+/// \note The pool has fixed capacity chosen at construction.
+/// Exhaustion is a sizing bug, not a runtime condition we grow around:
+/// growing would move (or fragment) the slab and defeat the whole
+/// point of contiguity. |Acquire| asserts in debug builds and returns
+/// nullptr in release builds when the pool is full.
+
+// Typical usage:
+//
+//   pimpl::PimplPool<Session> pool(/*capacity*/ 4096);
+//
+//   Session* s = pool.Acquire(socket_fd);
+//   ...
+//   pool.Release(s);       // destroys one object, slot is reused
+//   ...
+//   pool.Clear();          // bulk destruction of everything still live
+
+namespace pimpl {
+
+  template<typename T>
+  class PimplPool {
+    /// \note We want the slab start on a cache-line boundary so the
+    /// first object never straddles a line it shares with unrelated
+    /// heap metadata; objects inside the slab stay densely packed at
+    /// alignof(T) (per-object cache-line padding would waste the
+    /// locality we are here for).
+#if defined(__cpp_lib_hardware_interference_size)
+    static constexpr std::size_t kSlabAlignment =
+      std::hardware_destructive_interference_size > alignof(T)
+        ? std::hardware_destructive_interference_size
+        : alignof(T);
+#else
+    static constexpr std::size_t kSlabAlignment =
+      64 > alignof(T) ? 64 : alignof(T);
+#endif
+
+public:
+    explicit PimplPool(std::size_t capacity)
+      : capacity_(capacity)
+      , live_(capacity, 0)
+    {
+      assert(capacity > 0
+        && "PimplPool: capacity must be non-zero");
+
+      // uses aligned operator new so the slab itself never relies on
+      // malloc's max_align_t guarantee
+      slab_ = static_cast<unsigned char*>(
+        ::operator new(capacity * sizeof(T),
+                       std::align_val_t{kSlabAlignment}));
+
+      free_.reserve(capacity);
+    }
+
+    // Bulk destruction: every object still live is destroyed with the
+    // slab, so owners of short-lived batches may skip per-object
+    // |Release| entirely.
+    ~PimplPool()
+    {
+      Clear();
+
+      ::operator delete(slab_, std::align_val_t{kSlabAlignment});
+    }
+
+    // Constructs a |T| in the next free slot.
+    // Returns nullptr if the pool is exhausted (asserts in debug builds).
+    template<typename... Args>
+    T* Acquire(Args&&... args)
+    {
+      std::size_t index;
+      if (!free_.empty())
+      {
+        index = free_.back();
+        free_.pop_back();
+      }
+      else if (cursor_ < capacity_)
+      {
+        index = cursor_++;
+      }
+      else
+      {
+        assert(false
+          && "PimplPool: exhausted; pick a bigger capacity");
+        return nullptr;
+      }
+
+      // uses placement new to construct into the slab
+      T* object = new (SlotAt(index)) T(std::forward<Args>(args)...);
+      live_[index] = 1;
+      ++size_;
+      return object;
+    }
+
+    // Destroys one object and recycles its slot.
+    void Release(T* object)
+    {
+      assert(object);
+
+      const std::size_t index = IndexOf(object);
+      assert(live_[index]
+        && "PimplPool: double Release or foreign pointer");
+
+      object->~T();
+      live_[index] = 0;
+      --size_;
+      free_.push_back(index);
+    }
+
+    // Destroys all live objects (in slab order) and resets the pool to
+    // its freshly-constructed state. O(capacity) flag scan, but one
+    // pass over contiguous memory - this is the cheap way to tear down
+    // thousands of sessions at once.
+    void Clear()
+    {
+      for (std::size_t index = 0; index < cursor_; ++index)
+      {
+        if (live_[index])
+        {
+          SlotAt(index)->~T();
+          live_[index] = 0;
+        }
+      }
+      cursor_ = 0;
+      size_ = 0;
+      free_.clear();
+    }
+
+    // Number of live objects.
+    std::size_t size() const noexcept
+    {
+      return size_;
+    }
+
+    std::size_t capacity() const noexcept
+    {
+      return capacity_;
+    }
+
+    bool empty() const noexcept
+    {
+      return size_ == 0;
+    }
+
+    // True if |object| points into this pool's slab.
+    // Useful for asserts at ownership boundaries.
+    bool Owns(const T* object) const noexcept
+    {
+      const unsigned char* raw =
+        reinterpret_cast<const unsigned char*>(object);
+      return raw >= slab_ && raw < slab_ + capacity_ * sizeof(T);
+    }
+
+    PimplPool(const PimplPool&) = delete;
+    PimplPool& operator=(const PimplPool&) = delete;
+
+private:
+    inline /* use `inline` to eleminate function call overhead */
+    T* SlotAt(std::size_t index) noexcept
+    {
+      return reinterpret_cast<T*>(slab_ + index * sizeof(T));
+    }
+
+    inline /* use `inline` to eleminate function call overhead */
+    std::size_t IndexOf(const T* object) const noexcept
+    {
+      assert(Owns(object));
+
+      return static_cast<std::size_t>(
+        reinterpret_cast<const unsigned char*>(object) - slab_)
+          / sizeof(T);
+    }
+
+    const std::size_t capacity_;
+
+    // Contiguous cache-aligned storage for |capacity_| objects.
+    unsigned char* slab_ = nullptr;
+
+    // High-water mark: slots in [0, cursor_) have been handed out at
+    // least once; slots past it are untouched and need no flag scan.
+    std::size_t cursor_ = 0;
+
+    std::size_t size_ = 0;
+
+    // One flag per slot so |Clear| and the destructor know which slots
+    // hold live objects (std::uint8_t, not std::vector<bool>, to keep
+    // the scan branch simple).
+    std::vector<std::uint8_t> live_;
+
+    // Recycled slot indices, LIFO so the hottest (most recently
+    // touched) slot is reused first.
+    std::vector<std::size_t> free_;
+  };
+
+} // namespace pimpl
@@ -0,0 +1,81 @@
+#include "basis/cpu_features.hpp" // IWYU pragma: associated
+
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#define BASIS_CPU_FEATURES_X86 1
+#endif
+
+namespace basis {
+
+namespace {
+
+#if defined(BASIS_CPU_FEATURES_X86)
+
+// XCR0 via xgetbv: the OS must opt into saving the wider register
+// files, otherwise executing AVX code corrupts other threads' state on
+// context switch. cpuid alone is not enough.
+uint64_t xgetbv0()
+{
+  uint32_t eax, edx;
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return (static_cast<uint64_t>(edx) << 32) | eax;
+}
+
+CpuFeatures probe()
+{
+  CpuFeatures features;
+
+  uint32_t eax, ebx, ecx, edx;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+    return features;
+  }
+
+  features.has_ssse3 = ecx & (1u << 9);
+  features.has_sse42 = ecx & (1u << 20);
+  features.has_popcnt = ecx & (1u << 23);
+
+  const bool osxsave = ecx & (1u << 27);
+  const bool cpu_avx = ecx & (1u << 28);
+
+  // XCR0 bit 1 = XMM, bit 2 = YMM; bits 5..7 = opmask/ZMM_Hi256/Hi16_ZMM.
+  const uint64_t xcr0 = osxsave ? xgetbv0() : 0;
+  const bool os_ymm = (xcr0 & 0x6) == 0x6;
+  const bool os_zmm = (xcr0 & 0xe6) == 0xe6;
+
+  features.has_avx = cpu_avx && os_ymm;
+
+  if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+    features.has_bmi2 = ebx & (1u << 8);
+    features.has_avx2 = features.has_avx && (ebx & (1u << 5));
+    features.has_avx512f = os_zmm && (ebx & (1u << 16));
+    features.has_avx512bw = features.has_avx512f && (ebx & (1u << 30));
+  }
+
+  if (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) {
+    features.has_invariant_tsc = edx & (1u << 8);
+  }
+
+  return features;
+}
+
+#else  // BASIS_CPU_FEATURES_X86
+
+// Non-x86: no flags, resolvers fall through to the scalar kernels.
+CpuFeatures probe()
+{
+  return CpuFeatures{};
+}
+
+#endif  // BASIS_CPU_FEATURES_X86
+
+}  // namespace
+
+const CpuFeatures& cpuFeatures()
+{
+  static const CpuFeatures features = probe();
+  return features;
+}
+
+}  // namespace basis
@@ -0,0 +1,79 @@
+#pragma once
+
+// Runtime CPU-feature detection and kernel dispatch.
+//
+// platform_detection.hpp answers questions at preprocessor time, which
+// picks the kernel for the build machine, not the host: one shipped
+// binary lands on everything from SSE4-only boxes to AVX-512 servers.
+// This header adds the runtime half: cpuid-probed feature flags plus a
+// BASIS_MULTIARCH helper that routes a function through a function
+// pointer resolved exactly once (thread-safe magic static), so each
+// kernel family costs a single predictable indirect call after
+// startup.
+//
+// USAGE:
+//   // Kernels, each compiled for its ISA (per-function target
+//   // attributes or separate TUs with their own -m flags):
+//   size_t countImplScalar(const uint8_t* p, size_t n);
+//   size_t countImplAvx2(const uint8_t* p, size_t n)
+//     __attribute__((target("avx2")));
+//
+//   // The resolver picks the best kernel the host supports; runs once.
+//   static size_t (*resolveCount())(const uint8_t*, size_t)
+//   {
+//     const basis::CpuFeatures& cpu = basis::cpuFeatures();
+//     if (cpu.has_avx2) return &countImplAvx2;
+//     return &countImplScalar;
+//   }
+//
+//   BASIS_MULTIARCH(size_t, count
+//     , (const uint8_t* p, size_t n), (p, n), resolveCount)
+//
+//   // callers just call count(p, n)
+//
+// A kernel must only be *executed* on a host with its ISA; the resolver
+// is the single place that guarantees that, so never call a kernel
+// directly.
+
+namespace basis {
+
+// One flag per instruction-set extension the kernels in this tree care
+// about. AVX flags are false unless the OS saves the wider registers
+// (XGETBV), so a set flag always means "safe to execute".
+struct CpuFeatures {
+  // x86 SIMD generations, each implying the previous ones in practice.
+  bool has_sse42 = false;
+  bool has_ssse3 = false;
+  bool has_avx = false;
+  bool has_avx2 = false;
+  // Foundation + the byte/word ops the string kernels would need; both
+  // set only when the OS saves ZMM state.
+  bool has_avx512f = false;
+  bool has_avx512bw = false;
+
+  // Scalar helpers kernels key on.
+  bool has_popcnt = false;
+  bool has_bmi2 = false;
+
+  // TSC ticks at a constant rate across P-states and deep C-states
+  // (cpuid 0x80000007), so rdtsc is usable as a wall-time source (see
+  // basis::FastClock).
+  bool has_invariant_tsc = false;
+};
+
+// The probed features of this host; cpuid runs on first call, every
+// later call is a load. Never returns different answers within one
+// process.
+const CpuFeatures& cpuFeatures();
+
+}  // namespace basis
+
+// Defines `ret name params` that forwards to the kernel chosen by
+// |resolver| (a function returning the kernel pointer), resolved on
+// first call and cached in a function-local static.
+#define BASIS_MULTIARCH(ret, name, params, args, resolver) \
+  inline ret name params                                   \
+  {                                                        \
+    static const auto basis_multiarch_impl = resolver();   \
+    return basis_multiarch_impl args;                      \
+  }
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <type_traits>
+
+namespace basis {
+
+// Constexpr enum<->string reflection declared alongside the EnumSet
+// type bounds (basis/enum_set.hpp), replacing the runtime
+// std::map<std::string, E> lookups in config/network parsing: the
+// whole table is built at compile time, enum->string is one array
+// index and string->enum is a binary search over a name-sorted copy -
+// no allocation, no hashing, and misspelled or missing entries fail
+// the build instead of the parse.
+//
+// |EnumNameTable| USAGE:
+//
+// enum class Fruit {
+//   kApple,
+//   kMin = kApple,
+//   kBanana,
+//   kCherry,
+//   kMax = kCherry
+// };
+// using FruitSet = EnumSet<Fruit, Fruit::kMin, Fruit::kMax>;
+//
+// inline constexpr EnumNameTable<FruitSet> kFruitNames({
+//   {Fruit::kApple, "apple"},
+//   {Fruit::kBanana, "banana"},
+//   {Fruit::kCherry, "cherry"},
+// });
+// static_assert(kFruitNames.isComplete()
+//   , "every Fruit needs a distinct name");
+//
+// kFruitNames.nameOf(Fruit::kBanana);     // "banana", O(1)
+// Fruit fruit;
+// kFruitNames.parse("cherry", &fruit);    // true, O(log N), no alloc
+template <typename TEnumSet>
+class EnumNameTable {
+ public:
+  using EnumType = typename TEnumSet::EnumType;
+  static constexpr size_t kValueCount = TEnumSet::kValueCount;
+
+  struct Entry {
+    EnumType value;
+    std::string_view name;
+  };
+
+  // One entry per value in [kMinValue, kMaxValue], any order.
+  constexpr explicit EnumNameTable(const Entry (&entries)[kValueCount])
+    : names_{}, by_name_{}
+  {
+    for(size_t i = 0; i < kValueCount; ++i) {
+      names_[indexOf(entries[i].value)] = entries[i].name;
+      by_name_[i] = entries[i];
+    }
+    // Name-sorted copy for parse(); insertion sort is constexpr-legal
+    // in C++17 and these tables are small.
+    for(size_t i = 1; i < kValueCount; ++i) {
+      const Entry key = by_name_[i];
+      size_t j = i;
+      for(; j > 0 && key.name < by_name_[j - 1].name; --j) {
+        by_name_[j] = by_name_[j - 1];
+      }
+      by_name_[j] = key;
+    }
+  }
+
+  // O(1). Empty view for values outside [kMinValue, kMaxValue] (or
+  // never listed - rule that out with static_assert(isComplete())).
+  constexpr std::string_view nameOf(EnumType value) const noexcept
+  {
+    if(underlying(value) < underlying(TEnumSet::kMinValue)
+       || underlying(value) > underlying(TEnumSet::kMaxValue))
+    {
+      return std::string_view();
+    }
+    return names_[indexOf(value)];
+  }
+
+  // Binary search over the name-sorted copy: O(log N), no allocation.
+  // Returns false (leaving |out| untouched) when |name| is unknown.
+  constexpr bool parse(std::string_view name, EnumType* out) const noexcept
+  {
+    size_t lo = 0;
+    size_t hi = kValueCount;
+    while(lo < hi) {
+      const size_t mid = lo + (hi - lo) / 2;
+      if(by_name_[mid].name < name) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    if(lo == kValueCount || by_name_[lo].name != name) {
+      return false;
+    }
+    *out = by_name_[lo].value;
+    return true;
+  }
+
+  // True when every value in range got a name and no name repeats;
+  // meant for a static_assert next to the table definition.
+  constexpr bool isComplete() const noexcept
+  {
+    for(size_t i = 0; i < kValueCount; ++i) {
+      if(names_[i].empty()) {
+        return false;
+      }
+    }
+    for(size_t i = 1; i < kValueCount; ++i) {
+      // by_name_ is sorted, so duplicates sit next to each other.
+      if(!(by_name_[i - 1].name < by_name_[i].name)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ private:
+  using Underlying = std::underlying_type_t<EnumType>;
+
+  static constexpr Underlying underlying(EnumType value)
+  {
+    return static_cast<Underlying>(value);
+  }
+
+  static constexpr size_t indexOf(EnumType value)
+  {
+    return static_cast<size_t>(
+      underlying(value) - underlying(TEnumSet::kMinValue));
+  }
+
+  // Indexed by value - kMinValue.
+  std::string_view names_[kValueCount];
+
+  // Sorted by name, for parse().
+  Entry by_name_[kValueCount];
+};
+
+}  // namespace basis
@@ -0,0 +1,159 @@
+#include "basis/fast_clock.hpp" // IWYU pragma: associated
+
+#include <basis/cpu_features.hpp>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h> // for __rdtsc
+#define BASIS_FAST_CLOCK_X86 1
+#elif defined(__aarch64__)
+#define BASIS_FAST_CLOCK_ARM64 1
+#endif
+
+namespace basis {
+
+namespace {
+
+// ns = base_ns + ((ticks - base_ticks) * mult >> kShift); the 128-bit
+// intermediate keeps the conversion exact for centuries of uptime.
+constexpr int kShift = 32;
+
+struct Calibration {
+  bool use_tsc = false;
+  uint64_t base_ticks = 0;
+  int64_t base_ns = 0;
+  uint64_t mult = 0;
+};
+
+int64_t steadyNowNs()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#if defined(BASIS_FAST_CLOCK_X86)
+
+uint64_t readTicks()
+{
+  return __rdtsc();
+}
+
+// Paired (steady, tsc, steady) read: the midpoint of the two steady
+// reads is the best estimate of when the tsc read happened, which
+// cancels most of the vDSO-call latency out of the calibration.
+void samplePair(int64_t* ns, uint64_t* ticks)
+{
+  const int64_t before = steadyNowNs();
+  *ticks = readTicks();
+  const int64_t after = steadyNowNs();
+  *ns = before + (after - before) / 2;
+}
+
+Calibration calibrate()
+{
+  Calibration calibration;
+  if (!cpuFeatures().has_invariant_tsc) {
+    // A TSC that changes rate with frequency scaling would silently
+    // warp every measurement; fall back.
+    return calibration;
+  }
+
+  int64_t ns0, ns1;
+  uint64_t ticks0, ticks1;
+  samplePair(&ns0, &ticks0);
+  // ~0.5 ms window: clock-pair jitter is tens of nanoseconds, so the
+  // resulting frequency error is ~1e-4 - irrelevant for durations that
+  // are compared against each other and against millisecond ticks.
+  do {
+    samplePair(&ns1, &ticks1);
+  } while (ns1 - ns0 < 500000);
+
+  if (ticks1 <= ticks0) {
+    return calibration;
+  }
+
+  calibration.mult = static_cast<uint64_t>(
+    (static_cast<unsigned __int128>(ns1 - ns0) << kShift)
+    / (ticks1 - ticks0));
+  calibration.base_ticks = ticks1;
+  calibration.base_ns = ns1;
+  calibration.use_tsc = calibration.mult != 0;
+  return calibration;
+}
+
+#elif defined(BASIS_FAST_CLOCK_ARM64)
+
+uint64_t readTicks()
+{
+  uint64_t ticks;
+  asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+  return ticks;
+}
+
+// The architected counter advertises its exact frequency; no
+// measurement window needed.
+Calibration calibrate()
+{
+  Calibration calibration;
+  uint64_t freq;
+  asm volatile("mrs %0, cntfrq_el0" : "=r"(freq));
+  if (freq == 0) {
+    return calibration;
+  }
+  calibration.mult = static_cast<uint64_t>(
+    (static_cast<unsigned __int128>(1000000000u) << kShift) / freq);
+  calibration.base_ticks = readTicks();
+  calibration.base_ns = steadyNowNs();
+  calibration.use_tsc = true;
+  return calibration;
+}
+
+#else
+
+uint64_t readTicks()
+{
+  return 0;
+}
+
+Calibration calibrate()
+{
+  return Calibration{};
+}
+
+#endif
+
+const Calibration& calibration()
+{
+  static const Calibration calibration = calibrate();
+  return calibration;
+}
+
+}  // namespace
+
+// static
+FastClock::time_point FastClock::now() noexcept
+{
+  const Calibration& tsc = calibration();
+  if (!tsc.use_tsc) {
+    return time_point(duration(steadyNowNs()));
+  }
+  const uint64_t ticks = readTicks() - tsc.base_ticks;
+  const int64_t ns
+    = tsc.base_ns
+      + static_cast<int64_t>(
+          (static_cast<unsigned __int128>(ticks) * tsc.mult) >> kShift);
+  return time_point(duration(ns));
+}
+
+// static
+bool FastClock::initialize() noexcept
+{
+  return calibration().use_tsc;
+}
+
+// static
+bool FastClock::usingTsc() noexcept
+{
+  return calibration().use_tsc;
+}
+
+}  // namespace basis
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace basis {
+
+// Cheap monotonic clock for timing-heavy code.
+//
+// std::chrono::steady_clock::now() is a vDSO call costing ~20 ns; the
+// fixed-step loop reads the clock several times per tick and the frame
+// pacer spins on it, so the clock itself becomes a measurable slice of
+// the tick budget. FastClock reads the timestamp counter instead
+// (~5 ns, fully inlineable ordering-wise) and converts to nanoseconds
+// with a multiply/shift calibrated against steady_clock once per
+// process.
+//
+// Trustworthiness: rdtsc is only used when cpuid reports an invariant
+// TSC (constant rate across frequency scaling and deep sleep); on
+// aarch64 the architected counter with its exact cntfrq frequency is
+// used; everywhere else now() falls back to steady_clock, so FastClock
+// is always correct, just not always fast.
+//
+// The epoch is aligned with steady_clock at calibration time, but
+// FastClock time_points are their own clock: compare and subtract them
+// against each other, not against steady_clock's.
+//
+// The first call calibrates (<= ~0.5 ms busy); call initialize() during
+// startup to keep that off latency-sensitive paths.
+class FastClock {
+ public:
+  // TrivialClock interface - drop-in for steady_clock in the time_step
+  // and timer modules.
+  using rep = int64_t;
+  using period = std::nano;
+  using duration = std::chrono::nanoseconds;
+  using time_point = std::chrono::time_point<FastClock, duration>;
+  static constexpr bool is_steady = true;
+
+  static time_point now() noexcept;
+
+  // Forces calibration now (idempotent). Returns usingTsc().
+  static bool initialize() noexcept;
+
+  // True when now() is counter-backed; false means the steady_clock
+  // fallback is in use (non-x86/arm64, or no invariant TSC).
+  static bool usingTsc() noexcept;
+};
+
+}  // namespace basis
@@ -0,0 +1,222 @@
+#include "basis/flat_json.h" // IWYU pragma: associated
+
+#include <deque>
+#include <utility>
+
+#include "basis/serializers.h"
+
+namespace chromecast {
+
+namespace {
+
+constexpr uint32_t kInvalid = FlatJsonDocument::kInvalidIndex;
+
+// Builds the document in two stages: the streaming parse appends nodes
+// in document order with first/last-child + next-sibling links (no
+// per-node allocations, the links live in the same vector), then a
+// breadth-first renumbering produces the final layout in which the
+// children of every container are contiguous.
+class FlatJsonBuilder : public JsonStreamHandler {
+ public:
+  FlatJsonBuilder() = default;
+
+  bool BeginObject() override {
+    return BeginContainer(FlatJsonDocument::Type::kObject);
+  }
+
+  bool EndObject() override { return EndContainer(); }
+
+  bool BeginArray() override {
+    return BeginContainer(FlatJsonDocument::Type::kArray);
+  }
+
+  bool EndArray() override { return EndContainer(); }
+
+  bool Key(base::StringPiece key) override {
+    pending_key_offset_ = Intern(key);
+    pending_key_length_ = static_cast<uint32_t>(key.size());
+    return pending_key_offset_ != kInvalid;
+  }
+
+  bool StringValue(base::StringPiece value) override {
+    TempNode node;
+    node.node.type = FlatJsonDocument::Type::kString;
+    node.node.string_offset = Intern(value);
+    node.node.string_length = static_cast<uint32_t>(value.size());
+    if (node.node.string_offset == kInvalid)
+      return false;
+    return Append(std::move(node));
+  }
+
+  bool IntValue(int value) override {
+    TempNode node;
+    node.node.type = FlatJsonDocument::Type::kInt;
+    node.node.int_value = value;
+    return Append(std::move(node));
+  }
+
+  bool DoubleValue(double value) override {
+    TempNode node;
+    node.node.type = FlatJsonDocument::Type::kDouble;
+    node.node.double_value = value;
+    return Append(std::move(node));
+  }
+
+  bool BoolValue(bool value) override {
+    TempNode node;
+    node.node.type = FlatJsonDocument::Type::kBool;
+    node.node.bool_value = value;
+    return Append(std::move(node));
+  }
+
+  bool NullValue() override {
+    TempNode node;
+    node.node.type = FlatJsonDocument::Type::kNull;
+    return Append(std::move(node));
+  }
+
+  // Flattens into the final breadth-first layout (children of every
+  // container contiguous). Only valid after a successful parse
+  // (balanced containers, at least one node); false on an empty parse.
+  bool TakeParts(std::vector<FlatJsonDocument::Node>* out_nodes,
+                 std::string* out_strings) {
+    DCHECK(open_.empty());
+    if (temp_.empty())
+      return false;
+
+    std::vector<uint32_t> order;
+    order.reserve(temp_.size());
+    std::vector<uint32_t> final_of(temp_.size(), kInvalid);
+
+    // BFS enqueues the children of each node back to back, which is
+    // exactly the "children contiguous" layout.
+    std::deque<uint32_t> queue;
+    queue.push_back(0);
+    while (!queue.empty()) {
+      const uint32_t t = queue.front();
+      queue.pop_front();
+      final_of[t] = static_cast<uint32_t>(order.size());
+      order.push_back(t);
+      for (uint32_t child = temp_[t].first_child; child != kInvalid;
+           child = temp_[child].next_sibling) {
+        queue.push_back(child);
+      }
+    }
+    DCHECK(order.size() == temp_.size());
+
+    out_nodes->clear();
+    out_nodes->reserve(order.size());
+    for (const uint32_t t : order) {
+      FlatJsonDocument::Node node = temp_[t].node;
+      node.first_child = temp_[t].first_child != kInvalid
+                             ? final_of[temp_[t].first_child]
+                             : kInvalid;
+      out_nodes->push_back(node);
+    }
+    *out_strings = std::move(strings_);
+    return true;
+  }
+
+ private:
+  struct TempNode {
+    FlatJsonDocument::Node node;
+    uint32_t first_child = kInvalid;
+    uint32_t last_child = kInvalid;
+    uint32_t next_sibling = kInvalid;
+  };
+
+  // Copies |piece| into the arena and returns its offset, or kInvalid
+  // if the arena would outgrow 32-bit offsets (a multi-gigabyte
+  // document; callers treat that as a parse failure).
+  uint32_t Intern(base::StringPiece piece) {
+    if (strings_.size() + piece.size() >= kInvalid)
+      return kInvalid;
+    const uint32_t offset = static_cast<uint32_t>(strings_.size());
+    strings_.append(piece.data(), piece.size());
+    return offset;
+  }
+
+  bool Append(TempNode node) {
+    if (pending_key_offset_ != kInvalid) {
+      node.node.key_offset = pending_key_offset_;
+      node.node.key_length = pending_key_length_;
+      pending_key_offset_ = kInvalid;
+      pending_key_length_ = 0;
+    }
+    const uint32_t index = static_cast<uint32_t>(temp_.size());
+    if (index == kInvalid)
+      return false;
+    if (!open_.empty()) {
+      TempNode& parent = temp_[open_.back()];
+      if (parent.last_child == kInvalid) {
+        parent.first_child = index;
+      } else {
+        temp_[parent.last_child].next_sibling = index;
+      }
+      parent.last_child = index;
+      ++parent.node.child_count;
+    } else {
+      // The parser guarantees a single root.
+      DCHECK(temp_.empty());
+    }
+    temp_.push_back(std::move(node));
+    last_appended_ = index;
+    return true;
+  }
+
+  bool BeginContainer(FlatJsonDocument::Type type) {
+    TempNode node;
+    node.node.type = type;
+    if (!Append(std::move(node)))
+      return false;
+    open_.push_back(last_appended_);
+    return true;
+  }
+
+  bool EndContainer() {
+    DCHECK(!open_.empty());
+    open_.pop_back();
+    return true;
+  }
+
+  std::vector<TempNode> temp_;
+  // Stack of open containers (indices into |temp_|).
+  std::vector<uint32_t> open_;
+  uint32_t last_appended_ = kInvalid;
+  uint32_t pending_key_offset_ = kInvalid;
+  uint32_t pending_key_length_ = 0;
+  std::string strings_;
+};
+
+}  // namespace
+
+FlatJsonDocument::NodeRef FlatJsonDocument::NodeRef::FindKey(
+    base::StringPiece key) const {
+  DCHECK(type() == Type::kObject);
+  const uint32_t first = node().first_child;
+  const uint32_t count = node().child_count;
+  for (uint32_t i = 0; i < count; ++i) {
+    const Node& child = doc_->nodes_[first + i];
+    if (doc_->ArenaView(child.key_offset, child.key_length) == key) {
+      return NodeRef(doc_, first + i);
+    }
+  }
+  return NodeRef();
+}
+
+std::unique_ptr<FlatJsonDocument> DeserializeFromJsonFlat(
+    const std::string& text) {
+  FlatJsonBuilder builder;
+  if (!StreamJsonFromString(text, &builder)) {
+    return nullptr;
+  }
+  std::vector<FlatJsonDocument::Node> nodes;
+  std::string strings;
+  if (!builder.TakeParts(&nodes, &strings)) {
+    return nullptr;
+  }
+  return std::unique_ptr<FlatJsonDocument>(
+      new FlatJsonDocument(std::move(nodes), std::move(strings)));
+}
+
+}  // namespace chromecast
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/logging.h"
+#include "base/strings/string_piece.h"
+
+namespace chromecast {
+
+// Flat, arena-backed representation of a parsed JSON document.
+//
+// DeserializeFromJson (basis/serializers.h) hands back a base::Value
+// tree of thousands of individually allocated nodes; walking it is a
+// pointer chase with a cache miss per node. FlatJsonDocument stores
+// every node in one contiguous vector and every string (keys and
+// values) in one arena; the direct children of any container occupy
+// consecutive node slots, so traversal and key lookup are linear scans
+// over adjacent memory - bandwidth-bound, not latency-bound - and
+// destruction is two frees instead of a tree walk.
+//
+// The document is immutable after parsing and safe to read from any
+// thread. All string access is zero-copy (StringPieces into the arena,
+// valid for the document's lifetime). Use DeserializeFromJsonFlat()
+// where the whole document is needed read-only (config walks, diffs);
+// keep DeserializeFromJson where callers mutate the tree or hand it to
+// base::Value-typed interfaces.
+class FlatJsonDocument {
+ public:
+  enum class Type : uint8_t {
+    kNull,
+    kBool,
+    kInt,
+    kDouble,
+    kString,
+    kArray,
+    kObject,
+  };
+
+  static constexpr uint32_t kInvalidIndex = static_cast<uint32_t>(-1);
+
+  // One node; an implementation detail exposed only so the parser can
+  // build the vectors (use NodeRef for traversal).
+  struct Node {
+    Type type = Type::kNull;
+    // Key of this node within its parent object; kInvalidIndex offset
+    // for array elements and the root.
+    uint32_t key_offset = kInvalidIndex;
+    uint32_t key_length = 0;
+    // Scalar payload (one of, per |type|).
+    bool bool_value = false;
+    int int_value = 0;
+    double double_value = 0.0;
+    uint32_t string_offset = 0;
+    uint32_t string_length = 0;
+    // Children block: |child_count| consecutive nodes starting at
+    // |first_child| (kInvalidIndex when empty or not a container).
+    uint32_t first_child = kInvalidIndex;
+    uint32_t child_count = 0;
+  };
+
+  // Lightweight cursor; copyable, two words, never owns anything.
+  class NodeRef {
+   public:
+    NodeRef() = default;
+
+    bool is_valid() const { return doc_ != nullptr; }
+
+    Type type() const { return node().type; }
+
+    bool GetBool() const {
+      DCHECK(type() == Type::kBool);
+      return node().bool_value;
+    }
+
+    int GetInt() const {
+      DCHECK(type() == Type::kInt);
+      return node().int_value;
+    }
+
+    // Like base::Value::GetDouble, promotes int nodes.
+    double GetDouble() const {
+      DCHECK(type() == Type::kDouble || type() == Type::kInt);
+      return type() == Type::kInt ? node().int_value : node().double_value;
+    }
+
+    // Valid for the document's lifetime; zero-copy.
+    base::StringPiece GetString() const {
+      DCHECK(type() == Type::kString);
+      return doc_->ArenaView(node().string_offset, node().string_length);
+    }
+
+    // Key of this node within its parent object; empty-invalid for
+    // array elements and the root (see has_key()).
+    bool has_key() const { return node().key_offset != kInvalidIndex; }
+    base::StringPiece key() const {
+      DCHECK(has_key());
+      return doc_->ArenaView(node().key_offset, node().key_length);
+    }
+
+    // Children (arrays and objects); the block is contiguous, so
+    // iterating children by index walks adjacent memory.
+    size_t children_count() const { return node().child_count; }
+    NodeRef child(size_t i) const {
+      DCHECK(type() == Type::kArray || type() == Type::kObject);
+      DCHECK(i < node().child_count);
+      return NodeRef(doc_, node().first_child + static_cast<uint32_t>(i));
+    }
+
+    // Linear scan over the contiguous children of an object; returns
+    // an invalid NodeRef when |key| is absent.
+    NodeRef FindKey(base::StringPiece key) const;
+
+   private:
+    friend class FlatJsonDocument;
+
+    NodeRef(const FlatJsonDocument* doc, uint32_t index)
+        : doc_(doc), index_(index) {}
+
+    const Node& node() const {
+      DCHECK(is_valid());
+      return doc_->nodes_[index_];
+    }
+
+    const FlatJsonDocument* doc_ = nullptr;
+    uint32_t index_ = kInvalidIndex;
+  };
+
+  // Never invalid on a successfully parsed document (an empty JSON
+  // document does not parse).
+  NodeRef root() const {
+    DCHECK(!nodes_.empty());
+    return NodeRef(this, 0);
+  }
+
+  size_t node_count() const { return nodes_.size(); }
+  size_t arena_size() const { return strings_.size(); }
+
+ private:
+  friend std::unique_ptr<FlatJsonDocument> DeserializeFromJsonFlat(
+      const std::string& text);
+
+  FlatJsonDocument(std::vector<Node> nodes, std::string strings)
+      : nodes_(std::move(nodes)), strings_(std::move(strings)) {}
+
+  base::StringPiece ArenaView(uint32_t offset, uint32_t length) const {
+    return base::StringPiece(strings_.data() + offset, length);
+  }
+
+  // Breadth-first node order (children of each container contiguous).
+  const std::vector<Node> nodes_;
+  // Every key and string value, back to back.
+  const std::string strings_;
+};
+
+// Sibling of DeserializeFromJson (basis/serializers.h) producing the
+// flat representation: one streaming parse pass, no base::Value tree.
+// Returns the NULL pointer if |text| is empty or not valid JSON.
+std::unique_ptr<FlatJsonDocument> DeserializeFromJsonFlat(
+    const std::string& text);
+
+}  // namespace chromecast
@@ -1,5 +1,12 @@
 #include "basis/i18n.hpp"
 
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include <base/synchronization/lock.h>
+
 #include <base/i18n/rtl.h>
 #include <base/i18n/icu_util.h>
 #include <base/i18n/message_formatter.h>
@@ -11,6 +18,9 @@
 #include <base/files/file_util.h>
 #include <base/sequenced_task_runner.h>
 
+#include <basis/icu_util.hpp>
+#include <basis/utf8.hpp>
+
 #include <third_party/icu/source/common/unicode/unistr.h>
 #include <third_party/icu/source/i18n/unicode/datefmt.h>
 #include <third_party/icu/source/i18n/unicode/msgfmt.h>
@@ -20,10 +30,103 @@
 
 namespace i18n {
 
-I18n::I18n(const char* pref_locale)
+// Thread-safe LRU of compiled `icu::MessageFormat`s keyed by
+// pattern + locale. Pattern parsing dominates repeated formatting, so
+// steady-state hits only pay a hash lookup and the format itself.
+/// \note `icu::Format` objects are not documented as safe for
+/// concurrent use, so formatting happens under the cache lock; with
+/// parsing gone that critical section is short.
+class I18n::MessageFormatCache {
+public:
+  explicit MessageFormatCache(size_t max_entries)
+    : max_entries_(max_entries)
+  {
+    DCHECK_GT(max_entries_, 0u);
+  }
+
+  base::string16 Format(
+    const base::string16& pattern
+    , const std::vector<icu::Formattable>& args)
+  {
+    const std::string locale = base::i18n::GetConfiguredLocale();
+    // Key conversion runs per format call; the vectorized helper keeps
+    // it off the profile (the warning paths below stay on base::).
+    std::string key = locale + "\n" + basis::utf16ToUtf8(pattern);
+
+    base::AutoLock auto_lock(lock_);
+
+    icu::MessageFormat* format = nullptr;
+    auto found = index_.find(key);
+    if(found != index_.end()) {
+      // Refresh LRU position.
+      entries_.splice(entries_.begin(), entries_, found->second);
+      format = found->second->second.get();
+    } else {
+      UErrorCode status = U_ZERO_ERROR;
+      auto compiled = std::make_unique<icu::MessageFormat>(
+        icu::UnicodeString(false, pattern.data(), pattern.size())
+        , icu::Locale(locale.c_str())
+        , status);
+      if(U_FAILURE(status)) {
+        LOG(WARNING)
+          << "unable to parse message pattern: "
+          << base::UTF16ToUTF8(pattern);
+        return base::string16();
+      }
+      format = compiled.get();
+      entries_.emplace_front(key, std::move(compiled));
+      index_[std::move(key)] = entries_.begin();
+      if(entries_.size() > max_entries_) {
+        index_.erase(entries_.back().first);
+        entries_.pop_back();
+      }
+    }
+
+    icu::UnicodeString formatted;
+    UErrorCode status = U_ZERO_ERROR;
+    format->format(args.data(), args.size(), formatted, status);
+    if(U_FAILURE(status)) {
+      LOG(WARNING)
+        << "unable to format message pattern: "
+        << base::UTF16ToUTF8(pattern);
+      return base::string16();
+    }
+    return base::string16(formatted.getBuffer()
+      , formatted.getBuffer() + formatted.length());
+  }
+
+  size_t size() const
+  {
+    base::AutoLock auto_lock(lock_);
+    return entries_.size();
+  }
+
+private:
+  using Entry
+    = std::pair<std::string, std::unique_ptr<icu::MessageFormat>>;
+
+  const size_t max_entries_;
+
+  mutable base::Lock lock_;
+  // Most recently used at the front.
+  std::list<Entry> entries_;
+  std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+
+  DISALLOW_COPY_AND_ASSIGN(MessageFormatCache);
+};
+
+I18n::I18n(const char* pref_locale, size_t formatCacheSize)
+  : format_cache_(std::make_unique<MessageFormatCache>(formatCacheSize))
 {
   DETACH_FROM_SEQUENCE(sequence_checker_);
 
+  // Runs the deferred ICU load (see icu_util::deferICUi18n) if one is
+  // pending; no-op after an eager initICUi18n*.
+  if(!icu_util::ensureICUi18n()) {
+    LOG(WARNING)
+      << "deferred ICU initialization failed";
+  }
+
   if(pref_locale == nullptr) {
     base::i18n::SetICUDefaultLocale(uloc_getDefault());
     // Convert ICU locale to chrome ("en_US" to "en-US", etc.).
@@ -70,6 +173,18 @@ I18n::~I18n()
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
 }
 
+base::string16 I18n::formatMessage(
+  const base::string16& pattern
+  , const std::vector<icu::Formattable>& args)
+{
+  return format_cache_->Format(pattern, args);
+}
+
+size_t I18n::formatCacheSize() const
+{
+  return format_cache_->size();
+}
+
 #else // UCONFIG_NO_FORMATTING
 
 #error "unable to init i18n: icu built with UCONFIG_NO_FORMATTING"
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include <base/i18n/rtl.h>
 #include <base/i18n/icu_util.h>
@@ -23,11 +24,32 @@ namespace i18n {
 /// \note you must init ICU before i18n
 class I18n {
 public:
-  I18n(const char* locale = nullptr);
+  // Upper bound on cached compiled patterns; a steady-state UI uses a
+  // few hundred distinct patterns, so the default keeps them all hot.
+  static constexpr size_t kDefaultFormatCacheSize = 256;
+
+  I18n(const char* locale = nullptr
+    , size_t formatCacheSize = kDefaultFormatCacheSize);
 
   ~I18n();
 
+  // Formats |pattern| (ICU MessageFormat syntax) with |args|.
+  // Compiled `icu::MessageFormat` objects are kept in a thread-safe
+  // LRU cache keyed by pattern + current default locale, so repeated
+  // patterns skip parsing entirely. Returns an empty string (and
+  // warns) when the pattern does not parse.
+  base::string16 formatMessage(
+    const base::string16& pattern
+    , const std::vector<icu::Formattable>& args);
+
+  // Entries currently cached; for tests and diagnostics.
+  size_t formatCacheSize() const;
+
 private:
+  class MessageFormatCache;
+
+  std::unique_ptr<MessageFormatCache> format_cache_;
+
   SEQUENCE_CHECKER(sequence_checker_);
 
   DISALLOW_COPY_AND_ASSIGN(I18n);
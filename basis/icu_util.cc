@@ -2,15 +2,50 @@
 
 #include <base/logging.h>
 #include <base/path_service.h>
+#include <base/files/file.h>
 #include <base/files/file_util.h>
+#include <base/files/memory_mapped_file.h>
 #include <base/i18n/icu_util.h>
 
+#include <basis/startup_phases.hpp>
+
+#include <mutex>
+
+#if defined(BASIS_EMBED_ICU_DATA)
+#include <third_party/icu/source/common/unicode/udata.h>
+#include <third_party/icu/source/common/unicode/uclean.h>
+
+#include <cstdint>
+
+extern "C" {
+// Emitted by cmake/icu_data_embed.S.in when EMBED_ICU_DATA is ON;
+// 16-byte aligned in .rodata, as udata_setCommonData requires.
+extern const uint8_t basis_icu_data_begin[];
+}
+#endif // BASIS_EMBED_ICU_DATA
+
 namespace icu_util {
 
 const base::FilePath::CharType kIcuDataFileName[]
   = FILE_PATH_LITERAL("./resources/icu/icudtl.dat");
 
-void initICUi18n(
+namespace {
+
+// State for deferICUi18n()/ensureICUi18n(). Leaked: lives for the
+// whole process, like ICU itself.
+struct DeferredIcuState {
+  std::once_flag once;
+  base::FilePath path;
+  bool deferred = false;
+  bool ok = true;
+};
+
+DeferredIcuState& deferredIcuState() {
+  static DeferredIcuState* state = new DeferredIcuState();
+  return *state;
+}
+
+base::FilePath resolveIcuDataPath(
   const base::FilePath::CharType icuFileName[])
 {
   base::FilePath dir_exe;
@@ -26,14 +61,114 @@ void initICUi18n(
       << "loading icu i18n file: "
       << dir_exe.Append(icuFileName);
   }
+  return dir_exe.Append(icuFileName);
+}
+
+// Hands the data file to ICU through base's fd-based entry point,
+// which mmaps it read-only: pages fault in only when a locale/format
+// table is first touched and are shared with every other process
+// mapping the same file. Returns false on failure.
+bool initICUWithMappedFile(const base::FilePath& icuFilePath)
+{
+  base::File file(
+    icuFilePath
+    , base::File::FLAG_OPEN | base::File::FLAG_READ);
+  if(!file.IsValid()) {
+    LOG(WARNING)
+      << "unable to open icu i18n file: "
+      << icuFilePath;
+    return false;
+  }
+  const base::MemoryMappedFile::Region region
+    = {0, file.GetLength()};
+  /// \note the descriptor is intentionally handed over for the process
+  /// lifetime: ICU reads from the mapping until exit
   bool icu_initialized
-    = base::i18n::InitializeICUWithPath(
-        dir_exe.Append(icuFileName));
+    = base::i18n::InitializeICUWithFileDescriptor(
+        file.TakePlatformFile(), region);
   if(!icu_initialized) {
     LOG(WARNING)
       << "unable to initialize icu i18n file: "
-      << dir_exe.Append(icuFileName);
+      << icuFilePath;
+  }
+  return icu_initialized;
+}
+
+}  // namespace
+
+void initICUi18n(
+  const base::FilePath::CharType icuFileName[])
+{
+  basis::ScopedStartupPhase startup_phase("initICUi18n");
+
+  base::FilePath icuFilePath = resolveIcuDataPath(icuFileName);
+  bool icu_initialized
+    = base::i18n::InitializeICUWithPath(icuFilePath);
+  if(!icu_initialized) {
+    LOG(WARNING)
+      << "unable to initialize icu i18n file: "
+      << icuFilePath;
+  }
+}
+
+void initICUi18nMapped(
+  const base::FilePath::CharType icuFileName[])
+{
+  basis::ScopedStartupPhase startup_phase("initICUi18nMapped");
+
+  initICUWithMappedFile(resolveIcuDataPath(icuFileName));
+}
+
+void deferICUi18n(
+  const base::FilePath::CharType icuFileName[])
+{
+  // Resolve the path now, while PathService is known to be usable on
+  // the startup thread; the (mapped) load itself waits for first use.
+  DeferredIcuState& state = deferredIcuState();
+  state.path = resolveIcuDataPath(icuFileName);
+  state.deferred = true;
+}
+
+bool ensureICUi18n()
+{
+  DeferredIcuState& state = deferredIcuState();
+  if(!state.deferred) {
+    return true;
   }
+  std::call_once(state.once, [&state] {
+    basis::ScopedStartupPhase startup_phase("ensureICUi18n");
+    state.ok = initICUWithMappedFile(state.path);
+  });
+  return state.ok;
 }
 
+#if defined(BASIS_EMBED_ICU_DATA)
+
+bool initICUi18nEmbedded()
+{
+  basis::ScopedStartupPhase startup_phase("initICUi18nEmbedded");
+
+  UErrorCode status = U_ZERO_ERROR;
+  udata_setCommonData(basis_icu_data_begin, &status);
+  if(U_FAILURE(status)) {
+    LOG(WARNING)
+      << "unable to register embedded icu data: "
+      << u_errorName(status);
+    return false;
+  }
+  // Force ICU to actually open the common data now, so a bad embed
+  // fails loudly at startup rather than on the first format call.
+  status = U_ZERO_ERROR;
+  u_init(&status);
+  if(U_FAILURE(status)) {
+    LOG(WARNING)
+      << "embedded icu data rejected by u_init: "
+      << u_errorName(status);
+    return false;
+  }
+  return true;
+}
+
+#endif // BASIS_EMBED_ICU_DATA
+
 }  // namespace icu_util
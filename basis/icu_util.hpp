@@ -9,4 +9,36 @@ extern const base::FilePath::CharType kIcuDataFileName[];
 void initICUi18n(
   const base::FilePath::CharType icuFileName[] = kIcuDataFileName);
 
+// Maps the ICU data file read-only instead of loading it eagerly: the
+// ~27 MB are faulted in lazily per page and the pages are shared
+// across every process mapping the same file, so N processes per host
+// stop paying N copies of resident memory and startup skips the read.
+void initICUi18nMapped(
+  const base::FilePath::CharType icuFileName[] = kIcuDataFileName);
+
+// Takes ICU init off the startup critical path entirely: only records
+// the data file path. The first call of ensureICUi18n() (done by
+// i18n::I18n, or call it manually before any direct ICU use) performs
+// the mapped initialization exactly once.
+void deferICUi18n(
+  const base::FilePath::CharType icuFileName[] = kIcuDataFileName);
+
+// Runs the deferred initialization if one is pending; safe to call
+// from multiple threads and repeatedly. Returns false when a deferred
+// init was attempted and failed, true otherwise (including the
+// "nothing deferred" case, e.g. after eager init).
+bool ensureICUi18n();
+
+#if defined(BASIS_EMBED_ICU_DATA)
+// Registers the ICU data that the EMBED_ICU_DATA build option linked
+// into the binary (via udata_setCommonData): no file probe, no read,
+// no failure mode at deploy time - the container image cannot ship
+// without the data it was linked against. The embedded copy lives in
+// .rodata, so the OS still shares it across processes the way the
+// mapped-file variants do. Call instead of initICUi18n*/deferICUi18n.
+// Returns false when ICU rejects the data (a build problem, not a
+// runtime one).
+bool initICUi18nEmbedded();
+#endif // BASIS_EMBED_ICU_DATA
+
 }  // namespace icu_util
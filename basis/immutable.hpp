@@ -1,9 +1,17 @@
 ﻿#pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include <base/macros.h>
 #include <base/memory/ref_counted.h>
+#include <base/no_destructor.h>
+#include <base/synchronization/lock.h>
 
 // Immutable<T> provides an easy, cheap, and thread-safe way to pass
 // large immutable data around.
@@ -61,6 +69,12 @@
 // NOTE: Some complexity is necessary in order to use Immutable<T>
 // with forward-declared types.  See comments on traits below for
 // details.
+//
+// NOTE: For small trivially copyable T (pointer-pair sized or less,
+// with default traits), the value is stored inline instead of in a
+// refcounted heap core - chosen automatically at compile time - so
+// Immutable<int64_t>-class uses cost no allocation and no atomic ops;
+// passing one around is passing a value.
 
 namespace basis {
 
@@ -84,6 +98,13 @@ class ImmutableCore
 
   const T& Get() const { return Traits::Unwrap(wrapper_); }
 
+  // Steals the wrapped value into |out|, leaving this core
+  // default-initialized. Only valid when the caller holds the sole
+  // reference (checked by Immutable::Rebuild).
+  void SwapOutForRebuild(T* out) {
+    Traits::Swap(out, Traits::UnwrapMutable(&wrapper_));
+  }
+
  private:
   friend class base::RefCountedThreadSafe<ImmutableCore<T, Traits>>;
 
@@ -96,6 +117,150 @@ class ImmutableCore
   DISALLOW_COPY_AND_ASSIGN(ImmutableCore);
 };
 
+// Inline storage pays off only when copying the value is no more
+// expensive than copying (and atomically bumping) a refcounted
+// pointer. Custom wrappers (forward-declared types) always need the
+// core.
+template <typename T, typename Traits>
+struct UseInlineImmutableStorage {
+  static constexpr bool value =
+      std::is_same<typename Traits::Wrapper, T>::value &&
+      std::is_trivially_copyable<T>::value &&
+      sizeof(T) <= 2 * sizeof(void*);
+};
+
+// Storage policy behind Immutable: the primary template is the
+// refcounted heap core, the specialization below stores T inline by
+// value. Both expose the same small surface to Immutable.
+template <typename T, typename Traits, bool UseInlineStorage>
+class ImmutableStorage {
+ public:
+  ImmutableStorage() : core_(new ImmutableCore<T, Traits>()) {}
+
+  explicit ImmutableStorage(T* t)
+      : core_(new ImmutableCore<T, Traits>(t)) {}
+
+  // Adopts an existing (i.e. interned) core.
+  explicit ImmutableStorage(
+      scoped_refptr<const ImmutableCore<T, Traits>> core)
+      : core_(std::move(core)) {}
+
+  const T& Get() const { return core_->Get(); }
+
+  // Moves the value into |out| for Immutable::Rebuild(): steals it when
+  // this storage holds the sole reference, copies otherwise, and leaves
+  // the storage default-initialized either way.
+  void MoveOutForRebuild(T* out) {
+    if (core_->HasOneRef()) {
+      // Sole owner: steal the state instead of copying. The const_cast
+      // is sound because no other handle exists and the owning handle
+      // is being consumed; nobody can ever read the old core again.
+      const_cast<ImmutableCore<T, Traits>*>(core_.get())
+          ->SwapOutForRebuild(out);
+    } else {
+      *out = core_->Get();
+    }
+    core_ = new ImmutableCore<T, Traits>();
+  }
+
+ private:
+  scoped_refptr<const ImmutableCore<T, Traits>> core_;
+};
+
+// Process-wide table of canonical cores for one (T, Traits), behind
+// MakeInternedImmutable. Keyed by std::hash<T>; values within a bucket
+// are deep-compared once at interning time, after which equal values
+// share one core and compare by address. The registry keeps its
+// entries alive; PurgeUnused() drops the ones nothing else references.
+template <typename T, typename Traits>
+class ImmutableInternRegistry {
+ public:
+  static ImmutableInternRegistry& GetInstance() {
+    static base::NoDestructor<ImmutableInternRegistry> instance;
+    return *instance;
+  }
+
+  // Returns the canonical core equal to |*t|, creating it from |*t| if
+  // none exists yet. |*t| is reset to a default-initialized state
+  // either way, matching Immutable(T*).
+  scoped_refptr<const ImmutableCore<T, Traits>> Intern(T* t) {
+    const size_t hash = std::hash<T>()(*t);
+
+    base::AutoLock lock(lock_);
+    auto& bucket = buckets_[hash];
+    for (const auto& core : bucket) {
+      if (core->Get() == *t) {
+        // Duplicate: collapse to the canonical instance. Still resets
+        // |*t| as documented.
+        T defaulted;
+        Traits::Swap(t, &defaulted);
+        return core;
+      }
+    }
+    scoped_refptr<const ImmutableCore<T, Traits>> core(
+        new ImmutableCore<T, Traits>(t));
+    bucket.push_back(core);
+    return core;
+  }
+
+  // Drops canonical entries that nothing outside the registry
+  // references anymore; call at quiet points (end of a map load) to
+  // keep the table from accumulating dead values. Returns the number
+  // of entries dropped.
+  size_t PurgeUnused() {
+    base::AutoLock lock(lock_);
+    size_t purged = 0;
+    for (auto it = buckets_.begin(); it != buckets_.end();) {
+      auto& bucket = it->second;
+      const size_t before = bucket.size();
+      bucket.erase(
+          std::remove_if(bucket.begin(), bucket.end(),
+                         [](const scoped_refptr<
+                             const ImmutableCore<T, Traits>>& core) {
+                           return core->HasOneRef();
+                         }),
+          bucket.end());
+      purged += before - bucket.size();
+      it = bucket.empty() ? buckets_.erase(it) : ++it;
+    }
+    return purged;
+  }
+
+ private:
+  friend class base::NoDestructor<ImmutableInternRegistry>;
+
+  ImmutableInternRegistry() = default;
+
+  base::Lock lock_;
+  std::unordered_map<
+      size_t,
+      std::vector<scoped_refptr<const ImmutableCore<T, Traits>>>>
+      buckets_;
+
+  DISALLOW_COPY_AND_ASSIGN(ImmutableInternRegistry);
+};
+
+// Inline variant for small trivially copyable T (see
+// UseInlineImmutableStorage): no core, no refcount - the handle IS the
+// value, and copying a handle copies sizeof(T) bytes.
+template <typename T, typename Traits>
+class ImmutableStorage<T, Traits, true> {
+ public:
+  ImmutableStorage() : value_() {}
+
+  explicit ImmutableStorage(T* t) : value_() { Traits::Swap(&value_, t); }
+
+  const T& Get() const { return value_; }
+
+  // Each handle owns its copy outright, so "stealing" is just a swap.
+  void MoveOutForRebuild(T* out) { Traits::Swap(out, &value_); }
+
+ private:
+  // Semantically const; only mutated while no other code can see it
+  // (construction and consumed-handle rebuilds).
+  T value_;
+};
+
 }  // namespace internal
 
 // Traits usage notes
@@ -216,17 +381,77 @@ template <typename T, typename Traits = DefaultImmutableTraits<T>>
 class Immutable {
  public:
   // Puts the underlying object in a default-initialized state.
-  Immutable() : core_(new internal::ImmutableCore<T, Traits>()) {}
+  Immutable() : storage_() {}
 
   // Copy constructor and assignment welcome.
 
   // Resets |t| to a default-initialized state.
-  explicit Immutable(T* t) : core_(new internal::ImmutableCore<T, Traits>(t)) {}
+  explicit Immutable(T* t) : storage_(t) {}
 
-  const T& Get() const { return core_->Get(); }
+  const T& Get() const { return storage_.Get(); }
+
+  // Copy-on-write rebuild support.
+  //
+  // Producing a slightly-modified version of an immutable value used to
+  // require a full copy of T before wrapping it again. Rebuild() consumes
+  // the handle (rvalue-qualified), so no live handle can observe the
+  // mutation; when the consumed handle was the last reference to the
+  // state, the state is swapped into the builder and edited in place -
+  // no copy at all. Only when other handles still share the state is one
+  // copy made, up front. Build() freezes the edited value into a fresh
+  // Immutable (again a swap, not a copy).
+  //
+  //   Immutable<RoutingTable> table = ...;
+  //   auto builder = std::move(table).Rebuild();
+  //   builder.Mutable().push_back(entry);  // in-place, no O(n) copy
+  //   table = std::move(builder).Build();
+  //
+  // Requires T to be copy-assignable (used only on the shared path).
+  class Builder {
+   public:
+    Builder(Builder&& other) = default;
+    Builder& operator=(Builder&& other) = default;
+
+    // Mutable view of the value being built.
+    T& Mutable() { return value_; }
+
+    const T& Get() const { return value_; }
+
+    // Freezes into an Immutable; leaves the builder default-initialized.
+    Immutable Build() && { return Immutable(&value_); }
+
+   private:
+    friend class Immutable;
+
+    Builder() : value_() {}
+
+    T value_;
+
+    DISALLOW_COPY_AND_ASSIGN(Builder);
+  };
+
+  Builder Rebuild() && {
+    Builder builder;
+    // Keeps the moved-from handle safe to Get() (default-initialized
+    // state), matching the documented behavior of MakeImmutable sources.
+    storage_.MoveOutForRebuild(&builder.value_);
+    return builder;
+  }
 
  private:
-  scoped_refptr<const internal::ImmutableCore<T, Traits>> core_;
+  template <typename U>
+  friend Immutable<U> MakeInternedImmutable(U* u);
+
+  // Wraps an existing (interned) core; see MakeInternedImmutable.
+  explicit Immutable(
+      scoped_refptr<const internal::ImmutableCore<T, Traits>> core)
+      : storage_(std::move(core)) {}
+
+  internal::ImmutableStorage<
+      T,
+      Traits,
+      internal::UseInlineImmutableStorage<T, Traits>::value>
+      storage_;
 };
 
 // Helper function to avoid having to write out template arguments.
@@ -235,4 +460,39 @@ Immutable<T> MakeImmutable(T* t) {
   return Immutable<T>(t);
 }
 
+// Like MakeImmutable, but deduplicates: equal values handed to this
+// function collapse to one canonical shared instance (found by hash
+// lookup), so a thousand Immutable<std::string> copies of the same
+// asset key cost one string plus refcount bumps. Because interned
+// handles with equal values share one core, caches can compare them by
+// address - `&a.Get() == &b.Get()` - instead of deep-comparing T.
+//
+// Resets |t| to a default-initialized state, like MakeImmutable.
+// Requires std::hash<T> and operator==. The canonical instance stays
+// alive in the process-wide registry until
+// PurgeUnusedInternedImmutables<T>() is called while no handle to it
+// exists; intern only values that recur (asset keys, config
+// fragments), not unbounded unique data.
+template <typename T>
+Immutable<T> MakeInternedImmutable(T* t) {
+  static_assert(
+      !internal::UseInlineImmutableStorage<T,
+                                           DefaultImmutableTraits<T>>::value,
+      "Inline-stored Immutables have no shared state to intern");
+  return Immutable<T>(
+      internal::ImmutableInternRegistry<T, DefaultImmutableTraits<T>>::
+          GetInstance()
+              .Intern(t));
+}
+
+// Drops interned values of type T that no live handle references;
+// call at quiet points (end of a map load). Returns the number of
+// values dropped.
+template <typename T>
+size_t PurgeUnusedInternedImmutables() {
+  return internal::ImmutableInternRegistry<
+             T, DefaultImmutableTraits<T>>::GetInstance()
+      .PurgeUnused();
+}
+
 } // namespace basis
@@ -0,0 +1,148 @@
+#pragma once
+
+/**
+ * Fixed-capacity, non-allocating, move-only callable.
+ *
+ * base::BindRepeating / base::BindOnce heap-allocate a BindState per
+ * bind and dispatch through it, which on hot scheduling paths means
+ * one malloc per registered callback plus an extra pointer hop per
+ * call. InplaceFunction stores the callable inline in the object
+ * itself: constructing one from a lambda performs no allocation, and
+ * invocation is one indirect call into code the branch predictor sees
+ * per call site.
+ *
+ * Compared to std::function it is move-only (so captured move-only
+ * state is fine), never allocates, and refuses at compile time any
+ * callable that does not fit |Capacity| — going over the budget is a
+ * static_assert, not a silent fallback to the heap.
+ *
+ * A base::RepeatingCallback (one refcounted pointer) fits easily, so
+ * APIs migrated to InplaceFunction can keep accepting bound callbacks
+ * by wrapping them; only the wrapper then pays the BindState cost.
+ **/
+
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace basis {
+
+// Enough for a lambda capturing a handful of pointers; tune per use
+// through the template argument when a site needs more.
+inline constexpr size_t kInplaceFunctionDefaultCapacity = 48;
+
+template <typename Signature,
+          size_t Capacity = kInplaceFunctionDefaultCapacity>
+class InplaceFunction;  // undefined; see the R(Args...) specialization
+
+template <typename R, typename... Args, size_t Capacity>
+class InplaceFunction<R(Args...), Capacity> {
+ public:
+  InplaceFunction() noexcept = default;
+
+  InplaceFunction(std::nullptr_t) noexcept {}
+
+  // Intentionally implicit, like std::function: call sites pass
+  // lambdas directly.
+  template <typename F,
+            typename = std::enable_if_t<
+                !std::is_same_v<std::decay_t<F>, InplaceFunction> &&
+                std::is_invocable_r_v<R, std::decay_t<F>&, Args...>>>
+  InplaceFunction(F&& callable) {
+    using Decayed = std::decay_t<F>;
+    static_assert(sizeof(Decayed) <= Capacity,
+                  "callable exceeds InplaceFunction capacity; shrink the"
+                  " captures or raise the Capacity template argument");
+    static_assert(alignof(Decayed) <= alignof(std::max_align_t),
+                  "over-aligned callables are not supported");
+    static_assert(std::is_move_constructible_v<Decayed>,
+                  "callable must be move constructible");
+    new (&storage_) Decayed(std::forward<F>(callable));
+    invoke_ = &InvokeImpl<Decayed>;
+    manage_ = &ManageImpl<Decayed>;
+  }
+
+  InplaceFunction(InplaceFunction&& other) noexcept {
+    MoveFrom(other);
+  }
+
+  InplaceFunction& operator=(InplaceFunction&& other) noexcept {
+    if (this != &other) {
+      Reset();
+      MoveFrom(other);
+    }
+    return *this;
+  }
+
+  InplaceFunction& operator=(std::nullptr_t) noexcept {
+    Reset();
+    return *this;
+  }
+
+  ~InplaceFunction() { Reset(); }
+
+  // Calling an empty InplaceFunction is a programming error.
+  R operator()(Args... args) {
+    assert(invoke_ && "called an empty InplaceFunction");
+    return invoke_(&storage_, std::forward<Args>(args)...);
+  }
+
+  explicit operator bool() const noexcept { return invoke_ != nullptr; }
+
+  // Destroys the stored callable, leaving *this empty.
+  void Reset() noexcept {
+    if (manage_) {
+      manage_(Op::kDestroy, &storage_, nullptr);
+      invoke_ = nullptr;
+      manage_ = nullptr;
+    }
+  }
+
+ private:
+  enum class Op { kMoveTo, kDestroy };
+
+  using Storage =
+      typename std::aligned_storage<Capacity,
+                                    alignof(std::max_align_t)>::type;
+  using Invoke = R (*)(Storage*, Args&&...);
+  // kMoveTo: move-construct |self|'s callable into |to|, then destroy
+  // the original. kDestroy: destroy |self|'s callable.
+  using Manage = void (*)(Op, Storage* self, Storage* to);
+
+  template <typename Decayed>
+  static R InvokeImpl(Storage* storage, Args&&... args) {
+    return (*reinterpret_cast<Decayed*>(storage))(
+        std::forward<Args>(args)...);
+  }
+
+  template <typename Decayed>
+  static void ManageImpl(Op op, Storage* self, Storage* to) {
+    Decayed* callable = reinterpret_cast<Decayed*>(self);
+    if (op == Op::kMoveTo) {
+      new (to) Decayed(std::move(*callable));
+    }
+    callable->~Decayed();
+  }
+
+  // Precondition: *this is empty. |other| is left empty.
+  void MoveFrom(InplaceFunction& other) noexcept {
+    if (other.manage_) {
+      other.manage_(Op::kMoveTo, &other.storage_, &storage_);
+      invoke_ = other.invoke_;
+      manage_ = other.manage_;
+      other.invoke_ = nullptr;
+      other.manage_ = nullptr;
+    }
+  }
+
+  Storage storage_;
+  Invoke invoke_ = nullptr;
+  Manage manage_ = nullptr;
+
+  InplaceFunction(const InplaceFunction&) = delete;
+  InplaceFunction& operator=(const InplaceFunction&) = delete;
+};
+
+}  // namespace basis
@@ -0,0 +1,272 @@
+#include "AsyncLogger.hpp" // IWYU pragma: associated
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <base/strings/string_number_conversions.h>
+
+#include <basis/concurrency/LockFreeProducerConsumerQueue.hpp>
+
+#include "BinaryLogSink.hpp"
+
+namespace gloer {
+namespace log {
+
+namespace {
+
+// Slots per producer thread. 4096 records * ~72 bytes keeps a ring well
+// under a megabyte while absorbing bursts far larger than the drain
+// thread's wakeup interval can accumulate.
+constexpr uint32_t kRingCapacity = 4096;
+
+// How long the drain thread sleeps when every ring is empty.
+constexpr std::chrono::milliseconds kIdleSleep{1};
+
+// One SPSC ring per producer thread, shared between the thread_local
+// registration (producer side) and the drain thread (consumer side).
+struct ThreadRing {
+  basis::LockFreeProducerConsumerQueue<internal::LogRecord> queue{
+      kRingCapacity};
+  // Set when the owning thread exits; the drain thread removes the ring
+  // once it has been emptied.
+  std::atomic<bool> retired{false};
+  // Records rejected because the ring was full; reported by the drain
+  // thread so overload is visible rather than silent.
+  std::atomic<uint64_t> dropped{0};
+};
+
+}  // namespace
+
+namespace internal {
+
+std::string FormatLogMessage(const char* format, const LogArg* args) {
+  std::string out;
+  out.reserve(64);
+  size_t next_arg = 0;
+  for (const char* p = format; *p; ++p) {
+    if (*p != '%') {
+      out.push_back(*p);
+      continue;
+    }
+    ++p;
+    if (*p == '%') {
+      out.push_back('%');
+      continue;
+    }
+    if (*p == '\0')
+      break;
+    if (next_arg >= kMaxLogArgs) {
+      out += "<?>";
+      continue;
+    }
+    const LogArg& arg = args[next_arg++];
+    using Type = LogArg::Type;
+    switch (*p) {
+      case 'd':
+        if (arg.type == Type::kInt)
+          out += base::NumberToString(arg.as_int);
+        else if (arg.type == Type::kUint)
+          out += base::NumberToString(arg.as_uint);
+        else
+          out += "<?>";
+        break;
+      case 'u':
+        if (arg.type == Type::kUint)
+          out += base::NumberToString(arg.as_uint);
+        else if (arg.type == Type::kInt && arg.as_int >= 0)
+          out += base::NumberToString(arg.as_int);
+        else
+          out += "<?>";
+        break;
+      case 'f':
+        if (arg.type == Type::kDouble)
+          out += base::NumberToString(arg.as_double);
+        else
+          out += "<?>";
+        break;
+      case 'b':
+        if (arg.type == Type::kBool)
+          out += arg.as_bool ? "true" : "false";
+        else
+          out += "<?>";
+        break;
+      case 's':
+        if (arg.type == Type::kCString && arg.as_cstring)
+          out += arg.as_cstring;
+        else
+          out += "<?>";
+        break;
+      default:
+        out += "<?>";
+        break;
+    }
+  }
+  return out;
+}
+
+}  // namespace internal
+
+struct AsyncLogger::Impl {
+  std::mutex rings_mutex;
+  std::vector<std::shared_ptr<ThreadRing>> rings;
+
+  std::mutex wake_mutex;
+  std::condition_variable wake;
+
+  // Non-null routes drained records into the structured binary format
+  // instead of text; guarded by |sink_mutex| since SetBinarySink may be
+  // called from any thread while the drain thread is emitting.
+  std::mutex sink_mutex;
+  std::unique_ptr<BinaryLogSink> sink;
+
+  std::atomic<bool> stop{false};
+  std::thread drain_thread;
+};
+
+namespace {
+
+// Owns the calling thread's ring; flags it retired on thread exit so
+// the drain thread can empty and drop it.
+struct RingRegistration {
+  std::shared_ptr<ThreadRing> ring;
+
+  ~RingRegistration() {
+    if (ring)
+      ring->retired.store(true, std::memory_order_release);
+  }
+};
+
+thread_local RingRegistration tls_ring_registration;
+
+}  // namespace
+
+// static
+AsyncLogger& AsyncLogger::GetInstance() {
+  // Leaked (never destroyed) so logging from static destructors of
+  // other objects stays safe; the process exit flushes via the OS.
+  static AsyncLogger* instance = new AsyncLogger();
+  return *instance;
+}
+
+AsyncLogger::AsyncLogger() : impl_(new Impl()) {
+  impl_->drain_thread = std::thread(&AsyncLogger::DrainLoop, this);
+}
+
+AsyncLogger::~AsyncLogger() {
+  impl_->stop.store(true, std::memory_order_release);
+  impl_->wake.notify_all();
+  impl_->drain_thread.join();
+  delete impl_;
+}
+
+void AsyncLogger::Enqueue(const internal::LogRecord& record) {
+  std::shared_ptr<ThreadRing>& ring = tls_ring_registration.ring;
+  if (!ring) {
+    ring = std::make_shared<ThreadRing>();
+    std::lock_guard<std::mutex> lock(impl_->rings_mutex);
+    impl_->rings.push_back(ring);
+  }
+  if (!ring->queue.write(record))
+    ring->dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AsyncLogger::DrainLoop() {
+  std::vector<std::shared_ptr<ThreadRing>> snapshot;
+  internal::LogRecord record;
+  for (;;) {
+    {
+      std::lock_guard<std::mutex> lock(impl_->rings_mutex);
+      snapshot = impl_->rings;
+    }
+
+    bool did_work = false;
+    for (const std::shared_ptr<ThreadRing>& ring : snapshot) {
+      while (ring->queue.read(record)) {
+        did_work = true;
+        std::lock_guard<std::mutex> sink_lock(impl_->sink_mutex);
+        if (impl_->sink) {
+          impl_->sink->Write(record);
+        } else {
+          // The -verbose_level convention matches VLOG_LOC_STREAM.
+          logging::LogMessage(record.file, record.line,
+                              -record.verbose_level)
+                  .stream()
+              << "[t+" << record.timestamp_us << "us] "
+              << internal::FormatLogMessage(record.format, record.args);
+        }
+      }
+      uint64_t dropped = ring->dropped.exchange(0, std::memory_order_relaxed);
+      if (dropped) {
+        LOG(WARNING) << "AsyncLogger: dropped " << dropped
+                     << " records from overloaded ring";
+      }
+    }
+
+    // Drop rings whose producer thread exited once they are empty.
+    {
+      std::lock_guard<std::mutex> lock(impl_->rings_mutex);
+      for (size_t i = 0; i < impl_->rings.size();) {
+        ThreadRing& ring = *impl_->rings[i];
+        if (ring.retired.load(std::memory_order_acquire) &&
+            ring.queue.isEmpty()) {
+          impl_->rings.erase(impl_->rings.begin() + i);
+        } else {
+          ++i;
+        }
+      }
+    }
+
+    if (impl_->stop.load(std::memory_order_acquire)) {
+      // Final sweep already happened above with no producers left
+      // allowed; exit once a pass finds nothing.
+      if (!did_work)
+        return;
+      continue;
+    }
+
+    if (!did_work) {
+      std::unique_lock<std::mutex> lock(impl_->wake_mutex);
+      impl_->wake.wait_for(lock, kIdleSleep);
+    }
+  }
+}
+
+void AsyncLogger::Flush() {
+  // The drain thread polls every kIdleSleep, so waiting for all rings
+  // to empty bounds the flush without producer-side synchronization.
+  for (;;) {
+    bool empty = true;
+    {
+      std::lock_guard<std::mutex> lock(impl_->rings_mutex);
+      for (const std::shared_ptr<ThreadRing>& ring : impl_->rings) {
+        if (!ring->queue.isEmpty()) {
+          empty = false;
+          break;
+        }
+      }
+    }
+    if (empty)
+      break;
+    impl_->wake.notify_all();
+    std::this_thread::sleep_for(kIdleSleep);
+  }
+  std::lock_guard<std::mutex> sink_lock(impl_->sink_mutex);
+  if (impl_->sink)
+    impl_->sink->Flush();
+}
+
+void AsyncLogger::SetBinarySink(std::unique_ptr<BinaryLogSink> sink) {
+  std::lock_guard<std::mutex> lock(impl_->sink_mutex);
+  if (impl_->sink)
+    impl_->sink->Flush();
+  impl_->sink = std::move(sink);
+}
+
+}  // namespace log
+}  // namespace gloer
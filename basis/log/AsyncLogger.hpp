@@ -0,0 +1,203 @@
+#pragma once
+
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <string>
+
+#include <base/location.h>
+#include <base/logging.h>
+#include <base/macros.h>
+#include <base/time/time.h>
+
+#include "Logger.hpp"
+
+// Asynchronous logging mode for hot threads.
+//
+// VLOG_LOC formats and writes synchronously through logging::LogMessage,
+// which can cost hundreds of microseconds per burst on a packet thread.
+// VLOG_LOC_ASYNC instead captures the callsite pointer, a printf-lite
+// format string and raw argument values into a per-thread lock-free SPSC
+// ring (basis/concurrency/LockFreeProducerConsumerQueue.hpp); a single
+// background drain thread does all formatting and hands the text to
+// logging::LogMessage. The hot-path cost is the verbosity check plus one
+// ring write - no formatting, no locks, no allocation.
+//
+// Restrictions that make the hot path cheap:
+//  * at most |kMaxLogArgs| arguments per site;
+//  * arguments are integers, floats, bools or C strings; C strings must
+//    have static storage duration (string literals) because formatting
+//    happens later on another thread;
+//  * the format string must be a literal, with %d %u %f %b %s %%
+//    placeholders consumed left to right.
+//
+// If a ring overflows the newest records are dropped and the drain
+// thread reports the drop count; logging never blocks the producer.
+//
+// USAGE:
+//   VLOG_LOC_ASYNC(FROM_HERE, 1, "rx seq=%u bytes=%d", seq, size);
+
+namespace gloer {
+namespace log {
+
+namespace internal {
+
+// One argument captured on the hot path. Kept trivially copyable so the
+// whole record memcpy-s through the ring.
+struct LogArg {
+  enum class Type : uint8_t { kNone, kInt, kUint, kDouble, kBool, kCString };
+
+  Type type = Type::kNone;
+  union {
+    int64_t as_int;
+    uint64_t as_uint;
+    double as_double;
+    bool as_bool;
+    const char* as_cstring;
+  };
+
+  static LogArg Make(int value) {
+    LogArg arg;
+    arg.type = Type::kInt;
+    arg.as_int = value;
+    return arg;
+  }
+  static LogArg Make(long value) {
+    LogArg arg;
+    arg.type = Type::kInt;
+    arg.as_int = value;
+    return arg;
+  }
+  static LogArg Make(long long value) {
+    LogArg arg;
+    arg.type = Type::kInt;
+    arg.as_int = value;
+    return arg;
+  }
+  static LogArg Make(unsigned value) {
+    LogArg arg;
+    arg.type = Type::kUint;
+    arg.as_uint = value;
+    return arg;
+  }
+  static LogArg Make(unsigned long value) {
+    LogArg arg;
+    arg.type = Type::kUint;
+    arg.as_uint = value;
+    return arg;
+  }
+  static LogArg Make(unsigned long long value) {
+    LogArg arg;
+    arg.type = Type::kUint;
+    arg.as_uint = value;
+    return arg;
+  }
+  static LogArg Make(double value) {
+    LogArg arg;
+    arg.type = Type::kDouble;
+    arg.as_double = value;
+    return arg;
+  }
+  static LogArg Make(float value) { return Make(static_cast<double>(value)); }
+  static LogArg Make(bool value) {
+    LogArg arg;
+    arg.type = Type::kBool;
+    arg.as_bool = value;
+    return arg;
+  }
+  // |value| must have static storage duration (see file comment).
+  static LogArg Make(const char* value) {
+    LogArg arg;
+    arg.type = Type::kCString;
+    arg.as_cstring = value;
+    return arg;
+  }
+};
+
+constexpr size_t kMaxLogArgs = 4;
+
+// Fixed-size record flowing through the per-thread ring.
+struct LogRecord {
+  const char* file;
+  int line;
+  int verbose_level;
+  // Capture time; the drain thread prefixes it to the message since
+  // LogMessage stamps drain time, not log time.
+  int64_t timestamp_us;
+  const char* format;
+  LogArg args[kMaxLogArgs];
+};
+
+// Renders |format| with the placeholder rules documented above.
+// |args| points at kMaxLogArgs entries; placeholders are matched left
+// to right, mismatches render "<?>". Shared by the drain thread and
+// the offline binary-log renderer (BinaryLogSink.hpp).
+std::string FormatLogMessage(const char* format, const LogArg* args);
+
+}  // namespace internal
+
+class BinaryLogSink;
+
+class AsyncLogger {
+ public:
+  static AsyncLogger& GetInstance();
+
+  // Hot path: packs the site and arguments into this thread's ring.
+  // Never blocks; drops the record if the ring is full.
+  template <typename... Args>
+  void Log(const base::Location& from_here,
+           int verbose_level,
+           const char* format,
+           Args... args) {
+    static_assert(sizeof...(Args) <= internal::kMaxLogArgs,
+                  "VLOG_LOC_ASYNC supports at most kMaxLogArgs arguments");
+    internal::LogRecord record;
+    record.file = from_here.file_name();
+    record.line = from_here.line_number();
+    record.verbose_level = verbose_level;
+    record.timestamp_us =
+        base::TimeTicks::Now().since_origin().InMicroseconds();
+    record.format = format;
+    size_t i = 0;
+    (void)std::initializer_list<int>{
+        (record.args[i++] = internal::LogArg::Make(args), 0)...};
+    Enqueue(record);
+  }
+
+  // Blocks until every record enqueued before the call has been written.
+  // For tests and orderly shutdown; never call it from a hot path.
+  void Flush();
+
+  // Routes drained records into |sink| as structured binary records
+  // instead of formatted text (see BinaryLogSink.hpp); pass nullptr to
+  // return to text output. Producer-side cost is unchanged. May be
+  // called from any thread.
+  void SetBinarySink(std::unique_ptr<BinaryLogSink> sink);
+
+ private:
+  AsyncLogger();
+  ~AsyncLogger();
+
+  void Enqueue(const internal::LogRecord& record);
+
+  void DrainLoop();
+
+  struct Impl;
+  Impl* impl_;
+
+  DISALLOW_COPY_AND_ASSIGN(AsyncLogger);
+};
+
+}  // namespace log
+}  // namespace gloer
+
+// Same gating as VLOG_LOC, but the accepted record goes through the
+// async backend instead of a synchronous LogMessage.
+#define VLOG_LOC_ASYNC(from_here, verbose_level, ...)                   \
+  do {                                                                  \
+    if (VLOG_IS_ON(verbose_level) ||                                    \
+        ::gloer::log::VlogIsOnForLocation(from_here, verbose_level)) {  \
+      ::gloer::log::AsyncLogger::GetInstance().Log(                     \
+          from_here, verbose_level, __VA_ARGS__);                       \
+    }                                                                   \
+  } while (0)
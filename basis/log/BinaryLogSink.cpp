@@ -0,0 +1,342 @@
+#include "BinaryLogSink.hpp" // IWYU pragma: associated
+
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+#include <basis/compressed_block_writer.hpp>
+
+namespace gloer {
+namespace log {
+
+namespace {
+
+const char kBinaryLogMagic[4] = {'G', 'B', 'L', '1'};
+
+enum RecordType : uint8_t {
+  kFormatDef = 0x01,
+  kFileDef = 0x02,
+  kEvent = 0x03,
+};
+
+uint64_t ZigZagEncode(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^
+         static_cast<uint64_t>(value >> 63);
+}
+
+int64_t ZigZagDecode(uint64_t value) {
+  return static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+}  // namespace
+
+BinaryLogSink::BinaryLogSink(const std::string& path, bool compress) {
+  if (compress) {
+    compressed_ = std::make_unique<basis::CompressedBlockWriter>(path);
+    block_buffer_.reserve(basis::CompressedBlockWriter::kBlockSize);
+  } else {
+    out_.open(path, std::ios::binary | std::ios::trunc);
+  }
+  if (ok())
+    WriteRaw(kBinaryLogMagic, sizeof(kBinaryLogMagic));
+}
+
+BinaryLogSink::~BinaryLogSink() {
+  Flush();
+}
+
+bool BinaryLogSink::ok() const {
+  return compressed_ ? compressed_->ok() : out_.good();
+}
+
+void BinaryLogSink::Write(const internal::LogRecord& record) {
+  const uint32_t format_id =
+      InternString(record.format, kFormatDef, &format_ids_);
+  const uint32_t file_id = InternString(record.file, kFileDef, &file_ids_);
+
+  PutByte(static_cast<char>(kEvent));
+  AppendVarint(format_id);
+  AppendVarint(file_id);
+  AppendVarint(static_cast<uint64_t>(record.line));
+  AppendVarint(static_cast<uint64_t>(record.verbose_level));
+  AppendVarint(static_cast<uint64_t>(record.timestamp_us));
+
+  size_t arg_count = 0;
+  while (arg_count < internal::kMaxLogArgs &&
+         record.args[arg_count].type != internal::LogArg::Type::kNone) {
+    ++arg_count;
+  }
+  AppendVarint(arg_count);
+  for (size_t i = 0; i < arg_count; ++i) {
+    const internal::LogArg& arg = record.args[i];
+    PutByte(static_cast<char>(arg.type));
+    switch (arg.type) {
+      case internal::LogArg::Type::kInt:
+        AppendZigZag(arg.as_int);
+        break;
+      case internal::LogArg::Type::kUint:
+        AppendVarint(arg.as_uint);
+        break;
+      case internal::LogArg::Type::kDouble: {
+        char bytes[sizeof(double)];
+        std::memcpy(bytes, &arg.as_double, sizeof(double));
+        WriteRaw(bytes, sizeof(double));
+        break;
+      }
+      case internal::LogArg::Type::kBool:
+        PutByte(arg.as_bool ? 1 : 0);
+        break;
+      case internal::LogArg::Type::kCString: {
+        // Argument strings are written inline (unlike format strings):
+        // a site may pass different values per hit.
+        const char* str = arg.as_cstring ? arg.as_cstring : "";
+        AppendBytes(str, std::strlen(str));
+        break;
+      }
+      case internal::LogArg::Type::kNone:
+        break;
+    }
+  }
+}
+
+void BinaryLogSink::Flush() {
+  if (compressed_) {
+    if (!block_buffer_.empty()) {
+      compressed_->write(block_buffer_.data(), block_buffer_.size());
+      block_buffer_.clear();
+    }
+    compressed_->flush();
+    return;
+  }
+  out_.flush();
+}
+
+uint32_t BinaryLogSink::InternString(
+    const char* string,
+    uint8_t def_record_type,
+    std::unordered_map<const char*, uint32_t>* ids) {
+  auto it = ids->find(string);
+  if (it != ids->end())
+    return it->second;
+  const uint32_t id = next_id_++;
+  (*ids)[string] = id;
+  PutByte(static_cast<char>(def_record_type));
+  AppendVarint(id);
+  AppendBytes(string, std::strlen(string));
+  return id;
+}
+
+void BinaryLogSink::AppendVarint(uint64_t value) {
+  while (value >= 0x80) {
+    PutByte(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  PutByte(static_cast<char>(value));
+}
+
+void BinaryLogSink::AppendZigZag(int64_t value) {
+  AppendVarint(ZigZagEncode(value));
+}
+
+void BinaryLogSink::AppendBytes(const char* data, size_t size) {
+  AppendVarint(size);
+  WriteRaw(data, size);
+}
+
+void BinaryLogSink::PutByte(char byte) {
+  WriteRaw(&byte, 1);
+}
+
+void BinaryLogSink::WriteRaw(const char* data, size_t size) {
+  if (!compressed_) {
+    out_.write(data, static_cast<std::streamsize>(size));
+    return;
+  }
+  block_buffer_.append(data, size);
+  // Full blocks go to the compression thread; the remainder waits for
+  // more records or Flush().
+  while (block_buffer_.size() >= basis::CompressedBlockWriter::kBlockSize) {
+    compressed_->write(block_buffer_.data(),
+                       basis::CompressedBlockWriter::kBlockSize);
+    block_buffer_.erase(0, basis::CompressedBlockWriter::kBlockSize);
+  }
+}
+
+namespace {
+
+// Bounds-checked reader for RenderBinaryLogFile.
+class LogFileReader {
+ public:
+  explicit LogFileReader(const std::string& data) : data_(data) {}
+
+  bool AtEnd() const { return pos_ == data_.size(); }
+
+  bool ReadByte(uint8_t* out) {
+    if (pos_ >= data_.size())
+      return false;
+    *out = static_cast<uint8_t>(data_[pos_++]);
+    return true;
+  }
+
+  bool ReadVarint(uint64_t* out) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      uint8_t byte;
+      if (!ReadByte(&byte))
+        return false;
+      value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      if (!(byte & 0x80)) {
+        *out = value;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool ReadString(std::string* out) {
+    uint64_t length;
+    if (!ReadVarint(&length))
+      return false;
+    if (length > data_.size() - pos_)
+      return false;
+    out->assign(data_, pos_, length);
+    pos_ += length;
+    return true;
+  }
+
+  bool ReadDouble(double* out) {
+    if (pos_ + sizeof(double) > data_.size())
+      return false;
+    std::memcpy(out, data_.data() + pos_, sizeof(double));
+    pos_ += sizeof(double);
+    return true;
+  }
+
+ private:
+  const std::string& data_;
+  size_t pos_ = 0;
+};
+
+}  // namespace
+
+base::Optional<std::string> RenderBinaryLogFile(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in.good())
+    return base::nullopt;
+  std::ostringstream raw;
+  raw << in.rdbuf();
+  std::string data = raw.str();
+
+  // A compressed sink wraps the GBL1 stream in block framing; undo it
+  // first so both layouts render identically.
+  if (data.size() >= 4 && data.compare(0, 4, "BLZ1") == 0) {
+    base::Optional<std::string> decompressed =
+        basis::decompressBlockFile(path);
+    if (!decompressed)
+      return base::nullopt;
+    data = std::move(*decompressed);
+  }
+
+  if (data.size() < sizeof(kBinaryLogMagic) ||
+      std::memcmp(data.data(), kBinaryLogMagic, sizeof(kBinaryLogMagic)) !=
+          0) {
+    return base::nullopt;
+  }
+
+  const std::string payload = data.substr(sizeof(kBinaryLogMagic));
+  LogFileReader reader(payload);
+  std::unordered_map<uint64_t, std::string> formats;
+  std::unordered_map<uint64_t, std::string> files;
+  std::string out;
+
+  while (!reader.AtEnd()) {
+    uint8_t record_type;
+    if (!reader.ReadByte(&record_type))
+      return base::nullopt;
+    switch (record_type) {
+      case kFormatDef:
+      case kFileDef: {
+        uint64_t id;
+        std::string text;
+        if (!reader.ReadVarint(&id) || !reader.ReadString(&text))
+          return base::nullopt;
+        (record_type == kFormatDef ? formats : files)[id] = std::move(text);
+        break;
+      }
+      case kEvent: {
+        uint64_t format_id, file_id, line, level, timestamp_us, arg_count;
+        if (!reader.ReadVarint(&format_id) || !reader.ReadVarint(&file_id) ||
+            !reader.ReadVarint(&line) || !reader.ReadVarint(&level) ||
+            !reader.ReadVarint(&timestamp_us) ||
+            !reader.ReadVarint(&arg_count) ||
+            arg_count > internal::kMaxLogArgs) {
+          return base::nullopt;
+        }
+        auto format_it = formats.find(format_id);
+        auto file_it = files.find(file_id);
+        if (format_it == formats.end() || file_it == files.end())
+          return base::nullopt;
+
+        internal::LogArg args[internal::kMaxLogArgs];
+        // Backing store for decoded argument strings; |args| points
+        // into it, so it must outlive the FormatLogMessage call.
+        std::vector<std::string> string_storage(arg_count);
+        for (uint64_t i = 0; i < arg_count; ++i) {
+          uint8_t type;
+          if (!reader.ReadByte(&type))
+            return base::nullopt;
+          args[i].type = static_cast<internal::LogArg::Type>(type);
+          switch (args[i].type) {
+            case internal::LogArg::Type::kInt: {
+              uint64_t raw_value;
+              if (!reader.ReadVarint(&raw_value))
+                return base::nullopt;
+              args[i].as_int = ZigZagDecode(raw_value);
+              break;
+            }
+            case internal::LogArg::Type::kUint:
+              if (!reader.ReadVarint(&args[i].as_uint))
+                return base::nullopt;
+              break;
+            case internal::LogArg::Type::kDouble:
+              if (!reader.ReadDouble(&args[i].as_double))
+                return base::nullopt;
+              break;
+            case internal::LogArg::Type::kBool: {
+              uint8_t byte;
+              if (!reader.ReadByte(&byte))
+                return base::nullopt;
+              args[i].as_bool = byte != 0;
+              break;
+            }
+            case internal::LogArg::Type::kCString:
+              if (!reader.ReadString(&string_storage[i]))
+                return base::nullopt;
+              args[i].as_cstring = string_storage[i].c_str();
+              break;
+            default:
+              return base::nullopt;
+          }
+        }
+
+        out += file_it->second;
+        out += ':';
+        out += std::to_string(line);
+        out += " [t+";
+        out += std::to_string(timestamp_us);
+        out += "us] V";
+        out += std::to_string(level);
+        out += ' ';
+        out += internal::FormatLogMessage(format_it->second.c_str(), args);
+        out += '\n';
+        break;
+      }
+      default:
+        return base::nullopt;
+    }
+  }
+  return out;
+}
+
+}  // namespace log
+}  // namespace gloer
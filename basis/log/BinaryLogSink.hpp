@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include <base/macros.h>
+#include <base/optional.h>
+
+#include "AsyncLogger.hpp"
+
+namespace basis {
+class CompressedBlockWriter;
+}  // namespace basis
+
+// Structured binary logging.
+//
+// Even with the async backend, rendering integers and floats to decimal
+// dominates logging cost - for messages nobody reads interactively.
+// BinaryLogSink takes formatting out of the process entirely: each event
+// is written to disk as a compact binary record referencing its format
+// string and file name by dictionary ID, with raw argument values.
+// Rendering to text happens offline via RenderBinaryLogFile() (callable
+// from a trivial host-side utility or a test); the log file is
+// self-describing because dictionary entries are emitted inline the
+// first time a format string or file name is seen.
+//
+// Wire format ("GBL1" magic, then records; varint = unsigned LEB128):
+//   0x01 FormatDef  varint id, varint length, format-string bytes
+//   0x02 FileDef    varint id, varint length, file-name bytes
+//   0x03 Event      varint format id, varint file id, varint line,
+//                   varint verbose level, varint timestamp (us),
+//                   varint argument count, then per argument a 1-byte
+//                   LogArg::Type tag and its payload (zigzag varint for
+//                   ints, varint for uints, 8 raw bytes for doubles,
+//                   1 byte for bools, varint length + bytes for strings)
+//
+// Attach a sink to the async backend with AsyncLogger::SetBinarySink();
+// the drain thread then writes records instead of formatting text, so
+// the producer-side cost of VLOG_LOC_ASYNC is unchanged.
+
+namespace gloer {
+namespace log {
+
+class BinaryLogSink {
+ public:
+  // Creates/truncates |path| and writes the header. ok() reports
+  // whether the file opened. With |compress| the records go through the
+  // streaming LZ4 stage (basis/compressed_block_writer.hpp): the drain
+  // thread hands 64 KiB blocks to a background compression thread and
+  // the disk sees ~4x fewer bytes; RenderBinaryLogFile() reads both
+  // layouts transparently.
+  explicit BinaryLogSink(const std::string& path, bool compress = false);
+  ~BinaryLogSink();
+
+  bool ok() const;
+
+  // Called by the drain thread only (single-threaded, like the text
+  // path). Emits dictionary entries for unseen format/file strings,
+  // then the event record.
+  void Write(const internal::LogRecord& record);
+
+  // Flushes buffered records to disk.
+  void Flush();
+
+ private:
+  uint32_t InternString(const char* string,
+                        uint8_t def_record_type,
+                        std::unordered_map<const char*, uint32_t>* ids);
+
+  void AppendVarint(uint64_t value);
+  void AppendZigZag(int64_t value);
+  void AppendBytes(const char* data, size_t size);
+
+  // Byte-level sinks shared by the append helpers: straight to |out_|,
+  // or staged in |block_buffer_| and handed to |compressed_| block by
+  // block.
+  void PutByte(char byte);
+  void WriteRaw(const char* data, size_t size);
+
+  std::ofstream out_;
+
+  // Set only in compressed mode (then |out_| stays closed).
+  std::unique_ptr<basis::CompressedBlockWriter> compressed_;
+  std::string block_buffer_;
+
+  // Dictionaries are keyed by pointer: format strings and file names
+  // are literals, so identical sites share one entry.
+  std::unordered_map<const char*, uint32_t> format_ids_;
+  std::unordered_map<const char*, uint32_t> file_ids_;
+  uint32_t next_id_ = 1;
+
+  DISALLOW_COPY_AND_ASSIGN(BinaryLogSink);
+};
+
+// Offline renderer: reads a BinaryLogSink file and returns one text
+// line per event ("file:line [t+<us>] V<level> <message>"), using the
+// same placeholder rules as the async text path. Returns base::nullopt
+// if the file cannot be read or is corrupt.
+base::Optional<std::string> RenderBinaryLogFile(const std::string& path);
+
+}  // namespace log
+}  // namespace gloer
@@ -1,6 +1,7 @@
 ﻿#include "Logger.hpp" // IWYU pragma: associated
 
 #include <base/location.h>
+#include <base/time/time.h>
 
 #ifndef __has_include
   static_assert(false, "__has_include not supported");
@@ -22,12 +23,67 @@
 namespace gloer {
 namespace log {
 
+namespace {
+
+// Bumped on every vlog configuration change; never reset.
+std::atomic<uint32_t> g_vlog_config_generation{0};
+
+}  // namespace
+
 bool VlogIsOnForLocation(const base::Location& from_here, int verbose_level) {
   return (verbose_level <=
           logging::GetVlogLevelHelper(from_here.file_name(),
                                       ::strlen(from_here.file_name())));
 }
 
+uint32_t VlogConfigGeneration() {
+  return g_vlog_config_generation.load(std::memory_order_relaxed);
+}
+
+void InvalidateVlogSiteCaches() {
+  g_vlog_config_generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool LogSiteRateLimiter::Acquire(uint32_t max_per_sec,
+                                 uint32_t* suppressed) {
+  *suppressed = 0;
+  if (max_per_sec == 0) {
+    suppressed_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  const uint32_t now_window = static_cast<uint32_t>(
+      base::TimeTicks::Now().since_origin().InSeconds());
+
+  uint64_t state = state_.load(std::memory_order_relaxed);
+  for (;;) {
+    const uint32_t window = static_cast<uint32_t>(state >> 32);
+    const uint32_t used = static_cast<uint32_t>(state);
+
+    if (window != now_window) {
+      // Fresh window: claim its first slot and report what the previous
+      // window dropped.
+      if (state_.compare_exchange_weak(
+              state, (static_cast<uint64_t>(now_window) << 32) | 1,
+              std::memory_order_relaxed)) {
+        *suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+        return true;
+      }
+      continue;
+    }
+
+    if (used >= max_per_sec) {
+      suppressed_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    if (state_.compare_exchange_weak(state, state + 1,
+                                     std::memory_order_relaxed)) {
+      return true;
+    }
+  }
+}
+
 //Logger::Logger() { initLogging(); }
 //
 //Logger::~Logger() { shutdown(); }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -15,11 +17,33 @@ class Location;
                       -verbose_level)                                 \
       .stream()
 
+// Per-callsite memo for the verbosity check below. The full check walks
+// the vmodule patterns keyed by file name on every hit; hot loops
+// execute it millions of times with logging off. Each macro expansion
+// gets a function-local VlogSiteCache, so a disabled site costs one
+// relaxed atomic load plus a branch until the configuration generation
+// changes (see InvalidateVlogSiteCaches()).
+#define VLOG_LOC_IS_ON(from_here, verbose_level)                              \
+  ([&]() -> bool {                                                            \
+    static ::gloer::log::VlogSiteCache vlog_loc_site_cache;                   \
+    const uint32_t vlog_loc_generation =                                      \
+        ::gloer::log::VlogConfigGeneration();                                 \
+    bool vlog_loc_verdict;                                                    \
+    if (!vlog_loc_site_cache.Lookup(vlog_loc_generation,                      \
+                                    from_here.file_name(), verbose_level,    \
+                                    &vlog_loc_verdict)) {                     \
+      vlog_loc_verdict =                                                      \
+          VLOG_IS_ON(verbose_level) ||                                        \
+          ::gloer::log::VlogIsOnForLocation(from_here, verbose_level);        \
+      vlog_loc_site_cache.Store(vlog_loc_generation, from_here.file_name(),   \
+                                verbose_level, vlog_loc_verdict);             \
+    }                                                                         \
+    return vlog_loc_verdict;                                                  \
+  }())
+
 #define VLOG_LOC_IF(from_here, verbose_level, condition) \
   LAZY_STREAM(VLOG_LOC_STREAM(from_here, verbose_level), \
-              condition &&                               \
-                  (VLOG_IS_ON(verbose_level) ||          \
-                   ::gloer::log::VlogIsOnForLocation(from_here, verbose_level)))
+              condition && VLOG_LOC_IS_ON(from_here, verbose_level))
 
 // USAGE:
 // command_line->AppendSwitchASCII(switches::kV, "1");
@@ -31,6 +55,34 @@ class Location;
 #define VLOG_LOC(from_here, verbose_level)              \
   VLOG_LOC_IF(from_here, verbose_level, 1)
 
+// VLOG_LOC with a per-site cap of |n_per_sec| emitted messages per
+// second. A misbehaving peer can make one log site fire 100k times a
+// second, and the formatting/sink cost then destroys tick latency;
+// this caps the worst case regardless of load. Excess hits are
+// dropped at the cost of one relaxed atomic increment, and the first
+// message that gets through afterwards is preceded by a suppression
+// count, so drops stay visible in the log. The verbosity check (and
+// its per-site cache) runs first: a disabled site costs the same as
+// plain VLOG_LOC and consumes no budget.
+#define VLOG_LOC_RATELIMITED(from_here, verbose_level, n_per_sec)             \
+  LAZY_STREAM(                                                                \
+      VLOG_LOC_STREAM(from_here, verbose_level),                              \
+      ([&]() -> bool {                                                        \
+        if (!VLOG_LOC_IS_ON(from_here, verbose_level))                        \
+          return false;                                                       \
+        static ::gloer::log::LogSiteRateLimiter vlog_loc_rate_limiter;        \
+        uint32_t vlog_loc_suppressed = 0;                                     \
+        if (!vlog_loc_rate_limiter.Acquire((n_per_sec),                       \
+                                           &vlog_loc_suppressed))             \
+          return false;                                                       \
+        if (vlog_loc_suppressed > 0) {                                        \
+          VLOG_LOC_STREAM(from_here, verbose_level)                           \
+              << "(rate limit: suppressed " << vlog_loc_suppressed            \
+              << " earlier messages at this site)";                           \
+        }                                                                     \
+        return true;                                                          \
+      }()))
+
 namespace gloer {
 namespace log {
 
@@ -69,5 +121,86 @@ namespace log {
 
 bool VlogIsOnForLocation(const base::Location& from_here, int verbose_level);
 
+// Generation of the vlog configuration. Bumped by
+// InvalidateVlogSiteCaches(); cached per-site verdicts tagged with an
+// older generation recompute on their next hit.
+uint32_t VlogConfigGeneration();
+
+// Call after changing --v/--vmodule settings at runtime. O(1): it only
+// bumps the generation counter, the (unknown many) site caches refresh
+// lazily.
+void InvalidateVlogSiteCaches();
+
+// One per VLOG_LOC_IS_ON expansion; see the macro comment. The verdict,
+// the configuration generation and a 16-bit hash of (file, level) are
+// packed into a single 64-bit atomic, so concurrent refreshes can never
+// tear a verdict onto the wrong site. The hash guards sites that relay
+// a caller-provided base::Location: a changed file or level misses the
+// cache and recomputes (a hash collision can at worst serve a stale
+// verdict until the next generation bump - logging-grade accuracy).
+class VlogSiteCache {
+ public:
+  VlogSiteCache() = default;
+
+  bool Lookup(uint32_t generation,
+              const char* file,
+              int verbose_level,
+              bool* verdict) const {
+    const uint64_t state = state_.load(std::memory_order_relaxed);
+    if ((state >> 32) != static_cast<uint64_t>(generation) + 1)
+      return false;
+    if (((state >> 16) & 0xFFFF) != SiteHash(file, verbose_level))
+      return false;
+    *verdict = state & 1;
+    return true;
+  }
+
+  void Store(uint32_t generation,
+             const char* file,
+             int verbose_level,
+             bool verdict) {
+    state_.store(((static_cast<uint64_t>(generation) + 1) << 32) |
+                     (static_cast<uint64_t>(SiteHash(file, verbose_level))
+                      << 16) |
+                     (verdict ? 1 : 0),
+                 std::memory_order_relaxed);
+  }
+
+ private:
+  static uint16_t SiteHash(const char* file, int verbose_level) {
+    uintptr_t h = reinterpret_cast<uintptr_t>(file) ^
+                  (static_cast<uintptr_t>(verbose_level) * 0x9E3779B1u);
+    return static_cast<uint16_t>(h ^ (h >> 16) ^ (h >> 31));
+  }
+
+  // Bits 63..32: generation + 1 (0 = no verdict yet).
+  // Bits 31..16: site hash. Bit 0: verdict.
+  std::atomic<uint64_t> state_{0};
+};
+
+// One per VLOG_LOC_RATELIMITED expansion: a fixed one-second window
+// with |max_per_sec| slots, packed into a single 64-bit atomic so
+// concurrent hits race only on a relaxed CAS. Slightly burstier than
+// a true token bucket (up to 2x max_per_sec across a window edge),
+// which is irrelevant at logging granularity and keeps the hot drop
+// path to one relaxed fetch_add.
+class LogSiteRateLimiter {
+ public:
+  LogSiteRateLimiter() = default;
+
+  // Returns true when this hit may log. When it returns true after
+  // one or more dropped hits, *suppressed carries how many were
+  // dropped (else 0), so the caller can surface the gap.
+  bool Acquire(uint32_t max_per_sec, uint32_t* suppressed);
+
+ private:
+  // Bits 63..32: window id (seconds, truncated); bits 31..0: hits
+  // consumed in that window.
+  std::atomic<uint64_t> state_{0};
+
+  // Hits dropped since the last window rollover.
+  std::atomic<uint32_t> suppressed_{0};
+};
+
 } // namespace log
 } // namespace gloer
@@ -4,9 +4,13 @@
 #include <base/path_service.h>
 #include <base/files/file_util.h>
 
+#include <basis/startup_phases.hpp>
+
 namespace basis {
 
 void initLogging(const std::string& logFile) {
+  ScopedStartupPhase startup_phase("initLogging");
+
   logging::LoggingSettings logging_settings;
   logging_settings.logging_dest
     = logFile.empty() ?
@@ -26,8 +26,15 @@
  **/
 
 #include <stdio.h>
+
+#include <atomic>
+#include <cstdint>
+
 #include <base/logging.h> // for DCHECK_IS_ON
 
+#include <basis/enum_set.hpp>
+#include <basis/ltrace_format.hpp>
+
 //#define __FUNC__ __PRETTY_FUNCTION__
 #define __FUNC__ __func__
 
@@ -98,3 +105,127 @@
  (LOCAL_CATEGORY_AND_LEVEL_ENABLED(category, level) \
   && DCHECK_IS_ON())
 
+/**
+ * Runtime trace categories.
+ *
+ * The LOCAL_ENABLE_CATEGORY_* defines above are resolved at compile
+ * time, so flipping a category means a recompile and a deploy. The
+ * registry below is the hybrid: categories are values of a user enum
+ * registered into a 64-bit atomic mask, so a compiled-in site costs one
+ * relaxed load plus a test when its category is off, and the mask can
+ * be flipped on a live server. The compile-time LOCAL_TRACE_LEVEL gate
+ * still applies first, so levels compiled out keep costing nothing.
+ *
+ * @example
+ *   enum class TraceCat { kNet, kDecode, kMix, kMaxValue = kMix };
+ *   using AppTraceCategories = ::basis::ltrace::CategoryRegistry<
+ *       TraceCat, TraceCat::kNet, TraceCat::kMaxValue>;
+ *
+ *   LTRACEF_CATEGORY(AppTraceCategories, TraceCat::kNet, 1,
+ *                    "rx %d bytes\n", size);  // off: one load + branch
+ *
+ *   AppTraceCategories::Enable(TraceCat::kNet);   // from admin console
+ *   AppTraceCategories::Disable(TraceCat::kNet);
+ **/
+
+namespace basis {
+namespace ltrace {
+
+// One runtime mask per registry instantiation. Categories are a user
+// enum handled through SmallEnumSet (basis/enum_set.hpp), so the usual
+// constexpr set algebra is available for building masks.
+template <typename CategoryEnum,
+          CategoryEnum MinValue,
+          CategoryEnum MaxValue>
+struct CategoryRegistry {
+  using Set = ::basis::SmallEnumSet<CategoryEnum, MinValue, MaxValue>;
+
+  // The per-site check: one relaxed atomic load plus a test.
+  static bool IsEnabled(CategoryEnum category) {
+    return (Mask().load(std::memory_order_relaxed) &
+            Set::single_val_bitstring(category)) != 0;
+  }
+
+  template <class... T>
+  static void Enable(CategoryEnum head, T... tail) {
+    Mask().fetch_or(Set::bitstring(head, tail...),
+                    std::memory_order_relaxed);
+  }
+
+  template <class... T>
+  static void Disable(CategoryEnum head, T... tail) {
+    Mask().fetch_and(~Set::bitstring(head, tail...),
+                     std::memory_order_relaxed);
+  }
+
+  static void EnableAll() {
+    Mask().store(~uint64_t{0}, std::memory_order_relaxed);
+  }
+
+  static void DisableAll() {
+    Mask().store(0, std::memory_order_relaxed);
+  }
+
+ private:
+  static std::atomic<uint64_t>& Mask() {
+    static std::atomic<uint64_t> mask{0};
+    return mask;
+  }
+};
+
+} // namespace ltrace
+} // namespace basis
+
+/* trace routines gated by a runtime category on top of the compile-time
+   level: when LOCAL_TRACE_LEVEL compiles the site out the category
+   check folds away with it */
+#define LTRACEF_CATEGORY(registry, category, level, x...) \
+  do {                                                    \
+    if (LOCAL_TRACE_LEVEL >= (level)) {                   \
+      if (registry::IsEnabled(category)) {                \
+        TRACEF(x);                                        \
+      }                                                   \
+    }                                                     \
+  } while (0)
+
+#define LTRACE_CATEGORY(registry, category)   \
+  do {                                        \
+    if (LOCAL_TRACE_LEVEL) {                  \
+      if (registry::IsEnabled(category)) {    \
+        TRACE;                                \
+      }                                       \
+    }                                         \
+  } while (0)
+
+/* LTRACEF with a compile-time checked format string: the format is
+   parsed by a constexpr parser (basis/ltrace_format.hpp), so a bad
+   conversion or an argument count/type mismatch is a static_assert
+   instead of a runtime crash, and an enabled site only copies literals
+   and converts arguments into a stack buffer instead of re-parsing the
+   format through printf. Requires |fmt_str| to be a string literal
+   (non-literals fail to compile, which is the point). Supported
+   conversions are listed in basis/ltrace_format.hpp */
+#define LTRACEF_FAST(fmt_str, x...)                                  \
+  do {                                                               \
+    if (LOCAL_TRACE_LEVEL) {                                         \
+      struct LtraceFmtHolder {                                       \
+        static constexpr const char* str() { return fmt_str; }       \
+        static constexpr size_t size() { return sizeof(fmt_str); }   \
+      };                                                             \
+      char ltrace_fmt_buf[::basis::ltrace::kFormatBufferSize];       \
+      const size_t ltrace_fmt_len =                                  \
+          ::basis::ltrace::FormatTrace<LtraceFmtHolder>(             \
+              ltrace_fmt_buf, sizeof(ltrace_fmt_buf), ##x);          \
+      TRACE_LOG_FUNC("%s:%d: %.*s", __FUNC__, __LINE__,              \
+                     static_cast<int>(ltrace_fmt_len),               \
+                     ltrace_fmt_buf);                                \
+    }                                                                \
+  } while (0)
+
+#define LTRACEF_FAST_LEVEL(level, fmt_str, x...) \
+  do {                                           \
+    if (LOCAL_TRACE_LEVEL >= (level)) {          \
+      LTRACEF_FAST(fmt_str, ##x);                \
+    }                                            \
+  } while (0)
+
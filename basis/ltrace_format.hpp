@@ -0,0 +1,411 @@
+#pragma once
+
+/**
+ * Compile-time format machinery for the ltrace macros (basis/ltrace.hpp).
+ *
+ * LTRACEF goes through printf, which re-parses the format string and
+ * walks the locale machinery on every hit. The helpers here parse the
+ * format string with a constexpr parser instead:
+ *
+ *  - malformed format strings and argument type/count mismatches are
+ *    compile errors (static_assert), not runtime crashes;
+ *  - the layout (literal runs + typed slots) is computed at compile
+ *    time, so the runtime work of an enabled site is only copying the
+ *    literals and converting the arguments into a stack buffer.
+ *
+ * Supported conversions: %d %i %u %x %X (with l/ll/z length modifiers),
+ * %f %g %e, %s, %c, %p and %%. Width/precision flags are intentionally
+ * not supported — trace lines do not need them and rejecting them keeps
+ * the parser honest.
+ *
+ * Use through LTRACEF_FAST (see basis/ltrace.hpp).
+ **/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace basis {
+namespace ltrace {
+
+// Stack buffer for one formatted trace line.
+constexpr size_t kFormatBufferSize = 512;
+
+enum class SlotType : uint8_t {
+  kInt,        // %d %i (<= 32-bit integral)
+  kUnsigned,   // %u (<= 32-bit integral)
+  kHex,        // %x %X (<= 32-bit integral)
+  kLongLong,   // %lld %ld %zd (64-bit integral)
+  kULongLong,  // %llu %lu %zu (64-bit integral)
+  kHexLong,    // %llx %lx %zx (64-bit integral)
+  kDouble,     // %f %g %e (float or double)
+  kChar,       // %c
+  kString,     // %s
+  kPointer,    // %p
+  kPercent,    // %% — consumes no argument
+};
+
+// Layout of one format string: for each slot, the literal run that
+// precedes it plus the conversion; |tail_*| is the literal after the
+// last slot. Offsets index into the original format string.
+struct FormatSpec {
+  static constexpr size_t kMaxSlots = 16;
+
+  struct Slot {
+    uint16_t literal_begin = 0;
+    uint16_t literal_end = 0;
+    SlotType type = SlotType::kInt;
+  };
+
+  Slot slots[kMaxSlots] = {};
+  size_t slot_count = 0;       // includes kPercent slots
+  size_t argument_count = 0;   // excludes kPercent slots
+  uint16_t tail_begin = 0;
+  uint16_t tail_end = 0;
+  bool valid = false;
+};
+
+// Parses |fmt| (NUL-terminated, |size| includes the NUL). Returns a
+// spec with valid == false on any unsupported or malformed conversion.
+constexpr FormatSpec ParseFormat(const char* fmt, size_t size) {
+  FormatSpec spec;
+  const size_t length = size - 1;  // drop the NUL
+  size_t literal_begin = 0;
+  size_t i = 0;
+  while (i < length) {
+    if (fmt[i] != '%') {
+      ++i;
+      continue;
+    }
+    if (spec.slot_count == FormatSpec::kMaxSlots) {
+      return spec;  // too many conversions; invalid
+    }
+    FormatSpec::Slot& slot = spec.slots[spec.slot_count];
+    slot.literal_begin = static_cast<uint16_t>(literal_begin);
+    slot.literal_end = static_cast<uint16_t>(i);
+
+    ++i;  // past '%'
+    // Length modifier.
+    int longs = 0;
+    if (i < length && fmt[i] == 'z') {
+      longs = 2;
+      ++i;
+    } else {
+      while (i < length && fmt[i] == 'l' && longs < 2) {
+        ++longs;
+        ++i;
+      }
+    }
+    if (i >= length) {
+      return spec;  // dangling '%'
+    }
+    // sizeof(long) is 8 on the platforms this runs on; treat a single
+    // 'l' like 'll'.
+    const bool wide = longs > 0;
+    switch (fmt[i]) {
+      case 'd':
+      case 'i':
+        slot.type = wide ? SlotType::kLongLong : SlotType::kInt;
+        break;
+      case 'u':
+        slot.type = wide ? SlotType::kULongLong : SlotType::kUnsigned;
+        break;
+      case 'x':
+      case 'X':
+        slot.type = wide ? SlotType::kHexLong : SlotType::kHex;
+        break;
+      case 'f':
+      case 'g':
+      case 'e':
+        if (wide) {
+          return spec;
+        }
+        slot.type = SlotType::kDouble;
+        break;
+      case 'c':
+        if (wide) {
+          return spec;
+        }
+        slot.type = SlotType::kChar;
+        break;
+      case 's':
+        if (wide) {
+          return spec;
+        }
+        slot.type = SlotType::kString;
+        break;
+      case 'p':
+        if (wide) {
+          return spec;
+        }
+        slot.type = SlotType::kPointer;
+        break;
+      case '%':
+        if (wide) {
+          return spec;
+        }
+        slot.type = SlotType::kPercent;
+        break;
+      default:
+        return spec;  // unsupported conversion (incl. width/precision)
+    }
+    ++i;
+    ++spec.slot_count;
+    if (slot.type != SlotType::kPercent) {
+      ++spec.argument_count;
+    }
+    literal_begin = i;
+  }
+  spec.tail_begin = static_cast<uint16_t>(literal_begin);
+  spec.tail_end = static_cast<uint16_t>(length);
+  spec.valid = true;
+  return spec;
+}
+
+// Compile-time classification of an argument type for slot matching.
+enum class ArgKind : uint8_t {
+  kSmallIntegral,  // <= 32-bit integral (after promotion rules)
+  kWideIntegral,   // 64-bit integral
+  kFloating,
+  kCString,
+  kPointer,
+  kUnsupported,
+};
+
+template <typename T>
+constexpr ArgKind KindOf() {
+  using Decayed = std::decay_t<T>;
+  if constexpr (std::is_same_v<Decayed, char*> ||
+                std::is_same_v<Decayed, const char*>) {
+    return ArgKind::kCString;
+  } else if constexpr (std::is_pointer_v<Decayed> ||
+                       std::is_null_pointer_v<Decayed>) {
+    return ArgKind::kPointer;
+  } else if constexpr (std::is_floating_point_v<Decayed>) {
+    return ArgKind::kFloating;
+  } else if constexpr (std::is_integral_v<Decayed> ||
+                       std::is_enum_v<Decayed>) {
+    return sizeof(Decayed) <= 4 ? ArgKind::kSmallIntegral
+                                : ArgKind::kWideIntegral;
+  } else {
+    return ArgKind::kUnsupported;
+  }
+}
+
+// Signedness of %d vs %u is deliberately not enforced (printf varargs
+// never did either); width is, since passing a 64-bit value to a
+// 32-bit slot truncates.
+constexpr bool SlotAccepts(SlotType type, ArgKind kind) {
+  switch (type) {
+    case SlotType::kInt:
+    case SlotType::kUnsigned:
+    case SlotType::kHex:
+    case SlotType::kChar:
+      return kind == ArgKind::kSmallIntegral;
+    case SlotType::kLongLong:
+    case SlotType::kULongLong:
+    case SlotType::kHexLong:
+      return kind == ArgKind::kSmallIntegral ||
+             kind == ArgKind::kWideIntegral;
+    case SlotType::kDouble:
+      return kind == ArgKind::kFloating;
+    case SlotType::kString:
+      return kind == ArgKind::kCString;
+    case SlotType::kPointer:
+      return kind == ArgKind::kPointer || kind == ArgKind::kCString;
+    case SlotType::kPercent:
+      return false;  // consumes no argument
+  }
+  return false;
+}
+
+template <typename... Args>
+constexpr bool SlotsMatch(const FormatSpec& spec) {
+  const ArgKind kinds[] = {KindOf<Args>()..., ArgKind::kUnsupported};
+  size_t arg = 0;
+  for (size_t i = 0; i < spec.slot_count; ++i) {
+    if (spec.slots[i].type == SlotType::kPercent) {
+      continue;
+    }
+    if (arg >= sizeof...(Args) ||
+        !SlotAccepts(spec.slots[i].type, kinds[arg])) {
+      return false;
+    }
+    ++arg;
+  }
+  return arg == sizeof...(Args);
+}
+
+// ---------------------------------------------------------------------
+// Runtime side: literal copies plus hand-rolled conversions. Everything
+// truncates safely at |cap|; the buffer is never overrun and the
+// returned length never exceeds it.
+
+inline size_t AppendRaw(char* out, size_t cap, size_t pos,
+                        const char* data, size_t length) {
+  if (pos >= cap) {
+    return pos;
+  }
+  const size_t room = cap - pos;
+  const size_t n = length < room ? length : room;
+  memcpy(out + pos, data, n);
+  return pos + n;
+}
+
+inline size_t AppendUnsignedBase(char* out, size_t cap, size_t pos,
+                                 unsigned long long value, unsigned base,
+                                 bool uppercase) {
+  char digits[24];
+  size_t n = 0;
+  const char* alphabet =
+      uppercase ? "0123456789ABCDEF" : "0123456789abcdef";
+  do {
+    digits[n++] = alphabet[value % base];
+    value /= base;
+  } while (value);
+  // Reverse into the output.
+  for (size_t i = 0; i < n && pos < cap; ++i) {
+    out[pos++] = digits[n - 1 - i];
+  }
+  return pos;
+}
+
+inline size_t AppendSigned(char* out, size_t cap, size_t pos,
+                           long long value) {
+  if (value < 0) {
+    if (pos < cap) {
+      out[pos++] = '-';
+    }
+    return AppendUnsignedBase(
+        out, cap, pos,
+        ~static_cast<unsigned long long>(value) + 1ull, 10, false);
+  }
+  return AppendUnsignedBase(
+      out, cap, pos, static_cast<unsigned long long>(value), 10, false);
+}
+
+template <typename T>
+inline size_t AppendArg(char* out, size_t cap, size_t pos,
+                        SlotType type, const T& value) {
+  if constexpr (std::is_same_v<std::decay_t<T>, char*> ||
+                std::is_same_v<std::decay_t<T>, const char*>) {
+    if (type == SlotType::kPointer) {
+      pos = AppendRaw(out, cap, pos, "0x", 2);
+      return AppendUnsignedBase(out, cap, pos,
+                                reinterpret_cast<uintptr_t>(value), 16,
+                                false);
+    }
+    const char* str = value;
+    if constexpr (!std::is_array_v<T>) {  // literals cannot be null
+      if (!str) {
+        str = "(null)";
+      }
+    }
+    return AppendRaw(out, cap, pos, str, strlen(str));
+  } else if constexpr (std::is_pointer_v<std::decay_t<T>> ||
+                       std::is_null_pointer_v<std::decay_t<T>>) {
+    pos = AppendRaw(out, cap, pos, "0x", 2);
+    return AppendUnsignedBase(
+        out, cap, pos,
+        reinterpret_cast<uintptr_t>(
+            static_cast<const void*>(value)), 16, false);
+  } else if constexpr (std::is_floating_point_v<std::decay_t<T>>) {
+    // Binary-to-decimal for floats is genuinely hard; lean on snprintf
+    // for this one conversion (rare on trace lines) and keep the
+    // integer/string fast paths printf-free.
+    char tmp[32];
+    const int n =
+        snprintf(tmp, sizeof(tmp), "%g", static_cast<double>(value));
+    return AppendRaw(out, cap, pos, tmp, n > 0 ? static_cast<size_t>(n) : 0);
+  } else if constexpr (std::is_integral_v<std::decay_t<T>> ||
+                       std::is_enum_v<std::decay_t<T>>) {
+    const long long wide = static_cast<long long>(value);
+    switch (type) {
+      case SlotType::kChar: {
+        if (pos < cap) {
+          out[pos++] = static_cast<char>(wide);
+        }
+        return pos;
+      }
+      case SlotType::kHex:
+        return AppendUnsignedBase(
+            out, cap, pos,
+            static_cast<uint32_t>(wide), 16, false);
+      case SlotType::kHexLong:
+        return AppendUnsignedBase(
+            out, cap, pos,
+            static_cast<unsigned long long>(wide), 16, false);
+      case SlotType::kUnsigned:
+        return AppendUnsignedBase(
+            out, cap, pos, static_cast<uint32_t>(wide), 10, false);
+      case SlotType::kULongLong:
+        return AppendUnsignedBase(
+            out, cap, pos,
+            static_cast<unsigned long long>(wide), 10, false);
+      default:
+        return AppendSigned(out, cap, pos, wide);
+    }
+  } else {
+    static_assert(sizeof(T) == 0, "unsupported ltrace argument type");
+    return pos;
+  }
+}
+
+template <typename FmtHolder>
+inline size_t FormatSlots(char* out, size_t cap, size_t pos,
+                          size_t slot_index) {
+  constexpr FormatSpec spec =
+      ParseFormat(FmtHolder::str(), FmtHolder::size());
+  // Remaining slots can only be %%.
+  for (size_t i = slot_index; i < spec.slot_count; ++i) {
+    pos = AppendRaw(out, cap, pos, FmtHolder::str() + spec.slots[i].literal_begin,
+                    spec.slots[i].literal_end - spec.slots[i].literal_begin);
+    pos = AppendRaw(out, cap, pos, "%", 1);
+  }
+  return AppendRaw(out, cap, pos, FmtHolder::str() + spec.tail_begin,
+                   spec.tail_end - spec.tail_begin);
+}
+
+template <typename FmtHolder, typename Arg, typename... Rest>
+inline size_t FormatSlots(char* out, size_t cap, size_t pos,
+                          size_t slot_index, const Arg& arg,
+                          const Rest&... rest) {
+  constexpr FormatSpec spec =
+      ParseFormat(FmtHolder::str(), FmtHolder::size());
+  // Emit any %% slots that precede the next argument slot.
+  while (spec.slots[slot_index].type == SlotType::kPercent) {
+    pos = AppendRaw(out, cap, pos,
+                    FmtHolder::str() + spec.slots[slot_index].literal_begin,
+                    spec.slots[slot_index].literal_end -
+                        spec.slots[slot_index].literal_begin);
+    pos = AppendRaw(out, cap, pos, "%", 1);
+    ++slot_index;
+  }
+  const FormatSpec::Slot& slot = spec.slots[slot_index];
+  pos = AppendRaw(out, cap, pos, FmtHolder::str() + slot.literal_begin,
+                  slot.literal_end - slot.literal_begin);
+  pos = AppendArg(out, cap, pos, slot.type, arg);
+  return FormatSlots<FmtHolder>(out, cap, pos, slot_index + 1, rest...);
+}
+
+// Entry point used by LTRACEF_FAST. |FmtHolder| is the local struct
+// the macro wraps around the format literal so the string stays a
+// constant expression in here.
+template <typename FmtHolder, typename... Args>
+inline size_t FormatTrace(char* out, size_t cap, const Args&... args) {
+  constexpr FormatSpec spec =
+      ParseFormat(FmtHolder::str(), FmtHolder::size());
+  static_assert(spec.valid,
+                "LTRACEF_FAST: malformed or unsupported format string");
+  static_assert(spec.argument_count == sizeof...(Args),
+                "LTRACEF_FAST: argument count does not match format string");
+  static_assert(SlotsMatch<Args...>(spec),
+                "LTRACEF_FAST: argument type does not match conversion");
+  return FormatSlots<FmtHolder>(out, cap, 0, 0, args...);
+}
+
+}  // namespace ltrace
+}  // namespace basis
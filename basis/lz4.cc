@@ -0,0 +1,236 @@
+#include "basis/lz4.hpp" // IWYU pragma: associated
+
+#include <cstring>
+
+namespace basis {
+
+namespace {
+
+// Block-format constants, straight from the spec: matches are at least
+// 4 bytes, the last 5 bytes of a block are always literals, and no
+// match may start within the last 12 bytes.
+constexpr size_t kMinMatch = 4;
+constexpr size_t kLastLiterals = 5;
+constexpr size_t kMfLimit = 12;
+constexpr size_t kMaxOffset = 65535;
+
+// 4096-entry hash table: 16 KiB, cheap to zero per block and enough for
+// the 64 KiB blocks the flush framing uses.
+constexpr int kHashLog = 12;
+
+inline uint32_t read32(const uint8_t* p) {
+  uint32_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+// Fibonacci hash of the 4 bytes at a position.
+inline uint32_t hash4(uint32_t value) {
+  return (value * 2654435761u) >> (32 - kHashLog);
+}
+
+}  // namespace
+
+size_t lz4CompressBlock(
+  const uint8_t* src
+  , size_t src_size
+  , uint8_t* dst
+  , size_t dst_capacity)
+{
+  const uint8_t* ip = src;
+  const uint8_t* anchor = src;
+  const uint8_t* const iend = src + src_size;
+  uint8_t* op = dst;
+  uint8_t* const oend = dst + dst_capacity;
+
+  // Positions of previously seen 4-byte sequences, as offsets from
+  // |src|. A stale/empty slot is filtered by the byte compare below.
+  uint32_t table[size_t(1) << kHashLog];
+  std::memset(table, 0, sizeof(table));
+
+  if (src_size > kMfLimit) {
+    const uint8_t* const mflimit = iend - kMfLimit;
+    const uint8_t* const match_limit = iend - kLastLiterals;
+
+    while (ip < mflimit) {
+      const uint32_t sequence = read32(ip);
+      const uint32_t hash = hash4(sequence);
+      const uint8_t* match = src + table[hash];
+      table[hash] = static_cast<uint32_t>(ip - src);
+
+      if (match >= ip
+          || static_cast<size_t>(ip - match) > kMaxOffset
+          || read32(match) != sequence) {
+        ++ip;
+        continue;
+      }
+
+      // Extend the match forward (never into the mandatory trailing
+      // literals).
+      size_t match_len = kMinMatch;
+      while (ip + match_len < match_limit
+             && ip[match_len] == match[match_len]) {
+        ++match_len;
+      }
+
+      const size_t lit_len = static_cast<size_t>(ip - anchor);
+
+      // Worst case for this sequence: token, extended literal length,
+      // literals, 2-byte offset, extended match length.
+      if (op + 1 + lit_len / 255 + 1 + lit_len + 2 + match_len / 255 + 1
+          > oend) {
+        return 0;
+      }
+
+      uint8_t* const token = op++;
+      if (lit_len >= 15) {
+        *token = 15 << 4;
+        size_t remaining = lit_len - 15;
+        for (; remaining >= 255; remaining -= 255) {
+          *op++ = 255;
+        }
+        *op++ = static_cast<uint8_t>(remaining);
+      } else {
+        *token = static_cast<uint8_t>(lit_len << 4);
+      }
+      std::memcpy(op, anchor, lit_len);
+      op += lit_len;
+
+      const size_t offset = static_cast<size_t>(ip - match);
+      *op++ = static_cast<uint8_t>(offset);
+      *op++ = static_cast<uint8_t>(offset >> 8);
+
+      size_t extra = match_len - kMinMatch;
+      if (extra >= 15) {
+        *token |= 15;
+        extra -= 15;
+        for (; extra >= 255; extra -= 255) {
+          *op++ = 255;
+        }
+        *op++ = static_cast<uint8_t>(extra);
+      } else {
+        *token |= static_cast<uint8_t>(extra);
+      }
+
+      ip += match_len;
+      anchor = ip;
+
+      // Seed the table inside the span just covered so the next search
+      // can match against it.
+      if (ip < mflimit) {
+        table[hash4(read32(ip - 2))] = static_cast<uint32_t>(ip - 2 - src);
+      }
+    }
+  }
+
+  // Trailing literals (the whole input, for tiny blocks).
+  const size_t last_lit = static_cast<size_t>(iend - anchor);
+  if (op + 1 + last_lit / 255 + 1 + last_lit > oend) {
+    return 0;
+  }
+  uint8_t* const token = op++;
+  if (last_lit >= 15) {
+    *token = 15 << 4;
+    size_t remaining = last_lit - 15;
+    for (; remaining >= 255; remaining -= 255) {
+      *op++ = 255;
+    }
+    *op++ = static_cast<uint8_t>(remaining);
+  } else {
+    *token = static_cast<uint8_t>(last_lit << 4);
+  }
+  if (last_lit != 0) {
+    std::memcpy(op, anchor, last_lit);
+    op += last_lit;
+  }
+
+  return static_cast<size_t>(op - dst);
+}
+
+size_t lz4DecompressBlock(
+  const uint8_t* src
+  , size_t src_size
+  , uint8_t* dst
+  , size_t dst_capacity)
+{
+  const uint8_t* ip = src;
+  const uint8_t* const iend = src + src_size;
+  uint8_t* op = dst;
+  uint8_t* const oend = dst + dst_capacity;
+
+  if (src_size == 0) {
+    return 0;
+  }
+
+  for (;;) {
+    if (ip >= iend) {
+      // A block always ends inside a literal run.
+      return 0;
+    }
+    const uint8_t token = *ip++;
+
+    size_t lit_len = token >> 4;
+    if (lit_len == 15) {
+      uint8_t byte;
+      do {
+        if (ip >= iend) {
+          return 0;
+        }
+        byte = *ip++;
+        lit_len += byte;
+      } while (byte == 255);
+    }
+    if (lit_len > static_cast<size_t>(iend - ip)
+        || lit_len > static_cast<size_t>(oend - op)) {
+      return 0;
+    }
+    if (lit_len != 0) {
+      std::memcpy(op, ip, lit_len);
+      op += lit_len;
+      ip += lit_len;
+    }
+
+    if (ip == iend) {
+      // Last sequence: literals only, no match.
+      break;
+    }
+
+    if (iend - ip < 2) {
+      return 0;
+    }
+    const size_t offset = static_cast<size_t>(ip[0])
+                          | (static_cast<size_t>(ip[1]) << 8);
+    ip += 2;
+    if (offset == 0 || offset > static_cast<size_t>(op - dst)) {
+      return 0;
+    }
+
+    size_t match_len = token & 15;
+    if (match_len == 15) {
+      uint8_t byte;
+      do {
+        if (ip >= iend) {
+          return 0;
+        }
+        byte = *ip++;
+        match_len += byte;
+      } while (byte == 255);
+    }
+    match_len += kMinMatch;
+    if (match_len > static_cast<size_t>(oend - op)) {
+      return 0;
+    }
+
+    // Byte-by-byte on purpose: overlapping copies (offset < match_len)
+    // are how LZ4 encodes runs, and memcpy/memmove don't replicate.
+    const uint8_t* match = op - offset;
+    for (size_t i = 0; i < match_len; ++i) {
+      op[i] = match[i];
+    }
+    op += match_len;
+  }
+
+  return static_cast<size_t>(op - dst);
+}
+
+}  // namespace basis
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace basis {
+
+// Self-contained LZ4 block codec (the raw block format, see
+// https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md), so flush
+// paths can compress without pulling a third-party dependency into the
+// build. LZ4 is the right trade for I/O relief on hot paths: the greedy
+// encoder below compresses at memcpy-like speed and still takes ~4x out
+// of trace JSON and binary log records, whereas a stronger codec would
+// make the compression stage the bottleneck instead of the disk.
+//
+// Only whole blocks are handled here; framing (sizes, magic, raw
+// fallback for incompressible blocks) is the caller's job - see
+// compressed_block_writer.hpp for the standard file framing.
+
+// Worst-case compressed size for |src_size| input bytes; size the
+// destination of lz4CompressBlock() with this.
+constexpr size_t lz4CompressBound(size_t src_size) {
+  return src_size + src_size / 255 + 16;
+}
+
+// Compresses |src_size| bytes into |dst|. Returns the compressed size,
+// or 0 when |dst_capacity| is too small (never happens with
+// lz4CompressBound(src_size) capacity). Output decodes with any
+// standard LZ4 block decoder.
+size_t lz4CompressBlock(
+  const uint8_t* src
+  , size_t src_size
+  , uint8_t* dst
+  , size_t dst_capacity);
+
+// Decompresses an LZ4 block into |dst|. Returns the decompressed size,
+// or 0 when the input is corrupt / truncated or the output does not fit
+// |dst_capacity|. (An empty decompressed result is indistinguishable
+// from an error; the framing layer never writes empty blocks.)
+size_t lz4DecompressBlock(
+  const uint8_t* src
+  , size_t src_size
+  , uint8_t* dst
+  , size_t dst_capacity);
+
+}  // namespace basis
@@ -0,0 +1,123 @@
+#include <basis/memory/Arena.hpp>
+
+#include <cassert>
+#include <cstdlib>
+
+namespace basis {
+
+namespace {
+
+size_t alignUp(size_t value, size_t alignment)
+{
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+}  // namespace
+
+char* Arena::payload(Block* block)
+{
+  return reinterpret_cast<char*>(block) + blockHeaderSize();
+}
+
+Arena::Arena(size_t block_size)
+  : block_size_(block_size)
+{
+  assert(block_size_ >= kCacheLineSize);
+}
+
+Arena::~Arena()
+{
+  Block* block = head_;
+  while (block) {
+    Block* next = block->next;
+    ::free(block);
+    block = next;
+  }
+}
+
+void* Arena::allocate(size_t size, size_t alignment)
+{
+  assert((alignment & (alignment - 1)) == 0 && "power of two");
+  // Payloads start cache-line aligned; offsets inside a block cannot
+  // guarantee more than that.
+  assert(alignment <= kCacheLineSize);
+
+  if (!current_) {
+    current_ = head_ = newBlock(size + alignment);
+  }
+
+  size_t offset = alignUp(current_->used, alignment);
+  if (offset + size > current_->capacity) {
+    // Reuse a block kept alive by a previous reset() before acquiring
+    // a fresh one.
+    if (current_->next && size <= current_->next->capacity) {
+      current_ = current_->next;
+      current_->used = 0;
+    } else {
+      Block* fresh = newBlock(size + alignment);
+      fresh->next = current_->next;
+      current_->next = fresh;
+      current_ = fresh;
+    }
+    offset = alignUp(current_->used, alignment);
+  }
+
+  current_->used = offset + size;
+  bytes_allocated_ += size;
+  return payload(current_) + offset;
+}
+
+void Arena::reset()
+{
+  // Blocks are kept (their |used| is rewound lazily as allocate()
+  // walks back onto them), so a steady-state tick never re-enters
+  // malloc.
+  if (head_) {
+    head_->used = 0;
+    current_ = head_;
+  }
+  bytes_allocated_ = 0;
+}
+
+void Arena::trim()
+{
+  if (!head_) {
+    return;
+  }
+  Block* block = head_->next;
+  while (block) {
+    Block* next = block->next;
+    bytes_reserved_ -= block->capacity + blockHeaderSize();
+    ::free(block);
+    block = next;
+  }
+  head_->next = nullptr;
+  head_->used = 0;
+  current_ = head_;
+  bytes_allocated_ = 0;
+}
+
+Arena::Block* Arena::newBlock(size_t min_capacity)
+{
+  size_t capacity = block_size_ - blockHeaderSize();
+  if (capacity < min_capacity) {
+    capacity = alignUp(min_capacity, kCacheLineSize);
+  }
+
+  void* memory = nullptr;
+  // Cache-line-aligned block start => cache-line-aligned payload.
+  if (::posix_memalign(&memory, kCacheLineSize,
+                       blockHeaderSize() + capacity) != 0)
+  {
+    throw std::bad_alloc();
+  }
+
+  Block* block = static_cast<Block*>(memory);
+  block->next = nullptr;
+  block->capacity = capacity;
+  block->used = 0;
+  bytes_reserved_ += blockHeaderSize() + capacity;
+  return block;
+}
+
+}  // namespace basis
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+namespace basis {
+
+/*
+ * Bump-pointer region allocator.
+ *
+ * Allocation is a pointer increment inside the current block; individual
+ * frees are no-ops and the whole region is reclaimed at once with reset().
+ * That makes it a fit for transient per-tick / per-request data: allocate
+ * freely during the tick, reset() once at the end, and the blocks are
+ * reused for the next tick without touching malloc.
+ *
+ * Alignment is honored per allocation (default: alignof(max_align_t));
+ * blocks themselves start cache-line aligned so cache-line-aligned
+ * requests never straddle a line.
+ *
+ * Not thread safe: one Arena per owning thread/sequence, which is how
+ * per-tick usage works anyway.
+ */
+class Arena {
+ public:
+  static constexpr size_t kDefaultBlockSize = 64 * 1024;
+  static constexpr size_t kCacheLineSize = 64;
+
+  explicit Arena(size_t block_size = kDefaultBlockSize);
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  ~Arena();
+
+  // Returns |size| bytes aligned to |alignment| (a power of two).
+  // Oversized requests get a dedicated block; they work, but a larger
+  // block_size fits the usage better.
+  void* allocate(size_t size
+    , size_t alignment = alignof(std::max_align_t));
+
+  // Invalidates every allocation and rewinds to the first block.
+  // Already-acquired blocks are kept for reuse, so a steady-state
+  // tick allocates from warm memory and never calls malloc.
+  void reset();
+
+  // Frees every block except the first; use when a one-off spike
+  // should not keep its memory parked forever.
+  void trim();
+
+  // Bytes handed out since construction / last reset().
+  size_t bytesAllocated() const { return bytes_allocated_; }
+
+  // Bytes acquired from the system (kept across reset()).
+  size_t bytesReserved() const { return bytes_reserved_; }
+
+ private:
+  struct Block {
+    Block* next;
+    size_t capacity;
+    size_t used;
+    // Payload follows the header, cache-line aligned.
+  };
+
+  // Payload offset from the block start, rounded up so the payload
+  // stays cache-line aligned.
+  static constexpr size_t blockHeaderSize()
+  {
+    return ((sizeof(Block) + kCacheLineSize - 1) / kCacheLineSize)
+      * kCacheLineSize;
+  }
+
+  // Payload pointer of |block|.
+  static char* payload(Block* block);
+
+  // Acquires a block able to hold |min_capacity| payload bytes and
+  // links it after |current_|.
+  Block* newBlock(size_t min_capacity);
+
+  const size_t block_size_;
+
+  // Singly linked list of every acquired block, in acquisition order;
+  // |current_| is the block being bumped.
+  Block* head_ = nullptr;
+  Block* current_ = nullptr;
+
+  size_t bytes_allocated_ = 0;
+  size_t bytes_reserved_ = 0;
+};
+
+/*
+ * STL-compatible allocator over an Arena.
+ *
+ * With a null arena it degrades to plain operator new/delete, so a
+ * container type can take ArenaAllocator unconditionally and callers
+ * opt into region allocation by passing an arena:
+ *
+ *   std::vector<Job, basis::ArenaAllocator<Job>>
+ *     jobs{basis::ArenaAllocator<Job>(&arena)};
+ *
+ * deallocate() is a no-op for arena-backed memory (reclaimed by
+ * Arena::reset()); the container must not outlive the arena.
+ */
+template <typename T>
+class ArenaAllocator {
+ public:
+  using value_type = T;
+
+  explicit ArenaAllocator(Arena* arena = nullptr) noexcept
+    : arena_(arena)
+  {}
+
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other) noexcept
+    : arena_(other.arena())
+  {}
+
+  T* allocate(size_t n)
+  {
+    if (arena_) {
+      return static_cast<T*>(
+        arena_->allocate(n * sizeof(T), alignof(T)));
+    }
+    return static_cast<T*>(::operator new(n * sizeof(T)));
+  }
+
+  void deallocate(T* ptr, size_t /*n*/) noexcept
+  {
+    if (!arena_) {
+      ::operator delete(ptr);
+    }
+    // Arena memory is reclaimed in bulk by Arena::reset().
+  }
+
+  Arena* arena() const noexcept { return arena_; }
+
+ private:
+  Arena* arena_;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& left
+  , const ArenaAllocator<U>& right) noexcept
+{
+  return left.arena() == right.arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& left
+  , const ArenaAllocator<U>& right) noexcept
+{
+  return !(left == right);
+}
+
+}  // namespace basis
@@ -0,0 +1,107 @@
+#include "Metrics.hpp" // IWYU pragma: associated
+
+#include <base/logging.h> // for DCHECK
+
+namespace basis {
+
+namespace {
+
+/// \note logarithmic bucket index: bucket 0 is sub-microsecond,
+/// bucket N is [2^(N-1), 2^N) microseconds
+size_t bucketIndex(const std::chrono::nanoseconds& sample) noexcept
+{
+  uint64_t us
+    = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+          sample < std::chrono::nanoseconds{0}
+            ? std::chrono::nanoseconds{0}
+            : sample).count());
+  size_t index = 0;
+  while(us && index < LockFreeHistogram::kBucketCount - 1)
+  {
+    us >>= 1;
+    ++index;
+  }
+  return index;
+}
+
+/// \note upper bound of a bucket, used as the pessimistic percentile
+/// answer
+std::chrono::nanoseconds bucketUpperBound(const size_t index) noexcept
+{
+  const uint64_t us = index == 0 ? 1 : (uint64_t{1} << index);
+  return std::chrono::nanoseconds{us * 1000};
+}
+
+} // namespace
+
+void LockFreeHistogram::Snapshot::merge(const Snapshot& other) noexcept
+{
+  for(size_t i = 0; i < kBucketCount; ++i)
+  {
+    buckets[i] += other.buckets[i];
+  }
+  count += other.count;
+}
+
+std::chrono::nanoseconds LockFreeHistogram::Snapshot::percentile(
+  const double fraction) const noexcept
+{
+  DCHECK(fraction >= 0.0 && fraction <= 1.0);
+  if(count == 0)
+  {
+    return std::chrono::nanoseconds{0};
+  }
+  const uint64_t rank
+    = static_cast<uint64_t>(fraction * static_cast<double>(count));
+  uint64_t seen = 0;
+  for(size_t i = 0; i < kBucketCount; ++i)
+  {
+    seen += buckets[i];
+    if(seen > rank || seen >= count)
+    {
+      return bucketUpperBound(i);
+    }
+  }
+  return bucketUpperBound(kBucketCount - 1);
+}
+
+LockFreeHistogram::LockFreeHistogram() noexcept
+{
+  reset();
+}
+
+void LockFreeHistogram::record(
+  const std::chrono::nanoseconds& sample) noexcept
+{
+  buckets_[bucketIndex(sample)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::chrono::nanoseconds LockFreeHistogram::percentile(
+  const double fraction) const noexcept
+{
+  return snapshot().percentile(fraction);
+}
+
+LockFreeHistogram::Snapshot LockFreeHistogram::snapshot() const noexcept
+{
+  Snapshot out;
+  for(size_t i = 0; i < kBucketCount; ++i)
+  {
+    out.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+    out.count += out.buckets[i];
+  }
+  return out;
+}
+
+void LockFreeHistogram::reset() noexcept
+{
+  for(size_t i = 0; i < kBucketCount; ++i)
+  {
+    buckets_[i].store(0, std::memory_order_relaxed);
+  }
+  count_.store(0, std::memory_order_relaxed);
+}
+
+} // namespace basis
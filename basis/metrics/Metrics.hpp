@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace basis {
+
+  /// \brief Lock-free duration histogram with logarithmic buckets.
+  /// \note recording is one relaxed fetch_add on the bucket plus one on
+  /// the running total, so it can stay enabled in production on the hot
+  /// tick path; readers (percentile queries, dumps) race benignly with
+  /// writers and see a slightly stale but consistent-enough snapshot
+  /// \note buckets are powers of two of microseconds, so the relative
+  /// error of a percentile answer is at most 2x, which is plenty to
+  /// tell a 2 ms update from a 20 ms one
+  class LockFreeHistogram
+  {
+  public:
+    /// \note bucket N holds samples in [2^(N-1), 2^N) microseconds;
+    /// bucket 0 holds sub-microsecond samples; 40 buckets cover
+    /// durations up to ~2^39 us (~6 days), far beyond any tick
+    static constexpr size_t kBucketCount = 40;
+
+    /// \brief Plain copy of the bucket counts, taken at one point in
+    /// time (up to benign races with concurrent writers).
+    /// \note snapshots of several histograms — one per loop, per
+    /// thread, per shard — merge() into an aggregate before percentile
+    /// queries, which is how cross-thread statistics are meant to be
+    /// read from this module
+    struct Snapshot
+    {
+      uint64_t buckets[kBucketCount] = {};
+      uint64_t count = 0;
+
+      void merge(const Snapshot& other) noexcept;
+
+      /// \note |fraction| in [0, 1]; returns the upper bound of the
+      /// bucket the percentile falls into (rounds pessimistically)
+      [[nodiscard]] /* don't ignore return value */
+      std::chrono::nanoseconds percentile(const double fraction) const noexcept;
+    };
+
+  public:
+    LockFreeHistogram() noexcept;
+
+    /// \note the recording path: two relaxed atomic increments
+    void record(const std::chrono::nanoseconds& sample) noexcept;
+
+    /// \note large `inline` functions cause Cache misses
+    /// and affect efficiency negatively, so keep it small
+    [[nodiscard]] /* don't ignore return value */
+    inline /* `inline` to eleminate function call overhead */
+    uint64_t count() const noexcept {
+      return count_.load(std::memory_order_relaxed);
+    }
+
+    /// \note |fraction| in [0, 1]: percentile(0.99) answers "99% of
+    /// samples were at or below this"; returns the upper bound of the
+    /// bucket the percentile falls into (i.e. rounds pessimistically)
+    [[nodiscard]] /* don't ignore return value */
+    std::chrono::nanoseconds percentile(const double fraction) const noexcept;
+
+    [[nodiscard]] /* don't ignore return value */
+    Snapshot snapshot() const noexcept;
+
+    void reset() noexcept;
+
+  private:
+    std::atomic<uint64_t> buckets_[kBucketCount];
+
+    std::atomic<uint64_t> count_;
+  };
+
+  /// \brief Monotonic event counter.
+  /// \note recording is one relaxed fetch_add; safe to hit from any
+  /// thread, cheap enough to leave enabled in production
+  class Counter
+  {
+  public:
+    Counter() noexcept : value_{0} {}
+
+    /// \note large `inline` functions cause Cache misses
+    /// and affect efficiency negatively, so keep it small
+    inline /* `inline` to eleminate function call overhead */
+    void increment(const uint64_t delta = 1) noexcept {
+      value_.fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] /* don't ignore return value */
+    inline /* `inline` to eleminate function call overhead */
+    uint64_t value() const noexcept {
+      return value_.load(std::memory_order_relaxed);
+    }
+
+    void reset() noexcept {
+      value_.store(0, std::memory_order_relaxed);
+    }
+
+  private:
+    std::atomic<uint64_t> value_;
+  };
+
+  /// \brief Last-written value plus its high watermark.
+  /// \note for levels rather than events (queue depth, live sessions);
+  /// set() is a relaxed store plus a CAS loop that only spins while
+  /// the maximum is actually being raced upward
+  class Gauge
+  {
+  public:
+    Gauge() noexcept : value_{0}, max_{0} {}
+
+    void set(const int64_t value) noexcept {
+      value_.store(value, std::memory_order_relaxed);
+      int64_t seen_max = max_.load(std::memory_order_relaxed);
+      while(value > seen_max
+            && !max_.compare_exchange_weak(
+                 seen_max, value, std::memory_order_relaxed))
+      {}
+    }
+
+    [[nodiscard]] /* don't ignore return value */
+    inline /* `inline` to eleminate function call overhead */
+    int64_t value() const noexcept {
+      return value_.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] /* don't ignore return value */
+    inline /* `inline` to eleminate function call overhead */
+    int64_t max() const noexcept {
+      return max_.load(std::memory_order_relaxed);
+    }
+
+    void reset() noexcept {
+      value_.store(0, std::memory_order_relaxed);
+      max_.store(0, std::memory_order_relaxed);
+    }
+
+  private:
+    std::atomic<int64_t> value_;
+
+    std::atomic<int64_t> max_;
+  };
+
+} // namespace basis
@@ -0,0 +1,129 @@
+#include "MetricsTraceExporter.hpp" // IWYU pragma: associated
+
+#include <chrono>
+
+#include <base/bind.h>
+#include <base/logging.h> // for DCHECK
+#include <base/trace_event/trace_event.h>
+
+namespace basis {
+
+namespace {
+
+// Counter names live in the entry vectors for the exporter's lifetime,
+// but the trace macros only guarantee literal lifetime, hence the
+// TRACE_COPY_* variants below.
+constexpr char kTraceCategory[] = "metrics";
+
+} // namespace
+
+MetricsTraceExporter::MetricsTraceExporter(const Config& config)
+  : config_{config}
+{
+  DCHECK(config_.sample_interval > base::TimeDelta());
+  DETACH_FROM_SEQUENCE(sequence_checker_);
+}
+
+MetricsTraceExporter::~MetricsTraceExporter()
+{
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+}
+
+void MetricsTraceExporter::watchCounter(
+  const std::string& name
+  , const Counter* counter)
+{
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK(!sample_timer_.IsRunning());
+  DCHECK(counter);
+  CounterEntry entry;
+  entry.name = name;
+  entry.counter = counter;
+  // Start the delta from the current total, so a counter that already
+  // ran up before export does not graph as one giant first sample.
+  entry.last_value = counter->value();
+  counters_.push_back(std::move(entry));
+}
+
+void MetricsTraceExporter::watchGauge(
+  const std::string& name
+  , const Gauge* gauge)
+{
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK(!sample_timer_.IsRunning());
+  DCHECK(gauge);
+  gauges_.push_back(GaugeEntry{name, gauge});
+}
+
+void MetricsTraceExporter::watchHistogram(
+  const std::string& name
+  , const LockFreeHistogram* histogram)
+{
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK(!sample_timer_.IsRunning());
+  DCHECK(histogram);
+  histograms_.push_back(HistogramEntry{name, histogram});
+}
+
+void MetricsTraceExporter::start()
+{
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK(size() > 0);
+  sample_timer_.Start(
+    FROM_HERE
+    , config_.sample_interval
+    , base::BindRepeating(
+        &MetricsTraceExporter::OnSampleTimer, base::Unretained(this)));
+}
+
+void MetricsTraceExporter::stop()
+{
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  sample_timer_.Stop();
+}
+
+void MetricsTraceExporter::OnSampleTimer()
+{
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+
+  for(CounterEntry& entry : counters_)
+  {
+    const uint64_t total = entry.counter->value();
+    /// \note reset() between samples makes the total go backwards;
+    /// clamp to zero rather than wrap
+    const uint64_t delta
+      = total >= entry.last_value ? total - entry.last_value : 0;
+    entry.last_value = total;
+    TRACE_COPY_COUNTER1(kTraceCategory
+      , entry.name.c_str()
+      , static_cast<int>(delta));
+  }
+
+  for(const GaugeEntry& entry : gauges_)
+  {
+    TRACE_COPY_COUNTER2(kTraceCategory
+      , entry.name.c_str()
+      , "value"
+      , static_cast<int>(entry.gauge->value())
+      , "max"
+      , static_cast<int>(entry.gauge->max()));
+  }
+
+  for(const HistogramEntry& entry : histograms_)
+  {
+    /// \note percentiles scan 40 buckets twice per sample - still
+    /// trivially cheap at any sane interval
+    const std::chrono::nanoseconds p50
+      = entry.histogram->percentile(0.5);
+    const std::chrono::nanoseconds p99
+      = entry.histogram->percentile(0.99);
+    TRACE_COPY_COUNTER2(kTraceCategory
+      , entry.name.c_str()
+      , "p50_us"
+      , static_cast<int>(p50.count() / 1000)
+      , "p99_us"
+      , static_cast<int>(p99.count() / 1000));
+  }
+}
+
+} // namespace basis
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "basis/metrics/Metrics.hpp"
+
+#include <string>
+#include <vector>
+
+#include <base/macros.h>
+#include <base/sequence_checker.h>
+#include <base/time/time.h>
+#include <base/timer/timer.h>
+
+namespace basis {
+
+  /// \brief Periodically samples registered Counters, Gauges and
+  /// LockFreeHistograms and emits them as TRACE_COUNTER events through
+  /// the tracing machinery set up by basis::initTracing, so queue
+  /// depths, tick times and pool latencies appear on the same
+  /// chrome://tracing timeline as the trace events around them.
+  /// \note sampling is pull-based from this one repeating task; the
+  /// instrumented hot paths keep paying only their relaxed atomic
+  /// increments, nothing extra per event
+  /// \note what each metric kind graphs as:
+  ///  - Counter: events per interval (the delta since the previous
+  ///    sample), because the raw monotonic total graphs as a ramp
+  ///  - Gauge: current value and high watermark
+  ///  - LockFreeHistogram: p50 and p99 in microseconds
+  /// \note counters are emitted under the "metrics" trace category;
+  /// include it in the category list passed to initTracing (or the
+  /// flight recorder) or the samples are dropped at the macro
+  /// \code
+  ///   basis::MetricsTraceExporter exporter(
+  ///     basis::MetricsTraceExporter::Config{});
+  ///   exporter.watchCounter("frames_dropped", &frames_dropped);
+  ///   exporter.watchGauge("net_queue_depth", &net_queue_depth);
+  ///   exporter.watchHistogram("tick_time", &tick_histogram);
+  ///   exporter.start(); // on the sequence that owns the exporter
+  /// \endcode
+  class MetricsTraceExporter
+  {
+  public:
+    struct Config
+    {
+      /// \note one pass over the registered metrics per interval; each
+      /// sample is a handful of relaxed loads (plus a bucket scan per
+      /// histogram), so even sub-second intervals stay in the noise
+      base::TimeDelta sample_interval
+        = base::TimeDelta::FromMilliseconds(250);
+    };
+
+  public:
+    explicit MetricsTraceExporter(const Config& config);
+
+    ~MetricsTraceExporter();
+
+    /// \note metrics are non-owned and must outlive the exporter (they
+    /// are typically static or live in a long-lived owner anyway);
+    /// register before start()
+    void watchCounter(
+      const std::string& name
+      , const Counter* counter);
+
+    void watchGauge(
+      const std::string& name
+      , const Gauge* gauge);
+
+    void watchHistogram(
+      const std::string& name
+      , const LockFreeHistogram* histogram);
+
+    /// \note starts the repeating sample timer on the calling sequence;
+    /// all other methods must be called on it too
+    void start();
+
+    void stop();
+
+    /// \note large `inline` functions cause Cache misses
+    /// and affect efficiency negatively, so keep it small
+    [[nodiscard]] /* don't ignore return value */
+    inline /* `inline` to eleminate function call overhead */
+    size_t size() const noexcept {
+      return counters_.size() + gauges_.size() + histograms_.size();
+    }
+
+  private:
+    struct CounterEntry
+    {
+      std::string name;
+      const Counter* counter;
+      /// \note previous sample's total, for the per-interval delta
+      uint64_t last_value = 0;
+    };
+
+    struct GaugeEntry
+    {
+      std::string name;
+      const Gauge* gauge;
+    };
+
+    struct HistogramEntry
+    {
+      std::string name;
+      const LockFreeHistogram* histogram;
+    };
+
+    /// \note one timer tick: samples every registered metric and emits
+    /// the TRACE_COUNTER events
+    void OnSampleTimer();
+
+    const Config config_;
+
+    std::vector<CounterEntry> counters_;
+
+    std::vector<GaugeEntry> gauges_;
+
+    std::vector<HistogramEntry> histograms_;
+
+    base::RepeatingTimer sample_timer_;
+
+    SEQUENCE_CHECKER(sequence_checker_);
+
+    DISALLOW_COPY_AND_ASSIGN(MetricsTraceExporter);
+  };
+
+} // namespace basis
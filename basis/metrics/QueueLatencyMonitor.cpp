@@ -0,0 +1,149 @@
+#include "QueueLatencyMonitor.hpp" // IWYU pragma: associated
+
+#include <utility>
+
+#include <base/bind.h>
+#include <base/logging.h> // for DCHECK
+#include <base/task/post_task.h>
+
+namespace basis {
+
+QueueLatencyMonitor::ProbeTarget::ProbeTarget(
+  const std::string& name
+  , const base::TaskTraits& traits
+  , scoped_refptr<base::SequencedTaskRunner> task_runner)
+  : name{name}
+    , traits{traits}
+    , task_runner{std::move(task_runner)}
+{}
+
+QueueLatencyMonitor::ProbeTarget::~ProbeTarget() = default;
+
+QueueLatencyMonitor::QueueLatencyMonitor(const Config& config)
+  : config_{config}
+{
+  DCHECK(config_.probe_interval > base::TimeDelta());
+  DCHECK(config_.alarm_threshold > base::TimeDelta());
+  DETACH_FROM_SEQUENCE(sequence_checker_);
+}
+
+QueueLatencyMonitor::~QueueLatencyMonitor()
+{
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+}
+
+QueueLatencyMonitor::TargetId QueueLatencyMonitor::watchPool(
+  const std::string& name
+  , const base::TaskTraits& traits)
+{
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK(!probe_timer_.IsRunning());
+  targets_.push_back(
+    base::MakeRefCounted<ProbeTarget>(name, traits, nullptr));
+  return targets_.size() - 1;
+}
+
+QueueLatencyMonitor::TargetId QueueLatencyMonitor::watchSequence(
+  const std::string& name
+  , scoped_refptr<base::SequencedTaskRunner> task_runner)
+{
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK(!probe_timer_.IsRunning());
+  DCHECK(task_runner);
+  targets_.push_back(
+    base::MakeRefCounted<ProbeTarget>(
+      name, base::TaskTraits{}, std::move(task_runner)));
+  return targets_.size() - 1;
+}
+
+void QueueLatencyMonitor::setAlarmCallback(AlarmCallback alarmCallback)
+{
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  alarm_callback_ = std::move(alarmCallback);
+}
+
+void QueueLatencyMonitor::start()
+{
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK(!targets_.empty());
+  probe_timer_.Start(
+    FROM_HERE
+    , config_.probe_interval
+    , base::BindRepeating(
+        &QueueLatencyMonitor::OnProbeTimer, base::Unretained(this)));
+}
+
+void QueueLatencyMonitor::stop()
+{
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  probe_timer_.Stop();
+}
+
+std::chrono::nanoseconds QueueLatencyMonitor::p99(
+  const TargetId id) const noexcept
+{
+  DCHECK(id < targets_.size());
+  return targets_[id]->histogram.percentile(0.99);
+}
+
+LockFreeHistogram::Snapshot QueueLatencyMonitor::snapshotOf(
+  const TargetId id) const noexcept
+{
+  DCHECK(id < targets_.size());
+  return targets_[id]->histogram.snapshot();
+}
+
+// static
+void QueueLatencyMonitor::RecordProbe(
+  scoped_refptr<ProbeTarget> target
+  , base::TimeTicks posted)
+{
+  const base::TimeDelta queued = base::TimeTicks::Now() - posted;
+  target->histogram.record(
+    std::chrono::nanoseconds{queued.InNanoseconds()});
+}
+
+void QueueLatencyMonitor::OnProbeTimer()
+{
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+
+  /// \note alarms are evaluated before this interval's probes are
+  /// posted, on the samples that already ran; a probe still stuck in
+  /// a queue cannot be counted yet, which only makes the alarm late
+  /// by one interval, never early
+  for(const scoped_refptr<ProbeTarget>& target : targets_)
+  {
+    if(!alarm_callback_
+       || target->histogram.count() < config_.min_samples_for_alarm)
+    {
+      continue;
+    }
+    const std::chrono::nanoseconds p99_delay
+      = target->histogram.percentile(0.99);
+    if(p99_delay
+       > std::chrono::nanoseconds{config_.alarm_threshold.InNanoseconds()})
+    {
+      alarm_callback_.Run(target->name, p99_delay);
+    }
+  }
+
+  const base::TimeTicks now = base::TimeTicks::Now();
+  for(const scoped_refptr<ProbeTarget>& target : targets_)
+  {
+    if(target->task_runner)
+    {
+      target->task_runner->PostTask(
+        FROM_HERE
+        , base::BindOnce(&QueueLatencyMonitor::RecordProbe, target, now));
+    }
+    else
+    {
+      base::PostTask(
+        FROM_HERE
+        , target->traits
+        , base::BindOnce(&QueueLatencyMonitor::RecordProbe, target, now));
+    }
+  }
+}
+
+} // namespace basis
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "basis/metrics/Metrics.hpp"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <base/callback.h>
+#include <base/macros.h>
+#include <base/memory/ref_counted.h>
+#include <base/memory/scoped_refptr.h>
+#include <base/sequence_checker.h>
+#include <base/sequenced_task_runner.h>
+#include <base/task/task_traits.h>
+#include <base/time/time.h>
+#include <base/timer/timer.h>
+
+namespace basis {
+
+  /// \brief Measures how long tasks sit in base::ThreadPool queues (and
+  /// selected sequences) before running, by periodically posting
+  /// timestamp probes and recording the post-to-run deltas into
+  /// LockFreeHistograms.
+  /// \note queueing delay is invisible until user-visible latency
+  /// degrades; a probe per target per interval is cheap (one posted
+  /// no-op task plus two relaxed increments on run) and turns "the
+  /// server feels slow" into "foreground pool queueing p99 is 40 ms"
+  /// \note probes measure the same queues real tasks wait in, so a
+  /// BEST_EFFORT probe legitimately waiting behind foreground work is
+  /// the signal, not noise
+  /// \code
+  ///   basis::QueueLatencyMonitor::Config config;
+  ///   config.alarm_threshold = base::TimeDelta::FromMilliseconds(20);
+  ///   basis::QueueLatencyMonitor monitor(config);
+  ///   const size_t foreground = monitor.watchPool(
+  ///     "foreground"
+  ///     , {base::ThreadPool(), base::TaskPriority::USER_BLOCKING});
+  ///   monitor.watchSequence("fixed_loop", fixedLoopTaskRunner);
+  ///   monitor.setAlarmCallback(base::BindRepeating(&onQueueingAlarm));
+  ///   monitor.start(); // on the sequence that owns the monitor
+  ///   ...
+  ///   LOG(INFO) << monitor.p99(foreground).count() << " ns";
+  /// \endcode
+  class QueueLatencyMonitor
+  {
+  public:
+    struct Config
+    {
+      /// \note one probe per target per interval; the default keeps
+      /// the monitor far below the noise floor of any real workload
+      base::TimeDelta probe_interval
+        = base::TimeDelta::FromSeconds(1);
+
+      /// \note the alarm fires while a target's p99 queueing delay
+      /// exceeds this
+      base::TimeDelta alarm_threshold
+        = base::TimeDelta::FromMilliseconds(20);
+
+      /// \note p99 of a handful of samples is meaningless; no alarm
+      /// before a target collected this many
+      uint64_t min_samples_for_alarm = 32;
+    };
+
+    /// \note runs on the monitor's own sequence, once per probe
+    /// interval per target that is over the threshold
+    using AlarmCallback
+      = base::RepeatingCallback<
+          void(const std::string& target_name
+               , std::chrono::nanoseconds p99)>;
+
+    using TargetId = size_t;
+
+  public:
+    explicit QueueLatencyMonitor(const Config& config);
+
+    ~QueueLatencyMonitor();
+
+    /// \note watch one priority band of the thread pool (the pools
+    /// configured by initThreadPool map to task priorities); register
+    /// targets before start()
+    [[nodiscard]] /* don't ignore return value */
+    TargetId watchPool(
+      const std::string& name
+      , const base::TaskTraits& traits);
+
+    /// \note watch one sequence (e.g. an AppRunners task runner);
+    /// measures how long the sequence's queue holds a newly posted task
+    [[nodiscard]] /* don't ignore return value */
+    TargetId watchSequence(
+      const std::string& name
+      , scoped_refptr<base::SequencedTaskRunner> task_runner);
+
+    void setAlarmCallback(AlarmCallback alarmCallback);
+
+    /// \note starts the repeating probe timer on the calling sequence;
+    /// all other non-const methods must be called on it too
+    void start();
+
+    void stop();
+
+    /// \note current p99 queueing delay of one target; readable from
+    /// any thread (histogram reads race benignly with probe recording)
+    [[nodiscard]] /* don't ignore return value */
+    std::chrono::nanoseconds p99(const TargetId id) const noexcept;
+
+    /// \note full histogram snapshot for dashboards; merge() snapshots
+    /// of several monitors per the Metrics module convention
+    [[nodiscard]] /* don't ignore return value */
+    LockFreeHistogram::Snapshot snapshotOf(const TargetId id) const noexcept;
+
+    /// \note large `inline` functions cause Cache misses
+    /// and affect efficiency negatively, so keep it small
+    [[nodiscard]] /* don't ignore return value */
+    inline /* `inline` to eleminate function call overhead */
+    size_t size() const noexcept {
+      return targets_.size();
+    }
+
+  private:
+    /// \note refcounted because in-flight probes hold the histogram
+    /// past stop() (a probe stuck in a saturated queue is exactly the
+    /// sample we must not lose or crash on)
+    struct ProbeTarget
+      : public base::RefCountedThreadSafe<ProbeTarget>
+    {
+      ProbeTarget(
+        const std::string& name
+        , const base::TaskTraits& traits
+        , scoped_refptr<base::SequencedTaskRunner> task_runner);
+
+      const std::string name;
+
+      /// \note used when |task_runner| is null: probe goes to the pool
+      const base::TaskTraits traits;
+
+      /// \note non-null for sequence targets
+      const scoped_refptr<base::SequencedTaskRunner> task_runner;
+
+      LockFreeHistogram histogram;
+
+     private:
+      friend class base::RefCountedThreadSafe<ProbeTarget>;
+      ~ProbeTarget();
+
+      DISALLOW_COPY_AND_ASSIGN(ProbeTarget);
+    };
+
+    /// \note runs where the probe was queued to; records post-to-run
+    static void RecordProbe(
+      scoped_refptr<ProbeTarget> target
+      , base::TimeTicks posted);
+
+    /// \note one timer tick: posts a probe per target, then checks
+    /// alarms against the previous samples
+    void OnProbeTimer();
+
+    const Config config_;
+
+    std::vector<scoped_refptr<ProbeTarget>> targets_;
+
+    AlarmCallback alarm_callback_;
+
+    base::RepeatingTimer probe_timer_;
+
+    SEQUENCE_CHECKER(sequence_checker_);
+
+    DISALLOW_COPY_AND_ASSIGN(QueueLatencyMonitor);
+  };
+
+} // namespace basis
@@ -17,8 +17,15 @@
 // value, and the value may be updated at any time from any thread by calling
 // SetValue(). You can also get the value using GetValue(); but note that this
 // is not threadsafe (the value is returned without locking), so the caller must
-// ensure safety by other means. Calling GetValueThreadSafe() is threadsafe but
-// involves a mutex lock.
+// ensure safety by other means. Calling GetValueThreadSafe() is threadsafe and
+// lock-free: it copies out of an immutable snapshot that SetValue() replaces
+// wholesale (RCU-style). For large values, GetSnapshot() returns a
+// shared_ptr to that snapshot without copying the value at all.
+// When T is trivially copyable, the snapshot is backed by a seqlock instead
+// (selected automatically): SetValue() publishes with two counter increments
+// plus a raw copy (no allocation) and GetValueThreadSafe() retry-loops on the
+// counter, so small high-rate values (telemetry structs updated at kHz rates)
+// cost readers and writer nothing but the copies themselves.
 //
 // Code that wants to observe the value calls Observe() on it at any point when
 // the value is alive. Note that Observe() may be called safely from any thread.
@@ -35,7 +42,10 @@
 // that constructed the Observer). Note that Observers are always updated
 // asynchronously with PostTask(), even if they belong to the same thread that
 // calls SetValue(). All Observers on the same thread have the same consistent
-// view of the observed value.
+// view of the observed value. Observer sequences share one immutable snapshot
+// per update rather than each holding a deep copy, so fanning an update out to
+// N observing sequences costs N refcount bumps, not N copies of T; SetValue()
+// also takes rvalues, letting callers move vector-heavy values in.
 //
 // Observers may be copied freely; the copy also observes the original
 // Observable, and belongs to the thread that created the copy. Copying is safe
@@ -101,7 +111,10 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <atomic>
+#include <cstring>
 #include <memory>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -138,9 +151,12 @@ class Observer {
     on_update_callback_ = std::move(callback);
   }
 
+  // The returned reference is valid until the next update is applied on
+  // this sequence (updates repoint the sequence's shared snapshot); copy
+  // the value out before running a message loop.
   const T& GetValue() const {
     DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
-    return value_;
+    return *value_;
   }
 
  private:
@@ -152,15 +168,31 @@ class Observer {
   void OnUpdate();
 
   const scoped_refptr<subtle::ObservableInternals<T>> internals_;
-  // Note: value_ is a const ref to the value copy for this sequence, stored in
-  // SequenceOwnedInfo.
-  const T& value_;
+  // Note: value_ refers to the snapshot pointer for this sequence, stored
+  // in SequenceOwnedInfo (the pointer cell is heap-stable; the snapshot it
+  // designates is shared by every sequence seeing the same update).
+  const std::shared_ptr<const T>& value_;
   base::RepeatingClosure on_update_callback_;
   SEQUENCE_CHECKER(sequence_checker_);
 
   DISALLOW_ASSIGN(Observer);
 };
 
+// How SetValue() propagates to observer sequences.
+enum class ObservableUpdatePolicy {
+  // One posted task per observer sequence per SetValue() call; every
+  // intermediate value is delivered (original behavior).
+  kEager,
+  // At most one pending task per observer sequence at any time; rapid
+  // successive SetValue() calls collapse and the task delivers whatever
+  // value is latest when it runs. Use for high-rate values (telemetry at
+  // 1 kHz etc.) where observers only care about the current value: N
+  // updates x M sequences costs at most M posts instead of N x M.
+  // Updates are version-stamped, so an observer sequence never applies a
+  // value older than one it has already seen.
+  kCoalesce,
+};
+
 template <typename T>
 class Observable {
   static_assert(std::is_copy_constructible<T>::value,
@@ -169,12 +201,19 @@ class Observable {
                 "Observable values must be copy-assignable");
 
  public:
-  explicit Observable(const T& initial_value);
+  explicit Observable(
+      const T& initial_value,
+      ObservableUpdatePolicy update_policy = ObservableUpdatePolicy::kEager);
   Observer<T> Observe();
 
   void SetValue(const T& new_value);
+  // Move flavor for vector-heavy values: the observable takes the value
+  // without a deep copy.
+  void SetValue(T&& new_value);
   const T& GetValue() const;  // NOT threadsafe!
   T GetValueThreadSafe() const;
+  // Threadsafe and lock-free; avoids copying T (see file comment).
+  std::shared_ptr<const T> GetSnapshot() const;
 
  private:
   // By using a refcounted object to store the value and observer list, we can
@@ -186,30 +225,155 @@ class Observable {
 
 namespace subtle {
 
+// Storage behind GetValueThreadSafe() / GetSnapshot(). The defaulted
+// second parameter picks the seqlock variant below for trivially
+// copyable T automatically.
+//
+// Generic variant: RCU-style immutable snapshot, replaced wholesale on
+// every publish (one allocation per SetValue()) and handed out by
+// shared_ptr, so a grabbed snapshot stays valid across updates.
+template <typename T,
+          bool IsTriviallyCopyable = std::is_trivially_copyable<T>::value>
+class SharedValueStore {
+ public:
+  // What Publish() needs prepared ahead of time; built by the caller
+  // outside its lock, since staging allocates here.
+  using Staged = std::shared_ptr<const T>;
+
+  explicit SharedValueStore(const T& initial_value)
+      : snapshot_(std::make_shared<const T>(initial_value)) {}
+
+  Staged Stage(const T& new_value) const {
+    return std::make_shared<const T>(new_value);
+  }
+
+  // Publish() calls must be externally serialized (the observable's
+  // lock does this); concurrent Load()/GetSnapshot() are fine.
+  void Publish(Staged staged, const T& /* new_value */) {
+    std::atomic_store_explicit(&snapshot_, std::move(staged),
+                               std::memory_order_release);
+  }
+
+  T Load() const { return *GetSnapshot(); }
+
+  // Grabs the current immutable snapshot without copying the value;
+  // it stays valid even if a publish replaces it concurrently.
+  std::shared_ptr<const T> GetSnapshot() const {
+    return std::atomic_load_explicit(&snapshot_, std::memory_order_acquire);
+  }
+
+ private:
+  std::shared_ptr<const T> snapshot_;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedValueStore);
+};
+
+// Seqlock variant for trivially copyable T (small telemetry structs
+// updated at high rate): Publish() is two counter increments plus a
+// raw word copy — wait-free, no allocation — and Load() optimistically
+// copies the words, retrying while the counter says a publish is in
+// progress (odd) or happened in between (changed). Readers write no
+// shared state at all — the generic variant's shared_ptr loads bounce
+// the refcount cache line between reading cores — so reads scale.
+// Fence placement follows Boehm, "Can seqlocks get along with
+// programming language memory models?".
 template <typename T>
-class ObservableInternals
-    : public base::RefCountedThreadSafe<ObservableInternals<T>> {
+class SharedValueStore<T, true> {
  public:
-  explicit ObservableInternals(const T& initial_value)
-      : value_(initial_value) {}
+  // Nothing to prepare; publishing never allocates.
+  struct Staged {};
 
-  void SetValue(const T& new_value) {
-    base::AutoLock lock(lock_);
-    value_ = new_value;
+  explicit SharedValueStore(const T& initial_value) {
+    StoreWords(initial_value);
+  }
 
-    for (auto& item : per_sequence_) {
-      item.SetValue(new_value);
+  Staged Stage(const T& /* new_value */) const { return Staged(); }
+
+  // Publish() calls must be externally serialized (the observable's
+  // lock does this); concurrent Load()/GetSnapshot() are fine.
+  void Publish(Staged /* staged */, const T& new_value) {
+    const uint64_t seq = seq_.load(std::memory_order_relaxed);
+    // Odd = publish in progress; readers that overlap it retry.
+    seq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    StoreWords(new_value);
+    seq_.store(seq + 2, std::memory_order_release);
+  }
+
+  T Load() const {
+    uint64_t words[kWordCount];
+    for (;;) {
+      const uint64_t seq_before = seq_.load(std::memory_order_acquire);
+      if (seq_before & 1) {
+        continue;
+      }
+      for (size_t i = 0; i < kWordCount; ++i) {
+        words[i] = words_[i].load(std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (seq_.load(std::memory_order_relaxed) == seq_before) {
+        break;
+      }
     }
+    // T need not be default-constructible; materialize the copy from
+    // raw storage (fine for trivially copyable types).
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type buffer;
+    std::memcpy(&buffer, words, sizeof(T));
+    return *reinterpret_cast<const T*>(&buffer);
+  }
+
+  // Kept for API parity with the generic variant. A "snapshot" of a
+  // trivially copyable value is just a copy; this is the one path here
+  // that allocates, so prefer Load().
+  std::shared_ptr<const T> GetSnapshot() const {
+    return std::make_shared<const T>(Load());
   }
 
+ private:
+  static constexpr size_t kWordCount =
+      (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+  void StoreWords(const T& value) {
+    uint64_t words[kWordCount] = {};
+    std::memcpy(words, &value, sizeof(T));
+    for (size_t i = 0; i < kWordCount; ++i) {
+      words_[i].store(words[i], std::memory_order_relaxed);
+    }
+  }
+
+  std::atomic<uint64_t> seq_{0};
+  std::atomic<uint64_t> words_[kWordCount];
+
+  DISALLOW_COPY_AND_ASSIGN(SharedValueStore);
+};
+
+template <typename T>
+class ObservableInternals
+    : public base::RefCountedThreadSafe<ObservableInternals<T>> {
+ public:
+  ObservableInternals(const T& initial_value,
+                      ObservableUpdatePolicy update_policy)
+      : update_policy_(update_policy),
+        value_(initial_value),
+        snapshot_(initial_value) {}
+
+  void SetValue(const T& new_value) { DoSetValue(new_value); }
+  void SetValue(T&& new_value) { DoSetValue(std::move(new_value)); }
+
   const T& GetValue() const { return value_; }
 
-  T GetValueThreadSafe() const {
-    base::AutoLock lock(lock_);
-    return value_;
+  T GetValueThreadSafe() const { return snapshot_.Load(); }
+
+  // Reads without touching |lock_| (see SharedValueStore), so
+  // read-mostly workloads (config read per request, written once an
+  // hour) and high-rate pollers never contend with the writer. The
+  // returned value stays valid even if SetValue() publishes
+  // concurrently.
+  std::shared_ptr<const T> GetSnapshot() const {
+    return snapshot_.GetSnapshot();
   }
 
-  const T& AddObserver(Observer<T>* observer) {
+  const std::shared_ptr<const T>& AddObserver(Observer<T>* observer) {
     DCHECK(observer);
     DCHECK(base::SequencedTaskRunnerHandle::IsSet());
     auto task_runner = base::SequencedTaskRunnerHandle::Get();
@@ -220,7 +384,10 @@ class ObservableInternals
       ++it;
     }
     if (it == per_sequence_.end()) {
-      per_sequence_.emplace_back(std::move(task_runner), value_);
+      // New sequences start from the current snapshot (shared, not
+      // copied, for the generic store).
+      per_sequence_.emplace_back(std::move(task_runner),
+                                 snapshot_.GetSnapshot());
       it = --per_sequence_.end();
     }
     it->AddObserver(observer);
@@ -249,6 +416,37 @@ class ObservableInternals
   }
 
  private:
+  template <typename U>
+  void DoSetValue(U&& new_value) {
+    // Staged outside the lock, since staging is where the generic
+    // store allocates; only the publish below needs the lock.
+    auto staged = snapshot_.Stage(new_value);
+
+    base::AutoLock lock(lock_);
+    value_ = std::forward<U>(new_value);
+    snapshot_.Publish(std::move(staged), value_);
+    ++version_;
+
+    if (per_sequence_.empty()) {
+      return;
+    }
+
+    if (update_policy_ == ObservableUpdatePolicy::kCoalesce) {
+      for (auto& item : per_sequence_) {
+        item.PostCoalescedUpdate(this);
+      }
+      return;
+    }
+
+    // Every sequence shares one immutable snapshot of this update (for
+    // the generic store it is the very object Publish() installed, so
+    // the fan-out is refcount bumps, not copies of T).
+    std::shared_ptr<const T> shared_value = snapshot_.GetSnapshot();
+    for (auto& item : per_sequence_) {
+      item.SetValue(shared_value);
+    }
+  }
+
   // Information owned by a particular sequence. Must be only accessed on that
   // sequence, and must be deleted by posting a task to that sequence.
   // This class MUST NOT contain a scoped_refptr to the task_runner, since if it
@@ -256,9 +454,13 @@ class ObservableInternals
   // Destroy() is posted.
   class SequenceOwnedInfo {
    public:
-    explicit SequenceOwnedInfo(const T& value) : value_(value) {}
+    explicit SequenceOwnedInfo(std::shared_ptr<const T> value)
+        : value_(std::move(value)) {}
 
-    const T& value() const {
+    // Returns a reference to this sequence's snapshot pointer; the cell
+    // is stable for the lifetime of the SequenceOwnedInfo (Observers
+    // keep a reference to it, see Observer::value_).
+    const std::shared_ptr<const T>& value() const {
       DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
       return value_;
     }
@@ -284,21 +486,48 @@ class ObservableInternals
       return observers_.empty();
     }
 
-    void SetValue(const T& value) {
+    void SetValue(std::shared_ptr<const T> value) {
       DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
-      value_ = value;
+      value_ = std::move(value);
       for (auto* obs : observers_) {
         obs->OnUpdate();
       }
     }
 
+    // Coalesced delivery (see ObservableUpdatePolicy::kCoalesce): reads
+    // whatever value is latest at run time and clears the pending mark,
+    // so the next SetValue() posts again. Clearing under the same lock as
+    // the value read guarantees no update is lost: any SetValue() after
+    // the read observes |pending| == false and posts a new task.
+    void DeliverCoalescedUpdate(scoped_refptr<ObservableInternals> internals,
+                                std::shared_ptr<bool> pending) {
+      DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+      std::shared_ptr<const T> value;
+      uint64_t version;
+      {
+        base::AutoLock lock(internals->lock_);
+        value = internals->snapshot_.GetSnapshot();
+        version = internals->version_;
+        *pending = false;
+      }
+      if (version <= last_applied_version_) {
+        // Already applied by a delivery that read a newer snapshot.
+        return;
+      }
+      last_applied_version_ = version;
+      SetValue(std::move(value));
+    }
+
     static void Destroy(std::unique_ptr<SequenceOwnedInfo> self) {
       // The unique_ptr deletes automatically.
     }
 
    private:
     std::vector<Observer<T>*> observers_;
-    T value_;
+    // Shared with other sequences that saw the same update; the pointer
+    // cell itself is only touched on this sequence.
+    std::shared_ptr<const T> value_;
+    uint64_t last_applied_version_ = 0;
     SEQUENCE_CHECKER(sequence_checker_);
 
     DISALLOW_COPY_AND_ASSIGN(SequenceOwnedInfo);
@@ -307,9 +536,10 @@ class ObservableInternals
   class PerSequenceInfo {
    public:
     PerSequenceInfo(scoped_refptr<base::SequencedTaskRunner> task_runner,
-                    const T& value)
+                    std::shared_ptr<const T> value)
         : task_runner_(std::move(task_runner)),
-          owned_info_(std::make_unique<SequenceOwnedInfo>(value)) {}
+          owned_info_(
+              std::make_unique<SequenceOwnedInfo>(std::move(value))) {}
 
     PerSequenceInfo(PerSequenceInfo&& other) = default;
 
@@ -329,7 +559,9 @@ class ObservableInternals
           base::BindOnce(&SequenceOwnedInfo::Destroy, std::move(owned_info_)));
     }
 
-    const T& value() const { return owned_info_->value(); }
+    const std::shared_ptr<const T>& value() const {
+      return owned_info_->value();
+    }
 
     const base::SequencedTaskRunner* task_runner() const {
       return task_runner_.get();
@@ -348,13 +580,30 @@ class ObservableInternals
     void Swap(PerSequenceInfo& other) {
       std::swap(task_runner_, other.task_runner_);
       std::swap(owned_info_, other.owned_info_);
+      std::swap(update_pending_, other.update_pending_);
     }
 
-    void SetValue(const T& value) {
+    void SetValue(std::shared_ptr<const T> value) {
       task_runner_->PostTask(
           FROM_HERE,
           base::BindOnce(&SequenceOwnedInfo::SetValue,
-                         base::Unretained(owned_info_.get()), value));
+                         base::Unretained(owned_info_.get()),
+                         std::move(value)));
+    }
+
+    // Must be called with the internals lock held (like SetValue); posts
+    // only when no delivery is already pending for this sequence.
+    void PostCoalescedUpdate(ObservableInternals* internals) {
+      if (*update_pending_) {
+        // The pending task will pick up the value just written.
+        return;
+      }
+      *update_pending_ = true;
+      task_runner_->PostTask(
+          FROM_HERE,
+          base::BindOnce(&SequenceOwnedInfo::DeliverCoalescedUpdate,
+                         base::Unretained(owned_info_.get()),
+                         base::WrapRefCounted(internals), update_pending_));
     }
 
    private:
@@ -362,13 +611,25 @@ class ObservableInternals
     // since all operations must occur on |task_runner|.
     scoped_refptr<base::SequencedTaskRunner> task_runner_;
     std::unique_ptr<SequenceOwnedInfo> owned_info_;
+    // True while a coalesced delivery is posted but has not yet read the
+    // value. Guarded by the internals lock; shared with the posted task
+    // since |this| may move inside |per_sequence_|.
+    std::shared_ptr<bool> update_pending_ = std::make_shared<bool>(false);
   };
 
   friend class base::RefCountedThreadSafe<ObservableInternals>;
   ~ObservableInternals() {}
 
   mutable base::Lock lock_;
+  const ObservableUpdatePolicy update_policy_;
   T value_;
+  // Publication channel for GetValueThreadSafe()/GetSnapshot(), read
+  // without |lock_|: an RCU-style immutable snapshot for general T, a
+  // seqlock for trivially copyable T (see SharedValueStore).
+  SharedValueStore<T> snapshot_;
+  // Incremented under |lock_| on every SetValue(); stamps coalesced
+  // deliveries so stale snapshots are never applied over newer ones.
+  uint64_t version_ = 0;
   std::vector<PerSequenceInfo> per_sequence_;
 
   DISALLOW_COPY_AND_ASSIGN(ObservableInternals);
@@ -398,9 +659,10 @@ void Observer<T>::OnUpdate() {
 }
 
 template <typename T>
-Observable<T>::Observable(const T& initial_value)
+Observable<T>::Observable(const T& initial_value,
+                          ObservableUpdatePolicy update_policy)
     : internals_(base::WrapRefCounted(
-          new subtle::ObservableInternals<T>(initial_value))) {}
+          new subtle::ObservableInternals<T>(initial_value, update_policy))) {}
 
 template <typename T>
 Observer<T> Observable<T>::Observe() {
@@ -412,6 +674,11 @@ void Observable<T>::SetValue(const T& new_value) {
   internals_->SetValue(new_value);
 }
 
+template <typename T>
+void Observable<T>::SetValue(T&& new_value) {
+  internals_->SetValue(std::move(new_value));
+}
+
 template <typename T>
 const T& Observable<T>::GetValue() const {
   return internals_->GetValue();
@@ -422,6 +689,11 @@ T Observable<T>::GetValueThreadSafe() const {
   return internals_->GetValueThreadSafe();
 }
 
+template <typename T>
+std::shared_ptr<const T> Observable<T>::GetSnapshot() const {
+  return internals_->GetSnapshot();
+}
+
 }  // namespace chromecast
 
 #endif  // CHROMECAST_BASE_OBSERVER_H_
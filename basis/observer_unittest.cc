@@ -123,6 +123,129 @@ TEST_F(ObserverTest, SimpleValue) {
   EXPECT_EQ(1, observer.GetValue());
 }
 
+TEST_F(ObserverTest, SnapshotOutlivesUpdates) {
+  Observable<int> original(1);
+
+  std::shared_ptr<const int> snapshot = original.GetSnapshot();
+  EXPECT_EQ(1, *snapshot);
+  EXPECT_EQ(1, original.GetValueThreadSafe());
+
+  // A grabbed snapshot is immutable; new reads see the new value.
+  original.SetValue(2);
+  EXPECT_EQ(1, *snapshot);
+  EXPECT_EQ(2, *original.GetSnapshot());
+  EXPECT_EQ(2, original.GetValueThreadSafe());
+}
+
+struct Telemetry {
+  uint64_t frame = 0;
+  float cpu_load = 0.0f;
+  float mem_load = 0.0f;
+};
+static_assert(std::is_trivially_copyable<Telemetry>::value,
+              "Telemetry must take the seqlock specialization");
+
+TEST_F(ObserverTest, SeqlockValueForTriviallyCopyable) {
+  Observable<Telemetry> original((Telemetry()));
+  EXPECT_EQ(0u, original.GetValueThreadSafe().frame);
+
+  Telemetry telemetry;
+  telemetry.frame = 7;
+  telemetry.cpu_load = 0.5f;
+  original.SetValue(telemetry);
+  EXPECT_EQ(7u, original.GetValueThreadSafe().frame);
+  EXPECT_EQ(0.5f, original.GetValueThreadSafe().cpu_load);
+  EXPECT_EQ(7u, original.GetSnapshot()->frame);
+
+  // Observer delivery is unchanged by the storage specialization.
+  Observer<Telemetry> observer = original.Observe();
+  telemetry.frame = 8;
+  original.SetValue(telemetry);
+  base::RunLoop().RunUntilIdle();
+  EXPECT_EQ(8u, observer.GetValue().frame);
+}
+
+struct SeqlockPair {
+  uint64_t a = 0;
+  // Writers always keep |b| == ~|a|; a torn read breaks the invariant.
+  uint64_t b = ~0ull;
+};
+
+TEST_F(ObserverTest, SeqlockReadsNeverTear) {
+  Observable<SeqlockPair> original((SeqlockPair()));
+
+  base::WaitableEvent stop(base::WaitableEvent::ResetPolicy::MANUAL,
+                           base::WaitableEvent::InitialState::NOT_SIGNALED);
+  base::Thread writer("SeqlockWriter");
+  writer.Start();
+  writer.task_runner()->PostTask(
+      FROM_HERE,
+      base::BindOnce(
+          [](Observable<SeqlockPair>* observable, base::WaitableEvent* stop) {
+            uint64_t i = 0;
+            while (!stop->IsSignaled()) {
+              SeqlockPair pair;
+              pair.a = ++i;
+              pair.b = ~pair.a;
+              observable->SetValue(pair);
+            }
+          },
+          base::Unretained(&original), base::Unretained(&stop)));
+
+  for (int i = 0; i < 10000; ++i) {
+    SeqlockPair pair = original.GetValueThreadSafe();
+    ASSERT_EQ(~pair.a, pair.b);
+  }
+
+  stop.Signal();
+  writer.Stop();
+}
+
+TEST_F(ObserverTest, CoalescedUpdatesDeliverLatestValue) {
+  Observable<int> original(0, ObservableUpdatePolicy::kCoalesce);
+  Observer<int> observer = original.Observe();
+
+  int update_count = 0;
+  observer.SetOnUpdateCallback(base::BindRepeating(
+      [](int* update_count) { ++(*update_count); }, &update_count));
+
+  // A burst of updates collapses into one delivery of the latest value.
+  original.SetValue(1);
+  original.SetValue(2);
+  original.SetValue(3);
+  base::RunLoop().RunUntilIdle();
+  EXPECT_EQ(3, observer.GetValue());
+  EXPECT_EQ(1, update_count);
+
+  // Once delivered, a later update posts (and delivers) again.
+  original.SetValue(4);
+  base::RunLoop().RunUntilIdle();
+  EXPECT_EQ(4, observer.GetValue());
+  EXPECT_EQ(2, update_count);
+}
+
+TEST_F(ObserverTest, MoveSetValue) {
+  Observable<std::vector<int>> original((std::vector<int>()));
+  Observer<std::vector<int>> observer = original.Observe();
+
+  std::vector<int> big(1000, 7);
+  original.SetValue(std::move(big));
+  base::RunLoop().RunUntilIdle();
+  EXPECT_EQ(1000u, observer.GetValue().size());
+  EXPECT_EQ(7, observer.GetValue()[0]);
+}
+
+TEST_F(ObserverTest, ObserversShareOneSnapshot) {
+  Observable<std::vector<int>> original((std::vector<int>()));
+  Observer<std::vector<int>> observer = original.Observe();
+
+  original.SetValue(std::vector<int>(10, 3));
+  base::RunLoop().RunUntilIdle();
+  // The sequence's view is the very snapshot the observable published,
+  // not a per-sequence deep copy.
+  EXPECT_EQ(original.GetSnapshot().get(), &observer.GetValue());
+}
+
 TEST_F(ObserverTest, MultipleObservers) {
   Observable<int> original(0);
   Observer<int> observer1 = original.Observe();
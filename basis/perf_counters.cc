@@ -0,0 +1,183 @@
+#include "basis/perf_counters.hpp" // IWYU pragma: associated
+
+#include <base/logging.h>
+
+#include <cerrno>
+#include <cstring>
+
+#if defined(OS_LINUX) || defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined(__NR_perf_event_open)
+#define BASIS_HAS_PERF_COUNTERS 1
+#endif
+#endif
+
+namespace basis {
+
+#if defined(BASIS_HAS_PERF_COUNTERS)
+
+namespace {
+
+// {type, config} per slot, leader first. Instructions lead so the
+// group lives or dies on the most portable event.
+struct EventSpec {
+  uint32_t type;
+  uint64_t config;
+};
+
+constexpr EventSpec kEvents[] = {
+  {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+  {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+  {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+  {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+};
+
+static_assert(sizeof(kEvents) / sizeof(kEvents[0])
+                == 4
+  , "one spec per fd slot");
+
+int perfEventOpen(
+  perf_event_attr* attr
+  , pid_t pid
+  , int cpu
+  , int group_fd
+  , unsigned long flags)
+{
+  return static_cast<int>(
+    ::syscall(__NR_perf_event_open, attr, pid, cpu, group_fd, flags));
+}
+
+} // namespace
+
+PerfCounters::PerfCounters()
+{
+  for(size_t i = 0; i < kEventCount; ++i) {
+    fds_[i] = -1;
+  }
+  for(size_t i = 0; i < kEventCount; ++i) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = kEvents[i].type;
+    attr.config = kEvents[i].config;
+    attr.disabled = (i == 0); // the group enables through the leader
+    // User space only: no elevated perf_event_paranoid needed, and
+    // kernel noise stays out of benchmark counts.
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    // Scaling bookkeeping for when the PMU multiplexes the group.
+    attr.read_format
+      = PERF_FORMAT_GROUP
+        | PERF_FORMAT_TOTAL_TIME_ENABLED
+        | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    const int group_fd = (i == 0) ? -1 : fds_[0];
+    fds_[i] = perfEventOpen(
+      &attr, /*pid=*/0, /*cpu=*/-1, group_fd, /*flags=*/0);
+    if(fds_[i] < 0) {
+      DVLOG(9)
+        << "perf_event_open failed for event " << i
+        << ": " << strerror(errno);
+      // All or nothing: partial groups would silently report zeros
+      // for the missing events.
+      for(size_t j = 0; j < i; ++j) {
+        ::close(fds_[j]);
+        fds_[j] = -1;
+      }
+      fds_[0] = -1;
+      return;
+    }
+  }
+}
+
+PerfCounters::~PerfCounters()
+{
+  for(size_t i = 0; i < kEventCount; ++i) {
+    if(fds_[i] >= 0) {
+      ::close(fds_[i]);
+    }
+  }
+}
+
+bool PerfCounters::ok() const
+{
+  return fds_[0] >= 0;
+}
+
+void PerfCounters::start()
+{
+  if(!ok()) {
+    return;
+  }
+  ::ioctl(fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ::ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+PerfCounters::Sample PerfCounters::stop()
+{
+  Sample sample;
+  if(!ok()) {
+    return sample;
+  }
+  ::ioctl(fds_[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+  // PERF_FORMAT_GROUP layout: nr, time_enabled, time_running, then
+  // one value per event in creation order.
+  struct {
+    uint64_t nr;
+    uint64_t time_enabled;
+    uint64_t time_running;
+    uint64_t values[kEventCount];
+  } data;
+  const ssize_t got = ::read(fds_[0], &data, sizeof(data));
+  if(got != static_cast<ssize_t>(sizeof(data))
+     || data.nr != kEventCount)
+  {
+    return sample;
+  }
+  // Scale like perf stat when the group was multiplexed off-PMU part
+  // of the time.
+  double scale = 1.0;
+  if(data.time_running != 0 && data.time_running < data.time_enabled) {
+    scale = static_cast<double>(data.time_enabled)
+            / static_cast<double>(data.time_running);
+  }
+  const auto scaled = [scale](uint64_t value) {
+    return static_cast<uint64_t>(static_cast<double>(value) * scale);
+  };
+  sample.instructions = scaled(data.values[0]);
+  sample.cycles = scaled(data.values[1]);
+  sample.cache_misses = scaled(data.values[2]);
+  sample.branch_misses = scaled(data.values[3]);
+  sample.valid = data.time_running != 0;
+  return sample;
+}
+
+#else // BASIS_HAS_PERF_COUNTERS
+
+PerfCounters::PerfCounters()
+{
+  for(size_t i = 0; i < kEventCount; ++i) {
+    fds_[i] = -1;
+  }
+}
+
+PerfCounters::~PerfCounters() = default;
+
+bool PerfCounters::ok() const
+{
+  return false;
+}
+
+void PerfCounters::start() {}
+
+PerfCounters::Sample PerfCounters::stop()
+{
+  return Sample();
+}
+
+#endif // BASIS_HAS_PERF_COUNTERS
+
+}  // namespace basis
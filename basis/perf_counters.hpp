@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <base/macros.h>
+
+namespace basis {
+
+// Scoped hardware-counter measurement over perf_event_open: wall-clock
+// benchmarks show THAT a change regressed, these counters show WHY
+// (IPC collapse, cache misses, branch mispredicts). Intended for the
+// basis-benchmarks target - measure around the benchmark loop and
+// divide by iterations to get "misses per op".
+//
+// USAGE:
+//   basis::PerfCounters counters;  // ok() false if the kernel refuses
+//   counters.start();
+//   for(auto _ : state) { ... }
+//   const basis::PerfCounters::Sample sample = counters.stop();
+//   if(sample.valid) { sample.ipc(); sample.cache_misses; ... }
+//
+// The four events are opened as one group on the calling thread
+// (user-space only, so perf_event_paranoid <= 2 suffices); when the
+// PMU multiplexes the group the counts are scaled by
+// time_enabled/time_running, like perf stat does. On kernels or
+// containers that deny perf_event_open, ok() is false and stop()
+// returns an invalid Sample - callers degrade to time-only output.
+class PerfCounters {
+ public:
+  struct Sample {
+    uint64_t instructions = 0;
+    uint64_t cycles = 0;
+    uint64_t cache_misses = 0;
+    uint64_t branch_misses = 0;
+    // False when the counters could not be opened or read; all counts
+    // are zero then.
+    bool valid = false;
+
+    double ipc() const
+    {
+      return cycles ? static_cast<double>(instructions) / cycles : 0.0;
+    }
+  };
+
+  PerfCounters();
+  ~PerfCounters();
+
+  // False when perf_event_open is unavailable (old kernel, seccomp,
+  // perf_event_paranoid); start()/stop() are safe no-ops then.
+  bool ok() const;
+
+  // Resets and enables the counter group.
+  void start();
+
+  // Disables the group and reads it out.
+  Sample stop();
+
+ private:
+  // Group leader first; -1 when closed/unavailable.
+  static constexpr size_t kEventCount = 4;
+  int fds_[kEventCount];
+
+  DISALLOW_COPY_AND_ASSIGN(PerfCounters);
+};
+
+}  // namespace basis
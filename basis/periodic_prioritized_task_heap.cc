@@ -1,14 +1,53 @@
 #include "periodic_prioritized_task_heap.hpp" // IWYU pragma: associated
 
 #include <algorithm>
+#include <utility>
 
 #include <base/bind.h>
+#include <base/synchronization/waitable_event.h>
+#include <base/task/post_task.h>
+#include <base/task/task_traits.h>
 
 namespace basis {
 
+// Position of the owning job inside |task_job_heap_|,
+// or |kNotInHeap| when the job is not currently stored there
+// (finished, canceled, or temporarily detached while running).
+struct PeriodicPrioritizedTaskHeap::TaskHandle::State {
+  static constexpr size_t kNotInHeap = static_cast<size_t>(-1);
+
+  size_t heap_index = kNotInHeap;
+  bool canceled = false;
+};
+
+PeriodicPrioritizedTaskHeap::TaskHandle::TaskHandle() = default;
+PeriodicPrioritizedTaskHeap::TaskHandle::~TaskHandle() = default;
+
+PeriodicPrioritizedTaskHeap::TaskHandle::TaskHandle(
+  const TaskHandle& other) = default;
+PeriodicPrioritizedTaskHeap::TaskHandle&
+  PeriodicPrioritizedTaskHeap::TaskHandle::operator=(
+    const TaskHandle& other) = default;
+PeriodicPrioritizedTaskHeap::TaskHandle::TaskHandle(
+  TaskHandle&& other) = default;
+PeriodicPrioritizedTaskHeap::TaskHandle&
+  PeriodicPrioritizedTaskHeap::TaskHandle::operator=(
+    TaskHandle&& other) = default;
+
+PeriodicPrioritizedTaskHeap::TaskHandle::TaskHandle(
+  std::shared_ptr<State> state)
+  : state_(std::move(state))
+{
+}
+
+bool PeriodicPrioritizedTaskHeap::TaskHandle::IsValid() const
+{
+  return state_ != nullptr;
+}
+
 PeriodicPrioritizedTaskHeap::Job::Job(
   const base::Location& from_here,
-  Callback task,
+  InplaceCallback task,
   uint32_t priority,
   uint32_t task_count,
   const std::chrono::nanoseconds& interval)
@@ -28,23 +67,90 @@ PeriodicPrioritizedTaskHeap::Job&
   PeriodicPrioritizedTaskHeap::Job::operator=(Job&& other) =
     default;
 
-PeriodicPrioritizedTaskHeap::PeriodicPrioritizedTaskHeap()
+PeriodicPrioritizedTaskHeap::PendingSchedule::PendingSchedule(
+  const base::Location& from_here,
+  InplaceCallback task,
+  uint32_t priority,
+  const std::chrono::nanoseconds& interval)
+  : from_here(from_here),
+    task(std::move(task)),
+    priority(priority),
+    interval(interval)
+{
+}
+
+PeriodicPrioritizedTaskHeap::PeriodicPrioritizedTaskHeap(
+  OrderingMode ordering_mode, basis::Arena* arena)
+  : task_job_heap_(basis::ArenaAllocator<Job>(arena))
+  , ordering_mode_(ordering_mode)
 {
   SEQUENCE_CHECKER(sequence_checker_);
 }
 
-void PeriodicPrioritizedTaskHeap::ScheduleTask(
-  const base::Location& from_here
-  , Callback task
-  , uint32_t priority
-  , const std::chrono::nanoseconds& interval)
+bool PeriodicPrioritizedTaskHeap::JobBelow(
+  const Job& left, const Job& right) const
 {
-  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (ordering_mode_ == OrderingMode::kEarliestDeadlineFirst) {
+    // Remaining time until the interval passes; negative when overdue.
+    // All timers advance by the same dt each frame, so the relative
+    // order only changes when a job runs (and is reinserted anyway).
+    const std::chrono::nanoseconds left_remaining
+      = left.timer.GetInterval() - left.timer.GetCurrent();
+    const std::chrono::nanoseconds right_remaining
+      = right.timer.GetInterval() - right.timer.GetCurrent();
+    if (left_remaining != right_remaining)
+      return left_remaining > right_remaining;
+    // Equal deadlines fall through to priority order.
+  }
+  if (left.priority == right.priority)
+    return left.task_count > right.task_count;
+  return left.priority > right.priority;
+}
 
+PeriodicPrioritizedTaskHeap::TaskHandle
+  PeriodicPrioritizedTaskHeap::ScheduleTask(
+    const base::Location& from_here
+    , Callback task
+    , uint32_t priority
+    , const std::chrono::nanoseconds& interval
+    , bool parallel_safe)
+{
   DCHECK(task)
     << "Unexpected Callback. Location: "
     << from_here.ToString();
 
+  return ScheduleTask(
+    from_here
+    , InplaceCallback(
+        [task = std::move(task)](
+          const std::chrono::nanoseconds& current_frame_elapsed_dt
+          , const std::chrono::nanoseconds& last_call_elapsed_dt
+          , bool* stop_repeating_task)
+        {
+          task.Run(
+            current_frame_elapsed_dt
+            , last_call_elapsed_dt
+            , stop_repeating_task);
+        })
+    , priority
+    , interval
+    , parallel_safe);
+}
+
+PeriodicPrioritizedTaskHeap::TaskHandle
+  PeriodicPrioritizedTaskHeap::ScheduleTask(
+    const base::Location& from_here
+    , InplaceCallback task
+    , uint32_t priority
+    , const std::chrono::nanoseconds& interval
+    , bool parallel_safe)
+{
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+
+  DCHECK(task)
+    << "Unexpected callable. Location: "
+    << from_here.ToString();
+
   DCHECK(interval.count() > 0)
     << "Unexpected interval. Location: "
     << from_here.ToString();
@@ -56,14 +162,222 @@ void PeriodicPrioritizedTaskHeap::ScheduleTask(
     , task_count_++
     , interval);
 
+  job.parallel_safe = parallel_safe;
+  job.handle_state = std::make_shared<TaskHandle::State>();
+
+  TaskHandle handle(job.handle_state);
+
   task_job_heap_.push_back(std::move(job));
+  SetJobIndex(task_job_heap_.size() - 1);
+  SiftUp(task_job_heap_.size() - 1);
+
+  return handle;
+}
+
+std::vector<PeriodicPrioritizedTaskHeap::TaskHandle>
+  PeriodicPrioritizedTaskHeap::ScheduleTasks(std::vector<JobSpec> specs)
+{
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+
+  std::vector<TaskHandle> handles;
+  handles.reserve(specs.size());
+  task_job_heap_.reserve(task_job_heap_.size() + specs.size());
+
+  for (JobSpec& spec : specs) {
+    DCHECK(spec.task)
+      << "Unexpected callable. Location: "
+      << spec.from_here.ToString();
+
+    DCHECK(spec.interval.count() > 0)
+      << "Unexpected interval. Location: "
+      << spec.from_here.ToString();
+
+    Job job(
+      spec.from_here
+      , std::move(spec.task)
+      , spec.priority
+      , task_count_++
+      , spec.interval);
+    job.owner_tag = spec.owner_tag;
+    job.parallel_safe = spec.parallel_safe;
+    job.handle_state = std::make_shared<TaskHandle::State>();
+
+    handles.push_back(TaskHandle(job.handle_state));
+
+    // Appended in arrival order; one Heapify below restores the heap
+    // property for the whole batch.
+    task_job_heap_.push_back(std::move(job));
+    SetJobIndex(task_job_heap_.size() - 1);
+  }
+
+  Heapify();
+
+  return handles;
+}
+
+size_t PeriodicPrioritizedTaskHeap::CancelByOwnerTag(uint64_t owner_tag)
+{
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+
+  DCHECK(owner_tag != 0)
+    << "CancelByOwnerTag would cancel every untagged job";
+
+  // Compact in place: relative order of survivors is irrelevant
+  // (Heapify rebuilds), removed jobs are destroyed by the resize.
+  size_t canceled = 0;
+  size_t write = 0;
+  for (size_t read = 0; read < task_job_heap_.size(); ++read) {
+    Job& job = task_job_heap_[read];
+    if (job.owner_tag == owner_tag) {
+      job.handle_state->canceled = true;
+      job.handle_state->heap_index = TaskHandle::State::kNotInHeap;
+      ++canceled;
+      continue;
+    }
+    if (write != read) {
+      task_job_heap_[write] = std::move(job);
+      SetJobIndex(write);
+    }
+    ++write;
+  }
+
+  if (canceled > 0) {
+    task_job_heap_.resize(write);
+    Heapify();
+  }
+
+  return canceled;
+}
+
+PeriodicPrioritizedTaskHeap::TaskHandle
+  PeriodicPrioritizedTaskHeap::ScheduleTaskCrossThread(
+    const base::Location& from_here
+    , InplaceCallback task
+    , uint32_t priority
+    , const std::chrono::nanoseconds& interval)
+{
+  // Deliberately no sequence check: this is the one entry point meant
+  // for other threads.
+
+  DCHECK(task)
+    << "Unexpected callable. Location: "
+    << from_here.ToString();
+
+  DCHECK(interval.count() > 0)
+    << "Unexpected interval. Location: "
+    << from_here.ToString();
+
+  PendingSchedule* pending = new PendingSchedule(
+    from_here
+    , std::move(task)
+    , priority
+    , interval);
+
+  pending->handle_state = std::make_shared<TaskHandle::State>();
+
+  TaskHandle handle(pending->handle_state);
+
+  // Counter first, so a concurrent drain that observes it keeps
+  // retrying pop() until the push below is linked.
+  cross_thread_pending_.fetch_add(1, std::memory_order_release);
+  cross_thread_inbox_.push(pending);
+
+  return handle;
+}
+
+void PeriodicPrioritizedTaskHeap::DrainCrossThreadInbox()
+{
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+
+  while (cross_thread_pending_.load(std::memory_order_acquire) > 0) {
+    PendingSchedule* pending = cross_thread_inbox_.pop();
+    if (!pending) {
+      // A producer is between its exchange and link store; the window
+      // is a few instructions (see MPSCIntrusiveQueue), so spin.
+      continue;
+    }
+    cross_thread_pending_.fetch_sub(1, std::memory_order_relaxed);
+
+    // Canceled before it ever entered the heap.
+    if (!pending->handle_state->canceled) {
+      Job job(
+        pending->from_here
+        , std::move(pending->task)
+        , pending->priority
+        , task_count_++
+        , pending->interval);
+      job.handle_state = std::move(pending->handle_state);
+
+      task_job_heap_.push_back(std::move(job));
+      SetJobIndex(task_job_heap_.size() - 1);
+      SiftUp(task_job_heap_.size() - 1);
+    }
+
+    delete pending;
+  }
+}
+
+bool PeriodicPrioritizedTaskHeap::Cancel(const TaskHandle& handle)
+{
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+
+  if (!handle.state_ || handle.state_->canceled) {
+    return false;
+  }
+
+  handle.state_->canceled = true;
+
+  if (handle.state_->heap_index == TaskHandle::State::kNotInHeap) {
+    // Finished, or detached while running this frame; in the latter case
+    // the |canceled| mark prevents reinsertion (see RunAllTasks).
+    return false;
+  }
+
+  // Job destructor releases the callback.
+  RemoveJobAt(handle.state_->heap_index);
+  return true;
+}
+
+bool PeriodicPrioritizedTaskHeap::Reschedule(
+  const TaskHandle& handle
+  , uint32_t priority
+  , const std::chrono::nanoseconds& interval)
+{
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
 
-  std::push_heap(task_job_heap_.begin(), task_job_heap_.end(), JobComparer());
+  DCHECK(interval.count() > 0);
+
+  if (!handle.state_
+      || handle.state_->canceled
+      || handle.state_->heap_index == TaskHandle::State::kNotInHeap) {
+    return false;
+  }
+
+  const size_t index = handle.state_->heap_index;
+  Job& job = task_job_heap_[index];
+  job.priority = priority;
+  job.timer.SetInterval(interval);
+  // Reordering among equal priorities follows reschedule time.
+  job.task_count = task_count_++;
+
+  SiftDown(SiftUp(index));
+  return true;
 }
 
 PeriodicPrioritizedTaskHeap::~PeriodicPrioritizedTaskHeap()
 {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+
+  // Dispose of jobs still parked in the inbox. No producer may race
+  // with destruction (they would be pushing into a dying object).
+  while (cross_thread_pending_.load(std::memory_order_acquire) > 0) {
+    PendingSchedule* pending = cross_thread_inbox_.pop();
+    if (!pending) {
+      continue;
+    }
+    cross_thread_pending_.fetch_sub(1, std::memory_order_relaxed);
+    delete pending;
+  }
 }
 
 void PeriodicPrioritizedTaskHeap::RunAllTasks(
@@ -71,8 +385,142 @@ void PeriodicPrioritizedTaskHeap::RunAllTasks(
 {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
 
-  for(size_t i = 0; i < task_job_heap_.size(); i++) {
-    RunLargestTask(current_frame_elapsed_dt);
+  DrainCrossThreadInbox();
+
+  // Detach-run-reinsert so that each job runs exactly once per call, in
+  // priority order, even though a job put back right away would surface
+  // at the top again.
+  std::vector<Job> ran_jobs;
+  ran_jobs.reserve(task_job_heap_.size());
+
+  while (!task_job_heap_.empty()) {
+    Job job = RemoveJobAt(0);
+
+    bool need_stop_repeating_task = false;
+    RunJob(job, current_frame_elapsed_dt, &need_stop_repeating_task);
+
+    if (!need_stop_repeating_task && !job.handle_state->canceled) {
+      ran_jobs.push_back(std::move(job));
+    }
+  }
+
+  for (Job& job : ran_jobs) {
+    ReinsertJob(std::move(job));
+  }
+}
+
+void PeriodicPrioritizedTaskHeap::RunAllTasksParallel(
+  const std::chrono::nanoseconds& current_frame_elapsed_dt)
+{
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+
+  DCHECK(ordering_mode_ == OrderingMode::kPriorityOrder)
+    << "waves are priority groups, which is meaningless under "
+       "kEarliestDeadlineFirst";
+
+  DrainCrossThreadInbox();
+
+  std::vector<Job> ran_jobs;
+  ran_jobs.reserve(task_job_heap_.size());
+
+  std::vector<Job> wave;
+
+  while (!task_job_heap_.empty()) {
+    // Detach every job of the current top priority into one wave.
+    wave.clear();
+    const uint32_t wave_priority = task_job_heap_[0].priority;
+    while (!task_job_heap_.empty()
+           && task_job_heap_[0].priority == wave_priority) {
+      wave.push_back(RemoveJobAt(0));
+    }
+
+    // Timers advance on the owning thread; only due jobs run at all.
+    size_t parallel_jobs = 0;
+    for (Job& job : wave) {
+      job.timer.Update(current_frame_elapsed_dt);
+      if (job.parallel_safe && job.timer.Passed()) {
+        ++parallel_jobs;
+      }
+    }
+
+    // Per-job out-flags; plain bytes, each written by exactly one task.
+    std::vector<uint8_t> stop_flags(wave.size(), 0);
+
+    base::WaitableEvent done(
+      base::WaitableEvent::ResetPolicy::MANUAL
+      , base::WaitableEvent::InitialState::NOT_SIGNALED);
+    std::atomic<size_t> remaining{parallel_jobs};
+
+    for (size_t i = 0; i < wave.size(); ++i) {
+      Job& job = wave[i];
+      if (!job.parallel_safe || !job.timer.Passed()) {
+        continue;
+      }
+      base::PostTask(
+        job.from_here
+        , {base::ThreadPool(), base::TaskPriority::USER_BLOCKING}
+        , base::BindOnce(
+            &PeriodicPrioritizedTaskHeap::RunParallelJobOnPool
+            , &job
+            , current_frame_elapsed_dt
+            , &stop_flags[i]
+            , &remaining
+            , &done));
+    }
+
+    // Serial jobs of the wave run here, overlapping the posted work.
+    for (size_t i = 0; i < wave.size(); ++i) {
+      Job& job = wave[i];
+      if (job.parallel_safe) {
+        continue;
+      }
+      bool need_stop_repeating_task = false;
+      RunJobCallback(
+        job, current_frame_elapsed_dt, &need_stop_repeating_task);
+      stop_flags[i] = need_stop_repeating_task ? 1 : 0;
+    }
+
+    // Join the wave before the next priority starts.
+    if (parallel_jobs > 0) {
+      done.Wait();
+    }
+
+    for (size_t i = 0; i < wave.size(); ++i) {
+      if (!stop_flags[i] && !wave[i].handle_state->canceled) {
+        ran_jobs.push_back(std::move(wave[i]));
+      }
+    }
+  }
+
+  for (Job& job : ran_jobs) {
+    ReinsertJob(std::move(job));
+  }
+}
+
+// static
+void PeriodicPrioritizedTaskHeap::RunParallelJobOnPool(
+  Job* job
+  , std::chrono::nanoseconds current_frame_elapsed_dt
+  , uint8_t* stop_flag
+  , std::atomic<size_t>* remaining
+  , base::WaitableEvent* done)
+{
+  DCHECK(job->task)
+    << "Unexpected callable. Location: "
+    << job->from_here.ToString();
+
+  // The wave owns |job| exclusively until |done| is signaled, so the
+  // timer and flag writes below need no synchronization of their own.
+  bool need_stop_repeating_task = false;
+  job->task(
+    current_frame_elapsed_dt
+    , /*last_call_elapsed_dt*/ job->timer.GetCurrent()
+    , &need_stop_repeating_task);
+  job->timer.Reset();
+  *stop_flag = need_stop_repeating_task ? 1 : 0;
+
+  if (remaining->fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    done->Signal();
   }
 }
 
@@ -81,36 +529,192 @@ void PeriodicPrioritizedTaskHeap::RunLargestTask(
 {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
 
-  // Find the next job to run.
-  // Moves the largest to the end
-  std::pop_heap(task_job_heap_.begin(), task_job_heap_.end(), JobComparer());
+  DrainCrossThreadInbox();
+
+  if (task_job_heap_.empty()) {
+    return;
+  }
+
+  Job job = RemoveJobAt(0);
 
   bool need_stop_repeating_task = false;
+  RunJob(job, current_frame_elapsed_dt, &need_stop_repeating_task);
 
-  Job& job = task_job_heap_.back();
+  if (!need_stop_repeating_task && !job.handle_state->canceled) {
+    // Fresh |task_count| (see ReinsertJob) makes repeated
+    // RunLargestTask calls cycle through jobs of equal priority.
+    ReinsertJob(std::move(job));
+  }
+}
+
+void PeriodicPrioritizedTaskHeap::RunTasksWithBudget(
+  const std::chrono::nanoseconds& current_frame_elapsed_dt
+  , const std::chrono::nanoseconds& budget)
+{
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+
+  DrainCrossThreadInbox();
+
+  // Advance every timer up front, whether or not its job fits into the
+  // budget: jobs that do not fit keep accumulating due time, so they stay
+  // due (and, under kEarliestDeadlineFirst, surface first) next frame.
+  // A uniform increment does not reorder the deadline heap.
+  for (Job& job : task_job_heap_) {
+    job.timer.Update(current_frame_elapsed_dt);
+  }
 
+  const std::chrono::steady_clock::time_point deadline
+    = std::chrono::steady_clock::now() + budget;
+
+  std::vector<Job> ran_jobs;
+  ran_jobs.reserve(task_job_heap_.size());
+
+  while (!task_job_heap_.empty()
+         && std::chrono::steady_clock::now() < deadline) {
+    Job job = RemoveJobAt(0);
+
+    bool need_stop_repeating_task = false;
+    RunJobCallback(job, current_frame_elapsed_dt, &need_stop_repeating_task);
+
+    if (!need_stop_repeating_task && !job.handle_state->canceled) {
+      ran_jobs.push_back(std::move(job));
+    }
+  }
+
+  for (Job& job : ran_jobs) {
+    ReinsertJob(std::move(job));
+  }
+}
+
+void PeriodicPrioritizedTaskHeap::RunJob(
+  Job& job
+  , const std::chrono::nanoseconds& current_frame_elapsed_dt
+  , bool* need_stop_repeating_task)
+{
+  job.timer.Update(current_frame_elapsed_dt);
+
+  RunJobCallback(job, current_frame_elapsed_dt, need_stop_repeating_task);
+}
+
+void PeriodicPrioritizedTaskHeap::RunJobCallback(
+  Job& job
+  , const std::chrono::nanoseconds& current_frame_elapsed_dt
+  , bool* need_stop_repeating_task)
+{
   DCHECK(job.timer.GetInterval().count() > 0)
     << "Unexpected interval. Location: "
     << job.from_here.ToString();
 
   DCHECK(job.task)
-    << "Unexpected Callback. Location: "
+    << "Unexpected callable. Location: "
     << job.from_here.ToString();
 
-  job.timer.Update(current_frame_elapsed_dt);
-
   if(job.timer.Passed()) {
-    job.task.Run(
+    job.task(
       current_frame_elapsed_dt
       , /*last_call_elapsed_dt*/ job.timer.GetCurrent()
-      , &need_stop_repeating_task);
+      , need_stop_repeating_task);
     job.timer.Reset();
   }
+}
+
+size_t PeriodicPrioritizedTaskHeap::SiftUp(size_t index)
+{
+  while (index > 0) {
+    const size_t parent = (index - 1) / kHeapDegree;
+    if (!JobBelow(task_job_heap_[parent], task_job_heap_[index])) {
+      break;
+    }
+    SwapJobs(parent, index);
+    index = parent;
+  }
+  return index;
+}
+
+size_t PeriodicPrioritizedTaskHeap::SiftDown(size_t index)
+{
+  const size_t size = task_job_heap_.size();
+  for (;;) {
+    const size_t first_child = index * kHeapDegree + 1;
+    if (first_child >= size) {
+      break;
+    }
+
+    // Pick the topmost (JobComparer-wise) of up to kHeapDegree children.
+    size_t best_child = first_child;
+    const size_t end_child = std::min(first_child + kHeapDegree, size);
+    for (size_t child = first_child + 1; child < end_child; ++child) {
+      if (JobBelow(task_job_heap_[best_child], task_job_heap_[child])) {
+        best_child = child;
+      }
+    }
 
-  if(need_stop_repeating_task) {
-    // removes the largest element
-    task_job_heap_.pop_back();
+    if (!JobBelow(task_job_heap_[index], task_job_heap_[best_child])) {
+      break;
+    }
+    SwapJobs(index, best_child);
+    index = best_child;
   }
+  return index;
+}
+
+void PeriodicPrioritizedTaskHeap::Heapify()
+{
+  if (task_job_heap_.size() < 2) {
+    return;
+  }
+  // Sift down every internal node, deepest parent first.
+  const size_t last_parent = (task_job_heap_.size() - 2) / kHeapDegree;
+  for (size_t index = last_parent + 1; index > 0; --index) {
+    SiftDown(index - 1);
+  }
+}
+
+void PeriodicPrioritizedTaskHeap::SwapJobs(
+  size_t left_index, size_t right_index)
+{
+  std::swap(task_job_heap_[left_index], task_job_heap_[right_index]);
+  SetJobIndex(left_index);
+  SetJobIndex(right_index);
+}
+
+void PeriodicPrioritizedTaskHeap::SetJobIndex(size_t index)
+{
+  DCHECK(task_job_heap_[index].handle_state);
+  task_job_heap_[index].handle_state->heap_index = index;
+}
+
+PeriodicPrioritizedTaskHeap::Job
+  PeriodicPrioritizedTaskHeap::RemoveJobAt(size_t index)
+{
+  DCHECK(index < task_job_heap_.size());
+
+  const size_t last_index = task_job_heap_.size() - 1;
+  if (index != last_index) {
+    SwapJobs(index, last_index);
+  }
+
+  Job job = std::move(task_job_heap_.back());
+  task_job_heap_.pop_back();
+  job.handle_state->heap_index = TaskHandle::State::kNotInHeap;
+
+  if (index != last_index) {
+    // The job moved into the hole may violate the heap property in
+    // either direction.
+    SiftDown(SiftUp(index));
+  }
+
+  return job;
+}
+
+void PeriodicPrioritizedTaskHeap::ReinsertJob(Job&& job)
+{
+  // Fresh |task_count| so jobs of equal priority round-robin.
+  job.task_count = task_count_++;
+
+  task_job_heap_.push_back(std::move(job));
+  SetJobIndex(task_job_heap_.size() - 1);
+  SiftUp(task_job_heap_.size() - 1);
 }
 
 }  // namespace basis
@@ -1,9 +1,14 @@
 #pragma once
 
+#include <basis/concurrency/MPSCIntrusiveQueue.hpp>
+#include <basis/inplace_function.hpp>
+#include <basis/memory/Arena.hpp>
 #include <basis/timer/IntervalTimer.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <memory>
 #include <vector>
 #include <chrono>
 
@@ -11,18 +16,26 @@
 #include <base/callback.h>
 #include <base/location.h>
 #include <base/memory/ref_counted.h>
-#include <base/synchronization/lock.h>
 #include <base/optional.h>
 #include <base/timer/timer.h>
 #include <base/time/time.h>
 #include <base/trace_event/trace_event.h>
 
+namespace base {
+class WaitableEvent;
+}  // namespace base
+
 namespace basis {
 
 // PeriodicPrioritizedTaskHeap allows for prioritization of posted tasks.
 // It provides up to 2^32 priority levels.
 // All tasks posted via the PeriodicPrioritizedTaskHeap
 // will run in priority order.
+//
+// Sequence-affine by design: scheduling, canceling and running all
+// happen on one sequence (DCHECK-enforced) and take no lock. The rare
+// off-sequence caller goes through ScheduleTaskCrossThread, which parks
+// the job in a lock-free inbox drained at frame start.
 class PeriodicPrioritizedTaskHeap
   : public base::RefCountedThreadSafe<PeriodicPrioritizedTaskHeap>
 {
@@ -30,7 +43,49 @@ class PeriodicPrioritizedTaskHeap
   // Highest priority will run before other priority values.
   static constexpr uint32_t kHighestPriority = 0;
 
-  PeriodicPrioritizedTaskHeap();
+  enum class OrderingMode {
+    // Jobs surface by |priority| (see ScheduleTask).
+    kPriorityOrder,
+    // Jobs surface by how close (or past) their interval they are, so
+    // period-overrun jobs get caught up first; |priority| breaks ties.
+    // Pair with RunTasksWithBudget: jobs pushed past their period by an
+    // exhausted budget surface first on the next frame.
+    kEarliestDeadlineFirst,
+  };
+
+  // Stable reference to a scheduled task; stays valid while the task is
+  // scheduled (moving inside the heap does not invalidate it).
+  // Default-constructed handles reference nothing.
+  // See ScheduleTask / Cancel / Reschedule.
+  class TaskHandle {
+   public:
+    TaskHandle();
+    ~TaskHandle();
+
+    TaskHandle(const TaskHandle& other);
+    TaskHandle& operator=(const TaskHandle& other);
+    TaskHandle(TaskHandle&& other);
+    TaskHandle& operator=(TaskHandle&& other);
+
+    // False for default-constructed handles.
+    bool IsValid() const;
+
+   private:
+    friend class PeriodicPrioritizedTaskHeap;
+
+    struct State;
+
+    explicit TaskHandle(std::shared_ptr<State> state);
+
+    std::shared_ptr<State> state_;
+  };
+
+  // |arena|, when given, backs the job heap's storage so growth never
+  // touches malloc; it must outlive this object and must not be
+  // reset() while jobs are scheduled.
+  explicit PeriodicPrioritizedTaskHeap(
+    OrderingMode ordering_mode = OrderingMode::kPriorityOrder
+    , basis::Arena* arena = nullptr);
 
   typedef base::RepeatingCallback<
       void(
@@ -39,15 +94,107 @@ class PeriodicPrioritizedTaskHeap
         , bool* stop_repeating_task)
     > Callback;
 
+  // Non-allocating flavor of |Callback|: the callable is stored inline
+  // in the job itself, so scheduling never touches malloc (a
+  // BindRepeating-made |Callback| costs one BindState allocation per
+  // job, which adds up when hundreds of periodic jobs are registered
+  // at once, e.g. on map load). Prefer passing lambdas through this.
+  using InplaceCallback = basis::InplaceFunction<
+      void(
+        const std::chrono::nanoseconds& current_frame_elapsed_dt
+        , const std::chrono::nanoseconds& last_call_elapsed_dt
+        , bool* stop_repeating_task)>;
+
   // Task runs at |priority|.
   // Priority 0 is the highest priority and will run before other
   // priority values.
   // Multiple tasks with the same |priority| value are run in
-  // order of posting.
-  void ScheduleTask(
+  // round-robin order.
+  // Returned handle may be used to Cancel / Reschedule the task;
+  // it is fine to drop it if the task only stops itself.
+  // |parallel_safe| marks the task as independent of every other
+  // same-priority task, opting it into RunAllTasksParallel fan-out
+  // (where its callback runs on a thread pool worker and must not
+  // touch this heap or other sequence-affine state).
+  TaskHandle ScheduleTask(
+    const base::Location& from_here
+    , InplaceCallback task
+    , uint32_t priority
+    , const std::chrono::nanoseconds& interval
+    , bool parallel_safe = false);
+
+  // Convenience overload for callers holding a bound |Callback|; the
+  // callback is wrapped into an InplaceCallback (it is just one
+  // refcounted pointer), so only the original BindRepeating allocated.
+  TaskHandle ScheduleTask(
     const base::Location& from_here
     , Callback task
     , uint32_t priority
+    , const std::chrono::nanoseconds& interval
+    , bool parallel_safe = false);
+
+  // One ScheduleTasks entry; field semantics match ScheduleTask.
+  struct JobSpec {
+    base::Location from_here;
+    InplaceCallback task;
+    uint32_t priority = 0;
+    std::chrono::nanoseconds interval{};
+    // Groups jobs for CancelByOwnerTag (i.e. all jobs registered by
+    // one map or subsystem). 0 means untagged.
+    uint64_t owner_tag = 0;
+    // See ScheduleTask.
+    bool parallel_safe = false;
+  };
+
+  // Bulk flavor of ScheduleTask for registration bursts (i.e. hundreds
+  // of periodic jobs on map load): appends every job and restores the
+  // heap property with one O(n) build-heap pass instead of one
+  // O(log n) sift per job. Returned handles are in |specs| order.
+  std::vector<TaskHandle> ScheduleTasks(std::vector<JobSpec> specs);
+
+  // Cancels every scheduled job carrying |owner_tag| and restores the
+  // heap with one O(n) pass, so mass teardown (map unload) does not
+  // pay O(log n) per job. |owner_tag| must be non-zero: canceling "all
+  // untagged jobs" is never what a caller wants.
+  // Returns the number of jobs canceled.
+  size_t CancelByOwnerTag(uint64_t owner_tag);
+
+  // Thread-safe scheduling port for the rare off-sequence caller. The
+  // job is parked in a lock-free inbox (one wait-free push, one node
+  // allocation — unlike ScheduleTask) and enters the heap when the
+  // owning sequence drains the inbox. The returned handle behaves as
+  // usual once drained; Cancel may also be called (on the owning
+  // sequence) before the drain, which keeps the job from ever being
+  // inserted.
+  TaskHandle ScheduleTaskCrossThread(
+    const base::Location& from_here
+    , InplaceCallback task
+    , uint32_t priority
+    , const std::chrono::nanoseconds& interval);
+
+  // Moves jobs parked by ScheduleTaskCrossThread into the heap. Runs
+  // automatically at the start of every Run* call (i.e. at frame
+  // start); call it explicitly only to make a parked job visible to
+  // Reschedule before its first frame. Costs one atomic load when the
+  // inbox is empty. Owning sequence only.
+  void DrainCrossThreadInbox();
+
+  // Removes the task in O(log n) without waiting for it to surface at the
+  // top of the heap (i.e. jobs of disconnected players stop paying their
+  // callback cost immediately).
+  // Returns false if the task already finished or was already canceled.
+  /// \note a task canceled from inside another task's callback during
+  /// RunAllTasks is guaranteed to not run on following frames, but may
+  /// still run once on the current one if it preceded the caller
+  /// in priority order.
+  bool Cancel(const TaskHandle& handle);
+
+  // Changes priority and interval of a scheduled task in O(log n).
+  // Accumulated elapsed time of the task's timer is kept.
+  // Returns false if the task already finished or was canceled.
+  bool Reschedule(
+    const TaskHandle& handle
+    , uint32_t priority
     , const std::chrono::nanoseconds& interval);
 
   void RunLargestTask(
@@ -56,6 +203,29 @@ class PeriodicPrioritizedTaskHeap
   void RunAllTasks(
     const std::chrono::nanoseconds& current_frame_elapsed_dt);
 
+  // Like RunAllTasks, but fans parallel-safe jobs (see ScheduleTask)
+  // out to base::ThreadPool in priority waves: all due jobs of the top
+  // priority run concurrently — serial ones on the calling thread,
+  // overlapping the posted ones — and the wave is joined before the
+  // next priority starts, so cross-priority ordering is preserved.
+  // With independent same-priority jobs (per-region AI updates) the
+  // wave finishes in max() of its jobs instead of their sum.
+  // Requires kPriorityOrder (waves are priority groups, which is
+  // meaningless under kEarliestDeadlineFirst) and an initialized
+  // thread pool (see basis/thread_pool_util.hpp).
+  void RunAllTasksParallel(
+    const std::chrono::nanoseconds& current_frame_elapsed_dt);
+
+  // Like RunAllTasks, but stops starting new jobs once |budget| of wall
+  // time was spent (a running job is never interrupted, so the budget can
+  // be overshot by one job). Timers of every job are advanced regardless,
+  // so jobs that did not fit keep accumulating due time and are caught up
+  // on following frames — use this to keep a burst of simultaneously
+  // expiring IntervalTimers from blowing the frame budget.
+  void RunTasksWithBudget(
+    const std::chrono::nanoseconds& current_frame_elapsed_dt
+    , const std::chrono::nanoseconds& budget);
+
  private:
   friend class base::RefCountedThreadSafe<PeriodicPrioritizedTaskHeap>;
 
@@ -67,7 +237,7 @@ class PeriodicPrioritizedTaskHeap
 
   struct Job {
     Job(const base::Location& from_here,
-        Callback task,
+        InplaceCallback task,
         uint32_t priority,
         uint32_t task_count,
         const std::chrono::nanoseconds& interval);
@@ -78,34 +248,121 @@ class PeriodicPrioritizedTaskHeap
     Job& operator=(Job&& other);
 
     base::Location from_here;
-    Callback task;
+    InplaceCallback task;
     uint32_t priority = 0;
     uint32_t task_count = 0;
     uint32_t iteration = 0;
+    // See JobSpec::owner_tag; 0 for jobs scheduled without a tag.
+    uint64_t owner_tag = 0;
+    // See ScheduleTask.
+    bool parallel_safe = false;
     basis::IntervalTimer timer;
 
+    // Back-pointer cell kept in sync with the job's position in
+    // |task_job_heap_|; shared with any TaskHandle copies.
+    std::shared_ptr<TaskHandle::State> handle_state;
+
    private:
     DISALLOW_COPY_AND_ASSIGN(Job);
   };
 
-  struct JobComparer {
-    bool operator()(const Job& left, const Job& right) {
-      if (left.priority == right.priority)
-        return left.task_count > right.task_count;
-      return left.priority > right.priority;
-    }
+  // A ScheduleTaskCrossThread call parked until the owning sequence
+  // drains the inbox. Heap-allocated by the producer, freed by the
+  // drain (the intrusive queue does not own its elements).
+  struct PendingSchedule : MPSCQueueNode<PendingSchedule> {
+    PendingSchedule(const base::Location& from_here,
+                    InplaceCallback task,
+                    uint32_t priority,
+                    const std::chrono::nanoseconds& interval);
+
+    base::Location from_here;
+    InplaceCallback task;
+    uint32_t priority = 0;
+    std::chrono::nanoseconds interval{};
+
+    // Created by the producer so the caller gets a handle immediately;
+    // adopted by the Job on drain.
+    std::shared_ptr<TaskHandle::State> handle_state;
+
+   private:
+    DISALLOW_COPY_AND_ASSIGN(PendingSchedule);
   };
 
+  // Returns true when |left| must sit below |right| in the heap,
+  // honoring |ordering_mode_|.
+  bool JobBelow(const Job& left, const Job& right) const;
+
+  // Arity of the heap. A 4-ary heap is shallower than a binary one and
+  // keeps the children of a node in one or two cache lines, which makes
+  // sift-down (the common operation here) cheaper in practice.
+  static constexpr size_t kHeapDegree = 4;
+
+  // Updates the timer of |job| and runs its callback if the interval
+  // passed. Does not touch the heap.
+  void RunJob(
+    Job& job
+    , const std::chrono::nanoseconds& current_frame_elapsed_dt
+    , bool* need_stop_repeating_task);
+
+  // Same, but assumes the timer was already advanced this frame
+  // (see RunTasksWithBudget).
+  void RunJobCallback(
+    Job& job
+    , const std::chrono::nanoseconds& current_frame_elapsed_dt
+    , bool* need_stop_repeating_task);
+
+  // Thread pool body of one parallel-safe due job (see
+  // RunAllTasksParallel). |job| and the out-params live in the caller's
+  // frame, which blocks on |done| until |remaining| drops to zero.
+  static void RunParallelJobOnPool(
+    Job* job
+    , std::chrono::nanoseconds current_frame_elapsed_dt
+    , uint8_t* stop_flag
+    , std::atomic<size_t>* remaining
+    , base::WaitableEvent* done);
+
+  // Heap primitives; every move of a Job inside |task_job_heap_| goes
+  // through these so handle back-pointers stay correct.
+  // Sift* return the final index of the sifted job.
+  size_t SiftUp(size_t index);
+  size_t SiftDown(size_t index);
+  void SwapJobs(size_t left_index, size_t right_index);
+  void SetJobIndex(size_t index);
+
+  // Restores the heap property over the whole vector in O(n) (Floyd's
+  // build-heap); back-pointers stay correct since all moves go through
+  // SwapJobs. Used by the bulk operations above.
+  void Heapify();
+
+  // Detaches and returns the job at |index| in O(log n),
+  // restoring the heap property.
+  Job RemoveJobAt(size_t index);
+
+  // Puts a job (back) into the heap. Assigns a fresh |task_count| so jobs
+  // of equal priority round-robin instead of starving each other.
+  void ReinsertJob(Job&& job);
+
   // Accessed on both task_runner_ and the reply task runner.
-  // |std::priority_queue| does not support move-only types,
-  // so we use |std::vector|.
-  std::vector<Job> task_job_heap_;
+  // Kept as an explicit d-ary heap (not std::push_heap/std::pop_heap)
+  // so that element moves can maintain TaskHandle back-pointers.
+  // Allocator degrades to plain new/delete when no arena was given.
+  std::vector<Job, basis::ArenaAllocator<Job>> task_job_heap_;
+
+  const OrderingMode ordering_mode_;
 
   // Used to preserve order of jobs of equal priority.
   /// \note This can overflow and cause periodic priority inversion.
   /// This should be infrequent enough to be of negligible impact.
   uint32_t task_count_ = 0;
 
+  // Off-sequence ScheduleTaskCrossThread calls park jobs here.
+  // |cross_thread_pending_| keeps the empty check to one atomic load
+  // per frame and covers pop()'s mid-push nullptr window (see
+  // MPSCIntrusiveQueue): the drain retries while the counter says an
+  // element is in flight.
+  MPSCIntrusiveQueue<PendingSchedule> cross_thread_inbox_;
+  std::atomic<size_t> cross_thread_pending_{0};
+
   SEQUENCE_CHECKER(sequence_checker_);
 
   DISALLOW_COPY_AND_ASSIGN(PeriodicPrioritizedTaskHeap);
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstdint>
+#include <type_traits>
+
 #include <base/logging.h>
 
 namespace basis {
@@ -26,4 +29,94 @@ Derived polymorphic_downcast(Base base) {
   return static_cast<Derived>(base);
 }
 
+// Opt-in type tags for checked downcasts without RTTI.
+//
+// polymorphic_downcast is only safe when the dynamic type is already
+// known; where it is not, the fallback is dynamic_cast, whose cost
+// (string-compare-based RTTI on some toolchains) is visible in
+// dispatch loops that run millions of casts per second. A tagged
+// hierarchy stores one integer identifying the concrete type, and
+// fast_cast checks it with a single integer compare.
+//
+// The tag identifies the CONCRETE type: fast_cast<T*> succeeds only
+// when the object is exactly a T, not a type derived from T. That is
+// the sealed-event-hierarchy shape this is built for; hierarchies that
+// need cast-to-intermediate-base still want dynamic_cast.
+//
+// EXAMPLE:
+//   class Event : public basis::TypeTagged {
+//    public:
+//     virtual ~Event() = default;
+//    protected:
+//     using TypeTagged::TypeTagged;
+//   };
+//   class MoveEvent : public Event {
+//    public:
+//     static constexpr basis::TypeTag kTypeTag
+//       = basis::makeTypeTag("MoveEvent");
+//     MoveEvent() : Event(kTypeTag) {}
+//     ...
+//   };
+//   ...
+//   void dispatch(Event* event) {
+//     if (MoveEvent* move = basis::fast_cast<MoveEvent*>(event)) {
+//       ...
+using TypeTag = uint32_t;
+
+// Compile-time FNV-1a over the type name; collisions across a real
+// event set are vanishingly unlikely, and an enum of hand-picked ids
+// works just as well where that is preferred.
+constexpr TypeTag makeTypeTag(const char* name) {
+  TypeTag hash = 2166136261u;
+  for (; *name; ++name) {
+    hash ^= static_cast<TypeTag>(static_cast<unsigned char>(*name));
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+// Base holding the stored tag; derive the hierarchy root from it and
+// pass the concrete class's kTypeTag up from each leaf constructor.
+class TypeTagged {
+ public:
+  constexpr TypeTag type_tag() const { return type_tag_; }
+
+ protected:
+  explicit constexpr TypeTagged(const TypeTag type_tag)
+    : type_tag_(type_tag) {}
+
+  // Not for polymorphic deletion; the hierarchy root owns the virtual
+  // destructor if it needs one.
+  ~TypeTagged() = default;
+
+ private:
+  TypeTag type_tag_;
+};
+
+// Checked downcast at the cost of an integer compare: returns the
+// downcast pointer when the object's stored tag matches the concrete
+// type's kTypeTag, nullptr otherwise (the dynamic_cast query shape).
+template <typename Derived, typename Base>
+Derived fast_cast(Base* base) {
+  static_assert(std::is_pointer<Derived>::value,
+                "fast_cast<T*> takes the destination as a pointer type,"
+                " like polymorphic_downcast");
+  using DerivedType =
+      std::remove_cv_t<std::remove_pointer_t<Derived>>;
+  static_assert(std::is_base_of<TypeTagged, DerivedType>::value,
+                "fast_cast needs a TypeTagged hierarchy");
+  if (base == nullptr || base->type_tag() != DerivedType::kTypeTag) {
+    return nullptr;
+  }
+#if DCHECK_IS_ON()
+  // Where RTTI is available, cross-check the tag against the real
+  // dynamic type; a mismatch means two classes share a tag.
+  if constexpr (std::is_polymorphic<
+                  std::remove_cv_t<Base>>::value) {
+    DCHECK(dynamic_cast<Derived>(base) != nullptr);
+  }
+#endif // DCHECK_IS_ON
+  return static_cast<Derived>(base);
+}
+
 }  // namespace basis
@@ -4,11 +4,17 @@
 
 #include "basis/promise/abstract_promise.h" // IWYU pragma: associated
 
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
 #include "base/bind.h"
 #include "base/lazy_instance.h"
 #include "base/sequenced_task_runner.h"
 #include "basis/promise/dependent_list.h"
 #include "basis/promise/post_task_executor.h"
+#include "basis/promise/dispatch_batch.h"
+#include "basis/promise/promise_arena.h"
 #include "base/threading/sequenced_task_runner_handle.h"
 
 namespace base {
@@ -292,6 +298,12 @@ AbstractPromise* AbstractPromise::GetCurriedPromise() {
   return value_.Get<scoped_refptr<AbstractPromise>>()->get();
 }
 
+const AbstractPromise* AbstractPromise::GetCurriedPromise() const {
+  if (!value_.ContainsCurriedPromise())
+    return nullptr;
+  return value_.Get<scoped_refptr<AbstractPromise>>()->get();
+}
+
 const PromiseExecutor* AbstractPromise::GetExecutor() const {
   if (!value_.ContainsPromiseExecutor())
     return nullptr;
@@ -448,7 +460,14 @@ void AbstractPromise::OnResolveDispatchReadyDependents() {
   };
 
   Visitor visitor(this);
-  dependents_.ResolveAndConsumeAllDependents(&visitor);
+  if (PromiseDispatchBatch::IsBatchingEnabled()) {
+    // Collect the ready dependents and post at most one task per destination
+    // runner when |batch| closes, instead of one task per dependent.
+    PromiseDispatchBatch batch;
+    dependents_.ResolveAndConsumeAllDependents(&visitor);
+  } else {
+    dependents_.ResolveAndConsumeAllDependents(&visitor);
+  }
 }
 
 void AbstractPromise::OnRejectDispatchReadyDependents() {
@@ -465,7 +484,12 @@ void AbstractPromise::OnRejectDispatchReadyDependents() {
   };
 
   Visitor visitor(this);
-  dependents_.RejectAndConsumeAllDependents(&visitor);
+  if (PromiseDispatchBatch::IsBatchingEnabled()) {
+    PromiseDispatchBatch batch;
+    dependents_.RejectAndConsumeAllDependents(&visitor);
+  } else {
+    dependents_.RejectAndConsumeAllDependents(&visitor);
+  }
 }
 
 void AbstractPromise::OnResolveMakeDependantsUseCurriedPrerequisite(
@@ -513,8 +537,26 @@ void AbstractPromise::OnRejectMakeDependantsUseCurriedPrerequisite(
 }
 
 void AbstractPromise::DispatchPromise() {
-  if (task_runner_) {
-    task_runner_->PostDelayedTask(
+  if (execution_context_) {
+    TaskRunner* task_runner = execution_context_->task_runner().get();
+    // Opt-in fast path: if the prerequisite settled on the sequence we would
+    // post to anyway, skip the task queue round trip and run synchronously.
+    // This collapses Then chains on already-resolved promises into plain
+    // function calls.
+    if (inline_dispatch_allowed_ &&
+        task_runner->RunsTasksInCurrentSequence()) {
+      Execute();
+      return;
+    }
+    // When a dispatch batch is open (fan-out settlement with batching
+    // enabled) defer to it so dependents sharing a destination runner are
+    // posted as a single task.
+    if (PromiseDispatchBatch* batch =
+            PromiseDispatchBatch::GetActiveForCurrentThread()) {
+      batch->Add(execution_context_->task_runner(), this);
+      return;
+    }
+    task_runner->PostDelayedTask(
       from_here_
       , BindOnce([](WrappedPromise promise) { promise.Execute(); },
                std::move(WrappedPromise(this))),
@@ -557,6 +599,39 @@ void AbstractPromise::OnCanceled() {
     prerequisites_->Clear();
 }
 
+void AbstractPromise::CancelUnsettledPrerequisiteChains(
+    AbstractPromise* settled_prerequisite) {
+  if (!prerequisites_)
+    return;
+  for (DependentList::Node& node : *prerequisites_->prerequisite_list()) {
+    AbstractPromise* prerequisite = node.prerequisite();
+    if (!prerequisite || prerequisite == settled_prerequisite)
+      continue;
+    prerequisite->CancelChainUpward();
+  }
+}
+
+void AbstractPromise::CancelChainUpward() {
+  if (IsSettled())
+    return;
+
+  // Collect the unsettled ancestors first because OnCanceled() clears
+  // |prerequisites_|. Holding refs keeps them alive across the cancellation
+  // of their (possibly only) dependent.
+  std::vector<scoped_refptr<AbstractPromise>> ancestors;
+  if (prerequisites_) {
+    for (DependentList::Node& node : *prerequisites_->prerequisite_list()) {
+      if (node.prerequisite())
+        ancestors.emplace_back(node.prerequisite());
+    }
+  }
+
+  OnCanceled();
+
+  for (scoped_refptr<AbstractPromise>& ancestor : ancestors)
+    ancestor->CancelChainUpward();
+}
+
 AbstractPromise* AbstractPromise::FindCurriedAncestor() {
   AbstractPromise* promise = this;
   while (promise->IsSettled()) {
@@ -627,16 +702,102 @@ void AbstractPromise::OnRejected() {
     prerequisites_->Clear();
 }
 
-AbstractPromise::AdjacencyList::AdjacencyList() = default;
+// static
+void* AbstractPromise::operator new(size_t size) {
+  return PromiseArena::Allocate(size);
+}
+
+// static
+void AbstractPromise::operator delete(void* ptr) {
+  PromiseArena::Delete(ptr);
+}
+
+// static
+void* AbstractPromise::AdjacencyList::operator new(size_t size) {
+  return PromiseArena::Allocate(size);
+}
+
+// static
+void AbstractPromise::AdjacencyList::operator delete(void* ptr) {
+  PromiseArena::Delete(ptr);
+}
+
+PromiseExecutionContext::PromiseExecutionContext(
+    scoped_refptr<TaskRunner> task_runner)
+    : task_runner_(std::move(task_runner)) {
+  DCHECK(task_runner_);
+}
+
+PromiseExecutionContext::~PromiseExecutionContext() = default;
+
+// static
+void* PromiseExecutionContext::operator new(size_t size) {
+  return PromiseArena::Allocate(size);
+}
+
+// static
+void PromiseExecutionContext::operator delete(void* ptr) {
+  PromiseArena::Delete(ptr);
+}
+
+// static
+scoped_refptr<PromiseExecutionContext> AbstractPromise::
+    AcquireExecutionContext(const scoped_refptr<TaskRunner>& task_runner,
+                            AdjacencyList* prerequisites) {
+  if (!task_runner)
+    return nullptr;
+  // Linear Then chains have exactly one prerequisite; when it targets the
+  // same runner, borrow its context so the chain shares a single runner
+  // reference. The prerequisite's |execution_context_| is immutable after
+  // construction, so this read is safe even if the prerequisite is
+  // settling on another thread.
+  if (prerequisites && prerequisites->prerequisite_list()->size() == 1) {
+    AbstractPromise* prerequisite =
+        (*prerequisites->prerequisite_list())[0].prerequisite();
+    if (prerequisite && prerequisite->execution_context_ &&
+        prerequisite->execution_context_->task_runner() == task_runner) {
+      return prerequisite->execution_context_;
+    }
+  }
+  return MakeRefCounted<PromiseExecutionContext>(task_runner);
+}
+
+DependentList::Node* AbstractPromise::AdjacencyList::InlineNodeAllocator::
+    allocate(size_t count) {
+  if (count == 1 && !owner_->inline_node_used_) {
+    owner_->inline_node_used_ = true;
+    return reinterpret_cast<DependentList::Node*>(
+        &owner_->inline_node_storage_);
+  }
+  return static_cast<DependentList::Node*>(
+      ::operator new(count * sizeof(DependentList::Node)));
+}
+
+void AbstractPromise::AdjacencyList::InlineNodeAllocator::deallocate(
+    DependentList::Node* ptr,
+    size_t count) {
+  if (ptr == reinterpret_cast<DependentList::Node*>(
+                 &owner_->inline_node_storage_)) {
+    owner_->inline_node_used_ = false;
+    return;
+  }
+  ::operator delete(ptr);
+}
+
+AbstractPromise::AdjacencyList::AdjacencyList()
+    : prerequisite_list_(InlineNodeAllocator(this)) {}
 
 AbstractPromise::AdjacencyList::AdjacencyList(AbstractPromise* prerequisite)
-    : prerequisite_list_(1), action_prerequisite_count_(1) {
+    : prerequisite_list_(1, InlineNodeAllocator(this)),
+      action_prerequisite_count_(1) {
   prerequisite_list_[0].SetPrerequisite(prerequisite);
 }
 
 AbstractPromise::AdjacencyList::AdjacencyList(
     std::vector<DependentList::Node> nodes)
-    : prerequisite_list_(std::move(nodes)),
+    : prerequisite_list_(std::make_move_iterator(nodes.begin()),
+                         std::make_move_iterator(nodes.end()),
+                         InlineNodeAllocator(this)),
       action_prerequisite_count_(prerequisite_list_.size()) {}
 
 AbstractPromise::AdjacencyList::~AdjacencyList() = default;
@@ -672,6 +833,20 @@ void AbstractPromise::AdjacencyList::RemoveCanceledPrerequisite(
                << canceled_prerequisite->from_here().ToString();
 }
 
+size_t AbstractPromise::AdjacencyList::EstimateMemoryUsage() const {
+  size_t usage = sizeof(*this);
+  // |prerequisite_list_| only owns a heap block when it outgrew the inline
+  // node slot (multi-prerequisite Alls and Races). Clear() keeps capacity,
+  // so account for capacity rather than size.
+  const DependentList::Node* inline_storage =
+      reinterpret_cast<const DependentList::Node*>(&inline_node_storage_);
+  if (prerequisite_list_.capacity() > 0 &&
+      prerequisite_list_.data() != inline_storage) {
+    usage += prerequisite_list_.capacity() * sizeof(DependentList::Node);
+  }
+  return usage;
+}
+
 void AbstractPromise::AdjacencyList::Clear() {
   // If there's only one prerequisite we can just clear |prerequisite_list_|
   // which deals with potential refcounting cycles due to curried promises.
@@ -688,6 +863,58 @@ void AbstractPromise::AdjacencyList::Clear() {
   }
 }
 
+size_t AbstractPromise::EstimateMemoryUsageLocal() const {
+  size_t usage = sizeof(*this) + value_.EstimateMemoryUsage();
+  if (prerequisites_)
+    usage += prerequisites_->EstimateMemoryUsage();
+  // The execution context is shared along the chain (see
+  // AcquireExecutionContext); attribute it to the link that created it
+  // rather than to every link that borrowed it.
+  if (execution_context_) {
+    bool borrowed = false;
+    const PrerequisiteList* prerequisite_list = this->prerequisite_list();
+    if (prerequisite_list && prerequisite_list->size() == 1) {
+      AbstractPromise* prerequisite = (*prerequisite_list)[0].prerequisite();
+      borrowed =
+          prerequisite && prerequisite->execution_context_ == execution_context_;
+    }
+    if (!borrowed)
+      usage += sizeof(PromiseExecutionContext);
+  }
+  return usage;
+}
+
+size_t AbstractPromise::EstimateMemoryUsage() const {
+  // Iterative walk over the prerequisite graph. Prerequisites form a DAG
+  // (a promise can be a prerequisite of several Alls/Races), so track
+  // visited nodes to avoid double counting. Dependents are not walked:
+  // DependentList is consume-once and not safely iterable, and dependents
+  // hold this promise alive rather than the other way round.
+  std::vector<const AbstractPromise*> visited;
+  std::vector<const AbstractPromise*> to_visit{this};
+  size_t usage = 0;
+  while (!to_visit.empty()) {
+    const AbstractPromise* promise = to_visit.back();
+    to_visit.pop_back();
+    if (std::find(visited.begin(), visited.end(), promise) != visited.end())
+      continue;
+    visited.push_back(promise);
+    usage += promise->EstimateMemoryUsageLocal();
+
+    if (const AbstractPromise* curried = promise->GetCurriedPromise())
+      to_visit.push_back(curried);
+
+    const PrerequisiteList* prerequisite_list = promise->prerequisite_list();
+    if (!prerequisite_list)
+      continue;
+    for (const DependentList::Node& node : *prerequisite_list) {
+      if (const AbstractPromise* prerequisite = node.prerequisite())
+        to_visit.push_back(prerequisite);
+    }
+  }
+  return usage;
+}
+
 BasePromise::BasePromise() = default;
 
 BasePromise::BasePromise(
@@ -4,12 +4,15 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <utility>
 
 #include "base/location.h"
 #include "base/macros.h"
 #include "base/memory/ref_counted.h"
 #include "base/no_destructor.h"
+#include "base/sequence_checker.h"
 #include "base/task/common/checked_lock.h"
 #include "basis/promise/dependent_list.h"
 #include "basis/promise/promise_executor.h"
@@ -333,16 +336,56 @@ class BASE_EXPORT PassedPromise {
   AbstractPromise* promise_;
 };
 
+// Holds the destination TaskRunner for one promise chain. Every link of a
+// ThenOn chain used to hold its own scoped_refptr<TaskRunner>, so building
+// an N-link chain bumped and dropped the runner's refcount N times — and
+// that refcount lives on a cache line shared by every chain targeting the
+// same runner, which is contended when chains are built at high rates.
+// Instead consecutive links targeting the same runner now share one
+// context: the runner's refcount is touched once per chain, and each link
+// only refcounts the chain-local context (an uncontended cache line,
+// typically carved out of the same PromiseArena as the chain itself).
+// Immutable after construction, so task_runner() is safe from any thread.
+class BASE_EXPORT PromiseExecutionContext
+    : public RefCountedThreadSafe<PromiseExecutionContext> {
+ public:
+  explicit PromiseExecutionContext(scoped_refptr<TaskRunner> task_runner);
+
+  // Like AbstractPromise, placed inside the thread's current PromiseArena
+  // when one is installed.
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr);
+
+  const scoped_refptr<TaskRunner>& task_runner() const {
+    return task_runner_;
+  }
+
+ private:
+  friend class base::RefCountedThreadSafe<PromiseExecutionContext>;
+  ~PromiseExecutionContext();
+
+  const scoped_refptr<TaskRunner> task_runner_;
+
+  DISALLOW_COPY_AND_ASSIGN(PromiseExecutionContext);
+};
+
 // Internal promise representation, maintains a graph of dependencies and posts
 // promises as they become ready. In debug builds various sanity checks are
 // performed to catch common errors such as double move or forgetting to catch a
 // potential reject (NB this last check can be turned off with
 // RejectPolicy::kCatchNotRequired).
-class BASE_EXPORT AbstractPromise
-    : public RefCountedThreadSafe<AbstractPromise> {
+class BASE_EXPORT AbstractPromise {
  public:
   class AdjacencyList;
 
+  // |sequence_confined| declares that this promise (and every reference to
+  // it) will only ever be touched from the sequence it is created on. In
+  // exchange AddRef()/Release() use plain loads and stores instead of
+  // lock-prefixed read-modify-writes and DependentList skips its CAS loops,
+  // which matters because every link of a chain bumps the refcount of its
+  // neighbours several times. The claim is enforced with a sequence checker
+  // in DCHECK builds; it is the caller's responsibility that prerequisites
+  // of a confined promise settle on the same sequence.
   template <typename ConstructType>
   static scoped_refptr<AbstractPromise> Create(
       const scoped_refptr<TaskRunner>& task_runner,
@@ -350,11 +393,17 @@ class BASE_EXPORT AbstractPromise
       std::unique_ptr<AdjacencyList> prerequisites,
       RejectPolicy reject_policy,
       ConstructType tag,
-      PromiseExecutor::Data&& executor_data) noexcept {
+      PromiseExecutor::Data&& executor_data,
+      bool inline_dispatch_allowed = false,
+      bool sequence_confined = false) noexcept {
     scoped_refptr<AbstractPromise> promise = subtle::AdoptRefIfNeeded(
         new AbstractPromise(task_runner, from_here, std::move(prerequisites),
-                            reject_policy, tag, std::move(executor_data)),
+                            reject_policy, tag, std::move(executor_data),
+                            sequence_confined),
         AbstractPromise::kRefCountPreference);
+    // Must be set before AddAsDependentForAllPrerequisites() because an
+    // already settled prerequisite dispatches us from within that call.
+    promise->inline_dispatch_allowed_ = inline_dispatch_allowed;
     // It's important this is called after |promise| has been initialized
     // because otherwise it could trigger a scoped_refptr destructor on another
     // thread before this thread has had a chance to increment the refcount.
@@ -378,8 +427,60 @@ class BASE_EXPORT AbstractPromise
   AbstractPromise(const AbstractPromise&) = delete;
   AbstractPromise& operator=(const AbstractPromise&) = delete;
 
+  // Routed through PromiseArena so whole promise chains can be carved out of
+  // one arena (see basis/promise/promise_arena.h). Falls back to the regular
+  // heap when no ScopedPromiseArena is installed on the allocating thread.
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr);
+
+  // Hand-rolled refcounting (rather than RefCountedThreadSafe) so that
+  // sequence-confined promises can use non-atomic increments, see Create().
+  // Matches RefCountedThreadSafe's default start-from-zero behaviour.
+  static constexpr subtle::StartRefCountFromZeroTag kRefCountPreference =
+      subtle::kStartRefCountFromZeroTag;
+
+  void AddRef() const {
+    if (sequence_confined_) {
+      DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+      // Plain load/store; no other thread may touch a sequence-confined
+      // promise (enforced by the sequence checker in DCHECK builds).
+      ref_count_.store(ref_count_.load(std::memory_order_relaxed) + 1,
+                       std::memory_order_relaxed);
+      return;
+    }
+    ref_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void Release() const {
+    if (sequence_confined_) {
+      DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+      const uint32_t new_count =
+          ref_count_.load(std::memory_order_relaxed) - 1;
+      ref_count_.store(new_count, std::memory_order_relaxed);
+      if (new_count == 0)
+        delete this;
+      return;
+    }
+    if (ref_count_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      delete this;
+  }
+
+  bool HasOneRef() const {
+    return ref_count_.load(std::memory_order_acquire) == 1;
+  }
+
   const Location& from_here() const { return from_here_; }
 
+  // Estimates memory usage (in bytes) of this promise and everything it
+  // keeps alive: out-of-line value payloads, AdjacencyLists, transitive
+  // prerequisites, curried promises and the execution context of the link
+  // that created it. Follows the T::EstimateMemoryUsage() convention (see
+  // base/trace_event/memory_usage_estimator.h). Allocations owned by
+  // resolved values or by bound callback state are type-erased and not
+  // visible here. Only meaningful while the graph is not being
+  // concurrently mutated; a racing settle can make the estimate stale.
+  size_t EstimateMemoryUsage() const;
+
   bool IsSettled() const { return dependents_.IsSettled(); }
   bool IsCanceled() const;
 
@@ -402,6 +503,16 @@ class BASE_EXPORT AbstractPromise
     return value_;
   }
 
+  // Mutable access to the settled value, for executors that construct
+  // their result directly from the stored value (see
+  // TupleConstructor::GetResolvedValueRefFromPromise). Unlike
+  // TakeValue() this performs no DCHECK-build reset, so the reference
+  // stays valid for the whole consuming expression.
+  PromiseValue& value() {
+    DCHECK(!IsResolvedWithPromise());
+    return value_;
+  }
+
   class ValueHandle {
    public:
     PromiseValue& value() { return value_; }
@@ -451,9 +562,56 @@ class BASE_EXPORT AbstractPromise
   // regular PostTask without promise chains.
   class BASE_EXPORT AdjacencyList {
    public:
+    // The overwhelming majority of promises have exactly one
+    // prerequisite (linear Then chains), and with AbstractPromise and
+    // AdjacencyList themselves carved out of the PromiseArena, the
+    // backing store of |prerequisite_list_| was the last malloc left on
+    // the chain-building path. This allocator serves a single-node
+    // request from a slot embedded in the owning AdjacencyList and only
+    // falls back to the heap for multi-prerequisite promises (Alls and
+    // Races). Not thread safe, like the list structure it backs:
+    // prerequisites are only set up while the dependent promise is
+    // being constructed.
+    class BASE_EXPORT InlineNodeAllocator {
+     public:
+      using value_type = DependentList::Node;
+
+      // Identity rebind; allocator_traits requires it for non-template
+      // allocators. Only ever instantiated with Node.
+      template <typename U>
+      struct rebind {
+        static_assert(std::is_same<U, DependentList::Node>::value,
+                      "InlineNodeAllocator only allocates Nodes");
+        using other = InlineNodeAllocator;
+      };
+
+      explicit InlineNodeAllocator(AdjacencyList* owner) : owner_(owner) {}
+
+      DependentList::Node* allocate(size_t count);
+      void deallocate(DependentList::Node* ptr, size_t count);
+
+      bool operator==(const InlineNodeAllocator& other) const {
+        return owner_ == other.owner_;
+      }
+      bool operator!=(const InlineNodeAllocator& other) const {
+        return !(*this == other);
+      }
+
+     private:
+      AdjacencyList* owner_;
+    };
+
+    using PrerequisiteList =
+        std::vector<DependentList::Node, InlineNodeAllocator>;
+
     AdjacencyList();
     ~AdjacencyList();
 
+    // Like AbstractPromise itself, AdjacencyLists are placed inside the
+    // thread's current PromiseArena when one is installed.
+    static void* operator new(size_t size);
+    static void operator delete(void* ptr);
+
     explicit AdjacencyList(AbstractPromise* prerequisite);
     explicit AdjacencyList(std::vector<DependentList::Node> prerequisite_list);
 
@@ -471,10 +629,15 @@ class BASE_EXPORT AbstractPromise
     // called.
     void RemoveCanceledPrerequisite(AbstractPromise* canceled_prerequisite);
 
-    std::vector<DependentList::Node>* prerequisite_list() {
+    PrerequisiteList* prerequisite_list() {
       return &prerequisite_list_;
     }
 
+    // Estimates memory usage (in bytes) of this AdjacencyList plus the
+    // heap backing of |prerequisite_list_|, which is zero for
+    // single-prerequisite promises served from the inline node slot.
+    size_t EstimateMemoryUsage() const;
+
     AbstractPromise* GetFirstSettledPrerequisite() const {
       return reinterpret_cast<AbstractPromise*>(
           first_settled_prerequisite_.load(std::memory_order_acquire));
@@ -483,7 +646,17 @@ class BASE_EXPORT AbstractPromise
     void Clear();
 
    private:
-    std::vector<DependentList::Node> prerequisite_list_;
+    friend class InlineNodeAllocator;
+
+    // Backing store handed out by InlineNodeAllocator. Declared before
+    // |prerequisite_list_| so it is live before the vector's first
+    // allocation.
+    typename std::aligned_storage<sizeof(DependentList::Node),
+                                  alignof(DependentList::Node)>::type
+        inline_node_storage_;
+    bool inline_node_used_ = false;
+
+    PrerequisiteList prerequisite_list_;
 
     // PrerequisitePolicy::kAny waits for at most 1 resolve or N cancellations.
     // PrerequisitePolicy::kAll waits for N resolves or at most 1 cancellation.
@@ -497,7 +670,9 @@ class BASE_EXPORT AbstractPromise
     std::atomic<uintptr_t> first_settled_prerequisite_{0};
   };
 
-  const std::vector<DependentList::Node>* prerequisite_list() const {
+  using PrerequisiteList = AdjacencyList::PrerequisiteList;
+
+  const PrerequisiteList* prerequisite_list() const {
     if (!prerequisites_)
       return nullptr;
     return prerequisites_->prerequisite_list();
@@ -507,7 +682,7 @@ class BASE_EXPORT AbstractPromise
   // call this if the number of prerequisites isn't exactly one.
   AbstractPromise* GetOnlyPrerequisite() const {
     DCHECK(prerequisites_);
-    const std::vector<DependentList::Node>* prerequisite_list =
+    const PrerequisiteList* prerequisite_list =
         prerequisites_->prerequisite_list();
     DCHECK_EQ(prerequisite_list->size(), 1u);
     return (*prerequisite_list)[0].prerequisite();
@@ -531,9 +706,16 @@ class BASE_EXPORT AbstractPromise
   // OnRejected() has already run, this does nothing.
   void OnCanceled();
 
- private:
-  friend base::RefCountedThreadSafe<AbstractPromise>;
+  // Eagerly cancels the losing branches of a settled race: every
+  // prerequisite other than |settled_prerequisite| that hasn't settled yet is
+  // canceled via OnCanceled(), and so - recursively - are its own unsettled
+  // ancestors. Note cancellation also reaches any other dependents hanging
+  // off those chains (the usual OnCanceled() semantics), so this is only
+  // called by race executors where the losing chains are expected to be
+  // exclusive to the race (e.g. redundant backend queries).
+  void CancelUnsettledPrerequisiteChains(AbstractPromise* settled_prerequisite);
 
+ private:
   friend class AbstractPromiseTest;
 
   template <typename ResolveType, typename RejectType>
@@ -548,8 +730,11 @@ class BASE_EXPORT AbstractPromise
                   std::unique_ptr<AdjacencyList> prerequisites,
                   RejectPolicy reject_policy,
                   ConstructType tag,
-                  PromiseExecutor::Data&& executor_data) noexcept
-      : task_runner_(task_runner),
+                  PromiseExecutor::Data&& executor_data,
+                  bool sequence_confined = false) noexcept
+      : sequence_confined_(sequence_confined),
+        execution_context_(
+            AcquireExecutionContext(task_runner, prerequisites.get())),
         from_here_(std::move(from_here)),
         value_(in_place_type_t<PromiseExecutor>(), std::move(executor_data)),
 #if DCHECK_IS_ON()
@@ -563,6 +748,8 @@ class BASE_EXPORT AbstractPromise
 #endif
         dependents_(tag),
         prerequisites_(std::move(prerequisites)) {
+    if (sequence_confined_)
+      dependents_.SetSequenceConfined();
 #if DCHECK_IS_ON()
     {
       CheckedAutoLock lock(GetCheckedLock());
@@ -598,6 +785,10 @@ class BASE_EXPORT AbstractPromise
   // scheduled for execution.
   void OnRejected();
 
+  // Cancels this promise (if unsettled) and walks up the prerequisite graph
+  // canceling unsettled ancestors. See CancelUnsettledPrerequisiteChains().
+  void CancelChainUpward();
+
   // Returns the curried promise if there is one or null otherwise.
   AbstractPromise* GetCurriedPromise();
 
@@ -661,10 +852,40 @@ class BASE_EXPORT AbstractPromise
   void ReplaceCurriedPrerequisite(AbstractPromise* curried_prerequisite,
                                   AbstractPromise* replacement);
 
-  scoped_refptr<TaskRunner> task_runner_;
+  // Returns the context to store in |execution_context_|: the single
+  // prerequisite's context when it targets the same |task_runner| (the
+  // common linear-chain case), a fresh one otherwise, or null when
+  // |task_runner| is null.
+  static scoped_refptr<PromiseExecutionContext> AcquireExecutionContext(
+      const scoped_refptr<TaskRunner>& task_runner,
+      AdjacencyList* prerequisites);
+
+  // Memory owned directly by this promise (no graph traversal);
+  // EstimateMemoryUsage() sums this over the reachable graph.
+  size_t EstimateMemoryUsageLocal() const;
+
+  // See Create(). Immutable after construction.
+  const bool sequence_confined_;
+
+  mutable std::atomic<uint32_t> ref_count_{0};
+
+  // Only consulted for sequence-confined promises, where it backs the
+  // non-atomic AddRef()/Release() and DependentList fast paths.
+  SEQUENCE_CHECKER(sequence_checker_);
+
+  // Destination runner, borrowed through a context shared by consecutive
+  // links of the chain that target the same runner (see
+  // PromiseExecutionContext). Null for promises executed synchronously.
+  scoped_refptr<PromiseExecutionContext> execution_context_;
 
   const Location from_here_;
 
+  // If true DispatchPromise() may run the executor synchronously instead of
+  // posting it when the current thread already runs tasks on |task_runner_|'s
+  // sequence. Opted into via e.g. Promise::ThenHereInline. Set before
+  // AddAsDependentForAllPrerequisites() and immutable afterwards.
+  bool inline_dispatch_allowed_ = false;
+
   // To save memory |value_| contains Executor (which is stored inline) before
   // it has run and afterwards it contains one of:
   // * Resolved<T>
@@ -150,6 +150,8 @@ class AbstractPromiseTest : public testing::Test {
     base::OnceCallback<void(AbstractPromise*)> callback;
 
     scoped_refptr<TaskRunner> task_runner = ThreadTaskRunnerHandle::Get();
+
+    bool sequence_confined = false;
   };
 
   class PromiseSettingsBuilder {
@@ -214,6 +216,11 @@ class AbstractPromiseTest : public testing::Test {
       return *this;
     }
 
+    PromiseSettingsBuilder& SequenceConfined() {
+      settings.sequence_confined = true;
+      return *this;
+    }
+
     operator scoped_refptr<AbstractPromise>() {
       switch (settings.prerequisite_policy) {
         case PrerequisitePolicy::kAll:
@@ -243,7 +250,9 @@ class AbstractPromiseTest : public testing::Test {
                                 std::move(settings.prerequisites),
                                 settings.reject_policy,
                                 DependentList::ConstructUnresolved(),
-                                std::move(executor_data)))
+                                std::move(executor_data),
+                                /* inline_dispatch_allowed */ false,
+                                settings.sequence_confined))
           .TakeForTesting();
     }
 
@@ -709,6 +718,104 @@ TEST_F(AbstractPromiseTest, MultipleResolvedPrerequisitePolicyALL) {
   EXPECT_TRUE(all_promise->IsResolvedForTesting());
 }
 
+#if !DCHECK_IS_ON()
+TEST_F(AbstractPromiseTest, InertDoNothingPromiseIsShared) {
+  // Promises that can neither resolve nor reject carry no state in release
+  // builds and are served from one shared instance (see
+  // NoOpPromiseExecutor::Create).
+  scoped_refptr<AbstractPromise> p1 = DoNothingPromiseBuilder(FROM_HERE);
+  scoped_refptr<AbstractPromise> p2 = DoNothingPromiseBuilder(FROM_HERE);
+  EXPECT_EQ(p1.get(), p2.get());
+
+  // A promise that may settle is stateful and must stay per-call-site.
+  scoped_refptr<AbstractPromise> p3 =
+      DoNothingPromiseBuilder(FROM_HERE).SetCanResolve(true);
+  EXPECT_NE(p1.get(), p3.get());
+}
+#endif
+
+TEST_F(AbstractPromiseTest, SingleResolvedPrerequisitePolicyALL) {
+  // A single-element prerequisite list lands in AdjacencyList's inline
+  // node slot (see AdjacencyList::InlineNodeAllocator); make sure that
+  // path settles like any other ALL promise.
+  scoped_refptr<AbstractPromise> p1 =
+      DoNothingPromiseBuilder(FROM_HERE).SetCanResolve(true);
+
+  std::vector<internal::DependentList::Node> prerequisite_list(1);
+  prerequisite_list[0].SetPrerequisite(p1.get());
+
+  scoped_refptr<AbstractPromise> all_promise =
+      AllPromise(FROM_HERE, std::move(prerequisite_list));
+
+  RunLoop().RunUntilIdle();
+  EXPECT_FALSE(all_promise->IsResolvedForTesting());
+
+  OnResolved(p1);
+  RunLoop().RunUntilIdle();
+  EXPECT_TRUE(all_promise->IsResolvedForTesting());
+}
+
+TEST_F(AbstractPromiseTest, EstimateMemoryUsage) {
+  scoped_refptr<AbstractPromise> p0 = ThenPromise(FROM_HERE, nullptr);
+  const size_t single_usage = p0->EstimateMemoryUsage();
+  EXPECT_GE(single_usage, sizeof(AbstractPromise));
+
+  // The estimate walks transitive prerequisites, so each extra link grows
+  // the estimate of the handle at the end of the chain.
+  scoped_refptr<AbstractPromise> p1 = ThenPromise(FROM_HERE, p0);
+  scoped_refptr<AbstractPromise> p2 = ThenPromise(FROM_HERE, p1);
+  EXPECT_GT(p1->EstimateMemoryUsage(), single_usage);
+  EXPECT_GT(p2->EstimateMemoryUsage(), p1->EstimateMemoryUsage());
+
+  // A diamond counts a shared prerequisite once. Compare two structurally
+  // identical ALL promises, one whose branches share a root and one whose
+  // branches have distinct roots: the estimates differ by exactly one
+  // root promise.
+  scoped_refptr<AbstractPromise> shared_root = ThenPromise(FROM_HERE, nullptr);
+  std::vector<internal::DependentList::Node> shared_list(2);
+  scoped_refptr<AbstractPromise> shared_a =
+      ThenPromise(FROM_HERE, shared_root);
+  scoped_refptr<AbstractPromise> shared_b =
+      ThenPromise(FROM_HERE, shared_root);
+  shared_list[0].SetPrerequisite(shared_a.get());
+  shared_list[1].SetPrerequisite(shared_b.get());
+  scoped_refptr<AbstractPromise> shared_all =
+      AllPromise(FROM_HERE, std::move(shared_list));
+
+  scoped_refptr<AbstractPromise> root_a = ThenPromise(FROM_HERE, nullptr);
+  scoped_refptr<AbstractPromise> root_b = ThenPromise(FROM_HERE, nullptr);
+  std::vector<internal::DependentList::Node> distinct_list(2);
+  scoped_refptr<AbstractPromise> distinct_a = ThenPromise(FROM_HERE, root_a);
+  scoped_refptr<AbstractPromise> distinct_b = ThenPromise(FROM_HERE, root_b);
+  distinct_list[0].SetPrerequisite(distinct_a.get());
+  distinct_list[1].SetPrerequisite(distinct_b.get());
+  scoped_refptr<AbstractPromise> distinct_all =
+      AllPromise(FROM_HERE, std::move(distinct_list));
+
+  EXPECT_EQ(distinct_all->EstimateMemoryUsage(),
+            shared_all->EstimateMemoryUsage() + single_usage);
+
+  OnCanceled(shared_all);
+  OnCanceled(distinct_all);
+}
+
+TEST_F(AbstractPromiseTest, SequenceConfinedChainResolves) {
+  // Sequence-confined promises use non-atomic refcounts and the plain-store
+  // paths in DependentList instead of the CAS loops. A confined chain must
+  // still settle and dispatch in order like a regular one.
+  scoped_refptr<AbstractPromise> p0 =
+      ThenPromise(FROM_HERE, nullptr).SequenceConfined();
+  scoped_refptr<AbstractPromise> p1 =
+      ThenPromise(FROM_HERE, p0).SequenceConfined();
+  scoped_refptr<AbstractPromise> p2 =
+      ThenPromise(FROM_HERE, p1).SequenceConfined();
+
+  OnResolved(p0);
+  RunLoop().RunUntilIdle();
+  EXPECT_TRUE(p1->IsResolvedForTesting());
+  EXPECT_TRUE(p2->IsResolvedForTesting());
+}
+
 TEST_F(AbstractPromiseTest,
        MultithreadedMultipleResolvedPrerequisitePolicyALL) {
   constexpr int num_threads = 4;
@@ -31,7 +31,7 @@ class AllTuplePromiseExecutor {
       return;
     }
 
-    const std::vector<DependentList::Node>* prerequisite_list =
+    const AbstractPromise::PrerequisiteList* prerequisite_list =
         promise->prerequisite_list();
     DCHECK(prerequisite_list);
     TupleConstructor<ResolveTuple>::ConstructResolvedTuple(prerequisite_list, promise);
@@ -0,0 +1,272 @@
+// Copyright 2019 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#pragma once
+
+// Coroutine support for base::Promise<>.
+//
+// Including this header lets code `co_await` a Promise and write coroutines
+// returning a Promise, collapsing what used to be a stack of ThenHere lambdas
+// (one callback allocation plus bind state per link) into a single coroutine
+// frame:
+//
+//   Promise<int> LoadAndParse() {
+//     std::string raw = co_await LoadHere(FROM_HERE, path);
+//     co_return Parse(raw);
+//   }
+//
+// Awaiting a Promise<T, NoReject> yields T. Awaiting a rejectable
+// Promise<T, E> yields a PromiseAwaitResult<T, E> - an expected-like value -
+// because this codebase does not use exceptions for control flow:
+//
+//   PromiseAwaitResult<Reply, Error> result = co_await backend_query;
+//   if (!result.ok())
+//     co_return MakeFallback(result.error());
+//
+// The awaiting coroutine is resumed on the sequence it suspended on (the
+// continuation is attached with ThenHere), so co_await may only be used on
+// threads with a SequencedTaskRunnerHandle, same as ThenHere.
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#define BASIS_COROUTINE_NAMESPACE std
+#elif defined(__cpp_coroutines) && __has_include(<experimental/coroutine>)
+#include <experimental/coroutine>
+#define BASIS_COROUTINE_NAMESPACE std::experimental
+#else
+#error "basis/promise/co_await.h requires compiler coroutine support \
+(-fcoroutines / -fcoroutines-ts)"
+#endif
+
+#include <utility>
+
+#include "base/bind.h"
+#include "base/callback.h"
+#include "base/logging.h"
+#include "base/optional.h"
+#include "basis/promise/promise.h"
+
+namespace base {
+
+// Expected-like result of awaiting a rejectable promise. Exactly one of
+// value()/error() is set.
+template <typename ResolveType, typename RejectType>
+class PromiseAwaitResult {
+ public:
+  struct ResolvedTag {};
+  struct RejectedTag {};
+
+  template <typename... Args>
+  PromiseAwaitResult(ResolvedTag, Args&&... args)
+      : value_(in_place, std::forward<Args>(args)...) {}
+
+  template <typename... Args>
+  PromiseAwaitResult(RejectedTag, Args&&... args)
+      : error_(in_place, std::forward<Args>(args)...) {}
+
+  bool ok() const { return value_.has_value(); }
+
+  ResolveType& value() {
+    DCHECK(value_.has_value());
+    return *value_;
+  }
+
+  RejectType& error() {
+    DCHECK(error_.has_value());
+    return *error_;
+  }
+
+  ResolveType TakeValue() {
+    DCHECK(value_.has_value());
+    return std::move(*value_);
+  }
+
+  RejectType TakeError() {
+    DCHECK(error_.has_value());
+    return std::move(*error_);
+  }
+
+ private:
+  Optional<ResolveType> value_;
+  Optional<RejectType> error_;
+};
+
+namespace internal {
+
+// Awaiter for Promise<ResolveType, NoReject>. Implemented purely in terms of
+// the public ThenHere API so the inline fast path (ThenHereInline) and all
+// DCHECK based API misuse detection keep working.
+template <typename ResolveType>
+class PromiseAwaiter {
+ public:
+  using Handle = BASIS_COROUTINE_NAMESPACE::coroutine_handle<>;
+
+  explicit PromiseAwaiter(Promise<ResolveType, NoReject> promise)
+      : promise_(std::move(promise)) {}
+
+  bool await_ready() const noexcept { return false; }
+
+  void await_suspend(Handle handle) {
+    // |this| lives in the suspended coroutine frame, which cannot be
+    // destroyed before resumption, so Unretained is safe.
+    promise_.ThenHereInline(
+        FROM_HERE, BindOnce(&PromiseAwaiter::OnResolved, Unretained(this),
+                            handle));
+  }
+
+  ResolveType await_resume() { return std::move(*result_); }
+
+ private:
+  void OnResolved(Handle handle, ResolveType value) {
+    result_.emplace(std::move(value));
+    handle.resume();
+  }
+
+  Promise<ResolveType, NoReject> promise_;
+  Optional<ResolveType> result_;
+};
+
+template <>
+class PromiseAwaiter<void> {
+ public:
+  using Handle = BASIS_COROUTINE_NAMESPACE::coroutine_handle<>;
+
+  explicit PromiseAwaiter(Promise<void, NoReject> promise)
+      : promise_(std::move(promise)) {}
+
+  bool await_ready() const noexcept { return false; }
+
+  void await_suspend(Handle handle) {
+    promise_.ThenHereInline(
+        FROM_HERE,
+        BindOnce([](Handle handle) { handle.resume(); }, handle));
+  }
+
+  void await_resume() {}
+
+ private:
+  Promise<void, NoReject> promise_;
+};
+
+// Awaiter for rejectable promises; produces a PromiseAwaitResult so the
+// rejection is consumed (satisfying RejectPolicy::kMustCatchRejection) and
+// surfaced as a value instead of an exception.
+template <typename ResolveType, typename RejectType>
+class RejectablePromiseAwaiter {
+ public:
+  using Handle = BASIS_COROUTINE_NAMESPACE::coroutine_handle<>;
+  using Result = PromiseAwaitResult<ResolveType, RejectType>;
+
+  explicit RejectablePromiseAwaiter(Promise<ResolveType, RejectType> promise)
+      : promise_(std::move(promise)) {}
+
+  bool await_ready() const noexcept { return false; }
+
+  void await_suspend(Handle handle) {
+    promise_.ThenHere(
+        FROM_HERE,
+        BindOnce(&RejectablePromiseAwaiter::OnResolved, Unretained(this),
+                 handle),
+        BindOnce(&RejectablePromiseAwaiter::OnRejected, Unretained(this),
+                 handle));
+  }
+
+  Result await_resume() { return std::move(*result_); }
+
+ private:
+  void OnResolved(Handle handle, ResolveType value) {
+    result_.emplace(typename Result::ResolvedTag(), std::move(value));
+    handle.resume();
+  }
+
+  void OnRejected(Handle handle, RejectType error) {
+    result_.emplace(typename Result::RejectedTag(), std::move(error));
+    handle.resume();
+  }
+
+  Promise<ResolveType, RejectType> promise_;
+  Optional<Result> result_;
+};
+
+// promise_type for coroutines returning Promise<ResolveType>. The coroutine
+// starts eagerly (suspend_never) which matches how posted promise chains
+// begin executing without an explicit start step.
+template <typename ResolveType>
+class PromiseCoroutine {
+ public:
+  PromiseCoroutine() : resolver_(FROM_HERE) {}
+
+  Promise<ResolveType> get_return_object() { return resolver_.promise(); }
+
+  BASIS_COROUTINE_NAMESPACE::suspend_never initial_suspend() noexcept {
+    return {};
+  }
+  BASIS_COROUTINE_NAMESPACE::suspend_never final_suspend() noexcept {
+    return {};
+  }
+
+  template <typename T>
+  void return_value(T&& value) {
+    resolver_.Resolve(std::forward<T>(value));
+  }
+
+  void unhandled_exception() {
+    // Exceptions are not used for promise control flow in this codebase;
+    // reject by converting the coroutine author's intent explicitly instead.
+    CHECK(false) << "Uncaught exception in a Promise coroutine";
+  }
+
+ private:
+  ManualPromiseResolver<ResolveType> resolver_;
+};
+
+template <>
+class PromiseCoroutine<void> {
+ public:
+  PromiseCoroutine() : resolver_(FROM_HERE) {}
+
+  Promise<void> get_return_object() { return resolver_.promise(); }
+
+  BASIS_COROUTINE_NAMESPACE::suspend_never initial_suspend() noexcept {
+    return {};
+  }
+  BASIS_COROUTINE_NAMESPACE::suspend_never final_suspend() noexcept {
+    return {};
+  }
+
+  void return_void() { resolver_.Resolve(); }
+
+  void unhandled_exception() {
+    CHECK(false) << "Uncaught exception in a Promise coroutine";
+  }
+
+ private:
+  ManualPromiseResolver<void> resolver_;
+};
+
+}  // namespace internal
+
+template <typename ResolveType>
+internal::PromiseAwaiter<ResolveType> operator co_await(
+    Promise<ResolveType, NoReject> promise) {
+  return internal::PromiseAwaiter<ResolveType>(std::move(promise));
+}
+
+template <typename ResolveType, typename RejectType>
+internal::RejectablePromiseAwaiter<ResolveType, RejectType> operator co_await(
+    Promise<ResolveType, RejectType> promise) {
+  return internal::RejectablePromiseAwaiter<ResolveType, RejectType>(
+      std::move(promise));
+}
+
+}  // namespace base
+
+namespace BASIS_COROUTINE_NAMESPACE {
+
+template <typename ResolveType, typename... Args>
+struct coroutine_traits<base::Promise<ResolveType, base::NoReject>, Args...> {
+  using promise_type = base::internal::PromiseCoroutine<ResolveType>;
+};
+
+}  // namespace BASIS_COROUTINE_NAMESPACE
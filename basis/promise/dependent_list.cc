@@ -125,31 +125,46 @@ void DependentList::Node::ClearPrerequisite() {
 DependentList::InsertResult DependentList::Insert(Node* node) {
   DCHECK(!node->next_);
 
-  // std::memory_order_acquire for hapens-after relation with
-  // SettleAndDispatchAllDependents completing and thus this this call returning
-  // an error.
-  uintptr_t prev_data = data_.load(std::memory_order_acquire);
+  uintptr_t prev_data;
   bool did_insert = false;
-  while (IsAllowingInserts(prev_data) && !did_insert) {
-    node->next_ = ExtractHead(prev_data);
-
-    // On success std::memory_order_release so that all memory operations become
-    // visible in SettleAndDispatchAllDependents when iterating the list.
-    // On failure std::memory_order_acquire for happens-after relation with
+  if (sequence_confined_) {
+    // Single sequence (see SetSequenceConfined): nothing can race this
+    // insert, so a plain read and store of |data_| suffice.
+    prev_data = data_.load(std::memory_order_relaxed);
+    if (IsAllowingInserts(prev_data)) {
+      node->next_ = ExtractHead(prev_data);
+      data_.store(CreateData(node, ExtractState(prev_data), kAllowInserts),
+                  std::memory_order_relaxed);
+      did_insert = true;
+    }
+  } else {
+    // std::memory_order_acquire for hapens-after relation with
     // SettleAndDispatchAllDependents completing and thus this this call
     // returning an error.
-    //
-    // Note: ABA is not an issue here as we do not care that head_ might now be
-    // pointing to a different node (but with same address) we only need to
-    // guarantee that node->next points to the current head (which is now the
-    // new node but with the same address so node->next is still valid).
-    if (data_.compare_exchange_weak(
-            prev_data, CreateData(node, ExtractState(prev_data), kAllowInserts),
-            std::memory_order_seq_cst, std::memory_order_seq_cst)) {
-      did_insert = true;
-    } else {
-      // Cleanup in case the loop terminates
-      node->next_ = nullptr;
+    prev_data = data_.load(std::memory_order_acquire);
+    while (IsAllowingInserts(prev_data) && !did_insert) {
+      node->next_ = ExtractHead(prev_data);
+
+      // On success std::memory_order_release so that all memory operations
+      // become visible in SettleAndDispatchAllDependents when iterating the
+      // list.
+      // On failure std::memory_order_acquire for happens-after relation with
+      // SettleAndDispatchAllDependents completing and thus this this call
+      // returning an error.
+      //
+      // Note: ABA is not an issue here as we do not care that head_ might now
+      // be pointing to a different node (but with same address) we only need
+      // to guarantee that node->next points to the current head (which is now
+      // the new node but with the same address so node->next is still valid).
+      if (data_.compare_exchange_weak(
+              prev_data,
+              CreateData(node, ExtractState(prev_data), kAllowInserts),
+              std::memory_order_seq_cst, std::memory_order_seq_cst)) {
+        did_insert = true;
+      } else {
+        // Cleanup in case the loop terminates
+        node->next_ = nullptr;
+      }
     }
   }
 
@@ -179,6 +194,29 @@ bool DependentList::SettleAndDispatchAllDependents(const State settled_state,
                                                    Visitor* visitor) {
   DCHECK_NE(settled_state, State::kUnresolved);
 
+  if (sequence_confined_) {
+    // Single sequence (see SetSequenceConfined): no settlement race to win
+    // and no concurrent Insert, so plain loads and stores suffice. The
+    // drain loop is still needed because dispatching a node may run a
+    // dependent inline, which in turn may Insert new dependents.
+    uintptr_t data = data_.load(std::memory_order_relaxed);
+    if (ExtractState(data) != State::kUnresolved) {
+      // Was already settled.
+      return false;
+    }
+    while (!IsListEmpty(data)) {
+      data_.store(CreateData(nullptr, settled_state, kAllowInserts),
+                  std::memory_order_relaxed);
+      // We don't want to retain prerequisites when cancelling.
+      DispatchAll(ExtractHead(data), visitor,
+                  settled_state != State::kCanceled);
+      data = data_.load(std::memory_order_relaxed);
+    }
+    data_.store(CreateData(nullptr, settled_state, kBlockInserts),
+                std::memory_order_relaxed);
+    return true;
+  }
+
   // Whether this invocation won the settlement race. If so, it will now keep
   // dispatching all nodes in as many attempts as it takes to win the race
   // against Insert()'s.
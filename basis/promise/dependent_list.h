@@ -122,6 +122,14 @@ class BASE_EXPORT DependentList {
     static constexpr intptr_t kIsRetained = 1;
   };
 
+  // Declares that this list is only ever accessed from a single sequence
+  // (see AbstractPromise::Create's |sequence_confined|). Insert and the
+  // *AndConsumeAllDependents methods then use plain loads and stores on
+  // |data_| instead of CAS loops. Must be called before any Insert, i.e.
+  // right after construction. The owning AbstractPromise DCHECKs the
+  // single-sequence claim with a sequence checker.
+  void SetSequenceConfined() { sequence_confined_ = true; }
+
   // Insert will only succeed if neither ResolveAndConsumeAllDependents nor
   // RejectAndConsumeAllDependents nor CancelAndConsumeAllDependents have been
   // called yet. If the call succeeds, |node| must remain valid pointer until it
@@ -294,6 +302,10 @@ class BASE_EXPORT DependentList {
                           bool retain_prerequsites);
 
   std::atomic<uintptr_t> data_;
+
+  // See SetSequenceConfined(). Set once before the list is shared and
+  // immutable afterwards, so plain reads of it are safe.
+  bool sequence_confined_ = false;
 };
 
 }  // namespace internal
@@ -0,0 +1,81 @@
+// Copyright 2019 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "basis/promise/dispatch_batch.h" // IWYU pragma: associated
+
+#include <atomic>
+
+#include "base/bind.h"
+#include "base/task_runner.h"
+#include "basis/promise/abstract_promise.h"
+
+namespace base {
+namespace internal {
+
+namespace {
+
+std::atomic_bool g_batching_enabled{false};
+
+thread_local PromiseDispatchBatch* g_active_batch = nullptr;
+
+void ExecuteBatch(std::vector<scoped_refptr<AbstractPromise>> promises) {
+  for (scoped_refptr<AbstractPromise>& promise : promises)
+    promise->Execute();
+}
+
+}  // namespace
+
+PromiseDispatchBatch::PromiseDispatchBatch()
+    : is_outermost_(g_active_batch == nullptr) {
+  if (is_outermost_)
+    g_active_batch = this;
+}
+
+PromiseDispatchBatch::~PromiseDispatchBatch() {
+  if (!is_outermost_)
+    return;
+  g_active_batch = nullptr;
+  // Group |pending_| by destination runner with a linear scan. Entries that
+  // have already been claimed by an earlier group have a null runner.
+  for (size_t i = 0; i < pending_.size(); ++i) {
+    if (!pending_[i].first)
+      continue;
+    scoped_refptr<TaskRunner> task_runner = std::move(pending_[i].first);
+    std::vector<scoped_refptr<AbstractPromise>> group;
+    group.push_back(std::move(pending_[i].second));
+    for (size_t j = i + 1; j < pending_.size(); ++j) {
+      if (pending_[j].first == task_runner) {
+        group.push_back(std::move(pending_[j].second));
+        pending_[j].first = nullptr;
+      }
+    }
+    // One task runs the whole group, replacing |group.size()| PostTask calls.
+    task_runner->PostTask(group[0]->from_here(),
+                          BindOnce(&ExecuteBatch, std::move(group)));
+  }
+}
+
+// static
+void PromiseDispatchBatch::SetBatchingEnabled(bool enabled) {
+  g_batching_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+// static
+bool PromiseDispatchBatch::IsBatchingEnabled() {
+  return g_batching_enabled.load(std::memory_order_relaxed);
+}
+
+// static
+PromiseDispatchBatch* PromiseDispatchBatch::GetActiveForCurrentThread() {
+  return g_active_batch;
+}
+
+void PromiseDispatchBatch::Add(scoped_refptr<TaskRunner> task_runner,
+                               scoped_refptr<AbstractPromise> promise) {
+  DCHECK_EQ(this, g_active_batch);
+  pending_.emplace_back(std::move(task_runner), std::move(promise));
+}
+
+}  // namespace internal
+}  // namespace base
@@ -0,0 +1,75 @@
+// Copyright 2019 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+
+namespace base {
+
+class TaskRunner;
+
+namespace internal {
+
+class AbstractPromise;
+
+// Batches the cross-thread dispatch of dependent promises.
+//
+// When an antecedent with a large fan-out settles, every dependent is
+// normally posted to its destination task runner individually - hundreds of
+// PostTask calls (and cross-thread wakeups) for a single broadcast-style
+// promise. While a PromiseDispatchBatch is active on the dispatching thread,
+// AbstractPromise::DispatchPromise() instead hands the ready promise to the
+// batch; when the batch goes out of scope the collected promises are grouped
+// by destination task runner and one task per runner executes the whole
+// group.
+//
+// Batching is opt-in via SetBatchingEnabled(). When enabled,
+// DependentList consumption (see OnResolveDispatchReadyDependents) opens a
+// batch automatically, so fan-out settlement produces at most one posted
+// task per distinct destination runner. Promises dispatched to the current
+// sequence via the inline fast path are unaffected.
+class BASE_EXPORT PromiseDispatchBatch {
+ public:
+  PromiseDispatchBatch();
+
+  // Flushes: groups pending promises by task runner and posts one task per
+  // runner which runs AbstractPromise::Execute for each member of the group.
+  ~PromiseDispatchBatch();
+
+  PromiseDispatchBatch(const PromiseDispatchBatch&) = delete;
+  PromiseDispatchBatch& operator=(const PromiseDispatchBatch&) = delete;
+
+  // Globally enables or disables batched dispatch. Off by default.
+  static void SetBatchingEnabled(bool enabled);
+  static bool IsBatchingEnabled();
+
+  // The batch currently open on this thread, or null. Only the outermost
+  // batch on a thread collects promises; nested batches are inert.
+  static PromiseDispatchBatch* GetActiveForCurrentThread();
+
+  // Defers |promise| (ready to Execute) for batched posting to |task_runner|.
+  void Add(scoped_refptr<TaskRunner> task_runner,
+           scoped_refptr<AbstractPromise> promise);
+
+  size_t num_pending_for_testing() const { return pending_.size(); }
+
+ private:
+  // Kept as a flat list; fan-out dispatch rarely targets more than a handful
+  // of distinct runners so grouping is done with a linear scan at flush time
+  // rather than paying for a map.
+  std::vector<
+      std::pair<scoped_refptr<TaskRunner>, scoped_refptr<AbstractPromise>>>
+      pending_;
+
+  const bool is_outermost_;
+};
+
+}  // namespace internal
+}  // namespace base
@@ -0,0 +1,139 @@
+// Copyright 2019 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#pragma once
+
+#include <utility>
+
+#include "base/bind.h"
+#include "base/callback.h"
+#include "base/location.h"
+#include "basis/promise/promise.h"
+
+namespace base {
+
+// Fuses a chain of same-sequence Then links into a single promise node.
+//
+// A typical chain of 5-8 ThenHere calls costs one AbstractPromise, one
+// DependentList and one task-queue hop per link. When every link targets the
+// current sequence and has no reject handler, nothing observable happens
+// between the links, so they can be composed into one callback executed
+// back-to-back by a single AbstractPromise:
+//
+//   // db_query is a Promise<Row>.
+//   Promise<std::string> out =
+//       FuseChain(db_query, BindOnce(&DecodeRow))   // Row -> Item
+//           .Then(BindOnce(&FormatItem))            // Item -> std::string
+//           .Build(FROM_HERE);
+//
+// Build() attaches exactly one continuation to the antecedent, so the whole
+// fused chain costs one promise allocation and one scheduling hop regardless
+// of its length. Only resolve-only (NoReject) links taking and returning
+// plain values can be fused; use ordinary ThenHere/CatchHere links where
+// rejection handling or curried promises are needed.
+
+namespace internal {
+
+// Composes two OnceCallbacks into one, specialized over the four void /
+// non-void argument and return combinations.
+template <typename FirstCb, typename SecondCb>
+struct OnceCallbackComposer;
+
+template <typename A, typename B, typename C>
+struct OnceCallbackComposer<OnceCallback<B(A)>, OnceCallback<C(B)>> {
+  static C Run(OnceCallback<B(A)> first, OnceCallback<C(B)> second, A arg) {
+    return std::move(second).Run(std::move(first).Run(std::move(arg)));
+  }
+
+  static OnceCallback<C(A)> Compose(OnceCallback<B(A)> first,
+                                    OnceCallback<C(B)> second) {
+    return BindOnce(&OnceCallbackComposer::Run, std::move(first),
+                    std::move(second));
+  }
+};
+
+template <typename A, typename C>
+struct OnceCallbackComposer<OnceCallback<void(A)>, OnceCallback<C()>> {
+  static C Run(OnceCallback<void(A)> first, OnceCallback<C()> second, A arg) {
+    std::move(first).Run(std::move(arg));
+    return std::move(second).Run();
+  }
+
+  static OnceCallback<C(A)> Compose(OnceCallback<void(A)> first,
+                                    OnceCallback<C()> second) {
+    return BindOnce(&OnceCallbackComposer::Run, std::move(first),
+                    std::move(second));
+  }
+};
+
+template <typename B, typename C>
+struct OnceCallbackComposer<OnceCallback<B()>, OnceCallback<C(B)>> {
+  static C Run(OnceCallback<B()> first, OnceCallback<C(B)> second) {
+    return std::move(second).Run(std::move(first).Run());
+  }
+
+  static OnceCallback<C()> Compose(OnceCallback<B()> first,
+                                   OnceCallback<C(B)> second) {
+    return BindOnce(&OnceCallbackComposer::Run, std::move(first),
+                    std::move(second));
+  }
+};
+
+template <typename C>
+struct OnceCallbackComposer<OnceCallback<void()>, OnceCallback<C()>> {
+  static C Run(OnceCallback<void()> first, OnceCallback<C()> second) {
+    std::move(first).Run();
+    return std::move(second).Run();
+  }
+
+  static OnceCallback<C()> Compose(OnceCallback<void()> first,
+                                   OnceCallback<C()> second) {
+    return BindOnce(&OnceCallbackComposer::Run, std::move(first),
+                    std::move(second));
+  }
+};
+
+}  // namespace internal
+
+template <typename PromiseType, typename CallbackType>
+class FusedChainBuilder {
+ public:
+  FusedChainBuilder(PromiseType promise, CallbackType callback)
+      : promise_(std::move(promise)), callback_(std::move(callback)) {}
+
+  // Appends |next| to the fused chain. Consumes the builder.
+  template <typename NextCb>
+  auto Then(NextCb next) && {
+    auto composed =
+        internal::OnceCallbackComposer<CallbackType, NextCb>::Compose(
+            std::move(callback_), std::move(next));
+    return FusedChainBuilder<PromiseType, decltype(composed)>(
+        std::move(promise_), std::move(composed));
+  }
+
+  // Attaches the fused callback as a single ThenHere link and returns the
+  // resulting promise. Consumes the builder.
+  auto Build(const Location& from_here) && {
+    return promise_.ThenHere(from_here, std::move(callback_));
+  }
+
+  // As Build() but opts into the synchronous fast path (see ThenHereInline).
+  auto BuildInline(const Location& from_here) && {
+    return promise_.ThenHereInline(from_here, std::move(callback_));
+  }
+
+ private:
+  PromiseType promise_;
+  CallbackType callback_;
+};
+
+// Starts a fused chain off |promise|. |first| receives the promise's resolve
+// value like a regular ThenHere callback.
+template <typename ResolveType, typename FirstCb>
+auto FuseChain(Promise<ResolveType, NoReject> promise, FirstCb first) {
+  return FusedChainBuilder<Promise<ResolveType, NoReject>, FirstCb>(
+      std::move(promise), std::move(first));
+}
+
+}  // namespace base
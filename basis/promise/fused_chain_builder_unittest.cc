@@ -0,0 +1,64 @@
+// Copyright 2019 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "basis/promise/fused_chain_builder.h"
+
+#include <string>
+
+#include "base/run_loop.h"
+#include "base/test/bind_test_util.h"
+#include "base/test/task_environment.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace {
+
+int Increment(int value) {
+  return value + 1;
+}
+
+std::string Stringify(int value) {
+  return std::to_string(value);
+}
+
+}  // namespace
+
+class FusedChainBuilderTest : public testing::Test {
+ public:
+  test::TaskEnvironment task_environment_;
+};
+
+TEST_F(FusedChainBuilderTest, RunsAllLinksBackToBack) {
+  ManualPromiseResolver<int> p(FROM_HERE);
+  p.Resolve(41);
+
+  RunLoop run_loop;
+  FuseChain(p.promise(), BindOnce(&Increment))
+      .Then(BindOnce(&Stringify))
+      .Build(FROM_HERE)
+      .ThenHere(FROM_HERE, BindLambdaForTesting([&](std::string result) {
+                  EXPECT_EQ("42", result);
+                  run_loop.Quit();
+                }));
+  run_loop.Run();
+}
+
+TEST_F(FusedChainBuilderTest, VoidLinksCompose) {
+  ManualPromiseResolver<void> p(FROM_HERE);
+  p.Resolve();
+
+  int counter = 0;
+  bool done = false;
+  FuseChain(p.promise(), BindLambdaForTesting([&]() { ++counter; }))
+      .Then(BindLambdaForTesting([&]() { ++counter; }))
+      .Then(BindLambdaForTesting([&]() {
+        EXPECT_EQ(2, counter);
+        done = true;
+      }))
+      .BuildInline(FROM_HERE);
+  // BuildInline on a settled promise runs the fused links synchronously.
+  EXPECT_TRUE(done);
+}
+
+}  // namespace base
@@ -19,7 +19,9 @@ PassedPromise ConstructAbstractPromiseWithSinglePrerequisite(
     const scoped_refptr<TaskRunner>& task_runner,
     const Location& from_here,
     AbstractPromise* prerequisite,
-    internal::PromiseExecutor::Data&& executor_data) noexcept {
+    internal::PromiseExecutor::Data&& executor_data,
+    bool inline_dispatch_allowed,
+    bool sequence_confined) noexcept {
   // Note |prerequisite| can legitimately be null when posting a promise chain
   // during shutdown.
   if (!prerequisite) {
@@ -32,17 +34,19 @@ PassedPromise ConstructAbstractPromiseWithSinglePrerequisite(
       task_runner, from_here,
       std::make_unique<AbstractPromise::AdjacencyList>(prerequisite),
       RejectPolicy::kMustCatchRejection,
-      internal::DependentList::ConstructUnresolved(),
-      std::move(executor_data)));
+      internal::DependentList::ConstructUnresolved(), std::move(executor_data),
+      inline_dispatch_allowed, sequence_confined));
 }
 
 PassedPromise ConstructHereAbstractPromiseWithSinglePrerequisite(
     const Location& from_here,
     AbstractPromise* prerequisite,
-    internal::PromiseExecutor::Data&& executor_data) noexcept {
+    internal::PromiseExecutor::Data&& executor_data,
+    bool inline_dispatch_allowed,
+    bool sequence_confined) noexcept {
   return ConstructAbstractPromiseWithSinglePrerequisite(
       SequencedTaskRunnerHandle::Get(), from_here, prerequisite,
-      std::move(executor_data));
+      std::move(executor_data), inline_dispatch_allowed, sequence_confined);
 }
 
 PassedPromise ConstructManualPromiseResolverPromise(const Location& from_here,
@@ -703,14 +703,18 @@ PassedPromise BASE_EXPORT ConstructAbstractPromiseWithSinglePrerequisite(
     const scoped_refptr<TaskRunner>& task_runner,
     const Location& from_here,
     AbstractPromise* prerequsite,
-    PromiseExecutor::Data&& executor_data) noexcept;
+    PromiseExecutor::Data&& executor_data,
+    bool inline_dispatch_allowed = false,
+    bool sequence_confined = false) noexcept;
 
 // Like ConstructAbstractPromiseWithSinglePrerequisite except tasks are posted
 // onto SequencedTaskRunnerHandle::Get().
 PassedPromise BASE_EXPORT ConstructHereAbstractPromiseWithSinglePrerequisite(
     const Location& from_here,
     AbstractPromise* prerequsite,
-    PromiseExecutor::Data&& executor_data) noexcept;
+    PromiseExecutor::Data&& executor_data,
+    bool inline_dispatch_allowed = false,
+    bool sequence_confined = false) noexcept;
 
 PassedPromise BASE_EXPORT
 ConstructManualPromiseResolverPromise(const Location& from_here,
@@ -732,6 +736,20 @@ struct TupleConstructor<Tuple, std::index_sequence<Indices...>> {
     return ArgMoveSemanticsHelper<ArgType, ResolvedType>::Get(arg);
   }
 
+  // Binds a reference directly to the value stored inside |arg| - an
+  // rvalue reference for types that use move semantics, a const lvalue
+  // reference otherwise - so a tuple element can be constructed
+  // straight from the antecedent's storage with a single move (or
+  // copy), instead of through the by-value temporary that
+  // GetResolvedValueFromPromise materializes per element.
+  template <typename ArgType>
+  static decltype(auto) GetResolvedValueRefFromPromise(AbstractPromise* arg) {
+    using ResolvedType = base::Resolved<UndoToNonVoidT<ArgType>>;
+    DCHECK(arg->IsSettled() && arg->IsResolved());
+    return GetResolvedValueRefImpl<ArgType, ResolvedType>(
+        arg, UseMoveSemantics<ArgType>());
+  }
+
   template <typename ArgType>
   static auto GetOptionallyResolvedValueFromPromise(AbstractPromise* arg) {
     using ResolvedType = base::Resolved<UndoToNonVoidT<ArgType>>;
@@ -741,20 +759,38 @@ struct TupleConstructor<Tuple, std::index_sequence<Indices...>> {
     return internal::ToNonVoidT<UndoToNonVoidT<ArgType>>{};
   }
 
-  // Resolves |result| with a std::tuple of the promise results of the dependent
-  // promises.
+  // Resolves |result| with a std::tuple of the promise results of the
+  // dependent promises. The tuple lives directly in |result|'s value
+  // storage (value_.emplace constructs Resolved<Tuple> in place) and
+  // each element is constructed from a reference into its antecedent's
+  // storage, so every resolved value lands in its final slot with one
+  // move - no per-element temporaries.
   static void ConstructResolvedTuple(
-      const std::vector<DependentList::Node>* prerequisite_list,
+      const AbstractPromise::PrerequisiteList* prerequisite_list,
       AbstractPromise* result) {
     DCHECK_EQ(sizeof...(Indices), prerequisite_list->size());
     result->emplace(
         in_place_type_t<Resolved<Tuple>>(),
-        GetResolvedValueFromPromise<std::tuple_element_t<Indices, Tuple>>(
+        GetResolvedValueRefFromPromise<std::tuple_element_t<Indices, Tuple>>(
             (*prerequisite_list)[Indices].prerequisite())...);
+#if DCHECK_IS_ON()
+    // The by-value path consumed each moved-from antecedent through
+    // TakeValue(), whose handle resets the storage in DCHECK builds to
+    // catch double consumption; preserve that hygiene for the elements
+    // that were moved (copied elements stay readable, as before).
+    int fold[] = {
+        (ConsumeResolvedValueIfMoved<std::tuple_element_t<Indices, Tuple>>(
+             (*prerequisite_list)[Indices].prerequisite()),
+         0)...};
+    (void)fold;
+#endif
   }
 
+  // Unlike ConstructResolvedTuple this stays by-value: unresolved
+  // elements are default-constructed temporaries, so there is no
+  // stored value to reference.
   static void ConstructOptionallyResolvedTuple(
-      const std::vector<DependentList::Node>* prerequisite_list,
+      const AbstractPromise::PrerequisiteList* prerequisite_list,
       AbstractPromise* result) {
     DCHECK_EQ(sizeof...(Indices), prerequisite_list->size());
     result->emplace(
@@ -762,6 +798,30 @@ struct TupleConstructor<Tuple, std::index_sequence<Indices...>> {
         GetOptionallyResolvedValueFromPromise<std::tuple_element_t<Indices, Tuple>>(
             (*prerequisite_list)[Indices].prerequisite())...);
   }
+
+ private:
+  // The stored field is ToNonVoidT<UndoToNonVoidT<ArgType>>, which is
+  // exactly ArgType for every tuple element (Void included).
+  template <typename ArgType, typename ResolvedType>
+  static ArgType&& GetResolvedValueRefImpl(AbstractPromise* arg,
+                                           std::true_type /* use_move */) {
+    return std::move(arg->value().Get<ResolvedType>()->value);
+  }
+
+  template <typename ArgType, typename ResolvedType>
+  static const ArgType& GetResolvedValueRefImpl(
+      AbstractPromise* arg,
+      std::false_type /* use_move */) {
+    return arg->value().Get<ResolvedType>()->value;
+  }
+
+#if DCHECK_IS_ON()
+  template <typename ArgType>
+  static void ConsumeResolvedValueIfMoved(AbstractPromise* arg) {
+    if (UseMoveSemantics<ArgType>::value)
+      arg->TakeValue();
+  }
+#endif
 };
 
 template <typename T>
@@ -4,6 +4,7 @@
 
 #include "basis/promise/no_op_promise_executor.h" // IWYU pragma: associated
 
+#include "base/no_destructor.h"
 #include "base/task_runner.h"
 
 namespace base {
@@ -50,6 +51,29 @@ PassedPromise NoOpPromiseExecutor::Create(Location from_here,
                                           bool can_resolve,
                                           bool can_reject,
                                           RejectPolicy reject_policy) {
+#if !DCHECK_IS_ON()
+  // An inert DoNothing promise (can't resolve, can't reject) carries no
+  // state at all in release builds: the executor is empty, the promise can
+  // never settle, and |reject_policy| only drives DCHECK bookkeeping. All
+  // such promises are interchangeable, so hand out one process-lifetime
+  // instance and make the common default-continuation case a refcount bump
+  // instead of an allocation. DCHECK builds keep allocating because each
+  // instance carries per-call-site verification state (location, catch
+  // responsibility) that must not be shared between unrelated sites.
+  //
+  // Note attaching dependents to a promise that can never settle keeps
+  // them alive for as long as the promise — with this shared instance,
+  // for the whole process. That was already a dubious thing to do with a
+  // fresh DoNothing promise (the dependents can never run).
+  if (!can_resolve && !can_reject) {
+    static NoDestructor<scoped_refptr<AbstractPromise>> shared_promise(
+        AbstractPromise::CreateNoPrerequisitePromise(
+            from_here, reject_policy, DependentList::ConstructUnresolved(),
+            PromiseExecutor::Data(in_place_type_t<NoOpPromiseExecutor>(),
+                                  false, false)));
+    return PassedPromise(*shared_promise);
+  }
+#endif
   return PassedPromise(AbstractPromise::CreateNoPrerequisitePromise(
       from_here, reject_policy, DependentList::ConstructUnresolved(),
       PromiseExecutor::Data(in_place_type_t<NoOpPromiseExecutor>(), can_resolve,
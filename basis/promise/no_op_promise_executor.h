@@ -20,6 +20,10 @@ class BASE_EXPORT NoOpPromiseExecutor {
   static constexpr PromiseExecutor::PrerequisitePolicy kPrerequisitePolicy =
       PromiseExecutor::PrerequisitePolicy::kNever;
 
+  // In non-DCHECK builds promises that can neither resolve nor reject are
+  // served from one shared process-lifetime instance (they carry no state,
+  // so all of them are interchangeable); other configurations, and all
+  // DCHECK builds, allocate a fresh promise.
   static PassedPromise Create(Location from_here,
                               bool can_resolve,
                               bool can_reject,
@@ -62,6 +62,15 @@ class Promise : public internal::BasePromise {
 
   ~Promise() = default;
 
+  // Estimates memory usage (in bytes) of the promise graph reachable from
+  // this handle, i.e. this promise plus its transitive prerequisites and
+  // curried promises. See AbstractPromise::EstimateMemoryUsage() for what
+  // is and isn't counted and for the no-concurrent-mutation requirement.
+  size_t EstimateMemoryUsage() const {
+    DCHECK(abstract_promise_);
+    return abstract_promise_->EstimateMemoryUsage();
+  }
+
   bool IsCancelledForTesting() const { return abstract_promise_->IsCanceled(); }
 
   // Waits until the promise has settled and if resolved it returns the resolved
@@ -303,6 +312,27 @@ class Promise : public internal::BasePromise {
 
   template <typename ThenCb>
   auto ThenHere(const Location& from_here, ThenCb&& on_resolve) noexcept {
+    return ThenHereInternal(from_here, std::forward<ThenCb>(on_resolve),
+                            /*inline_dispatch_allowed=*/false);
+  }
+
+  // Like ThenHere() but opts into synchronous dispatch: when this promise
+  // settles on the current sequence (in particular when it is already
+  // resolved at the time of the call) |on_resolve| runs immediately instead
+  // of via a posted task, collapsing the link into a plain function call.
+  // Callers must tolerate |on_resolve| running re-entrantly before
+  // ThenHereInline() returns.
+  template <typename ThenCb>
+  auto ThenHereInline(const Location& from_here, ThenCb&& on_resolve) noexcept {
+    return ThenHereInternal(from_here, std::forward<ThenCb>(on_resolve),
+                            /*inline_dispatch_allowed=*/true);
+  }
+
+ private:
+  template <typename ThenCb>
+  auto ThenHereInternal(const Location& from_here,
+                        ThenCb&& on_resolve,
+                        bool inline_dispatch_allowed) noexcept {
     DCHECK(!on_resolve.is_null());
 
     // Extract properties from the |on_resolve| callback.
@@ -342,9 +372,11 @@ class Promise : public internal::BasePromise {
                     Resolved<ReturnedPromiseResolveT>,
                     Rejected<ReturnedPromiseRejectT>>>(),
                 internal::ToCallbackBase(std::move(on_resolve)),
-                OnceClosure())));
+                OnceClosure()),
+            inline_dispatch_allowed));
   }
 
+ public:
   // A task to execute |on_reject| is posted on |task_runner| as soon as this
   // promise (or an uncaught ancestor) is rejected. Likewise a task to execute
   // |on_resolve| is posted on |task_runner| as soon as this promise (or an
@@ -769,6 +801,25 @@ class Promises {
         Container, typename Container::value_type>::All(from_here, promises);
   }
 
+  // Bulk variant of All() for joining large containers (e.g. 1k+ per-entity
+  // simulation results). Aggregation uses the same single preallocated
+  // dependents block and atomic countdown, but every element result is moved
+  // (never copied) straight into the returned std::vector. The input
+  // promises' values are therefore consumed: don't attach other Thens that
+  // read them after the join.
+  template <typename Container>
+  static auto AllBulk(const Location& from_here, const Container& promises) {
+    using PromiseType = typename internal::AllContainerHelper<
+        Container, typename Container::value_type>::PromiseType;
+    if (promises.empty()) {
+      DCHECK(false) << "nothing passed to Promise::AllBulk";
+      return PromiseType::CreateResolved(from_here);
+    }
+    return internal::AllContainerHelper<
+        Container, typename Container::value_type>::AllBulk(from_here,
+                                                            promises);
+  }
+
   // Accepts one or more promises and returns a
   // Promise<std::tuple<Resolve> ...>, Reject> which is resolved when all
   // promises resolve or rejects with the Reject value of the first promise to
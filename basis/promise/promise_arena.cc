@@ -0,0 +1,202 @@
+// Copyright 2019 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "basis/promise/promise_arena.h" // IWYU pragma: associated
+
+#include <cstdlib>
+
+namespace base {
+namespace internal {
+
+namespace {
+
+// Keeps DependentList::Node's ALIGNAS(8) requirement intact for the payload
+// that follows the header.
+constexpr size_t kBlockAlignment = 8;
+
+constexpr size_t AlignUp(size_t value) {
+  return (value + kBlockAlignment - 1) & ~(kBlockAlignment - 1);
+}
+
+constexpr size_t kHeaderSize = 16;
+
+thread_local PromiseArena* g_current_arena = nullptr;
+
+// Recycles heap blocks (promise nodes and adjacency lists allocated with no
+// arena installed) through per-thread, size-bucketed freelists. Steady-state
+// promise traffic is millions of identically sized allocations per minute;
+// the freelist turns each into a couple of pointer moves instead of a trip
+// to the global allocator. Blocks are pushed onto the freeing thread's list,
+// which for balanced workloads keeps the lists warm without any locking.
+class PromiseNodeFreelist {
+ public:
+  // Promise nodes are well under this; anything bigger goes to malloc.
+  static constexpr size_t kMaxBlockSize = 512;
+  static constexpr size_t kBucketGranularity = 16;
+  static constexpr size_t kNumBuckets = kMaxBlockSize / kBucketGranularity;
+  // Bounds memory kept per thread to kMaxPerBucket * kMaxBlockSize.
+  static constexpr size_t kMaxPerBucket = 64;
+
+  ~PromiseNodeFreelist() {
+    for (size_t i = 0; i < kNumBuckets; ++i) {
+      FreeBlock* block = buckets_[i];
+      while (block) {
+        FreeBlock* next = block->next;
+        free(block);
+        block = next;
+      }
+    }
+  }
+
+  // |size| includes the header. Returns null on miss.
+  void* Take(size_t size) {
+    const size_t bucket = BucketFor(size);
+    if (bucket >= kNumBuckets || !buckets_[bucket])
+      return nullptr;
+    FreeBlock* block = buckets_[bucket];
+    buckets_[bucket] = block->next;
+    --bucket_sizes_[bucket];
+    return block;
+  }
+
+  // Returns false if the block should be freed normally.
+  bool Put(void* ptr, size_t size) {
+    const size_t bucket = BucketFor(size);
+    if (bucket >= kNumBuckets || bucket_sizes_[bucket] >= kMaxPerBucket)
+      return false;
+    FreeBlock* block = static_cast<FreeBlock*>(ptr);
+    block->next = buckets_[bucket];
+    buckets_[bucket] = block;
+    ++bucket_sizes_[bucket];
+    return true;
+  }
+
+  // Take() matches by bucket, not exact size, so heap blocks must be
+  // allocated at their bucket's upper bound: a recycled block can then
+  // serve any request mapping to the same bucket, including ones a few
+  // bytes larger than the size it was first allocated for. Blocks past
+  // kMaxBlockSize are never recycled and keep their exact size.
+  static size_t MallocSizeFor(size_t size) {
+    const size_t bucket = BucketFor(size);
+    if (bucket >= kNumBuckets)
+      return size;
+    return (bucket + 1) * kBucketGranularity;
+  }
+
+ private:
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  static size_t BucketFor(size_t size) {
+    return (size - 1) / kBucketGranularity;
+  }
+
+  FreeBlock* buckets_[kNumBuckets] = {};
+  size_t bucket_sizes_[kNumBuckets] = {};
+};
+
+PromiseNodeFreelist& GetFreelistForThread() {
+  static thread_local PromiseNodeFreelist freelist;
+  return freelist;
+}
+
+}  // namespace
+
+PromiseArena::PromiseArena() : PromiseArena(kDefaultSlabSize) {}
+
+PromiseArena::PromiseArena(size_t slab_bytes) : slab_bytes_(slab_bytes) {
+  DCHECK_GT(slab_bytes_, sizeof(Slab) + kHeaderSize);
+}
+
+PromiseArena::~PromiseArena() {
+  DCHECK_EQ(live_blocks_.load(std::memory_order_acquire), 0u)
+      << "PromiseArena destroyed while promises allocated from it are alive";
+  Slab* slab = current_slab_;
+  while (slab) {
+    Slab* next = slab->next;
+    free(slab);
+    slab = next;
+  }
+}
+
+// static
+PromiseArena* PromiseArena::CurrentForThread() {
+  return g_current_arena;
+}
+
+// static
+void* PromiseArena::Allocate(size_t size) {
+  static_assert(sizeof(BlockHeader) <= kHeaderSize,
+                "BlockHeader must fit into the reserved prefix");
+  const size_t block_size = kHeaderSize + size;
+  PromiseArena* arena = g_current_arena;
+  void* block;
+  if (arena) {
+    block = arena->AllocateFromSlab(block_size);
+    arena->live_blocks_.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    block = GetFreelistForThread().Take(block_size);
+    if (!block) {
+      block = malloc(PromiseNodeFreelist::MallocSizeFor(block_size));
+      CHECK(block);
+    }
+  }
+  BlockHeader* header = static_cast<BlockHeader*>(block);
+  header->arena = arena;
+  header->size = block_size;
+  return static_cast<char*>(block) + kHeaderSize;
+}
+
+// static
+void PromiseArena::Delete(void* ptr) {
+  if (!ptr)
+    return;
+  void* block = static_cast<char*>(ptr) - kHeaderSize;
+  BlockHeader* header = static_cast<BlockHeader*>(block);
+  if (header->arena) {
+    // The memory stays inside the arena's slabs; it is released in bulk by
+    // ~PromiseArena.
+    header->arena->OnBlockDeleted();
+  } else if (!GetFreelistForThread().Put(block, header->size)) {
+    free(block);
+  }
+}
+
+void* PromiseArena::AllocateFromSlab(size_t size) {
+  size = AlignUp(size);
+  DCHECK_LE(size, slab_bytes_ - AlignUp(sizeof(Slab)));
+  while (lock_.test_and_set(std::memory_order_acquire)) {
+  }
+  Slab* slab = current_slab_;
+  if (!slab || slab->used + size > slab_bytes_) {
+    slab = static_cast<Slab*>(malloc(slab_bytes_));
+    CHECK(slab);
+    slab->next = current_slab_;
+    slab->used = AlignUp(sizeof(Slab));
+    current_slab_ = slab;
+    ++num_slabs_;
+  }
+  void* result = reinterpret_cast<char*>(slab) + slab->used;
+  slab->used += size;
+  lock_.clear(std::memory_order_release);
+  return result;
+}
+
+void PromiseArena::OnBlockDeleted() {
+  DCHECK_GT(live_blocks_.load(std::memory_order_relaxed), 0u);
+  live_blocks_.fetch_sub(1, std::memory_order_release);
+}
+
+ScopedPromiseArena::ScopedPromiseArena(PromiseArena* arena)
+    : previous_arena_(g_current_arena) {
+  g_current_arena = arena;
+}
+
+ScopedPromiseArena::~ScopedPromiseArena() {
+  g_current_arena = previous_arena_;
+}
+
+}  // namespace internal
+}  // namespace base
@@ -0,0 +1,75 @@
+// Copyright 2019 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "basis/promise/promise_arena.h"
+
+#include "base/test/do_nothing_promise.h"
+#include "basis/promise/abstract_promise.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+// This TU provides the counting operator new/delete for the test
+// binary; keep it out of any other TU linked into the same target.
+#define BASIS_IMPLEMENT_ALLOCATION_WATCHER 1
+#include "basis/test/allocation_watcher.h"
+
+namespace base {
+namespace internal {
+
+TEST(PromiseArenaTest, NoArenaInstalledByDefault) {
+  EXPECT_EQ(nullptr, PromiseArena::CurrentForThread());
+}
+
+TEST(PromiseArenaTest, ScopedInstallAndRestore) {
+  PromiseArena arena;
+  {
+    ScopedPromiseArena scoped_arena(&arena);
+    EXPECT_EQ(&arena, PromiseArena::CurrentForThread());
+    {
+      PromiseArena nested;
+      ScopedPromiseArena scoped_nested(&nested);
+      EXPECT_EQ(&nested, PromiseArena::CurrentForThread());
+    }
+    EXPECT_EQ(&arena, PromiseArena::CurrentForThread());
+  }
+  EXPECT_EQ(nullptr, PromiseArena::CurrentForThread());
+}
+
+TEST(PromiseArenaTest, PromisesAreCarvedFromArena) {
+  PromiseArena arena;
+  {
+    ScopedPromiseArena scoped_arena(&arena);
+    scoped_refptr<AbstractPromise> promise = DoNothingPromiseBuilder(FROM_HERE);
+    EXPECT_GE(arena.live_blocks_for_testing(), 1u);
+    EXPECT_EQ(1u, arena.slabs_allocated_for_testing());
+    promise->OnCanceled();
+  }
+  EXPECT_EQ(0u, arena.live_blocks_for_testing());
+}
+
+TEST(PromiseArenaTest, WarmArenaPromisesDoNotTouchTheHeap) {
+  PromiseArena arena;
+  ScopedPromiseArena scoped_arena(&arena);
+  // First promise pays the slab allocation; from then on creation and
+  // destruction must carve from the arena without heap traffic.
+  scoped_refptr<AbstractPromise> warmup = DoNothingPromiseBuilder(FROM_HERE);
+  EXPECT_ALLOCATIONS_LE(0) {
+    scoped_refptr<AbstractPromise> promise = DoNothingPromiseBuilder(FROM_HERE);
+    promise->OnCanceled();
+  }
+  warmup->OnCanceled();
+}
+
+TEST(PromiseArenaTest, HeapPromisesUnaffectedByOtherThreadsArena) {
+  // A promise allocated with no arena installed must route through the
+  // regular heap even if it is deleted while some arena is current.
+  scoped_refptr<AbstractPromise> promise = DoNothingPromiseBuilder(FROM_HERE);
+  PromiseArena arena;
+  ScopedPromiseArena scoped_arena(&arena);
+  promise->OnCanceled();
+  promise = nullptr;
+  EXPECT_EQ(0u, arena.live_blocks_for_testing());
+}
+
+}  // namespace internal
+}  // namespace base
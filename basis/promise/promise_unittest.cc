@@ -199,6 +199,33 @@ TEST_F(PromiseTest, GetResolveCallbackThen) {
   run_loop.Run();
 }
 
+TEST_F(PromiseTest, ThenHereInlineRunsSynchronouslyWhenAlreadyResolved) {
+  ManualPromiseResolver<int> p(FROM_HERE);
+  p.GetResolveCallback().Run(123);
+
+  // The antecedent already settled on this sequence so the continuation must
+  // run before ThenHereInline() returns, without spinning a RunLoop.
+  bool run = false;
+  p.promise().ThenHereInline(FROM_HERE, BindLambdaForTesting([&](int result) {
+                               EXPECT_EQ(123, result);
+                               run = true;
+                             }));
+  EXPECT_TRUE(run);
+}
+
+TEST_F(PromiseTest, ThenHereInlinePostsWhenNotSettled) {
+  ManualPromiseResolver<int> p(FROM_HERE);
+
+  RunLoop run_loop;
+  p.promise().ThenHereInline(FROM_HERE, BindLambdaForTesting([&](int result) {
+                               EXPECT_EQ(123, result);
+                               run_loop.Quit();
+                             }));
+  // Not settled yet, so nothing can have run inline.
+  p.GetResolveCallback().Run(123);
+  run_loop.Run();
+}
+
 TEST_F(PromiseTest, GetResolveCallbackThenWithConstInt) {
   ManualPromiseResolver<int> p(FROM_HERE);
   p.GetResolveCallback().Run(123);
@@ -16,6 +16,11 @@ void PromiseValueInternal::NopMove(PromiseValueInternal* src,
 // static
 void PromiseValueInternal::NopDelete(PromiseValueInternal* src) {}
 
+// static
+size_t PromiseValueInternal::NopSize() {
+  return 0u;
+}
+
 constexpr PromiseValueInternal::TypeOps PromiseValueInternal::null_type_;
 
 }  // namespace internal
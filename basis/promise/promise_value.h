@@ -4,10 +4,21 @@
 
 #pragma once
 
+#include <cstddef>
+
 #include "base/base_export.h"
 #include "base/memory/scoped_refptr.h"
 #include "base/parameter_pack.h"
 
+// Number of bytes PromiseValue can store without a heap allocation. Must be
+// at least three words (a PromiseExecutor is stored in the same buffer). The
+// default covers typical payloads - ints, small structs, StatusOr-like types
+// - up to 32 bytes on 64-bit. Projects with larger hot-path payloads can
+// raise this at build time.
+#if !defined(BASIS_PROMISE_VALUE_INLINE_CAPACITY)
+#define BASIS_PROMISE_VALUE_INLINE_CAPACITY (sizeof(void*) * 4)
+#endif
+
 namespace base {
 
 namespace internal {
@@ -122,9 +133,14 @@ struct BASE_EXPORT PromiseValueInternal {
     }
   };
 
-  struct alignas(sizeof(void*)) InlineAlloc {
-    // Holds a T if small. Tweaked to hold a promise executor inline.
-    char bytes[sizeof(void*) * 3];
+  struct alignas(alignof(std::max_align_t)) InlineAlloc {
+    // Holds a T if small. Sized (configurably, see
+    // BASIS_PROMISE_VALUE_INLINE_CAPACITY) to hold at least a promise
+    // executor inline.
+    char bytes[BASIS_PROMISE_VALUE_INLINE_CAPACITY];
+
+    static_assert(BASIS_PROMISE_VALUE_INLINE_CAPACITY >= sizeof(void*) * 3,
+                  "PromiseValue inline capacity must fit a PromiseExecutor");
 
     template <typename T>
     T& value_as() {
@@ -139,12 +155,11 @@ struct BASE_EXPORT PromiseValueInternal {
 
   template <typename T>
   struct InlineStorageHelper {
+    // Over-aligned types fall back to the heap rather than being stored
+    // misaligned.
     static constexpr bool kUseInlineStorage =
-        (sizeof(T) <= sizeof(InlineAlloc));
-
-    static_assert(
-        std::alignment_of<T>::value <= sizeof(T),
-        "Type T has alignment requirements that preclude it's storage inline.");
+        (sizeof(T) <= sizeof(InlineAlloc)) &&
+        (std::alignment_of<T>::value <= alignof(InlineAlloc));
   };
 
   template <typename T>
@@ -173,12 +188,16 @@ struct BASE_EXPORT PromiseValueInternal {
   template <typename T, bool UseInlineStorage>
   struct DeleteHelper;
 
+  template <typename T, bool UseInlineStorage>
+  struct SizeHelper;
+
   template <typename T>
   struct TypeToStateHelper;
 
   using MoveFunctionPtr = void (*)(PromiseValueInternal* src,
                                    PromiseValueInternal* dest);
   using DeleteFunctionPtr = void (*)(PromiseValueInternal* object);
+  using SizeFunctionPtr = size_t (*)();
 
   // Similar to a virtual function but we don't need a dynamic memory
   // allocation. One possible design alternative would be to fold these methods
@@ -192,6 +211,7 @@ struct BASE_EXPORT PromiseValueInternal {
 #endif
     MoveFunctionPtr move_fn_ptr;
     DeleteFunctionPtr delete_fn_ptr;
+    SizeFunctionPtr size_fn_ptr;
   };
 
   template <typename T>
@@ -205,17 +225,19 @@ struct BASE_EXPORT PromiseValueInternal {
         &MoveHelper<T,
                     InlineStorageHelper<T>::kUseInlineStorage,
                     std::is_move_constructible<T>::value>::Move,
-        &DeleteHelper<T, InlineStorageHelper<T>::kUseInlineStorage>::Delete};
+        &DeleteHelper<T, InlineStorageHelper<T>::kUseInlineStorage>::Delete,
+        &SizeHelper<T, InlineStorageHelper<T>::kUseInlineStorage>::Size};
   };
 
   static void NopMove(PromiseValueInternal* src, PromiseValueInternal* dest);
   static void NopDelete(PromiseValueInternal* src);
+  static size_t NopSize();
 
   static constexpr TypeOps null_type_ = {
 #if DCHECK_IS_ON()
       "EMPTY!",
 #endif
-      &NopMove, &NopDelete};
+      &NopMove, &NopDelete, &NopSize};
 
   union {
     OutlineAlloc outline_alloc;
@@ -311,6 +333,19 @@ struct PromiseValueInternal::DeleteHelper<T, /* UseInlineStorage */ false> {
   }
 };
 
+// Heap bytes owned by the container itself: nothing when the value is
+// stored inline, the out-of-line block otherwise. Allocations owned by the
+// stored value (e.g. a std::string payload's buffer) are not visible here.
+template <typename T>
+struct PromiseValueInternal::SizeHelper<T, /* UseInlineStorage */ true> {
+  static size_t Size() { return 0u; }
+};
+
+template <typename T>
+struct PromiseValueInternal::SizeHelper<T, /* UseInlineStorage */ false> {
+  static size_t Size() { return sizeof(T); }
+};
+
 template <typename T>
 struct PromiseValueInternal::TypeToStateHelper {
   static constexpr State state = State::INVALID;
@@ -461,6 +496,13 @@ class BASE_EXPORT PromiseValue {
     other.MarkAsEmpty();
   }
 
+  // Estimates heap bytes owned by this container: zero while the value is
+  // stored inline, the size of the out-of-line block otherwise. Follows the
+  // T::EstimateMemoryUsage() convention (see
+  // base/trace_event/memory_usage_estimator.h) but deliberately does not
+  // recurse into the stored value, whose type has been erased.
+  size_t EstimateMemoryUsage() const { return type_ops_->size_fn_ptr(); }
+
   bool ContainsPromiseExecutor() const {
     return type_ops_.GetState() == State::PROMISE_EXECUTOR;
   }
@@ -519,4 +561,23 @@ class BASE_EXPORT PromiseValue {
 };
 
 }  // namespace internal
+
+// Compile time check that a promise payload of type |T| fits into
+// PromiseValue's inline buffer, i.e. resolving or rejecting with it never
+// heap-allocates. Intended for hot-path payloads:
+//
+//   static_assert(base::PromiseValueIsStoredInline<MyStatus>::value,
+//                 "MyStatus should not heap-allocate in promise chains");
+//
+// If this fires either shrink the payload or raise
+// BASIS_PROMISE_VALUE_INLINE_CAPACITY.
+template <typename T>
+struct PromiseValueIsStoredInline
+    : std::integral_constant<
+          bool,
+          internal::PromiseValueInternal::InlineStorageHelper<
+              Resolved<T>>::kUseInlineStorage &&
+              internal::PromiseValueInternal::InlineStorageHelper<
+                  Rejected<T>>::kUseInlineStorage> {};
+
 }  // namespace base
@@ -223,5 +223,22 @@ TEST(PromiseValueTest, DestructorCalledOnAssignment) {
   EXPECT_TRUE(destructor_called);
 }
 
+TEST(PromiseValueTest, SmallPayloadsAreStoredInline) {
+  struct SmallStatus {
+    int code;
+    const char* message;
+  };
+  static_assert(PromiseValueIsStoredInline<int>::value,
+                "int payloads must never heap-allocate");
+  static_assert(PromiseValueIsStoredInline<SmallStatus>::value,
+                "small struct payloads must never heap-allocate");
+
+  struct Big {
+    char bytes[BASIS_PROMISE_VALUE_INLINE_CAPACITY + 1];
+  };
+  static_assert(!PromiseValueIsStoredInline<Big>::value,
+                "oversized payloads fall back to the heap");
+}
+
 }  // namespace internal
 }  // namespace base
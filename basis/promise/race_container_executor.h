@@ -37,6 +37,9 @@ public:
      if (first_settled->IsRejected()) {
        AllPromiseRejectHelper<Rejected<RejectType>>
          ::Reject(promise, first_settled);
+       // The race has a winner; stop the losing chains from burning CPU and
+       // I/O on work nobody will consume.
+       promise->CancelUnsettledPrerequisiteChains(first_settled);
        return;
      }
 
@@ -44,6 +47,7 @@ public:
      if (first_settled->IsResolved()) {
        AllPromiseResolveHelper<Resolved<ResolveType>>
          ::Resolve(promise, first_settled);
+       promise->CancelUnsettledPrerequisiteChains(first_settled);
        return;
      }
    }
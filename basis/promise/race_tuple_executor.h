@@ -31,16 +31,20 @@ class RaceTuplePromiseExecutor {
       if (first_settled->IsRejected()) {
         AllPromiseRejectHelper<Rejected<RejectType>>
           ::Reject(promise, first_settled);
+        // The race has a winner; stop the losing chains from burning CPU and
+        // I/O on work nobody will consume.
+        promise->CancelUnsettledPrerequisiteChains(first_settled);
         return;
       }
 
       // Race is resolved if any prerequisites are resolved.
       if (first_settled->IsResolved()) {
-        const std::vector<DependentList::Node>* prerequisite_list =
+        const AbstractPromise::PrerequisiteList* prerequisite_list =
             promise->prerequisite_list();
         DCHECK(prerequisite_list);
         TupleConstructor<ResolveType>
           ::ConstructOptionallyResolvedTuple(prerequisite_list, promise);
+        promise->CancelUnsettledPrerequisiteChains(first_settled);
         return;
       }
     }
@@ -0,0 +1,147 @@
+#include "basis/scoped_profile.hpp" // IWYU pragma: associated
+
+#include <base/synchronization/lock.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h> // for __rdtsc
+#endif
+
+namespace basis {
+
+namespace {
+
+// Guards site registration, per-site thread block ownership and the
+// calibration pair. Never taken on the measurement path.
+struct RegistryState {
+  RegistryState()
+      : calibration_cycles(ProfileNowCycles()),
+        calibration_time(std::chrono::steady_clock::now()) {}
+
+  base::Lock lock;
+  ProfileSite* sites[ProfileSite::kMaxSites] = {};
+  size_t site_count = 0;
+
+  // TSC frequency reference: cycles elapsed since this pair divided by
+  // wall nanoseconds elapsed gives cycles-per-ns at Export time.
+  const uint64_t calibration_cycles;
+  const std::chrono::steady_clock::time_point calibration_time;
+};
+
+RegistryState& State() {
+  // Leaked: sites are function-local statics that may be constructed
+  // and used during static destruction.
+  static RegistryState* state = new RegistryState();
+  return *state;
+}
+
+// Bucket upper bound in cycles (see ProfileSite::BucketIndex).
+uint64_t BucketUpperBoundCycles(size_t index) {
+  return index >= 63 ? ~uint64_t{0} : (uint64_t{1} << (index + 1));
+}
+
+uint64_t CyclesToNs(uint64_t cycles, double cycles_per_ns) {
+  return static_cast<uint64_t>(static_cast<double>(cycles) / cycles_per_ns);
+}
+
+// Rank scan over aggregated buckets; |fraction| in [0, 1].
+uint64_t PercentileCycles(const uint64_t (&buckets)[ProfileSite::kBucketCount],
+                          uint64_t total,
+                          double fraction) {
+  if (total == 0)
+    return 0;
+  const uint64_t rank =
+      static_cast<uint64_t>(fraction * static_cast<double>(total));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < ProfileSite::kBucketCount; ++i) {
+    seen += buckets[i];
+    if (seen > rank || seen >= total)
+      return BucketUpperBoundCycles(i);
+  }
+  return BucketUpperBoundCycles(ProfileSite::kBucketCount - 1);
+}
+
+}  // namespace
+
+uint64_t ProfileNowCycles() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#elif defined(__aarch64__)
+  uint64_t virtual_timer;
+  asm volatile("mrs %0, cntvct_el0" : "=r"(virtual_timer));
+  return virtual_timer;
+#else
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+#endif
+}
+
+ProfileSite::ProfileSite(const char* name)
+    : name_(name), site_index_(ProfileRegistry::RegisterSite(this)) {}
+
+ProfileSite::ThreadBuckets* ProfileSite::RegisterThread() {
+  auto buckets = std::make_unique<ThreadBuckets>();
+  ThreadBuckets* raw = buckets.get();
+  {
+    base::AutoLock lock(State().lock);
+    thread_blocks_.push_back(std::move(buckets));
+  }
+  ThreadSlot() = raw;
+  return raw;
+}
+
+// static
+size_t ProfileRegistry::RegisterSite(ProfileSite* site) {
+  RegistryState& state = State();
+  base::AutoLock lock(state.lock);
+  CHECK(state.site_count < ProfileSite::kMaxSites)
+      << "too many ProfileSites; raise ProfileSite::kMaxSites";
+  const size_t index = state.site_count++;
+  state.sites[index] = site;
+  return index;
+}
+
+// static
+std::vector<ProfileRegistry::SiteStats> ProfileRegistry::Export() {
+  RegistryState& state = State();
+
+  const uint64_t now_cycles = ProfileNowCycles();
+  const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - state.calibration_time);
+  double cycles_per_ns =
+      static_cast<double>(now_cycles - state.calibration_cycles) /
+      static_cast<double>(
+          elapsed.count() > 0 ? elapsed.count() : 1);
+  if (cycles_per_ns <= 0.0)
+    cycles_per_ns = 1.0;
+
+  std::vector<SiteStats> stats;
+  base::AutoLock lock(state.lock);
+  stats.reserve(state.site_count);
+  for (size_t i = 0; i < state.site_count; ++i) {
+    const ProfileSite& site = *state.sites[i];
+    uint64_t buckets[ProfileSite::kBucketCount] = {};
+    SiteStats site_stats;
+    site_stats.name = site.name();
+    uint64_t max_cycles = 0;
+    // Plain reads racing the owning threads' plain writes: a snapshot
+    // may lag by in-flight samples, which is fine for monitoring.
+    for (const auto& block : site.thread_blocks_) {
+      for (size_t b = 0; b < ProfileSite::kBucketCount; ++b)
+        buckets[b] += block->buckets[b];
+      site_stats.count += block->count;
+      if (block->max_cycles > max_cycles)
+        max_cycles = block->max_cycles;
+    }
+    site_stats.p50_ns = CyclesToNs(
+        PercentileCycles(buckets, site_stats.count, 0.50), cycles_per_ns);
+    site_stats.p99_ns = CyclesToNs(
+        PercentileCycles(buckets, site_stats.count, 0.99), cycles_per_ns);
+    site_stats.max_ns = CyclesToNs(max_cycles, cycles_per_ns);
+    stats.push_back(site_stats);
+  }
+  return stats;
+}
+
+}  // namespace basis
@@ -4,12 +4,742 @@
 
 #include "chromecast/base/serializers.h"
 
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <set>
+#include <utility>
+
+#include "base/files/file_util.h"
+#include "base/files/memory_mapped_file.h"
 #include "base/json/json_file_value_serializer.h"
 #include "base/json/json_string_value_serializer.h"
 #include "base/logging.h"
+#include "base/macros.h"
+#include "base/strings/string_util.h"
+#include "base/task/task_traits.h"
+#include "base/values.h"
+#include "basis/async_file.hpp"
+#include "basis/immutable.hpp"
+#include "basis/promise/post_promise.h"
 
 namespace chromecast {
 
+namespace {
+
+// Matches the nesting limit of base::JSONReader so documents accepted by
+// DeserializeFromJson are accepted here too.
+const int kMaxNestingDepth = 200;
+
+// Single-pass recursive-descent scanner behind StreamJsonFromString.
+// Strings are unescaped into |scratch_| and handed to the handler as
+// StringPieces, so no per-token allocation happens after the scratch
+// buffer reaches the length of the longest string in the document.
+class JsonStreamParser {
+ public:
+  JsonStreamParser(base::StringPiece text, JsonStreamHandler* handler)
+      : text_(text), pos_(0), handler_(handler) {}
+
+  bool Parse() {
+    if (!ParseValue(0))
+      return false;
+    SkipWhitespace();
+    // Trailing garbage after the document is an error, like JSONReader.
+    return pos_ == text_.size();
+  }
+
+ private:
+  bool ParseValue(int depth) {
+    if (depth > kMaxNestingDepth)
+      return false;
+    SkipWhitespace();
+    if (pos_ >= text_.size())
+      return false;
+    switch (text_[pos_]) {
+      case '{':
+        return ParseObject(depth);
+      case '[':
+        return ParseArray(depth);
+      case '"': {
+        base::StringPiece string_value;
+        if (!ParseString(&string_value))
+          return false;
+        return handler_->StringValue(string_value);
+      }
+      case 't':
+        return ConsumeLiteral("true") && handler_->BoolValue(true);
+      case 'f':
+        return ConsumeLiteral("false") && handler_->BoolValue(false);
+      case 'n':
+        return ConsumeLiteral("null") && handler_->NullValue();
+      default:
+        return ParseNumber();
+    }
+  }
+
+  bool ParseObject(int depth) {
+    DCHECK_EQ(text_[pos_], '{');
+    ++pos_;
+    if (!handler_->BeginObject())
+      return false;
+    SkipWhitespace();
+    if (pos_ < text_.size() && text_[pos_] == '}') {
+      ++pos_;
+      return handler_->EndObject();
+    }
+    for (;;) {
+      SkipWhitespace();
+      if (pos_ >= text_.size() || text_[pos_] != '"')
+        return false;
+      base::StringPiece key;
+      if (!ParseString(&key))
+        return false;
+      if (!handler_->Key(key))
+        return false;
+      SkipWhitespace();
+      if (pos_ >= text_.size() || text_[pos_] != ':')
+        return false;
+      ++pos_;
+      if (!ParseValue(depth + 1))
+        return false;
+      SkipWhitespace();
+      if (pos_ >= text_.size())
+        return false;
+      if (text_[pos_] == ',') {
+        ++pos_;
+        continue;
+      }
+      if (text_[pos_] == '}') {
+        ++pos_;
+        return handler_->EndObject();
+      }
+      return false;
+    }
+  }
+
+  bool ParseArray(int depth) {
+    DCHECK_EQ(text_[pos_], '[');
+    ++pos_;
+    if (!handler_->BeginArray())
+      return false;
+    SkipWhitespace();
+    if (pos_ < text_.size() && text_[pos_] == ']') {
+      ++pos_;
+      return handler_->EndArray();
+    }
+    for (;;) {
+      if (!ParseValue(depth + 1))
+        return false;
+      SkipWhitespace();
+      if (pos_ >= text_.size())
+        return false;
+      if (text_[pos_] == ',') {
+        ++pos_;
+        continue;
+      }
+      if (text_[pos_] == ']') {
+        ++pos_;
+        return handler_->EndArray();
+      }
+      return false;
+    }
+  }
+
+  // Parses the quoted string at |pos_|. Strings without escape
+  // sequences are returned as a zero-copy StringPiece into |text_| (so
+  // callers parsing from a memory-mapped file never copy them); only
+  // strings containing escapes are unescaped into |scratch_|.
+  bool ParseString(base::StringPiece* out) {
+    DCHECK_EQ(text_[pos_], '"');
+    ++pos_;
+    const size_t body_start = pos_;
+    while (pos_ < text_.size()) {
+      char c = text_[pos_];
+      if (c == '"') {
+        *out = text_.substr(body_start, pos_ - body_start);
+        ++pos_;
+        return true;
+      }
+      if (c == '\\')
+        return ParseEscapedString(body_start, out);
+      ++pos_;
+    }
+    return false;  // Unterminated string.
+  }
+
+  // Slow path of ParseString: copies [body_start, pos_) into |scratch_|
+  // and continues unescaping from the first backslash.
+  bool ParseEscapedString(size_t body_start, base::StringPiece* out) {
+    std::string* unescaped = &scratch_;
+    unescaped->assign(text_.data() + body_start, pos_ - body_start);
+    while (pos_ < text_.size()) {
+      char c = text_[pos_++];
+      if (c == '"') {
+        *out = *unescaped;
+        return true;
+      }
+      if (c != '\\') {
+        unescaped->push_back(c);
+        continue;
+      }
+      if (pos_ >= text_.size())
+        return false;
+      char escaped = text_[pos_++];
+      switch (escaped) {
+        case '"':
+        case '\\':
+        case '/':
+          unescaped->push_back(escaped);
+          break;
+        case 'b':
+          unescaped->push_back('\b');
+          break;
+        case 'f':
+          unescaped->push_back('\f');
+          break;
+        case 'n':
+          unescaped->push_back('\n');
+          break;
+        case 'r':
+          unescaped->push_back('\r');
+          break;
+        case 't':
+          unescaped->push_back('\t');
+          break;
+        case 'u': {
+          uint32_t code_point;
+          if (!ParseUnicodeEscape(&code_point))
+            return false;
+          AppendUtf8(code_point, unescaped);
+          break;
+        }
+        default:
+          return false;
+      }
+    }
+    return false;  // Unterminated string.
+  }
+
+  // Parses the 4 hex digits after "\u" (and a low surrogate if needed).
+  bool ParseUnicodeEscape(uint32_t* code_point) {
+    uint32_t unit;
+    if (!ParseHex4(&unit))
+      return false;
+    if (unit >= 0xD800 && unit <= 0xDBFF) {
+      // High surrogate; must be followed by "\uDC00".."\uDFFF".
+      if (pos_ + 1 >= text_.size() || text_[pos_] != '\\' ||
+          text_[pos_ + 1] != 'u') {
+        return false;
+      }
+      pos_ += 2;
+      uint32_t low;
+      if (!ParseHex4(&low) || low < 0xDC00 || low > 0xDFFF)
+        return false;
+      *code_point = 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00);
+      return true;
+    }
+    if (unit >= 0xDC00 && unit <= 0xDFFF)
+      return false;  // Unpaired low surrogate.
+    *code_point = unit;
+    return true;
+  }
+
+  bool ParseHex4(uint32_t* out) {
+    if (pos_ + 4 > text_.size())
+      return false;
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+      char c = text_[pos_++];
+      value <<= 4;
+      if (c >= '0' && c <= '9')
+        value |= c - '0';
+      else if (c >= 'a' && c <= 'f')
+        value |= c - 'a' + 10;
+      else if (c >= 'A' && c <= 'F')
+        value |= c - 'A' + 10;
+      else
+        return false;
+    }
+    *out = value;
+    return true;
+  }
+
+  static void AppendUtf8(uint32_t cp, std::string* out) {
+    if (cp < 0x80) {
+      out->push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+      out->push_back(static_cast<char>(0xC0 | (cp >> 6)));
+      out->push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+      out->push_back(static_cast<char>(0xE0 | (cp >> 12)));
+      out->push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+      out->push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else {
+      out->push_back(static_cast<char>(0xF0 | (cp >> 18)));
+      out->push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+      out->push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+      out->push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+  }
+
+  bool ParseNumber() {
+    size_t start = pos_;
+    if (pos_ < text_.size() && text_[pos_] == '-')
+      ++pos_;
+    if (pos_ >= text_.size() || !base::IsAsciiDigit(text_[pos_]))
+      return false;
+    bool is_double = false;
+    while (pos_ < text_.size()) {
+      char c = text_[pos_];
+      if (base::IsAsciiDigit(c)) {
+        ++pos_;
+      } else if (c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-') {
+        is_double = true;
+        ++pos_;
+      } else {
+        break;
+      }
+    }
+    // The token is bounded, so copy it for strtod's NUL terminator.
+    std::string token(text_.substr(start, pos_ - start).as_string());
+    char* end = nullptr;
+    double number = std::strtod(token.c_str(), &end);
+    if (end != token.c_str() + token.size())
+      return false;
+    if (!is_double && number >= std::numeric_limits<int>::min() &&
+        number <= std::numeric_limits<int>::max()) {
+      return handler_->IntValue(static_cast<int>(number));
+    }
+    return handler_->DoubleValue(number);
+  }
+
+  bool ConsumeLiteral(base::StringPiece literal) {
+    if (text_.substr(pos_, literal.size()) != literal)
+      return false;
+    pos_ += literal.size();
+    return true;
+  }
+
+  void SkipWhitespace() {
+    while (pos_ < text_.size() && base::IsAsciiWhitespace(text_[pos_]))
+      ++pos_;
+  }
+
+  const base::StringPiece text_;
+  size_t pos_;
+  JsonStreamHandler* const handler_;
+  std::string scratch_;
+
+  DISALLOW_COPY_AND_ASSIGN(JsonStreamParser);
+};
+
+// Handler behind DeserializeJsonPaths: tracks the current dotted key
+// path through nested objects and, when it hits a requested path, builds
+// just that subtree into base::Value; everything else is discarded as it
+// streams by.
+class FilteringHandler : public JsonStreamHandler {
+ public:
+  explicit FilteringHandler(const std::vector<std::string>& key_paths)
+      : key_paths_(key_paths.begin(), key_paths.end()),
+        result_(std::make_unique<base::DictionaryValue>()) {}
+
+  std::unique_ptr<base::DictionaryValue> TakeResult() {
+    return std::move(result_);
+  }
+
+  // JsonStreamHandler implementation:
+  bool BeginObject() override {
+    if (capturing())
+      return CaptureBegin(std::make_unique<base::DictionaryValue>());
+    // An object frame; its current key is filled in by Key().
+    frames_.push_back(Frame{true, std::string()});
+    return true;
+  }
+
+  bool EndObject() override {
+    if (capturing())
+      return CaptureEnd();
+    frames_.pop_back();
+    return true;
+  }
+
+  bool BeginArray() override {
+    if (capturing())
+      return CaptureBegin(std::make_unique<base::ListValue>());
+    // Array elements are not addressable by dotted paths, so nothing
+    // under this frame can match.
+    frames_.push_back(Frame{false, std::string()});
+    return true;
+  }
+
+  bool EndArray() override {
+    if (capturing())
+      return CaptureEnd();
+    frames_.pop_back();
+    return true;
+  }
+
+  bool Key(base::StringPiece key) override {
+    if (capturing()) {
+      pending_key_ = key.as_string();
+      return true;
+    }
+    frames_.back().key = key.as_string();
+    if (key_paths_.count(CurrentPath())) {
+      // The next value (scalar or whole subtree) belongs to the caller.
+      capture_path_ = CurrentPath();
+      capture_armed_ = true;
+    }
+    return true;
+  }
+
+  bool StringValue(base::StringPiece value) override {
+    return Scalar(base::Value(value));
+  }
+  bool IntValue(int value) override { return Scalar(base::Value(value)); }
+  bool DoubleValue(double value) override { return Scalar(base::Value(value)); }
+  bool BoolValue(bool value) override { return Scalar(base::Value(value)); }
+  bool NullValue() override { return Scalar(base::Value()); }
+
+ private:
+  struct Frame {
+    bool is_object;
+    std::string key;
+  };
+
+  bool capturing() const { return capture_armed_ || !capture_stack_.empty(); }
+
+  std::string CurrentPath() const {
+    std::string path;
+    for (const Frame& frame : frames_) {
+      if (!frame.is_object)
+        return std::string();  // Unreachable via Key(); arrays never match.
+      if (!path.empty())
+        path += '.';
+      path += frame.key;
+    }
+    return path;
+  }
+
+  bool Scalar(base::Value value) {
+    if (!capturing())
+      return true;
+    return Attach(base::Value::ToUniquePtrValue(std::move(value)));
+  }
+
+  bool CaptureBegin(std::unique_ptr<base::Value> container) {
+    capture_stack_.push_back(
+        std::make_pair(std::move(container), pending_key_));
+    pending_key_.clear();
+    return true;
+  }
+
+  bool CaptureEnd() {
+    std::unique_ptr<base::Value> finished =
+        std::move(capture_stack_.back().first);
+    std::string key = capture_stack_.back().second;
+    capture_stack_.pop_back();
+    pending_key_ = key;
+    return Attach(std::move(finished));
+  }
+
+  // Stores |value| into the innermost container being captured, or into
+  // the result when the captured subtree is complete.
+  bool Attach(std::unique_ptr<base::Value> value) {
+    if (capture_stack_.empty()) {
+      capture_armed_ = false;
+      // Set() expands the dotted path, so the result keeps the source
+      // document's nesting.
+      result_->Set(capture_path_, std::move(value));
+      return true;
+    }
+    base::Value* container = capture_stack_.back().first.get();
+    if (container->is_dict()) {
+      static_cast<base::DictionaryValue*>(container)
+          ->SetWithoutPathExpansion(pending_key_, std::move(value));
+      pending_key_.clear();
+    } else {
+      static_cast<base::ListValue*>(container)->Append(std::move(value));
+    }
+    return true;
+  }
+
+  const std::set<std::string> key_paths_;
+  std::unique_ptr<base::DictionaryValue> result_;
+
+  // Object/array nesting outside a capture.
+  std::vector<Frame> frames_;
+
+  // Set between a matching Key() and the arrival of its value.
+  bool capture_armed_ = false;
+  std::string capture_path_;
+
+  // In-progress containers of the subtree being captured, with the
+  // object key each will be attached under.
+  std::vector<std::pair<std::unique_ptr<base::Value>, std::string>>
+      capture_stack_;
+  std::string pending_key_;
+
+  DISALLOW_COPY_AND_ASSIGN(FilteringHandler);
+};
+
+// Binary value format ("CBV", version 1)
+// --------------------------------------
+// A 4-byte header "CBV1" followed by one encoded value. Values are a
+// 1-byte type tag plus a payload; lengths/counts are unsigned LEB128
+// varints, multi-byte integers are little-endian:
+//
+//   kNull     (no payload)
+//   kFalse    (no payload)
+//   kTrue     (no payload)
+//   kInt      int32, 4 bytes
+//   kDouble   IEEE 754 binary64, 8 bytes
+//   kString   varint byte length, then UTF-8 bytes
+//   kBlob     varint byte length, then raw bytes
+//   kList     varint element count, then that many values
+//   kDict     varint entry count, then (varint key length, key bytes,
+//             value) per entry
+//
+// This mirrors CBOR's shape (tag + varint length) without pulling in a
+// CBOR library; the header makes files self-describing so readers can
+// dispatch on format (see DeserializeValueFromFile).
+const char kBinaryFormatMagic[4] = {'C', 'B', 'V', '1'};
+
+enum BinaryTag : uint8_t {
+  kNull = 0,
+  kFalse = 1,
+  kTrue = 2,
+  kInt = 3,
+  kDouble = 4,
+  kString = 5,
+  kBlob = 6,
+  kList = 7,
+  kDict = 8,
+};
+
+void AppendVarint(uint64_t value, std::string* out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+template <typename IntType>
+void AppendLittleEndian(IntType value, std::string* out) {
+  for (size_t i = 0; i < sizeof(IntType); ++i)
+    out->push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+}
+
+bool EncodeBinaryValue(const base::Value& value, std::string* out) {
+  switch (value.type()) {
+    case base::Value::Type::NONE:
+      out->push_back(kNull);
+      return true;
+    case base::Value::Type::BOOLEAN:
+      out->push_back(value.GetBool() ? kTrue : kFalse);
+      return true;
+    case base::Value::Type::INTEGER:
+      out->push_back(kInt);
+      AppendLittleEndian(static_cast<uint32_t>(value.GetInt()), out);
+      return true;
+    case base::Value::Type::DOUBLE: {
+      out->push_back(kDouble);
+      uint64_t bits;
+      double number = value.GetDouble();
+      std::memcpy(&bits, &number, sizeof(bits));
+      AppendLittleEndian(bits, out);
+      return true;
+    }
+    case base::Value::Type::STRING: {
+      const std::string& str = value.GetString();
+      out->push_back(kString);
+      AppendVarint(str.size(), out);
+      out->append(str);
+      return true;
+    }
+    case base::Value::Type::BINARY: {
+      const base::Value::BlobStorage& blob = value.GetBlob();
+      out->push_back(kBlob);
+      AppendVarint(blob.size(), out);
+      out->append(reinterpret_cast<const char*>(blob.data()), blob.size());
+      return true;
+    }
+    case base::Value::Type::LIST: {
+      const base::Value::ListStorage& list = value.GetList();
+      out->push_back(kList);
+      AppendVarint(list.size(), out);
+      for (const base::Value& item : list) {
+        if (!EncodeBinaryValue(item, out))
+          return false;
+      }
+      return true;
+    }
+    case base::Value::Type::DICTIONARY: {
+      out->push_back(kDict);
+      AppendVarint(value.DictSize(), out);
+      for (const auto& entry : value.DictItems()) {
+        AppendVarint(entry.first.size(), out);
+        out->append(entry.first);
+        if (!EncodeBinaryValue(entry.second, out))
+          return false;
+      }
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+// Bounds-checked reader over the encoded bytes.
+class BinaryValueReader {
+ public:
+  explicit BinaryValueReader(base::StringPiece data)
+      : data_(data), pos_(0) {}
+
+  // Decodes one value. Returns base::nullopt on corrupt input.
+  base::Optional<base::Value> DecodeValue(int depth) {
+    if (depth > kMaxNestingDepth)
+      return base::nullopt;
+    uint8_t tag;
+    if (!ReadByte(&tag))
+      return base::nullopt;
+    switch (tag) {
+      case kNull:
+        return base::Value();
+      case kFalse:
+        return base::Value(false);
+      case kTrue:
+        return base::Value(true);
+      case kInt: {
+        uint32_t raw;
+        if (!ReadLittleEndian(&raw))
+          return base::nullopt;
+        return base::Value(static_cast<int>(raw));
+      }
+      case kDouble: {
+        uint64_t bits;
+        if (!ReadLittleEndian(&bits))
+          return base::nullopt;
+        double number;
+        std::memcpy(&number, &bits, sizeof(number));
+        return base::Value(number);
+      }
+      case kString: {
+        base::StringPiece bytes;
+        if (!ReadLengthPrefixedBytes(&bytes))
+          return base::nullopt;
+        return base::Value(bytes);
+      }
+      case kBlob: {
+        base::StringPiece bytes;
+        if (!ReadLengthPrefixedBytes(&bytes))
+          return base::nullopt;
+        return base::Value(base::Value::BlobStorage(
+            bytes.data(), bytes.data() + bytes.size()));
+      }
+      case kList: {
+        uint64_t count;
+        if (!ReadVarint(&count))
+          return base::nullopt;
+        base::Value::ListStorage list;
+        // Every element costs at least one tag byte, so |count| larger
+        // than the remaining input is corrupt; don't pre-reserve it.
+        if (count > data_.size() - pos_)
+          return base::nullopt;
+        list.reserve(count);
+        for (uint64_t i = 0; i < count; ++i) {
+          base::Optional<base::Value> item = DecodeValue(depth + 1);
+          if (!item)
+            return base::nullopt;
+          list.push_back(std::move(*item));
+        }
+        return base::Value(std::move(list));
+      }
+      case kDict: {
+        uint64_t count;
+        if (!ReadVarint(&count))
+          return base::nullopt;
+        base::Value dict(base::Value::Type::DICTIONARY);
+        for (uint64_t i = 0; i < count; ++i) {
+          base::StringPiece key;
+          if (!ReadLengthPrefixedBytes(&key))
+            return base::nullopt;
+          base::Optional<base::Value> item = DecodeValue(depth + 1);
+          if (!item)
+            return base::nullopt;
+          dict.SetKey(key, std::move(*item));
+        }
+        return dict;
+      }
+      default:
+        return base::nullopt;
+    }
+  }
+
+  bool AtEnd() const { return pos_ == data_.size(); }
+
+ private:
+  bool ReadByte(uint8_t* out) {
+    if (pos_ >= data_.size())
+      return false;
+    *out = static_cast<uint8_t>(data_[pos_++]);
+    return true;
+  }
+
+  bool ReadVarint(uint64_t* out) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      uint8_t byte;
+      if (!ReadByte(&byte))
+        return false;
+      value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      if (!(byte & 0x80)) {
+        *out = value;
+        return true;
+      }
+    }
+    return false;  // Over-long varint.
+  }
+
+  template <typename IntType>
+  bool ReadLittleEndian(IntType* out) {
+    if (pos_ + sizeof(IntType) > data_.size())
+      return false;
+    IntType value = 0;
+    for (size_t i = 0; i < sizeof(IntType); ++i)
+      value |= static_cast<IntType>(static_cast<uint8_t>(data_[pos_ + i]))
+               << (8 * i);
+    pos_ += sizeof(IntType);
+    *out = value;
+    return true;
+  }
+
+  bool ReadLengthPrefixedBytes(base::StringPiece* out) {
+    uint64_t length;
+    if (!ReadVarint(&length))
+      return false;
+    if (length > data_.size() - pos_)
+      return false;
+    *out = data_.substr(pos_, length);
+    pos_ += length;
+    return true;
+  }
+
+  const base::StringPiece data_;
+  size_t pos_;
+
+  DISALLOW_COPY_AND_ASSIGN(BinaryValueReader);
+};
+
+bool HasBinaryFormatMagic(base::StringPiece data) {
+  return data.size() >= sizeof(kBinaryFormatMagic) &&
+         std::memcmp(data.data(), kBinaryFormatMagic,
+                     sizeof(kBinaryFormatMagic)) == 0;
+}
+
+}  // namespace
+
 std::unique_ptr<base::Value> DeserializeFromJson(const std::string& text) {
   JSONStringValueDeserializer deserializer(text);
 
@@ -50,4 +780,187 @@ bool SerializeJsonToFile(const base::FilePath& path, const base::Value& value) {
   return serializer.Serialize(value);
 }
 
+base::Promise<bool, base::NoReject> SerializeJsonToFileAsync(
+    const base::FilePath& path,
+    base::Value value) {
+  // O(1) handover: |value| is swapped (not cloned) into a thread-safe
+  // ref-counted snapshot, so binding it across threads never copies the
+  // tree and the caller's sequence does no encode work at all.
+  basis::Immutable<base::Value> snapshot(&value);
+  scoped_refptr<base::SequencedTaskRunner> task_runner =
+      base::CreateSequencedTaskRunnerWithTraits(
+          {base::MayBlock(), base::TaskPriority::BEST_EFFORT,
+           base::TaskShutdownBehavior::BLOCK_SHUTDOWN});
+  return base::PostPromise(
+      FROM_HERE, task_runner.get(),
+      base::BindOnce(
+          [](const base::FilePath& path,
+             basis::Immutable<base::Value> snapshot) {
+            // Encode first, then write through AsyncFile so the write
+            // rides the io_uring-batched path where the kernel has it
+            // (plain syscalls otherwise; same result either way).
+            base::Optional<std::string> json =
+                SerializeToJson(snapshot.Get());
+            if (!json)
+              return false;
+            return basis::AsyncFile::WriteFileBlocking(path, *json);
+          },
+          path, std::move(snapshot)));
+}
+
+base::Promise<std::unique_ptr<base::Value>, base::NoReject>
+DeserializeJsonFromFileAsync(const base::FilePath& path) {
+  scoped_refptr<base::SequencedTaskRunner> task_runner =
+      base::CreateSequencedTaskRunnerWithTraits(
+          {base::MayBlock(), base::TaskPriority::BEST_EFFORT,
+           base::TaskShutdownBehavior::BLOCK_SHUTDOWN});
+  return base::PostPromise(
+      FROM_HERE, task_runner.get(),
+      base::BindOnce(
+          [](const base::FilePath& path) {
+            std::string contents;
+            if (!basis::AsyncFile::ReadFileToStringBlocking(path,
+                                                            &contents)) {
+              DLOG(ERROR) << "Failed to read " << path.value();
+              return std::unique_ptr<base::Value>();
+            }
+            return DeserializeFromJson(contents);
+          },
+          path));
+}
+
+std::unique_ptr<base::Value> DeserializeJsonFromMappedFile(
+    const base::FilePath& path) {
+  base::MemoryMappedFile mapped;
+  if (!mapped.Initialize(path)) {
+    DLOG(ERROR) << "Failed to map " << path.value();
+    return nullptr;
+  }
+  // Parse straight from the mapping; the deserializer never copies the
+  // input, only the strings that end up owned by the resulting tree.
+  JSONStringValueDeserializer deserializer(base::StringPiece(
+      reinterpret_cast<const char*>(mapped.data()), mapped.length()));
+
+  int error_code = -1;
+  std::string error_msg;
+  std::unique_ptr<base::Value> value =
+      deserializer.Deserialize(&error_code, &error_msg);
+  DLOG_IF(ERROR, !value) << "JSON error " << error_code << ":" << error_msg;
+
+  // Value will hold the nullptr in case of an error.
+  return value;
+}
+
+base::Optional<std::string> SerializeToBinary(const base::Value& value) {
+  std::string encoded(kBinaryFormatMagic, sizeof(kBinaryFormatMagic));
+  if (!EncodeBinaryValue(value, &encoded))
+    return base::nullopt;
+  return encoded;
+}
+
+std::unique_ptr<base::Value> DeserializeFromBinary(const std::string& data) {
+  if (!HasBinaryFormatMagic(data)) {
+    DLOG(ERROR) << "Binary value header missing";
+    return nullptr;
+  }
+  BinaryValueReader reader(
+      base::StringPiece(data).substr(sizeof(kBinaryFormatMagic)));
+  base::Optional<base::Value> value = reader.DecodeValue(0);
+  // Trailing bytes after the root value mean corruption, same as
+  // trailing garbage after a JSON document.
+  if (!value || !reader.AtEnd()) {
+    DLOG(ERROR) << "Corrupt or truncated binary value";
+    return nullptr;
+  }
+  return base::Value::ToUniquePtrValue(std::move(*value));
+}
+
+bool SerializeValueToFile(const base::FilePath& path,
+                          const base::Value& value,
+                          ValueFileFormat format) {
+  if (format == ValueFileFormat::kJson)
+    return SerializeJsonToFile(path, value);
+  base::Optional<std::string> encoded = SerializeToBinary(value);
+  if (!encoded)
+    return false;
+  int size = static_cast<int>(encoded->size());
+  return base::WriteFile(path, encoded->data(), size) == size;
+}
+
+std::unique_ptr<base::Value> DeserializeValueFromFile(
+    const base::FilePath& path) {
+  std::string content;
+  if (!base::ReadFileToString(path, &content))
+    return nullptr;
+  if (HasBinaryFormatMagic(content))
+    return DeserializeFromBinary(content);
+  return DeserializeFromJson(content);
+}
+
+JsonStreamHandler::~JsonStreamHandler() {}
+
+bool JsonStreamHandler::BeginObject() {
+  return true;
+}
+bool JsonStreamHandler::EndObject() {
+  return true;
+}
+bool JsonStreamHandler::BeginArray() {
+  return true;
+}
+bool JsonStreamHandler::EndArray() {
+  return true;
+}
+bool JsonStreamHandler::Key(base::StringPiece key) {
+  return true;
+}
+bool JsonStreamHandler::StringValue(base::StringPiece value) {
+  return true;
+}
+bool JsonStreamHandler::IntValue(int value) {
+  return true;
+}
+bool JsonStreamHandler::DoubleValue(double value) {
+  return true;
+}
+bool JsonStreamHandler::BoolValue(bool value) {
+  return true;
+}
+bool JsonStreamHandler::NullValue() {
+  return true;
+}
+
+bool StreamJsonFromString(base::StringPiece text, JsonStreamHandler* handler) {
+  DCHECK(handler);
+  JsonStreamParser parser(text, handler);
+  return parser.Parse();
+}
+
+bool StreamJsonFromFile(const base::FilePath& path,
+                        JsonStreamHandler* handler) {
+  DCHECK(handler);
+  base::MemoryMappedFile mapped;
+  if (!mapped.Initialize(path)) {
+    DLOG(ERROR) << "Failed to map " << path.value();
+    return false;
+  }
+  // Escape-free strings reach the handler as StringPieces into the
+  // mapping, so the whole parse is zero-copy for the common case.
+  return StreamJsonFromString(
+      base::StringPiece(reinterpret_cast<const char*>(mapped.data()),
+                        mapped.length()),
+      handler);
+}
+
+std::unique_ptr<base::Value> DeserializeJsonPaths(
+    const std::string& text,
+    const std::vector<std::string>& key_paths) {
+  FilteringHandler handler(key_paths);
+  if (!StreamJsonFromString(text, &handler)) {
+    DLOG(ERROR) << "JSON error while extracting key paths";
+    return nullptr;
+  }
+  return handler.TakeResult();
+}
+
 }  // namespace chromecast
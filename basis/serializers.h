@@ -7,8 +7,11 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "base/optional.h"
+#include "base/strings/string_piece.h"
+#include "basis/promise/promise.h"
 
 namespace base {
 class Value;
@@ -20,6 +23,8 @@ namespace chromecast {
 // Helper function which deserializes JSON |text| into a base::Value. If |text|
 // is empty, is not valid JSON, or if some other deserialization error occurs,
 // the return value will hold the NULL pointer.
+// For read-only consumers that traverse the whole document, see the
+// cache-friendly DeserializeFromJsonFlat (basis/flat_json.h).
 std::unique_ptr<base::Value> DeserializeFromJson(const std::string& text);
 
 // Helper function which serializes |value| into a JSON string. If a
@@ -34,10 +39,124 @@ base::Optional<std::string> SerializeToJson(const base::Value& value);
 std::unique_ptr<base::Value> DeserializeJsonFromFile(
     const base::FilePath& path);
 
+// Like DeserializeJsonFromFile, but memory-maps the file and parses
+// directly from the mapping instead of first reading the whole file into
+// a std::string. For multi-megabyte config/catalog files this avoids one
+// full copy of the content and the transient doubling of peak memory.
+// The returned tree owns its strings; the mapping is released before
+// returning.
+std::unique_ptr<base::Value> DeserializeJsonFromMappedFile(
+    const base::FilePath& path);
+
 // Helper function which serializes |value| into the file at |path|. The
 // function returns true on success, false otherwise.
 bool SerializeJsonToFile(const base::FilePath& path, const base::Value& value);
 
+// Asynchronous SerializeJsonToFile: both the JSON encode and the write
+// run on a background thread-pool sequence (MayBlock, BEST_EFFORT), so
+// the calling sequence never stalls on I/O. |value| is taken by value
+// and moved - not cloned - into a thread-safe snapshot, so handing over
+// even a huge tree is O(1); callers that need to keep their copy pass
+// value.Clone(). The returned promise resolves with the result of the
+// write; attach continuations with ThenHere to get back onto the
+// calling sequence.
+base::Promise<bool, base::NoReject> SerializeJsonToFileAsync(
+    const base::FilePath& path,
+    base::Value value);
+
+// Asynchronous DeserializeJsonFromFile: the read and the parse run on a
+// background thread-pool sequence (MayBlock, BEST_EFFORT). The read goes
+// through basis::AsyncFile, so on kernels with io_uring the file is
+// fetched as one batched submission instead of a read syscall per chunk.
+// The promise resolves with the parsed tree, or the NULL pointer on any
+// read/parse error; attach continuations with ThenHere to get back onto
+// the calling sequence.
+base::Promise<std::unique_ptr<base::Value>, base::NoReject>
+DeserializeJsonFromFileAsync(const base::FilePath& path);
+
+// Helper function which serializes |value| into a compact self-describing
+// binary string (a CBOR-like tagged encoding behind a 4-byte magic/version
+// header, so files identify their own format). Roughly an order of
+// magnitude faster than SerializeToJson for large snapshot state, and
+// unlike JSON it round-trips Type::BINARY blobs. Returns base::nullopt
+// only on unserializable input.
+base::Optional<std::string> SerializeToBinary(const base::Value& value);
+
+// Inverse of SerializeToBinary. Returns the NULL pointer if |data| does
+// not start with the binary-format header or is corrupt/truncated.
+std::unique_ptr<base::Value> DeserializeFromBinary(const std::string& data);
+
+// File format selector for the helpers below.
+enum class ValueFileFormat {
+  kJson,    // Human-readable, interoperable; the historical default.
+  kBinary,  // SerializeToBinary encoding; ~10x faster for big values.
+};
+
+// Serializes |value| into the file at |path| using |format|. Returns
+// true on success, false otherwise.
+bool SerializeValueToFile(const base::FilePath& path,
+                          const base::Value& value,
+                          ValueFileFormat format);
+
+// Deserializes the file at |path|, auto-detecting the format from the
+// content (binary header => binary codec, anything else => JSON), so
+// callers can migrate paths between formats without a flag day. Returns
+// the NULL pointer on any error.
+std::unique_ptr<base::Value> DeserializeValueFromFile(
+    const base::FilePath& path);
+
+// Receiver for StreamJsonFromString. Unlike DeserializeFromJson, no
+// base::Value tree is built; each token is reported through one virtual
+// call, so large documents parse with O(depth) memory. Any callback may
+// return false to stop parsing immediately (StreamJsonFromString then
+// returns false). The default implementations accept everything, so
+// handlers only override the tokens they care about.
+//
+// StringPiece arguments point either directly into the input text
+// (strings without escape sequences — the common case — are passed
+// zero-copy) or into an internal scratch buffer, so treat them as valid
+// only for the duration of the call; copy them if needed later.
+class JsonStreamHandler {
+ public:
+  virtual ~JsonStreamHandler();
+
+  virtual bool BeginObject();
+  virtual bool EndObject();
+  virtual bool BeginArray();
+  virtual bool EndArray();
+  virtual bool Key(base::StringPiece key);
+  virtual bool StringValue(base::StringPiece value);
+  virtual bool IntValue(int value);
+  virtual bool DoubleValue(double value);
+  virtual bool BoolValue(bool value);
+  virtual bool NullValue();
+};
+
+// Parses JSON |text| in a single pass, reporting each token to |handler|
+// without building a base::Value tree. Returns true iff the whole
+// document parsed successfully and no handler callback returned false.
+bool StreamJsonFromString(base::StringPiece text, JsonStreamHandler* handler);
+
+// Memory-maps the file at |path| and streams it through |handler| as
+// StreamJsonFromString does, parsing straight from the mapped region:
+// the file content is never copied into a std::string, and escape-free
+// string values are handed to the handler as StringPieces into the
+// mapping itself. Returns false if the file cannot be mapped, is not
+// valid JSON, or a handler callback returned false.
+bool StreamJsonFromFile(const base::FilePath& path,
+                        JsonStreamHandler* handler);
+
+// Extracts only the values at |key_paths| (dotted key paths into nested
+// objects, e.g. "status.uptime") from JSON |text|, skipping everything
+// else without materializing it. The result is a DictionaryValue holding
+// just the matched paths in their original nesting; paths not present in
+// the document are simply absent. Returns the NULL pointer if |text| is
+// not valid JSON. Array elements are not addressable; a matched path
+// whose value is an array or object captures that subtree whole.
+std::unique_ptr<base::Value> DeserializeJsonPaths(
+    const std::string& text,
+    const std::vector<std::string>& key_paths);
+
 }  // namespace chromecast
 
 #endif  // CHROMECAST_BASE_SERIALIZERS_H_
@@ -4,7 +4,9 @@
 
 #include <vector>
 
+#include "base/bind.h"
 #include "base/files/file_util.h"
+#include "base/test/task_environment.h"
 #include "base/values.h"
 #include "chromecast/base/scoped_temp_file.h"
 #include "chromecast/base/serializers.h"
@@ -148,4 +150,298 @@ TEST(SerializeJsonToFile, PopulatedValue) {
   EXPECT_TRUE(new_value->Equals(&orig_value));
 }
 
+TEST(SerializeJsonToFileAsync, PopulatedValue) {
+  base::test::TaskEnvironment env;
+  ScopedTempFile temp;
+
+  base::DictionaryValue orig_value;
+  orig_value.SetString(kTestKey, kTestValue);
+
+  bool result = false;
+  SerializeJsonToFileAsync(temp.path(), orig_value.Clone())
+      .ThenHere(FROM_HERE,
+                base::BindOnce([](bool* result, bool ok) { *result = ok; },
+                               &result));
+  env.RunUntilIdle();
+  EXPECT_TRUE(result);
+
+  std::unique_ptr<base::Value> new_value = DeserializeJsonFromFile(temp.path());
+  ASSERT_NE(nullptr, new_value.get());
+  EXPECT_TRUE(new_value->Equals(&orig_value));
+}
+
+TEST(DeserializeJsonFromFileAsync, ProperJsonObject) {
+  base::test::TaskEnvironment env;
+  ScopedTempFile temp;
+  EXPECT_EQ(static_cast<int>(strlen(kProperJsonString)),
+            temp.Write(kProperJsonString));
+
+  std::unique_ptr<base::Value> value;
+  DeserializeJsonFromFileAsync(temp.path())
+      .ThenHere(FROM_HERE,
+                base::BindOnce(
+                    [](std::unique_ptr<base::Value>* out,
+                       std::unique_ptr<base::Value> parsed) {
+                      *out = std::move(parsed);
+                    },
+                    &value));
+  env.RunUntilIdle();
+  ASSERT_NE(nullptr, value.get());
+
+  std::unique_ptr<base::Value> expected = DeserializeJsonFromFile(temp.path());
+  ASSERT_NE(nullptr, expected.get());
+  EXPECT_TRUE(value->Equals(expected.get()));
+}
+
+TEST(DeserializeJsonFromFileAsync, NoFile) {
+  base::test::TaskEnvironment env;
+
+  bool resolved = false;
+  std::unique_ptr<base::Value> value;
+  DeserializeJsonFromFileAsync(base::FilePath("/file/does/not/exist.json"))
+      .ThenHere(FROM_HERE,
+                base::BindOnce(
+                    [](bool* resolved, std::unique_ptr<base::Value>* out,
+                       std::unique_ptr<base::Value> parsed) {
+                      *resolved = true;
+                      *out = std::move(parsed);
+                    },
+                    &resolved, &value));
+  env.RunUntilIdle();
+  EXPECT_TRUE(resolved);
+  EXPECT_EQ(nullptr, value.get());
+}
+
+TEST(SerializeToBinary, RoundTripsPopulatedValue) {
+  std::unique_ptr<base::Value> orig_value =
+      DeserializeFromJson(kProperJsonString);
+  ASSERT_NE(nullptr, orig_value.get());
+
+  base::Optional<std::string> encoded = SerializeToBinary(*orig_value);
+  ASSERT_TRUE(encoded.has_value());
+
+  std::unique_ptr<base::Value> decoded = DeserializeFromBinary(*encoded);
+  ASSERT_NE(nullptr, decoded.get());
+  EXPECT_TRUE(decoded->Equals(orig_value.get()));
+}
+
+TEST(SerializeToBinary, RoundTripsBlob) {
+  // JSON cannot serialize Type::BINARY; the binary codec must.
+  base::Value blob(std::vector<char>(12));
+  base::Optional<std::string> encoded = SerializeToBinary(blob);
+  ASSERT_TRUE(encoded.has_value());
+
+  std::unique_ptr<base::Value> decoded = DeserializeFromBinary(*encoded);
+  ASSERT_NE(nullptr, decoded.get());
+  EXPECT_TRUE(decoded->Equals(&blob));
+}
+
+TEST(DeserializeFromBinary, RejectsGarbage) {
+  EXPECT_EQ(nullptr, DeserializeFromBinary("not a binary value").get());
+  EXPECT_EQ(nullptr, DeserializeFromBinary(std::string()).get());
+}
+
+TEST(DeserializeFromBinary, RejectsTruncation) {
+  base::DictionaryValue value;
+  value.SetString(kTestKey, kTestValue);
+  base::Optional<std::string> encoded = SerializeToBinary(value);
+  ASSERT_TRUE(encoded.has_value());
+  std::string truncated = encoded->substr(0, encoded->size() - 1);
+  EXPECT_EQ(nullptr, DeserializeFromBinary(truncated).get());
+}
+
+TEST(SerializeValueToFile, RoundTripsBothFormats) {
+  base::DictionaryValue orig_value;
+  orig_value.SetString(kTestKey, kTestValue);
+
+  for (ValueFileFormat format :
+       {ValueFileFormat::kJson, ValueFileFormat::kBinary}) {
+    ScopedTempFile temp;
+    ASSERT_TRUE(SerializeValueToFile(temp.path(), orig_value, format));
+
+    // DeserializeValueFromFile detects the format from the content.
+    std::unique_ptr<base::Value> new_value =
+        DeserializeValueFromFile(temp.path());
+    ASSERT_NE(nullptr, new_value.get());
+    EXPECT_TRUE(new_value->Equals(&orig_value));
+  }
+}
+
+namespace {
+
+// Records the token stream as a compact trace for comparison.
+class TracingHandler : public JsonStreamHandler {
+ public:
+  bool BeginObject() override { return Append("{"); }
+  bool EndObject() override { return Append("}"); }
+  bool BeginArray() override { return Append("["); }
+  bool EndArray() override { return Append("]"); }
+  bool Key(base::StringPiece key) override {
+    return Append("k:" + key.as_string());
+  }
+  bool StringValue(base::StringPiece value) override {
+    return Append("s:" + value.as_string());
+  }
+  bool IntValue(int value) override {
+    return Append("i:" + std::to_string(value));
+  }
+  bool DoubleValue(double value) override { return Append("d"); }
+  bool BoolValue(bool value) override {
+    return Append(value ? "b:true" : "b:false");
+  }
+  bool NullValue() override { return Append("null"); }
+
+  const std::vector<std::string>& trace() const { return trace_; }
+
+ private:
+  bool Append(const std::string& token) {
+    trace_.push_back(token);
+    return true;
+  }
+
+  std::vector<std::string> trace_;
+};
+
+// Stops parsing as soon as any key is seen.
+class AbortOnKeyHandler : public JsonStreamHandler {
+ public:
+  bool Key(base::StringPiece key) override { return false; }
+};
+
+}  // namespace
+
+TEST(StreamJsonFromString, TokensArriveInDocumentOrder) {
+  TracingHandler handler;
+  EXPECT_TRUE(StreamJsonFromString(kProperJsonString, &handler));
+  std::vector<std::string> expected = {
+      "{", "k:compound", "{", "k:a", "i:1", "k:b", "i:2", "}",
+      "k:some_String", "s:1337", "k:some_int", "i:42", "k:the_list",
+      "[", "s:val1", "s:val2", "]", "}"};
+  EXPECT_EQ(expected, handler.trace());
+}
+
+TEST(StreamJsonFromString, PoorlyFormedJsonObject) {
+  TracingHandler handler;
+  EXPECT_FALSE(StreamJsonFromString(kPoorlyFormedJsonString, &handler));
+}
+
+TEST(StreamJsonFromString, HandlerCanAbort) {
+  AbortOnKeyHandler handler;
+  EXPECT_FALSE(StreamJsonFromString(kProperJsonString, &handler));
+}
+
+TEST(StreamJsonFromString, EscapesAreDecoded) {
+  TracingHandler handler;
+  EXPECT_TRUE(StreamJsonFromString("[\"a\\n\\u0041\"]", &handler));
+  std::vector<std::string> expected = {"[", "s:a\nA", "]"};
+  EXPECT_EQ(expected, handler.trace());
+}
+
+TEST(DeserializeJsonPaths, ExtractsOnlyRequestedPaths) {
+  std::unique_ptr<base::Value> value = DeserializeJsonPaths(
+      kProperJsonString, {"compound.b", "some_int", "missing.path"});
+  ASSERT_NE(nullptr, value.get());
+
+  base::DictionaryValue* dict = nullptr;
+  ASSERT_TRUE(value->GetAsDictionary(&dict));
+  int b = 0;
+  EXPECT_TRUE(dict->GetInteger("compound.b", &b));
+  EXPECT_EQ(2, b);
+  int some_int = 0;
+  EXPECT_TRUE(dict->GetInteger("some_int", &some_int));
+  EXPECT_EQ(42, some_int);
+  // Unrequested and absent keys must not appear.
+  EXPECT_FALSE(dict->HasKey("some_String"));
+  EXPECT_FALSE(dict->HasKey("missing"));
+  int a = 0;
+  EXPECT_FALSE(dict->GetInteger("compound.a", &a));
+}
+
+TEST(DeserializeJsonPaths, CapturesSubtreesWhole) {
+  std::unique_ptr<base::Value> value =
+      DeserializeJsonPaths(kProperJsonString, {"the_list"});
+  ASSERT_NE(nullptr, value.get());
+
+  base::DictionaryValue* dict = nullptr;
+  ASSERT_TRUE(value->GetAsDictionary(&dict));
+  base::ListValue* list = nullptr;
+  ASSERT_TRUE(dict->GetList("the_list", &list));
+  EXPECT_EQ(2u, list->GetSize());
+}
+
+TEST(DeserializeJsonFromMappedFile, NoFile) {
+  std::unique_ptr<base::Value> value = DeserializeJsonFromMappedFile(
+      base::FilePath("/file/does/not/exist.json"));
+  EXPECT_EQ(nullptr, value.get());
+}
+
+TEST(DeserializeJsonFromMappedFile, ProperJsonObject) {
+  ScopedTempFile temp;
+  EXPECT_EQ(static_cast<int>(strlen(kProperJsonString)),
+            temp.Write(kProperJsonString));
+  std::unique_ptr<base::Value> value =
+      DeserializeJsonFromMappedFile(temp.path());
+  ASSERT_NE(nullptr, value.get());
+
+  // Same tree as the read-into-string path.
+  std::unique_ptr<base::Value> expected = DeserializeJsonFromFile(temp.path());
+  EXPECT_TRUE(value->Equals(expected.get()));
+}
+
+TEST(DeserializeJsonFromMappedFile, PoorlyFormedJsonObject) {
+  ScopedTempFile temp;
+  EXPECT_EQ(static_cast<int>(strlen(kPoorlyFormedJsonString)),
+            temp.Write(kPoorlyFormedJsonString));
+  std::unique_ptr<base::Value> value =
+      DeserializeJsonFromMappedFile(temp.path());
+  EXPECT_EQ(nullptr, value.get());
+}
+
+TEST(StreamJsonFromFile, ProperJsonObject) {
+  ScopedTempFile temp;
+  EXPECT_EQ(static_cast<int>(strlen(kProperJsonString)),
+            temp.Write(kProperJsonString));
+  TracingHandler handler;
+  EXPECT_TRUE(StreamJsonFromFile(temp.path(), &handler));
+  EXPECT_EQ(18u, handler.trace().size());
+}
+
+TEST(StreamJsonFromFile, NoFile) {
+  TracingHandler handler;
+  EXPECT_FALSE(
+      StreamJsonFromFile(base::FilePath("/file/does/not/exist.json"), &handler));
+}
+
+TEST(StreamJsonFromString, EscapeFreeStringsAreZeroCopy) {
+  // Strings without escapes must alias the input buffer (this is what
+  // makes StreamJsonFromFile parse straight out of the mapping).
+  const std::string input = "[\"plain\", \"esc\\n\"]";
+
+  class AliasCheckHandler : public JsonStreamHandler {
+   public:
+    explicit AliasCheckHandler(const std::string& input) : input_(input) {}
+    bool StringValue(base::StringPiece value) override {
+      bool aliases = value.data() >= input_.data() &&
+                     value.data() < input_.data() + input_.size();
+      if (value == "plain")
+        EXPECT_TRUE(aliases);
+      else
+        EXPECT_FALSE(aliases);  // Unescaping forces a copy.
+      return true;
+    }
+
+   private:
+    const std::string& input_;
+  };
+
+  AliasCheckHandler handler(input);
+  EXPECT_TRUE(StreamJsonFromString(input, &handler));
+}
+
+TEST(DeserializeJsonPaths, PoorlyFormedJsonObject) {
+  std::unique_ptr<base::Value> value =
+      DeserializeJsonPaths(kPoorlyFormedJsonString, {"key"});
+  EXPECT_EQ(nullptr, value.get());
+}
+
 }  // namespace chromecast
@@ -0,0 +1,94 @@
+#include "basis/startup_phases.hpp" // IWYU pragma: associated
+
+#include <base/logging.h>
+#include <base/synchronization/lock.h>
+#include <base/threading/platform_thread.h>
+#include <base/trace_event/trace_event.h>
+
+#include <cstring>
+
+namespace basis {
+
+namespace {
+
+struct PhaseTable {
+  base::Lock lock;
+  StartupPhases::Phase phases[StartupPhases::kMaxPhases];
+  size_t count = 0;
+};
+
+PhaseTable& Table() {
+  // Leaked: recording may begin before and outlive any static's
+  // orderly lifetime.
+  static PhaseTable* table = new PhaseTable();
+  return *table;
+}
+
+}  // namespace
+
+// static
+void StartupPhases::BeginPhase(const char* name) {
+  const base::TimeTicks now = base::TimeTicks::Now();
+  PhaseTable& table = Table();
+  base::AutoLock lock(table.lock);
+  if (table.count >= kMaxPhases) {
+    // Silently dropping would hide exactly the data we are after.
+    LOG(WARNING) << "startup phase table full, dropping: " << name;
+    return;
+  }
+  Phase& phase = table.phases[table.count++];
+  phase.name = name;
+  phase.begin = now;
+}
+
+// static
+void StartupPhases::EndPhase(const char* name) {
+  const base::TimeTicks now = base::TimeTicks::Now();
+  PhaseTable& table = Table();
+  base::AutoLock lock(table.lock);
+  // Most recent open phase of that name, so nested phases balance.
+  for (size_t i = table.count; i > 0; --i) {
+    Phase& phase = table.phases[i - 1];
+    if (phase.end.is_null() && std::strcmp(phase.name, name) == 0) {
+      phase.end = now;
+      return;
+    }
+  }
+  LOG(WARNING) << "EndPhase without BeginPhase: " << name;
+}
+
+// static
+std::vector<StartupPhases::Phase> StartupPhases::Snapshot() {
+  PhaseTable& table = Table();
+  base::AutoLock lock(table.lock);
+  return std::vector<Phase>(table.phases, table.phases + table.count);
+}
+
+// static
+void StartupPhases::LogAll() {
+  for (const Phase& phase : Snapshot()) {
+    if (phase.end.is_null()) {
+      LOG(INFO) << "startup phase " << phase.name << ": still open";
+      continue;
+    }
+    LOG(INFO) << "startup phase " << phase.name << ": "
+              << (phase.end - phase.begin).InMillisecondsF() << " ms";
+  }
+}
+
+// static
+void StartupPhases::DumpToTraceLog() {
+  const base::PlatformThreadId thread_id = base::PlatformThread::CurrentId();
+  size_t id = 0;
+  for (const Phase& phase : Snapshot()) {
+    ++id;
+    if (phase.end.is_null())
+      continue;
+    TRACE_EVENT_BEGIN_WITH_ID_TID_AND_TIMESTAMP0(
+        "startup", phase.name, id, thread_id, phase.begin);
+    TRACE_EVENT_END_WITH_ID_TID_AND_TIMESTAMP0(
+        "startup", phase.name, id, thread_id, phase.end);
+  }
+}
+
+}  // namespace basis
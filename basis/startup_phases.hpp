@@ -0,0 +1,70 @@
+#pragma once
+
+#include <base/macros.h>
+#include <base/time/time.h>
+
+#include <vector>
+
+namespace basis {
+
+// Startup phase timing.
+//
+// Process start runs through a chain of init helpers (initCommandLine,
+// initLogging, initICUi18n, initThreadPool, ...) with no visibility
+// into which one eats the time. Each helper records begin/end of its
+// phase into a small static table; after main() starts the table can
+// be read (Snapshot), logged (LogAll) or replayed into TraceLog with
+// the original timestamps (DumpToTraceLog) so the phases show up as
+// slices in a chrome://tracing capture next to everything else.
+//
+// Recording works before logging/tracing are initialized (it only
+// touches the table), which is the point: the earliest phases are the
+// ones we cannot see today.
+class StartupPhases {
+ public:
+  struct Phase {
+    const char* name = nullptr;
+    base::TimeTicks begin;
+    // Null until the phase ended (phase still running or unbalanced).
+    base::TimeTicks end;
+  };
+
+  static constexpr size_t kMaxPhases = 32;
+
+  // |name| must be a string literal (stored by pointer). Nesting is
+  // allowed; EndPhase closes the most recent open phase of that name.
+  static void BeginPhase(const char* name);
+  static void EndPhase(const char* name);
+
+  // Phases in begin order. Thread-safe.
+  static std::vector<Phase> Snapshot();
+
+  // One log line per completed phase with its duration.
+  static void LogAll();
+
+  // Emits every completed phase as a trace slice with its original
+  // begin/end timestamps. Call once tracing is up (see
+  // basis/tracing_util.hpp); phases recorded before tracing started
+  // are replayed correctly since the macros take explicit timestamps.
+  static void DumpToTraceLog();
+
+ private:
+  DISALLOW_IMPLICIT_CONSTRUCTORS(StartupPhases);
+};
+
+// RAII recorder for one phase; put at the top of an init helper.
+class ScopedStartupPhase {
+ public:
+  explicit ScopedStartupPhase(const char* name) : name_(name) {
+    StartupPhases::BeginPhase(name_);
+  }
+
+  ~ScopedStartupPhase() { StartupPhases::EndPhase(name_); }
+
+ private:
+  const char* const name_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedStartupPhase);
+};
+
+}  // namespace basis
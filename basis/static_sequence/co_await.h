@@ -0,0 +1,83 @@
+// Copyright 2019 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CHROMECAST_BASE_STATIC_SEQUENCE_CO_AWAIT_H_
+#define CHROMECAST_BASE_STATIC_SEQUENCE_CO_AWAIT_H_
+
+// Coroutine support for util::StaticSequence.
+//
+// Including this header lets a coroutine hop between static sequences with
+// `co_await MySequence::Switch()`, which resumes the coroutine frame on
+// that sequence and yields the sequence Key, so statically-sequenced
+// functions can be called directly from the resumed code:
+//
+//   MyCoroutine ProcessFrame() {
+//     const DecodeSequence::Key& decode_key =
+//         co_await DecodeSequence::Switch();
+//     Decode(frame, decode_key);
+//     const AudioSequence::Key& audio_key =
+//         co_await AudioSequence::Switch();
+//     Mix(frame, audio_key);
+//   }
+//
+// Where a multi-sequence workflow used to pay one base::BindOnce
+// allocation plus posted closure per hop, the coroutine keeps a single
+// frame alive across every transition; each hop is just a posted resume of
+// that frame. Awaiting while already on the target sequence is free (no
+// suspension, no post).
+//
+// This lives in its own header (rather than static_sequence.h) so that
+// only coroutine-enabled translation units need compiler coroutine
+// support; calling MySequence::Switch() without including this header
+// fails to compile with an incomplete-type error pointing here.
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#define BASIS_COROUTINE_NAMESPACE std
+#elif defined(__cpp_coroutines) && __has_include(<experimental/coroutine>)
+#include <experimental/coroutine>
+#define BASIS_COROUTINE_NAMESPACE std::experimental
+#else
+#error "basis/static_sequence/co_await.h requires compiler coroutine \
+support (-fcoroutines / -fcoroutines-ts)"
+#endif
+
+#include "base/bind.h"
+#include "base/location.h"
+#include "chromecast/base/static_sequence/static_sequence.h"
+
+namespace util {
+namespace internal {
+
+// Awaiter returned by StaticSequence<T>::Switch(). Suspends the awaiting
+// coroutine and resumes it on |Sequence|'s TaskRunner; await_resume hands
+// out the sequence Key, which is valid because resumption always happens
+// on the sequence.
+template <typename Sequence>
+struct SequenceSwitchAwaiter {
+  const typename Sequence::Key* key;
+  base::Location from_here;
+
+  bool await_ready() const noexcept {
+    // Already on the target sequence: skip the hop entirely.
+    return Sequence::TaskRunner()->RunsTasksInCurrentSequence();
+  }
+
+  void await_suspend(BASIS_COROUTINE_NAMESPACE::coroutine_handle<> handle) {
+    Sequence::TaskRunner()->PostTask(
+        from_here,
+        base::BindOnce(
+            [](BASIS_COROUTINE_NAMESPACE::coroutine_handle<> handle) {
+              handle.resume();
+            },
+            handle));
+  }
+
+  const typename Sequence::Key& await_resume() const noexcept { return *key; }
+};
+
+}  // namespace internal
+}  // namespace util
+
+#endif  // CHROMECAST_BASE_STATIC_SEQUENCE_CO_AWAIT_H_
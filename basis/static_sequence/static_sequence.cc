@@ -4,11 +4,55 @@
 
 #include "chromecast/base/static_sequence/static_sequence.h"
 
+#include "base/logging.h"
 #include "base/task/thread_pool.h"
 
 namespace util {
 namespace internal {
 
+SequenceMailbox::SequenceMailbox() = default;
+
+SequenceMailbox::~SequenceMailbox() {
+  // Dispose of anything never drained (process shutdown).
+  while (TaskNode* node = queue_.pop()) {
+    delete node;
+  }
+}
+
+SequenceMailbox::TaskNode::TaskNode(base::OnceClosure task)
+    : task(std::move(task)) {}
+
+bool SequenceMailbox::Push(base::OnceClosure task) {
+  queue_.push(new TaskNode(std::move(task)));
+  // The push above happens-before this increment, so a drain scheduled
+  // because the count moved off zero observes the node.
+  return pending_.fetch_add(1, std::memory_order_acq_rel) == 0;
+}
+
+void SequenceMailbox::Drain() {
+  for (;;) {
+    // Everything counted so far is (or is about to be) reachable.
+    const size_t batch = pending_.load(std::memory_order_acquire);
+    DCHECK_GT(batch, 0u);
+
+    for (size_t i = 0; i < batch; ++i) {
+      TaskNode* node = queue_.pop();
+      while (!node) {
+        // A producer incremented |pending_| but has not linked its node
+        // yet; the window is a few instructions (see MPSCIntrusiveQueue).
+        node = queue_.pop();
+      }
+      std::move(node->task).Run();
+      delete node;
+    }
+
+    if (pending_.fetch_sub(batch, std::memory_order_acq_rel) == batch) {
+      // Nothing arrived while draining; the next Push schedules anew.
+      return;
+    }
+  }
+}
+
 StaticTaskRunnerHolder::StaticTaskRunnerHolder(base::TaskTraits traits)
     : traits_(traits), initialized_(false) {}
 
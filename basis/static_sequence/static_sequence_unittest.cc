@@ -4,6 +4,8 @@
 
 #include "chromecast/base/static_sequence/static_sequence.h"
 
+#include <vector>
+
 #include "base/test/task_environment.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -211,4 +213,75 @@ TEST(StaticSequenceTest, PostProtectedFreeFunction) {
   EXPECT_TRUE(r);
 }
 
+TEST(StaticSequenceTest, MailboxRunsBurstInOrder) {
+  base::test::TaskEnvironment env;
+  std::vector<int> order;
+  for (int i = 0; i < 100; ++i) {
+    TestSequence::PostTaskViaMailbox(base::BindOnce(
+        [](std::vector<int>* order, int i) { order->push_back(i); }, &order,
+        i));
+  }
+  EXPECT_TRUE(order.empty());
+  env.RunUntilIdle();
+  ASSERT_EQ(order.size(), 100u);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(order[i], i);
+  }
+}
+
+TEST(StaticSequenceTest, LocalStorageLazilyConstructsAndPersists) {
+  base::test::TaskEnvironment env;
+  static TestSequence::LocalStorage<std::vector<int>> storage;
+  int size_before = -1;
+  int size_after = -1;
+  TestSequence::PostTask(base::BindOnce(
+      [](int* size_before, int* size_after, const TestSequence::Key& key) {
+        EXPECT_EQ(storage.GetIfExists(key), nullptr);
+        std::vector<int>& values = storage.Get(key);
+        *size_before = static_cast<int>(values.size());
+        values.push_back(1);
+        values.push_back(2);
+        *size_after = static_cast<int>(storage.Get(key).size());
+      },
+      &size_before, &size_after));
+  env.RunUntilIdle();
+  EXPECT_EQ(size_before, 0);
+  EXPECT_EQ(size_after, 2);
+
+  // A later task on the sequence sees the same value.
+  int size_later = -1;
+  TestSequence::PostTask(base::BindOnce(
+      [](int* size_later, const TestSequence::Key& key) {
+        *size_later = static_cast<int>(storage.Get(key).size());
+        storage.Reset(key);
+        EXPECT_EQ(storage.GetIfExists(key), nullptr);
+      },
+      &size_later));
+  env.RunUntilIdle();
+  EXPECT_EQ(size_later, 2);
+}
+
+TEST(StaticSequenceTest, LocalStorageEmplace) {
+  base::test::TaskEnvironment env;
+  static TestSequence::LocalStorage<ParameterizedObject> storage;
+  int r = 0;
+  TestSequence::PostTask(base::BindOnce(
+      [](int* r, const TestSequence::Key& key) {
+        storage.Emplace(key, 7).Increment(r, key);
+      },
+      &r));
+  env.RunUntilIdle();
+  EXPECT_EQ(r, 7);
+}
+
+TEST(StaticSequenceTest, MailboxProvidesKey) {
+  base::test::TaskEnvironment env;
+  bool activated = false;
+  TestSequence::PostTaskViaMailbox(
+      base::BindOnce(&DoSomethingWithRequiredSequence, &activated));
+  EXPECT_FALSE(activated);
+  env.RunUntilIdle();
+  EXPECT_TRUE(activated);
+}
+
 }  // namespace util
@@ -0,0 +1,209 @@
+#include "basis/switch_registry.hpp" // IWYU pragma: associated
+
+#include <base/command_line.h>
+#include <base/logging.h>
+#include <base/strings/string_number_conversions.h>
+#if defined(OS_WIN)
+#include <base/strings/utf_string_conversions.h>
+#endif
+
+#include <algorithm>
+#include <utility>
+
+namespace basis {
+
+SwitchRegistry::SwitchRegistry() = default;
+
+SwitchRegistry::~SwitchRegistry() = default;
+
+SwitchRegistry::SwitchId SwitchRegistry::declare(Entry entry)
+{
+  DCHECK(!parsed_)
+    << "switch --" << entry.name << " declared after the parse pass";
+  DCHECK(findSwitch(entry.name) == kInvalidSwitchId)
+    << "switch --" << entry.name << " declared twice";
+  entries_.push_back(std::move(entry));
+  return static_cast<SwitchId>(entries_.size() - 1);
+}
+
+SwitchRegistry::SwitchId SwitchRegistry::declareBool(
+  const base::StringPiece& name, const bool default_value)
+{
+  Entry entry;
+  entry.name = name.as_string();
+  entry.type = SwitchType::kBool;
+  entry.bool_value = default_value;
+  return declare(std::move(entry));
+}
+
+SwitchRegistry::SwitchId SwitchRegistry::declareInt(
+  const base::StringPiece& name, const int64_t default_value)
+{
+  Entry entry;
+  entry.name = name.as_string();
+  entry.type = SwitchType::kInt;
+  entry.int_value = default_value;
+  return declare(std::move(entry));
+}
+
+SwitchRegistry::SwitchId SwitchRegistry::declareDouble(
+  const base::StringPiece& name, const double default_value)
+{
+  Entry entry;
+  entry.name = name.as_string();
+  entry.type = SwitchType::kDouble;
+  entry.double_value = default_value;
+  return declare(std::move(entry));
+}
+
+SwitchRegistry::SwitchId SwitchRegistry::declareString(
+  const base::StringPiece& name, const base::StringPiece& default_value)
+{
+  Entry entry;
+  entry.name = name.as_string();
+  entry.type = SwitchType::kString;
+  entry.string_value = default_value.as_string();
+  return declare(std::move(entry));
+}
+
+void SwitchRegistry::parseFromCommandLine(
+  const base::CommandLine& command_line)
+{
+  DCHECK(!parsed_);
+  parsed_ = true;
+
+  // The switch map is small and sorted, the registry is small and
+  // unsorted; one pass over the map with a linear scan per hit keeps
+  // the code trivial and is far below any measurable cost (the
+  // savings come from the hot read path, not from here).
+  for(const auto& name_and_value : command_line.GetSwitches())
+  {
+    const std::string& name = name_and_value.first;
+    const auto it = std::find_if(entries_.begin(), entries_.end()
+      , [&name](const Entry& entry) {
+          return entry.name == name;
+        });
+    if(it == entries_.end())
+    {
+      // Not ours (base's own switches like --v land here).
+      continue;
+    }
+    Entry& entry = *it;
+
+#if defined(OS_WIN)
+    const std::string value = base::WideToUTF8(name_and_value.second);
+#else
+    const std::string& value = name_and_value.second;
+#endif
+
+    switch(entry.type)
+    {
+      case SwitchType::kBool:
+      {
+        if(value.empty() || value == "1" || value == "true")
+        {
+          entry.bool_value = true;
+        }
+        else if(value == "0" || value == "false")
+        {
+          entry.bool_value = false;
+        }
+        else
+        {
+          LOG(WARNING)
+            << "--" << entry.name << "=" << value
+            << " is not a bool; keeping default";
+          continue;
+        }
+        break;
+      }
+      case SwitchType::kInt:
+      {
+        if(!base::StringToInt64(value, &entry.int_value))
+        {
+          LOG(WARNING)
+            << "--" << entry.name << "=" << value
+            << " is not an integer; keeping default";
+          continue;
+        }
+        break;
+      }
+      case SwitchType::kDouble:
+      {
+        if(!base::StringToDouble(value, &entry.double_value))
+        {
+          LOG(WARNING)
+            << "--" << entry.name << "=" << value
+            << " is not a number; keeping default";
+          continue;
+        }
+        break;
+      }
+      case SwitchType::kString:
+      {
+        entry.string_value = value;
+        break;
+      }
+    }
+    entry.was_set = true;
+  }
+}
+
+const SwitchRegistry::Entry& SwitchRegistry::entryForRead(
+  const SwitchId id, const SwitchType type) const
+{
+  DCHECK(parsed_)
+    << "switch read before the parse pass (initCommandLine)";
+  DCHECK(id < entries_.size());
+  const Entry& entry = entries_[id];
+  DCHECK(entry.type == type)
+    << "--" << entry.name << " read with the wrong type";
+  return entry;
+}
+
+bool SwitchRegistry::getBool(const SwitchId id) const
+{
+  return entryForRead(id, SwitchType::kBool).bool_value;
+}
+
+int64_t SwitchRegistry::getInt(const SwitchId id) const
+{
+  return entryForRead(id, SwitchType::kInt).int_value;
+}
+
+double SwitchRegistry::getDouble(const SwitchId id) const
+{
+  return entryForRead(id, SwitchType::kDouble).double_value;
+}
+
+base::StringPiece SwitchRegistry::getString(const SwitchId id) const
+{
+  return entryForRead(id, SwitchType::kString).string_value;
+}
+
+bool SwitchRegistry::wasSet(const SwitchId id) const
+{
+  DCHECK(id < entries_.size());
+  return entries_[id].was_set;
+}
+
+SwitchRegistry::SwitchId SwitchRegistry::findSwitch(
+  const base::StringPiece& name) const
+{
+  for(size_t i = 0; i < entries_.size(); ++i)
+  {
+    if(entries_[i].name == name)
+    {
+      return static_cast<SwitchId>(i);
+    }
+  }
+  return kInvalidSwitchId;
+}
+
+SwitchRegistry& switchRegistry()
+{
+  static SwitchRegistry registry;
+  return registry;
+}
+
+}  // namespace basis
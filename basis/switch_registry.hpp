@@ -0,0 +1,129 @@
+#pragma once
+
+#include <base/macros.h>
+#include <base/strings/string_piece.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace base { class CommandLine; }
+
+namespace basis {
+
+// Typed command-line switch registry.
+//
+// base::CommandLine answers every query with a map lookup and hands
+// values back as freshly allocated std::strings; startup code that
+// probes hundreds of switches pays that cost per query. The registry
+// inverts the flow: switches are declared once (name, type, default),
+// the command line is walked in a single pass at init, and afterwards
+// every read is an index into a flat table - no lookups, no
+// allocations, safe from any thread (the table is immutable once
+// parsed).
+//
+// Usage:
+//   // at namespace scope or early in startup, before initCommandLine
+//   const auto kNetThreads
+//     = basis::switchRegistry().declareInt("net-threads", 4);
+//   ...
+//   basis::initCommandLine(argc, argv); // single parse pass
+//   ...
+//   const int64_t net_threads
+//     = basis::switchRegistry().getInt(kNetThreads);
+//
+// Unknown switches on the command line are ignored (they may belong
+// to base itself, e.g. --v); declared switches missing from the
+// command line read back their defaults with wasSet() == false. A
+// value that fails to parse as the declared type keeps the default
+// and logs a warning rather than aborting startup.
+class SwitchRegistry {
+ public:
+  using SwitchId = uint32_t;
+
+  static constexpr SwitchId kInvalidSwitchId
+    = static_cast<SwitchId>(-1);
+
+  SwitchRegistry();
+  ~SwitchRegistry();
+
+  /// \note declarations must happen before the parse pass;
+  /// each returns the index used for all later reads
+  /// \note a bool switch is true when present with no value or with
+  /// "1"/"true", false with "0"/"false"
+  SwitchId declareBool(
+    const base::StringPiece& name, bool default_value);
+  SwitchId declareInt(
+    const base::StringPiece& name, int64_t default_value);
+  SwitchId declareDouble(
+    const base::StringPiece& name, double default_value);
+  SwitchId declareString(
+    const base::StringPiece& name, const base::StringPiece& default_value);
+
+  /// \note single pass over the command line's switch map; called by
+  /// |initCommandLine| for the process-wide registry. May be called
+  /// at most once per registry.
+  void parseFromCommandLine(const base::CommandLine& command_line);
+
+  /// \note reads are index-based and allocation-free; the id must
+  /// come from the matching declare call (type-checked via DCHECK)
+  bool getBool(SwitchId id) const;
+  int64_t getInt(SwitchId id) const;
+  double getDouble(SwitchId id) const;
+  /// \note the returned view points into the registry and stays valid
+  /// for the registry's lifetime
+  base::StringPiece getString(SwitchId id) const;
+
+  /// \note false = the switch was absent (or unparseable) and the
+  /// read returns the declared default
+  bool wasSet(SwitchId id) const;
+
+  /// \note for migrating string-keyed call sites gradually;
+  /// returns |kInvalidSwitchId| for undeclared names
+  SwitchId findSwitch(const base::StringPiece& name) const;
+
+  /// \note large `inline` functions cause Cache misses
+  /// and affect efficiency negatively, so keep it small
+  [[nodiscard]] /* don't ignore return value */
+  inline /* `inline` to eleminate function call overhead */
+  bool parsed() const noexcept {
+    return parsed_;
+  }
+
+ private:
+  enum class SwitchType : uint8_t {
+    kBool,
+    kInt,
+    kDouble,
+    kString
+  };
+
+  struct Entry {
+    std::string name;
+    SwitchType type;
+    bool was_set = false;
+    bool bool_value = false;
+    int64_t int_value = 0;
+    double double_value = 0.0;
+    /// \note owns both the default and the parsed value so that
+    /// |getString| can return a stable view
+    std::string string_value;
+  };
+
+  SwitchId declare(Entry entry);
+
+  const Entry& entryForRead(SwitchId id, SwitchType type) const;
+
+  /// \note flat table, |SwitchId| is the index
+  std::vector<Entry> entries_;
+
+  bool parsed_ = false;
+
+  DISALLOW_COPY_AND_ASSIGN(SwitchRegistry);
+};
+
+/// \note the process-wide registry parsed by |initCommandLine|;
+/// declare switches before that call, read them any time after
+SwitchRegistry& switchRegistry();
+
+}  // namespace basis
@@ -6,8 +6,22 @@
 
 #include "base/bind.h"
 #include "base/location.h"
+#include "base/logging.h"
 #include "base/sequenced_task_runner.h"
 
+#if defined(OS_LINUX)
+#include <errno.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <limits>
+
+#include "base/posix/eintr_wrapper.h"
+#endif  // defined(OS_LINUX)
+
 namespace chromecast {
 
 namespace {
@@ -94,4 +108,98 @@ base::Time SystemTimeChangeNotifierPeriodicMonitor::Now() const {
   return base::Time::Now();
 }
 
+#if defined(OS_LINUX)
+
+SystemTimeChangeNotifierTimerFd::SystemTimeChangeNotifierTimerFd() {
+  timer_fd_ = timerfd_create(CLOCK_REALTIME, TFD_CLOEXEC);
+  if (timer_fd_ < 0) {
+    PLOG(WARNING) << "timerfd_create failed; "
+                  << "use SystemTimeChangeNotifierPeriodicMonitor instead";
+    return;
+  }
+  if (!ArmTimer()) {
+    close(timer_fd_);
+    timer_fd_ = -1;
+    return;
+  }
+  shutdown_fd_ = eventfd(0, EFD_CLOEXEC);
+  if (shutdown_fd_ < 0) {
+    PLOG(WARNING) << "eventfd failed";
+    close(timer_fd_);
+    timer_fd_ = -1;
+    return;
+  }
+  if (!base::PlatformThread::Create(0, this, &watcher_thread_)) {
+    LOG(WARNING) << "unable to create time change watcher thread";
+    close(timer_fd_);
+    timer_fd_ = -1;
+    close(shutdown_fd_);
+    shutdown_fd_ = -1;
+  }
+}
+
+SystemTimeChangeNotifierTimerFd::~SystemTimeChangeNotifierTimerFd() {
+  if (!IsSupported())
+    return;
+  const uint64_t value = 1;
+  ignore_result(HANDLE_EINTR(write(shutdown_fd_, &value, sizeof(value))));
+  base::PlatformThread::Join(watcher_thread_);
+  close(timer_fd_);
+  close(shutdown_fd_);
+}
+
+bool SystemTimeChangeNotifierTimerFd::IsSupported() const {
+  return timer_fd_ >= 0;
+}
+
+bool SystemTimeChangeNotifierTimerFd::ArmTimer() {
+  // The expiry itself is uninteresting (and essentially unreachable);
+  // TFD_TIMER_CANCEL_ON_SET makes a blocked read fail with ECANCELED
+  // whenever CLOCK_REALTIME is set discontinuously.
+  struct itimerspec its = {};
+  its.it_value.tv_sec = std::numeric_limits<time_t>::max();
+  if (timerfd_settime(timer_fd_,
+                      TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET,
+                      &its, nullptr) < 0) {
+    PLOG(WARNING) << "timerfd_settime(TFD_TIMER_CANCEL_ON_SET) failed; "
+                  << "use SystemTimeChangeNotifierPeriodicMonitor instead";
+    return false;
+  }
+  return true;
+}
+
+void SystemTimeChangeNotifierTimerFd::ThreadMain() {
+  base::PlatformThread::SetName("TimeChangeWatcher");
+  for (;;) {
+    struct pollfd fds[2] = {{timer_fd_, POLLIN, 0},
+                            {shutdown_fd_, POLLIN, 0}};
+    if (poll(fds, 2, -1) < 0) {
+      if (errno == EINTR)
+        continue;
+      PLOG(WARNING) << "poll failed; time change watcher exits";
+      return;
+    }
+    if (fds[1].revents & POLLIN)
+      return;  // Shutting down.
+    if (!(fds[0].revents & POLLIN))
+      continue;
+    uint64_t expirations = 0;
+    if (read(timer_fd_, &expirations, sizeof(expirations)) >= 0) {
+      // Genuine (far-future) expiry; nothing to report.
+      continue;
+    }
+    if (errno == ECANCELED) {
+      // The kernel observed a discontinuous clock set. Re-arm first so
+      // back-to-back steps are not missed, then notify.
+      ArmTimer();
+      NotifySystemTimeChanged();
+    } else if (errno != EINTR && errno != EAGAIN) {
+      PLOG(WARNING) << "timerfd read failed; time change watcher exits";
+      return;
+    }
+  }
+}
+
+#endif  // defined(OS_LINUX)
+
 }  // namespace chromecast
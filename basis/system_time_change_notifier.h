@@ -10,7 +10,9 @@
 #include "base/memory/ref_counted.h"
 #include "base/memory/weak_ptr.h"
 #include "base/observer_list_threadsafe.h"
+#include "base/threading/platform_thread.h"
 #include "base/time/time.h"
+#include "build/build_config.h"
 
 namespace base {
 class SequencedTaskRunner;
@@ -85,6 +87,41 @@ class SystemTimeChangeNotifierPeriodicMonitor
   DISALLOW_COPY_AND_ASSIGN(SystemTimeChangeNotifierPeriodicMonitor);
 };
 
+#if defined(OS_LINUX)
+
+// Linux implementation with zero periodic wakeups: a watcher thread
+// blocks on a CLOCK_REALTIME timerfd armed with TFD_TIMER_CANCEL_ON_SET,
+// so the kernel wakes it only when the clock is set discontinuously
+// (NTP step, settimeofday). Detection is immediate instead of waiting
+// for the next poll. Callers should check IsSupported() after
+// construction and fall back to SystemTimeChangeNotifierPeriodicMonitor
+// when it returns false (e.g. old kernel, seccomp policy).
+class SystemTimeChangeNotifierTimerFd : public SystemTimeChangeNotifier,
+                                        public base::PlatformThread::Delegate {
+ public:
+  SystemTimeChangeNotifierTimerFd();
+  ~SystemTimeChangeNotifierTimerFd() override;
+
+  bool IsSupported() const;
+
+  // base::PlatformThread::Delegate:
+  void ThreadMain() override;
+
+ private:
+  // Arms the timer with a far-future absolute expiry; only the
+  // cancel-on-set side effect is of interest. Returns false on failure.
+  bool ArmTimer();
+
+  int timer_fd_ = -1;
+  // eventfd used to unblock the watcher thread on destruction.
+  int shutdown_fd_ = -1;
+  base::PlatformThreadHandle watcher_thread_;
+
+  DISALLOW_COPY_AND_ASSIGN(SystemTimeChangeNotifierTimerFd);
+};
+
+#endif  // defined(OS_LINUX)
+
 }  // namespace chromecast
 
 #endif  // CHROMECAST_BASE_SYSTEM_TIME_CHANGE_NOTIFIER_H_
@@ -2,11 +2,69 @@
 
 #include <base/macros.h>
 #include <base/callback.h>
+#include <base/sequence_token.h>
 #include <base/synchronization/waitable_event.h>
 #include <base/bind.h>
 
+#include <basis/promise/post_promise.h>
+
+#include <atomic>
+#include <utility>
+
 namespace basis {
 
+namespace {
+
+// Hands out generations for SequenceSet; never reuses a value, so a
+// cache entry can only ever match the exact set state it was computed
+// against.
+uint64_t NextSequenceSetGeneration()
+{
+  static std::atomic<uint64_t> generation{0};
+  return generation.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+// One cached verdict: "the sequence behind |token| is (not) a member
+// of the set state behind |generation|".
+struct SequenceSetCacheEntry {
+  uint64_t generation = 0; // 0 = empty slot
+  base::SequenceToken token;
+  bool is_member = false;
+};
+
+// Per-thread cache, keyed by (generation, current sequence token); a
+// pool worker that hops between sequences misses on the token and
+// recomputes, so the cache never returns another sequence's verdict.
+// A handful of entries covers the few long-lived sets a thread
+// actually checks; replacement is round-robin.
+constexpr size_t kSequenceSetCacheSize = 8;
+thread_local SequenceSetCacheEntry
+  g_sequence_set_cache[kSequenceSetCacheSize];
+thread_local size_t g_sequence_set_cache_next = 0;
+
+// Shared by the countdown closures of one PostTasksAndWaitAll call;
+// lives on the caller's stack, which is safe because the caller blocks
+// until the last closure signals.
+struct WaitAllState {
+  explicit WaitAllState(const size_t total)
+    : remaining(total)
+    , event(base::WaitableEvent::ResetPolicy::MANUAL
+        , base::WaitableEvent::InitialState::NOT_SIGNALED)
+  {}
+
+  std::atomic<size_t> remaining;
+  base::WaitableEvent event;
+};
+
+void CountdownAndMaybeSignal(WaitAllState* state)
+{
+  if(state->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    state->event.Signal();
+  }
+}
+
+} // namespace
+
 bool RunsTasksInAnySequenceOf(
   const std::vector<scoped_refptr<base::SequencedTaskRunner> > &task_runners
   , bool dcheck_not_empty)
@@ -23,6 +81,89 @@ bool RunsTasksInAnySequenceOf(
   return false;
 }
 
+SequenceSet::SequenceSet()
+  : generation_{NextSequenceSetGeneration()}
+{}
+
+SequenceSet::SequenceSet(
+  std::vector<scoped_refptr<base::SequencedTaskRunner>> task_runners)
+  : task_runners_{std::move(task_runners)}
+  , generation_{NextSequenceSetGeneration()}
+{
+#if DCHECK_IS_ON()
+  for(const scoped_refptr<base::SequencedTaskRunner>& task_runner
+      : task_runners_)
+  {
+    DCHECK(task_runner);
+  }
+#endif // DCHECK_IS_ON()
+}
+
+SequenceSet::~SequenceSet() = default;
+
+void SequenceSet::insert(
+  scoped_refptr<base::SequencedTaskRunner> task_runner)
+{
+  DCHECK(task_runner);
+  task_runners_.push_back(std::move(task_runner));
+  generation_.store(
+    NextSequenceSetGeneration(), std::memory_order_release);
+}
+
+void SequenceSet::clear()
+{
+  task_runners_.clear();
+  generation_.store(
+    NextSequenceSetGeneration(), std::memory_order_release);
+}
+
+bool SequenceSet::scanMembership() const
+{
+  for(const scoped_refptr<base::SequencedTaskRunner>& task_runner
+      : task_runners_)
+  {
+    if(task_runner->RunsTasksInCurrentSequence())
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool SequenceSet::RunsTasksInCurrentSequence() const
+{
+  const base::SequenceToken token
+    = base::SequenceToken::GetForCurrentThread();
+  if(!token.IsValid())
+  {
+    // Not inside a sequenced task (e.g. a bare thread): nothing to key
+    // the cache on; answer with the plain scan.
+    return scanMembership();
+  }
+
+  const uint64_t generation
+    = generation_.load(std::memory_order_acquire);
+  for(const SequenceSetCacheEntry& entry : g_sequence_set_cache)
+  {
+    if(entry.generation == generation && entry.token == token)
+    {
+      return entry.is_member;
+    }
+  }
+
+  const bool is_member = scanMembership();
+
+  SequenceSetCacheEntry& slot
+    = g_sequence_set_cache[
+        g_sequence_set_cache_next % kSequenceSetCacheSize];
+  ++g_sequence_set_cache_next;
+  slot.generation = generation;
+  slot.token = token;
+  slot.is_member = is_member;
+
+  return is_member;
+}
+
 void PostTaskAndWait(const base::Location& from_here
   , base::SequencedTaskRunner* task_runner
   , base::OnceClosure task)
@@ -45,4 +186,58 @@ void PostTaskAndWait(const base::Location& from_here
   event.Wait();
 }
 
+TaskRunnerAndTask::TaskRunnerAndTask(
+  scoped_refptr<base::SequencedTaskRunner> task_runner
+  , base::OnceClosure task)
+  : task_runner(std::move(task_runner))
+  , task(std::move(task))
+{}
+
+TaskRunnerAndTask::TaskRunnerAndTask(TaskRunnerAndTask&& other) = default;
+TaskRunnerAndTask& TaskRunnerAndTask::operator=(TaskRunnerAndTask&& other)
+  = default;
+TaskRunnerAndTask::~TaskRunnerAndTask() = default;
+
+void PostTasksAndWaitAll(const base::Location& from_here
+  , std::vector<TaskRunnerAndTask> tasks)
+{
+  DCHECK(!tasks.empty());
+
+  WaitAllState state(tasks.size());
+  for(TaskRunnerAndTask& unit : tasks) {
+    DCHECK(unit.task_runner);
+    {
+      bool ok = unit.task_runner->PostTask(from_here, std::move(unit.task));
+      DCHECK(ok);
+    }
+    {
+      /// \note countdown task will be executed
+      /// after previous due to usage of |base::SequencedTaskRunner|
+      bool ok = unit.task_runner->PostTask(FROM_HERE,
+        base::BindOnce(&CountdownAndMaybeSignal, base::Unretained(&state)));
+      DCHECK(ok);
+    }
+  }
+  // Each sequence signals the countdown only after its task executed,
+  // so one Wait() covers the whole fan-out.
+  state.event.Wait();
+}
+
+base::Promise<void, base::NoReject> PostTasksAsPromise(
+  const base::Location& from_here
+  , std::vector<TaskRunnerAndTask> tasks)
+{
+  DCHECK(!tasks.empty());
+
+  std::vector<base::Promise<void, base::NoReject>> promises;
+  promises.reserve(tasks.size());
+  for(TaskRunnerAndTask& unit : tasks) {
+    DCHECK(unit.task_runner);
+    promises.push_back(
+      base::PostPromise(
+        from_here, unit.task_runner.get(), std::move(unit.task)));
+  }
+  return base::Promises::All(from_here, promises);
+}
+
 } // namespace basis
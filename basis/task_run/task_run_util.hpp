@@ -2,18 +2,99 @@
 
 #include <base/logging.h>
 #include <base/location.h>
+#include <base/macros.h>
 #include <base/callback_forward.h>
 #include <base/sequenced_task_runner.h>
 
+#include <basis/promise/promise.h>
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
 namespace basis {
 
 bool RunsTasksInAnySequenceOf(
   const std::vector<scoped_refptr<base::SequencedTaskRunner>>& task_runners
   , bool dcheck_not_empty = true);
 
+// Fixed set of runners with O(1) repeat membership checks.
+//
+// RunsTasksInAnySequenceOf pays a virtual RunsTasksInCurrentSequence()
+// per runner on every call, which adds up in DCHECKs and routing on
+// hot paths with multi-runner sets. SequenceSet computes the verdict
+// once per calling sequence and caches it against the current
+// base::SequenceToken; repeat checks from the same sequence are a
+// cache probe. Any mutation bumps the set's generation, invalidating
+// every cached verdict at once.
+//
+// Checks are safe from any sequence (outside a sequence the check
+// falls back to the uncached scan). Mutations are not synchronized
+// against concurrent checks: build the set during bring-up, like the
+// AppRunners task-runner slots, then treat it as read-only.
+class SequenceSet {
+ public:
+  SequenceSet();
+  explicit SequenceSet(
+    std::vector<scoped_refptr<base::SequencedTaskRunner>> task_runners);
+  ~SequenceSet();
+
+  void insert(scoped_refptr<base::SequencedTaskRunner> task_runner);
+
+  void clear();
+
+  // True when the calling sequence is one of the set's runners.
+  [[nodiscard]] /* don't ignore return value */
+  bool RunsTasksInCurrentSequence() const;
+
+  [[nodiscard]] /* don't ignore return value */
+  size_t size() const noexcept { return task_runners_.size(); }
+
+ private:
+  // The O(n) verdict the cache fronts.
+  bool scanMembership() const;
+
+  std::vector<scoped_refptr<base::SequencedTaskRunner>> task_runners_;
+
+  // Globally unique per (set, mutation): cache entries from a previous
+  // mutation — or from a destroyed set that this one happens to share
+  // an address with — can never match.
+  std::atomic<uint64_t> generation_;
+
+  DISALLOW_COPY_AND_ASSIGN(SequenceSet);
+};
+
 // Posts |task| to |task_runner| and blocks until it is executed.
 void PostTaskAndWait(const base::Location& from_here
   , base::SequencedTaskRunner* task_runner
   , base::OnceClosure task);
 
+// One unit of a fan-out: |task| runs on |task_runner|.
+struct TaskRunnerAndTask {
+  TaskRunnerAndTask(
+    scoped_refptr<base::SequencedTaskRunner> task_runner
+    , base::OnceClosure task);
+  TaskRunnerAndTask(TaskRunnerAndTask&& other);
+  TaskRunnerAndTask& operator=(TaskRunnerAndTask&& other);
+  ~TaskRunnerAndTask();
+
+  scoped_refptr<base::SequencedTaskRunner> task_runner;
+  base::OnceClosure task;
+};
+
+// Posts every task concurrently and blocks once until all of them
+// executed. Unlike calling PostTaskAndWait in a row (which serializes
+// independent work into a latency sum), the wall time is the max of
+// the task durations. Tasks on the same sequence still run in order.
+/// \note must not be called from any of the target sequences
+/// (deadlock, same as PostTaskAndWait).
+void PostTasksAndWaitAll(const base::Location& from_here
+  , std::vector<TaskRunnerAndTask> tasks);
+
+// Non-blocking variant: resolves when every task executed; attach
+// continuations with ThenHere/ThenOn.
+base::Promise<void, base::NoReject> PostTasksAsPromise(
+  const base::Location& from_here
+  , std::vector<TaskRunnerAndTask> tasks);
+
 } // namespace basis
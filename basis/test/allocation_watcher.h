@@ -0,0 +1,213 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// Allocation-count assertions for tests: makes "zero allocations on
+// this path" an enforced property instead of folklore.
+//
+// USAGE (inside a test body, works under gtest and catch2):
+//
+//   EXPECT_ALLOCATIONS_LE(0) {
+//     buffer.each([](const Snapshot& s, const TickNumType& t) { ... });
+//   }
+//
+// The scope counts operator new calls on the CURRENT thread only, so
+// background pool activity does not pollute the count; run the
+// measured path on the test thread.
+//
+// Counting needs the global operator new/delete replacements below,
+// which must be emitted by EXACTLY ONE translation unit per test
+// binary:
+//
+//   #define BASIS_IMPLEMENT_ALLOCATION_WATCHER 1
+//   #include "basis/test/allocation_watcher.h"
+//
+// (tests/main.cpp does this for the tests/ tree.) Never define it in
+// code linked into production targets - the replacement taxes every
+// allocation in the binary with a thread_local check.
+
+namespace basis {
+namespace test {
+
+struct AllocationWatcherState {
+  // Counting is off outside EXPECT_ALLOCATIONS_LE scopes, so the
+  // hooks cost one predictable branch when idle.
+  bool counting = false;
+  size_t new_calls = 0;
+};
+
+inline AllocationWatcherState& allocationWatcherState()
+{
+  thread_local AllocationWatcherState state;
+  return state;
+}
+
+// Counts this thread's operator new calls between construction and
+// count(). Nestable; the inner scope's allocations count toward the
+// outer one too.
+class ScopedAllocationCounter {
+ public:
+  ScopedAllocationCounter()
+    : was_counting_(allocationWatcherState().counting)
+    , start_(allocationWatcherState().new_calls)
+  {
+    allocationWatcherState().counting = true;
+  }
+
+  ~ScopedAllocationCounter()
+  {
+    allocationWatcherState().counting = was_counting_;
+  }
+
+  size_t count() const
+  {
+    return allocationWatcherState().new_calls - start_;
+  }
+
+  ScopedAllocationCounter(const ScopedAllocationCounter&) = delete;
+  ScopedAllocationCounter& operator=(const ScopedAllocationCounter&)
+    = delete;
+
+ private:
+  const bool was_counting_;
+  const size_t start_;
+};
+
+namespace internal {
+
+inline void* countedAlloc(std::size_t size) noexcept
+{
+  AllocationWatcherState& state = allocationWatcherState();
+  if(state.counting) {
+    ++state.new_calls;
+  }
+  return std::malloc(size ? size : 1);
+}
+
+inline void* countedAlignedAlloc(
+  std::size_t size, std::size_t alignment) noexcept
+{
+  AllocationWatcherState& state = allocationWatcherState();
+  if(state.counting) {
+    ++state.new_calls;
+  }
+  void* ptr = nullptr;
+  if(::posix_memalign(&ptr, alignment, size ? size : alignment) != 0) {
+    return nullptr;
+  }
+  return ptr;
+}
+
+} // namespace internal
+
+} // namespace test
+} // namespace basis
+
+// Maps onto whichever assertion framework the including test uses.
+#if !defined(BASIS_TEST_EXPECT_ALLOC_LE)
+#if defined(USE_CATCH_TEST)
+#define BASIS_TEST_EXPECT_ALLOC_LE(actual, max) CHECK((actual) <= (max))
+#else
+#define BASIS_TEST_EXPECT_ALLOC_LE(actual, max) EXPECT_LE(actual, max)
+#endif
+#endif // !defined(BASIS_TEST_EXPECT_ALLOC_LE)
+
+// Runs the braced statement that follows with counting enabled, then
+// asserts at most |max_allocs| operator new calls happened on this
+// thread. The count is frozen before the assertion macro runs, so the
+// framework's own allocations while recording the result cannot skew
+// it.
+#define EXPECT_ALLOCATIONS_LE(max_allocs)                             \
+  if(::basis::test::ScopedAllocationCounter basis_alloc_counter{};    \
+     true)                                                            \
+    for(size_t basis_alloc_observed = static_cast<size_t>(-1);        \
+        basis_alloc_observed == static_cast<size_t>(-1)               \
+          || (BASIS_TEST_EXPECT_ALLOC_LE(                             \
+                basis_alloc_observed                                  \
+                , static_cast<size_t>(max_allocs))                    \
+              , false);                                               \
+        basis_alloc_observed = basis_alloc_counter.count())
+
+#if defined(BASIS_IMPLEMENT_ALLOCATION_WATCHER)
+
+void* operator new(std::size_t size)
+{
+  void* ptr = basis::test::internal::countedAlloc(size);
+  if(!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void* operator new[](std::size_t size)
+{
+  void* ptr = basis::test::internal::countedAlloc(size);
+  if(!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+  return basis::test::internal::countedAlloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+  return basis::test::internal::countedAlloc(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+  void* ptr = basis::test::internal::countedAlignedAlloc(
+    size, static_cast<std::size_t>(alignment));
+  if(!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+  void* ptr = basis::test::internal::countedAlignedAlloc(
+    size, static_cast<std::size_t>(alignment));
+  if(!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+  std::free(ptr);
+}
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+  std::free(ptr);
+}
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+  std::free(ptr);
+}
+void operator delete[](void* ptr, std::align_val_t) noexcept
+{
+  std::free(ptr);
+}
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept
+{
+  std::free(ptr);
+}
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept
+{
+  std::free(ptr);
+}
+
+#endif // BASIS_IMPLEMENT_ALLOCATION_WATCHER
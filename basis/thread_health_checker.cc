@@ -4,31 +4,147 @@
 
 #include "chromecast/base/thread_health_checker.h"
 
+#include <chrono>
 #include <memory>
 #include <string>
+#include <utility>
 
 #include "base/bind.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
 #include "base/memory/ref_counted.h"
 #include "base/sequenced_task_runner.h"
+#include "base/strings/stringprintf.h"
 #include "base/task_runner.h"
 #include "base/threading/thread_checker.h"
+#include "base/time/tick_clock.h"
 #include "base/timer/timer.h"
 #include "chromecast/base/bind_to_task_runner.h"
 
+#include "basis/tracing_util.hpp"
+
 namespace chromecast {
 
+namespace {
+
+// Kernel-mode stack of a sibling thread. Pinpoints what a stalled
+// thread is blocked on inside the kernel (futex, disk I/O, ...).
+// Returns "" when the read fails: CONFIG_STACKTRACE kernels often
+// restrict the file to CAP_SYS_ADMIN, and the tid may have exited.
+std::string ReadKernelStack(base::PlatformThreadId tid) {
+#if defined(OS_LINUX) || defined(__linux__)
+  std::string stack;
+  if (!base::ReadFileToString(
+          base::FilePath(base::StringPrintf("/proc/self/task/%d/stack",
+                                            static_cast<int>(tid))),
+          &stack)) {
+    return std::string();
+  }
+  return stack;
+#else
+  return std::string();
+#endif
+}
+
+}  // namespace
+
+ThreadHeartbeat::ThreadHeartbeat() : ThreadHeartbeat(nullptr) {}
+
+ThreadHeartbeat::ThreadHeartbeat(const base::TickClock* tick_clock)
+    : tick_clock_(tick_clock),
+      // Start "fresh" so a thread that has not had a chance to beat yet
+      // is not reported stalled right after creation.
+      last_beat_us_(NowTicks().since_origin().InMicroseconds()) {}
+
+ThreadHeartbeat::~ThreadHeartbeat() {}
+
+void ThreadHeartbeat::Beat() {
+  // The tid only needs recording once; steady state adds one relaxed
+  // load to the hot path instead of a gettid syscall per beat.
+  if (last_beat_tid_.load(std::memory_order_relaxed) ==
+      base::kInvalidThreadId) {
+    last_beat_tid_.store(base::PlatformThread::CurrentId(),
+                         std::memory_order_relaxed);
+  }
+  last_beat_us_.store(NowTicks().since_origin().InMicroseconds(),
+                      std::memory_order_relaxed);
+}
+
+void ThreadHeartbeat::BeatWithTaskLocation(
+    const base::Location& task_location) {
+  task_function_name_.store(task_location.function_name(),
+                            std::memory_order_relaxed);
+  task_file_name_.store(task_location.file_name(),
+                        std::memory_order_relaxed);
+  task_line_number_.store(task_location.line_number(),
+                          std::memory_order_relaxed);
+  Beat();
+}
+
+base::TimeTicks ThreadHeartbeat::last_beat() const {
+  return base::TimeTicks() + base::TimeDelta::FromMicroseconds(
+                                 last_beat_us_.load(std::memory_order_relaxed));
+}
+
+base::PlatformThreadId ThreadHeartbeat::last_beat_thread_id() const {
+  return last_beat_tid_.load(std::memory_order_relaxed);
+}
+
+std::string ThreadHeartbeat::last_task_location() const {
+  const char* function = task_function_name_.load(std::memory_order_relaxed);
+  if (!function)
+    return std::string();
+  const char* file = task_file_name_.load(std::memory_order_relaxed);
+  return base::StringPrintf("%s@%s:%d", function, file ? file : "?",
+                            task_line_number_.load(std::memory_order_relaxed));
+}
+
+base::TimeTicks ThreadHeartbeat::NowTicks() const {
+  return tick_clock_ ? tick_clock_->NowTicks() : base::TimeTicks::Now();
+}
+
+StallDiagnostics CaptureStallDiagnostics(const ThreadHeartbeat* heartbeat,
+                                         const std::string& trace_dump_dir) {
+  StallDiagnostics diagnostics;
+  if (heartbeat) {
+    diagnostics.thread_id = heartbeat->last_beat_thread_id();
+    diagnostics.task_location = heartbeat->last_task_location();
+    if (diagnostics.thread_id != base::kInvalidThreadId)
+      diagnostics.kernel_stack = ReadKernelStack(diagnostics.thread_id);
+  }
+  if (!trace_dump_dir.empty()) {
+    // One file per detection: tid plus capture time keeps repeated
+    // stalls of the same thread from overwriting each other.
+    const base::FilePath path =
+        base::FilePath(trace_dump_dir)
+            .AppendASCII(base::StringPrintf(
+                "stall_tid%d_%lld.trace", static_cast<int>(diagnostics.thread_id),
+                static_cast<long long>(
+                    base::TimeTicks::Now().since_origin().InMicroseconds())));
+    if (basis::dumpTraceSnapshot(path))
+      diagnostics.trace_dump_path = path.value();
+  }
+  return diagnostics;
+}
+
 ThreadHealthChecker::Internal::Internal(
     scoped_refptr<base::TaskRunner> patient_task_runner,
+    scoped_refptr<ThreadHeartbeat> heartbeat,
     scoped_refptr<base::SequencedTaskRunner> doctor_task_runner,
     base::TimeDelta interval,
     base::TimeDelta timeout,
-    base::RepeatingClosure on_failure)
+    base::RepeatingClosure on_failure,
+    StallDiagnosticsCallback on_stall_diagnostics,
+    const std::string& trace_dump_dir)
     : patient_task_runner_(std::move(patient_task_runner)),
+      heartbeat_(std::move(heartbeat)),
       doctor_task_runner_(std::move(doctor_task_runner)),
       interval_(interval),
       timeout_(timeout),
-      on_failure_(std::move(on_failure)) {
-  DCHECK(patient_task_runner_);
+      on_failure_(std::move(on_failure)),
+      on_stall_diagnostics_(std::move(on_stall_diagnostics)),
+      trace_dump_dir_(trace_dump_dir) {
+  DCHECK(!patient_task_runner_ != !heartbeat_);
   DCHECK(doctor_task_runner_);
 }
 
@@ -59,6 +175,10 @@ void ThreadHealthChecker::Internal::ScheduleHealthCheck() {
 void ThreadHealthChecker::Internal::CheckThreadHealth() {
   DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
   DCHECK(!failure_timer_->IsRunning());
+  if (heartbeat_) {
+    CheckHeartbeat();
+    return;
+  }
   patient_task_runner_->PostTask(
       FROM_HERE, BindToCurrentThread(base::BindOnce(
                      &ThreadHealthChecker::Internal::ThreadOk, this)));
@@ -66,6 +186,15 @@ void ThreadHealthChecker::Internal::CheckThreadHealth() {
                         &ThreadHealthChecker::Internal::ThreadTimeout);
 }
 
+// Passive mode: nothing is posted to the patient; the checkup is a read
+// of the heartbeat slot against the heartbeat's own clock.
+void ThreadHealthChecker::Internal::CheckHeartbeat() {
+  DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+  if (heartbeat_->NowTicks() - heartbeat_->last_beat() > timeout_)
+    ReportFailure();
+  ScheduleHealthCheck();
+}
+
 void ThreadHealthChecker::Internal::ThreadOk() {
   DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
   failure_timer_->Stop();
@@ -74,10 +203,24 @@ void ThreadHealthChecker::Internal::ThreadOk() {
 
 void ThreadHealthChecker::Internal::ThreadTimeout() {
   DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
-  on_failure_.Run();
+  ReportFailure();
   ScheduleHealthCheck();
 }
 
+void ThreadHealthChecker::Internal::ReportFailure() {
+  DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+  // Capture before the failure callback runs, so the trace ring and the
+  // kernel stack reflect the stall rather than the handler's own work.
+  // |heartbeat_| is null in sentinel mode: the bundle then carries only
+  // the trace snapshot.
+  StallDiagnostics diagnostics;
+  if (on_stall_diagnostics_)
+    diagnostics = CaptureStallDiagnostics(heartbeat_.get(), trace_dump_dir_);
+  on_failure_.Run();
+  if (on_stall_diagnostics_)
+    on_stall_diagnostics_.Run(diagnostics);
+}
+
 // The public ThreadHealthChecker owns a ref-counted reference to an Internal
 // object which does the heavy lifting.
 ThreadHealthChecker::ThreadHealthChecker(
@@ -85,14 +228,43 @@ ThreadHealthChecker::ThreadHealthChecker(
     scoped_refptr<base::SequencedTaskRunner> doctor_task_runner,
     base::TimeDelta interval,
     base::TimeDelta timeout,
-    base::RepeatingClosure on_failure)
+    base::RepeatingClosure on_failure,
+    StallDiagnosticsCallback on_stall_diagnostics,
+    const std::string& trace_dump_dir)
     : doctor_task_runner_(doctor_task_runner),
       internal_(base::MakeRefCounted<ThreadHealthChecker::Internal>(
           patient_task_runner,
+          nullptr,
           doctor_task_runner,
           interval,
           timeout,
-          std::move(on_failure))) {
+          std::move(on_failure),
+          std::move(on_stall_diagnostics),
+          trace_dump_dir)) {
+  doctor_task_runner_->PostTask(
+      FROM_HERE,
+      base::BindOnce(&ThreadHealthChecker::Internal::StartHealthCheck,
+                     internal_));
+}
+
+ThreadHealthChecker::ThreadHealthChecker(
+    scoped_refptr<ThreadHeartbeat> heartbeat,
+    scoped_refptr<base::SequencedTaskRunner> doctor_task_runner,
+    base::TimeDelta interval,
+    base::TimeDelta timeout,
+    base::RepeatingClosure on_failure,
+    StallDiagnosticsCallback on_stall_diagnostics,
+    const std::string& trace_dump_dir)
+    : doctor_task_runner_(doctor_task_runner),
+      internal_(base::MakeRefCounted<ThreadHealthChecker::Internal>(
+          nullptr,
+          std::move(heartbeat),
+          doctor_task_runner,
+          interval,
+          timeout,
+          std::move(on_failure),
+          std::move(on_stall_diagnostics),
+          trace_dump_dir)) {
   doctor_task_runner_->PostTask(
       FROM_HERE,
       base::BindOnce(&ThreadHealthChecker::Internal::StartHealthCheck,
@@ -109,4 +281,170 @@ ThreadHealthChecker::~ThreadHealthChecker() {
                                 internal_));
 }
 
+ThreadHealthRegistry::Internal::Internal(
+    base::TimeDelta interval,
+    base::TimeDelta timeout,
+    base::RepeatingCallback<void(const std::string&)> on_failure,
+    const base::TickClock* tick_clock,
+    StallDiagnosticsCallback on_stall_diagnostics,
+    const std::string& trace_dump_dir)
+    : interval_(interval),
+      timeout_(timeout),
+      on_failure_(std::move(on_failure)),
+      on_stall_diagnostics_(std::move(on_stall_diagnostics)),
+      trace_dump_dir_(trace_dump_dir),
+      tick_clock_(tick_clock) {}
+
+ThreadHealthRegistry::Internal::~Internal() {}
+
+void ThreadHealthRegistry::Internal::Start() {
+  DETACH_FROM_THREAD(thread_checker_);
+  timer_ = std::make_unique<base::RepeatingTimer>();
+  timer_->Start(FROM_HERE, interval_, this,
+                &ThreadHealthRegistry::Internal::CheckAll);
+}
+
+void ThreadHealthRegistry::Internal::Stop() {
+  DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+  timer_->Stop();
+}
+
+void ThreadHealthRegistry::Internal::Register(
+    const std::string& name,
+    scoped_refptr<ThreadHeartbeat> heartbeat,
+    scoped_refptr<base::TaskRunner> patient_task_runner) {
+  DCHECK(heartbeat);
+  Entry entry;
+  entry.name = name;
+  entry.heartbeat = std::move(heartbeat);
+  entry.patient_task_runner = std::move(patient_task_runner);
+  base::AutoLock lock(lock_);
+  entries_.push_back(std::move(entry));
+}
+
+// The single doctor pass: every patient is checked with one read of its
+// heartbeat slot, and sentinel-mode patients get next round's heartbeat
+// task posted.
+void ThreadHealthRegistry::Internal::CheckAll() {
+  DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+  struct Failed {
+    std::string name;
+    scoped_refptr<ThreadHeartbeat> heartbeat;
+  };
+  std::vector<Failed> failed;
+  {
+    base::AutoLock lock(lock_);
+    for (Entry& entry : entries_) {
+      const base::TimeDelta age =
+          entry.heartbeat->NowTicks() - entry.heartbeat->last_beat();
+      heartbeat_age_.record(
+          std::chrono::nanoseconds(age.InMicroseconds() * 1000));
+      entry.healthy = age <= timeout_;
+      if (!entry.healthy) {
+        ++entry.stall_count;
+        ++total_stalls_;
+        failed.push_back({entry.name, entry.heartbeat});
+      }
+      if (entry.patient_task_runner) {
+        entry.patient_task_runner->PostTask(
+            FROM_HERE,
+            base::BindOnce(&ThreadHeartbeat::Beat, entry.heartbeat));
+      }
+    }
+  }
+  // Outside the lock: the callbacks may call GetStatus(), and the
+  // diagnostics capture blocks on /proc reads and the trace flush.
+  for (const Failed& f : failed) {
+    on_failure_.Run(f.name);
+    if (on_stall_diagnostics_) {
+      on_stall_diagnostics_.Run(
+          f.name, CaptureStallDiagnostics(f.heartbeat.get(), trace_dump_dir_));
+    }
+  }
+}
+
+std::vector<ThreadHealthRegistry::ThreadStatus>
+ThreadHealthRegistry::Internal::GetStatus() const {
+  std::vector<ThreadStatus> status;
+  base::AutoLock lock(lock_);
+  status.reserve(entries_.size());
+  for (const Entry& entry : entries_) {
+    ThreadStatus thread_status;
+    thread_status.name = entry.name;
+    thread_status.healthy = entry.healthy;
+    thread_status.stall_count = entry.stall_count;
+    status.push_back(std::move(thread_status));
+  }
+  return status;
+}
+
+uint64_t ThreadHealthRegistry::Internal::total_stalls() const {
+  base::AutoLock lock(lock_);
+  return total_stalls_;
+}
+
+basis::LockFreeHistogram::Snapshot
+ThreadHealthRegistry::Internal::heartbeat_age_snapshot() const {
+  // Lock-free reads; no lock needed.
+  return heartbeat_age_.snapshot();
+}
+
+ThreadHealthRegistry::ThreadHealthRegistry(
+    scoped_refptr<base::SequencedTaskRunner> doctor_task_runner,
+    base::TimeDelta interval,
+    base::TimeDelta timeout,
+    base::RepeatingCallback<void(const std::string&)> on_failure,
+    const base::TickClock* tick_clock,
+    StallDiagnosticsCallback on_stall_diagnostics,
+    const std::string& trace_dump_dir)
+    : doctor_task_runner_(doctor_task_runner),
+      internal_(base::MakeRefCounted<ThreadHealthRegistry::Internal>(
+          interval,
+          timeout,
+          std::move(on_failure),
+          tick_clock,
+          std::move(on_stall_diagnostics),
+          trace_dump_dir)) {
+  DCHECK(doctor_task_runner_);
+  doctor_task_runner_->PostTask(
+      FROM_HERE,
+      base::BindOnce(&ThreadHealthRegistry::Internal::Start, internal_));
+}
+
+// Mirrors ~ThreadHealthChecker: pending doctor tasks that partially own
+// Internal run before it is destroyed and the timer stops.
+ThreadHealthRegistry::~ThreadHealthRegistry() {
+  doctor_task_runner_->PostTask(
+      FROM_HERE,
+      base::BindOnce(&ThreadHealthRegistry::Internal::Stop, internal_));
+}
+
+void ThreadHealthRegistry::Register(const std::string& name,
+                                    scoped_refptr<ThreadHeartbeat> heartbeat) {
+  internal_->Register(name, std::move(heartbeat), nullptr);
+}
+
+void ThreadHealthRegistry::Register(
+    const std::string& name,
+    scoped_refptr<base::TaskRunner> patient_task_runner) {
+  DCHECK(patient_task_runner);
+  internal_->Register(
+      name, base::MakeRefCounted<ThreadHeartbeat>(internal_->tick_clock()),
+      std::move(patient_task_runner));
+}
+
+std::vector<ThreadHealthRegistry::ThreadStatus>
+ThreadHealthRegistry::GetStatus() const {
+  return internal_->GetStatus();
+}
+
+uint64_t ThreadHealthRegistry::total_stalls() const {
+  return internal_->total_stalls();
+}
+
+basis::LockFreeHistogram::Snapshot
+ThreadHealthRegistry::heartbeat_age_snapshot() const {
+  return internal_->heartbeat_age_snapshot();
+}
+
 }  // namespace chromecast
@@ -5,22 +5,119 @@
 #ifndef CHROMECAST_INTERNAL_SERVICE_THREAD_HEALTH_CHECKER_H_
 #define CHROMECAST_INTERNAL_SERVICE_THREAD_HEALTH_CHECKER_H_
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "base/callback.h"
+#include "base/location.h"
 #include "base/macros.h"
 #include "base/memory/ref_counted.h"
+#include "base/synchronization/lock.h"
+#include "base/threading/platform_thread.h"
 #include "base/threading/thread_checker.h"
 #include "base/time/time.h"
 
+#include "basis/metrics/Metrics.hpp"
+
 namespace base {
 class OneShotTimer;
+class RepeatingTimer;
 class SequencedTaskRunner;
 class TaskRunner;
+class TickClock;
 }  // namespace base
 
 namespace chromecast {
+
+// A shared slot into which an instrumented thread publishes a monotonic
+// heartbeat on its natural work cadence (e.g. once per loop iteration).
+// Beat() is a single relaxed atomic store, so it adds no queue traffic
+// and no measurable cost to the instrumented thread; readers compare
+// last_beat() against the current time. See the passive mode of
+// ThreadHealthChecker below.
+class ThreadHeartbeat : public base::RefCountedThreadSafe<ThreadHeartbeat> {
+ public:
+  ThreadHeartbeat();
+  // |tick_clock| must outlive this object; used by tests to control
+  // time. Null falls back to base::TimeTicks::Now().
+  explicit ThreadHeartbeat(const base::TickClock* tick_clock);
+
+  // Called by the instrumented thread. Thread-safe.
+  void Beat();
+
+  // Beat() plus a note of which task the thread is starting, so a later
+  // stall can be attributed to a posted-from location instead of just a
+  // thread name. |task_location| must point at static-lifetime strings,
+  // which FROM_HERE and base::PendingTask::posted_from guarantee; the
+  // extra cost over Beat() is three relaxed stores. Thread-safe.
+  void BeatWithTaskLocation(const base::Location& task_location);
+
+  // Time of the most recent Beat() (creation time if none yet).
+  // Thread-safe.
+  base::TimeTicks last_beat() const;
+
+  // Id of the first thread that called Beat() (the instrumented thread;
+  // the slot is meant to be beaten by exactly one), or
+  // base::kInvalidThreadId if none beat yet. Thread-safe.
+  base::PlatformThreadId last_beat_thread_id() const;
+
+  // "Function@file.cc:42" for the task last published through
+  // BeatWithTaskLocation(), or empty. The three location slots are read
+  // independently, so a beat racing this call can mix two tasks'
+  // fields; acceptable for diagnostics. Thread-safe.
+  std::string last_task_location() const;
+
+  base::TimeTicks NowTicks() const;
+
+ private:
+  friend class base::RefCountedThreadSafe<ThreadHeartbeat>;
+  ~ThreadHeartbeat();
+
+  const base::TickClock* const tick_clock_;
+  std::atomic<int64_t> last_beat_us_;
+  // Recorded once, on the first Beat(): the tid never changes, so the
+  // steady-state cost is one relaxed load instead of a gettid syscall
+  // per beat.
+  std::atomic<base::PlatformThreadId> last_beat_tid_{base::kInvalidThreadId};
+  std::atomic<const char*> task_function_name_{nullptr};
+  std::atomic<const char*> task_file_name_{nullptr};
+  std::atomic<int> task_line_number_{-1};
+
+  DISALLOW_COPY_AND_ASSIGN(ThreadHeartbeat);
+};
+
+// Evidence bundle captured on the doctor sequence when a stall is
+// detected, so one occurrence is enough to hand the owning team an
+// actionable profile instead of just a thread name.
+struct StallDiagnostics {
+  // From the patient's ThreadHeartbeat; base::kInvalidThreadId in
+  // sentinel mode (no heartbeat) or if the thread never beat.
+  base::PlatformThreadId thread_id = base::kInvalidThreadId;
+  // Kernel-mode stack of the stalled thread (/proc/self/task/<tid>/
+  // stack) — pinpoints threads blocked in syscalls (futex, disk I/O,
+  // ...). Empty when the tid is unknown or the read is not permitted
+  // (many kernels restrict it to CAP_SYS_ADMIN).
+  std::string kernel_stack;
+  // Posted-from location of the task the thread last started, when the
+  // patient publishes it via ThreadHeartbeat::BeatWithTaskLocation().
+  std::string task_location;
+  // File holding a snapshot of the flight-recorder trace ring (see
+  // basis::startTraceFlightRecorder) taken at detection time; empty
+  // when no dump directory was configured or the dump failed.
+  std::string trace_dump_path;
+};
+
+// Captures a StallDiagnostics bundle for the patient behind |heartbeat|
+// (may be null: only the trace ring is snapshotted). |trace_dump_dir|
+// empty skips the trace snapshot; otherwise the ring is dumped there in
+// whatever format initTracing() selected. Blocks on the trace flush;
+// call from the doctor sequence, not the stalled thread.
+StallDiagnostics CaptureStallDiagnostics(const ThreadHeartbeat* heartbeat,
+                                         const std::string& trace_dump_dir);
+
 // A class used to periodically check the responsiveness of a thread.
 //
 // The class takes two task runners, a "patient", and a "doctor". The doctor
@@ -32,24 +129,57 @@ namespace chromecast {
 // The thread health is checked periodically, with the length between one check
 // and the next determined by |interval|, and the amount of time allowed for the
 // sentinel task to complete determined by |timeout|.
+//
+// The sentinel mode above perturbs the patient's queue and costs a
+// cross-thread post/reply pair per check. The second constructor is a
+// passive mode: the patient publishes into a ThreadHeartbeat on its own
+// cadence and the doctor just reads the timestamp on its timer, failing
+// the checkup when the last beat is older than |timeout|. Since checks
+// add no work to the patient, |interval| can be shortened to ~100ms
+// across many threads without affecting them.
+//
+// When |on_stall_diagnostics| is set it runs right after |on_failure|
+// with a StallDiagnostics bundle captured at detection time. Sentinel
+// mode has no heartbeat, so its bundle carries only the trace snapshot;
+// passive mode also gets the tid, kernel stack and task location.
 class ThreadHealthChecker {
  public:
+  using StallDiagnosticsCallback =
+      base::RepeatingCallback<void(const StallDiagnostics&)>;
+
   ThreadHealthChecker(
       scoped_refptr<base::TaskRunner> patient_task_runner,
       scoped_refptr<base::SequencedTaskRunner> doctor_task_runner,
       base::TimeDelta interval,
       base::TimeDelta timeout,
-      base::RepeatingClosure on_failure);
+      base::RepeatingClosure on_failure,
+      StallDiagnosticsCallback on_stall_diagnostics =
+          StallDiagnosticsCallback(),
+      const std::string& trace_dump_dir = std::string());
+  // Passive mode: no sentinel tasks; |heartbeat| is compared against
+  // |timeout| every |interval|.
+  ThreadHealthChecker(
+      scoped_refptr<ThreadHeartbeat> heartbeat,
+      scoped_refptr<base::SequencedTaskRunner> doctor_task_runner,
+      base::TimeDelta interval,
+      base::TimeDelta timeout,
+      base::RepeatingClosure on_failure,
+      StallDiagnosticsCallback on_stall_diagnostics =
+          StallDiagnosticsCallback(),
+      const std::string& trace_dump_dir = std::string());
   ~ThreadHealthChecker();
 
  private:
   class Internal : public base::RefCountedThreadSafe<Internal> {
    public:
     Internal(scoped_refptr<base::TaskRunner> patient_task_runner,
+             scoped_refptr<ThreadHeartbeat> heartbeat,
              scoped_refptr<base::SequencedTaskRunner> doctor_task_runner,
              base::TimeDelta interval,
              base::TimeDelta timeout,
-             base::RepeatingClosure on_failure);
+             base::RepeatingClosure on_failure,
+             StallDiagnosticsCallback on_stall_diagnostics,
+             const std::string& trace_dump_dir);
     void StartHealthCheck();
     void StopHealthCheck();
 
@@ -58,16 +188,23 @@ class ThreadHealthChecker {
     ~Internal();
     void ScheduleHealthCheck();
     void CheckThreadHealth();
+    void CheckHeartbeat();
     void ThreadOk();
     void ThreadTimeout();
+    void ReportFailure();
 
+    // Exactly one of |patient_task_runner_| (sentinel mode) and
+    // |heartbeat_| (passive mode) is set.
     scoped_refptr<base::TaskRunner> patient_task_runner_;
+    scoped_refptr<ThreadHeartbeat> heartbeat_;
     scoped_refptr<base::SequencedTaskRunner> doctor_task_runner_;
     base::TimeDelta interval_;
     base::TimeDelta timeout_;
     std::unique_ptr<base::OneShotTimer> ok_timer_;
     std::unique_ptr<base::OneShotTimer> failure_timer_;
     base::RepeatingClosure on_failure_;
+    StallDiagnosticsCallback on_stall_diagnostics_;
+    std::string trace_dump_dir_;
     THREAD_CHECKER(thread_checker_);
   };
 
@@ -77,6 +214,127 @@ class ThreadHealthChecker {
   DISALLOW_COPY_AND_ASSIGN(ThreadHealthChecker);
 };
 
+// Multiplexes health checking of many threads onto one periodic timer.
+//
+// One ThreadHealthChecker per monitored thread means one timer wakeup
+// per thread per interval on the doctor sequence. The registry keeps a
+// single repeating timer and checks every registered patient in one
+// pass, and exports per-thread status plus an aggregate stall count in
+// one API for health metrics.
+//
+// Patients register either passively (a ThreadHeartbeat the thread
+// beats itself) or by task runner, in which case the registry posts a
+// heartbeat task through the runner each pass, so an unresponsive
+// queue shows up as a stale beat on the following pass.
+class ThreadHealthRegistry {
+ public:
+  struct ThreadStatus {
+    std::string name;
+    // Whether the patient passed the most recent check.
+    bool healthy = true;
+    // Failed checks for this patient since registration.
+    uint64_t stall_count = 0;
+  };
+
+  using StallDiagnosticsCallback =
+      base::RepeatingCallback<void(const std::string&,
+                                   const StallDiagnostics&)>;
+
+  // |on_failure| is run on the doctor sequence with the name of each
+  // patient that fails a pass. |tick_clock| (may be null) is used for
+  // staleness comparisons and internally created heartbeats; tests
+  // inject a mock clock through it. |on_stall_diagnostics| (may be
+  // null) additionally gets a StallDiagnostics bundle per failed
+  // patient, captured after the pass outside the registry lock.
+  ThreadHealthRegistry(
+      scoped_refptr<base::SequencedTaskRunner> doctor_task_runner,
+      base::TimeDelta interval,
+      base::TimeDelta timeout,
+      base::RepeatingCallback<void(const std::string&)> on_failure,
+      const base::TickClock* tick_clock = nullptr,
+      StallDiagnosticsCallback on_stall_diagnostics =
+          StallDiagnosticsCallback(),
+      const std::string& trace_dump_dir = std::string());
+  ~ThreadHealthRegistry();
+
+  // Thread-safe; patients cannot be unregistered.
+  void Register(const std::string& name,
+                scoped_refptr<ThreadHeartbeat> heartbeat);
+  void Register(const std::string& name,
+                scoped_refptr<base::TaskRunner> patient_task_runner);
+
+  // Snapshot of every patient's status. Thread-safe.
+  std::vector<ThreadStatus> GetStatus() const;
+
+  // Failed checks across all patients since creation. Thread-safe.
+  uint64_t total_stalls() const;
+
+  // Distribution of heartbeat ages observed at check time across all
+  // patients — the p99 age shows how close the fleet runs to |timeout|
+  // before any stall actually fires. Thread-safe.
+  basis::LockFreeHistogram::Snapshot heartbeat_age_snapshot() const;
+
+ private:
+  class Internal : public base::RefCountedThreadSafe<Internal> {
+   public:
+    Internal(base::TimeDelta interval,
+             base::TimeDelta timeout,
+             base::RepeatingCallback<void(const std::string&)> on_failure,
+             const base::TickClock* tick_clock,
+             StallDiagnosticsCallback on_stall_diagnostics,
+             const std::string& trace_dump_dir);
+
+    void Start();
+    void Stop();
+    void Register(const std::string& name,
+                  scoped_refptr<ThreadHeartbeat> heartbeat,
+                  scoped_refptr<base::TaskRunner> patient_task_runner);
+    std::vector<ThreadStatus> GetStatus() const;
+    uint64_t total_stalls() const;
+    basis::LockFreeHistogram::Snapshot heartbeat_age_snapshot() const;
+
+    const base::TickClock* tick_clock() const { return tick_clock_; }
+
+   private:
+    friend class base::RefCountedThreadSafe<Internal>;
+    ~Internal();
+    void CheckAll();
+
+    struct Entry {
+      std::string name;
+      scoped_refptr<ThreadHeartbeat> heartbeat;
+      // Null for passive patients.
+      scoped_refptr<base::TaskRunner> patient_task_runner;
+      bool healthy = true;
+      uint64_t stall_count = 0;
+    };
+
+    const base::TimeDelta interval_;
+    const base::TimeDelta timeout_;
+    const base::RepeatingCallback<void(const std::string&)> on_failure_;
+    const StallDiagnosticsCallback on_stall_diagnostics_;
+    const std::string trace_dump_dir_;
+    const base::TickClock* const tick_clock_;
+    std::unique_ptr<base::RepeatingTimer> timer_;
+
+    // Lock-free; recorded during the doctor pass, readable anytime.
+    basis::LockFreeHistogram heartbeat_age_;
+
+    // Guards |entries_| and |total_stalls_|: the doctor pass mutates
+    // them while GetStatus()/Register() may run on any thread.
+    mutable base::Lock lock_;
+    std::vector<Entry> entries_;
+    uint64_t total_stalls_ = 0;
+
+    THREAD_CHECKER(thread_checker_);
+  };
+
+  scoped_refptr<base::SequencedTaskRunner> doctor_task_runner_;
+  scoped_refptr<Internal> internal_;
+
+  DISALLOW_COPY_AND_ASSIGN(ThreadHealthRegistry);
+};
+
 }  // namespace chromecast
 
 #endif  // CHROMECAST_INTERNAL_SERVICE_THREAD_HEALTH_CHECKER_H_
@@ -4,10 +4,15 @@
 
 #include "chromecast/base/thread_health_checker.h"
 
+#include <string>
+#include <vector>
+
 #include "base/bind.h"
+#include "base/location.h"
 #include "base/memory/ref_counted.h"
 #include "base/synchronization/waitable_event.h"
 #include "base/test/test_mock_time_task_runner.h"
+#include "base/threading/platform_thread.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace chromecast {
@@ -15,6 +20,23 @@ namespace chromecast {
 namespace {
 const base::TimeDelta kInterval = base::TimeDelta::FromSeconds(3);
 const base::TimeDelta kTimeout = base::TimeDelta::FromSeconds(2);
+
+void RecordName(std::vector<std::string>* names, const std::string& name) {
+  names->push_back(name);
+}
+
+void RecordDiagnostics(std::vector<StallDiagnostics>* bundles,
+                       const StallDiagnostics& diagnostics) {
+  bundles->push_back(diagnostics);
+}
+
+void RecordNamedDiagnostics(std::vector<std::string>* names,
+                            std::vector<StallDiagnostics>* bundles,
+                            const std::string& name,
+                            const StallDiagnostics& diagnostics) {
+  names->push_back(name);
+  bundles->push_back(diagnostics);
+}
 }  // namespace
 
 class ThreadHealthCheckerTest : public ::testing::Test {
@@ -89,6 +111,160 @@ TEST_F(ThreadHealthCheckerTest, NoCrashWhenDestroyed) {
   doctor_->RunUntilIdle();
 }
 
+#define CREATE_PASSIVE_THREAD_HEALTH_CHECKER(name, heartbeat)                \
+  ThreadHealthChecker name(heartbeat, doctor_, kInterval, kTimeout,          \
+                           base::BindRepeating(&base::WaitableEvent::Signal, \
+                                               base::Unretained(&event_)))
+
+TEST_F(ThreadHealthCheckerTest, PassiveModeOkWhileHeartbeatFresh) {
+  auto heartbeat =
+      base::MakeRefCounted<ThreadHeartbeat>(doctor_->GetMockTickClock());
+  CREATE_PASSIVE_THREAD_HEALTH_CHECKER(thc, heartbeat);
+  // Beat before the first check at |kInterval|, so the slot is fresh.
+  doctor_->FastForwardBy(base::TimeDelta::FromSeconds(2));
+  heartbeat->Beat();
+  doctor_->FastForwardBy(base::TimeDelta::FromSeconds(2));
+  EXPECT_FALSE(event_.IsSignaled());
+}
+
+TEST_F(ThreadHealthCheckerTest, PassiveModeFiresWhenHeartbeatStale) {
+  auto heartbeat =
+      base::MakeRefCounted<ThreadHeartbeat>(doctor_->GetMockTickClock());
+  CREATE_PASSIVE_THREAD_HEALTH_CHECKER(thc, heartbeat);
+  // Never beat: by the first check the slot is |kInterval| old, which
+  // exceeds |kTimeout|.
+  doctor_->FastForwardBy(base::TimeDelta::FromSeconds(4));
+  EXPECT_TRUE(event_.IsSignaled());
+}
+
+TEST_F(ThreadHealthCheckerTest, PassiveModeFiresOnLaterIteration) {
+  auto heartbeat =
+      base::MakeRefCounted<ThreadHeartbeat>(doctor_->GetMockTickClock());
+  CREATE_PASSIVE_THREAD_HEALTH_CHECKER(thc, heartbeat);
+  // Fresh for the first check...
+  doctor_->FastForwardBy(base::TimeDelta::FromSeconds(2));
+  heartbeat->Beat();
+  doctor_->FastForwardBy(base::TimeDelta::FromSeconds(2));
+  EXPECT_FALSE(event_.IsSignaled());
+  // ...then the thread goes quiet and the second check fails.
+  doctor_->FastForwardBy(base::TimeDelta::FromSeconds(3));
+  EXPECT_TRUE(event_.IsSignaled());
+}
+
+TEST_F(ThreadHealthCheckerTest, HeartbeatRecordsThreadIdAndTaskLocation) {
+  auto heartbeat =
+      base::MakeRefCounted<ThreadHeartbeat>(doctor_->GetMockTickClock());
+  EXPECT_EQ(base::kInvalidThreadId, heartbeat->last_beat_thread_id());
+  EXPECT_EQ("", heartbeat->last_task_location());
+  heartbeat->BeatWithTaskLocation(FROM_HERE);
+  EXPECT_EQ(base::PlatformThread::CurrentId(),
+            heartbeat->last_beat_thread_id());
+  EXPECT_NE(std::string::npos, heartbeat->last_task_location().find(
+                                   "thread_health_checker_unittest.cc"));
+}
+
+TEST_F(ThreadHealthCheckerTest, PassiveModeBundlesDiagnosticsOnFailure) {
+  auto heartbeat =
+      base::MakeRefCounted<ThreadHeartbeat>(doctor_->GetMockTickClock());
+  std::vector<StallDiagnostics> bundles;
+  ThreadHealthChecker thc(
+      heartbeat, doctor_, kInterval, kTimeout,
+      base::BindRepeating(&base::WaitableEvent::Signal,
+                          base::Unretained(&event_)),
+      base::BindRepeating(&RecordDiagnostics, base::Unretained(&bundles)));
+  // The "patient" beats from this thread, then goes quiet.
+  heartbeat->BeatWithTaskLocation(FROM_HERE);
+  doctor_->FastForwardBy(base::TimeDelta::FromSeconds(4));
+  EXPECT_TRUE(event_.IsSignaled());
+  ASSERT_EQ(1u, bundles.size());
+  EXPECT_EQ(base::PlatformThread::CurrentId(), bundles[0].thread_id);
+  EXPECT_NE("", bundles[0].task_location);
+  // No dump directory was configured, so no trace snapshot.
+  EXPECT_EQ("", bundles[0].trace_dump_path);
+}
+
+TEST_F(ThreadHealthCheckerTest, RegistryBundlesDiagnosticsForFailedPatient) {
+  auto fresh =
+      base::MakeRefCounted<ThreadHeartbeat>(doctor_->GetMockTickClock());
+  auto stale =
+      base::MakeRefCounted<ThreadHeartbeat>(doctor_->GetMockTickClock());
+  std::vector<std::string> failed;
+  std::vector<std::string> diagnosed;
+  std::vector<StallDiagnostics> bundles;
+  ThreadHealthRegistry registry(
+      doctor_, kInterval, kTimeout,
+      base::BindRepeating(&RecordName, base::Unretained(&failed)),
+      doctor_->GetMockTickClock(),
+      base::BindRepeating(&RecordNamedDiagnostics, base::Unretained(&diagnosed),
+                          base::Unretained(&bundles)));
+  registry.Register("fresh", fresh);
+  registry.Register("stale", stale);
+  doctor_->FastForwardBy(base::TimeDelta::FromSeconds(2));
+  fresh->Beat();
+  stale->BeatWithTaskLocation(FROM_HERE);
+  // Both pass the first check...
+  doctor_->FastForwardBy(base::TimeDelta::FromSeconds(2));
+  EXPECT_TRUE(bundles.empty());
+  // ...then only |fresh| keeps beating; |stale| sticks in its last
+  // published task.
+  fresh->Beat();
+  doctor_->FastForwardBy(base::TimeDelta::FromSeconds(2));
+  ASSERT_EQ(1u, bundles.size());
+  EXPECT_EQ(failed, diagnosed);
+  EXPECT_EQ("stale", diagnosed[0]);
+  EXPECT_EQ(base::PlatformThread::CurrentId(), bundles[0].thread_id);
+  EXPECT_NE("", bundles[0].task_location);
+}
+
+TEST_F(ThreadHealthCheckerTest, RegistryChecksAllPatientsInOnePass) {
+  auto fresh =
+      base::MakeRefCounted<ThreadHeartbeat>(doctor_->GetMockTickClock());
+  auto stale =
+      base::MakeRefCounted<ThreadHeartbeat>(doctor_->GetMockTickClock());
+  std::vector<std::string> failed;
+  ThreadHealthRegistry registry(
+      doctor_, kInterval, kTimeout,
+      base::BindRepeating(&RecordName, base::Unretained(&failed)),
+      doctor_->GetMockTickClock());
+  registry.Register("fresh", fresh);
+  registry.Register("stale", stale);
+  doctor_->FastForwardBy(base::TimeDelta::FromSeconds(2));
+  fresh->Beat();
+  // The single pass at |kInterval| checks both patients.
+  doctor_->FastForwardBy(base::TimeDelta::FromSeconds(2));
+  std::vector<ThreadHealthRegistry::ThreadStatus> status =
+      registry.GetStatus();
+  ASSERT_EQ(2u, status.size());
+  EXPECT_EQ("fresh", status[0].name);
+  EXPECT_TRUE(status[0].healthy);
+  EXPECT_EQ(0u, status[0].stall_count);
+  EXPECT_EQ("stale", status[1].name);
+  EXPECT_FALSE(status[1].healthy);
+  EXPECT_EQ(1u, status[1].stall_count);
+  EXPECT_EQ(1u, registry.total_stalls());
+  ASSERT_EQ(1u, failed.size());
+  EXPECT_EQ("stale", failed[0]);
+}
+
+TEST_F(ThreadHealthCheckerTest, RegistrySentinelPatientBeatsThroughRunner) {
+  std::vector<std::string> failed;
+  ThreadHealthRegistry registry(
+      doctor_, kInterval, kTimeout,
+      base::BindRepeating(&RecordName, base::Unretained(&failed)),
+      doctor_->GetMockTickClock());
+  registry.Register("patient", patient_);
+  // The first pass finds the initial beat already |kInterval| old and
+  // posts the heartbeat task through the patient.
+  doctor_->FastForwardBy(base::TimeDelta::FromSeconds(4));
+  EXPECT_EQ(1u, registry.total_stalls());
+  // The patient runs its queue, so the following pass sees a fresh
+  // beat.
+  patient_->RunUntilIdle();
+  doctor_->FastForwardBy(base::TimeDelta::FromSeconds(2));
+  EXPECT_EQ(1u, registry.total_stalls());
+  EXPECT_TRUE(registry.GetStatus()[0].healthy);
+}
+
 TEST_F(ThreadHealthCheckerTest, DropPendingEventsAfterDestruction) {
   {
     CREATE_THREAD_HEALTH_CHECKER(thc);
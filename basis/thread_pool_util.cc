@@ -3,20 +3,380 @@
 #include <base/logging.h>
 #include <base/path_service.h>
 #include <base/files/file_util.h>
+#include <base/files/file_path.h>
+#include <base/strings/string_number_conversions.h>
+#include <base/strings/string_split.h>
+#include <base/strings/string_util.h>
+#include <base/bind.h>
+#include <base/memory/ref_counted.h>
+#include <base/synchronization/waitable_event.h>
+#include <base/task/post_task.h>
+#include <base/task/task_traits.h>
 #include <base/task/thread_pool/thread_pool.h>
 #include <base/task/thread_pool/thread_pool_impl.h>
+#include <base/task/thread_pool/worker_thread_observer.h>
+#include <base/threading/platform_thread.h>
 #include <base/system/sys_info.h>
+#include <build/build_config.h>
 
+#include <basis/startup_phases.hpp>
+
+#include <algorithm>
+#include <atomic>
 #include <memory>
+#include <utility>
+
+#if defined(OS_LINUX)
+#include <errno.h>
+#include <sched.h>
+#include <sys/resource.h>
+#endif // defined(OS_LINUX)
 
 namespace basis {
 
+namespace {
+
+// Parses a sysfs cpulist like "0-7,16-23" into individual CPU ids.
+std::vector<int> parseCpuList(const std::string& cpulist)
+{
+  std::vector<int> cpus;
+  for(const std::string& range
+      : base::SplitString(cpulist, ","
+          , base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY))
+  {
+    const size_t dash = range.find('-');
+    int first = 0;
+    int last = 0;
+    if(dash == std::string::npos)
+    {
+      if(!base::StringToInt(range, &first))
+      {
+        continue;
+      }
+      last = first;
+    }
+    else if(!base::StringToInt(range.substr(0, dash), &first)
+            || !base::StringToInt(range.substr(dash + 1), &last))
+    {
+      continue;
+    }
+    for(int cpu = first; cpu <= last; ++cpu)
+    {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+// CPUs of one NUMA node, from
+// /sys/devices/system/node/node<N>/cpulist; empty on failure (or on
+// platforms without that sysfs layout).
+std::vector<int> cpusOfNumaNode(const int node)
+{
+  std::string cpulist;
+  const base::FilePath path(
+    "/sys/devices/system/node/node"
+    + base::NumberToString(node) + "/cpulist");
+  if(!base::ReadFileToString(path, &cpulist))
+  {
+    LOG(WARNING)
+      << "unable to read NUMA node cpu list from "
+      << path.value();
+    return {};
+  }
+  return parseCpuList(
+    std::string(base::TrimWhitespaceASCII(cpulist, base::TRIM_ALL)));
+}
+
+// Resolved placement for one pool: explicit list wins over NUMA node.
+std::vector<int> resolvePoolCpus(
+  const std::vector<int>& explicit_cpus, const int numa_node)
+{
+  if(!explicit_cpus.empty())
+  {
+    return explicit_cpus;
+  }
+  if(numa_node >= 0)
+  {
+    return cpusOfNumaNode(numa_node);
+  }
+  return {};
+}
+
+#if defined(OS_LINUX)
+
+void applyCpuSet(const std::vector<int>& cpus)
+{
+  if(cpus.empty())
+  {
+    return;
+  }
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for(const int cpu : cpus)
+  {
+    CPU_SET(cpu, &cpu_set);
+  }
+  if(sched_setaffinity(0 /* current thread */, sizeof(cpu_set), &cpu_set))
+  {
+    PLOG(WARNING) << "sched_setaffinity failed";
+  }
+}
+
+// Pins each worker to its pool's CPU set and applies the pool's OS
+// scheduling as it starts. The observer runs on the worker itself,
+// after the pool assigned the thread its priority, so BACKGROUND
+// priority identifies background-pool workers.
+class WorkerStartThreadObserver
+  : public base::WorkerThreadObserver
+{
+ public:
+  WorkerStartThreadObserver(
+    std::vector<int> foreground_cpus
+    , std::vector<int> background_cpus
+    , const ThreadPoolSchedulingConfig& scheduling)
+    : foreground_cpus_(std::move(foreground_cpus))
+      , background_cpus_(std::move(background_cpus))
+      , scheduling_(scheduling)
+  {}
+
+  void OnWorkerThreadMainEntry() override
+  {
+    const bool is_background
+      = base::PlatformThread::GetCurrentThreadPriority()
+        == base::ThreadPriority::BACKGROUND;
+    applyCpuSet(is_background ? background_cpus_ : foreground_cpus_);
+    applyCurrentThreadScheduling(
+      is_background ? scheduling_.background : scheduling_.foreground);
+  }
+
+  void OnWorkerThreadMainExit() override {}
+
+ private:
+  const std::vector<int> foreground_cpus_;
+  const std::vector<int> background_cpus_;
+  const ThreadPoolSchedulingConfig scheduling_;
+};
+
+#endif // defined(OS_LINUX)
+
+// Must outlive the pool, so the observer is intentionally leaked (the
+// pool itself lives for the whole process).
+base::WorkerThreadObserver* makeWorkerStartObserver(
+  const ThreadPoolAffinityConfig& affinity
+  , const ThreadPoolSchedulingConfig& scheduling)
+{
+  if(!affinity.requiresPinning() && !scheduling.requiresSetup())
+  {
+    return nullptr;
+  }
+
+  std::vector<int> foreground_cpus
+    = resolvePoolCpus(
+        affinity.foreground_cpus, affinity.foreground_numa_node);
+  std::vector<int> background_cpus
+    = resolvePoolCpus(
+        affinity.background_cpus, affinity.background_numa_node);
+
+  if(affinity.isolate_foreground
+     && background_cpus.empty()
+     && !foreground_cpus.empty())
+  {
+    // Background gets every CPU the foreground pool does not use.
+    const int num_cores = base::SysInfo::NumberOfProcessors();
+    for(int cpu = 0; cpu < num_cores; ++cpu)
+    {
+      if(std::find(foreground_cpus.begin(), foreground_cpus.end(), cpu)
+         == foreground_cpus.end())
+      {
+        background_cpus.push_back(cpu);
+      }
+    }
+    if(background_cpus.empty())
+    {
+      LOG(WARNING)
+        << "isolate_foreground left no CPUs for the background pool;"
+        << " background workers stay unpinned";
+    }
+  }
+
+#if defined(OS_LINUX)
+  return new WorkerStartThreadObserver(
+    std::move(foreground_cpus), std::move(background_cpus), scheduling);
+#else
+  LOG(WARNING)
+    << "thread pool CPU affinity and scheduling are only implemented"
+    << " on Linux; pinning/scheduling config ignored";
+  return nullptr;
+#endif // defined(OS_LINUX)
+}
+
+// Shared between the prewarm tasks and the waiting caller; refcounted
+// because the release happens after the caller may have returned from
+// Wait() but before every task finished running.
+struct PrewarmState
+  : public base::RefCountedThreadSafe<PrewarmState>
+{
+  explicit PrewarmState(const int total)
+    : remaining(total)
+      , all_started(
+          base::WaitableEvent::ResetPolicy::MANUAL
+          , base::WaitableEvent::InitialState::NOT_SIGNALED)
+      , release(
+          base::WaitableEvent::ResetPolicy::MANUAL
+          , base::WaitableEvent::InitialState::NOT_SIGNALED)
+  {}
+
+  std::atomic<int> remaining;
+  base::WaitableEvent all_started;
+  base::WaitableEvent release;
+
+ private:
+  friend class base::RefCountedThreadSafe<PrewarmState>;
+  ~PrewarmState() = default;
+};
+
+void prewarmWorkerMain(scoped_refptr<PrewarmState> state)
+{
+  // Touch a chunk of the stack so its pages (and the thread's TLS,
+  // faulted by reaching here) are resident before real work arrives.
+  volatile char stack_probe[16 * 1024];
+  stack_probe[0] = 0;
+  stack_probe[sizeof(stack_probe) - 1] = 0;
+
+  // Block this worker until every pool sibling started, forcing the
+  // pool to create one worker per posted task instead of reusing one.
+  if(state->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+  {
+    state->all_started.Signal();
+  }
+  state->release.Wait();
+}
+
+}  // namespace
+
+bool ThreadPoolAffinityConfig::requiresPinning() const
+{
+  return !foreground_cpus.empty()
+    || !background_cpus.empty()
+    || foreground_numa_node >= 0
+    || background_numa_node >= 0;
+}
+
+bool ThreadSchedulingConfig::requiresSetup() const
+{
+  return policy != Policy::kInherit;
+}
+
+bool ThreadPoolSchedulingConfig::requiresSetup() const
+{
+  return foreground.requiresSetup() || background.requiresSetup();
+}
+
+bool applyCurrentThreadScheduling(const ThreadSchedulingConfig& config)
+{
+  if(!config.requiresSetup())
+  {
+    return true;
+  }
+
+#if defined(OS_LINUX)
+  if(config.policy == ThreadSchedulingConfig::Policy::kNice)
+  {
+    // id 0 with PRIO_PROCESS names the calling thread on Linux.
+    if(setpriority(PRIO_PROCESS, 0, config.nice_value))
+    {
+      PLOG(WARNING)
+        << "setpriority(" << config.nice_value << ") failed"
+        << " (negative nice needs CAP_SYS_NICE or RLIMIT_NICE)";
+      return false;
+    }
+    return true;
+  }
+
+  const int policy
+    = config.policy == ThreadSchedulingConfig::Policy::kFifo
+      ? SCHED_FIFO : SCHED_RR;
+
+  sched_param param;
+  param.sched_priority
+    = std::min(
+        std::max(config.realtime_priority, sched_get_priority_min(policy))
+        , sched_get_priority_max(policy));
+
+  if(sched_setscheduler(0 /* current thread */, policy, &param) == 0)
+  {
+    return true;
+  }
+
+  /// \note graceful fallback: an unprivileged process can not get a
+  /// real-time policy (EPERM); degrade to the requested nice value so
+  /// the thread still outranks background work instead of failing hard
+  PLOG(WARNING)
+    << "sched_setscheduler("
+    << (policy == SCHED_FIFO ? "SCHED_FIFO" : "SCHED_RR")
+    << ", " << param.sched_priority << ") failed;"
+    << " falling back to nice " << config.nice_value;
+  if(config.nice_value != 0
+     && setpriority(PRIO_PROCESS, 0, config.nice_value))
+  {
+    PLOG(WARNING)
+      << "fallback setpriority(" << config.nice_value << ") failed too;"
+      << " thread keeps inherited scheduling";
+  }
+  return false;
+#else
+  LOG(WARNING)
+    << "thread scheduling is only implemented on Linux;"
+    << " scheduling config ignored";
+  return false;
+#endif // defined(OS_LINUX)
+}
+
+void initThreadPool(
+  const int backgroundMaxThreads
+  , const int foregroundMaxThreads
+  // when to reclaim idle threads
+  , base::TimeDelta kSuggestedReclaimTime
+){
+  initThreadPool(
+    backgroundMaxThreads
+    , foregroundMaxThreads
+    , kSuggestedReclaimTime
+    , ThreadPoolAffinityConfig{});
+}
+
 void initThreadPool(
   const int backgroundMaxThreads
   , const int foregroundMaxThreads
   // when to reclaim idle threads
   , base::TimeDelta kSuggestedReclaimTime
+  , const ThreadPoolAffinityConfig& affinity
+  , const bool prewarmWorkers
+  , base::OnceClosure onWorkersReady
 ){
+  initThreadPool(
+    backgroundMaxThreads
+    , foregroundMaxThreads
+    , kSuggestedReclaimTime
+    , affinity
+    , ThreadPoolSchedulingConfig{}
+    , prewarmWorkers
+    , std::move(onWorkersReady));
+}
+
+void initThreadPool(
+  const int backgroundMaxThreads
+  , const int foregroundMaxThreads
+  // when to reclaim idle threads
+  , base::TimeDelta kSuggestedReclaimTime
+  , const ThreadPoolAffinityConfig& affinity
+  , const ThreadPoolSchedulingConfig& scheduling
+  , const bool prewarmWorkers
+  , base::OnceClosure onWorkersReady
+){
+  ScopedStartupPhase startup_phase("initThreadPool");
+
   DCHECK(!base::ThreadPool::GetInstance());
 
   DCHECK(backgroundMaxThreads >= 1);
@@ -60,7 +420,50 @@ void initThreadPool(
       {backgroundMaxThreads, kSuggestedReclaimTime}
       , {foregroundMaxThreads, kSuggestedReclaimTime}
     }
-    , /*worker_thread_observer_*/nullptr);
+    , makeWorkerStartObserver(affinity, scheduling));
+
+  if(prewarmWorkers)
+  {
+    prewarmThreadPool(backgroundMaxThreads, foregroundMaxThreads);
+  }
+  if(onWorkersReady)
+  {
+    std::move(onWorkersReady).Run();
+  }
+}
+
+void prewarmThreadPool(
+  const int backgroundMaxThreads
+  , const int foregroundMaxThreads
+){
+  DCHECK(base::ThreadPool::GetInstance());
+  DCHECK(backgroundMaxThreads >= 1);
+  DCHECK(foregroundMaxThreads >= 1);
+
+  scoped_refptr<PrewarmState> state
+    = base::MakeRefCounted<PrewarmState>(
+        backgroundMaxThreads + foregroundMaxThreads);
+
+  /// \note WithBaseSyncPrimitives: the tasks block on a WaitableEvent
+  /// by design (that is what holds each worker busy until its siblings
+  /// were created)
+  for(int i = 0; i < foregroundMaxThreads; ++i)
+  {
+    base::PostTask(
+      FROM_HERE
+      , {base::TaskPriority::USER_BLOCKING, base::WithBaseSyncPrimitives()}
+      , base::BindOnce(&prewarmWorkerMain, state));
+  }
+  for(int i = 0; i < backgroundMaxThreads; ++i)
+  {
+    base::PostTask(
+      FROM_HERE
+      , {base::TaskPriority::BEST_EFFORT, base::WithBaseSyncPrimitives()}
+      , base::BindOnce(&prewarmWorkerMain, state));
+  }
+
+  state->all_started.Wait();
+  state->release.Signal();
 }
 
 }  // namespace basis
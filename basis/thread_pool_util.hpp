@@ -1,11 +1,94 @@
 #pragma once
 
+#include <base/callback.h>
 #include <base/time/time.h>
 
 #include <string>
+#include <vector>
 
 namespace basis {
 
+// CPU placement for the two worker pools. Defaults keep today's
+// behavior (workers float across every core, at the mercy of the OS
+// scheduler). On multi-socket boxes foreground workers migrating
+// across NUMA nodes pay remote-memory traffic; pinning the foreground
+// pool to one node's cores (and keeping background compaction off
+// them) removes that.
+//
+// Resolution order per pool: an explicit |*_cpus| list wins; otherwise
+// a |*_numa_node| >= 0 expands to that node's CPU list (from sysfs);
+// otherwise the pool is not pinned. With |isolate_foreground| set and
+// no explicit background placement, the background pool is pinned to
+// the complement of the foreground CPUs, so latency-critical workers
+// stop sharing caches with background work.
+//
+// Affinity is applied on worker-thread start; only implemented on
+// Linux (sched_setaffinity), a no-op with a warning elsewhere.
+struct ThreadPoolAffinityConfig {
+  std::vector<int> foreground_cpus;
+  std::vector<int> background_cpus;
+
+  // -1 = any node.
+  int foreground_numa_node = -1;
+  int background_numa_node = -1;
+
+  bool isolate_foreground = false;
+
+  // True when any pinning was requested.
+  bool requiresPinning() const;
+};
+
+// OS scheduling for one thread. Defaults keep today's behavior (the
+// priority the thread was created with). Under load, background work
+// preempts latency-critical threads for whole timeslices; raising the
+// tick/audio thread above it (or making it real-time) caps those
+// stalls.
+//
+// kNice adjusts the timesharing priority (negative values need
+// CAP_SYS_NICE or a matching RLIMIT_NICE). kFifo/kRoundRobin request a
+// real-time policy with |realtime_priority| (1..99); that needs
+// privileges, and on failure the thread falls back to the most
+// favorable nice value it is allowed, with a warning — it never fails
+// hard.
+//
+// Only implemented on Linux (setpriority/sched_setscheduler), a no-op
+// with a warning elsewhere.
+struct ThreadSchedulingConfig {
+  enum class Policy {
+    kInherit,
+    kNice,
+    kFifo,
+    kRoundRobin,
+  };
+
+  Policy policy = Policy::kInherit;
+
+  // For kNice; also the fallback when a real-time request is denied.
+  int nice_value = 0;
+
+  // For kFifo/kRoundRobin; clamped to the platform's valid range.
+  int realtime_priority = 1;
+
+  // True when any change from the inherited scheduling was requested.
+  bool requiresSetup() const;
+};
+
+// Scheduling for the two worker pools, applied on worker-thread start
+// (same mechanism as ThreadPoolAffinityConfig).
+struct ThreadPoolSchedulingConfig {
+  ThreadSchedulingConfig foreground;
+  ThreadSchedulingConfig background;
+
+  bool requiresSetup() const;
+};
+
+// Applies |config| to the calling thread; see ThreadSchedulingConfig
+// for the fallback behavior. Returns false when the requested policy
+// could not be applied (a fallback may still have taken effect).
+// Intended to run first on a freshly started thread, before it takes
+// real work.
+bool applyCurrentThreadScheduling(const ThreadSchedulingConfig& config);
+
 void initThreadPool(
   const int backgroundMaxThreads
   , const int foregroundMaxThreads
@@ -14,4 +97,46 @@ void initThreadPool(
       = base::TimeDelta::FromSeconds(30)
 );
 
+void initThreadPool(
+  const int backgroundMaxThreads
+  , const int foregroundMaxThreads
+  // when to reclaim idle threads
+  , base::TimeDelta kSuggestedReclaimTime
+  , const ThreadPoolAffinityConfig& affinity
+  // spin up all configured workers before returning (see
+  // prewarmThreadPool below); |onWorkersReady| runs right after, on
+  // the calling thread
+  , const bool prewarmWorkers = false
+  , base::OnceClosure onWorkersReady = base::OnceClosure()
+);
+
+void initThreadPool(
+  const int backgroundMaxThreads
+  , const int foregroundMaxThreads
+  // when to reclaim idle threads
+  , base::TimeDelta kSuggestedReclaimTime
+  , const ThreadPoolAffinityConfig& affinity
+  // per-pool OS scheduling, applied on worker-thread start
+  , const ThreadPoolSchedulingConfig& scheduling
+  , const bool prewarmWorkers = false
+  , base::OnceClosure onWorkersReady = base::OnceClosure()
+);
+
+// Workers are otherwise created lazily, so the first burst of tasks
+// after process start pays thread-creation latency (thread spawn,
+// stack and TLS page faults) exactly when the service is being
+// health-checked. Prewarming posts one briefly-blocking task per
+// configured worker to each pool, waits until every one of them is
+// running on its own freshly created worker (which faults in the
+// stack), then releases them — after this, first-request latency
+// matches steady state.
+//
+// Blocks the calling thread until all workers started; pass the same
+// thread counts the pool was initialized with. Must not be called from
+// a thread pool worker.
+void prewarmThreadPool(
+  const int backgroundMaxThreads
+  , const int foregroundMaxThreads
+);
+
 }  // namespace basis
@@ -6,9 +6,52 @@ FixedTimeStep::FixedTimeStep(const std::chrono::nanoseconds& tickrate) noexcept
   : fps_{tickrate}
   , fixed_delta_time_{std::chrono::duration<float, std::ratio<1>>(tickrate).count()}
   , fixed_tickrate_{tickrate}
+  , stretched_tick_{tickrate}
 {
   DCHECK(tickrate != std::chrono::nanoseconds::min());
   DCHECK(tickrate != std::chrono::nanoseconds::max());
 }
 
+void FixedTimeStep::apply_catchup_policy() noexcept
+{
+  if(lag_ > max_lag_)
+  {
+    const std::chrono::nanoseconds shed = lag_ - max_lag_;
+    lag_ = max_lag_;
+    if(lag_shed_callback_)
+    {
+      /// \note the callback is documented not to throw; a throwing
+      /// callback terminates (this function is noexcept) rather than
+      /// leaving the accumulator in a half-updated state
+      lag_shed_callback_(shed);
+    }
+  }
+
+  /// \note stretch relaxes back to 1 as soon as the backlog fits into
+  /// the per-frame update budget again
+  dt_stretch_ = 1.0f;
+  stretched_tick_ = fps_;
+  if(max_dt_stretch_ > 1.0f && max_catchup_updates_ > 0)
+  {
+    const uint64_t pending_updates
+      = static_cast<uint64_t>(lag_.count())
+        / static_cast<uint64_t>(fps_.count());
+    if(pending_updates > max_catchup_updates_)
+    {
+      /// \note stretch chosen so the whole backlog is consumed within
+      /// |max_catchup_updates_| updates this frame, clamped to the
+      /// configured bound; beyond the bound the remaining lag waits
+      /// (and eventually hits |max_lag_| shedding)
+      const delta_time_t wanted
+        = static_cast<delta_time_t>(lag_.count())
+          / (static_cast<delta_time_t>(fps_.count())
+             * static_cast<delta_time_t>(max_catchup_updates_));
+      dt_stretch_ = (wanted < max_dt_stretch_) ? wanted : max_dt_stretch_;
+      stretched_tick_ = std::chrono::nanoseconds{
+        static_cast<int64_t>(
+          static_cast<delta_time_t>(fps_.count()) * dt_stretch_)};
+    }
+  }
+}
+
 } // namespace basis
@@ -1,7 +1,10 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
+#include <functional>
 #include <base/logging.h> // for DCHECK
+#include <basis/fast_clock.hpp>
 
 namespace basis {
 
@@ -24,11 +27,34 @@ namespace basis {
   /// sleep() is nice because it saves CPU,
   /// but sleep will only have a precision of 14-15 ms on most systems,
   /// even if you only sleep for 0 or 1 ms.
+  ///
+  /// \note catch-up under sustained overload is the classic
+  /// spiral-of-death: a slow frame accumulates lag, the next frame
+  /// schedules extra updates to catch up, takes even longer, and the
+  /// accumulator only ever grows. Three (independently optional)
+  /// controls bound it:
+  /// - |set_max_catchup_updates|: hard cap on updates per frame,
+  ///   overload degrades tick rate instead of frame time
+  /// - |set_max_lag|: accumulated time beyond the bound is dropped
+  ///   (the simulation jumps) and the shed callback is notified
+  /// - |set_max_dt_stretch|: when the pending updates exceed the
+  ///   per-frame cap, each update covers a proportionally longer
+  ///   timestep (up to the given factor) so real time is not lost
   class FixedTimeStep
   {
   public:
     using delta_time_t = float;
-    using clock = std::chrono::steady_clock;
+
+    /// \note invoked synchronously from |increase_lag| (the loop
+    /// thread) each time accumulated lag beyond |set_max_lag| is
+    /// discarded; the argument is the simulated time dropped.
+    /// The callback must not throw and should be cheap (log/metric).
+    using LagShedCallback
+      = std::function<void(const std::chrono::nanoseconds& shed)>;
+    /// \note FastClock: the loop reads the clock several times per
+    /// tick, so the ~20 ns vDSO call is replaced by a ~5 ns TSC read
+    /// (with automatic steady_clock fallback, see fast_clock.hpp)
+    using clock = basis::FastClock;
 
   public:
     FixedTimeStep(const std::chrono::nanoseconds& tickrate = k60fps) noexcept;
@@ -38,6 +64,7 @@ namespace basis {
     inline /* `inline` to eleminate function call overhead */
     void update_clock(const clock::time_point& tp) noexcept {
       start_ = tp;
+      updates_this_frame_ = 0;
     }
 
     /// \note large `inline` functions cause Cache misses
@@ -46,6 +73,7 @@ namespace basis {
     void increase_lag(
       const std::chrono::nanoseconds& deltaTime) noexcept {
       lag_ += deltaTime;
+      apply_catchup_policy();
     }
 
     /// \note large `inline` functions cause Cache misses
@@ -65,14 +93,17 @@ namespace basis {
     [[nodiscard]] /* don't ignore return value */
     inline /* `inline` to eleminate function call overhead */
     bool is_update_required() const noexcept {
-      return (lag_ >= fps_);
+      return (lag_ >= stretched_tick_)
+        && (max_catchup_updates_ == 0
+            || updates_this_frame_ < max_catchup_updates_);
     }
 
     /// \note large `inline` functions cause Cache misses
     /// and affect efficiency negatively, so keep it small
     inline /* `inline` to eleminate function call overhead */
     void update_lag() noexcept {
-      lag_ -= fps_;
+      lag_ -= stretched_tick_;
+      ++updates_this_frame_;
     }
 
     /// \note large `inline` functions cause Cache misses
@@ -99,8 +130,83 @@ namespace basis {
       return fixed_tickrate_;
     }
 
+    /// \note 0 (the default) = unlimited catch-up updates per frame
+    /// (the original behavior); a typical server value is 3-5
+    /// \note large `inline` functions cause Cache misses
+    /// and affect efficiency negatively, so keep it small
+    inline /* `inline` to eleminate function call overhead */
+    void set_max_catchup_updates(const uint32_t max_updates) noexcept {
+      max_catchup_updates_ = max_updates;
+    }
+
+    /// \note accumulated lag beyond |max_lag| is dropped by
+    /// |increase_lag| and reported via |set_lag_shed_callback|;
+    /// nanoseconds::max() (the default) disables shedding
+    /// \note large `inline` functions cause Cache misses
+    /// and affect efficiency negatively, so keep it small
+    inline /* `inline` to eleminate function call overhead */
+    void set_max_lag(const std::chrono::nanoseconds& max_lag) noexcept {
+      DCHECK(max_lag > std::chrono::nanoseconds{0});
+      max_lag_ = max_lag;
+    }
+
+    /// \note pass an empty callback to drop lag silently
+    inline /* `inline` to eleminate function call overhead */
+    void set_lag_shed_callback(LagShedCallback callback) {
+      lag_shed_callback_ = std::move(callback);
+    }
+
+    /// \note upper bound on the dynamic timestep stretch applied when
+    /// pending updates exceed |set_max_catchup_updates| (each update
+    /// then simulates a longer dt instead of real time being lost);
+    /// 1.0 (the default) disables stretching; requires the update
+    /// code to honor |stretched_dt| instead of assuming |fixed_dt|
+    /// \note large `inline` functions cause Cache misses
+    /// and affect efficiency negatively, so keep it small
+    inline /* `inline` to eleminate function call overhead */
+    void set_max_dt_stretch(const delta_time_t max_stretch) noexcept {
+      DCHECK(max_stretch >= 1.0f);
+      max_dt_stretch_ = max_stretch;
+    }
+
+    /// \note current stretch factor in [1, max_dt_stretch];
+    /// recomputed once per frame by |increase_lag|
+    /// \note large `inline` functions cause Cache misses
+    /// and affect efficiency negatively, so keep it small
+    [[nodiscard]] /* don't ignore return value */
+    inline /* `inline` to eleminate function call overhead */
+    delta_time_t dt_stretch() const noexcept {
+      return dt_stretch_;
+    }
+
+    /// \note |fixed_dt| scaled by the current stretch factor - the
+    /// delta the update should integrate this frame
+    /// \note large `inline` functions cause Cache misses
+    /// and affect efficiency negatively, so keep it small
+    [[nodiscard]] /* don't ignore return value */
+    inline /* `inline` to eleminate function call overhead */
+    delta_time_t stretched_dt() const noexcept {
+      return fixed_delta_time_ * dt_stretch_;
+    }
+
+    /// \note |fixed_tickrate| scaled by the current stretch factor;
+    /// equals |fixed_tickrate| while stretching is off or idle
+    /// \note large `inline` functions cause Cache misses
+    /// and affect efficiency negatively, so keep it small
+    [[nodiscard]] /* don't ignore return value */
+    inline /* `inline` to eleminate function call overhead */
+    std::chrono::nanoseconds stretched_tickrate() const noexcept {
+      return stretched_tick_;
+    }
+
   private:
-    /// \note lag measures how far the game�s clock
+    /// \note sheds lag beyond |max_lag_| (notifying the callback) and
+    /// recomputes the per-frame stretch factor; out-of-line because
+    /// the common case (no overload) returns after two compares
+    void apply_catchup_policy() noexcept;
+
+  private:
+    /// \note lag measures how far the game�s clock
     /// is behind compared to the real world
     std::chrono::nanoseconds lag_{0};
 
@@ -114,6 +220,155 @@ namespace basis {
     const std::chrono::nanoseconds fixed_tickrate_;
 
     clock::time_point start_{std::chrono::time_point<clock>::max()};
+
+    /// \note 0 = unlimited (see |set_max_catchup_updates|)
+    uint32_t max_catchup_updates_{0};
+
+    /// \note reset by |update_clock|, counted by |update_lag|
+    uint32_t updates_this_frame_{0};
+
+    std::chrono::nanoseconds max_lag_{std::chrono::nanoseconds::max()};
+
+    LagShedCallback lag_shed_callback_;
+
+    delta_time_t max_dt_stretch_{1.0f};
+
+    delta_time_t dt_stretch_{1.0f};
+
+    /// \note |fps_| scaled by |dt_stretch_|, cached so the hot
+    /// |is_update_required|/|update_lag| pair stays integer-only
+    std::chrono::nanoseconds stretched_tick_;
+  };
+
+  /// \note compile-time variant of |FixedTimeStep| for tick rates
+  /// fixed at build time: the timestep is the template parameter
+  /// (a std::ratio measured in seconds, e.g. std::ratio<1, 60>
+  /// for 60 ticks per second), so the accumulate/consume loop and
+  /// the interpolation-alpha computation fold into multiplies by
+  /// constants instead of runtime divisions.
+  /// Keep using |FixedTimeStep| when the rate is chosen at runtime
+  /// or when the adaptive catch-up controls (update cap, lag
+  /// shedding, dt stretch) are needed - this variant stays
+  /// policy-free so the hot path folds to compile-time constants.
+  ///
+  /// Usage:
+  ///   basis::FixedTimeStepT<std::ratio<1, 60>> timestep;
+  template<typename Period>
+  class FixedTimeStepT
+  {
+  public:
+    using delta_time_t = FixedTimeStep::delta_time_t;
+    using clock = FixedTimeStep::clock;
+
+    /// \note one tick measured in |Period| seconds
+    static constexpr std::chrono::duration<int64_t, Period>
+      kTick{1};
+
+    static constexpr std::chrono::nanoseconds kTickrate{
+      std::chrono::duration_cast<std::chrono::nanoseconds>(kTick)};
+
+    static constexpr delta_time_t kFixedDeltaTime{
+      static_cast<delta_time_t>(Period::num)
+        / static_cast<delta_time_t>(Period::den)};
+
+    /// \note reciprocal kept as a constant so that
+    /// |interpolation_alpha| is a multiply, not a divide
+    static constexpr delta_time_t kInvFixedDeltaTime{
+      static_cast<delta_time_t>(Period::den)
+        / static_cast<delta_time_t>(Period::num)};
+
+    static_assert(Period::num > 0
+      , "tick duration must be positive");
+
+  public:
+    FixedTimeStepT() noexcept = default;
+
+    /// \note large `inline` functions cause Cache misses
+    /// and affect efficiency negatively, so keep it small
+    inline /* `inline` to eleminate function call overhead */
+    void update_clock(const clock::time_point& tp) noexcept {
+      start_ = tp;
+    }
+
+    /// \note large `inline` functions cause Cache misses
+    /// and affect efficiency negatively, so keep it small
+    inline /* `inline` to eleminate function call overhead */
+    void increase_lag(
+      const std::chrono::nanoseconds& deltaTime) noexcept {
+      lag_ += deltaTime;
+    }
+
+    /// \note large `inline` functions cause Cache misses
+    /// and affect efficiency negatively, so keep it small
+    [[nodiscard]] /* don't ignore return value */
+    inline /* `inline` to eleminate function call overhead */
+    std::chrono::nanoseconds elapsed_dt_since(
+      const clock::time_point& tp) const noexcept {
+      DCHECK(start_ != std::chrono::time_point<clock>::max());
+      return
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+          tp - start_);
+    }
+
+    /// \note large `inline` functions cause Cache misses
+    /// and affect efficiency negatively, so keep it small
+    [[nodiscard]] /* don't ignore return value */
+    inline /* `inline` to eleminate function call overhead */
+    bool is_update_required() const noexcept {
+      return (lag_ >= kTickrate);
+    }
+
+    /// \note large `inline` functions cause Cache misses
+    /// and affect efficiency negatively, so keep it small
+    inline /* `inline` to eleminate function call overhead */
+    void update_lag() noexcept {
+      lag_ -= kTickrate;
+    }
+
+    /// \note large `inline` functions cause Cache misses
+    /// and affect efficiency negatively, so keep it small
+    [[nodiscard]] /* don't ignore return value */
+    inline /* `inline` to eleminate function call overhead */
+    constexpr delta_time_t fixed_dt() const noexcept {
+      return kFixedDeltaTime;
+    }
+
+    /// \note fraction of a tick accumulated in |lag|,
+    /// intended for render-state interpolation;
+    /// the division by dt folds into a multiply by
+    /// |kInvFixedDeltaTime|
+    /// \note large `inline` functions cause Cache misses
+    /// and affect efficiency negatively, so keep it small
+    [[nodiscard]] /* don't ignore return value */
+    inline /* `inline` to eleminate function call overhead */
+    delta_time_t interpolation_alpha() const noexcept {
+      return
+        std::chrono::duration<delta_time_t, std::ratio<1>>(lag_)
+          .count() * kInvFixedDeltaTime;
+    }
+
+    /// \note large `inline` functions cause Cache misses
+    /// and affect efficiency negatively, so keep it small
+    [[nodiscard]] /* don't ignore return value */
+    inline /* `inline` to eleminate function call overhead */
+    std::chrono::nanoseconds lag() const noexcept {
+      return lag_;
+    }
+
+    /// \note large `inline` functions cause Cache misses
+    /// and affect efficiency negatively, so keep it small
+    [[nodiscard]] /* don't ignore return value */
+    inline /* `inline` to eleminate function call overhead */
+    constexpr std::chrono::nanoseconds fixed_tickrate() const noexcept {
+      return kTickrate;
+    }
+
+  private:
+    /// \note lag measures how far the game�s clock
+    /// is behind compared to the real world
+    std::chrono::nanoseconds lag_{0};
+
+    clock::time_point start_{std::chrono::time_point<clock>::max()};
   };
 
 } // namespace basis
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "basis/time_step/FixedTimeStep.hpp"
+#include "basis/time_step/FramePacer.hpp"
+#include "basis/time_step/TickLoopStats.hpp"
 #include <chrono>
 #include <functional>
 #include <base/logging.h> // for DCHECK
@@ -101,7 +103,7 @@ public:
     = std::function<void(const std::chrono::nanoseconds&
                          , const std::chrono::nanoseconds&
                          , const std::chrono::nanoseconds&
-                         , const std::chrono::steady_clock::time_point&)>;*/
+                         , const basis::FixedTimeStep::clock::time_point&)>;*/
 
 public:
   FixedTimeStepLoop(
@@ -126,8 +128,8 @@ public:
   /// and affect efficiency negatively, so keep it small
   inline /* `inline` to eleminate function call overhead */
   void run_once() noexcept {
-    const std::chrono::steady_clock::time_point frame_start_timestamp
-      = std::chrono::steady_clock::now();
+    const basis::FixedTimeStep::clock::time_point frame_start_timestamp
+      = basis::FixedTimeStep::clock::now();
 
     /// \note amount of real time has elapsed since
     /// the last turn of the game loop.
@@ -143,7 +145,7 @@ public:
     //if(spareCycleBeforeUpdateCallback)
     {
 #if !defined(NDEBUG)
-      const auto sc_start = std::chrono::steady_clock::now();
+      const auto sc_start = basis::FixedTimeStep::clock::now();
 #endif // NDEBUG
 
       spareCycleBeforeUpdateCallback<UpdateCallbacksType>(
@@ -159,7 +161,7 @@ public:
 
 #if !defined(NDEBUG)
       const auto sc_elapsed = std::chrono::duration_cast<std::chrono::seconds>(
-            sc_start - std::chrono::steady_clock::now());
+            sc_start - basis::FixedTimeStep::clock::now());
 
       /// \note Make sure that code does not take too much time
       DCHECK(sc_elapsed < std::chrono::seconds{1});
@@ -171,22 +173,32 @@ public:
       //if(updateCallback)
       {
 #if !defined(NDEBUG)
-        const auto updateStart = std::chrono::steady_clock::now();
+        const auto updateStart = basis::FixedTimeStep::clock::now();
 #endif // NDEBUG
 
+        /// \note stats recording is two relaxed atomic increments per
+        /// sample (see TickLoopStats), cheap enough to stay on in
+        /// production; the clock reads only happen when attached
+        const basis::FixedTimeStep::clock::time_point stats_update_start
+          = stats_ ? basis::FixedTimeStep::clock::now()
+                   : basis::FixedTimeStep::clock::time_point{};
+
         //updateCallback(
         //  deltaTime
         //  , time_step_.fixed_tickrate());
 
         /// \note may be inlined
+        /// \note |stretched_tickrate| equals |fixed_tickrate| unless
+        /// the adaptive catch-up policy is stretching the timestep
+        /// under overload (see FixedTimeStep::set_max_dt_stretch)
         updateCallback<UpdateCallbacksType>(
           data_raw_
           , deltaTime
-          , time_step_.fixed_tickrate());
+          , time_step_.stretched_tickrate());
 
 #if !defined(NDEBUG)
         const auto updateElapsed = std::chrono::duration_cast<std::chrono::seconds>(
-              updateStart - std::chrono::steady_clock::now());
+              updateStart - basis::FixedTimeStep::clock::now());
 
         /// \note Make sure that code does not take too much time
         DCHECK(updateElapsed < std::chrono::seconds{1});
@@ -197,11 +209,37 @@ public:
         /// Otherwise, your game simply can�t catch up.
         DCHECK(time_step_.fixed_tickrate() > updateElapsed);
 #endif // NDEBUG
+
+        if(stats_)
+        {
+          stats_->record_update_duration(
+            basis::FixedTimeStep::clock::now() - stats_update_start);
+        }
       }
 
       time_step_.update_lag();
     }
 
+    if(stats_)
+    {
+      /// \note busy time of this frame vs. one fixed tick: the
+      /// difference is the spare-cycle budget; a frame that exceeded
+      /// its tick is an overrun (the loop fell behind and the next
+      /// frame has to catch up)
+      const std::chrono::nanoseconds frame_busy
+        = basis::FixedTimeStep::clock::now() - frame_start_timestamp;
+      if(frame_busy > time_step_.fixed_tickrate())
+      {
+        stats_->record_overrun();
+        stats_->record_spare_cycle(std::chrono::nanoseconds{0});
+      }
+      else
+      {
+        stats_->record_spare_cycle(
+          time_step_.fixed_tickrate() - frame_busy);
+      }
+    }
+
     /// \note can be used to compute (lag / MS_PER_UPDATE), so
     /// we can use extrapolation between update() calls
     /// \note extrapolation may be wrong when it is used between update() calls,
@@ -215,7 +253,7 @@ public:
     //if(spareCycleAfterUpdateCallback)
     {
 #if !defined(NDEBUG)
-      const auto sc_start = std::chrono::steady_clock::now();
+      const auto sc_start = basis::FixedTimeStep::clock::now();
 #endif // NDEBUG
 
       spareCycleAfterUpdateCallback<UpdateCallbacksType>(
@@ -232,12 +270,52 @@ public:
 
 #if !defined(NDEBUG)
       const auto sc_elapsed = std::chrono::duration_cast<std::chrono::seconds>(
-            sc_start - std::chrono::steady_clock::now());
+            sc_start - basis::FixedTimeStep::clock::now());
 
       /// \note Make sure that code does not take too much time
       DCHECK(sc_elapsed < std::chrono::seconds{1});
 #endif // NDEBUG
     }
+
+    /// \note built-in pacing for the spare-cycle time: sleep coarsely
+    /// until shortly before the next tick deadline, then spin on the
+    /// clock (see FramePacer). The deadline is the moment the
+    /// accumulated lag reaches one fixed tick; when the loop is
+    /// already behind, wait_until() returns immediately and adds no
+    /// delay. Off by default so callers that pace inside
+    /// spareCycleAfterUpdateCallback keep their behavior.
+    if(is_pacing_enabled_)
+    {
+      frame_pacer_.wait_until(
+        frame_start_timestamp
+        + (time_step_.fixed_tickrate() - time_step_.lag()));
+    }
+  }
+
+  /// \note large `inline` functions cause Cache misses
+  /// and affect efficiency negatively, so keep it small
+  [[nodiscard]] /* don't ignore return value */
+  inline /* `inline` to eleminate function call overhead */
+  basis::FramePacer& frame_pacer_ref() noexcept {
+    return frame_pacer_;
+  }
+
+  /// \note large `inline` functions cause Cache misses
+  /// and affect efficiency negatively, so keep it small
+  inline /* `inline` to eleminate function call overhead */
+  void set_pacing_enabled(const bool is_pacing_enabled) noexcept {
+    is_pacing_enabled_ = is_pacing_enabled;
+  }
+
+  /// \note attach always-on instrumentation (update durations,
+  /// spare-cycle time, overruns); the stats object must outlive the
+  /// loop and may be read from any thread while the loop runs;
+  /// pass nullptr to detach
+  /// \note large `inline` functions cause Cache misses
+  /// and affect efficiency negatively, so keep it small
+  inline /* `inline` to eleminate function call overhead */
+  void set_stats(TickLoopStats* stats) noexcept {
+    stats_ = stats;
   }
 
   //[[nodiscard]] /* don't ignore return value */
@@ -252,14 +330,14 @@ public:
     time_step_.update_clock(basis::FixedTimeStep::clock::now());
     while (is_running_) {
   #if !defined(NDEBUG)
-      const auto tp_start = std::chrono::steady_clock::now();
+      const auto tp_start = basis::FixedTimeStep::clock::now();
   #endif // NDEBUG
 
       run_once();
 
   #if !defined(NDEBUG)
       const auto tp_elapsed = std::chrono::duration_cast<std::chrono::seconds>(
-            tp_start - std::chrono::steady_clock::now());
+            tp_start - basis::FixedTimeStep::clock::now());
 
       /// \note Make sure that code does not take too much time
       DCHECK(tp_elapsed < std::chrono::seconds{1});
@@ -290,6 +368,12 @@ public:
 private:
   basis::FixedTimeStep time_step_;
 
+  basis::FramePacer frame_pacer_;
+
+  TickLoopStats* stats_{nullptr};
+
+  bool is_pacing_enabled_{false};
+
   bool is_running_{false};
 };
 
@@ -0,0 +1,185 @@
+#include "FrameGraphScheduler.hpp" // IWYU pragma: associated
+
+#include <algorithm>
+#include <utility>
+
+#include <base/bind.h>
+#include <base/location.h>
+#include <base/synchronization/waitable_event.h>
+#include <base/task/post_task.h>
+#include <base/task/task_traits.h>
+
+namespace basis {
+
+FrameGraphScheduler::Node::Node(
+  const char* name
+  , NodeUpdateCallback&& updateCallback
+  , std::vector<ResourceId>&& reads
+  , std::vector<ResourceId>&& writes
+  , const size_t wave)
+  : name{name}
+    , update_callback{std::move(updateCallback)}
+    , reads{std::move(reads)}
+    , writes{std::move(writes)}
+    , wave{wave}
+{}
+
+FrameGraphScheduler::FrameGraphScheduler() noexcept = default;
+
+FrameGraphScheduler::~FrameGraphScheduler() = default;
+
+// static
+bool FrameGraphScheduler::AreConflicting(
+  const Node& earlier, const Node& later)
+{
+  /// \note linear intersection tests: the declared sets hold a handful
+  /// of tags, so this beats building hash sets per node
+  const auto intersects
+    = [](const std::vector<ResourceId>& lhs
+         , const std::vector<ResourceId>& rhs)
+  {
+    for(const ResourceId resource : lhs)
+    {
+      if(std::find(rhs.begin(), rhs.end(), resource) != rhs.end())
+      {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  return
+    // read-after-write
+    intersects(later.reads, earlier.writes)
+    // write-after-read
+    || intersects(later.writes, earlier.reads)
+    // write-after-write
+    || intersects(later.writes, earlier.writes);
+}
+
+FrameGraphScheduler::NodeId FrameGraphScheduler::register_node(
+  const char* name
+  , NodeUpdateCallback updateCallback
+  , std::vector<ResourceId> reads
+  , std::vector<ResourceId> writes)
+{
+  DCHECK(name);
+  DCHECK(updateCallback);
+  /// \note a node that touches nothing orders against nothing; that is
+  /// almost always a forgotten declaration, not an independent node
+  DCHECK(!reads.empty() || !writes.empty());
+
+  /// \note registration order is a valid topological order, so the
+  /// wave is simply one past the latest-wave earlier node this one
+  /// conflicts with; O(nodes^2) at startup, free per tick
+  size_t wave = 0;
+  Node candidate{
+    name, std::move(updateCallback), std::move(reads), std::move(writes), 0};
+  for(const Node& earlier : nodes_)
+  {
+    if(AreConflicting(earlier, candidate))
+    {
+      wave = std::max(wave, earlier.wave + 1);
+    }
+  }
+  candidate.wave = wave;
+
+  nodes_.push_back(std::move(candidate));
+  return nodes_.size() - 1;
+}
+
+size_t FrameGraphScheduler::wave_count() const noexcept
+{
+  size_t last_wave = 0;
+  bool any = false;
+  for(const Node& node : nodes_)
+  {
+    last_wave = std::max(last_wave, node.wave);
+    any = true;
+  }
+  return any ? (last_wave + 1) : 0;
+}
+
+// static
+void FrameGraphScheduler::RunNodeOnPool(
+  Node* node
+  , std::chrono::nanoseconds deltaTime
+  , std::chrono::nanoseconds fixed_tickrate
+  , std::atomic<size_t>* remaining
+  , base::WaitableEvent* done)
+{
+  node->update_callback(deltaTime, fixed_tickrate);
+
+  /// \note acq_rel so the caller's Wait() observes everything the
+  /// node's callback wrote
+  if(remaining->fetch_sub(1, std::memory_order_acq_rel) == 1)
+  {
+    done->Signal();
+  }
+}
+
+void FrameGraphScheduler::run_updates(
+  const std::chrono::nanoseconds& deltaTime
+  , const std::chrono::nanoseconds& fixed_tickrate)
+{
+  const size_t waves = wave_count();
+  for(size_t wave = 0; wave < waves; ++wave)
+  {
+    /// \note gather the wave each tick instead of caching index lists:
+    /// one linear scan over ~a-dozen nodes costs less than keeping a
+    /// per-wave vector hot
+    Node* inline_node = nullptr;
+    std::vector<Node*> pool_nodes;
+    for(Node& node : nodes_)
+    {
+      if(node.wave != wave)
+      {
+        continue;
+      }
+      if(!inline_node)
+      {
+        /// \note the calling thread is a worker too: one node of every
+        /// wave runs inline, so a single-node wave posts nothing
+        inline_node = &node;
+      }
+      else
+      {
+        pool_nodes.push_back(&node);
+      }
+    }
+    if(!inline_node)
+    {
+      continue;
+    }
+
+    base::WaitableEvent done(
+      base::WaitableEvent::ResetPolicy::MANUAL
+      , base::WaitableEvent::InitialState::NOT_SIGNALED);
+    std::atomic<size_t> remaining{pool_nodes.size()};
+
+    for(Node* node : pool_nodes)
+    {
+      base::PostTask(
+        FROM_HERE
+        , {base::ThreadPool(), base::TaskPriority::USER_BLOCKING}
+        , base::BindOnce(
+            &FrameGraphScheduler::RunNodeOnPool
+            , node
+            , deltaTime
+            , fixed_tickrate
+            , &remaining
+            , &done));
+    }
+
+    inline_node->update_callback(deltaTime, fixed_tickrate);
+
+    /// \note join at the wave boundary: the next wave may read what
+    /// this one wrote, and |remaining|/|done| live on this stack frame
+    if(!pool_nodes.empty())
+    {
+      done.Wait();
+    }
+  }
+}
+
+} // namespace basis
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include <base/logging.h> // for DCHECK
+
+namespace base { class WaitableEvent; }
+
+namespace basis {
+
+  /// \brief Frame-graph layer for the fixed-step update: subsystems
+  /// register update nodes with declared read/write dependencies and
+  /// the scheduler runs independent nodes concurrently on the thread
+  /// pool each tick.
+  /// \note with a single updateCallback users serialize subsystem
+  /// updates by hand even when most of them are mutually independent;
+  /// here the declared resource sets order the nodes into topological
+  /// waves: a node depends on every earlier-registered node it
+  /// conflicts with (read-after-write, write-after-read or
+  /// write-after-write on the same resource), nodes of one wave run
+  /// concurrently, waves run in order and the whole graph is joined
+  /// before run_updates() returns - the frame boundary
+  /// \note callbacks of one wave run on thread pool threads; they may
+  /// only touch the resources the node declared (that is what makes
+  /// the wave safe to parallelize); undeclared shared state is a race
+  /// \code
+  ///   basis::FrameGraphScheduler graph;
+  ///   enum Resource : uint64_t { kWorld, kPhysics, kNav, kAudio };
+  ///   graph.register_node("physics", &updatePhysics
+  ///     , /*reads*/ {kWorld}, /*writes*/ {kPhysics});
+  ///   graph.register_node("navigation", &updateNav
+  ///     , /*reads*/ {kWorld}, /*writes*/ {kNav});     // parallel with physics
+  ///   graph.register_node("world", &integrateWorld
+  ///     , /*reads*/ {kPhysics, kNav}, /*writes*/ {kWorld}); // next wave
+  ///
+  ///   // inside updateCallback of FixedTimeStepLoop (once per tick):
+  ///   graph.run_updates(deltaTime, fixed_tickrate);
+  /// \endcode
+  class FrameGraphScheduler
+  {
+  public:
+    using NodeId = size_t;
+
+    /// \note resource ids are opaque tags chosen by the caller
+    /// (an enum per shared data structure works well); two nodes
+    /// conflict iff their declared sets intersect on one of them
+    using ResourceId = uint64_t;
+
+    using NodeUpdateCallback
+      = std::function<void(const std::chrono::nanoseconds& deltaTime
+                           , const std::chrono::nanoseconds& fixed_tickrate)>;
+
+  public:
+    FrameGraphScheduler() noexcept;
+
+    ~FrameGraphScheduler();
+
+    /// \note nodes can not be unregistered; register them once at
+    /// startup (the id is an index into a stable vector); registration
+    /// order breaks ties, so nodes that conflict run in the order they
+    /// were registered
+    /// \note |name| must outlive the scheduler (pass a string literal);
+    /// it names the posted tasks in traces
+    [[nodiscard]] /* don't ignore return value */
+    NodeId register_node(
+      const char* name
+      , NodeUpdateCallback updateCallback
+      , std::vector<ResourceId> reads
+      , std::vector<ResourceId> writes);
+
+    /// \note call once per tick (e.g. from updateCallback of
+    /// FixedTimeStepLoop); runs every wave, independent nodes of one
+    /// wave concurrently on the thread pool, and returns only after the
+    /// last node of the last wave finished, so the caller sees a
+    /// completed frame
+    /// \note must not be re-entered and nodes must not be registered
+    /// while it runs
+    void run_updates(
+      const std::chrono::nanoseconds& deltaTime
+      , const std::chrono::nanoseconds& fixed_tickrate);
+
+    /// \note large `inline` functions cause Cache misses
+    /// and affect efficiency negatively, so keep it small
+    [[nodiscard]] /* don't ignore return value */
+    inline /* `inline` to eleminate function call overhead */
+    size_t size() const noexcept {
+      return nodes_.size();
+    }
+
+    /// \note number of topological waves; 1 means every node is
+    /// mutually independent, size() means the graph is a chain
+    [[nodiscard]] /* don't ignore return value */
+    size_t wave_count() const noexcept;
+
+    /// \note wave the node was assigned to, for tuning declared
+    /// dependencies (a node landing in a later wave than expected
+    /// usually over-declares its resource sets)
+    [[nodiscard]] /* don't ignore return value */
+    inline /* `inline` to eleminate function call overhead */
+    size_t wave_of(const NodeId id) const noexcept {
+      DCHECK(id < nodes_.size());
+      return nodes_[id].wave;
+    }
+
+  private:
+    struct Node {
+      Node(
+        const char* name
+        , NodeUpdateCallback&& updateCallback
+        , std::vector<ResourceId>&& reads
+        , std::vector<ResourceId>&& writes
+        , const size_t wave);
+
+      const char* name;
+
+      NodeUpdateCallback update_callback;
+
+      std::vector<ResourceId> reads;
+
+      std::vector<ResourceId> writes;
+
+      /// \note 0-based topological wave; computed at registration as
+      /// 1 + max wave of every earlier node this one conflicts with
+      size_t wave;
+    };
+
+    [[nodiscard]] /* don't ignore return value */
+    static bool AreConflicting(const Node& earlier, const Node& later);
+
+    /// \note trampoline for nodes posted to the thread pool; signals
+    /// |done| when the last node of the wave finishes
+    static void RunNodeOnPool(
+      Node* node
+      , std::chrono::nanoseconds deltaTime
+      , std::chrono::nanoseconds fixed_tickrate
+      , std::atomic<size_t>* remaining
+      , base::WaitableEvent* done);
+
+    std::vector<Node> nodes_;
+  };
+
+} // namespace basis
@@ -0,0 +1,38 @@
+#include "FramePacer.hpp" // IWYU pragma: associated
+
+#include <thread>
+
+#include <base/logging.h> // for DCHECK
+
+namespace basis {
+
+FramePacer::FramePacer(
+  const std::chrono::nanoseconds& spin_window) noexcept
+  : spin_window_(spin_window)
+{
+  DCHECK(spin_window >= std::chrono::nanoseconds{0});
+}
+
+void FramePacer::wait_until(const clock::time_point& deadline) noexcept
+{
+  clock::time_point now = clock::now();
+
+  /// \note sleep in one chunk up to the spin window; sleep_for() may
+  /// overshoot by a scheduler quantum, which the spin window absorbs
+  if(now + spin_window_ < deadline)
+  {
+    std::this_thread::sleep_for(deadline - spin_window_ - now);
+    now = clock::now();
+  }
+
+  /// \note spin on the timestamp for the final stretch;
+  /// yield() keeps a loaded sibling hyper-thread usable while staying
+  /// far more precise than sleeping
+  while(now < deadline)
+  {
+    std::this_thread::yield();
+    now = clock::now();
+  }
+}
+
+} // namespace basis
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <chrono>
+
+#include <basis/fast_clock.hpp>
+
+namespace basis {
+
+  // (2 milliseconds = 2000000 nanoseconds)
+  constexpr std::chrono::nanoseconds kDefaultSpinWindow{2000000};
+
+  /// \brief Hybrid sleep/spin waiting for frame pacing.
+  /// \note sleep_for() alone overshoots by the OS scheduler quantum
+  /// (commonly 1-15 ms), while spinning alone burns a full core.
+  /// The pacer sleeps coarsely until |spin_window| before the deadline
+  /// and spins on the clock for the remainder, so tick start jitter
+  /// stays well under 100 microseconds without a dedicated core.
+  class FramePacer
+  {
+  public:
+    /// \note FastClock: the spin stretch reads the clock in a tight
+    /// loop, which is exactly where the cheap TSC read pays off
+    using clock = basis::FastClock;
+
+  public:
+    FramePacer(
+      const std::chrono::nanoseconds& spin_window = kDefaultSpinWindow) noexcept;
+
+    /// \note blocks until |deadline|; returns immediately when the
+    /// deadline already passed (the loop is lagging, do not add delay)
+    void wait_until(const clock::time_point& deadline) noexcept;
+
+    /// \note large `inline` functions cause Cache misses
+    /// and affect efficiency negatively, so keep it small
+    [[nodiscard]] /* don't ignore return value */
+    inline /* `inline` to eleminate function call overhead */
+    std::chrono::nanoseconds spin_window() const noexcept {
+      return spin_window_;
+    }
+
+    /// \note widen the window on systems with a coarse scheduler
+    /// quantum (sleeps that overshoot past the deadline), narrow it to
+    /// spend less CPU spinning
+    /// \note large `inline` functions cause Cache misses
+    /// and affect efficiency negatively, so keep it small
+    inline /* `inline` to eleminate function call overhead */
+    void set_spin_window(const std::chrono::nanoseconds& spin_window) noexcept {
+      spin_window_ = spin_window;
+    }
+
+  private:
+    /// \note how long before the deadline to switch from sleeping to
+    /// spinning; must cover the worst sleep_for() overshoot
+    std::chrono::nanoseconds spin_window_;
+  };
+
+} // namespace basis
@@ -0,0 +1,71 @@
+#include "MultiRateScheduler.hpp" // IWYU pragma: associated
+
+#include <limits>
+#include <utility>
+
+namespace basis {
+
+MultiRateScheduler::Subsystem::Subsystem(
+  const std::chrono::nanoseconds& tickrate
+  , SubsystemUpdateCallback&& updateCallback)
+  : time_step{tickrate}
+    , update_callback{std::move(updateCallback)}
+    /// \note the first tick of every subsystem is due after one of its
+    /// own periods, so rates stay phase-aligned from startup
+    , virtual_next_tick_ns{static_cast<uint64_t>(tickrate.count())}
+{}
+
+MultiRateScheduler::MultiRateScheduler() noexcept = default;
+
+MultiRateScheduler::SubsystemId MultiRateScheduler::register_subsystem(
+  const std::chrono::nanoseconds& tickrate
+  , SubsystemUpdateCallback updateCallback)
+{
+  /// \note don`t divide to 0
+  DCHECK(tickrate > std::chrono::nanoseconds{0});
+  DCHECK(updateCallback);
+  subsystems_.emplace_back(tickrate, std::move(updateCallback));
+  return subsystems_.size() - 1;
+}
+
+void MultiRateScheduler::increase_lag(
+  const std::chrono::nanoseconds& deltaTime) noexcept
+{
+  for(Subsystem& subsystem : subsystems_)
+  {
+    subsystem.time_step.increase_lag(deltaTime);
+  }
+}
+
+void MultiRateScheduler::run_updates()
+{
+  /// \note repeatedly run the due subsystem with the earliest virtual
+  /// next tick; a linear scan is O(subsystems) per tick, which beats a
+  /// heap for the handful of subsystems this is built for
+  for(;;)
+  {
+    Subsystem* next = nullptr;
+    uint64_t next_tick_ns = std::numeric_limits<uint64_t>::max();
+    for(Subsystem& subsystem : subsystems_)
+    {
+      if(subsystem.time_step.is_update_required()
+         && subsystem.virtual_next_tick_ns < next_tick_ns)
+      {
+        next = &subsystem;
+        next_tick_ns = subsystem.virtual_next_tick_ns;
+      }
+    }
+    if(!next)
+    {
+      break;
+    }
+
+    next->update_callback(next->time_step.fixed_tickrate());
+
+    next->time_step.update_lag();
+    next->virtual_next_tick_ns
+      += static_cast<uint64_t>(next->time_step.fixed_tickrate().count());
+  }
+}
+
+} // namespace basis
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "basis/time_step/FixedTimeStep.hpp"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include <base/logging.h> // for DCHECK
+
+namespace basis {
+
+  /// \brief Drives several subsystems at independent fixed rates from
+  /// one loop (physics 60 Hz, replication 20 Hz, AI 10 Hz, ...).
+  /// \note with a single FixedTimeStep everything ticks at the highest
+  /// common rate and slower subsystems self-filter with IntervalTimers,
+  /// paying a call and the cache traffic for every no-op; here each
+  /// subsystem keeps its own lag accumulator and is only invoked when
+  /// its own tick is due
+  /// \note updates of different subsystems are interleaved in virtual
+  /// tick order, so after a long frame a 60 Hz subsystem catches up
+  /// with six ticks before a 10 Hz subsystem runs its one, in the same
+  /// relative order as if the frame had not stalled
+  /// \code
+  ///   basis::MultiRateScheduler scheduler;
+  ///   const auto physics_id
+  ///     = scheduler.register_subsystem(basis::k60fps, &updatePhysics);
+  ///   const auto ai_id
+  ///     = scheduler.register_subsystem(
+  ///         std::chrono::nanoseconds{100000000}, &updateAi); // 10 Hz
+  ///
+  ///   // inside the frame (e.g. from updateCallback of
+  ///   // FixedTimeStepLoop driven at the highest rate, or a plain loop):
+  ///   scheduler.increase_lag(deltaTime);
+  ///   scheduler.run_updates();
+  ///   render(scheduler.alpha(physics_id)); // per-subsystem blend factor
+  /// \endcode
+  class MultiRateScheduler
+  {
+  public:
+    using SubsystemId = size_t;
+
+    /// \note the callback receives the subsystem's own fixed tickrate
+    /// (its simulation delta), not the frame delta
+    using SubsystemUpdateCallback
+      = std::function<void(const std::chrono::nanoseconds& fixed_tickrate)>;
+
+  public:
+    MultiRateScheduler() noexcept;
+
+    /// \note subsystems can not be unregistered; register them once at
+    /// startup (the id is an index into a stable vector)
+    [[nodiscard]] /* don't ignore return value */
+    SubsystemId register_subsystem(
+      const std::chrono::nanoseconds& tickrate
+      , SubsystemUpdateCallback updateCallback);
+
+    /// \note call once per frame with the elapsed real time;
+    /// adds the delta to every subsystem's lag accumulator
+    void increase_lag(const std::chrono::nanoseconds& deltaTime) noexcept;
+
+    /// \note runs every due tick of every subsystem, interleaved in
+    /// virtual tick order; a subsystem with no due tick costs one
+    /// comparison and is not invoked
+    void run_updates();
+
+    /// \note large `inline` functions cause Cache misses
+    /// and affect efficiency negatively, so keep it small
+    [[nodiscard]] /* don't ignore return value */
+    inline /* `inline` to eleminate function call overhead */
+    size_t size() const noexcept {
+      return subsystems_.size();
+    }
+
+    /// \note interpolation factor in [0, 1): how far the subsystem's
+    /// remaining lag is into its next tick; use it to blend between
+    /// the last two simulated states when rendering
+    [[nodiscard]] /* don't ignore return value */
+    inline /* `inline` to eleminate function call overhead */
+    FixedTimeStep::delta_time_t alpha(const SubsystemId id) const noexcept {
+      DCHECK(id < subsystems_.size());
+      const Subsystem& subsystem = subsystems_[id];
+      return
+        static_cast<FixedTimeStep::delta_time_t>(
+          subsystem.time_step.lag().count())
+        / static_cast<FixedTimeStep::delta_time_t>(
+            subsystem.time_step.fixed_tickrate().count());
+    }
+
+    /// \note large `inline` functions cause Cache misses
+    /// and affect efficiency negatively, so keep it small
+    [[nodiscard]] /* don't ignore return value */
+    inline /* `inline` to eleminate function call overhead */
+    basis::FixedTimeStep& time_step_ref(const SubsystemId id) noexcept {
+      DCHECK(id < subsystems_.size());
+      return subsystems_[id].time_step;
+    }
+
+  private:
+    struct Subsystem {
+      Subsystem(
+        const std::chrono::nanoseconds& tickrate
+        , SubsystemUpdateCallback&& updateCallback);
+
+      basis::FixedTimeStep time_step;
+
+      SubsystemUpdateCallback update_callback;
+
+      /// \note virtual time (ns since scheduler start) of the
+      /// subsystem's next tick; only used to order interleaved updates
+      uint64_t virtual_next_tick_ns;
+    };
+
+    std::vector<Subsystem> subsystems_;
+  };
+
+} // namespace basis
@@ -0,0 +1,57 @@
+#include "TickLoopStats.hpp" // IWYU pragma: associated
+
+#include <base/strings/string_number_conversions.h>
+#include <base/trace_event/trace_event.h>
+
+namespace basis {
+
+namespace {
+
+std::string percentileToString(
+  const LockFreeHistogram& histogram, const double fraction)
+{
+  return base::NumberToString(
+    std::chrono::duration_cast<std::chrono::microseconds>(
+      histogram.percentile(fraction)).count());
+}
+
+} // namespace
+
+TickLoopStats::TickLoopStats() noexcept = default;
+
+std::string TickLoopStats::ToString() const
+{
+  std::string out;
+  out += "update us p50/p95/p99 ";
+  out += percentileToString(update_duration_, 0.50);
+  out += "/";
+  out += percentileToString(update_duration_, 0.95);
+  out += "/";
+  out += percentileToString(update_duration_, 0.99);
+  out += " spare us p50/p95/p99 ";
+  out += percentileToString(spare_cycle_, 0.50);
+  out += "/";
+  out += percentileToString(spare_cycle_, 0.95);
+  out += "/";
+  out += percentileToString(spare_cycle_, 0.99);
+  out += " overruns ";
+  out += base::NumberToString(overruns());
+  return out;
+}
+
+void TickLoopStats::dumpToTraceLog() const
+{
+  TRACE_EVENT_INSTANT2("headless", "TickLoopStats"
+    , TRACE_EVENT_SCOPE_PROCESS
+    , "summary", ToString()
+    , "overruns", overruns());
+}
+
+void TickLoopStats::reset() noexcept
+{
+  update_duration_.reset();
+  spare_cycle_.reset();
+  overruns_.reset();
+}
+
+} // namespace basis
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <basis/metrics/Metrics.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace basis {
+
+  /// \note the histogram itself lives in basis/metrics/Metrics.hpp so
+  /// other instrumentation (profiler registry, health metrics) shares
+  /// one implementation; this header keeps working for existing users
+
+  /// \brief Always-on instrumentation for one FixedTimeStepLoop.
+  /// \note attach via FixedTimeStepLoop::set_stats(); the loop records
+  /// every update tick duration, the spare-cycle time of every frame
+  /// and every overrun (a frame whose busy time exceeded one fixed
+  /// tick, i.e. the loop fell behind and had to catch up)
+  /// \note query percentiles at runtime for an admin surface, or call
+  /// dumpToTraceLog() next to basis::dumpLastTraceEvents() so the
+  /// summary lands in the same chrome://tracing capture as the spike
+  /// being investigated
+  class TickLoopStats
+  {
+  public:
+    TickLoopStats() noexcept;
+
+    /// \note large `inline` functions cause Cache misses
+    /// and affect efficiency negatively, so keep it small
+    inline /* `inline` to eleminate function call overhead */
+    void record_update_duration(
+      const std::chrono::nanoseconds& duration) noexcept {
+      update_duration_.record(duration);
+    }
+
+    /// \note large `inline` functions cause Cache misses
+    /// and affect efficiency negatively, so keep it small
+    inline /* `inline` to eleminate function call overhead */
+    void record_spare_cycle(
+      const std::chrono::nanoseconds& duration) noexcept {
+      spare_cycle_.record(duration);
+    }
+
+    /// \note large `inline` functions cause Cache misses
+    /// and affect efficiency negatively, so keep it small
+    inline /* `inline` to eleminate function call overhead */
+    void record_overrun() noexcept {
+      overruns_.increment();
+    }
+
+    [[nodiscard]] /* don't ignore return value */
+    inline /* `inline` to eleminate function call overhead */
+    LockFreeHistogram& update_duration_ref() noexcept {
+      return update_duration_;
+    }
+
+    [[nodiscard]] /* don't ignore return value */
+    inline /* `inline` to eleminate function call overhead */
+    LockFreeHistogram& spare_cycle_ref() noexcept {
+      return spare_cycle_;
+    }
+
+    [[nodiscard]] /* don't ignore return value */
+    inline /* `inline` to eleminate function call overhead */
+    uint64_t overruns() const noexcept {
+      return overruns_.value();
+    }
+
+    /// \note one-line human-readable summary (p50/p95/p99) for logs
+    [[nodiscard]] /* don't ignore return value */
+    std::string ToString() const;
+
+    /// \note emits the summary as an instant trace event into
+    /// TraceLog, so a dump made with basis::dumpLastTraceEvents()
+    /// carries the percentiles alongside the raw events
+    void dumpToTraceLog() const;
+
+    void reset() noexcept;
+
+  private:
+    LockFreeHistogram update_duration_;
+
+    LockFreeHistogram spare_cycle_;
+
+    Counter overruns_;
+  };
+
+} // namespace basis
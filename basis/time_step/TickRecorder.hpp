@@ -0,0 +1,327 @@
+#pragma once
+
+#include "basis/SequenceBuffer.hpp" // for backend::TickNumType, UserCommand
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include <base/files/file.h>
+#include <base/files/file_path.h>
+#include <base/files/memory_mapped_file.h>
+#include <base/logging.h> // for DCHECK
+#include <base/macros.h>
+
+namespace basis {
+
+  /// \note on-disk layout of a recorded session:
+  /// one TickRecordFileHeader followed by |record_count| fixed-size
+  /// records; the file is sized for |max_ticks| up front and the
+  /// header's count marks how much of it is valid, so recording never
+  /// grows the mapping
+  struct TickRecordFileHeader
+  {
+    static constexpr uint32_t kMagic = 0x52435442; // 'BTCR'
+
+    static constexpr uint32_t kVersion = 1;
+
+    uint32_t magic = kMagic;
+
+    uint32_t version = kVersion;
+
+    /// \note sizeof the templated record; rejects replaying a file
+    /// recorded with a different input type
+    uint32_t record_size = 0;
+
+    uint32_t reserved = 0;
+
+    uint64_t record_count = 0;
+
+    /// \note fixed tickrate the session ran at, so replay drives the
+    /// simulation with the same dt
+    int64_t tickrate_ns = 0;
+
+    /// \note seed the session's RNG was created with; per-tick
+    /// reseeding (if any) is captured in the records
+    uint64_t session_rng_seed = 0;
+  };
+
+  /// \note everything the tick consumed that the simulation can not
+  /// recompute: the input of the tick and the RNG state it started with
+  template<typename InputType>
+  struct TickRecord
+  {
+    ::backend::TickNumType tickNum = 0;
+
+    uint64_t rng_seed = 0;
+
+    InputType input{};
+  };
+
+  /// \brief Captures per-tick inputs and RNG seeds of a live session
+  /// into a pre-sized memory-mapped file.
+  /// \note performance investigation of tick spikes needs the exact
+  /// input sequence; recording is one memcpy per tick into a mapped
+  /// page (the kernel writes pages back asynchronously), cheap enough
+  /// to stay on in production
+  /// \note the input type must be trivially copyable and small - the
+  /// same constraint SequenceBuffer puts on UserCommand; record the
+  /// command you already keep in the SequenceBuffer, not derived state
+  /// \note single-threaded: call record() from the tick thread only
+  /// \code
+  ///   basis::TickRecorder<backend::UserCommand> recorder;
+  ///   CHECK(recorder.open(path, /*max_ticks*/ 60 * 60 * 60
+  ///     , time_step.fixed_tickrate(), session_seed));
+  ///   // inside updateCallback, once per tick:
+  ///   recorder.record(tickNum, rng.current_seed(), command);
+  /// \endcode
+  template<typename InputType = ::backend::UserCommand>
+  class TickRecorder
+  {
+  public:
+    using Record = TickRecord<InputType>;
+
+    static_assert(std::is_trivially_copyable<Record>::value
+      , "tick records are raw-copied into the mapping");
+
+  public:
+    TickRecorder() = default;
+
+    /// \note pre-sizes the file for |max_ticks| records; recording
+    /// past that silently drops ticks (and DCHECKs), it never blocks
+    /// the tick thread on a remap
+    [[nodiscard]] /* don't ignore return value */
+    bool open(
+      const base::FilePath& path
+      , const uint64_t max_ticks
+      , const std::chrono::nanoseconds& tickrate
+      , const uint64_t session_rng_seed)
+    {
+      DCHECK(!mapping_.IsValid());
+      DCHECK(max_ticks > 0);
+      DCHECK(tickrate > std::chrono::nanoseconds{0});
+
+      base::File file(
+        path
+        , base::File::FLAG_CREATE_ALWAYS
+          | base::File::FLAG_READ
+          | base::File::FLAG_WRITE);
+      if(!file.IsValid())
+      {
+        return false;
+      }
+
+      const int64_t file_size
+        = static_cast<int64_t>(sizeof(TickRecordFileHeader))
+          + static_cast<int64_t>(max_ticks * sizeof(Record));
+      if(!mapping_.Initialize(
+           std::move(file)
+           , base::MemoryMappedFile::Region{0, static_cast<size_t>(file_size)}
+           , base::MemoryMappedFile::READ_WRITE_EXTEND))
+      {
+        return false;
+      }
+
+      max_ticks_ = max_ticks;
+
+      TickRecordFileHeader header;
+      header.record_size = static_cast<uint32_t>(sizeof(Record));
+      header.tickrate_ns = tickrate.count();
+      header.session_rng_seed = session_rng_seed;
+      std::memcpy(mapping_.data(), &header, sizeof(header));
+
+      return true;
+    }
+
+    /// \note large `inline` functions cause Cache misses
+    /// and affect efficiency negatively, so keep it small
+    inline /* `inline` to eleminate function call overhead */
+    void record(
+      const ::backend::TickNumType tickNum
+      , const uint64_t rng_seed
+      , const InputType& input) noexcept
+    {
+      DCHECK(mapping_.IsValid());
+      TickRecordFileHeader* header = mutable_header();
+      DCHECK(header->record_count < max_ticks_);
+      if(header->record_count >= max_ticks_)
+      {
+        return;
+      }
+      Record record;
+      record.tickNum = tickNum;
+      record.rng_seed = rng_seed;
+      record.input = input;
+      std::memcpy(
+        mapping_.data()
+          + sizeof(TickRecordFileHeader)
+          + header->record_count * sizeof(Record)
+        , &record
+        , sizeof(record));
+      /// \note count is bumped after the record bytes, so a session
+      /// that dies mid-record leaves a readable file
+      ++header->record_count;
+    }
+
+    /// \note large `inline` functions cause Cache misses
+    /// and affect efficiency negatively, so keep it small
+    [[nodiscard]] /* don't ignore return value */
+    inline /* `inline` to eleminate function call overhead */
+    uint64_t recorded_ticks() const noexcept {
+      DCHECK(mapping_.IsValid());
+      TickRecordFileHeader header;
+      std::memcpy(&header, mapping_.data(), sizeof(header));
+      return header.record_count;
+    }
+
+  private:
+    /// \note large `inline` functions cause Cache misses
+    /// and affect efficiency negatively, so keep it small
+    [[nodiscard]] /* don't ignore return value */
+    inline /* `inline` to eleminate function call overhead */
+    TickRecordFileHeader* mutable_header() noexcept {
+      return reinterpret_cast<TickRecordFileHeader*>(mapping_.data());
+    }
+
+    base::MemoryMappedFile mapping_;
+
+    uint64_t max_ticks_ = 0;
+
+    DISALLOW_COPY_AND_ASSIGN(TickRecorder);
+  };
+
+  /// \brief Re-runs a recorded session deterministically.
+  /// \note replay ignores the wall clock entirely: drive() feeds the
+  /// captured ticks back-to-back with the recorded fixed dt, which is
+  /// exactly what offline profiling under perf wants - the spike shows
+  /// up at the same tick number every run
+  /// \code
+  ///   basis::TickReplayer<backend::UserCommand> replayer;
+  ///   CHECK(replayer.open(path));
+  ///   rng.reseed(replayer.session_rng_seed());
+  ///   replayer.drive(
+  ///     [&](const basis::TickRecord<backend::UserCommand>& record
+  ///         , const std::chrono::nanoseconds& fixed_tickrate)
+  ///   {
+  ///     rng.reseed(record.rng_seed);
+  ///     // same body FixedTimeStepLoop's updateCallback runs live:
+  ///     simulate(record.input, fixed_tickrate);
+  ///   });
+  /// \endcode
+  template<typename InputType = ::backend::UserCommand>
+  class TickReplayer
+  {
+  public:
+    using Record = TickRecord<InputType>;
+
+  public:
+    TickReplayer() = default;
+
+    [[nodiscard]] /* don't ignore return value */
+    bool open(const base::FilePath& path)
+    {
+      DCHECK(!mapping_.IsValid());
+      if(!mapping_.Initialize(path))
+      {
+        return false;
+      }
+      if(mapping_.length() < sizeof(TickRecordFileHeader))
+      {
+        return false;
+      }
+      std::memcpy(&header_, mapping_.data(), sizeof(header_));
+      if(header_.magic != TickRecordFileHeader::kMagic
+         || header_.version != TickRecordFileHeader::kVersion
+         || header_.record_size != sizeof(Record))
+      {
+        return false;
+      }
+      /// \note tolerate a pre-sized file that died mid-session: trust
+      /// only the records the header vouches for and that fit the file
+      const uint64_t mapped_records
+        = (mapping_.length() - sizeof(TickRecordFileHeader))
+          / sizeof(Record);
+      if(header_.record_count > mapped_records)
+      {
+        header_.record_count = mapped_records;
+      }
+      return true;
+    }
+
+    /// \note large `inline` functions cause Cache misses
+    /// and affect efficiency negatively, so keep it small
+    [[nodiscard]] /* don't ignore return value */
+    inline /* `inline` to eleminate function call overhead */
+    uint64_t size() const noexcept {
+      return header_.record_count;
+    }
+
+    /// \note large `inline` functions cause Cache misses
+    /// and affect efficiency negatively, so keep it small
+    [[nodiscard]] /* don't ignore return value */
+    inline /* `inline` to eleminate function call overhead */
+    std::chrono::nanoseconds fixed_tickrate() const noexcept {
+      return std::chrono::nanoseconds{header_.tickrate_ns};
+    }
+
+    /// \note large `inline` functions cause Cache misses
+    /// and affect efficiency negatively, so keep it small
+    [[nodiscard]] /* don't ignore return value */
+    inline /* `inline` to eleminate function call overhead */
+    uint64_t session_rng_seed() const noexcept {
+      return header_.session_rng_seed;
+    }
+
+    /// \note sequential cursor over the records; returns false past
+    /// the last one
+    [[nodiscard]] /* don't ignore return value */
+    inline /* `inline` to eleminate function call overhead */
+    bool next(Record* out) noexcept {
+      DCHECK(out);
+      if(cursor_ >= header_.record_count)
+      {
+        return false;
+      }
+      std::memcpy(
+        out
+        , mapping_.data()
+          + sizeof(TickRecordFileHeader)
+          + cursor_ * sizeof(Record)
+        , sizeof(Record));
+      ++cursor_;
+      return true;
+    }
+
+    /// \note large `inline` functions cause Cache misses
+    /// and affect efficiency negatively, so keep it small
+    inline /* `inline` to eleminate function call overhead */
+    void reset() noexcept {
+      cursor_ = 0;
+    }
+
+    /// \note replay driver: runs the callback once per captured tick,
+    /// back-to-back, with the recorded fixed dt; deterministic given a
+    /// deterministic callback (reseed your RNG from the record)
+    template<typename ReplayTickCb>
+    void drive(ReplayTickCb&& replayTickCb)
+    {
+      const std::chrono::nanoseconds tickrate = fixed_tickrate();
+      Record record;
+      while(next(&record))
+      {
+        replayTickCb(record, tickrate);
+      }
+    }
+
+  private:
+    base::MemoryMappedFile mapping_;
+
+    TickRecordFileHeader header_;
+
+    uint64_t cursor_ = 0;
+
+    DISALLOW_COPY_AND_ASSIGN(TickReplayer);
+  };
+
+} // namespace basis
@@ -0,0 +1,69 @@
+#include "DelayedPromiseScheduler.hpp" // IWYU pragma: associated
+
+#include <base/logging.h> // for DCHECK
+
+namespace basis {
+
+DelayedPromiseScheduler::DelayedPromiseScheduler(
+  const base::TimeDelta& slack)
+  : slack_(slack)
+{
+  DCHECK_GT(slack_, base::TimeDelta());
+  DETACH_FROM_SEQUENCE(sequence_checker_);
+}
+
+DelayedPromiseScheduler::~DelayedPromiseScheduler()
+{
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+}
+
+void DelayedPromiseScheduler::Start()
+{
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK(!pump_timer_.IsRunning());
+  last_pump_ = base::TimeTicks::Now();
+  pump_timer_.Start(
+    FROM_HERE
+    , slack_
+    , this
+    , &DelayedPromiseScheduler::OnPump);
+}
+
+void DelayedPromiseScheduler::Stop()
+{
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  pump_timer_.Stop();
+}
+
+DelayedPromiseScheduler::Scheduled<void>
+DelayedPromiseScheduler::ResolveAfter(
+  const base::Location& from_here
+  , const std::chrono::nanoseconds& delay)
+{
+  return PostDelayedPromise<void>(
+    from_here, delay, base::BindOnce([]() {}));
+}
+
+bool DelayedPromiseScheduler::Cancel(const TimerWheel::TimerHandle& handle)
+{
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  return wheel_.Cancel(handle);
+}
+
+size_t DelayedPromiseScheduler::PendingCount() const
+{
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  return wheel_.PendingCount();
+}
+
+void DelayedPromiseScheduler::OnPump()
+{
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  const base::TimeTicks now = base::TimeTicks::Now();
+  const base::TimeDelta elapsed = now - last_pump_;
+  last_pump_ = now;
+  wheel_.Advance(
+    std::chrono::nanoseconds{elapsed.InNanoseconds()});
+}
+
+}  // namespace basis
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <basis/promise/promise.h>
+#include <basis/timer/TimerWheel.hpp>
+
+#include <chrono>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include <base/bind.h>
+#include <base/callback.h>
+#include <base/location.h>
+#include <base/macros.h>
+#include <base/sequence_checker.h>
+#include <base/time/time.h>
+#include <base/timer/timer.h>
+
+namespace basis {
+
+// Coalescing scheduler for delayed promises.
+//
+// Scheduling a delayed promise through the message pump creates one
+// OS-level delayed task per promise; retry/timeout logic holding ~20k
+// pending deadlines then keeps ~20k timer entries in the pump, each a
+// potential separate wakeup. This scheduler parks the deadlines in a
+// TimerWheel instead (O(1) schedule and cancel) and drives the wheel
+// with ONE repeating pump task firing every |slack|: every deadline
+// landing inside the same pump window settles in the same wakeup, so
+// 20k pending timeouts cost the pump one timer entry and at most one
+// wakeup per slack interval.
+//
+// The price is accuracy: a promise settles up to |slack| late (default
+// 10 ms). That is the right trade for retry/timeout deadlines, and the
+// wrong one for frame-accurate work - keep using the wheel directly
+// (or the pump) where a tick matters.
+//
+// Not thread-safe: construct, Start(), schedule and Stop() on one
+// sequence, like TimerWheel. The pump runs on the sequence Start() was
+// called on, and promises settle there (chain ThenOn/ThenHere to hop).
+//
+// USAGE:
+//   basis::DelayedPromiseScheduler scheduler;
+//   scheduler.Start(); // on the owning sequence
+//   ...
+//   auto scheduled = scheduler.ResolveAfter(
+//     FROM_HERE, std::chrono::milliseconds{500});
+//   scheduled.promise.ThenHere(FROM_HERE, base::BindOnce(&onTimeout));
+//   ...
+//   // The reply arrived in time; the timeout never settles:
+//   scheduler.Cancel(scheduled.handle);
+class DelayedPromiseScheduler
+{
+ public:
+  // A scheduled deadline: the promise that settles when it is due, and
+  // the wheel handle to Cancel() it.
+  template <typename ResolveT>
+  struct Scheduled
+  {
+    base::Promise<ResolveT, base::NoReject> promise;
+    TimerWheel::TimerHandle handle;
+  };
+
+  explicit DelayedPromiseScheduler(
+    const base::TimeDelta& slack = base::TimeDelta::FromMilliseconds(10));
+  ~DelayedPromiseScheduler();
+
+  // Starts the pump on the calling sequence.
+  void Start();
+
+  // Stops the pump; pending deadlines stay parked in the wheel and
+  // resume settling after the next Start().
+  void Stop();
+
+  // Promise that resolves (with void) once |delay| (+ up to |slack|)
+  // elapsed - the timeout primitive. O(1).
+  Scheduled<void> ResolveAfter(
+    const base::Location& from_here
+    , const std::chrono::nanoseconds& delay);
+
+  // Runs |task| once due and resolves the promise with its result
+  // (void tasks resolve with void). O(1).
+  template <typename ReturnT>
+  Scheduled<ReturnT> PostDelayedPromise(
+    const base::Location& from_here
+    , const std::chrono::nanoseconds& delay
+    , base::OnceCallback<ReturnT()> task)
+  {
+    DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+    auto resolver
+      = std::make_unique<base::ManualPromiseResolver<ReturnT>>(from_here);
+    Scheduled<ReturnT> scheduled;
+    scheduled.promise = resolver->promise();
+    // The wheel takes a RepeatingCallback; the entry is one-shot, so
+    // the owned state is consumed exactly once.
+    scheduled.handle = wheel_.ScheduleOneShot(
+      from_here
+      , base::BindRepeating(
+          &DelayedPromiseScheduler::RunAndResolve<ReturnT>
+          , base::Owned(resolver.release())
+          , base::Passed(std::move(task)))
+      , delay);
+    return scheduled;
+  }
+
+  // Marks the deadline canceled in O(1); its promise never settles
+  // (the typical "reply arrived before the timeout" path). Returns
+  // false if it already fired or was already canceled.
+  bool Cancel(const TimerWheel::TimerHandle& handle);
+
+  // Scheduled and not yet settled or canceled.
+  size_t PendingCount() const;
+
+ private:
+  template <typename ReturnT>
+  static void RunAndResolve(
+    base::ManualPromiseResolver<ReturnT>* resolver
+    , base::OnceCallback<ReturnT()> task)
+  {
+    if constexpr (std::is_void<ReturnT>::value) {
+      std::move(task).Run();
+      resolver->Resolve();
+    } else {
+      resolver->Resolve(std::move(task).Run());
+    }
+  }
+
+  // Pump body: advances the wheel by the real time elapsed since the
+  // previous pump, settling every deadline that came due.
+  void OnPump();
+
+  TimerWheel wheel_;
+
+  const base::TimeDelta slack_;
+
+  base::RepeatingTimer pump_timer_;
+
+  // Wall-clock position of the last wheel advance.
+  base::TimeTicks last_pump_;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+
+  DISALLOW_COPY_AND_ASSIGN(DelayedPromiseScheduler);
+};
+
+}  // namespace basis
@@ -0,0 +1,307 @@
+#include "TimerWheel.hpp" // IWYU pragma: associated
+
+#include <utility>
+
+#include <base/bind.h>
+#include <base/logging.h> // for DCHECK
+
+namespace basis {
+
+namespace {
+
+// Adapter that runs a wheel callback once through
+// PeriodicPrioritizedTaskHeap and stops itself, so a due wheel timer
+// behaves as a one-shot heap task.
+void RunWheelTaskOnce(
+  TimerWheel::Callback task
+  , const std::chrono::nanoseconds& current_frame_elapsed_dt
+  , const std::chrono::nanoseconds& last_call_elapsed_dt
+  , bool* stop_repeating_task)
+{
+  task.Run();
+  *stop_repeating_task = true;
+}
+
+uint64_t TicksCeil(const std::chrono::nanoseconds& duration)
+{
+  const uint64_t tick_ns
+    = static_cast<uint64_t>(TimerWheel::kTickDuration.count());
+  const uint64_t duration_ns
+    = duration < std::chrono::nanoseconds{0}
+        ? 0
+        : static_cast<uint64_t>(duration.count());
+  // Round up and never below one tick, so a zero delay still waits for
+  // the next Advance instead of landing in the past.
+  const uint64_t ticks = (duration_ns + tick_ns - 1) / tick_ns;
+  return ticks == 0 ? 1 : ticks;
+}
+
+}  // namespace
+
+// static
+constexpr std::chrono::nanoseconds TimerWheel::kTickDuration;
+
+struct TimerWheel::TimerHandle::Entry {
+  Entry(
+    const base::Location& from_here
+    , Callback task
+    , uint64_t deadline_tick
+    , const std::chrono::nanoseconds& interval)
+    : from_here(from_here)
+      , task(std::move(task))
+      , deadline_tick(deadline_tick)
+      , interval(interval)
+  {}
+
+  base::Location from_here;
+  Callback task;
+  uint64_t deadline_tick;
+  // Zero for one-shot timers.
+  std::chrono::nanoseconds interval;
+  bool canceled = false;
+  bool fired = false;
+};
+
+TimerWheel::TimerHandle::TimerHandle() = default;
+TimerWheel::TimerHandle::~TimerHandle() = default;
+
+TimerWheel::TimerHandle::TimerHandle(const TimerHandle& other) = default;
+TimerWheel::TimerHandle& TimerWheel::TimerHandle::operator=(
+  const TimerHandle& other) = default;
+TimerWheel::TimerHandle::TimerHandle(TimerHandle&& other) = default;
+TimerWheel::TimerHandle& TimerWheel::TimerHandle::operator=(
+  TimerHandle&& other) = default;
+
+bool TimerWheel::TimerHandle::IsValid() const
+{
+  return entry_ != nullptr;
+}
+
+TimerWheel::TimerHandle::TimerHandle(std::shared_ptr<Entry> entry)
+  : entry_(std::move(entry))
+{}
+
+TimerWheel::TimerWheel() = default;
+TimerWheel::~TimerWheel() = default;
+
+TimerWheel::TimerHandle TimerWheel::ScheduleOneShot(
+  const base::Location& from_here
+  , Callback task
+  , const std::chrono::nanoseconds& delay)
+{
+  return ScheduleInternal(
+    from_here, std::move(task), delay, std::chrono::nanoseconds{0});
+}
+
+TimerWheel::TimerHandle TimerWheel::ScheduleRepeating(
+  const base::Location& from_here
+  , Callback task
+  , const std::chrono::nanoseconds& interval)
+{
+  DCHECK(interval > std::chrono::nanoseconds{0});
+  return ScheduleInternal(from_here, std::move(task), interval, interval);
+}
+
+TimerWheel::TimerHandle TimerWheel::ScheduleInternal(
+  const base::Location& from_here
+  , Callback task
+  , const std::chrono::nanoseconds& delay
+  , const std::chrono::nanoseconds& interval)
+{
+  DCHECK(task);
+  auto entry = std::make_shared<TimerHandle::Entry>(
+    from_here
+    , std::move(task)
+    , current_tick_ + TicksCeil(delay)
+    , interval);
+  AddEntry(entry);
+  ++pending_count_;
+  return TimerHandle(std::move(entry));
+}
+
+bool TimerWheel::Cancel(const TimerHandle& handle)
+{
+  if(!handle.entry_
+     || handle.entry_->canceled
+     || handle.entry_->fired)
+  {
+    return false;
+  }
+  // Lazy: the slot holding the entry drops it when it next expires or
+  // cascades, so no search is needed.
+  handle.entry_->canceled = true;
+  DCHECK(pending_count_ > 0);
+  --pending_count_;
+  return true;
+}
+
+void TimerWheel::AddEntry(std::shared_ptr<TimerHandle::Entry> entry)
+{
+  const uint64_t delta
+    = entry->deadline_tick > current_tick_
+        ? entry->deadline_tick - current_tick_
+        : 0;
+  size_t level = 0;
+  // Smallest level whose span covers the remaining delay; delays past
+  // the top level's span park there and re-cascade on wrap.
+  while(level + 1 < kWheelLevels
+        && (delta >> (kLevelBits * (level + 1))) != 0)
+  {
+    ++level;
+  }
+  const size_t slot
+    = static_cast<size_t>(
+        (entry->deadline_tick >> (kLevelBits * level))
+        & (kSlotsPerLevel - 1));
+  slots_[level][slot].push_back(std::move(entry));
+}
+
+void TimerWheel::Cascade(size_t level)
+{
+  if(level >= kWheelLevels)
+  {
+    return;
+  }
+  const size_t slot
+    = static_cast<size_t>(
+        (current_tick_ >> (kLevelBits * level)) & (kSlotsPerLevel - 1));
+  // Higher levels wrap first so entries trickle down one level at a
+  // time toward level 0.
+  if(slot == 0)
+  {
+    Cascade(level + 1);
+  }
+  Slot entries = std::move(slots_[level][slot]);
+  slots_[level][slot].clear();
+  for(std::shared_ptr<TimerHandle::Entry>& entry : entries)
+  {
+    if(entry->canceled)
+    {
+      continue; // reclaims the canceled entry
+    }
+    AddEntry(std::move(entry));
+  }
+}
+
+void TimerWheel::AdvanceOneTick(Slot* due)
+{
+  ++current_tick_;
+  const size_t slot
+    = static_cast<size_t>(current_tick_ & (kSlotsPerLevel - 1));
+  if(slot == 0)
+  {
+    Cascade(1);
+  }
+  Slot& expired = slots_[0][slot];
+  for(std::shared_ptr<TimerHandle::Entry>& entry : expired)
+  {
+    if(entry->canceled)
+    {
+      continue;
+    }
+    DCHECK(entry->deadline_tick <= current_tick_);
+    due->push_back(std::move(entry));
+  }
+  expired.clear();
+}
+
+void TimerWheel::RunDueEntry(
+  const std::shared_ptr<TimerHandle::Entry>& entry)
+{
+  // A callback earlier in this tick's batch may have Cancel()ed this
+  // entry after it was collected into |due|. Cancel() returned true,
+  // so the task must not run, and pending_count_ was already
+  // decremented there.
+  if(entry->canceled)
+  {
+    return;
+  }
+  entry->task.Run();
+  if(entry->interval > std::chrono::nanoseconds{0})
+  {
+    entry->deadline_tick = current_tick_ + TicksCeil(entry->interval);
+    AddEntry(entry);
+  }
+  else
+  {
+    entry->fired = true;
+    DCHECK(pending_count_ > 0);
+    --pending_count_;
+  }
+}
+
+void TimerWheel::DispatchDueEntryVia(
+  const std::shared_ptr<TimerHandle::Entry>& entry
+  , const scoped_refptr<PeriodicPrioritizedTaskHeap>& task_heap
+  , uint32_t priority)
+{
+  // Same batch-cancellation guard as RunDueEntry.
+  if(entry->canceled)
+  {
+    return;
+  }
+  // Interval of one tick makes the heap task due on the heap's next
+  // Run*; it stops itself after the single run (see RunWheelTaskOnce).
+  task_heap->ScheduleTask(
+    entry->from_here
+    , base::BindRepeating(&RunWheelTaskOnce, entry->task)
+    , priority
+    , kTickDuration);
+  if(entry->interval > std::chrono::nanoseconds{0})
+  {
+    entry->deadline_tick = current_tick_ + TicksCeil(entry->interval);
+    AddEntry(entry);
+  }
+  else
+  {
+    entry->fired = true;
+    DCHECK(pending_count_ > 0);
+    --pending_count_;
+  }
+}
+
+void TimerWheel::Advance(const std::chrono::nanoseconds& diff)
+{
+  DCHECK(diff >= std::chrono::nanoseconds{0});
+  tick_remainder_ += diff;
+  Slot due;
+  while(tick_remainder_ >= kTickDuration)
+  {
+    tick_remainder_ -= kTickDuration;
+    due.clear();
+    AdvanceOneTick(&due);
+    // Run per tick so callbacks see expiry order across ticks.
+    for(const std::shared_ptr<TimerHandle::Entry>& entry : due)
+    {
+      RunDueEntry(entry);
+    }
+  }
+}
+
+void TimerWheel::AdvanceAndDispatchVia(
+  const std::chrono::nanoseconds& diff
+  , scoped_refptr<PeriodicPrioritizedTaskHeap> task_heap
+  , uint32_t priority)
+{
+  DCHECK(diff >= std::chrono::nanoseconds{0});
+  DCHECK(task_heap);
+  tick_remainder_ += diff;
+  Slot due;
+  while(tick_remainder_ >= kTickDuration)
+  {
+    tick_remainder_ -= kTickDuration;
+    due.clear();
+    AdvanceOneTick(&due);
+    for(const std::shared_ptr<TimerHandle::Entry>& entry : due)
+    {
+      DispatchDueEntryVia(entry, task_heap, priority);
+    }
+  }
+}
+
+size_t TimerWheel::PendingCount() const
+{
+  return pending_count_;
+}
+
+}  // namespace basis
@@ -1,5 +1,136 @@
-﻿#pragma once
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include <base/location.h>
+#include <base/macros.h>
+#include <base/trace_event/trace_event.h>
 
 #define TRACE_EVENT_LOC(from_here) \
   TRACE_EVENT0("headless", \
     (std::string(from_here.file_name()) + from_here.function_name()).c_str())
+
+// Sampled tracing.
+//
+// Tracing every per-entity update (hundreds of thousands of events per
+// second) perturbs the latency being measured. TRACE_EVENT_LOC_SAMPLED
+// emits only every Nth execution of a site: the per-site decision is a
+// relaxed load, a decrement and a branch (~1 ns), so unsampled and
+// disabled hits are effectively free. The rate lives in a SampleRate
+// object shared by any number of sites (typically one per category) and
+// is adjustable at runtime from an admin surface.
+//
+// USAGE:
+//   // once, e.g. in the subsystem's .cc:
+//   ::basis::SampleRate& entity_trace_rate =
+//       ::basis::GetSampleRateForCategory("entity_update");
+//   entity_trace_rate.SetEveryN(1000);  // or SetProbability(0.001)
+//
+//   // in the hot function:
+//   TRACE_EVENT_LOC_SAMPLED(FROM_HERE, entity_trace_rate);
+
+namespace basis {
+
+// Runtime-adjustable sampling rate. 0 disables the site entirely,
+// 1 samples every hit, N samples roughly every Nth hit.
+class SampleRate {
+ public:
+  constexpr SampleRate() = default;
+
+  void SetEveryN(uint32_t n) { every_n_.store(n, std::memory_order_relaxed); }
+
+  // Convenience: probability |p| in (0, 1] maps to every-1/p sampling.
+  // p <= 0 disables.
+  void SetProbability(double p) {
+    SetEveryN(p <= 0.0 ? 0 : static_cast<uint32_t>(1.0 / p));
+  }
+
+  uint32_t every_n() const {
+    return every_n_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<uint32_t> every_n_{0};
+
+  DISALLOW_COPY_AND_ASSIGN(SampleRate);
+};
+
+// Per-callsite countdown behind TRACE_EVENT_LOC_SAMPLED. The counter is
+// shared by all threads hitting the site; races on the reset are benign
+// (they only shift which hit gets sampled, never crash or deadlock).
+class SamplingSite {
+ public:
+  constexpr SamplingSite() = default;
+
+  bool ShouldSample(SampleRate& rate) {
+    const uint32_t every_n = rate.every_n();
+    if (every_n == 0)
+      return false;  // Disabled: one relaxed load + branch.
+    if (countdown_.fetch_sub(1, std::memory_order_relaxed) > 1)
+      return false;  // Unsampled: decrement-and-test.
+    countdown_.store(every_n, std::memory_order_relaxed);
+    return true;
+  }
+
+ private:
+  std::atomic<uint32_t> countdown_{1};
+
+  DISALLOW_COPY_AND_ASSIGN(SamplingSite);
+};
+
+// Process-wide rate registry keyed by category name, so the admin
+// surface and the instrumented sites can rendezvous without sharing
+// headers. The returned reference is stable; sites capture it once.
+inline SampleRate& GetSampleRateForCategory(const std::string& category) {
+  static std::mutex mutex;
+  // Leaked on purpose: rates may be referenced from static trace sites.
+  static auto* rates = new std::map<std::string, SampleRate>();
+  std::lock_guard<std::mutex> lock(mutex);
+  return (*rates)[category];
+}
+
+// RAII slice emitted only when |sampled| is true. Uses the COPY trace
+// macros because the name is built at runtime from the location.
+class ScopedSampledTraceEvent {
+ public:
+  ScopedSampledTraceEvent(bool sampled, const base::Location& from_here)
+      : sampled_(sampled) {
+    if (sampled_) {
+      // The allocation only happens on the (rare) sampled path.
+      name_ = std::string(from_here.file_name()) + from_here.function_name();
+      TRACE_EVENT_COPY_BEGIN0("headless", name_.c_str());
+    }
+  }
+
+  ~ScopedSampledTraceEvent() {
+    if (sampled_) {
+      TRACE_EVENT_COPY_END0("headless", name_.c_str());
+    }
+  }
+
+ private:
+  const bool sampled_;
+  std::string name_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedSampledTraceEvent);
+};
+
+}  // namespace basis
+
+#define BASIS_TRACE_UTIL_CONCAT2(a, b) a##b
+#define BASIS_TRACE_UTIL_CONCAT(a, b) BASIS_TRACE_UTIL_CONCAT2(a, b)
+
+// Scoped slice covering the rest of the enclosing scope, emitted for
+// roughly one in rate.every_n() executions of this line.
+#define TRACE_EVENT_LOC_SAMPLED(from_here, sample_rate)                     \
+  static ::basis::SamplingSite BASIS_TRACE_UTIL_CONCAT(trace_sampling_site_,\
+                                                       __LINE__);           \
+  ::basis::ScopedSampledTraceEvent BASIS_TRACE_UTIL_CONCAT(                 \
+      trace_sampling_scope_, __LINE__)(                                     \
+      BASIS_TRACE_UTIL_CONCAT(trace_sampling_site_, __LINE__)               \
+          .ShouldSample(sample_rate),                                       \
+      from_here)
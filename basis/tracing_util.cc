@@ -1,8 +1,12 @@
 #include "basis/tracing_util.hpp" // IWYU pragma: associated
 
+#include <base/bind.h>
 #include <base/logging.h>
+#include <base/memory/ref_counted_memory.h>
 #include <base/path_service.h>
+#include <base/files/file_path.h>
 #include <base/files/file_util.h>
+#include <base/synchronization/waitable_event.h>
 #include <base/trace_event/trace_event.h>
 #include <base/trace_event/trace_buffer.h>
 #include <base/trace_event/trace_log.h>
@@ -18,12 +22,80 @@
 #include <base/trace_event/memory_infra_background_whitelist.h>
 #include <base/trace_event/process_memory_dump.h>
 
+#include <basis/binary_trace_file.hpp>
+#include <basis/compressed_block_writer.hpp>
+
 namespace basis {
 
+namespace {
+
+// Selected by initTracing(), read by dumpTraceSnapshot(). Plain
+// variable: initTracing runs once at startup, before any dump.
+TraceSnapshotFormat g_snapshot_format = TraceSnapshotFormat::kJson;
+
+// Shared collection behind dumpLastTraceEvents() and its compressed
+// variant: snapshots the ring into a chrome://tracing JSON array.
+std::string collectLastTraceEventsJson()
+{
+  base::trace_event::TraceLog* trace_log
+    = base::trace_event::TraceLog::GetInstance();
+  DCHECK(trace_log);
+
+  std::string json("[");
+
+  base::WaitableEvent done(
+    base::WaitableEvent::ResetPolicy::MANUAL
+    , base::WaitableEvent::InitialState::NOT_SIGNALED);
+
+  // Collects the chunked flush output. TraceLog may deliver it on
+  // another thread, hence the event instead of a plain return.
+  auto collect_chunk = base::BindRepeating(
+    [
+    ](
+      std::string* out
+      , base::WaitableEvent* done
+      , const scoped_refptr<base::RefCountedString>& events_str
+      , bool has_more_events
+    ){
+      if (!events_str->data().empty()) {
+        if (out->size() > 1) {
+          out->append(",");
+        }
+        out->append(events_str->data());
+      }
+      if (!has_more_events) {
+        done->Signal();
+      }
+    }
+    , base::Unretained(&json)
+    , base::Unretained(&done));
+
+  if (trace_log->IsEnabled()) {
+    // Keeps recording: the ring is read out but not cleared, so the
+    // flight recorder loses nothing while the snapshot is taken.
+    trace_log->FlushButLeaveBufferIntact(collect_chunk);
+  } else {
+    trace_log->Flush(collect_chunk
+      // Use a worker so the dump works from threads without a task
+      // runner (e.g. a signal-driven watchdog).
+      , true // use_worker_if_no_message_loop
+      );
+  }
+  done.Wait();
+
+  json.append("]");
+  return json;
+}
+
+}  // namespace
+
 void initTracing(
   const bool auto_start_tracer
-  , const std::string event_categories)
+  , const std::string event_categories
+  , const TraceSnapshotFormat snapshot_format)
 {
+  g_snapshot_format = snapshot_format;
+
   // Used by out-of-process heap-profiling. When malloc is profiled by an
   // external process, that process will be responsible for emitting metrics on
   // behalf of this one. Thus, MallocDumpProvider should not do anything.
@@ -262,4 +334,106 @@ void initTracing(
   //));
 }
 
+void startTraceFlightRecorder(
+  const std::string event_categories
+  , const size_t buffer_size_kb)
+{
+  base::trace_event::TraceConfig trace_config{
+    event_categories
+    // Ring mode: the buffer never fills, the newest events overwrite
+    // the oldest, so the recorder can stay on indefinitely.
+    , base::trace_event::RECORD_CONTINUOUSLY
+    };
+
+  if (buffer_size_kb) {
+    trace_config.SetTraceBufferSizeInKb(buffer_size_kb);
+  }
+
+  base::trace_event::TraceLog::GetInstance()->SetEnabled(
+    trace_config
+    , base::trace_event::TraceLog::RECORDING_MODE);
+
+  VLOG(1)
+    << "Flight-recorder tracing started with config: "
+    << trace_config.ToString();
+}
+
+void stopTraceFlightRecorder()
+{
+  base::trace_event::TraceLog::GetInstance()->SetDisabled();
+}
+
+bool dumpLastTraceEvents(const base::FilePath& path)
+{
+  const std::string json = collectLastTraceEventsJson();
+
+  const int size = static_cast<int>(json.size());
+  if (base::WriteFile(path, json.data(), size) != size) {
+    LOG(ERROR)
+      << "Failed to write trace snapshot to "
+      << path.value();
+    return false;
+  }
+
+  VLOG(1)
+    << "Dumped " << size << " bytes of trace events to "
+    << path.value();
+  return true;
+}
+
+bool dumpLastTraceEventsCompressed(const base::FilePath& path)
+{
+  const std::string json = collectLastTraceEventsJson();
+
+  // The compression thread owns the disk writes from here; this thread
+  // only hands 64 KiB blocks to the ring, so the dump returns at
+  // compression speed, not disk speed.
+  CompressedBlockWriter writer(path.value());
+  writer.write(json.data(), json.size());
+  writer.close();
+  if (!writer.ok()) {
+    LOG(ERROR)
+      << "Failed to write compressed trace snapshot to "
+      << path.value();
+    return false;
+  }
+
+  VLOG(1)
+    << "Dumped " << json.size()
+    << " bytes of trace events (compressed) to "
+    << path.value();
+  return true;
+}
+
+bool dumpLastTraceEventsBinary(const base::FilePath& path)
+{
+  const std::string json = collectLastTraceEventsJson();
+
+  // Single streaming pass over the flushed JSON straight into the
+  // binary writer; disk then sees interned+delta-encoded records under
+  // LZ4 instead of the JSON itself.
+  if (!writeBinaryTraceFromJson(path, json)) {
+    return false;
+  }
+
+  VLOG(1)
+    << "Dumped " << json.size()
+    << " bytes of trace events (binary format) to "
+    << path.value();
+  return true;
+}
+
+bool dumpTraceSnapshot(const base::FilePath& path)
+{
+  switch (g_snapshot_format) {
+    case TraceSnapshotFormat::kJsonLz4:
+      return dumpLastTraceEventsCompressed(path);
+    case TraceSnapshotFormat::kBinary:
+      return dumpLastTraceEventsBinary(path);
+    case TraceSnapshotFormat::kJson:
+      break;
+  }
+  return dumpLastTraceEvents(path);
+}
+
 }  // namespace basis
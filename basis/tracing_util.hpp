@@ -2,14 +2,79 @@
 
 #include <string>
 
+namespace base {
+class FilePath;
+}  // namespace base
+
 namespace basis {
 
+// What dumpTraceSnapshot() writes. Selectable at init so operators
+// flip one flag instead of changing every dump call site:
+// kJson        - plain chrome://tracing JSON (human-greppable, huge)
+// kJsonLz4     - the same JSON through the LZ4 block stage (~4x less)
+// kBinary      - compact binary format (basis/binary_trace_file.hpp):
+//                interned strings + delta-varint timestamps + LZ4,
+//                ~10x smaller and correspondingly faster to flush;
+//                expand with convertBinaryTraceToJson() for viewing.
+enum class TraceSnapshotFormat {
+  kJson,
+  kJsonLz4,
+  kBinary,
+};
+
 /// \todo move to TraceManager
 /// https://github.com/blockspacer/cobalt-clone-28052019/blob/89664d116629734759176d820e9923257717e09c/src/cobalt/browser/trace_manager.h
 /// \todo use ScopedTraceToFile
 /// https://github.com/blockspacer/cobalt-clone-cab7770533804d582eaa66c713a1582f361182d3/blob/0b72f93b07285f3af3c8452ae2ceaf5860ca7c72/src/cobalt/trace_event/scoped_trace_to_file.cc
+// |snapshot_format| selects what dumpTraceSnapshot() writes; see
+// TraceSnapshotFormat. Existing dump functions keep their fixed
+// formats regardless.
 void initTracing(
   const bool auto_start_tracer
-  , const std::string event_categories);
+  , const std::string event_categories
+  , const TraceSnapshotFormat snapshot_format
+      = TraceSnapshotFormat::kJson);
+
+// Flight-recorder tracing: always-on recording into TraceLog's fixed
+// in-memory ring (RECORD_CONTINUOUSLY: the newest events overwrite the
+// oldest), so trace cost stays bounded and there is no file streaming.
+// When a latency spike hits, dumpLastTraceEvents() snapshots whatever
+// is still in the ring. |event_categories| follows the same
+// comma-delimited wildcard syntax as initTracing; |buffer_size_kb|
+// bounds the ring (0 keeps TraceLog's default).
+void startTraceFlightRecorder(
+  const std::string event_categories
+  , const size_t buffer_size_kb = 0);
+
+void stopTraceFlightRecorder();
+
+// Snapshots the last events still in the ring to |path| as a JSON
+// trace loadable in chrome://tracing, without stopping the recording
+// (the ring is flushed but left intact). Blocks until every thread's
+// local buffer has been collected. Returns true if the file was
+// written. Safe to call whether or not the recorder is running (when
+// stopped it dumps whatever the ring last held).
+bool dumpLastTraceEvents(const base::FilePath& path);
+
+// Like dumpLastTraceEvents(), but the JSON goes through the streaming
+// LZ4 stage (basis/compressed_block_writer.hpp) before hitting disk:
+// ~4x less I/O for multi-hundred-MB rings, and the write bandwidth is
+// paid by a background thread instead of the caller. Read the file back
+// with basis::decompressBlockFile() before loading it in
+// chrome://tracing.
+bool dumpLastTraceEventsCompressed(const base::FilePath& path);
+
+// Like dumpLastTraceEvents(), but transcoded into the compact binary
+// trace format (basis/binary_trace_file.hpp) on the way to disk:
+// interned strings and delta-encoded timestamps under LZ4 cut the file
+// and the flush pause by roughly an order of magnitude on big rings.
+// Not directly loadable in chrome://tracing; expand it with
+// basis::convertBinaryTraceToJson() when a human needs to look.
+bool dumpLastTraceEventsBinary(const base::FilePath& path);
+
+// Dumps in whatever TraceSnapshotFormat initTracing() selected (kJson
+// when initTracing was never called). Dump call sites use this so the
+// format stays an init-time deployment decision.
+bool dumpTraceSnapshot(const base::FilePath& path);
 
 }  // namespace basis
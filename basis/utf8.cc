@@ -0,0 +1,416 @@
+#include "basis/utf8.hpp" // IWYU pragma: associated
+
+#include <cstdint>
+#include <cstring>
+
+#include <basis/cpu_features.hpp>
+
+// SSE2 is the x86-64 baseline; the ASCII fast paths below use nothing
+// newer, so they stay compile-time selected.
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define BASIS_UTF8_SSE2 1
+#endif
+
+// The SSSE3 validator is compiled with a per-function target attribute
+// and selected at runtime through basis::cpuFeatures(), so a baseline
+// build still carries the fast kernel for hosts that can run it.
+#if (defined(__x86_64__) || defined(__i386__)) \
+    && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define BASIS_UTF8_SIMD 1
+#define BASIS_UTF8_TARGET_SSSE3 __attribute__((target("ssse3")))
+#endif
+
+namespace basis {
+
+namespace {
+
+// Decodes one code point at |p| (|n| bytes left). Returns the sequence
+// length and sets |cp|, or 0 on malformed input (bad lead or
+// continuation bytes, overlong form, surrogate, > U+10FFFF). This is
+// the reference accept/reject behavior; the SIMD validator must agree
+// with it byte for byte.
+size_t decodeOneUtf8(const uint8_t* p, size_t n, uint32_t* cp)
+{
+  const uint8_t b0 = p[0];
+  if(b0 < 0x80) {
+    *cp = b0;
+    return 1;
+  }
+  if(b0 < 0xC2) {
+    // Unexpected continuation byte, or the always-overlong C0/C1.
+    return 0;
+  }
+  if(b0 < 0xE0) {
+    if(n < 2 || (p[1] & 0xC0) != 0x80) {
+      return 0;
+    }
+    *cp = (static_cast<uint32_t>(b0 & 0x1F) << 6) | (p[1] & 0x3F);
+    return 2;
+  }
+  if(b0 < 0xF0) {
+    if(n < 3
+       || (p[1] & 0xC0) != 0x80
+       || (p[2] & 0xC0) != 0x80)
+    {
+      return 0;
+    }
+    const uint32_t v
+      = (static_cast<uint32_t>(b0 & 0x0F) << 12)
+        | (static_cast<uint32_t>(p[1] & 0x3F) << 6)
+        | (p[2] & 0x3F);
+    if(v < 0x800               // overlong
+       || (v >= 0xD800 && v <= 0xDFFF)) // surrogate
+    {
+      return 0;
+    }
+    *cp = v;
+    return 3;
+  }
+  if(b0 < 0xF5) {
+    if(n < 4
+       || (p[1] & 0xC0) != 0x80
+       || (p[2] & 0xC0) != 0x80
+       || (p[3] & 0xC0) != 0x80)
+    {
+      return 0;
+    }
+    const uint32_t v
+      = (static_cast<uint32_t>(b0 & 0x07) << 18)
+        | (static_cast<uint32_t>(p[1] & 0x3F) << 12)
+        | (static_cast<uint32_t>(p[2] & 0x3F) << 6)
+        | (p[3] & 0x3F);
+    if(v < 0x10000 || v > 0x10FFFF) {
+      return 0;
+    }
+    *cp = v;
+    return 4;
+  }
+  return 0; // F5..FF can never start a sequence
+}
+
+// Fallback kernel; also the only one on non-x86 targets.
+bool isValidUtf8Scalar(const uint8_t* data, size_t size)
+{
+  size_t i = 0;
+  while(i < size) {
+    uint32_t cp;
+    const size_t len = decodeOneUtf8(data + i, size - i, &cp);
+    if(len == 0) {
+      return false;
+    }
+    i += len;
+  }
+  return true;
+}
+
+void appendUtf8(std::string* out, uint32_t cp)
+{
+  if(cp < 0x80) {
+    out->push_back(static_cast<char>(cp));
+  } else if(cp < 0x800) {
+    out->push_back(static_cast<char>(0xC0 | (cp >> 6)));
+    out->push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  } else if(cp < 0x10000) {
+    out->push_back(static_cast<char>(0xE0 | (cp >> 12)));
+    out->push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  } else {
+    out->push_back(static_cast<char>(0xF0 | (cp >> 18)));
+    out->push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  }
+}
+
+#if defined(BASIS_UTF8_SIMD)
+
+// The simdjson stage-1 classification: each error class gets a bit,
+// and three nibble-indexed shuffles AND together so a bit survives
+// only for byte pairs that actually exhibit that error. kTooLarge1000
+// and kOverlong4 deliberately share a bit - their (lead, second byte)
+// patterns cannot collide.
+constexpr uint8_t kTooShort = 1 << 0;   // lead followed by non-cont
+constexpr uint8_t kTooLong = 1 << 1;    // ASCII followed by cont
+constexpr uint8_t kOverlong3 = 1 << 2;  // E0 80..9F
+constexpr uint8_t kTooLarge = 1 << 3;   // F4 90.. and beyond
+constexpr uint8_t kSurrogate = 1 << 4;  // ED A0..BF
+constexpr uint8_t kOverlong2 = 1 << 5;  // C0/C1
+constexpr uint8_t kTooLarge1000 = 1 << 6; // F5..FF leads
+constexpr uint8_t kOverlong4 = 1 << 6;  // F0 80..8F
+constexpr uint8_t kTwoConts = 1 << 7;   // cont followed by cont
+
+constexpr uint8_t kCarry = kTooShort | kTooLong | kTwoConts;
+
+BASIS_UTF8_TARGET_SSSE3
+inline __m128i highNibbles(__m128i v)
+{
+  return _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0x0F));
+}
+
+// Error bits for every byte of |input| given the previous block; zero
+// for well-formed pairs. Continuations demanded by 3/4-byte leads two
+// and three positions back cancel the kTwoConts bit via the final XOR
+// (the Keiser-Lemire trick).
+BASIS_UTF8_TARGET_SSSE3
+inline __m128i classifyBlock(__m128i input, __m128i prev_input)
+{
+  const __m128i byte_1_high_tbl = _mm_setr_epi8(
+    kTooLong, kTooLong, kTooLong, kTooLong,
+    kTooLong, kTooLong, kTooLong, kTooLong,
+    kTwoConts, kTwoConts, kTwoConts, kTwoConts,
+    kTooShort | kOverlong2,
+    kTooShort,
+    kTooShort | kOverlong3 | kSurrogate,
+    kTooShort | kTooLarge | kTooLarge1000);
+  const __m128i byte_1_low_tbl = _mm_setr_epi8(
+    kCarry | kOverlong3 | kOverlong2 | kOverlong4,
+    kCarry | kOverlong2,
+    kCarry, kCarry,
+    kCarry | kTooLarge,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000 | kSurrogate,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000);
+  const __m128i byte_2_high_tbl = _mm_setr_epi8(
+    kTooShort, kTooShort, kTooShort, kTooShort,
+    kTooShort, kTooShort, kTooShort, kTooShort,
+    kTooLong | kOverlong2 | kTwoConts | kOverlong3
+      | kTooLarge1000 | kOverlong4,
+    kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge,
+    kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+    kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+    kTooShort, kTooShort, kTooShort, kTooShort);
+
+  const __m128i prev1 = _mm_alignr_epi8(input, prev_input, 15);
+  const __m128i special_cases = _mm_and_si128(
+    _mm_and_si128(
+      _mm_shuffle_epi8(byte_1_high_tbl, highNibbles(prev1))
+      , _mm_shuffle_epi8(
+          byte_1_low_tbl, _mm_and_si128(prev1, _mm_set1_epi8(0x0F))))
+    , _mm_shuffle_epi8(byte_2_high_tbl, highNibbles(input)));
+
+  const __m128i prev2 = _mm_alignr_epi8(input, prev_input, 14);
+  const __m128i prev3 = _mm_alignr_epi8(input, prev_input, 13);
+  // >= 0x80 exactly for positions that must be the 3rd byte of an
+  // E0..FF lead two back, or the 4th byte of an F0..FF lead three back.
+  const __m128i must_2_3_cont = _mm_or_si128(
+    _mm_subs_epu8(prev2, _mm_set1_epi8(static_cast<char>(0x60)))
+    , _mm_subs_epu8(prev3, _mm_set1_epi8(static_cast<char>(0x70))));
+  return _mm_xor_si128(
+    _mm_and_si128(must_2_3_cont, _mm_set1_epi8(static_cast<char>(0x80)))
+    , special_cases);
+}
+
+// Nonzero where |input| ends inside a multi-byte sequence: a lead in
+// the last position, a 3/4-byte lead in the second-to-last, a 4-byte
+// lead in the third-to-last.
+BASIS_UTF8_TARGET_SSSE3
+inline __m128i incompleteMask(__m128i input)
+{
+  const __m128i max_value = _mm_setr_epi8(
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    static_cast<char>(0xF0 - 1)
+    , static_cast<char>(0xE0 - 1)
+    , static_cast<char>(0xC0 - 1));
+  return _mm_subs_epu8(input, max_value);
+}
+
+BASIS_UTF8_TARGET_SSSE3
+bool isValidUtf8Simd(const uint8_t* data, size_t size)
+{
+  __m128i error = _mm_setzero_si128();
+  __m128i prev_input = _mm_setzero_si128();
+  __m128i prev_incomplete = _mm_setzero_si128();
+  size_t i = 0;
+  for(; i + 16 <= size; i += 16) {
+    const __m128i input
+      = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    if(_mm_movemask_epi8(input) == 0) {
+      // All ASCII: only an unfinished sequence from the previous
+      // block can be wrong here.
+      error = _mm_or_si128(error, prev_incomplete);
+      prev_incomplete = _mm_setzero_si128();
+    } else {
+      error = _mm_or_si128(error, classifyBlock(input, prev_input));
+      prev_incomplete = incompleteMask(input);
+    }
+    prev_input = input;
+  }
+  // Final block, zero-padded: the padding closes any dangling lead in
+  // the remainder (a lead followed by 0x00 classifies as kTooShort).
+  uint8_t tail[16] = {};
+  std::memcpy(tail, data + i, size - i);
+  const __m128i input
+    = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tail));
+  if(_mm_movemask_epi8(input) == 0) {
+    error = _mm_or_si128(error, prev_incomplete);
+  } else {
+    error = _mm_or_si128(error, classifyBlock(input, prev_input));
+  }
+  return _mm_movemask_epi8(
+           _mm_cmpeq_epi8(error, _mm_setzero_si128())) == 0xFFFF;
+}
+
+#endif // BASIS_UTF8_SIMD
+
+// Picks the best validator the host can execute; runs once per
+// process (see BASIS_MULTIARCH).
+bool (*resolveIsValidUtf8())(const uint8_t*, size_t)
+{
+#if defined(BASIS_UTF8_SIMD)
+  if(cpuFeatures().has_ssse3) {
+    return &isValidUtf8Simd;
+  }
+#endif
+  return &isValidUtf8Scalar;
+}
+
+BASIS_MULTIARCH(bool, isValidUtf8Dispatch
+  , (const uint8_t* data, size_t size), (data, size)
+  , resolveIsValidUtf8)
+
+} // namespace
+
+bool isValidUtf8(const base::StringPiece& input) noexcept
+{
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(input.data());
+  return isValidUtf8Dispatch(data, input.size());
+}
+
+size_t countUtf8CodePoints(const base::StringPiece& input) noexcept
+{
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(input.data());
+  const size_t size = input.size();
+  size_t count = 0;
+  size_t i = 0;
+#if defined(BASIS_UTF8_SSE2)
+  const __m128i cont_mask = _mm_set1_epi8(static_cast<char>(0xC0));
+  const __m128i cont_tag = _mm_set1_epi8(static_cast<char>(0x80));
+  for(; i + 16 <= size; i += 16) {
+    const __m128i input16
+      = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    const int continuations = __builtin_popcount(_mm_movemask_epi8(
+      _mm_cmpeq_epi8(_mm_and_si128(input16, cont_mask), cont_tag)));
+    count += 16 - static_cast<size_t>(continuations);
+  }
+#endif
+  for(; i < size; ++i) {
+    count += (data[i] & 0xC0) != 0x80;
+  }
+  return count;
+}
+
+bool utf8ToUtf16(const base::StringPiece& input, base::string16* output)
+{
+  output->clear();
+  // One UTF-16 unit per byte is the worst case (ASCII); multi-byte
+  // sequences only shrink.
+  output->reserve(input.size());
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(input.data());
+  const size_t size = input.size();
+  size_t i = 0;
+  while(i < size) {
+#if defined(BASIS_UTF8_SSE2)
+    // ASCII runs widen 16 bytes at a time; the scalar path below only
+    // ever sees the non-ASCII stretches and the short tail.
+    while(i + 16 <= size) {
+      const __m128i block
+        = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+      if(_mm_movemask_epi8(block) != 0) {
+        break;
+      }
+      base::char16 wide[16];
+      const __m128i zero = _mm_setzero_si128();
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(wide)
+        , _mm_unpacklo_epi8(block, zero));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(wide + 8)
+        , _mm_unpackhi_epi8(block, zero));
+      output->append(wide, 16);
+      i += 16;
+    }
+    if(i >= size) {
+      break;
+    }
+#endif
+    uint32_t cp;
+    const size_t len = decodeOneUtf8(data + i, size - i, &cp);
+    if(len == 0) {
+      output->clear();
+      return false;
+    }
+    if(cp < 0x10000) {
+      output->push_back(static_cast<base::char16>(cp));
+    } else {
+      cp -= 0x10000;
+      output->push_back(static_cast<base::char16>(0xD800 + (cp >> 10)));
+      output->push_back(static_cast<base::char16>(0xDC00 + (cp & 0x3FF)));
+    }
+    i += len;
+  }
+  return true;
+}
+
+std::string utf16ToUtf8(const base::StringPiece16& input)
+{
+  std::string output;
+  output.reserve(input.size());
+  const size_t size = input.size();
+  size_t i = 0;
+  while(i < size) {
+#if defined(BASIS_UTF8_SSE2)
+    // ASCII runs narrow 16 units at a time.
+    while(i + 16 <= size) {
+      const __m128i lo = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(input.data() + i));
+      const __m128i hi = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(input.data() + i + 8));
+      const __m128i non_ascii = _mm_and_si128(
+        _mm_or_si128(lo, hi)
+        , _mm_set1_epi16(static_cast<short>(0xFF80)));
+      if(_mm_movemask_epi8(
+           _mm_cmpeq_epi16(non_ascii, _mm_setzero_si128())) != 0xFFFF)
+      {
+        break;
+      }
+      char narrow[16];
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(narrow)
+        , _mm_packus_epi16(lo, hi));
+      output.append(narrow, 16);
+      i += 16;
+    }
+    if(i >= size) {
+      break;
+    }
+#endif
+    const uint16_t u = input[i];
+    uint32_t cp;
+    if(u >= 0xD800 && u < 0xDC00
+       && i + 1 < size
+       && input[i + 1] >= 0xDC00 && input[i + 1] < 0xE000)
+    {
+      cp = 0x10000
+           + ((static_cast<uint32_t>(u) - 0xD800) << 10)
+           + (input[i + 1] - 0xDC00);
+      i += 2;
+    } else if(u >= 0xD800 && u < 0xE000) {
+      cp = 0xFFFD; // unpaired surrogate, match base::UTF16ToUTF8
+      i += 1;
+    } else {
+      cp = u;
+      i += 1;
+    }
+    appendUtf8(&output, cp);
+  }
+  return output;
+}
+
+}  // namespace basis
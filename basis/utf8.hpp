@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include <base/strings/string16.h>
+#include <base/strings/string_piece.h>
+
+namespace basis {
+
+// Vectorized UTF-8 validation and conversion for paths that push
+// megabytes of text per second (chat, names, log payloads), where the
+// scalar loops in base/strings show up in profiles.
+//
+// Validation follows the simdjson stage-1 scheme (Keiser & Lemire,
+// "Validating UTF-8 In Less Than One Instruction Per Byte"): three
+// nibble-indexed shuffles classify every byte pair, so a 16-byte block
+// is checked in a handful of instructions and all-ASCII blocks short
+// circuit on one movemask. Builds without SSSE3 fall back to a scalar
+// decoder with identical accept/reject behavior; conversions use the
+// same ASCII block fast path and drop to scalar only for the non-ASCII
+// runs, which on our traffic are a small fraction of the bytes.
+
+// True iff |input| is well-formed UTF-8 (rejects overlongs, surrogate
+// code points and values above U+10FFFF, per RFC 3629).
+bool isValidUtf8(const base::StringPiece& input) noexcept;
+
+// Number of code points in |input| (counts non-continuation bytes;
+// input is assumed valid, invalid bytes skew the count but never walk
+// out of bounds).
+size_t countUtf8CodePoints(const base::StringPiece& input) noexcept;
+
+// Converts valid UTF-8 to UTF-16. Returns false (leaving |output|
+// cleared) when |input| is malformed - unlike base::UTF8ToUTF16 it
+// never substitutes U+FFFD, because the callers that care about speed
+// also want malformed network input rejected, not laundered.
+bool utf8ToUtf16(const base::StringPiece& input, base::string16* output);
+
+// Converts UTF-16 to UTF-8; unpaired surrogates become U+FFFD
+// (matching base::UTF16ToUTF8, so it can substitute in cache-key and
+// logging paths without behavior change).
+std::string utf16ToUtf8(const base::StringPiece16& input);
+
+}  // namespace basis
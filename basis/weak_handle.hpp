@@ -1,7 +1,9 @@
 ﻿#pragma once
 
 #include <cstddef>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 #include <base/bind.h>
 #include <base/compiler_specific.h>
@@ -10,8 +12,11 @@
 #include <base/macros.h>
 #include <base/memory/ref_counted.h>
 #include <base/memory/weak_ptr.h>
+#include <base/optional.h>
 #include <base/sequenced_task_runner.h>
 
+#include <basis/promise/post_promise.h>
+
 // Weak handles provides a way to refer to weak pointers from another sequence.
 // This is useful because it is not safe to reference a weak pointer from a
 // sequence other than the sequence on which it was created.
@@ -76,6 +81,12 @@ class WeakHandleCoreBase {
   void PostToOwnerThread(const base::Location& from_here,
                          const base::Closure& fn) const;
 
+  // May be called on any thread; used by promise-returning calls,
+  // which post through base::PostPromise instead of PostToOwnerThread.
+  base::SequencedTaskRunner* OwnerTaskRunner() const {
+    return owner_loop_task_runner_.get();
+  }
+
  private:
   // May be used on any thread.
   const scoped_refptr<base::SequencedTaskRunner> owner_loop_task_runner_;
@@ -108,12 +119,74 @@ class WeakHandleCore : public WeakHandleCoreBase,
                       base::Bind(method, ptr_, std::forward<Args>(args)...));
   }
 
+  // Posts like Call() and delivers the method's return value back
+  // through a promise; see WeakHandle<T>::CallAndReturn.
+  template <typename Method, typename... Args>
+  auto CallAndReturn(const base::Location& from_here,
+                     Method method,
+                     Args&&... args) const {
+    return base::PostPromise(
+        from_here, OwnerTaskRunner(),
+        base::BindOnce(
+            &WeakHandleCore::RunAndReturn<Method, std::decay_t<Args>...>,
+            ptr_, method, std::forward<Args>(args)...));
+  }
+
+  // Binds a call without posting it; used by WeakHandle<T>::CallBatch.
+  // The WeakPtr is bound in, so the liveness check still happens
+  // per-invocation on the owner thread.
+  template <typename Method, typename... Args>
+  base::Closure BindCall(Method method, Args&&... args) const {
+    return base::Bind(method, ptr_, std::forward<Args>(args)...);
+  }
+
+  // Posts |calls| as one task that runs them in order on the owner
+  // thread. May be called on any thread.
+  void CallAll(const base::Location& from_here,
+               std::vector<base::Closure> calls) const {
+    PostToOwnerThread(from_here,
+                      base::Bind(&WeakHandleCore::RunAll,
+                                 base::Passed(&calls)));
+  }
+
  private:
   friend class base::RefCountedThreadSafe<WeakHandleCore<T>>;
 
   // May be destroyed on any thread.
   ~WeakHandleCore() {}
 
+  // Runs on the owner thread.  Each call carries its own WeakPtr, so
+  // calls after the object's destruction are dropped individually.
+  static void RunAll(std::vector<base::Closure> calls) {
+    for (base::Closure& call : calls) {
+      call.Run();
+    }
+  }
+
+  // Runs on the owner thread inside the promise executor.  base::Bind
+  // refuses non-void methods on a WeakPtr receiver, so the liveness
+  // check is done by hand here and the "object already destroyed" case
+  // becomes a value: nullopt (or false for void methods) instead of a
+  // silently dropped task.
+  template <typename Method, typename... BoundArgs>
+  static auto RunAndReturn(base::WeakPtr<T> ptr,
+                           Method method,
+                           BoundArgs... args) {
+    using ReturnType = std::invoke_result_t<Method, T*, BoundArgs...>;
+    if constexpr (std::is_void<ReturnType>::value) {
+      if (!ptr)
+        return false;
+      (ptr.get()->*method)(std::move(args)...);
+      return true;
+    } else {
+      using Result = base::Optional<std::decay_t<ReturnType>>;
+      if (!ptr)
+        return Result();
+      return Result(base::in_place,
+                    (ptr.get()->*method)(std::move(args)...));
+    }
+  }
+
   // Must be dereferenced only on the owner thread.  May be destroyed
   // from any thread.
   base::WeakPtr<T> ptr_;
@@ -170,6 +243,82 @@ class WeakHandle {
     core_->Call(from_here, method, std::forward<Args>(args)...);
   }
 
+  // Round-trip variant of Call(): posts the method to the owner thread
+  // and delivers its return value back through a basis/promise, in one
+  // coordinated hop instead of the hand-rolled double post (call one
+  // way, second WeakHandle back) a caller otherwise needs.
+  //
+  // Returns Promise<base::Optional<R>, NoReject> for a method returning
+  // R (Promise<bool, NoReject> for void methods): the promise resolves
+  // with the result after the method ran on the owner thread, or with
+  // nullopt (false) when the object was already destroyed — the usual
+  // weak-pointer drop made observable, so callers can stop waiting.
+  // Attach the continuation wherever it should run:
+  //
+  //   foo_.CallAndReturn(FROM_HERE, &Foo::ComputeChecksum, block)
+  //       .ThenHere(FROM_HERE, base::BindOnce(&OnChecksum));
+  //
+  // May be called on any thread; arguments must be safe to bind and
+  // copy across threads, same as Call().
+  template <typename Method, typename... Args>
+  auto CallAndReturn(const base::Location& from_here,
+                     Method method,
+                     Args&&... args) const {
+    DCHECK(IsInitialized());
+    return core_->CallAndReturn(from_here, method,
+                                std::forward<Args>(args)...);
+  }
+
+  // CallBatch queues calls locally and flushes them as a single posted
+  // task, instead of one posted task per Call().  Useful when one event
+  // produces many calls on the same handle (e.g. per-item progress
+  // updates): the owner thread pays for one task, and the calls run
+  // back-to-back in Add() order.
+  //
+  // Add() only appends to a local vector - no locking, no posting - so
+  // a batch must be built and flushed on one thread.  Each queued call
+  // is bound through the same WeakPtr as Call(), so the usual
+  // weak-pointer liveness check still happens per-invocation on the
+  // owner thread; if the object dies mid-batch, the remaining calls are
+  // dropped individually, just as separate Call()s would be.
+  //
+  //   WeakHandle<Foo>::CallBatch batch(foo_);
+  //   for (const auto& item : items)
+  //     batch.Add(&Foo::OnItem, item);
+  //   batch.Flush(FROM_HERE);
+  class CallBatch {
+   public:
+    explicit CallBatch(const WeakHandle& handle) : core_(handle.core_) {
+      DCHECK(handle.IsInitialized());
+    }
+
+    ~CallBatch() {
+      DCHECK(calls_.empty()) << "CallBatch destroyed without Flush()";
+    }
+
+    // Records a call without posting it.
+    template <typename Method, typename... Args>
+    void Add(Method method, Args&&... args) {
+      calls_.push_back(
+          core_->BindCall(method, std::forward<Args>(args)...));
+    }
+
+    // Posts all recorded calls as one task; the batch may then be
+    // reused.  No-op if nothing was recorded.
+    void Flush(const base::Location& from_here) {
+      if (calls_.empty())
+        return;
+      core_->CallAll(from_here, std::move(calls_));
+      calls_.clear();
+    }
+
+   private:
+    const scoped_refptr<internal::WeakHandleCore<T>> core_;
+    std::vector<base::Closure> calls_;
+
+    DISALLOW_COPY_AND_ASSIGN(CallBatch);
+  };
+
  private:
   scoped_refptr<internal::WeakHandleCore<T>> core_;
 };
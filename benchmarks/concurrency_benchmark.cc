@@ -0,0 +1,302 @@
+// Contention benchmark matrix for the concurrency primitives. Run the
+// basis-concurrency-bench target on a new host SKU to pick queue
+// capacities and producer/consumer pinnings instead of guessing:
+// queue behavior varies wildly with core topology, so every benchmark
+// runs across a matrix of pinning modes, element sizes and batch
+// sizes.
+//
+//   BM_SpscThroughput<N>      - steady SPSC traffic, N-byte elements
+//   BM_SpscPingPongLatency    - round-trip latency, p50/p99 reported
+//   BM_MpmcThroughput         - MPMC queue under 2 and 4 threads
+//   BM_ByteStreamThroughput   - byte-ring with 16 and 256 byte records
+//
+// The "pin" argument selects the core placement of the two roles:
+//   0 unpinned            - whatever the scheduler does
+//   1 same core           - both roles time-slice one CPU (worst case,
+//                           but what an oversubscribed box degrades to)
+//   2 neighbor cores      - adjacent CPU ids, usually a shared L2/LLC
+//   3 far cores           - first and last CPU id, cross-socket on
+//                           multi-socket hosts
+// On hosts with fewer CPUs than a mode needs it degrades to the
+// nearest placement that exists, so the matrix always runs.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+#include <benchmark/benchmark.h>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#include "basis/concurrency/ByteStreamSPSCQueue.hpp"
+#include "basis/concurrency/LockFreeProducerConsumerQueue.hpp"
+#include "basis/concurrency/MPMCQueue.hpp"
+#include "basis/metrics/Metrics.hpp"
+
+namespace {
+
+enum PinMode {
+  kUnpinned = 0,
+  kSameCore = 1,
+  kNeighborCores = 2,
+  kFarCores = 3,
+};
+
+// CPU id for |role| (0 = producer side, 1 = consumer side) under
+// |mode|, clamped to the CPUs that actually exist.
+int cpuForRole(int mode, int role)
+{
+  const int cpus
+    = static_cast<int>(std::thread::hardware_concurrency());
+  const int last = cpus > 0 ? cpus - 1 : 0;
+  switch(mode) {
+    case kSameCore:
+      return 0;
+    case kNeighborCores:
+      return role == 0 ? 0 : (last >= 1 ? 1 : 0);
+    case kFarCores:
+      return role == 0 ? 0 : last;
+    default:
+      return -1;
+  }
+}
+
+void pinToCpu(int cpu)
+{
+#if defined(__linux__)
+  if(cpu < 0) {
+    return;
+  }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  ::sched_setaffinity(0, sizeof(set), &set);
+#else
+  (void)cpu;
+#endif
+}
+
+// Pins the calling benchmark thread for its role; google benchmark
+// gives each thread a stable thread_index.
+void applyPinning(benchmark::State& state, int mode)
+{
+  pinToCpu(cpuForRole(mode, state.thread_index() % 2));
+}
+
+// Fixed-size element so the matrix can vary how much data each op
+// drags through the cache, not just how many ops happen.
+template <size_t N>
+struct Payload {
+  char bytes[N];
+};
+
+// ---------------------------------------------------------------------
+// SPSC throughput: thread 0 produces, thread 1 consumes, both spin on
+// full/empty. "batch" is how many ops each side issues back-to-back
+// before touching |state| again - larger batches amortize the index
+// cache refresh (see LockFreeProducerConsumerQueue.hpp).
+template <size_t N>
+void BM_SpscThroughput(benchmark::State& state) {
+  static basis::LockFreeProducerConsumerQueue<Payload<N>>* queue
+    = nullptr;
+  if(state.thread_index() == 0) {
+    queue = new basis::LockFreeProducerConsumerQueue<Payload<N>>(4096);
+  }
+  applyPinning(state, static_cast<int>(state.range(0)));
+  const int batch = static_cast<int>(state.range(1));
+  Payload<N> element;
+  std::memset(element.bytes, 0, sizeof(element.bytes));
+  for (auto _ : state) {
+    if(state.thread_index() == 0) {
+      for(int i = 0; i < batch; ++i) {
+        while(!queue->write(element)) {
+        }
+      }
+    } else {
+      for(int i = 0; i < batch; ++i) {
+        while(!queue->read(element)) {
+        }
+        benchmark::DoNotOptimize(element);
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * batch);
+  state.SetBytesProcessed(state.iterations() * batch
+                          * static_cast<int64_t>(N));
+  if(state.thread_index() == 0) {
+    // The producer may finish with up to one batch still in flight;
+    // the consumer has already left its loop, so drain here.
+    Payload<N> leftover;
+    while(queue->read(leftover)) {
+    }
+    delete queue;
+    queue = nullptr;
+  }
+}
+
+#define SPSC_MATRIX(n)                                             \
+  BENCHMARK_TEMPLATE(BM_SpscThroughput, n)                         \
+    ->ArgNames({"pin", "batch"})                                   \
+    ->Args({kUnpinned, 1})->Args({kUnpinned, 16})                  \
+    ->Args({kSameCore, 1})->Args({kSameCore, 16})                  \
+    ->Args({kNeighborCores, 1})->Args({kNeighborCores, 16})        \
+    ->Args({kFarCores, 1})->Args({kFarCores, 16})                  \
+    ->Threads(2)                                                   \
+    ->UseRealTime()
+
+SPSC_MATRIX(8);
+SPSC_MATRIX(64);
+SPSC_MATRIX(256);
+
+#undef SPSC_MATRIX
+
+// ---------------------------------------------------------------------
+// SPSC round-trip latency: thread 0 sends a timestamp through |ping|,
+// thread 1 echoes it through |pong|, thread 0 records the half
+// round-trip. Percentiles come from the lock-free metrics histogram
+// (2x bucket granularity - good enough to compare pinnings).
+void BM_SpscPingPongLatency(benchmark::State& state) {
+  using Clock = std::chrono::steady_clock;
+  using TimePoint = Clock::time_point;
+  static basis::LockFreeProducerConsumerQueue<TimePoint>* ping
+    = nullptr;
+  static basis::LockFreeProducerConsumerQueue<TimePoint>* pong
+    = nullptr;
+  if(state.thread_index() == 0) {
+    ping = new basis::LockFreeProducerConsumerQueue<TimePoint>(16);
+    pong = new basis::LockFreeProducerConsumerQueue<TimePoint>(16);
+  }
+  applyPinning(state, static_cast<int>(state.range(0)));
+  basis::LockFreeHistogram histogram;
+  for (auto _ : state) {
+    if(state.thread_index() == 0) {
+      while(!ping->write(Clock::now())) {
+      }
+      TimePoint sent;
+      while(!pong->read(sent)) {
+      }
+      histogram.record(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+          Clock::now() - sent) / 2);
+    } else {
+      TimePoint sent;
+      while(!ping->read(sent)) {
+      }
+      while(!pong->write(sent)) {
+      }
+    }
+  }
+  if(state.thread_index() == 0) {
+    state.counters["p50_ns"] = benchmark::Counter(
+      static_cast<double>(histogram.percentile(0.5).count()));
+    state.counters["p99_ns"] = benchmark::Counter(
+      static_cast<double>(histogram.percentile(0.99).count()));
+    delete ping;
+    delete pong;
+    ping = nullptr;
+    pong = nullptr;
+  }
+}
+BENCHMARK(BM_SpscPingPongLatency)
+  ->ArgNames({"pin"})
+  ->Arg(kUnpinned)->Arg(kSameCore)->Arg(kNeighborCores)->Arg(kFarCores)
+  ->Threads(2)
+  ->UseRealTime();
+
+// ---------------------------------------------------------------------
+// MPMC throughput: even thread indices produce, odd ones consume, so
+// Threads(2) is the SPSC-shaped baseline and Threads(4) adds CAS
+// contention on both ends. Pinning alternates roles across the far
+// placement so producers and consumers land on different cores.
+void BM_MpmcThroughput(benchmark::State& state) {
+  static basis::MPMCQueue<uint64_t>* queue = nullptr;
+  static std::atomic<int> live_producers{0};
+  if(state.thread_index() == 0) {
+    queue = new basis::MPMCQueue<uint64_t>(4096);
+    live_producers.store((state.threads() + 1) / 2);
+  }
+  applyPinning(state, static_cast<int>(state.range(0)));
+  const bool producer = (state.thread_index() % 2) == 0;
+  for (auto _ : state) {
+    if(producer) {
+      while(!queue->write(uint64_t{1})) {
+      }
+    } else {
+      uint64_t out;
+      while(!queue->read(out)) {
+      }
+      benchmark::DoNotOptimize(out);
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  if(producer) {
+    live_producers.fetch_sub(1);
+  }
+  if(state.thread_index() == 0) {
+    while(live_producers.load() != 0) {
+    }
+    uint64_t leftover;
+    while(queue->read(leftover)) {
+    }
+    delete queue;
+    queue = nullptr;
+  }
+}
+BENCHMARK(BM_MpmcThroughput)
+  ->ArgNames({"pin"})
+  ->Arg(kUnpinned)->Arg(kSameCore)->Arg(kNeighborCores)->Arg(kFarCores)
+  ->Threads(2)
+  ->Threads(4)
+  ->UseRealTime();
+
+// ---------------------------------------------------------------------
+// Byte-ring throughput: variable-size records through the
+// ByteStreamSPSCQueue, consumer reads in place via front()/popFront().
+// "bytes" is the record payload size.
+void BM_ByteStreamThroughput(benchmark::State& state) {
+  static basis::ByteStreamSPSCQueue* queue = nullptr;
+  if(state.thread_index() == 0) {
+    queue = new basis::ByteStreamSPSCQueue(64 * 1024);
+  }
+  applyPinning(state, static_cast<int>(state.range(0)));
+  const uint32_t bytes = static_cast<uint32_t>(state.range(1));
+  char record[256] = {};
+  for (auto _ : state) {
+    if(state.thread_index() == 0) {
+      while(!queue->write(record, bytes)) {
+      }
+    } else {
+      basis::ByteStreamSPSCQueue::MessageView view;
+      while(!(view = queue->front())) {
+      }
+      benchmark::DoNotOptimize(view.data);
+      queue->popFront();
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations()
+                          * static_cast<int64_t>(bytes));
+  if(state.thread_index() == 0) {
+    while(queue->front()) {
+      queue->popFront();
+    }
+    delete queue;
+    queue = nullptr;
+  }
+}
+BENCHMARK(BM_ByteStreamThroughput)
+  ->ArgNames({"pin", "bytes"})
+  ->Args({kUnpinned, 16})->Args({kUnpinned, 256})
+  ->Args({kSameCore, 16})->Args({kSameCore, 256})
+  ->Args({kNeighborCores, 16})->Args({kNeighborCores, 256})
+  ->Args({kFarCores, 16})->Args({kFarCores, 256})
+  ->Threads(2)
+  ->UseRealTime();
+
+}  // namespace
+
+BENCHMARK_MAIN();
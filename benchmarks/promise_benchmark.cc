@@ -0,0 +1,125 @@
+// Copyright 2019 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Microbenchmarks for the promise subsystem. Run the basis-benchmarks
+// target before/after allocator or scheduling changes to compare:
+//
+//   BM_PromiseChainConstruction - cost of building an N-link ThenHere chain
+//   BM_PromiseResolveLatency    - settle + drain of a prebuilt chain
+//   BM_PromiseFanOutDispatch    - DependentList dispatch to N dependents
+//   BM_PromiseValueMove         - PromiseValue move construction/assignment
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "base/bind.h"
+#include "base/run_loop.h"
+#include "base/test/task_environment.h"
+#include "basis/promise/promise.h"
+#include "basis/promise/promise_value.h"
+#include "basis/promise/post_promise.h"
+
+namespace {
+
+int AddOne(int value) {
+  return value + 1;
+}
+
+void ConsumeInt(int value) {
+  benchmark::DoNotOptimize(value);
+}
+
+// Builds an N-link ThenHere chain per iteration (the chain is drained outside
+// the timed region by the next iteration's RunUntilIdle to keep the
+// construction cost isolated as much as the API allows).
+void BM_PromiseChainConstruction(benchmark::State& state) {
+  base::test::TaskEnvironment task_environment;
+  const int chain_length = static_cast<int>(state.range(0));
+  for (auto _ : state) {
+    base::ManualPromiseResolver<int> resolver(FROM_HERE);
+    base::Promise<int> promise = resolver.promise();
+    for (int i = 0; i < chain_length; ++i)
+      promise = promise.ThenHere(FROM_HERE, base::BindOnce(&AddOne));
+    benchmark::DoNotOptimize(promise);
+    state.PauseTiming();
+    resolver.Resolve(0);
+    base::RunLoop().RunUntilIdle();
+    state.ResumeTiming();
+  }
+}
+BENCHMARK(BM_PromiseChainConstruction)->Arg(1)->Arg(4)->Arg(8);
+
+// Settles a prebuilt N-link chain and runs it to completion.
+void BM_PromiseResolveLatency(benchmark::State& state) {
+  base::test::TaskEnvironment task_environment;
+  const int chain_length = static_cast<int>(state.range(0));
+  for (auto _ : state) {
+    state.PauseTiming();
+    base::ManualPromiseResolver<int> resolver(FROM_HERE);
+    base::Promise<int> promise = resolver.promise();
+    for (int i = 0; i < chain_length; ++i)
+      promise = promise.ThenHere(FROM_HERE, base::BindOnce(&AddOne));
+    promise.ThenHere(FROM_HERE, base::BindOnce(&ConsumeInt));
+    state.ResumeTiming();
+
+    resolver.Resolve(0);
+    base::RunLoop().RunUntilIdle();
+  }
+}
+BENCHMARK(BM_PromiseResolveLatency)->Arg(1)->Arg(4)->Arg(8);
+
+// One antecedent with N dependents; measures DependentList consume +
+// dispatch of the whole fan-out.
+void BM_PromiseFanOutDispatch(benchmark::State& state) {
+  base::test::TaskEnvironment task_environment;
+  const int fan_out = static_cast<int>(state.range(0));
+  for (auto _ : state) {
+    state.PauseTiming();
+    base::ManualPromiseResolver<int> resolver(FROM_HERE);
+    for (int i = 0; i < fan_out; ++i)
+      resolver.promise().ThenHere(FROM_HERE, base::BindOnce(&ConsumeInt));
+    state.ResumeTiming();
+
+    resolver.Resolve(0);
+    base::RunLoop().RunUntilIdle();
+  }
+}
+BENCHMARK(BM_PromiseFanOutDispatch)->Arg(16)->Arg(128)->Arg(512);
+
+// PromiseValue move with an inline payload (no heap traffic expected).
+void BM_PromiseValueMoveInline(benchmark::State& state) {
+  for (auto _ : state) {
+    base::internal::PromiseValue value(base::Resolved<int>(42));
+    base::internal::PromiseValue moved(std::move(value));
+    benchmark::DoNotOptimize(moved);
+    base::internal::PromiseValue assigned;
+    assigned = std::move(moved);
+    benchmark::DoNotOptimize(assigned);
+  }
+}
+BENCHMARK(BM_PromiseValueMoveInline);
+
+// PromiseValue move with an outline payload (pointer swap).
+void BM_PromiseValueMoveOutline(benchmark::State& state) {
+  struct BigPayload {
+    char bytes[128];
+  };
+  for (auto _ : state) {
+    base::internal::PromiseValue value(base::Resolved<BigPayload>(
+        BigPayload()));
+    base::internal::PromiseValue moved(std::move(value));
+    benchmark::DoNotOptimize(moved);
+    base::internal::PromiseValue assigned;
+    assigned = std::move(moved);
+    benchmark::DoNotOptimize(assigned);
+  }
+}
+BENCHMARK(BM_PromiseValueMoveOutline);
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,129 @@
+include_guard( DIRECTORY )
+
+# Link-time and profile-guided optimization presets for ${STATIC_LIB_NAME}
+# and everything that links it (tests, benchmarks, consumers built in this
+# tree). The promise/callback machinery is layered small functions across
+# many TUs; cross-TU inlining collapses most of that layering, which is
+# why these are first-class options instead of hand-hacked flags.
+#
+# ENABLE_LTO:
+#   ThinLTO on Clang (-flto=thin; parallel and fast enough for everyday
+#   Release builds), CMake IPO (-flto) on GCC. Applies to every target
+#   configured after this file is included, so the static library and
+#   its consumers see the same IR-level view.
+#   NOTE: with Clang the static archive holds LLVM bitcode, so the
+#   archiver/ranlib must understand it (llvm-ar/llvm-ranlib, or binutils
+#   with the LLVM gold plugin); the clang conan profile sets those up.
+#
+# PGO_STAGE ("" | instrument | optimize) + PGO_PROFILE_DIR:
+#   The documented flow, using the benchmark targets as the training
+#   workload (they cover the promise, queue and timer hot paths):
+#
+#     # 1. instrumented build
+#     cmake -B build-pgo -DCMAKE_BUILD_TYPE=Release \
+#       -DENABLE_BENCHMARKS=ON -DPGO_STAGE=instrument
+#     cmake --build build-pgo
+#
+#     # 2. training run (writes profiles into PGO_PROFILE_DIR)
+#     ./build-pgo/bin/Release/benchmarks/basis-benchmarks
+#     ./build-pgo/bin/Release/benchmarks/basis-concurrency-bench
+#
+#     # 2b. Clang only: merge the raw profiles
+#     llvm-profdata merge -output=build-pgo/pgo-profiles/basis.profdata \
+#       build-pgo/pgo-profiles/*.profraw
+#
+#     # 3. optimized rebuild against the collected profiles
+#     cmake -B build-opt -DCMAKE_BUILD_TYPE=Release -DENABLE_LTO=ON \
+#       -DPGO_STAGE=optimize \
+#       -DPGO_PROFILE_DIR=$(pwd)/build-pgo/pgo-profiles
+#     cmake --build build-opt
+#
+#   A workload that does not match production skews the layout the wrong
+#   way - keep the training step to the benchmark targets (or a replay
+#   of real traffic), not the unit tests.
+
+option(ENABLE_LTO
+  "Enable ThinLTO/IPO for ${STATIC_LIB_NAME} and in-tree consumers" OFF)
+
+set(PGO_STAGE "" CACHE STRING
+  "PGO build stage: empty (off), 'instrument' or 'optimize'")
+set_property(CACHE PGO_STAGE PROPERTY STRINGS "" "instrument" "optimize")
+
+set(PGO_PROFILE_DIR "${CMAKE_BINARY_DIR}/pgo-profiles" CACHE PATH
+  "Where 'instrument' builds write profiles and 'optimize' builds read them")
+
+# Appends |flags| to compilation and to every link (exe/shared/module):
+# LTO and PGO both require the flags on both sides.
+macro(basis_add_compile_and_link_flags flags)
+  add_compile_options(${flags})
+  string(REPLACE ";" " " _basis_link_flags "${flags}")
+  set(CMAKE_EXE_LINKER_FLAGS
+    "${CMAKE_EXE_LINKER_FLAGS} ${_basis_link_flags}")
+  set(CMAKE_SHARED_LINKER_FLAGS
+    "${CMAKE_SHARED_LINKER_FLAGS} ${_basis_link_flags}")
+  set(CMAKE_MODULE_LINKER_FLAGS
+    "${CMAKE_MODULE_LINKER_FLAGS} ${_basis_link_flags}")
+  unset(_basis_link_flags)
+endmacro()
+
+if(ENABLE_LTO)
+  if(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+    basis_add_compile_and_link_flags("-flto=thin")
+    message(STATUS "${STATIC_LIB_NAME}: ThinLTO enabled")
+  else()
+    include(CheckIPOSupported)
+    check_ipo_supported(RESULT ipo_supported OUTPUT ipo_error)
+    if(ipo_supported)
+      # Inherited by every target configured after this point.
+      set(CMAKE_INTERPROCEDURAL_OPTIMIZATION ON)
+      message(STATUS "${STATIC_LIB_NAME}: IPO/LTO enabled")
+    else()
+      message(FATAL_ERROR
+        "ENABLE_LTO is ON but the toolchain lacks IPO support: ${ipo_error}")
+    endif()
+  endif()
+endif()
+
+if(PGO_STAGE STREQUAL "instrument")
+  file(MAKE_DIRECTORY "${PGO_PROFILE_DIR}")
+  if(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+    # %p keeps concurrent training processes from clobbering each other;
+    # merge the .profraw files with llvm-profdata before 'optimize'.
+    basis_add_compile_and_link_flags(
+      "-fprofile-instr-generate=${PGO_PROFILE_DIR}/basis-%p.profraw")
+  else()
+    basis_add_compile_and_link_flags(
+      "-fprofile-generate=${PGO_PROFILE_DIR}")
+  endif()
+  message(STATUS
+    "${STATIC_LIB_NAME}: PGO instrumentation -> ${PGO_PROFILE_DIR}")
+elseif(PGO_STAGE STREQUAL "optimize")
+  if(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+    set(pgo_profdata "${PGO_PROFILE_DIR}/basis.profdata")
+    if(NOT EXISTS "${pgo_profdata}")
+      message(FATAL_ERROR
+        "PGO_STAGE=optimize but ${pgo_profdata} is missing; run the "
+        "instrumented benchmarks and llvm-profdata merge first "
+        "(see cmake/OptimizationPresets.cmake)")
+    endif()
+    basis_add_compile_and_link_flags(
+      "-fprofile-instr-use=${pgo_profdata}")
+  else()
+    if(NOT IS_DIRECTORY "${PGO_PROFILE_DIR}")
+      message(FATAL_ERROR
+        "PGO_STAGE=optimize but PGO_PROFILE_DIR does not exist: "
+        "${PGO_PROFILE_DIR}; run the instrumented benchmarks first "
+        "(see cmake/OptimizationPresets.cmake)")
+    endif()
+    # -fprofile-correction: the concurrency benchmarks update counters
+    # from several threads, which leaves slightly inconsistent profiles.
+    basis_add_compile_and_link_flags(
+      "-fprofile-use=${PGO_PROFILE_DIR};-fprofile-correction")
+  endif()
+  message(STATUS
+    "${STATIC_LIB_NAME}: PGO optimized build <- ${PGO_PROFILE_DIR}")
+elseif(NOT PGO_STAGE STREQUAL "")
+  message(FATAL_ERROR
+    "Unknown PGO_STAGE '${PGO_STAGE}' (expected empty, 'instrument' "
+    "or 'optimize')")
+endif()
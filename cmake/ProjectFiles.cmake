@@ -7,23 +7,51 @@ list(APPEND BASIS_SOURCES
   ${BASIS_DIR}/i18n.hpp
   ${BASIS_DIR}/i18n.cc
   #
+  ${BASIS_DIR}/utf8.hpp
+  ${BASIS_DIR}/utf8.cc
+  #
+  ${BASIS_DIR}/cpu_features.hpp
+  ${BASIS_DIR}/cpu_features.cc
+  #
+  ${BASIS_DIR}/fast_clock.hpp
+  ${BASIS_DIR}/fast_clock.cc
+  #
   ${BASIS_DIR}/icu_util.hpp
   ${BASIS_DIR}/icu_util.cc
   #
   ${BASIS_DIR}/cmd_util.hpp
   ${BASIS_DIR}/cmd_util.cc
   #
+  ${BASIS_DIR}/switch_registry.hpp
+  ${BASIS_DIR}/switch_registry.cc
+  #
   ${BASIS_DIR}/thread_pool_util.hpp
   ${BASIS_DIR}/thread_pool_util.cc
   #
+  ${BASIS_DIR}/async_file.hpp
+  ${BASIS_DIR}/async_file.cc
+  #
   ${BASIS_DIR}/tracing_util.hpp
   ${BASIS_DIR}/tracing_util.cc
+  ${BASIS_DIR}/binary_trace_file.hpp
+  ${BASIS_DIR}/binary_trace_file.cc
+  #
+  ${BASIS_DIR}/serializers.h
+  ${BASIS_DIR}/serializers.cc
+  ${BASIS_DIR}/flat_json.h
+  ${BASIS_DIR}/flat_json.cc
   #
   ${BASIS_DIR}/log_util.hpp
   ${BASIS_DIR}/log_util.cc
+  ${BASIS_DIR}/startup_phases.hpp
+  ${BASIS_DIR}/startup_phases.cc
   #
   ${BASIS_DIR}/scoped_log_run_time.hpp
   ${BASIS_DIR}/scoped_log_run_time.cc
+  ${BASIS_DIR}/scoped_profile.hpp
+  ${BASIS_DIR}/scoped_profile.cc
+  ${BASIS_DIR}/perf_counters.hpp
+  ${BASIS_DIR}/perf_counters.cc
   #
   ${BASIS_DIR}/application/application.hpp
   ${BASIS_DIR}/application/application.cc
@@ -44,14 +72,19 @@ list(APPEND BASIS_SOURCES
   #
   ${BASIS_DIR}/test/do_nothing_promise.h
   ${BASIS_DIR}/test/do_nothing_promise.cc
+  ${BASIS_DIR}/test/allocation_watcher.h
   #
   ${BASIS_DIR}/promise/abstract_promise.cc
   ${BASIS_DIR}/promise/abstract_promise.h
   ${BASIS_DIR}/promise/all_container_executor.h
+  ${BASIS_DIR}/promise/co_await.h
   ${BASIS_DIR}/promise/all_tuple_executor.h
   ${BASIS_DIR}/promise/dependent_list.cc
   ${BASIS_DIR}/promise/dependent_list.h
+  ${BASIS_DIR}/promise/dispatch_batch.cc
+  ${BASIS_DIR}/promise/dispatch_batch.h
   ${BASIS_DIR}/promise/finally_executor.cc
+  ${BASIS_DIR}/promise/fused_chain_builder.h
   ${BASIS_DIR}/promise/finally_executor.h
   ${BASIS_DIR}/promise/helpers.cc
   ${BASIS_DIR}/promise/helpers.h
@@ -64,6 +97,8 @@ list(APPEND BASIS_SOURCES
   ${BASIS_DIR}/promise/promise_executor.cc
   ${BASIS_DIR}/promise/promise_executor.h
   ${BASIS_DIR}/promise/promise_result.h
+  ${BASIS_DIR}/promise/promise_arena.cc
+  ${BASIS_DIR}/promise/promise_arena.h
   ${BASIS_DIR}/promise/promise_value.cc
   ${BASIS_DIR}/promise/promise_value.h
   ${BASIS_DIR}/promise/post_promise.cc
@@ -72,22 +107,66 @@ list(APPEND BASIS_SOURCES
   ${BASIS_DIR}/promise/then_and_catch_executor.h
   #
   ${BASIS_DIR}/core/numeric_static_cast.hpp
+  ${BASIS_DIR}/core/saturated_cast_span.hpp
   ${BASIS_DIR}/core/pimpl.hpp
+  ${BASIS_DIR}/core/pimpl_pool.hpp
   ${BASIS_DIR}/immutable.hpp
+  ${BASIS_DIR}/inplace_function.hpp
   ${BASIS_DIR}/weak_handle.hpp
   ${BASIS_DIR}/enum_set.hpp
+  ${BASIS_DIR}/enum_table.hpp
   ${BASIS_DIR}/polymorphic_downcast.hpp
   ${BASIS_DIR}/ltrace.hpp
+  ${BASIS_DIR}/ltrace_format.hpp
+  ${BASIS_DIR}/metrics/Metrics.hpp
+  ${BASIS_DIR}/metrics/Metrics.cpp
+  ${BASIS_DIR}/metrics/QueueLatencyMonitor.hpp
+  ${BASIS_DIR}/metrics/QueueLatencyMonitor.cpp
+  ${BASIS_DIR}/metrics/MetricsTraceExporter.hpp
+  ${BASIS_DIR}/metrics/MetricsTraceExporter.cpp
+  ${BASIS_DIR}/memory/Arena.hpp
+  ${BASIS_DIR}/memory/Arena.cpp
+  ${BASIS_DIR}/memory/ObjectPool.hpp
   ${BASIS_DIR}/periodic_prioritized_task_heap.hpp
   ${BASIS_DIR}/periodic_prioritized_task_heap.cc
   ${BASIS_DIR}/time_step/FixedTimeStep.hpp
   ${BASIS_DIR}/time_step/FixedTimeStep.cpp
   ${BASIS_DIR}/time_step/FixedTimeStepLoop.hpp
   ${BASIS_DIR}/time_step/FixedTimeStepLoop.cpp
+  ${BASIS_DIR}/time_step/FrameGraphScheduler.hpp
+  ${BASIS_DIR}/time_step/FrameGraphScheduler.cpp
+  ${BASIS_DIR}/time_step/FramePacer.hpp
+  ${BASIS_DIR}/time_step/FramePacer.cpp
+  ${BASIS_DIR}/time_step/MultiRateScheduler.hpp
+  ${BASIS_DIR}/time_step/MultiRateScheduler.cpp
+  ${BASIS_DIR}/time_step/TickLoopStats.hpp
+  ${BASIS_DIR}/time_step/TickLoopStats.cpp
+  ${BASIS_DIR}/time_step/TickRecorder.hpp
   ${BASIS_DIR}/timer/IntervalTimer.hpp
   ${BASIS_DIR}/timer/IntervalTimer.cpp
+  ${BASIS_DIR}/timer/TimerWheel.hpp
+  ${BASIS_DIR}/timer/TimerWheel.cpp
+  ${BASIS_DIR}/timer/DelayedPromiseScheduler.hpp
+  ${BASIS_DIR}/timer/DelayedPromiseScheduler.cpp
   ${BASIS_DIR}/concurrency/LockFreeProducerConsumerQueue.hpp
   ${BASIS_DIR}/concurrency/LockFreeProducerConsumerQueue.cpp
+  ${BASIS_DIR}/concurrency/SharedMemorySPSCQueue.hpp
+  ${BASIS_DIR}/concurrency/ByteStreamSPSCQueue.hpp
+  ${BASIS_DIR}/concurrency/EventCount.hpp
+  ${BASIS_DIR}/concurrency/SpinWait.hpp
+  ${BASIS_DIR}/concurrency/SpinWait.cpp
+  ${BASIS_DIR}/concurrency/BlockingProducerConsumerQueue.hpp
+  ${BASIS_DIR}/concurrency/MPMCQueue.hpp
+  ${BASIS_DIR}/concurrency/WorkStealingDeque.hpp
+  ${BASIS_DIR}/concurrency/MPSCIntrusiveQueue.hpp
+  ${BASIS_DIR}/lz4.hpp
+  ${BASIS_DIR}/lz4.cc
+  ${BASIS_DIR}/compressed_block_writer.hpp
+  ${BASIS_DIR}/compressed_block_writer.cc
+  ${BASIS_DIR}/log/AsyncLogger.cpp
+  ${BASIS_DIR}/log/AsyncLogger.hpp
+  ${BASIS_DIR}/log/BinaryLogSink.cpp
+  ${BASIS_DIR}/log/BinaryLogSink.hpp
   ${BASIS_DIR}/log/Logger.cpp
   ${BASIS_DIR}/log/Logger.hpp
   ${BASIS_DIR}/task_run/task_run_util.cc
@@ -40,13 +40,15 @@ class basis_conan_project(conan_build_helper.CMakePackage):
     options = {
         "shared": [True, False],
         "debug": [True, False],
-        "enable_sanitizers": [True, False]
+        "enable_sanitizers": [True, False],
+        "enable_benchmarks": [True, False]
     }
 
     default_options = (
         "shared=False",
         "debug=False",
         "enable_sanitizers=False",
+        "enable_benchmarks=False",
         "*:integration=catch", # for FakeIt,
         # chromium_base
         "chromium_base:use_alloc_shim=True",
@@ -88,6 +90,12 @@ class basis_conan_project(conan_build_helper.CMakePackage):
             self.build_requires("catch2/[>=2.1.0]@bincrafters/stable")
             self.build_requires("FakeIt/[>=2.0.5]@gasuketsu/stable")
 
+        # for the basis-benchmarks and basis-concurrency-bench targets
+        # (-DENABLE_BENCHMARKS=ON); >=1.6 for the State::thread_index()
+        # accessors the concurrency matrix uses
+        if self.options.enable_benchmarks:
+            self.build_requires("benchmark/[>=1.6.0]@_/_")
+
     def requirements(self):
         self.requires("chromium_build_util/master@conan/stable")
         
@@ -122,6 +130,8 @@ class basis_conan_project(conan_build_helper.CMakePackage):
 
         self.add_cmake_option(cmake, "ENABLE_SANITIZERS", self.options.enable_sanitizers)
 
+        self.add_cmake_option(cmake, "ENABLE_BENCHMARKS", self.options.enable_benchmarks)
+
         cmake.configure(build_folder=self._build_subfolder)
 
         return cmake
@@ -0,0 +1,83 @@
+#include "testsCommon.h"
+
+#if !defined(USE_CATCH_TEST)
+#warning "use USE_CATCH_TEST"
+// default
+#define USE_CATCH_TEST 1
+#endif // !defined(USE_CATCH_TEST)
+
+#include <memory>
+#include <vector>
+
+/// \note keep framework assertion macros OUT of counted scopes - the
+/// framework itself may allocate while recording an assertion.
+
+SCENARIO("allocation_watcher", "[basic]") {
+
+  GIVEN("the counting hooks installed by main.cpp") {
+    THEN("a heap allocation inside the scope is counted") {
+      // Counts are read into locals first: asserting while counting
+      // is live would add the framework's own allocations.
+      size_t after_unique = 0;
+      size_t after_array_new = 0;
+      size_t after_delete = 0;
+      {
+        basis::test::ScopedAllocationCounter counter;
+        auto owned = std::make_unique<int>(42);
+        after_unique = counter.count();
+        int* raw = new int[8];
+        after_array_new = counter.count();
+        delete[] raw;
+        after_delete = counter.count();
+      }
+      REQUIRE(after_unique == 1);
+      REQUIRE(after_array_new == 2);
+      REQUIRE(after_delete == 2);
+    }
+
+    THEN("allocations outside a scope are not counted") {
+      size_t in_scope = 0;
+      {
+        basis::test::ScopedAllocationCounter counter;
+        in_scope = counter.count();
+      }
+      auto owned = std::make_unique<int>(1);
+      REQUIRE(in_scope == 0);
+      REQUIRE(*owned == 1);
+    }
+
+    THEN("an allocation-free path passes EXPECT_ALLOCATIONS_LE(0)") {
+      std::vector<int> values;
+      values.reserve(64);
+      EXPECT_ALLOCATIONS_LE(0) {
+        for(int i = 0; i < 64; ++i) {
+          values.push_back(i);
+        }
+      }
+      REQUIRE(values.size() == 64u);
+    }
+
+    THEN("a bounded-allocation path passes with its bound") {
+      EXPECT_ALLOCATIONS_LE(1) {
+        auto owned = std::make_unique<int>(7);
+        *owned += 1;
+      }
+    }
+
+    THEN("nested scopes attribute inner allocations to both") {
+      size_t inner_count = 0;
+      size_t outer_count = 0;
+      {
+        basis::test::ScopedAllocationCounter outer;
+        {
+          basis::test::ScopedAllocationCounter inner;
+          auto owned = std::make_unique<int>(3);
+          inner_count = inner.count();
+        }
+        outer_count = outer.count();
+      }
+      REQUIRE(inner_count == 1);
+      REQUIRE(outer_count == 1);
+    }
+  }
+}
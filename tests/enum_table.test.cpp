@@ -0,0 +1,90 @@
+#include "testsCommon.h"
+
+#if !defined(USE_CATCH_TEST)
+#warning "use USE_CATCH_TEST"
+// default
+#define USE_CATCH_TEST 1
+#endif // !defined(USE_CATCH_TEST)
+
+#include "basis/enum_set.hpp"
+#include "basis/enum_table.hpp"
+
+#include <string_view>
+
+namespace {
+
+enum class Fruit {
+  kApple,
+  kMin = kApple,
+  kBanana,
+  kCherry,
+  kMax = kCherry
+};
+
+using FruitSet = basis::EnumSet<Fruit, Fruit::kMin, Fruit::kMax>;
+
+constexpr basis::EnumNameTable<FruitSet> kFruitNames({
+  {Fruit::kCherry, "cherry"},
+  {Fruit::kApple, "apple"},
+  {Fruit::kBanana, "banana"},
+});
+
+// The whole facility is compile-time; exercise it there first.
+static_assert(kFruitNames.isComplete()
+  , "every Fruit needs a distinct name");
+static_assert(kFruitNames.nameOf(Fruit::kBanana) == "banana"
+  , "nameOf must be usable in constant expressions");
+constexpr bool kParsesCherry = [] {
+  Fruit fruit{};
+  return kFruitNames.parse("cherry", &fruit) && fruit == Fruit::kCherry;
+}();
+static_assert(kParsesCherry
+  , "parse must be usable in constant expressions");
+
+// A table with a duplicated name (and a hole) must report incomplete.
+enum class Broken {
+  kOne,
+  kMin = kOne,
+  kTwo,
+  kMax = kTwo
+};
+using BrokenSet = basis::EnumSet<Broken, Broken::kMin, Broken::kMax>;
+constexpr basis::EnumNameTable<BrokenSet> kBrokenNames({
+  {Broken::kOne, "same"},
+  {Broken::kTwo, "same"},
+});
+static_assert(!kBrokenNames.isComplete()
+  , "duplicate names must fail isComplete()");
+
+} // namespace
+
+SCENARIO("enum_table", "[basic]") {
+
+  GIVEN("a complete table") {
+    THEN("every value round-trips through its name") {
+      for (const Fruit fruit
+           : {Fruit::kApple, Fruit::kBanana, Fruit::kCherry})
+      {
+        const std::string_view name = kFruitNames.nameOf(fruit);
+        REQUIRE(!name.empty());
+        Fruit parsed{};
+        REQUIRE(kFruitNames.parse(name, &parsed));
+        REQUIRE(parsed == fruit);
+      }
+    }
+
+    THEN("unknown names are rejected without touching the output") {
+      Fruit parsed = Fruit::kBanana;
+      REQUIRE(!kFruitNames.parse("durian", &parsed));
+      REQUIRE(!kFruitNames.parse("", &parsed));
+      REQUIRE(!kFruitNames.parse("appl", &parsed));
+      REQUIRE(!kFruitNames.parse("apples", &parsed));
+      REQUIRE(parsed == Fruit::kBanana);
+    }
+
+    THEN("out-of-range values get an empty name") {
+      REQUIRE(kFruitNames.nameOf(static_cast<Fruit>(100)).empty());
+      REQUIRE(kFruitNames.nameOf(static_cast<Fruit>(-1)).empty());
+    }
+  }
+}
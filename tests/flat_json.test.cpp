@@ -0,0 +1,85 @@
+#include "testsCommon.h"
+
+#if !defined(USE_CATCH_TEST)
+#warning "use USE_CATCH_TEST"
+// default
+#define USE_CATCH_TEST 1
+#endif // !defined(USE_CATCH_TEST)
+
+#include "basis/flat_json.h"
+
+#include <string>
+
+using chromecast::DeserializeFromJsonFlat;
+using chromecast::FlatJsonDocument;
+
+SCENARIO("flat json document", "[flat_json]") {
+
+  GIVEN("invalid input") {
+    THEN("parsing fails with a null document") {
+      REQUIRE(DeserializeFromJsonFlat("") == nullptr);
+      REQUIRE(DeserializeFromJsonFlat("{\"unbalanced\": [1,") == nullptr);
+      REQUIRE(DeserializeFromJsonFlat("not json") == nullptr);
+    }
+  }
+
+  GIVEN("a nested config-like document") {
+    const std::string text = R"({
+      "name": "srv-1", "port": 8080, "ratio": 0.5, "on": true,
+      "tags": ["a", "bb", "ccc"],
+      "limits": {"cpu": 4, "mem": 1024, "nested": {"deep": null}}
+    })";
+    const auto doc = DeserializeFromJsonFlat(text);
+    REQUIRE(doc != nullptr);
+
+    THEN("scalars read back typed, via key lookup") {
+      const auto root = doc->root();
+      REQUIRE(root.type() == FlatJsonDocument::Type::kObject);
+      REQUIRE(root.children_count() == 6);
+      REQUIRE(root.FindKey("name").GetString() == "srv-1");
+      REQUIRE(root.FindKey("port").GetInt() == 8080);
+      REQUIRE(root.FindKey("ratio").GetDouble() == Approx(0.5));
+      // GetDouble promotes int nodes, as base::Value does.
+      REQUIRE(root.FindKey("port").GetDouble() == Approx(8080.0));
+      REQUIRE(root.FindKey("on").GetBool());
+      REQUIRE(!root.FindKey("absent").is_valid());
+    }
+
+    THEN("children are contiguous and ordered as in the document") {
+      const auto root = doc->root();
+      REQUIRE(root.child(0).key() == "name");
+      REQUIRE(root.child(4).key() == "tags");
+      REQUIRE(root.child(5).key() == "limits");
+      const auto tags = root.FindKey("tags");
+      REQUIRE(tags.type() == FlatJsonDocument::Type::kArray);
+      REQUIRE(tags.children_count() == 3);
+      REQUIRE(tags.child(0).GetString() == "a");
+      REQUIRE(tags.child(2).GetString() == "ccc");
+      // Array elements carry no key.
+      REQUIRE(!tags.child(1).has_key());
+    }
+
+    THEN("nesting traverses through contiguous blocks") {
+      const auto limits = doc->root().FindKey("limits");
+      REQUIRE(limits.FindKey("mem").GetInt() == 1024);
+      REQUIRE(limits.FindKey("nested").FindKey("deep").type()
+              == FlatJsonDocument::Type::kNull);
+    }
+
+    THEN("node and arena accounting matches the document") {
+      // 1 root + 6 entries + 3 tags + 3 limit entries + 1 deep.
+      REQUIRE(doc->node_count() == 14);
+      REQUIRE(doc->arena_size() > 0);
+    }
+  }
+
+  GIVEN("a scalar root") {
+    const auto doc = DeserializeFromJsonFlat("42");
+    THEN("the document is a single keyless node") {
+      REQUIRE(doc != nullptr);
+      REQUIRE(doc->node_count() == 1);
+      REQUIRE(doc->root().GetInt() == 42);
+      REQUIRE(!doc->root().has_key());
+    }
+  }
+}
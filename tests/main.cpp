@@ -9,6 +9,12 @@
 #define CATCH_CONFIG_RUNNER
 #endif
 
+// Emit the counting operator new/delete replacements for this test
+// binary - exactly one TU per binary may do this (see
+// basis/test/allocation_watcher.h).
+#define BASIS_IMPLEMENT_ALLOCATION_WATCHER 1
+#include <basis/test/allocation_watcher.h>
+
 #include "log/Logger.hpp"
 #include "log_util.hpp"
 
@@ -31,3 +31,7 @@ using namespace ::Catch::Matchers;
 #if !defined(GTEST_HEADER_INCLUDE)
 #define GMOCK_HEADER_INCLUDE "gmock/gmock.h"
 #endif // GTEST_HEADER_INCLUDE
+
+// EXPECT_ALLOCATIONS_LE(n) { ... } scopes; the counting hooks are
+// emitted by main.cpp (BASIS_IMPLEMENT_ALLOCATION_WATCHER).
+#include <basis/test/allocation_watcher.h>
@@ -0,0 +1,136 @@
+#include "testsCommon.h"
+
+#if !defined(USE_CATCH_TEST)
+#warning "use USE_CATCH_TEST"
+// default
+#define USE_CATCH_TEST 1
+#endif // !defined(USE_CATCH_TEST)
+
+#include "basis/time_step/FixedTimeStep.hpp"
+
+#include <chrono>
+
+namespace {
+
+using namespace std::chrono_literals;
+
+// Drains the accumulator the way FixedTimeStepLoop does and returns
+// how many updates ran this frame.
+int drainFrame(basis::FixedTimeStep& time_step)
+{
+  int updates = 0;
+  while (time_step.is_update_required()) {
+    time_step.update_lag();
+    ++updates;
+  }
+  return updates;
+}
+
+} // namespace
+
+SCENARIO("fixed time step catch-up policy", "[time_step]") {
+
+  GIVEN("a 10ms time step with no policy configured") {
+    basis::FixedTimeStep time_step{10ms};
+
+    THEN("lag schedules one update per accumulated tick") {
+      time_step.update_clock(basis::FixedTimeStep::clock::now());
+      time_step.increase_lag(35ms);
+      REQUIRE(drainFrame(time_step) == 3);
+      REQUIRE(time_step.lag() == 5ms);
+      REQUIRE(time_step.dt_stretch() == 1.0f);
+      REQUIRE(time_step.stretched_tickrate()
+              == time_step.fixed_tickrate());
+    }
+  }
+
+  GIVEN("a per-frame catch-up cap") {
+    basis::FixedTimeStep time_step{10ms};
+    time_step.set_max_catchup_updates(3);
+
+    THEN("an overloaded frame runs at most the cap") {
+      time_step.update_clock(basis::FixedTimeStep::clock::now());
+      time_step.increase_lag(100ms);
+      REQUIRE(drainFrame(time_step) == 3);
+      // The remainder waits for the next frame instead of extending
+      // this one.
+      REQUIRE(time_step.lag() == 70ms);
+    }
+
+    THEN("the counter resets on the next frame") {
+      time_step.update_clock(basis::FixedTimeStep::clock::now());
+      time_step.increase_lag(100ms);
+      REQUIRE(drainFrame(time_step) == 3);
+      time_step.update_clock(basis::FixedTimeStep::clock::now());
+      time_step.increase_lag(0ms);
+      REQUIRE(drainFrame(time_step) == 3);
+      REQUIRE(time_step.lag() == 40ms);
+    }
+  }
+
+  GIVEN("a lag-shedding bound with a callback") {
+    basis::FixedTimeStep time_step{10ms};
+    time_step.set_max_lag(50ms);
+
+    std::chrono::nanoseconds shed{0};
+    int notifications = 0;
+    time_step.set_lag_shed_callback(
+      [&](const std::chrono::nanoseconds& dropped) {
+        shed += dropped;
+        ++notifications;
+      });
+
+    THEN("lag beyond the bound is dropped and reported") {
+      time_step.update_clock(basis::FixedTimeStep::clock::now());
+      time_step.increase_lag(130ms);
+      REQUIRE(time_step.lag() == 50ms);
+      REQUIRE(shed == 80ms);
+      REQUIRE(notifications == 1);
+    }
+
+    THEN("lag within the bound is untouched") {
+      time_step.update_clock(basis::FixedTimeStep::clock::now());
+      time_step.increase_lag(30ms);
+      REQUIRE(time_step.lag() == 30ms);
+      REQUIRE(notifications == 0);
+    }
+  }
+
+  GIVEN("a dt stretch bound on top of the catch-up cap") {
+    basis::FixedTimeStep time_step{10ms};
+    time_step.set_max_catchup_updates(2);
+    time_step.set_max_dt_stretch(2.0f);
+
+    THEN("a moderate backlog stretches dt to fit the update budget") {
+      time_step.update_clock(basis::FixedTimeStep::clock::now());
+      // 30ms of lag over 2 allowed updates wants a 1.5x stretch.
+      time_step.increase_lag(30ms);
+      REQUIRE(time_step.dt_stretch() == Approx(1.5f));
+      REQUIRE(time_step.stretched_tickrate() == 15ms);
+      REQUIRE(drainFrame(time_step) == 2);
+      REQUIRE(time_step.lag() == 0ms);
+    }
+
+    THEN("the stretch is clamped to the configured bound") {
+      time_step.update_clock(basis::FixedTimeStep::clock::now());
+      // 100ms over 2 updates wants 5x; the bound is 2x.
+      time_step.increase_lag(100ms);
+      REQUIRE(time_step.dt_stretch() == Approx(2.0f));
+      REQUIRE(time_step.stretched_tickrate() == 20ms);
+      REQUIRE(drainFrame(time_step) == 2);
+      REQUIRE(time_step.lag() == 60ms);
+    }
+
+    THEN("the stretch relaxes once the backlog fits again") {
+      time_step.update_clock(basis::FixedTimeStep::clock::now());
+      time_step.increase_lag(30ms);
+      REQUIRE(time_step.dt_stretch() > 1.0f);
+      REQUIRE(drainFrame(time_step) == 2);
+      time_step.update_clock(basis::FixedTimeStep::clock::now());
+      time_step.increase_lag(10ms);
+      REQUIRE(time_step.dt_stretch() == 1.0f);
+      REQUIRE(time_step.stretched_tickrate()
+              == time_step.fixed_tickrate());
+    }
+  }
+}